@@ -0,0 +1,369 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ *@example ex_bitset.c
+ *@brief Nilorea Library bitset and roaring bitmap API
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+#include "nilorea/n_str.h"
+#include "nilorea/n_bitset.h"
+
+void usage(void) {
+    fprintf(stderr,
+            "     -v version\n"
+            "     -V log level: LOG_INFO, LOG_NOTICE, LOG_ERR, LOG_DEBUG\n"
+            "     -h help\n");
+}
+
+void process_args(int argc, char** argv) {
+    int getoptret = 0,
+        log_level = LOG_DEBUG; /* default log level */
+
+    /* Arguments optionnels */
+    /* -v version
+     * -V log level
+     * -h help
+     */
+    while ((getoptret = getopt(argc, argv, "hvV:")) != EOF) {
+        switch (getoptret) {
+            case 'v':
+                fprintf(stderr, "Date de compilation : %s a %s.\n", __DATE__, __TIME__);
+                exit(1);
+            case 'V':
+                if (!strcmp("LOG_NULL", optarg))
+                    log_level = LOG_NULL;
+                else if (!strcmp("LOG_NOTICE", optarg))
+                    log_level = LOG_NOTICE;
+                else if (!strcmp("LOG_INFO", optarg))
+                    log_level = LOG_INFO;
+                else if (!strcmp("LOG_ERR", optarg))
+                    log_level = LOG_ERR;
+                else if (!strcmp("LOG_DEBUG", optarg))
+                    log_level = LOG_DEBUG;
+                else {
+                    fprintf(stderr, "%s n'est pas un niveau de log valide.\n", optarg);
+                    exit(-1);
+                }
+                break;
+            default:
+            case '?': {
+                if (optopt == 'V') {
+                    fprintf(stderr, "\n      Missing log level\n");
+                } else if (optopt == 'p') {
+                    fprintf(stderr, "\n      Missing port\n");
+                } else if (optopt != 's') {
+                    fprintf(stderr, "\n      Unknow missing option %c\n", optopt);
+                }
+                usage();
+                exit(1);
+            }
+            case 'h': {
+                usage();
+                exit(1);
+            }
+        }
+    }
+    set_log_level(log_level);
+} /* void process_args( ... ) */
+
+/*! number of bits of the test bitsets */
+#define NB_BITS 1000
+
+/*! largest value put in the test roaring bitmaps */
+#define MAX_VALUE 400000
+
+/**
+ *@brief check a bitset against an array of flags
+ *@param bitset bitset to check
+ *@param flags expected bits
+ *@param nb number of bits
+ *@return the number of errors
+ */
+int check_bitset(const N_BITSET* bitset, const char* flags, size_t nb) {
+    int errors = 0;
+    size_t count = 0;
+    for (size_t it = 0; it < nb; it++) {
+        if (bitset_test(bitset, it) != flags[it]) {
+            n_log(LOG_ERR, "bit %zu is %d instead of %d", it, bitset_test(bitset, it), flags[it]);
+            errors++;
+        }
+        count += (size_t)flags[it];
+    }
+    if (bitset_count(bitset) != count) {
+        n_log(LOG_ERR, "bitset_count gave %zu instead of %zu", bitset_count(bitset), count);
+        errors++;
+    }
+    /* walk the set bits, then the cleared ones */
+    size_t bit = bitset_next_set(bitset, 0);
+    for (size_t it = 0; it < nb; it++) {
+        if (!flags[it]) continue;
+        if (bit != it) {
+            n_log(LOG_ERR, "bitset_next_set gave %zu instead of %zu", bit, it);
+            return errors + 1;
+        }
+        bit = bitset_next_set(bitset, bit + 1);
+    }
+    bit = bitset_next_clear(bitset, 0);
+    for (size_t it = 0; it < nb; it++) {
+        if (flags[it]) continue;
+        if (bit != it) {
+            n_log(LOG_ERR, "bitset_next_clear gave %zu instead of %zu", bit, it);
+            return errors + 1;
+        }
+        bit = bitset_next_clear(bitset, bit + 1);
+    }
+    if (bit != BITSET_NONE) {
+        n_log(LOG_ERR, "bitset_next_clear went past the last bit");
+        errors++;
+    }
+    return errors;
+}
+
+/**
+ *@brief test the fixed size bitsets
+ *@return the number of errors
+ */
+int test_bitset(void) {
+    int errors = 0;
+    char a_flags[NB_BITS], b_flags[NB_BITS], flags[NB_BITS];
+    N_BITSET* a = new_bitset(NB_BITS);
+    N_BITSET* b = new_bitset(NB_BITS);
+
+    errors += check_bitset(a, memset(a_flags, 0, NB_BITS), NB_BITS);
+    for (size_t it = 0; it < NB_BITS; it++) {
+        a_flags[it] = (it % 3 == 0 || it % 7 == 0) ? 1 : 0;
+        b_flags[it] = (it % 2 == 0 || it > 900) ? 1 : 0;
+        if (a_flags[it]) bitset_set(a, it);
+        if (b_flags[it]) bitset_set(b, it);
+    }
+    bitset_clear(a, 0);
+    a_flags[0] = 0;
+    errors += check_bitset(a, a_flags, NB_BITS);
+    errors += check_bitset(b, b_flags, NB_BITS);
+
+    /* ranges within a word, across words and up to the end */
+    size_t ranges[][2] = {{3, 9}, {60, 70}, {100, 300}, {64, 128}, {990, NB_BITS}, {5, 5}};
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+        int value = (int)(r % 2);
+        bitset_fill_range(a, ranges[r][0], ranges[r][1], value);
+        memset(a_flags + ranges[r][0], value, ranges[r][1] - ranges[r][0]);
+    }
+    errors += check_bitset(a, a_flags, NB_BITS);
+    if (bitset_fill_range(a, 10, NB_BITS + 1, 1) != FALSE) {
+        n_log(LOG_ERR, "bitset_fill_range accepted a range past the end");
+        errors++;
+    }
+
+    size_t common = 0;
+    for (size_t it = 0; it < NB_BITS; it++) common += (size_t)(a_flags[it] & b_flags[it]);
+    if (bitset_and_count(a, b) != common) {
+        n_log(LOG_ERR, "bitset_and_count gave %zu instead of %zu", bitset_and_count(a, b), common);
+        errors++;
+    }
+
+    N_BITSET* c = new_bitset(NB_BITS);
+    bitset_or(c, a);
+    bitset_and(c, b);
+    for (size_t it = 0; it < NB_BITS; it++) flags[it] = a_flags[it] & b_flags[it];
+    errors += check_bitset(c, flags, NB_BITS);
+    bitset_or(c, b);
+    bitset_xor(c, a);
+    for (size_t it = 0; it < NB_BITS; it++) flags[it] = (char)(((a_flags[it] & b_flags[it]) | b_flags[it]) ^ a_flags[it]);
+    errors += check_bitset(c, flags, NB_BITS);
+    bitset_fill(c, 1);
+    bitset_andnot(c, b);
+    for (size_t it = 0; it < NB_BITS; it++) flags[it] = (char)!b_flags[it];
+    errors += check_bitset(c, flags, NB_BITS);
+
+    N_BITSET* d = new_bitset(NB_BITS + 1);
+    if (bitset_and(d, a) != FALSE) {
+        n_log(LOG_ERR, "bitset_and accepted bitsets of different sizes");
+        errors++;
+    }
+    destroy_bitset(&a);
+    destroy_bitset(&b);
+    destroy_bitset(&c);
+    destroy_bitset(&d);
+    if (a != NULL)
+        errors++;
+    return errors;
+}
+
+/*! state of the roaring_foreach check */
+typedef struct FOREACH_CHECK {
+    /*! expected values */
+    const N_BITSET* flags;
+    /*! last value seen */
+    int64_t last;
+    /*! number of errors */
+    int errors;
+} FOREACH_CHECK;
+
+/**
+ *@brief roaring_foreach callback checking the order and the values
+ *@param value current value
+ *@param user_data FOREACH_CHECK state
+ *@return TRUE
+ */
+int foreach_check(uint32_t value, void* user_data) {
+    FOREACH_CHECK* check = (FOREACH_CHECK*)user_data;
+    if ((int64_t)value <= check->last || !bitset_test(check->flags, value))
+        check->errors++;
+    check->last = value;
+    return TRUE;
+}
+
+/**
+ *@brief check a roaring bitmap against a bitset holding the same values
+ *@param roaring roaring bitmap to check
+ *@param flags expected values
+ *@return the number of errors
+ */
+int check_roaring(const N_ROARING* roaring, const N_BITSET* flags) {
+    int errors = 0;
+    for (uint32_t it = 0; it <= MAX_VALUE; it++) {
+        if (roaring_contains(roaring, it) != bitset_test(flags, it)) {
+            n_log(LOG_ERR, "roaring_contains(%u) is %d instead of %d", it, roaring_contains(roaring, it), bitset_test(flags, it));
+            if (++errors > 10) return errors;
+        }
+    }
+    if (roaring_cardinality(roaring) != bitset_count(flags)) {
+        n_log(LOG_ERR, "roaring_cardinality gave %zu instead of %zu", roaring_cardinality(roaring), bitset_count(flags));
+        errors++;
+    }
+    FOREACH_CHECK check = {flags, -1, 0};
+    if (roaring_foreach(roaring, foreach_check, &check) != bitset_count(flags) || check.errors != 0) {
+        n_log(LOG_ERR, "roaring_foreach gave %d wrong values", check.errors);
+        errors++;
+    }
+    return errors;
+}
+
+/**
+ *@brief test the roaring bitmaps against bitsets, with sparse, dense and mixed containers
+ *@return the number of errors
+ */
+int test_roaring(void) {
+    int errors = 0;
+    N_ROARING* a = new_roaring();
+    N_ROARING* b = new_roaring();
+    N_BITSET* a_flags = new_bitset(MAX_VALUE + 1);
+    N_BITSET* b_flags = new_bitset(MAX_VALUE + 1);
+
+    /* a: dense in the first containers, sparse after. b: dense in the middle ones */
+    for (uint32_t it = 0; it <= MAX_VALUE; it++) {
+        if ((it < 140000 && it % 3 != 0) || it % 97 == 0) {
+            roaring_add(a, it);
+            bitset_set(a_flags, it);
+        }
+        if ((it > 100000 && it < 300000 && it % 2 == 0) || it % 89 == 0) {
+            roaring_add(b, it);
+            bitset_set(b_flags, it);
+        }
+    }
+    /* adding twice changes nothing */
+    roaring_add(a, 1);
+    roaring_add(b, 178);
+    errors += check_roaring(a, a_flags);
+    errors += check_roaring(b, b_flags);
+
+    /* remove enough values to turn bitmap containers back into arrays and to drop a container */
+    for (uint32_t it = 65536; it < 131072; it++) {
+        if (it % 5 != 0 && bitset_test(a_flags, it)) {
+            roaring_remove(a, it);
+            bitset_clear(a_flags, it);
+        }
+    }
+    for (uint32_t it = 196608; it < 262144; it++) {
+        if (bitset_test(b_flags, it)) {
+            roaring_remove(b, it);
+            bitset_clear(b_flags, it);
+        }
+    }
+    if (roaring_remove(b, 200000) != FALSE)
+        errors++;
+    errors += check_roaring(a, a_flags);
+    errors += check_roaring(b, b_flags);
+
+    N_BITSET* flags = new_bitset(MAX_VALUE + 1);
+    N_ROARING* result = roaring_and(a, b);
+    bitset_or(flags, a_flags);
+    bitset_and(flags, b_flags);
+    errors += check_roaring(result, flags);
+    destroy_roaring(&result);
+
+    result = roaring_or(a, b);
+    bitset_fill(flags, 0);
+    bitset_or(flags, a_flags);
+    bitset_or(flags, b_flags);
+    errors += check_roaring(result, flags);
+    destroy_roaring(&result);
+
+    result = roaring_andnot(a, b);
+    bitset_fill(flags, 0);
+    bitset_or(flags, a_flags);
+    bitset_andnot(flags, b_flags);
+    errors += check_roaring(result, flags);
+    destroy_roaring(&result);
+
+    result = roaring_andnot(b, a);
+    bitset_fill(flags, 0);
+    bitset_or(flags, b_flags);
+    bitset_andnot(flags, a_flags);
+    errors += check_roaring(result, flags);
+    destroy_roaring(&result);
+
+    roaring_empty(a);
+    bitset_fill(a_flags, 0);
+    errors += check_roaring(a, a_flags);
+    roaring_add(a, UINT32_MAX);
+    if (!roaring_contains(a, UINT32_MAX) || roaring_cardinality(a) != 1)
+        errors++;
+
+    destroy_bitset(&flags);
+    destroy_bitset(&a_flags);
+    destroy_bitset(&b_flags);
+    destroy_roaring(&a);
+    destroy_roaring(&b);
+    return errors;
+}
+
+int main(int argc, char** argv) {
+    set_log_level(LOG_INFO);
+
+    /* processing args and set log_level */
+    process_args(argc, argv);
+
+    int errors = 0;
+    errors += test_bitset();
+    errors += test_roaring();
+
+    n_log(LOG_INFO, "bitset test: %d errors", errors);
+    exit(errors == 0 ? 0 : 1);
+}
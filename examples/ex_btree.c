@@ -0,0 +1,246 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ *@example ex_btree.c
+ *@brief Nilorea Library B+tree ordered map API
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+#include "nilorea/n_str.h"
+#include "nilorea/n_btree.h"
+
+/*! number of values destroyed by the tree */
+static size_t nb_destroyed = 0;
+
+/**
+ *@brief value destructor counting its calls
+ *@param ptr value to free
+ */
+static void destroy_value(void* ptr) {
+    nb_destroyed++;
+    Free(ptr);
+}
+
+/**
+ *@brief allocate a value holding its key
+ *@param key key of the value
+ *@return the new value
+ */
+static void* new_value(int64_t key) {
+    int64_t* value = NULL;
+    Malloc(value, int64_t, 1);
+    __n_assert(value, exit(1));
+    (*value) = key;
+    return value;
+}
+
+void usage(void) {
+    fprintf(stderr,
+            "     -v version\n"
+            "     -V log level: LOG_INFO, LOG_NOTICE, LOG_ERR, LOG_DEBUG\n"
+            "     -h help\n");
+}
+
+void process_args(int argc, char** argv) {
+    int getoptret = 0,
+        log_level = LOG_DEBUG; /* default log level */
+
+    /* Arguments optionnels */
+    /* -v version
+     * -V log level
+     * -h help
+     */
+    while ((getoptret = getopt(argc, argv, "hvV:")) != EOF) {
+        switch (getoptret) {
+            case 'v':
+                fprintf(stderr, "Date de compilation : %s a %s.\n", __DATE__, __TIME__);
+                exit(1);
+            case 'V':
+                if (!strcmp("LOG_NULL", optarg))
+                    log_level = LOG_NULL;
+                else if (!strcmp("LOG_NOTICE", optarg))
+                    log_level = LOG_NOTICE;
+                else if (!strcmp("LOG_INFO", optarg))
+                    log_level = LOG_INFO;
+                else if (!strcmp("LOG_ERR", optarg))
+                    log_level = LOG_ERR;
+                else if (!strcmp("LOG_DEBUG", optarg))
+                    log_level = LOG_DEBUG;
+                else {
+                    fprintf(stderr, "%s n'est pas un niveau de log valide.\n", optarg);
+                    exit(-1);
+                }
+                break;
+            default:
+            case '?': {
+                if (optopt == 'V') {
+                    fprintf(stderr, "\n      Missing log level\n");
+                } else if (optopt == 'p') {
+                    fprintf(stderr, "\n      Missing port\n");
+                } else if (optopt != 's') {
+                    fprintf(stderr, "\n      Unknow missing option %c\n", optopt);
+                }
+                usage();
+                exit(1);
+            }
+            case 'h': {
+                usage();
+                exit(1);
+            }
+        }
+    }
+    set_log_level(log_level);
+} /* void process_args( ... ) */
+
+/*! number of keys put in the test trees */
+#define NB_KEYS 100000
+
+/**
+ *@brief walk a tree forward and backward, checking the order, the values, rank and select
+ *@param tree tree to check
+ *@return the number of errors
+ */
+int check_tree(BTREE* tree) {
+    int errors = 0;
+    BTREE_CURSOR cursor;
+    size_t rank = 0;
+    int64_t previous = INT64_MIN;
+    for (int ok = btree_cursor_first(tree, &cursor); ok; ok = btree_cursor_next(&cursor)) {
+        int64_t key = 0;
+        void* value = NULL;
+        btree_cursor_get(&cursor, &key, &value);
+        if ((rank > 0 && key <= previous) || *(int64_t*)value != key)
+            errors++;
+        int64_t selected = 0;
+        if (btree_rank(tree, key) != rank || btree_select(tree, rank, &selected, NULL) == FALSE || selected != key)
+            errors++;
+        previous = key;
+        rank++;
+    }
+    if (rank != tree->nb_items)
+        errors++;
+    for (int ok = btree_cursor_last(tree, &cursor); ok; ok = btree_cursor_prev(&cursor))
+        rank--;
+    if (rank != 0)
+        errors++;
+    return errors;
+}
+
+int main(int argc, char** argv) {
+    set_log_level(LOG_INFO);
+
+    /* processing args and set log_level */
+    process_args(argc, argv);
+
+    int errors = 0;
+
+    /* keys in a scrambled order, 7919 being prime with NB_KEYS */
+    BTREE* tree = new_btree(destroy_value);
+    for (int64_t it = 0; it < NB_KEYS; it++) {
+        int64_t key = (it * 7919) % NB_KEYS * 3;
+        if (btree_put(tree, key, new_value(key)) == FALSE)
+            errors++;
+    }
+    /* replacing a value destroys the old one */
+    btree_put(tree, 0, new_value(0));
+    if (nb_destroyed != 1 || tree->nb_items != NB_KEYS)
+        errors++;
+    errors += check_tree(tree);
+    n_log(LOG_INFO, "put %zu keys, height %zu", tree->nb_items, tree->height);
+
+    void* value = NULL;
+    if (btree_get(tree, 3 * 1234, &value) == FALSE || *(int64_t*)value != 3 * 1234 || btree_get(tree, 3 * 1234 + 1, &value) == TRUE)
+        errors++;
+    if (btree_rank(tree, 3 * 1234 + 1) != 1235 || btree_rank(tree, -1) != 0 || btree_rank(tree, INT64_MAX) != NB_KEYS)
+        errors++;
+
+    /* range scan from a key that is not in the tree */
+    BTREE_CURSOR cursor;
+    size_t nb_range = 0;
+    int64_t key = 0;
+    for (int ok = btree_cursor_seek(tree, &cursor, 100); ok && btree_cursor_get(&cursor, &key, NULL) && key <= 200; ok = btree_cursor_next(&cursor))
+        nb_range++;
+    /* 102, 105, ... 198 */
+    if (nb_range != 33)
+        errors++;
+    if (btree_cursor_seek(tree, &cursor, 3 * NB_KEYS) == TRUE)
+        errors++;
+
+    /* remove two keys out of three, merging and rotating nodes on the way */
+    for (int64_t it = 0; it < NB_KEYS; it++) {
+        if (it % 3 != 0 && btree_remove(tree, it * 3) == FALSE)
+            errors++;
+    }
+    if (btree_remove(tree, 1) == TRUE || tree->nb_items != (NB_KEYS + 2) / 3)
+        errors++;
+    errors += check_tree(tree);
+    n_log(LOG_INFO, "%zu keys left, height %zu", tree->nb_items, tree->height);
+
+    for (int64_t it = 0; it < NB_KEYS; it += 3) {
+        if (btree_remove(tree, it * 3) == FALSE)
+            errors++;
+    }
+    if (tree->nb_items != 0 || tree->root != NULL || nb_destroyed != 1 + NB_KEYS)
+        errors++;
+    destroy_btree(&tree);
+
+    /* bulk loading, then the same checks and updates as a tree built key by key */
+    int64_t* keys = NULL;
+    void** values = NULL;
+    Malloc(keys, int64_t, NB_KEYS);
+    Malloc(values, void*, NB_KEYS);
+    __n_assert(keys && values, exit(1));
+    for (int64_t it = 0; it < NB_KEYS; it++) {
+        keys[it] = it * 2;
+        values[it] = new_value(it * 2);
+    }
+    tree = new_btree(destroy_value);
+    if (btree_bulk_load(tree, keys, values, NB_KEYS) == FALSE)
+        errors++;
+    errors += check_tree(tree);
+    n_log(LOG_INFO, "bulk loaded %zu keys, height %zu", tree->nb_items, tree->height);
+    /* a second load on a non empty tree is refused */
+    if (btree_bulk_load(tree, keys, values, NB_KEYS) == TRUE)
+        errors++;
+    for (int64_t it = 0; it < NB_KEYS; it += 2) {
+        btree_put(tree, it * 2 + 1, new_value(it * 2 + 1));
+        btree_remove(tree, it * 4);
+    }
+    errors += check_tree(tree);
+    Free(keys);
+    Free(values);
+
+    nb_destroyed = 0;
+    size_t nb_left = tree->nb_items;
+    destroy_btree(&tree);
+    if (tree != NULL || nb_destroyed != nb_left)
+        errors++;
+
+    n_log(LOG_INFO, "btree test: %d errors", errors);
+    exit(errors == 0 ? 0 : 1);
+}
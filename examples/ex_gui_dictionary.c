@@ -111,6 +111,8 @@ void on_completion_select(int widget_id, int index, int selected, void* user_dat
 
     const char* item_text = n_gui_listbox_get_item_text(gui, completion_listbox_id, index);
     if (item_text) {
+        /* picked words come first in the next completions */
+        ht_trie_add_weight(dictionary, item_text, 1);
         n_gui_textarea_set_text(gui, search_textarea_id, item_text);
         update_completion(gui, item_text);
         update_definitions(gui, item_text);
@@ -134,7 +136,12 @@ static void update_completion(N_GUI_CTX* gui, const char* text) {
     if (completion) {
         list_destroy(&completion);
     }
-    completion = ht_get_completion_list(dictionary, text, max_results);
+    /* words ranked by weight once the user typed something, first letters otherwise */
+    if (text[0] != '\0') {
+        completion = ht_get_completion_list_ranked(dictionary, text, max_results);
+    } else {
+        completion = ht_get_completion_list(dictionary, text, max_results);
+    }
 
     n_gui_listbox_clear(gui, completion_listbox_id);
     if (completion) {
@@ -317,6 +324,8 @@ int main(int argc, char* argv[]) {
                 entry_def->type = strdup(type);
                 entry_def->definition = strdup(definition);
                 list_push(entry->definitions, entry_def, &free_entry_def);
+                /* words with more definitions rank higher in the completion */
+                ht_trie_add_weight(dictionary, entry_key, 1);
             } else {
                 Malloc(entry, DICTIONARY_ENTRY, 1);
 
@@ -331,6 +340,7 @@ int main(int argc, char* argv[]) {
                 list_push(entry->definitions, entry_def, &free_entry_def);
 
                 ht_put_ptr(dictionary, entry_key, entry, &free_entry, NULL);
+                ht_trie_set_weight(dictionary, entry_key, 1);
             }
             FreeNoLog(entry_key);
             FreeNoLog(type);
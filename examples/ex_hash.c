@@ -49,6 +49,71 @@ void destroy_data(void* ptr) {
     Free(data);
 }
 
+/*! number of keys written by each concurrent writer thread */
+#define NB_CONCURRENT_KEYS 2000
+
+/*! number of writer threads in the concurrent table test */
+#define NB_CONCURRENT_WRITERS 4
+
+/*! number of keys put by the batched functions test */
+#define NB_BATCH_KEYS 1000
+
+/*! concurrent table shared by the test threads */
+HASH_TABLE* concurrent_table = NULL;
+
+/*! set once the writers are done, readers stop on it */
+int concurrent_writers_done = 0;
+
+/**
+ *@brief writer thread: put then overwrite then remove half of its own keys
+ *@param param writer id, as intptr_t
+ *@return NULL
+ */
+void* concurrent_writer(void* param) {
+    intptr_t id = (intptr_t)param;
+    char key[32] = "";
+    for (int it = 0; it < NB_CONCURRENT_KEYS; it++) {
+        snprintf(key, sizeof(key), "w%d_%d", (int)id, it);
+        ht_put_int(concurrent_table, key, it);
+        ht_put_int(concurrent_table, key, it + 1);
+        /* replaced strings are freed once the readers holding their key have left */
+        snprintf(key, sizeof(key), "s%d", (int)id);
+        ht_put_string(concurrent_table, key, (it % 2) ? "odd" : "even");
+    }
+    for (int it = 0; it < NB_CONCURRENT_KEYS; it += 2) {
+        snprintf(key, sizeof(key), "w%d_%d", (int)id, it);
+        ht_remove(concurrent_table, key);
+    }
+    return NULL;
+}
+
+/**
+ *@brief reader thread: look up keys while the writers are running
+ *@param param pointer to an int error counter
+ *@return NULL
+ */
+void* concurrent_reader(void* param) {
+    int* errors = (int*)param;
+    char key[32] = "";
+    while (__atomic_load_n(&concurrent_writers_done, __ATOMIC_ACQUIRE) == 0) {
+        for (int it = 0; it < NB_CONCURRENT_KEYS; it += 7) {
+            HASH_INT_TYPE val = -1;
+            snprintf(key, sizeof(key), "w%d_%d", it % NB_CONCURRENT_WRITERS, it);
+            /* a key is either missing or holds one of the two values written */
+            if (ht_get_int(concurrent_table, key, &val) == TRUE && val != it && val != it + 1)
+                (*errors)++;
+            /* the string is only used inside the read section of its key */
+            snprintf(key, sizeof(key), "s%d", it % NB_CONCURRENT_WRITERS);
+            size_t parity = ht_concurrent_read_lock(concurrent_table, key);
+            char* str = NULL;
+            if (ht_get_string(concurrent_table, key, &str) == TRUE && strcmp(str, "odd") != 0 && strcmp(str, "even") != 0)
+                (*errors)++;
+            ht_concurrent_read_unlock(concurrent_table, key, parity);
+        }
+    }
+    return NULL;
+}
+
 int main(void) {
     set_log_level(LOG_DEBUG);
 
@@ -200,6 +265,468 @@ int main(void) {
 
     destroy_ht(&htable);
 
+    /* trie table: keys with long shared prefixes and keys prefixing other keys, then remove two thirds of them */
+    int trie_errors = 0;
+    htable = new_ht_trie(256, 0);
+    for (int it = 0; it < 3000; it++) {
+        char trie_key[64] = "";
+        snprintf(trie_key, sizeof(trie_key), "a_very_long_shared_prefix_%d", it);
+        ht_put_int(htable, trie_key, it);
+    }
+    ht_put_string(htable, "a_very_long_shared_prefix_", "MyTrieString");
+    ht_put_int(htable, "a_very_long_shared_prefix_12", -12);
+    for (int it = 0; it < 3000; it++) {
+        if (it % 3 == 0)
+            continue;
+        char trie_key[64] = "";
+        snprintf(trie_key, sizeof(trie_key), "a_very_long_shared_prefix_%d", it);
+        if (ht_remove(htable, trie_key) == FALSE)
+            trie_errors++;
+    }
+    for (int it = 0; it < 3000; it++) {
+        char trie_key[64] = "";
+        snprintf(trie_key, sizeof(trie_key), "a_very_long_shared_prefix_%d", it);
+        HASH_INT_TYPE trie_val = 0;
+        int found = ht_get_int(htable, trie_key, &trie_val);
+        if ((it % 3 != 0 && found == TRUE) || (it % 3 == 0 && (found == FALSE || trie_val != (it == 12 ? -12 : it))))
+            trie_errors++;
+    }
+    if (ht_get_string(htable, "a_very_long_shared_prefix_", &string) == FALSE || strcmp(string, "MyTrieString") != 0)
+        trie_errors++;
+    if (ht_remove(htable, "a_very_long_shared_prefix_1") == TRUE || ht_remove(htable, "a_very_long_shared") == TRUE)
+        trie_errors++;
+    size_t trie_count = 0;
+    HT_FOREACH(node, htable, { if (node->key) trie_count++; });
+    if (trie_count != htable->nb_keys || trie_count != 1001)
+        trie_errors++;
+    /* keybud itself, then the 4 kept keys of 30..39 and the 34 kept keys of 300..399 */
+    results = ht_get_completion_list(htable, "a_very_long_shared_prefix_3", 1000);
+    if (!results || results->nb_items != 39)
+        trie_errors++;
+    if (results)
+        list_destroy(&results);
+    n_log(LOG_INFO, "Trie table: %zu keys, %d errors", htable->nb_keys, trie_errors);
+    destroy_ht(&htable);
+
+    /* arena table: churn the same keys, they must be interned once and their entries recycled */
+    int arena_errors = 0;
+    htable = new_ht_ex(64, HT_ARENA);
+    for (int round = 0; round < 3; round++) {
+        for (int it = 0; it < 2000; it++) {
+            char arena_key[32] = "";
+            snprintf(arena_key, sizeof(arena_key), "arena_key_%d", it);
+            if (it % 2 == 0)
+                ht_put_int(htable, arena_key, it);
+            else
+                ht_put_string(htable, arena_key, "MyArenaString");
+        }
+        for (int it = 0; it < 2000; it += 4) {
+            char arena_key[32] = "";
+            snprintf(arena_key, sizeof(arena_key), "arena_key_%d", it);
+            if (ht_remove(htable, arena_key) == FALSE)
+                arena_errors++;
+        }
+    }
+    if (htable->nb_keys != 1500 || htable->arena_nb_interned != 2000)
+        arena_errors++;
+    HASH_TABLE* htable_arena_copy = ht_duplicate(htable);
+    string = NULL;
+    if (!htable_arena_copy || !(htable_arena_copy->flags & HT_ARENA) || ht_get_string(htable_arena_copy, "arena_key_1", &string) == FALSE || strcmp(string, "MyArenaString") != 0)
+        arena_errors++;
+    if (htable_arena_copy)
+        destroy_ht(&htable_arena_copy);
+    empty_ht(htable);
+    HASH_INT_TYPE arena_val = -1;
+    if (htable->nb_keys != 0 || ht_get_int(htable, "arena_key_2", &arena_val) == TRUE)
+        arena_errors++;
+    ht_put_int(htable, "arena_key_2", 2);
+    if (ht_get_int(htable, "arena_key_2", &arena_val) == FALSE || arena_val != 2)
+        arena_errors++;
+    n_log(LOG_INFO, "Arena table: %zu keys, %zu interned keys, %d errors", htable->nb_keys, htable->arena_nb_interned, arena_errors);
+    destroy_ht(&htable);
+
+    /* open addressing table: start small so it has to grow, then remove half the keys */
+    int open_errors = 0;
+    htable = new_ht_open(4);
+    for (int it = 0; it < 1000; it++) {
+        char open_key[32] = "";
+        snprintf(open_key, sizeof(open_key), "open_key_%d", it);
+        ht_put_int(htable, open_key, it);
+    }
+    ht_put_string(htable, "open_string", "MyOpenString");
+    ht_put_double(htable, "open_double", 42.0);
+    for (int it = 0; it < 1000; it += 2) {
+        char open_key[32] = "";
+        snprintf(open_key, sizeof(open_key), "open_key_%d", it);
+        if (ht_remove(htable, open_key) == FALSE)
+            open_errors++;
+    }
+    for (int it = 0; it < 1000; it++) {
+        char open_key[32] = "";
+        snprintf(open_key, sizeof(open_key), "open_key_%d", it);
+        HASH_INT_TYPE open_val = -1;
+        int found = ht_get_int(htable, open_key, &open_val);
+        if ((it % 2 == 0 && found == TRUE) || (it % 2 == 1 && (found == FALSE || open_val != it)))
+            open_errors++;
+    }
+    size_t open_count = 0;
+    HT_FOREACH(node, htable, { if (node->key) open_count++; });
+    if (open_count != htable->nb_keys || open_count != 502)
+        open_errors++;
+    HASH_TABLE* htable_open_copy = ht_duplicate(htable);
+    string = NULL;
+    if (!htable_open_copy || ht_get_string(htable_open_copy, "open_string", &string) == FALSE || strcmp(string, "MyOpenString") != 0)
+        open_errors++;
+    if (htable_open_copy)
+        destroy_ht(&htable_open_copy);
+    n_log(LOG_INFO, "Open table: %zu keys in %zu slots, %d errors", htable->nb_keys, htable->size, open_errors);
+    destroy_ht(&htable);
+
+    /* classic table: start tiny so it grows incrementally, check keys stay reachable while both bucket arrays are in use */
+    int grow_errors = 0;
+    size_t nb_resizing_checks = 0;
+    htable = new_ht(3);
+    ht_set_max_load(htable, HASH_CLASSIC_MAX_LOAD_PERCENT);
+    for (int it = 0; it < 5000; it++) {
+        char grow_key[32] = "";
+        snprintf(grow_key, sizeof(grow_key), "grow_key_%d", it);
+        ht_put_int(htable, grow_key, it);
+        if (htable->rehash_table) {
+            nb_resizing_checks++;
+            HASH_INT_TYPE grow_val = -1;
+            snprintf(grow_key, sizeof(grow_key), "grow_key_%d", it / 2);
+            if (ht_get_int(htable, grow_key, &grow_val) == FALSE || grow_val != it / 2)
+                grow_errors++;
+        }
+    }
+    for (int it = 0; it < 5000; it += 3) {
+        char grow_key[32] = "";
+        snprintf(grow_key, sizeof(grow_key), "grow_key_%d", it);
+        if (ht_remove(htable, grow_key) == FALSE)
+            grow_errors++;
+    }
+    size_t grow_count = 0;
+    ht_foreach(node, htable) {
+        grow_count++;
+    }
+    if (grow_count != htable->nb_keys || htable->size < 1000 || nb_resizing_checks == 0)
+        grow_errors++;
+    /* explicit incremental shrink, driven by hand */
+    ht_resize_incremental(htable, 101);
+    while (ht_rehash_step(htable, 16) == TRUE);
+    for (int it = 0; it < 5000; it++) {
+        char grow_key[32] = "";
+        snprintf(grow_key, sizeof(grow_key), "grow_key_%d", it);
+        HASH_INT_TYPE grow_val = -1;
+        int found = ht_get_int(htable, grow_key, &grow_val);
+        if ((it % 3 == 0 && found == TRUE) || (it % 3 != 0 && (found == FALSE || grow_val != it)))
+            grow_errors++;
+    }
+    if (htable->size != 101)
+        grow_errors++;
+    n_log(LOG_INFO, "Growing table: %zu keys in %zu buckets, %zu lookups during resizes, %d errors", htable->nb_keys, htable->size, nb_resizing_checks, grow_errors);
+    destroy_ht(&htable);
+
+    /* concurrent table: writers on their own keys, lock free readers on all of them */
+    int concurrent_errors = 0;
+    concurrent_table = new_ht_concurrent(1024, 8);
+    pthread_t writers[NB_CONCURRENT_WRITERS];
+    pthread_t reader;
+    pthread_create(&reader, NULL, concurrent_reader, &concurrent_errors);
+    for (intptr_t it = 0; it < NB_CONCURRENT_WRITERS; it++) {
+        pthread_create(&writers[it], NULL, concurrent_writer, (void*)it);
+    }
+    for (int it = 0; it < NB_CONCURRENT_WRITERS; it++) {
+        pthread_join(writers[it], NULL);
+    }
+    __atomic_store_n(&concurrent_writers_done, 1, __ATOMIC_RELEASE);
+    pthread_join(reader, NULL);
+    size_t concurrent_count = 0;
+    HT_FOREACH(node, concurrent_table, { if (node->key) concurrent_count++; });
+    if (concurrent_count != concurrent_table->nb_keys || concurrent_count != NB_CONCURRENT_WRITERS * (NB_CONCURRENT_KEYS / 2 + 1))
+        concurrent_errors++;
+    HASH_INT_TYPE concurrent_val = -1;
+    if (ht_get_int(concurrent_table, "w1_3", &concurrent_val) == FALSE || concurrent_val != 4 || ht_get_int(concurrent_table, "w1_4", &concurrent_val) == TRUE)
+        concurrent_errors++;
+    n_log(LOG_INFO, "Concurrent table: %zu keys in %zu shards, %d errors", concurrent_table->nb_keys, concurrent_table->nb_shards, concurrent_errors);
+    destroy_ht(&concurrent_table);
+
+    /* batched puts and gets on every table mode, half of the looked up keys missing */
+    int batch_errors = 0;
+    static int batch_values[NB_BATCH_KEYS];
+    char batch_keys[2 * NB_BATCH_KEYS][32];
+    const char* batch_key_ptrs[2 * NB_BATCH_KEYS];
+    void* batch_value_ptrs[2 * NB_BATCH_KEYS];
+    for (int it = 0; it < 2 * NB_BATCH_KEYS; it++) {
+        snprintf(batch_keys[it], sizeof(batch_keys[it]), "batch_key_%d", it);
+        batch_key_ptrs[it] = batch_keys[it];
+        if (it < NB_BATCH_KEYS) {
+            batch_values[it] = it;
+            batch_value_ptrs[it] = &batch_values[it];
+        }
+    }
+    HASH_TABLE* batch_tables[4] = {new_ht(64), new_ht_open(64), new_ht_concurrent(64, 4), new_ht_trie(128, 0)};
+    for (int table_it = 0; table_it < 4; table_it++) {
+        /* the second put replaces the values of the first one */
+        if (ht_put_ptr_many(batch_tables[table_it], batch_key_ptrs, NB_BATCH_KEYS, batch_value_ptrs, NULL, NULL) != NB_BATCH_KEYS ||
+            ht_put_ptr_many(batch_tables[table_it], batch_key_ptrs, NB_BATCH_KEYS, batch_value_ptrs, NULL, NULL) != NB_BATCH_KEYS || batch_tables[table_it]->nb_keys != NB_BATCH_KEYS)
+            batch_errors++;
+        ht_put_int(batch_tables[table_it], "batch_int", 1);
+        batch_key_ptrs[NB_BATCH_KEYS] = "batch_int";
+        if (ht_get_ptr_many(batch_tables[table_it], batch_key_ptrs, 2 * NB_BATCH_KEYS, batch_value_ptrs) != NB_BATCH_KEYS)
+            batch_errors++;
+        batch_key_ptrs[NB_BATCH_KEYS] = batch_keys[NB_BATCH_KEYS];
+        for (int it = 0; it < 2 * NB_BATCH_KEYS; it++) {
+            if ((it < NB_BATCH_KEYS && batch_value_ptrs[it] != &batch_values[it]) || (it >= NB_BATCH_KEYS && batch_value_ptrs[it] != NULL))
+                batch_errors++;
+        }
+        destroy_ht(&batch_tables[table_it]);
+    }
+    n_log(LOG_INFO, "Batched puts and gets: %d keys on 4 table modes, %d errors", NB_BATCH_KEYS, batch_errors);
+
+    /* snapshot: save a classic table, map it back, change it through the overlay, save it over itself */
+    int snapshot_errors = 0;
+    htable = new_ht(256);
+    for (int it = 0; it < 2000; it++) {
+        char snapshot_key[32] = "";
+        snprintf(snapshot_key, sizeof(snapshot_key), "snap_key_%d", it);
+        ht_put_int(htable, snapshot_key, it);
+    }
+    ht_put_double(htable, "snap_double", 3.5);
+    ht_put_string(htable, "snap_string", "MySnapshotString");
+    ht_put_string(htable, "snap_null_string", NULL);
+    ht_put_ptr(htable, "snap_ptr", &batch_values[0], NULL, NULL);
+    if (ht_save_snapshot(htable, "ex_hash.snapshot") == FALSE)
+        snapshot_errors++;
+    destroy_ht(&htable);
+
+    htable = ht_open_snapshot("ex_hash.snapshot");
+    if (!htable) {
+        snapshot_errors++;
+    } else {
+        HASH_INT_TYPE snapshot_val = -1;
+        double snapshot_double = 0.0;
+        void* snapshot_ptr = NULL;
+        string = NULL;
+        if (htable->nb_keys != 2003 || ht_get_ptr(htable, "snap_ptr", &snapshot_ptr) == TRUE)
+            snapshot_errors++;
+        if (ht_get_int(htable, "snap_key_1234", &snapshot_val) == FALSE || snapshot_val != 1234 || ht_get_int(htable, "snap_key_2000", &snapshot_val) == TRUE)
+            snapshot_errors++;
+        if (ht_get_double(htable, "snap_double", &snapshot_double) == FALSE || snapshot_double != 3.5)
+            snapshot_errors++;
+        if (ht_get_string(htable, "snap_string", &string) == FALSE || strcmp(string, "MySnapshotString") != 0 || ht_get_string(htable, "snap_null_string", &string) == FALSE || string != NULL)
+            snapshot_errors++;
+        /* overlay: new key, replaced image key, removed image key, removed then put back image key */
+        ht_put_int(htable, "snap_new_key", -1);
+        ht_put_int(htable, "snap_key_1", 100);
+        ht_remove(htable, "snap_key_2");
+        ht_remove(htable, "snap_key_3");
+        ht_put_int(htable, "snap_key_3", 300);
+        if (ht_put_string(htable, "snap_key_4", "wrong type") == TRUE || ht_remove(htable, "snap_key_2") == TRUE)
+            snapshot_errors++;
+        if (ht_get_int(htable, "snap_key_1", &snapshot_val) == FALSE || snapshot_val != 100 || ht_get_int(htable, "snap_key_2", &snapshot_val) == TRUE || ht_get_int(htable, "snap_key_3", &snapshot_val) == FALSE || snapshot_val != 300)
+            snapshot_errors++;
+        HASH_NODE* snapshot_node = ht_get_node(htable, "snap_key_5");
+        if (!snapshot_node || snapshot_node->data.ival != 5)
+            snapshot_errors++;
+        else
+            snapshot_node->data.ival = 500;
+        size_t snapshot_count = 0;
+        HT_FOREACH(node, htable, { if (node->key) snapshot_count++; });
+        if (snapshot_count != htable->nb_keys || snapshot_count != 2003)
+            snapshot_errors++;
+        HASH_TABLE* htable_snapshot_copy = ht_duplicate(htable);
+        if (!htable_snapshot_copy || htable_snapshot_copy->nb_keys != 2003 || ht_get_int(htable_snapshot_copy, "snap_key_5", &snapshot_val) == FALSE || snapshot_val != 500)
+            snapshot_errors++;
+        if (htable_snapshot_copy)
+            destroy_ht(&htable_snapshot_copy);
+        /* the mapped file is replaced, not overwritten, so the open table stays valid */
+        if (ht_save_snapshot(htable, "ex_hash.snapshot") == FALSE)
+            snapshot_errors++;
+        empty_ht(htable);
+        if (htable->nb_keys != 0 || ht_get_int(htable, "snap_key_6", &snapshot_val) == TRUE)
+            snapshot_errors++;
+        destroy_ht(&htable);
+    }
+    htable = ht_open_snapshot("ex_hash.snapshot");
+    if (!htable) {
+        snapshot_errors++;
+    } else {
+        HASH_INT_TYPE snapshot_val = -1;
+        if (htable->nb_keys != 2003 || ht_get_int(htable, "snap_key_5", &snapshot_val) == FALSE || snapshot_val != 500 || ht_get_int(htable, "snap_new_key", &snapshot_val) == FALSE || snapshot_val != -1 || ht_get_int(htable, "snap_key_2", &snapshot_val) == TRUE)
+            snapshot_errors++;
+        /* batched puts go to the overlay */
+        if (ht_put_ptr_many(htable, batch_key_ptrs, NB_BATCH_KEYS, batch_value_ptrs, NULL, NULL) != NB_BATCH_KEYS || htable->nb_keys != 2003 + NB_BATCH_KEYS ||
+            ht_get_ptr_many(htable, batch_key_ptrs, NB_BATCH_KEYS, batch_value_ptrs) != NB_BATCH_KEYS || batch_value_ptrs[NB_BATCH_KEYS - 1] != &batch_values[NB_BATCH_KEYS - 1])
+            snapshot_errors++;
+        destroy_ht(&htable);
+    }
+    FILE* snapshot_file = fopen("ex_hash.snapshot", "wb");
+    if (snapshot_file) {
+        fputs("not a snapshot image, though long enough to be checked against the snapshot header", snapshot_file);
+        fclose(snapshot_file);
+    }
+    htable = ht_open_snapshot("ex_hash.snapshot");
+    if (htable) {
+        snapshot_errors++;
+        destroy_ht(&htable);
+    }
+    unlink("ex_hash.snapshot");
+    n_log(LOG_INFO, "Snapshot table: %d errors", snapshot_errors);
+
+    /* cursors: trie prefix range in key order and resume, classic walk split in two cursors */
+    int cursor_errors = 0;
+    htable = new_ht_trie(128, 0);
+    HASH_TABLE* htable_cursor = new_ht(64);
+    for (int it = 0; it < 300; it++) {
+        char cursor_key[32] = "";
+        snprintf(cursor_key, sizeof(cursor_key), "cursor_%03d", it);
+        ht_put_int(htable, cursor_key, it);
+        ht_put_int(htable_cursor, cursor_key, it);
+    }
+    HASH_CURSOR* cursor = ht_cursor_open(htable, "cursor_1");
+    int cursor_expected = 100;
+    for (HASH_NODE* node = ht_cursor_next(cursor); node; node = ht_cursor_next(cursor)) {
+        if (node->data.ival != cursor_expected++)
+            cursor_errors++;
+    }
+    if (cursor_expected != 200)
+        cursor_errors++;
+    ht_cursor_seek(cursor, "cursor_150");
+    HASH_NODE* cursor_node = ht_cursor_next(cursor);
+    if (!cursor_node || strcmp(cursor_node->key, "cursor_151") != 0)
+        cursor_errors++;
+    ht_cursor_close(&cursor);
+    size_t cursor_count = 0;
+    char cursor_last_key[32] = "";
+    cursor = ht_cursor_open(htable_cursor, NULL);
+    for (HASH_NODE* node = ht_cursor_next(cursor); node && cursor_count < 120; node = ht_cursor_next(cursor)) {
+        snprintf(cursor_last_key, sizeof(cursor_last_key), "%s", node->key);
+        cursor_count++;
+    }
+    ht_cursor_close(&cursor);
+    cursor = ht_cursor_open(htable_cursor, NULL);
+    ht_cursor_seek(cursor, cursor_last_key);
+    while (ht_cursor_next(cursor)) {
+        cursor_count++;
+    }
+    ht_cursor_close(&cursor);
+    if (cursor_count != 300)
+        cursor_errors++;
+    /* puts going over the load factor don't resize the table under an open cursor, only once it is closed */
+    ht_set_max_load(htable_cursor, HASH_CLASSIC_MAX_LOAD_PERCENT);
+    cursor = ht_cursor_open(htable_cursor, NULL);
+    size_t cursor_walked = 0;
+    for (HASH_NODE* node = ht_cursor_next(cursor); node; node = ht_cursor_next(cursor)) {
+        if (cursor_walked++ == 10) {
+            for (int it = 300; it < 500; it++) {
+                char cursor_key[32] = "";
+                snprintf(cursor_key, sizeof(cursor_key), "cursor_%03d", it);
+                ht_put_int(htable_cursor, cursor_key, it);
+            }
+        }
+    }
+    if (htable_cursor->size != 64 || htable_cursor->rehash_table || cursor_walked < 300)
+        cursor_errors++;
+    ht_cursor_close(&cursor);
+    ht_put_int(htable_cursor, "cursor_500", 500);
+    if (!htable_cursor->rehash_table)
+        cursor_errors++;
+    destroy_ht(&htable_cursor);
+    destroy_ht(&htable);
+    n_log(LOG_INFO, "Cursors: %zu classic keys walked, %d errors", cursor_count, cursor_errors);
+
+    /* ranked completion: weights of a trie, heaviest matching keys first */
+    int rank_errors = 0;
+    htable = new_ht_trie(128, 0);
+    for (int it = 0; it < 500; it++) {
+        char rank_key[32] = "";
+        snprintf(rank_key, sizeof(rank_key), "rank_%03d", it);
+        HASH_INT_TYPE weight = (it * 7919) % 1000;
+        ht_put_int(htable, rank_key, weight);
+        ht_trie_set_weight(htable, rank_key, (size_t)weight);
+    }
+    LIST* ranked = ht_get_completion_list_ranked(htable, "rank_1", 10);
+    if (!ranked || ranked->nb_items != 10) {
+        rank_errors++;
+    } else {
+        HASH_INT_TYPE previous = 1000, lightest = 0;
+        list_foreach(node, ranked) {
+            HASH_INT_TYPE weight = -1;
+            if (ht_get_int(htable, (char*)node->ptr, &weight) == FALSE || strncmp((char*)node->ptr, "rank_1", 6) != 0 || weight > previous)
+                rank_errors++;
+            previous = lightest = weight;
+        }
+        int heavier = 0;
+        for (int it = 100; it < 200; it++) {
+            if ((it * 7919) % 1000 > lightest)
+                heavier++;
+        }
+        if (heavier != 9)
+            rank_errors++;
+    }
+    list_destroy(&ranked);
+    if (ht_trie_add_weight(htable, "rank_150", 5000) == FALSE || ht_trie_add_weight(htable, "rank_missing", 1) == TRUE)
+        rank_errors++;
+    ranked = ht_get_completion_list_ranked(htable, "", 1);
+    if (!ranked || strcmp((char*)ranked->start->ptr, "rank_150") != 0)
+        rank_errors++;
+    list_destroy(&ranked);
+    ht_remove(htable, "rank_150");
+    ranked = ht_get_completion_list_ranked(htable, "", 3);
+    if (!ranked || ranked->nb_items != 3 || strcmp((char*)ranked->start->ptr, "rank_321") != 0)
+        rank_errors++;
+    list_destroy(&ranked);
+    if (ht_get_completion_list_ranked(htable, "nothing", 3) != NULL)
+        rank_errors++;
+    destroy_ht(&htable);
+    n_log(LOG_INFO, "Ranked completion: %d errors", rank_errors);
+
+    /* compiled templates rendered with the tables of each mode into a reused N_STR */
+    int template_errors = 0;
+    char long_key[300] = "";
+    memset(long_key, 'k', sizeof(long_key) - 1);
+    N_STR* template_text = NULL;
+    nstrprintf(template_text, "Dear {{name}}, you have {{count}} new {{what}}{{}} {{{{name}} {{name}}!{{%s}} {{unterminated", long_key);
+    N_STR* template_expected = NULL;
+    nstrprintf(template_expected, "Dear Alice, you have 12 new {{what}}{{}} {{{{name}} Alice!{{%s}} {{unterminated", long_key);
+    N_STR_TEMPLATE* compiled = n_str_template_compile(_nstr(template_text));
+    N_STR* rendered = NULL;
+    HASH_TABLE* template_tables[4] = {new_ht(64), new_ht_open(64), new_ht_concurrent(64, 4), new_ht_trie(128, 0)};
+    for (int table_it = 0; table_it < 4; table_it++) {
+        ht_put_string(template_tables[table_it], "name", "Alice");
+        ht_put_string(template_tables[table_it], "count", "12");
+        for (int pass = 0; pass < 2; pass++) {
+            size_t allocated = rendered ? rendered->length : 0;
+            if (rendered)
+                rendered->written = 0;
+            if (!compiled || n_str_template_render(compiled, template_tables[table_it], &rendered) == FALSE || strcmp(_nstr(rendered), _nstr(template_expected)) != 0 || rendered->written != template_expected->written) {
+                n_log(LOG_ERR, "FAIL: template rendered as \"%s\" by table mode %d", _nstr(rendered), template_tables[table_it]->mode);
+                template_errors++;
+            }
+            /* same size output, no reallocation */
+            if (pass == 1 && rendered && rendered->length != allocated)
+                template_errors++;
+        }
+    }
+    /* appending, and rendering without vars */
+    if (!compiled || n_str_template_render(compiled, NULL, &rendered) == FALSE || rendered->written != template_expected->written + template_text->written || strcmp(rendered->data + template_expected->written, _nstr(template_text)) != 0)
+        template_errors++;
+    N_STR* expanded = n_str_template_expand(_nstr(template_text), template_tables[0]);
+    if (!expanded || strcmp(_nstr(expanded), _nstr(template_expected)) != 0)
+        template_errors++;
+    free_nstr(&expanded);
+    for (int table_it = 0; table_it < 4; table_it++) destroy_ht(&template_tables[table_it]);
+    if (compiled)
+        n_str_template_delete(&compiled);
+    free_nstr(&rendered);
+    free_nstr(&template_text);
+    free_nstr(&template_expected);
+    n_log(LOG_INFO, "Compiled templates: %d errors", template_errors);
+
+    if (trie_errors > 0 || arena_errors > 0 || open_errors > 0 || grow_errors > 0 || concurrent_errors > 0 || batch_errors > 0 || snapshot_errors > 0 || cursor_errors > 0 || rank_errors > 0 || template_errors > 0)
+        exit(1);
+
     exit(0);
 
 } /* END_OF_MAIN */
@@ -28,14 +28,44 @@
 #include "nilorea/n_list.h"
 #include "nilorea/n_str.h"
 
+#include <pthread.h>
+
 #define LIST_LIMIT 10
 #define NB_TEST_ELEM 15
+#define NB_PRODUCERS 4
+#define NB_PRODUCED 20000
 
 void print_list_info(LIST* list) {
     __n_assert(list, return);
     n_log(LOG_NOTICE, "List: %p, %d max_elements , %d elements", list, list->nb_max_items, list->nb_items);
 }
 
+/*! item of the intrusive list test, the link lives inside the item */
+typedef struct ILIST_ITEM {
+    /*! item value */
+    int value;
+    /*! link in the intrusive list */
+    ILIST_LINK link;
+} ILIST_ITEM;
+
+/*! values pushed by the MPSC queue producers */
+int produced[NB_PRODUCERS][NB_PRODUCED];
+/*! queue shared by the producers */
+MPSC_QUEUE* mpsc_queue = NULL;
+
+/* push the values of one producer, in order */
+void* mpsc_producer(void* arg) {
+    int* values = (int*)arg;
+    for (int it = 0; it < NB_PRODUCED; it++) {
+        mpsc_push(mpsc_queue, &values[it]);
+    }
+    return NULL;
+}
+
+int intcmp(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
 int nstrcmp(const void* a, const void* b) {
     const N_STR* s1 = a;
     const N_STR* s2 = b;
@@ -211,5 +241,141 @@ int main(void) {
 
     list_destroy(&list);
 
+    int errors = 0;
+
+    /* node cache: removed nodes are reused by the next insertions */
+    list = new_generic_list(UNLIMITED_LIST_ITEMS);
+    list_reserve_nodes(list, NB_TEST_ELEM);
+    if (list->nb_free_nodes != NB_TEST_ELEM)
+        errors++;
+    int values[NB_TEST_ELEM] = {0};
+    for (int it = 0; it < NB_TEST_ELEM; it++) {
+        list_push(list, &values[it], NULL);
+    }
+    if (list->nb_free_nodes != 0 || list->nb_items != NB_TEST_ELEM)
+        errors++;
+    for (int it = 0; it < NB_TEST_ELEM; it++) {
+        if (list_shift(list, int) != &values[it])
+            errors++;
+    }
+    if (list->nb_free_nodes != NB_TEST_ELEM)
+        errors++;
+    list_node_cache(list, 4);
+    if (list->nb_free_nodes != 4)
+        errors++;
+    list_destroy(&list);
+
+    /* intrusive list: items carry their own links */
+    ILIST ilist;
+    ilist_init(&ilist);
+    ILIST_ITEM items[NB_TEST_ELEM];
+    memset(items, 0, sizeof(items));
+    for (int it = 0; it < NB_TEST_ELEM; it++) {
+        items[it].value = it;
+        if (it % 2)
+            ilist_push(&ilist, &items[it].link);
+        else
+            ilist_unshift(&ilist, &items[it].link);
+    }
+    int previous = NB_TEST_ELEM;
+    int all_even = TRUE;
+    ilist_foreach(link, &ilist) {
+        ILIST_ITEM* item = ilist_entry(link, ILIST_ITEM, link);
+        if (item->value % 2 == 0) {
+            if (item->value > previous)
+                errors++;
+            previous = item->value;
+            ilist_remove(&ilist, link);
+        } else {
+            all_even = FALSE;
+        }
+    }
+    if (all_even || ilist.nb_items != NB_TEST_ELEM / 2 || ilist_is_unlinked(&items[0].link) == FALSE)
+        errors++;
+    ILIST other;
+    ilist_init(&other);
+    ilist_push(&other, &items[0].link);
+    ilist_splice(&other, &ilist);
+    if (ilist.nb_items != 0 || other.nb_items != NB_TEST_ELEM / 2 + 1 || ilist_entry(ilist_pop(&other), ILIST_ITEM, link)->value != ((NB_TEST_ELEM % 2) ? NB_TEST_ELEM - 2 : NB_TEST_ELEM - 1))
+        errors++;
+    while (ilist_shift(&other)) {
+    }
+    if (other.nb_items != 0)
+        errors++;
+
+    /* MPSC queue: each producer values must come out in order */
+    set_log_level(LOG_NOTICE);
+    mpsc_queue = new_mpsc_queue(UNLIMITED_LIST_ITEMS, NULL);
+    pthread_t producers[NB_PRODUCERS];
+    for (int it = 0; it < NB_PRODUCERS; it++) {
+        for (int value = 0; value < NB_PRODUCED; value++) {
+            produced[it][value] = value;
+        }
+        pthread_create(&producers[it], NULL, mpsc_producer, produced[it]);
+    }
+    int next_value[NB_PRODUCERS] = {0};
+    for (int popped_count = 0; popped_count < NB_PRODUCERS * NB_PRODUCED;) {
+        int* value = (int*)mpsc_pop(mpsc_queue);
+        if (!value)
+            continue;
+        int producer = (int)(((char*)value - (char*)produced) / (NB_PRODUCED * (int)sizeof(int)));
+        if (*value != next_value[producer])
+            errors++;
+        next_value[producer] = *value + 1;
+        popped_count++;
+    }
+    for (int it = 0; it < NB_PRODUCERS; it++) {
+        pthread_join(producers[it], NULL);
+    }
+    if (mpsc_pop(mpsc_queue) != NULL || mpsc_nb_items(mpsc_queue) != 0)
+        errors++;
+    destroy_mpsc_queue(&mpsc_queue);
+    mpsc_queue = new_mpsc_queue(2, free);
+    int* limited = NULL;
+    for (int it = 0; it < 2; it++) {
+        Malloc(limited, int, 1);
+        mpsc_push(mpsc_queue, limited);
+    }
+    int unpushed = 0;
+    if (mpsc_push(mpsc_queue, &unpushed) == TRUE || mpsc_nb_items(mpsc_queue) != 2)
+        errors++;
+    destroy_mpsc_queue(&mpsc_queue);
+
+    /* list_sort is stable: items of the same key keep their insertion order */
+    list = new_generic_list(UNLIMITED_LIST_ITEMS);
+    LIST* other_list = new_generic_list(UNLIMITED_LIST_ITEMS);
+    for (int it = 0; it < NB_PRODUCED; it++) {
+        produced[0][it] = rand() % 100;
+        list_push((it % 3) ? list : other_list, &produced[0][it], NULL);
+    }
+    list_sort(list, intcmp);
+    const int* previous_int = NULL;
+    list_foreach(node, list) {
+        /* values were pushed in address order */
+        const int* value = (const int*)node->ptr;
+        if (previous_int && (*previous_int > *value || (*previous_int == *value && previous_int > value)))
+            errors++;
+        previous_int = value;
+    }
+    list_sort(other_list, intcmp);
+    list_merge_sorted(list, other_list, intcmp);
+    if (list->nb_items != NB_PRODUCED || other_list->nb_items != 0 || other_list->start)
+        errors++;
+    previous_int = NULL;
+    list_foreach(node, list) {
+        const int* value = (const int*)node->ptr;
+        if (previous_int && (*previous_int > *value || node->prev->ptr != previous_int))
+            errors++;
+        previous_int = value;
+    }
+    if (list->end->ptr != previous_int)
+        errors++;
+    list_destroy(&other_list);
+    list_destroy(&list);
+
+    n_log(LOG_NOTICE, "node cache, intrusive list, mpsc queue and sort: %d errors", errors);
+    if (errors > 0)
+        exit(1);
+
     exit(0);
 } /* END_OF_MAIN */
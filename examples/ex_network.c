@@ -144,7 +144,122 @@ void process_args(int argc, char** argv, char** address, char** server, char** p
     set_log_level(log_level);
 } /* void process_args( ... ) */
 
+/*! size of the body sent by test_send_builder, far above the loopback socket buffers */
+#define BUILDER_BODY_SIZE (4 * 1024 * 1024)
+
+/*! receiving side of test_send_builder */
+typedef struct BUILDER_READER {
+    /*! port of the test listener */
+    char port[16];
+    /*! flattened copy of the response, checked byte by byte */
+    N_STR* expected;
+    /*! number of errors */
+    int errors;
+} BUILDER_READER;
+
+/**
+ *@brief connect to the test listener and read the response slowly, so that the sender fills its buffer and gets partial sends
+ *@param ptr BUILDER_READER of the test
+ *@return NULL
+ */
+void* builder_reader(void* ptr) {
+    BUILDER_READER* reader = (BUILDER_READER*)ptr;
+    NETWORK* client = NULL;
+    if (netw_connect(&client, "127.0.0.1", reader->port, NETWORK_IPV4) != TRUE) {
+        n_log(LOG_ERR, "builder test: unable to connect to 127.0.0.1:%s", reader->port);
+        reader->errors++;
+        return NULL;
+    }
+    char buf[65536];
+    size_t received = 0;
+    size_t next_stall = 0;
+    while (received < reader->expected->written) {
+        /* stall every megabyte */
+        if (received >= next_stall) {
+            u_sleep(30000);
+            next_stall += 1024 * 1024;
+        }
+        ssize_t nb = recv(client->link.sock, buf, sizeof(buf), 0);
+        if (nb <= 0)
+            break;
+        if (received + (size_t)nb > reader->expected->written || memcmp(reader->expected->data + received, buf, (size_t)nb) != 0) {
+            n_log(LOG_ERR, "builder test: bytes %zu to %zu differ from the response", received, received + (size_t)nb);
+            reader->errors++;
+            break;
+        }
+        received += (size_t)nb;
+    }
+    if (received != reader->expected->written) {
+        n_log(LOG_ERR, "builder test: received %zu bytes instead of %zu", received, reader->expected->written);
+        reader->errors++;
+    }
+    netw_close(&client);
+    return NULL;
+} /* builder_reader(...) */
+
+/**
+ *@brief send an HTTP response built in a N_STR_BUILDER with netw_send_builder on a loopback connection with a small send buffer and a short send timeout, and check the bytes received
+ *@return number of errors
+ */
+int test_send_builder(void) {
+    NETWORK* listener = NULL;
+    if (netw_make_listening(&listener, "127.0.0.1", "0", 1, NETWORK_IPV4) == FALSE) {
+        n_log(LOG_ERR, "builder test: unable to listen on 127.0.0.1");
+        return 1;
+    }
+    BUILDER_READER reader;
+    memset(&reader, 0, sizeof(reader));
+    struct sockaddr_in bound;
+    socklen_t bound_len = sizeof(bound);
+    if (getsockname(listener->link.sock, (struct sockaddr*)&bound, &bound_len) != 0) {
+        n_log(LOG_ERR, "builder test: unable to get the listening port");
+        netw_close(&listener);
+        return 1;
+    }
+    snprintf(reader.port, sizeof(reader.port), "%d", ntohs(bound.sin_port));
+
+    /* headers in a builder chunk, body referenced in a second one */
+    N_STR* body = new_nstr(BUILDER_BODY_SIZE + 1);
+    for (size_t it = 0; it < BUILDER_BODY_SIZE; it++)
+        body->data[it] = (char)('a' + (it % 251) % 26);
+    body->written = BUILDER_BODY_SIZE;
+    N_STR_BUILDER* response = new_nstr_builder(0);
+    netw_build_http_response_builder(response, 200, "ex_network", "text/plain", "", body);
+    reader.expected = nstr_builder_to_nstr(response);
+
+    pthread_t reader_thr;
+    pthread_create(&reader_thr, NULL, builder_reader, &reader);
+    NETWORK* sender = netw_accept_from(listener);
+    if (sender) {
+        netw_setsockopt(sender, SO_SNDBUF, 64 * 1024);
+#ifndef __windows__
+        /* a blocking sendmsg only stops early on a timeout or a signal */
+        struct timeval timeout = {0, 20000};
+        setsockopt(sender->link.sock, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+#endif
+        ssize_t sent = netw_send_builder(sender, response);
+        if (sent < 0 || (size_t)sent != response->written) {
+            n_log(LOG_ERR, "builder test: netw_send_builder returned %zd instead of %zu", sent, response->written);
+            reader.errors++;
+        }
+    } else {
+        n_log(LOG_ERR, "builder test: error on accept");
+        reader.errors++;
+    }
+    pthread_join(reader_thr, NULL);
+    n_log(LOG_INFO, "builder test: %zu bytes in %zu chunks, %d errors", response->written, response->nb_chunks, reader.errors);
+
+    if (sender)
+        netw_close(&sender);
+    netw_close(&listener);
+    destroy_nstr_builder(&response);
+    free_nstr(&reader.expected);
+    free_nstr(&body);
+    return reader.errors;
+} /* test_send_builder(...) */
+
 int main(int argc, char** argv) {
+    int exit_code = 0;
     char* addr = NULL;
     char* srv = NULL;
     char* port = NULL;
@@ -253,6 +368,9 @@ int main(int argc, char** argv) {
     }
     /* TCP mode */
     else if (mode == SERVER) {
+        if (test_send_builder() != 0)
+            exit_code = 1;
+
         n_log(LOG_INFO, "Creating listening network for %s:%s %d", _str(addr), _str(port), ip_mode);
         /* create listening network */
         if (netw_make_listening(&netw_server, addr, port, 10, ip_mode) == FALSE) {
@@ -354,5 +472,5 @@ int main(int argc, char** argv) {
 
     n_log(LOG_INFO, "Exiting network example");
 
-    exit(0);
+    exit(exit_code);
 } /* END_OF_MAIN() */
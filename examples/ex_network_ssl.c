@@ -249,7 +249,7 @@ void handle_request(NETWORK* netw_ptr, LIST* routes_ptr) {
     bool found = 0;
     char** split_results = NULL;
     char* http_url = NULL;
-    N_STR* dynamic_request_answer = NULL;
+    N_STR_BUILDER* http_answer = NULL;
 
     // Read request
     char* http_buffer = NULL;
@@ -282,12 +282,15 @@ void handle_request(NETWORK* netw_ptr, LIST* routes_ptr) {
     nstrprintf(origin, "%s:" SOCKET_SIZE_FORMAT, _str(netw_ptr->link.ip), netw_ptr->link.sock);
 
     NETWORK_HTTP_INFO http_request = netw_extract_http_info(http_buffer);
+    /* the answer only references http_body, which is sent as is without being copied behind the headers */
     N_STR* http_body = NULL;
+    http_answer = new_nstr_builder(0);
+    __n_assert(http_answer, netw_info_destroy(http_request); free_nstr(&origin); return);
 
     split_results = split(url, "?", 0);
     if (!split_results || !split_results[0]) {
         http_body = char_to_nstr("<html><body><h1>Bad Request</h1></body></html>");
-        if (netw_build_http_response(&dynamic_request_answer, 400, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
+        if (netw_build_http_response_builder(http_answer, 400, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
             n_log(LOG_ERR, "couldn't build a Bad Request answer for %s", url);
         }
         n_log(LOG_ERR, "%s: %s %s 400", _nstr(origin), http_request.type, url);
@@ -295,7 +298,7 @@ void handle_request(NETWORK* netw_ptr, LIST* routes_ptr) {
         http_url = split_results[0];
         n_log(LOG_INFO, "%s: %s %s request...", _nstr(origin), http_request.type, url);
         if (strcmp("OPTIONS", http_request.type) == 0) {
-            if (netw_build_http_response(&dynamic_request_answer, 200, "ex_network_ssl server", netw_guess_http_content_type(url), "Allow: OPTIONS, GET, POST\r\n", NULL) == FALSE) {
+            if (netw_build_http_response_builder(http_answer, 200, "ex_network_ssl server", netw_guess_http_content_type(url), "Allow: OPTIONS, GET, POST\r\n", NULL) == FALSE) {
                 n_log(LOG_ERR, "couldn't build an OPTION answer for %s", url);
             }
             n_log(LOG_INFO, "%s: %s %s 200", _nstr(origin), http_request.type, url);
@@ -316,12 +319,12 @@ void handle_request(NETWORK* netw_ptr, LIST* routes_ptr) {
                 http_body = file_to_nstr(system_url);
                 if (!http_body) {
                     http_body = char_to_nstr("<html><body><h1>Internal Server Error</h1></body></html>");
-                    if (netw_build_http_response(&dynamic_request_answer, 500, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
+                    if (netw_build_http_response_builder(http_answer, 500, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
                         n_log(LOG_ERR, "couldn't build an Internal Server Error answer for %s", url);
                     }
                     n_log(LOG_ERR, "%s: %s %s 500", _nstr(origin), http_request.type, url);
                 } else {
-                    if (netw_build_http_response(&dynamic_request_answer, 200, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
+                    if (netw_build_http_response_builder(http_answer, 200, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
                         n_log(LOG_ERR, "couldn't build an http answer for %s", url);
                     }
                     n_log(LOG_INFO, "%s: %s %s 200", _nstr(origin), http_request.type, url);
@@ -336,20 +339,20 @@ void handle_request(NETWORK* netw_ptr, LIST* routes_ptr) {
                 if (stat(index_path, &idx_st) == 0 && S_ISREG(idx_st.st_mode)) {
                     char location_header[4096] = "";
                     snprintf(location_header, sizeof(location_header), "Location: %s%sindex.html\r\n", http_url, slash);
-                    if (netw_build_http_response(&dynamic_request_answer, 301, "ex_network_ssl server", "text/html", location_header, NULL) == FALSE) {
+                    if (netw_build_http_response_builder(http_answer, 301, "ex_network_ssl server", "text/html", location_header, NULL) == FALSE) {
                         n_log(LOG_ERR, "couldn't build a redirect answer for %s", url);
                     }
                     n_log(LOG_INFO, "%s: %s %s 301 -> %s%sindex.html", _nstr(origin), http_request.type, url, http_url, slash);
                 } else {
                     http_body = char_to_nstr("<html><body><h1>404 Not Found</h1></body></html>");
-                    if (netw_build_http_response(&dynamic_request_answer, 404, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
+                    if (netw_build_http_response_builder(http_answer, 404, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
                         n_log(LOG_ERR, "couldn't build a NOT FOUND answer for %s", url);
                     }
                     n_log(LOG_ERR, "%s: %s %s 404", _nstr(origin), http_request.type, url);
                 }
             } else {
                 http_body = char_to_nstr("<html><body><h1>404 Not Found</h1></body></html>");
-                if (netw_build_http_response(&dynamic_request_answer, 404, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
+                if (netw_build_http_response_builder(http_answer, 404, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
                     n_log(LOG_ERR, "couldn't build a NOT FOUND answer for %s", url);
                 }
                 n_log(LOG_ERR, "%s: %s %s 404", _nstr(origin), http_request.type, url);
@@ -369,7 +372,7 @@ void handle_request(NETWORK* netw_ptr, LIST* routes_ptr) {
                         destroy_ht(&post_data);
                     }
                     http_body = char_to_nstr("{\"status\":\"ok\"}");
-                    if (netw_build_http_response(&dynamic_request_answer, 200, "ex_network_ssl server", "application/json", "", http_body) == FALSE) {
+                    if (netw_build_http_response_builder(http_answer, 200, "ex_network_ssl server", "application/json", "", http_body) == FALSE) {
                         n_log(LOG_ERR, "couldn't build a route 200 answer for %s", url);
                     }
                     found = 1;
@@ -379,30 +382,28 @@ void handle_request(NETWORK* netw_ptr, LIST* routes_ptr) {
             }
             if (!found) {
                 http_body = char_to_nstr("<html><body><h1>404 Not Found</h1></body></html>");
-                if (netw_build_http_response(&dynamic_request_answer, 404, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
+                if (netw_build_http_response_builder(http_answer, 404, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
                     n_log(LOG_ERR, "couldn't build a NOT FOUND answer for %s", url);
                 }
                 n_log(LOG_ERR, "%s: %s %s 404", _nstr(origin), http_request.type, url);
             }
         } else {
             http_body = char_to_nstr("<html><body><h1>Bad Request</h1></body></html>");
-            if (netw_build_http_response(&dynamic_request_answer, 400, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
+            if (netw_build_http_response_builder(http_answer, 400, "ex_network_ssl server", netw_guess_http_content_type(url), "", http_body) == FALSE) {
                 n_log(LOG_ERR, "couldn't build a Bad Request answer for %s", url);
             }
             n_log(LOG_ERR, "%s: %s %s 400", _nstr(origin), http_request.type, url);
         }
         free_split_result(&split_results);
     }
-    if (dynamic_request_answer) {
-        if (dynamic_request_answer->written > UINT32_MAX) {
-            n_log(LOG_ERR, "response too large to send for %s: %s %s (size: %zu)", _nstr(origin), http_request.type, url, dynamic_request_answer->written);
-        } else if (send_ssl_data(netw_ptr, dynamic_request_answer->data, (uint32_t)dynamic_request_answer->written) < 0) {
+    if (http_answer->written > 0) {
+        if (netw_send_builder(netw_ptr, http_answer) < 0) {
             n_log(LOG_ERR, "failed to send response for %s: %s %s", _nstr(origin), http_request.type, url);
         }
-        free_nstr(&dynamic_request_answer);
     } else {
         n_log(LOG_ERR, "couldn't build an answer for %s: %s %s", _nstr(origin), http_request.type, url);
     }
+    destroy_nstr_builder(&http_answer);
     netw_info_destroy(http_request);
     free_nstr(&origin);
     free_nstr(&http_body);
@@ -26,6 +26,10 @@
 
 #include "nilorea/n_str.h"
 #include "nilorea/n_log.h"
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/stat.h>
 
 int main(void) {
     set_log_level(LOG_DEBUG);
@@ -296,5 +300,587 @@ int main(void) {
         exit(1);
     }
 
+    /* inline strings and the allocation cache */
+    int alloc_errors = 0;
+    N_STR* small = new_nstr_inline(40);
+    if (!small || !(small->flags & NSTR_INLINE) || small->data != (char*)(small + 1) || small->length < 41) {
+        n_log(LOG_ERR, "FAIL: new_nstr_inline(40) did not give an inline string");
+        alloc_errors++;
+    }
+    nstrprintf_cat(small, "%s", "short payload");
+    /* growing past the block moves the data out */
+    for (int value = 0; value < 30; value++) nstrprintf_cat(small, " %d", value);
+    if (!small || small->data == (char*)(small + 1) || strcmp(_nstr(small), "short payload 0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29") != 0) {
+        n_log(LOG_ERR, "FAIL: grown inline string is \"%s\"", small ? _nstr(small) : "NULL");
+        alloc_errors++;
+    }
+    free_nstr(&small);
+
+    small = new_nstr_inline(8);
+    nstrprintf_cat(small, "%s", "detach");
+    char* detached = nstr_detach_data(small);
+    if (!detached || strcmp(detached, "detach") != 0 || small->data != NULL) {
+        n_log(LOG_ERR, "FAIL: nstr_detach_data on an inline string");
+        alloc_errors++;
+    }
+    free(detached);
+    free_nstr(&small);
+
+    /* a freed block of a size class is handed out again, zeroed */
+    N_STR* first = new_nstr(100);
+    memset(first->data, 'x', first->length);
+    char* first_data = first->data;
+    free_nstr(&first);
+    N_STR* second = new_nstr(100);
+    if (NSTR_CACHE_MAX_BLOCKS > 0 && second->data != first_data) {
+        n_log(LOG_ERR, "FAIL: new_nstr did not reuse the cached block");
+        alloc_errors++;
+    }
+    for (size_t pos = 0; pos < second->length; pos++) {
+        if (second->data[pos] != 0) {
+            n_log(LOG_ERR, "FAIL: cached block not zeroed at %zu", pos);
+            alloc_errors++;
+            break;
+        }
+    }
+    free_nstr(&second);
+
+    /* data set by the caller is freed, not cached: the cached block stays the one handed out */
+    second = new_nstr(100);
+    uintptr_t cached_data = (uintptr_t)second->data;
+    free_nstr(&second);
+    N_STR* foreign = new_nstr(0);
+    foreign->data = malloc(128);
+    foreign->length = 128;
+    uintptr_t foreign_data = (uintptr_t)foreign->data;
+    free_nstr(&foreign);
+    second = new_nstr(100);
+    if ((uintptr_t)second->data == foreign_data || (NSTR_CACHE_MAX_BLOCKS > 0 && (uintptr_t)second->data != cached_data)) {
+        n_log(LOG_ERR, "FAIL: a caller data block went to the allocation cache");
+        alloc_errors++;
+    }
+    free_nstr(&second);
+    nstr_cache_flush();
+
+    if (alloc_errors > 0) {
+        n_log(LOG_ERR, "N_STR allocation: %d test(s) failed", alloc_errors);
+        exit(1);
+    }
+
+    /* chunked builder: printf and appends across small chunks, a referenced block, flatten and writev */
+    int builder_errors = 0;
+    N_STR_BUILDER* builder = new_nstr_builder(128);
+    N_STR* expected = new_nstr(16);
+    char ref_block[] = "[referenced block]";
+    for (int value = 0; value < 500; value++) {
+        nstr_builder_printf(builder, "%d,", value);
+        nstrprintf_cat(expected, "%d,", value);
+        if (value % 50 == 0) {
+            nstr_builder_append(builder, "0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz", 144);
+            nstrcat_bytes(expected, "0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz");
+        }
+        if (value % 100 == 0) {
+            nstr_builder_append_ref(builder, ref_block, strlen(ref_block));
+            nstrcat_bytes(expected, ref_block);
+        }
+    }
+    if (builder->written != expected->written || builder->nb_chunks < 2) {
+        n_log(LOG_ERR, "FAIL: builder holds %zu bytes in %zu chunks, expected %zu bytes", builder->written, builder->nb_chunks, expected->written);
+        builder_errors++;
+    }
+    n_log(LOG_INFO, "builder: %zu bytes in %zu chunks", builder->written, builder->nb_chunks);
+    N_STR* flat = nstr_builder_to_nstr(builder);
+    if (!flat || flat->written != expected->written || strcmp(flat->data, expected->data) != 0) {
+        n_log(LOG_ERR, "FAIL: nstr_builder_to_nstr content differs");
+        builder_errors++;
+    }
+    free_nstr(&flat);
+
+    int pipe_fd[2];
+    if (pipe(pipe_fd) == 0) {
+        ssize_t sent = nstr_builder_write_fd(builder, pipe_fd[1]);
+        close(pipe_fd[1]);
+        N_STR* received = new_nstr(expected->written + 1);
+        ssize_t got = 0;
+        while ((got = read(pipe_fd[0], received->data + received->written, received->length - received->written - 1)) > 0)
+            received->written += (size_t)got;
+        close(pipe_fd[0]);
+        if (sent != (ssize_t)expected->written || received->written != expected->written || memcmp(received->data, expected->data, expected->written) != 0) {
+            n_log(LOG_ERR, "FAIL: nstr_builder_write_fd wrote %zd bytes, read %zu, expected %zu", sent, received->written, expected->written);
+            builder_errors++;
+        }
+        free_nstr(&received);
+    }
+
+    nstr_builder_empty(builder);
+    nstr_builder_printf(builder, "%s", "again");
+    flat = nstr_builder_to_nstr(builder);
+    if (!flat || strcmp(flat->data, "again") != 0 || builder->nb_chunks != 1) {
+        n_log(LOG_ERR, "FAIL: builder reuse after nstr_builder_empty");
+        builder_errors++;
+    }
+    free_nstr(&flat);
+    free_nstr(&expected);
+    destroy_nstr_builder(&builder);
+    nstr_cache_flush();
+
+    if (builder_errors > 0) {
+        n_log(LOG_ERR, "N_STR builder: %d test(s) failed", builder_errors);
+        exit(1);
+    }
+
+    /* string kernels: every SIMD level must give the scalar results */
+    int kernel_errors = 0;
+    char* sample = NULL;
+    Malloc(sample, char, 1001);
+    for (size_t pos = 0; pos < 1000; pos++) {
+        const char alphabet[] = "aZ09 ,;:./-_\tzA|&\\mM";
+        sample[pos] = alphabet[(pos * 7 + pos / 13) % (sizeof(alphabet) - 1)];
+        /* a few non ASCII bytes, their blocks take the locale path */
+        if (pos % 150 == 0)
+            sample[pos] = (char)0xe9;
+    }
+    char* expected_up = NULL;
+    char* expected_lo = NULL;
+    char* expected_clean = NULL;
+    Malloc(expected_up, char, 1001);
+    Malloc(expected_lo, char, 1001);
+    Malloc(expected_clean, char, 1001);
+    for (size_t pos = 0; pos < 1000; pos++) {
+        expected_up[pos] = (char)toupper((unsigned char)sample[pos]);
+        expected_lo[pos] = (char)tolower((unsigned char)sample[pos]);
+        expected_clean[pos] = strchr(";|&\\", sample[pos]) ? '_' : sample[pos];
+    }
+    for (int level = NSTR_SIMD_NONE; level <= NSTR_SIMD_AVX2; level++) {
+        if (nstr_set_simd_level(level) != level)
+            continue;
+        char* buffer = NULL;
+        Malloc(buffer, char, 1001);
+        strup(sample, buffer);
+        if (strcmp(buffer, expected_up) != 0) {
+            n_log(LOG_ERR, "FAIL: strup differs at SIMD level %d", level);
+            kernel_errors++;
+        }
+        strlo(sample, buffer);
+        if (strcmp(buffer, expected_lo) != 0) {
+            n_log(LOG_ERR, "FAIL: strlo differs at SIMD level %d", level);
+            kernel_errors++;
+        }
+        memcpy(buffer, sample, 1001);
+        str_sanitize(buffer, ";|&\\", '_');
+        if (strcmp(buffer, expected_clean) != 0) {
+            n_log(LOG_ERR, "FAIL: str_sanitize differs at SIMD level %d", level);
+            kernel_errors++;
+        }
+        Free(buffer);
+    }
+    n_log(LOG_INFO, "string kernels SIMD level: %d", nstr_set_simd_level(NSTR_SIMD_AVX2));
+    Free(sample);
+    Free(expected_up);
+    Free(expected_lo);
+    Free(expected_clean);
+
+    char* replace_result = str_replace("aaa-bb-aaaa", "aa", "X");
+    if (!replace_result || strcmp(replace_result, "Xa-bb-XX") != 0) {
+        n_log(LOG_ERR, "FAIL: str_replace shrinking gave %s", _str(replace_result));
+        kernel_errors++;
+    }
+    FreeNoLog(replace_result);
+    replace_result = str_replace("a,b,,c", ",", "<->");
+    if (!replace_result || strcmp(replace_result, "a<->b<-><->c") != 0) {
+        n_log(LOG_ERR, "FAIL: str_replace growing gave %s", _str(replace_result));
+        kernel_errors++;
+    }
+    FreeNoLog(replace_result);
+
+    const char* csv = "one::two::::three::";
+    N_STR_SPAN spans[8];
+    size_t nb_spans = split_spans(csv, strlen(csv), "::", 0, spans, 8);
+    if (nb_spans != 3 || spans[1].offset != 5 || spans[1].length != 3 || spans[2].offset != 12 || spans[2].length != 5) {
+        n_log(LOG_ERR, "FAIL: split_spans gave %zu spans", nb_spans);
+        kernel_errors++;
+    }
+    nb_spans = split_spans(csv, strlen(csv), "::", 1, spans, 2);
+    if (nb_spans != 5 || spans[0].length != 3 || spans[1].length != 3) {
+        n_log(LOG_ERR, "FAIL: split_spans with empty sections gave %zu spans", nb_spans);
+        kernel_errors++;
+    }
+    char** sections = split(csv, "::", 1);
+    if (!sections || split_count(sections) != 5 || strcmp(sections[2], "") != 0 || strcmp(sections[3], "three") != 0 || strcmp(sections[4], "") != 0) {
+        n_log(LOG_ERR, "FAIL: split with empty sections");
+        kernel_errors++;
+    }
+    free_split_result(&sections);
+
+    NSTRBYTE position = 2;
+    if (skipu("key=value", '=', &position, 1) != TRUE || position != 3) {
+        n_log(LOG_ERR, "FAIL: skipu found '=' at %zu", position);
+        kernel_errors++;
+    }
+    if (skipu("key=value", '#', &position, 1) != FALSE || position != 10) {
+        n_log(LOG_ERR, "FAIL: skipu past the end stopped at %zu", position);
+        kernel_errors++;
+    }
+
+    if (kernel_errors > 0) {
+        n_log(LOG_ERR, "string kernels: %d test(s) failed", kernel_errors);
+        exit(1);
+    }
+
+    /* mapped files and line reader */
+    int file_errors = 0;
+    const char* lines_file = "nilorea_nstr_lines.txt";
+    N_STR* lines = new_nstr(8192);
+    for (int value = 0; lines->written < 4096; value++) {
+        nstrprintf_cat(lines, "line %d%s\n", value, (value % 10 == 0) ? " is longer than the reader buffer" : "");
+    }
+    /* a file filling exactly its last page, without ending delimiter */
+    lines->written = 4096;
+    lines->data[4095] = 'x';
+    lines->data[4096] = '\0';
+    nstr_to_file(lines, (char*)lines_file);
+
+    N_STR* mapped = n_file_map(lines_file);
+    if (!mapped || mapped->written != lines->written || strcmp(mapped->data, lines->data) != 0) {
+        n_log(LOG_ERR, "FAIL: n_file_map content differs");
+        file_errors++;
+    }
+    if (mapped && !nstrcat_bytes(mapped, "+tail")) {
+        n_log(LOG_ERR, "FAIL: nstrcat on a mapped file");
+        file_errors++;
+    }
+    if (mapped && (mapped->flags & NSTR_MAPPED || mapped->written != lines->written + 5 || strcmp(mapped->data + lines->written, "+tail") != 0)) {
+        n_log(LOG_ERR, "FAIL: mapped string not moved to the heap when growing");
+        file_errors++;
+    }
+    if (mapped)
+        n_file_unmap(&mapped);
+
+    /* in place writers change the private mapping, never the file */
+    const char* cr_file = "nilorea_nstr_cr.txt";
+    N_STR* cr_content = char_to_nstr("line\r");
+    nstr_to_file(cr_content, (char*)cr_file);
+    mapped = n_file_map(cr_file);
+    if (mapped) {
+        n_remove_ending_cr(mapped);
+    }
+    if (!mapped || !(mapped->flags & NSTR_MAPPED) || mapped->written != 4 || strcmp(mapped->data, "line") != 0) {
+        n_log(LOG_ERR, "FAIL: n_remove_ending_cr on a mapped file");
+        file_errors++;
+    }
+    if (mapped)
+        n_file_unmap(&mapped);
+    mapped = file_to_nstr((char*)cr_file);
+    if (!mapped || strcmp(mapped->data, cr_content->data) != 0) {
+        n_log(LOG_ERR, "FAIL: writing to a mapped string changed the file");
+        file_errors++;
+    }
+    if (mapped)
+        free_nstr(&mapped);
+    free_nstr(&cr_content);
+    unlink(cr_file);
+
+    N_LINE_READER* reader = open_line_reader(lines_file, 16, '\n');
+    char* line = NULL;
+    size_t line_len = 0;
+    size_t offset = 0;
+    while (reader && line_reader_next(reader, &line, &line_len)) {
+        if (offset + line_len > lines->written || memcmp(line, lines->data + offset, line_len) != 0 || line[line_len] != '\0') {
+            n_log(LOG_ERR, "FAIL: line %zu differs", reader->line_number);
+            file_errors++;
+            break;
+        }
+        offset += line_len + 1;
+    }
+    if (!reader || reader->error || offset != lines->written + 1) {
+        n_log(LOG_ERR, "FAIL: line reader stopped at offset %zu of %zu", offset, lines->written);
+        file_errors++;
+    }
+    if (reader)
+        destroy_line_reader(&reader);
+    free_nstr(&lines);
+    unlink(lines_file);
+
+    if (file_errors > 0) {
+        n_log(LOG_ERR, "mapped files and line reader: %d test(s) failed", file_errors);
+        exit(1);
+    }
+
+    /* compiled patterns against wildmat and wildmatcase */
+    int glob_errors = 0;
+    const char* glob_patterns[] = {"", "*", "**", "?", "a", "A", "abc", "a*", "*c", "a*c", "a*b*c", "*a*", "a?c", "?*?",
+                                   "[abc]", "[^abc]*", "[a-c]*[x-z]", "[]a]*", "[-a]?", "[a-]", "*[!-/]", "\\*", "a\\?c", "\\",
+                                   "*.txt", "*/ex_*.c", "*.[cChH]", "*ab*ab*", "[", "*\xe9*", "[\xe0-\xef]*"};
+    const char* glob_texts[] = {"", "a", "A", "b", "abc", "ABC", "aXc", "aaabbbccc", "*", "a?c", "]", "-", "a-", "x",
+                                "file.txt", "dir/file.TXT", "src/ex_nstr.c", "n_str.H", "ababab", "abab", "/", "!",
+                                "za", "azx", "zzz", "\\", "caf\xe9", "\xe9t\xe9"};
+    char long_pattern[2 * N_GLOB_MAX_TOKENS + 4] = {0};
+    for (size_t glob_it = 0; glob_it < 2 * N_GLOB_MAX_TOKENS; glob_it++) long_pattern[glob_it] = (glob_it % 2) ? '*' : 'a';
+    char long_text[N_GLOB_MAX_TOKENS + 2] = {0};
+    memset(long_text, 'a', N_GLOB_MAX_TOKENS + 1);
+    size_t nb_glob_patterns = sizeof(glob_patterns) / sizeof(glob_patterns[0]);
+    size_t nb_glob_texts = sizeof(glob_texts) / sizeof(glob_texts[0]);
+    for (size_t pattern_it = 0; pattern_it <= nb_glob_patterns; pattern_it++) {
+        const char* pattern = (pattern_it < nb_glob_patterns) ? glob_patterns[pattern_it] : long_pattern;
+        N_GLOB* glob = n_glob_compile(pattern, 0);
+        N_GLOB* glob_case = n_glob_compile(pattern, N_GLOB_CASELESS);
+        for (size_t text_it = 0; text_it <= nb_glob_texts; text_it++) {
+            const char* text = (text_it < nb_glob_texts) ? glob_texts[text_it] : long_text;
+            int expected_match = (wildmat(text, pattern) == TRUE) ? TRUE : FALSE;
+            int expected_case = (wildmatcase(text, pattern) == TRUE) ? TRUE : FALSE;
+            if (!glob || n_glob_match(glob, text) != expected_match) {
+                n_log(LOG_ERR, "FAIL: n_glob_match(\"%s\", \"%s\") != %d", pattern, text, expected_match);
+                glob_errors++;
+            }
+            if (!glob_case || n_glob_match(glob_case, text) != expected_case) {
+                n_log(LOG_ERR, "FAIL: caseless n_glob_match(\"%s\", \"%s\") != %d", pattern, text, expected_case);
+                glob_errors++;
+            }
+        }
+        if (glob)
+            n_glob_delete(&glob);
+        if (glob_case)
+            n_glob_delete(&glob_case);
+    }
+
+    const char* scan_root = "nilorea_nstr_scan";
+    mkdir(scan_root, 0755);
+    mkdir("nilorea_nstr_scan/sub", 0755);
+    const char* scan_files[] = {"nilorea_nstr_scan/a.txt", "nilorea_nstr_scan/b.TXT", "nilorea_nstr_scan/c.log", "nilorea_nstr_scan/sub/d.txt"};
+    for (size_t glob_it = 0; glob_it < sizeof(scan_files) / sizeof(scan_files[0]); glob_it++) {
+        FILE* out = fopen(scan_files[glob_it], "w");
+        if (out)
+            fclose(out);
+    }
+    LIST* found = new_generic_list(UNLIMITED_LIST_ITEMS);
+    if (scan_dir_ex(scan_root, "*.txt", found, TRUE, 1) != TRUE || found->nb_items != 3) {
+        n_log(LOG_ERR, "FAIL: scan_dir_ex found %zu *.txt files instead of 3", found->nb_items);
+        glob_errors++;
+    }
+    list_foreach(node, found) {
+        N_STR* file = (N_STR*)node->ptr;
+        if (strncmp(file->data, "nilorea_nstr_scan/", 18) != 0 || file->written != strlen(file->data)) {
+            n_log(LOG_ERR, "FAIL: scan_dir_ex result %s", _nstr(file));
+            glob_errors++;
+        }
+    }
+    list_destroy(&found);
+    for (size_t glob_it = 0; glob_it < sizeof(scan_files) / sizeof(scan_files[0]); glob_it++) unlink(scan_files[glob_it]);
+    rmdir("nilorea_nstr_scan/sub");
+    rmdir(scan_root);
+
+    if (glob_errors > 0) {
+        n_log(LOG_ERR, "compiled patterns: %d test(s) failed", glob_errors);
+        exit(1);
+    }
+
+    /* number formatting and parsing against the C library */
+    int number_errors = 0;
+    int64_t signed_samples[] = {0, 1, -1, 9, 10, -10, 99, 100, 12345, -987654321, INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN};
+    N_STR* numbers = NULL;
+    char expected_number[64] = "";
+    for (size_t number_it = 0; number_it < sizeof(signed_samples) / sizeof(signed_samples[0]); number_it++) {
+        if (numbers)
+            numbers->written = 0;
+        snprintf(expected_number, sizeof(expected_number), "%" PRId64, signed_samples[number_it]);
+        int64_t parsed_i64 = 0;
+        if (!n_nstr_cat_i64(&numbers, signed_samples[number_it]) || strcmp(numbers->data, expected_number) != 0 || numbers->written != strlen(expected_number) ||
+            n_str_span_to_i64(numbers->data, numbers->written, 10, &parsed_i64, NULL) == FALSE || parsed_i64 != signed_samples[number_it]) {
+            n_log(LOG_ERR, "FAIL: n_nstr_cat_i64 %s gave %s", expected_number, _nstr(numbers));
+            number_errors++;
+        }
+    }
+    uint64_t unsigned_samples[] = {0, 7, 42, 1000, 4294967296ULL, 10000000000000000000ULL, UINT64_MAX};
+    for (size_t number_it = 0; number_it < sizeof(unsigned_samples) / sizeof(unsigned_samples[0]); number_it++) {
+        numbers->written = 0;
+        snprintf(expected_number, sizeof(expected_number), "%" PRIu64, unsigned_samples[number_it]);
+        uint64_t parsed_u64 = 0;
+        if (!n_nstr_cat_u64(&numbers, unsigned_samples[number_it]) || strcmp(numbers->data, expected_number) != 0 ||
+            n_str_span_to_u64(numbers->data, numbers->written, 0, &parsed_u64, NULL) == FALSE || parsed_u64 != unsigned_samples[number_it]) {
+            n_log(LOG_ERR, "FAIL: n_nstr_cat_u64 %s gave %s", expected_number, _nstr(numbers));
+            number_errors++;
+        }
+    }
+    /* appending many numbers */
+    numbers->written = 0;
+    for (int64_t value = -500; value < 500; value++) {
+        n_nstr_cat_i64(&numbers, value);
+        nstrcat_bytes(numbers, ",");
+    }
+    size_t number_position = 0;
+    for (int64_t value = -500; value < 500; value++) {
+        int64_t parsed_i64 = 0;
+        size_t parsed_len = 0;
+        if (n_str_span_to_i64(numbers->data + number_position, numbers->written - number_position, 10, &parsed_i64, &parsed_len) == FALSE || parsed_i64 != value || numbers->data[number_position + parsed_len] != ',') {
+            n_log(LOG_ERR, "FAIL: reading back %" PRId64 " at %zu", value, number_position);
+            number_errors++;
+            break;
+        }
+        number_position += parsed_len + 1;
+    }
+
+    const char* double_texts[][2] = {{"0.1", "0.1"}, {"12.5", "12.5"}, {"-0", "-0"}, {"123", "123"}, {"1e20", "1e+20"}, {"0.000123", "0.000123"}, {"3.141592653589793", "3.141592653589793"}, {"1e-7", "1e-07"}};
+    for (size_t number_it = 0; number_it < sizeof(double_texts) / sizeof(double_texts[0]); number_it++) {
+        numbers->written = 0;
+        double value = strtod(double_texts[number_it][0], NULL);
+        if (!n_nstr_cat_double(&numbers, value) || strcmp(numbers->data, double_texts[number_it][1]) != 0) {
+            n_log(LOG_ERR, "FAIL: n_nstr_cat_double %s gave %s", double_texts[number_it][1], _nstr(numbers));
+            number_errors++;
+        }
+    }
+    srand(42);
+    for (int number_it = 0; number_it < 20000; number_it++) {
+        double value = 0;
+        if (number_it % 2) {
+            uint64_t bits = ((uint64_t)rand() << 40) ^ ((uint64_t)rand() << 20) ^ (uint64_t)rand();
+            /* powers of two, whose interval is wider above the value */
+            if (number_it % 6 == 1)
+                bits &= ~((1ULL << 52) - 1);
+            memcpy(&value, &bits, sizeof(value));
+            if (isnan(value) || isinf(value) || value == 0)
+                continue;
+        } else {
+            value = (double)(rand() % 2000000 - 1000000) / (double)(1 + rand() % 10000);
+        }
+        char text[NSTR_DOUBLE_MAX_LEN + 1] = "";
+        size_t text_len = n_double_to_chars(value, text);
+        double parsed_double = 0;
+        /* shortest length: the first precision whose %g reads back, or one less when the next decimal up does, above a power of two */
+        char shortest[32] = "";
+        size_t shortest_digits = 1;
+        for (; shortest_digits < 17; shortest_digits++) {
+            snprintf(shortest, sizeof(shortest), "%.*g", (int)shortest_digits, value);
+            if (strtod(shortest, NULL) == value)
+                break;
+        }
+        if (shortest_digits > 1) {
+            char rounded_up[32] = "";
+            snprintf(rounded_up, sizeof(rounded_up), "%.*e", (int)shortest_digits - 2, fabs(value));
+            uint64_t mantissa = 0;
+            char* mantissa_it = rounded_up;
+            for (; *mantissa_it != 'e'; mantissa_it++) {
+                if (*mantissa_it != '.')
+                    mantissa = mantissa * 10 + (uint64_t)(*mantissa_it - '0');
+            }
+            snprintf(rounded_up, sizeof(rounded_up), "%" PRIu64 "e%d", mantissa + 1, atoi(mantissa_it + 1) - ((int)shortest_digits - 2));
+            if (strtod(rounded_up, NULL) == fabs(value))
+                shortest_digits--;
+        }
+        if (strtod(text, NULL) != value || n_str_span_to_double(text, text_len, &parsed_double, NULL) == FALSE || parsed_double != value) {
+            n_log(LOG_ERR, "FAIL: %s does not read back as %.17g", text, value);
+            number_errors++;
+        }
+        /* significant digits, without the sign, the point, the exponent and the zeros around */
+        const char* digit_first = text;
+        const char* digit_last = text;
+        while (*digit_last && *digit_last != 'e') digit_last++;
+        while (*digit_first == '-' || *digit_first == '0' || *digit_first == '.') digit_first++;
+        while (digit_last > digit_first && (digit_last[-1] == '0' || digit_last[-1] == '.')) digit_last--;
+        size_t digits = 0;
+        for (; digit_first < digit_last; digit_first++) digits += (*digit_first != '.') ? 1 : 0;
+        if (digits != shortest_digits) {
+            n_log(LOG_ERR, "FAIL: %s has %zu digits, the shortest has %zu (%s)", text, digits, shortest_digits, shortest);
+            number_errors++;
+        }
+    }
+
+    const char* parse_texts[] = {"42", "  -17xyz", "+8", "0x1F", "0x", "077", "9223372036854775807", "9223372036854775808", "-9223372036854775808",
+                                 "-9223372036854775809", "18446744073709551615", "18446744073709551616", "", "-", " ", "12 ", "1.5e3", ".5", "5.", "1e", "1e+",
+                                 "-0.0", "inf", "-nan", "0x1p4", "1e400", "1e-400", "123456789012345678901234567890", "0.1234567890123456789012", "2.2250738585072014e-308"};
+    for (size_t number_it = 0; number_it < sizeof(parse_texts) / sizeof(parse_texts[0]); number_it++) {
+        const char* text = parse_texts[number_it];
+        size_t text_len = strlen(text);
+        for (int base_it = 0; base_it < 3; base_it++) {
+            int base = (base_it == 0) ? 10 : (base_it == 1) ? 16 : 0;
+            char* endstr = NULL;
+            errno = 0;
+            long long expected_ll = strtoll(text, &endstr, base);
+            int expected_ok = (endstr != text && errno != ERANGE) ? TRUE : FALSE;
+            int64_t parsed_i64 = 0;
+            size_t parsed_len = 0;
+            int ok = n_str_span_to_i64(text, text_len, base, &parsed_i64, &parsed_len);
+            if (ok != expected_ok || (ok && (parsed_i64 != expected_ll || parsed_len != (size_t)(endstr - text)))) {
+                n_log(LOG_ERR, "FAIL: n_str_span_to_i64(\"%s\", %d)", text, base);
+                number_errors++;
+            }
+            errno = 0;
+            unsigned long long expected_ull = strtoull(text, &endstr, base);
+            const char* sign = text;
+            while (isspace((unsigned char)*sign)) sign++;
+            expected_ok = (endstr != text && errno != ERANGE && *sign != '-') ? TRUE : FALSE;
+            uint64_t parsed_u64 = 0;
+            ok = n_str_span_to_u64(text, text_len, base, &parsed_u64, &parsed_len);
+            if (ok != expected_ok || (ok && (parsed_u64 != expected_ull || parsed_len != (size_t)(endstr - text)))) {
+                n_log(LOG_ERR, "FAIL: n_str_span_to_u64(\"%s\", %d)", text, base);
+                number_errors++;
+            }
+        }
+        char* endstr = NULL;
+        errno = 0;
+        double expected_double = strtod(text, &endstr);
+        int expected_ok = (endstr != text && !(errno == ERANGE && isinf(expected_double))) ? TRUE : FALSE;
+        double parsed_double = 0;
+        size_t parsed_len = 0;
+        int ok = n_str_span_to_double(text, text_len, &parsed_double, &parsed_len);
+        if (ok != expected_ok || (ok && (parsed_len != (size_t)(endstr - text) || (memcmp(&parsed_double, &expected_double, sizeof(double)) != 0 && !isnan(expected_double))))) {
+            n_log(LOG_ERR, "FAIL: n_str_span_to_double(\"%s\")", text);
+            number_errors++;
+        }
+    }
+    /* spans are not terminated */
+    int64_t span_value = 0;
+    if (n_str_span_to_i64("12345", 3, 10, &span_value, NULL) == FALSE || span_value != 123)
+        number_errors++;
+    double span_double = 0;
+    if (n_str_span_to_double("2.5e10", 3, &span_double, NULL) == FALSE || span_double != 2.5)
+        number_errors++;
+    if (n_str_span_to_i64("12x", 3, 10, &span_value, NULL) == TRUE)
+        number_errors++;
+    /* a hexadecimal number at the start of a long span */
+    char long_span[4096];
+    memset(long_span, '7', sizeof(long_span));
+    memcpy(long_span, "0x10, inf", 9);
+    size_t span_parsed = 0;
+    if (n_str_span_to_double(long_span, sizeof(long_span), &span_double, &span_parsed) == FALSE || span_double != 16 || span_parsed != 4)
+        number_errors++;
+
+    int int_value = 0;
+    long int long_value = 0;
+    long long int long_long_value = 0;
+    if (str_to_int("123\n", &int_value, 10) == FALSE || int_value != 123 || str_to_int("12x", &int_value, 10) == TRUE || str_to_int("2147483648", &int_value, 10) == TRUE ||
+        str_to_int("-2147483648", &int_value, 10) == FALSE || int_value != INT_MIN || str_to_int("", &int_value, 10) == FALSE || int_value != 0)
+        number_errors++;
+    if (str_to_long_ex("ab-123cd", 2, 8, &long_value, 10) == FALSE || long_value != -123 || str_to_long("cd", &long_value, 10) == TRUE ||
+        str_to_long_long("99999999999999999999", &long_long_value, 10) == TRUE || str_to_long_long("-0x10", &long_long_value, 16) == FALSE || long_long_value != -16)
+        number_errors++;
+
+    /* formatting in place, growing, and on a mapped file */
+    N_STR* formatted = new_nstr(8);
+    if (!nstrprintf(formatted, "%d", 12) || strcmp(formatted->data, "12") != 0 || !nstrprintf(formatted, "%s-%d", "a longer text", 34) || strcmp(formatted->data, "a longer text-34") != 0 ||
+        !nstrprintf_cat(formatted, "+%d", 5) || strcmp(formatted->data, "a longer text-34+5") != 0 || formatted->written != 18)
+        number_errors++;
+    free_nstr(&formatted);
+    const char* mapped_file = "nilorea_nstr_numbers.txt";
+    N_STR* mapped_content = char_to_nstr("mapped file content");
+    nstr_to_file(mapped_content, (char*)mapped_file);
+    free_nstr(&mapped_content);
+    formatted = n_file_map(mapped_file);
+    if (!formatted || !nstrprintf(formatted, "%d", 7) || strcmp(formatted->data, "7") != 0)
+        number_errors++;
+    if (formatted)
+        free_nstr(&formatted);
+    formatted = n_file_map(mapped_file);
+    if (!formatted || !nstrprintf_cat(formatted, "%d", 7) || strcmp(formatted->data, "mapped file content7") != 0)
+        number_errors++;
+    if (formatted)
+        free_nstr(&formatted);
+    unlink(mapped_file);
+    free_nstr(&numbers);
+
+    if (number_errors > 0) {
+        n_log(LOG_ERR, "number formatting and parsing: %d test(s) failed", number_errors);
+        exit(1);
+    }
+
     exit(0);
 }
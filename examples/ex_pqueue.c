@@ -0,0 +1,236 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ *@example ex_pqueue.c
+ *@brief Nilorea Library priority queue API
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+#include "nilorea/n_str.h"
+#include "nilorea/n_pqueue.h"
+
+/*! number of values destroyed by the queue */
+static size_t nb_destroyed = 0;
+
+/**
+ *@brief value destructor counting its calls
+ *@param ptr value to free
+ */
+static void destroy_value(void* ptr) {
+    nb_destroyed++;
+    Free(ptr);
+}
+
+/**
+ *@brief allocate a value holding its key
+ *@param key key of the value
+ *@return the new value
+ */
+static void* new_value(int64_t key) {
+    int64_t* value = NULL;
+    Malloc(value, int64_t, 1);
+    __n_assert(value, exit(1));
+    (*value) = key;
+    return value;
+}
+
+void usage(void) {
+    fprintf(stderr,
+            "     -v version\n"
+            "     -V log level: LOG_INFO, LOG_NOTICE, LOG_ERR, LOG_DEBUG\n"
+            "     -h help\n");
+}
+
+void process_args(int argc, char** argv) {
+    int getoptret = 0,
+        log_level = LOG_DEBUG; /* default log level */
+
+    /* Arguments optionnels */
+    /* -v version
+     * -V log level
+     * -h help
+     */
+    while ((getoptret = getopt(argc, argv, "hvV:")) != EOF) {
+        switch (getoptret) {
+            case 'v':
+                fprintf(stderr, "Date de compilation : %s a %s.\n", __DATE__, __TIME__);
+                exit(1);
+            case 'V':
+                if (!strcmp("LOG_NULL", optarg))
+                    log_level = LOG_NULL;
+                else if (!strcmp("LOG_NOTICE", optarg))
+                    log_level = LOG_NOTICE;
+                else if (!strcmp("LOG_INFO", optarg))
+                    log_level = LOG_INFO;
+                else if (!strcmp("LOG_ERR", optarg))
+                    log_level = LOG_ERR;
+                else if (!strcmp("LOG_DEBUG", optarg))
+                    log_level = LOG_DEBUG;
+                else {
+                    fprintf(stderr, "%s n'est pas un niveau de log valide.\n", optarg);
+                    exit(-1);
+                }
+                break;
+            default:
+            case '?': {
+                if (optopt == 'V') {
+                    fprintf(stderr, "\n      Missing log level\n");
+                } else if (optopt == 'p') {
+                    fprintf(stderr, "\n      Missing port\n");
+                } else if (optopt != 's') {
+                    fprintf(stderr, "\n      Unknow missing option %c\n", optopt);
+                }
+                usage();
+                exit(1);
+            }
+            case 'h': {
+                usage();
+                exit(1);
+            }
+        }
+    }
+    set_log_level(log_level);
+} /* void process_args( ... ) */
+
+/*! number of items queued by the tests */
+#define NB_ITEMS 50000
+
+/**
+ *@brief pop everything from a queue, checking that keys come out in increasing order and match their value
+ *@param pq queue to drain
+ *@param expected number of items expected in the queue
+ *@return the number of errors
+ */
+int drain(PQUEUE* pq, size_t expected) {
+    int errors = 0;
+    int64_t previous = INT64_MIN;
+    int64_t key = 0;
+    void* value = NULL;
+    size_t nb = 0;
+    while (pqueue_pop(pq, &key, &value) == TRUE) {
+        if (key < previous || *(int64_t*)value != key)
+            errors++;
+        previous = key;
+        Free(value);
+        nb++;
+    }
+    if (nb != expected || pq->nb_items != 0)
+        errors++;
+    return errors;
+}
+
+int main(int argc, char** argv) {
+    set_log_level(LOG_INFO);
+
+    /* processing args and set log_level */
+    process_args(argc, argv);
+
+    int errors = 0;
+    size_t arities[3] = {2, 0, 8};
+    size_t* handles = NULL;
+    Malloc(handles, size_t, NB_ITEMS);
+    __n_assert(handles, exit(1));
+
+    for (int test = 0; test < 3; test++) {
+        /* start tiny so the queue has to grow */
+        PQUEUE* pq = new_pqueue(arities[test], 1, destroy_value);
+        for (int64_t it = 0; it < NB_ITEMS; it++) {
+            /* keys spread and duplicated, 7919 being prime with NB_ITEMS */
+            int64_t key = (it * 7919) % NB_ITEMS / 2;
+            handles[it] = pqueue_push(pq, key, new_value(key));
+            if (handles[it] == PQUEUE_NO_HANDLE)
+                errors++;
+        }
+        int64_t key = 0;
+        void* value = NULL;
+        if (pqueue_peek(pq, &key, NULL) == FALSE || key != 0)
+            errors++;
+
+        /* move a tenth of the items ahead, like a shorter path found to an open node */
+        for (int64_t it = 0; it < NB_ITEMS; it += 10) {
+            if (pqueue_get(pq, handles[it], &key, &value) == FALSE)
+                errors++;
+            int64_t lower = key - 1000;
+            *(int64_t*)value = lower;
+            if (pqueue_decrease_key(pq, handles[it], lower) == FALSE)
+                errors++;
+        }
+        /* increases are refused by decrease-key, accepted by update-key */
+        pqueue_get(pq, handles[1], &key, &value);
+        if (pqueue_decrease_key(pq, handles[1], key + 1) == TRUE)
+            errors++;
+        *(int64_t*)value = key + NB_ITEMS;
+        if (pqueue_update_key(pq, handles[1], key + NB_ITEMS) == FALSE)
+            errors++;
+
+        /* remove a few items from the middle of the heap */
+        nb_destroyed = 0;
+        for (int64_t it = 5; it < NB_ITEMS; it += 10) {
+            if (pqueue_remove(pq, handles[it]) == FALSE)
+                errors++;
+        }
+        if (pqueue_remove(pq, handles[5]) == TRUE || nb_destroyed != NB_ITEMS / 10)
+            errors++;
+        if (pqueue_peek(pq, &key, NULL) == FALSE || key != -1000)
+            errors++;
+
+        errors += drain(pq, NB_ITEMS - NB_ITEMS / 10);
+        if (pqueue_pop(pq, &key, &value) == TRUE || pqueue_get(pq, handles[0], &key, NULL) == TRUE)
+            errors++;
+
+        /* bulk heapify into the empty queue, then a smaller batch on top of it */
+        int64_t* keys = NULL;
+        void** values = NULL;
+        Malloc(keys, int64_t, NB_ITEMS);
+        Malloc(values, void*, NB_ITEMS);
+        __n_assert(keys && values, exit(1));
+        for (int64_t it = 0; it < NB_ITEMS; it++) {
+            keys[it] = (it * 104729) % NB_ITEMS;
+            values[it] = new_value(keys[it]);
+        }
+        if (pqueue_heapify(pq, keys, values, NB_ITEMS - 100, handles) == FALSE)
+            errors++;
+        if (pqueue_heapify(pq, &keys[NB_ITEMS - 100], &values[NB_ITEMS - 100], 100, NULL) == FALSE)
+            errors++;
+        if (pqueue_get(pq, handles[42], &key, &value) == FALSE || key != keys[42] || value != values[42])
+            errors++;
+        errors += drain(pq, NB_ITEMS);
+        Free(keys);
+        Free(values);
+
+        pqueue_push(pq, 1, new_value(1));
+        nb_destroyed = 0;
+        destroy_pqueue(&pq);
+        if (pq != NULL || nb_destroyed != 1)
+            errors++;
+    }
+    Free(handles);
+
+    n_log(LOG_INFO, "pqueue test: %d errors", errors);
+    exit(errors == 0 ? 0 : 1);
+}
@@ -0,0 +1,349 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ *@example ex_skiplist.c
+ *@brief Nilorea Library lock free skip list map API
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+#include "nilorea/n_str.h"
+#include "nilorea/n_skiplist.h"
+
+/*! number of values destroyed by the skip list */
+static size_t nb_destroyed = 0;
+
+/**
+ *@brief value destructor counting its calls, from any thread
+ *@param ptr value to free
+ */
+static void destroy_value(void* ptr) {
+    __atomic_add_fetch(&nb_destroyed, 1, __ATOMIC_RELAXED);
+    Free(ptr);
+}
+
+/**
+ *@brief allocate a value holding its key
+ *@param key key of the value
+ *@return the new value
+ */
+static void* new_value(int64_t key) {
+    int64_t* value = NULL;
+    Malloc(value, int64_t, 1);
+    __n_assert(value, exit(1));
+    (*value) = key;
+    return value;
+}
+
+void usage(void) {
+    fprintf(stderr,
+            "     -v version\n"
+            "     -V log level: LOG_INFO, LOG_NOTICE, LOG_ERR, LOG_DEBUG\n"
+            "     -h help\n");
+}
+
+void process_args(int argc, char** argv) {
+    int getoptret = 0,
+        log_level = LOG_DEBUG; /* default log level */
+
+    /* Arguments optionnels */
+    /* -v version
+     * -V log level
+     * -h help
+     */
+    while ((getoptret = getopt(argc, argv, "hvV:")) != EOF) {
+        switch (getoptret) {
+            case 'v':
+                fprintf(stderr, "Date de compilation : %s a %s.\n", __DATE__, __TIME__);
+                exit(1);
+            case 'V':
+                if (!strcmp("LOG_NULL", optarg))
+                    log_level = LOG_NULL;
+                else if (!strcmp("LOG_NOTICE", optarg))
+                    log_level = LOG_NOTICE;
+                else if (!strcmp("LOG_INFO", optarg))
+                    log_level = LOG_INFO;
+                else if (!strcmp("LOG_ERR", optarg))
+                    log_level = LOG_ERR;
+                else if (!strcmp("LOG_DEBUG", optarg))
+                    log_level = LOG_DEBUG;
+                else {
+                    fprintf(stderr, "%s n'est pas un niveau de log valide.\n", optarg);
+                    exit(-1);
+                }
+                break;
+            default:
+            case '?': {
+                if (optopt == 'V') {
+                    fprintf(stderr, "\n      Missing log level\n");
+                } else if (optopt == 'p') {
+                    fprintf(stderr, "\n      Missing port\n");
+                } else if (optopt != 's') {
+                    fprintf(stderr, "\n      Unknow missing option %c\n", optopt);
+                }
+                usage();
+                exit(1);
+            }
+            case 'h': {
+                usage();
+                exit(1);
+            }
+        }
+    }
+    set_log_level(log_level);
+} /* void process_args( ... ) */
+
+/*! number of threads inserting events */
+#define NB_PRODUCERS 4
+/*! number of events inserted by each producer */
+#define NB_EVENTS 20000
+/*! number of keys fought over by the put / remove threads */
+#define NB_SHARED_KEYS 64
+/*! number of popped values kept by the drainer until no reader can see them */
+#define NB_POPPED_BATCH 256
+
+/*! shared test map */
+SKIPLIST* events = NULL;
+/*! set once the producers are done */
+int producers_done = 0;
+/*! number of ordering errors seen by the threads */
+int thread_errors = 0;
+
+/**
+ *@brief insert NB_EVENTS events with increasing timestamps, the key being timestamp * NB_PRODUCERS + producer id so that producers never collide
+ *@param param producer id
+ *@return NULL
+ */
+void* producer(void* param) {
+    int64_t id = (int64_t)(intptr_t)param;
+    for (int64_t timestamp = 0; timestamp < NB_EVENTS; timestamp++) {
+        int64_t key = timestamp * NB_PRODUCERS + id;
+        if (skiplist_put_ptr(events, key, new_value(key), destroy_value) == FALSE)
+            __atomic_add_fetch(&thread_errors, 1, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+/**
+ *@brief drain the events in order while the producers insert them. Each producer's events must come out in the order they were inserted.
+ *@param param unused
+ *@return NULL
+ */
+void* drainer(void* param) {
+    (void)param;
+    int64_t last[NB_PRODUCERS];
+    void* popped[NB_POPPED_BATCH];
+    size_t nb_popped = 0;
+    size_t nb_drained = 0;
+    for (int it = 0; it < NB_PRODUCERS; it++)
+        last[it] = -1;
+    while (TRUE) {
+        int64_t key = 0;
+        int type = 0;
+        union HASH_DATA data;
+        int done = __atomic_load_n(&producers_done, __ATOMIC_ACQUIRE);
+        int got = skiplist_pop_first(events, &key, &type, &data);
+        if (got == TRUE) {
+            int64_t id = key % NB_PRODUCERS;
+            if (type != HASH_PTR || *(int64_t*)data.ptr != key || key <= last[id])
+                __atomic_add_fetch(&thread_errors, 1, __ATOMIC_RELAXED);
+            last[id] = key;
+            popped[nb_popped++] = data.ptr;
+            nb_drained++;
+        }
+        /* the churners may still be reading the popped values, they are freed once they left */
+        if (nb_popped == NB_POPPED_BATCH || (got == FALSE && done)) {
+            while (skiplist_reclaim(events) == FALSE) sched_yield();
+            for (size_t it = 0; it < nb_popped; it++) Free(popped[it]);
+            nb_popped = 0;
+        }
+        if (got == FALSE && done)
+            break;
+    }
+    if (nb_drained != NB_PRODUCERS * NB_EVENTS)
+        __atomic_add_fetch(&thread_errors, 1, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+/**
+ *@brief put, replace, read and remove a small set of keys, racing the other threads doing the same
+ *@param param thread id
+ *@return NULL
+ */
+void* churner(void* param) {
+    int64_t id = (int64_t)(intptr_t)param;
+    for (int64_t it = 0; it < NB_EVENTS; it++) {
+        int64_t key = (it * 7 + id) % NB_SHARED_KEYS;
+        void* got = NULL;
+        switch ((it + id) % 3) {
+            case 0:
+                skiplist_put_ptr(events, key, new_value(key), destroy_value);
+                break;
+            case 1:
+                skiplist_remove(events, key);
+                break;
+            default: {
+                /* the value is only safe to read inside a read section */
+                size_t parity = skiplist_read_enter(events);
+                if (skiplist_get_ptr(events, key, &got) == TRUE && *(int64_t*)got != key)
+                    __atomic_add_fetch(&thread_errors, 1, __ATOMIC_RELAXED);
+                skiplist_read_exit(events, parity);
+                break;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ *@brief range callback summing the keys it is given
+ *@param key key of the value
+ *@param type type of the value
+ *@param data value
+ *@param user_data running sum
+ *@return TRUE to go on
+ */
+int sum_keys(int64_t key, int type, union HASH_DATA data, void* user_data) {
+    (void)type;
+    (void)data;
+    (*(int64_t*)user_data) += key;
+    return TRUE;
+}
+
+int main(int argc, char** argv) {
+    set_log_level(LOG_INFO);
+
+    /* processing args and set log_level */
+    process_args(argc, argv);
+
+    int errors = 0;
+
+    /* typed put / get, ordered lookups */
+    SKIPLIST* sl = new_skiplist();
+    for (int64_t key = 100; key > 0; key--) {
+        if (skiplist_put_int(sl, key * 10, (HASH_INT_TYPE)key) == FALSE)
+            errors++;
+    }
+    skiplist_put_double(sl, -5, 3.5);
+    skiplist_put_string(sl, 2000, "two thousands");
+    skiplist_put_string(sl, 2000, "replaced");
+    skiplist_put_ptr(sl, 3000, strdup("ptr"), free);
+    HASH_INT_TYPE ival = 0;
+    double fval = 0.0;
+    char* string = NULL;
+    void* ptr = NULL;
+    if (skiplist_get_int(sl, 420, &ival) == FALSE || ival != 42)
+        errors++;
+    if (skiplist_get_double(sl, -5, &fval) == FALSE || fval != 3.5)
+        errors++;
+    if (skiplist_get_string(sl, 2000, &string) == FALSE || strcmp(string, "replaced") != 0)
+        errors++;
+    if (skiplist_get_ptr(sl, 3000, &ptr) == FALSE || strcmp((char*)ptr, "ptr") != 0)
+        errors++;
+    if (skiplist_get_int(sl, 421, &ival) == TRUE || skiplist_get_int(sl, -5, &ival) == TRUE)
+        errors++;
+    if (skiplist_nb_items(sl) != 103)
+        errors++;
+
+    int64_t found = 0;
+    if (skiplist_floor(sl, 425, &found) == FALSE || found != 420)
+        errors++;
+    if (skiplist_floor(sl, 420, &found) == FALSE || found != 420)
+        errors++;
+    if (skiplist_ceiling(sl, 421, &found) == FALSE || found != 430)
+        errors++;
+    if (skiplist_floor(sl, -6, &found) == TRUE || skiplist_ceiling(sl, 3001, &found) == TRUE)
+        errors++;
+
+    if (skiplist_remove(sl, 430) == FALSE || skiplist_remove(sl, 430) == TRUE)
+        errors++;
+    if (skiplist_ceiling(sl, 421, &found) == FALSE || found != 440)
+        errors++;
+    int64_t sum = 0;
+    /* 400 + 410 + 420 + 440 + 450 */
+    if (skiplist_range(sl, 400, 450, sum_keys, &sum) != 5 || sum != 2120)
+        errors++;
+
+    int64_t previous = INT64_MIN;
+    int64_t key = 0;
+    int type = 0;
+    union HASH_DATA data;
+    size_t nb_popped = 0;
+    while (skiplist_pop_first(sl, &key, &type, &data) == TRUE) {
+        if (key <= previous)
+            errors++;
+        if (type == HASH_STRING || type == HASH_PTR)
+            free(data.ptr);
+        previous = key;
+        nb_popped++;
+    }
+    if (nb_popped != 102 || skiplist_nb_items(sl) != 0)
+        errors++;
+    skiplist_put_string(sl, 1, "left in the map");
+    destroy_skiplist(&sl);
+    if (sl != NULL)
+        errors++;
+
+    /* many threads insert timestamped events while one reader drains them in order */
+    events = new_skiplist();
+    pthread_t producers[NB_PRODUCERS];
+    pthread_t drain;
+    pthread_create(&drain, NULL, drainer, NULL);
+    for (intptr_t it = 0; it < NB_PRODUCERS; it++)
+        pthread_create(&producers[it], NULL, producer, (void*)it);
+    for (int it = 0; it < NB_PRODUCERS; it++)
+        pthread_join(producers[it], NULL);
+    __atomic_store_n(&producers_done, 1, __ATOMIC_RELEASE);
+    pthread_join(drain, NULL);
+    if (skiplist_nb_items(events) != 0)
+        errors++;
+
+    /* concurrent puts, replacements and removes of the same keys, through the reclamation */
+    nb_destroyed = 0;
+    for (intptr_t it = 0; it < NB_PRODUCERS; it++)
+        pthread_create(&producers[it], NULL, churner, (void*)it);
+    for (int it = 0; it < NB_PRODUCERS; it++)
+        pthread_join(producers[it], NULL);
+    size_t nb_left = skiplist_nb_items(events);
+    destroy_skiplist(&events);
+    /* every value put was destroyed once, by a replacement, a removal or the final destroy */
+    size_t nb_put = 0;
+    for (int64_t id = 0; id < NB_PRODUCERS; id++) {
+        for (int64_t it = 0; it < NB_EVENTS; it++) {
+            if ((it + id) % 3 == 0)
+                nb_put++;
+        }
+    }
+    if (nb_destroyed != nb_put || nb_left > NB_SHARED_KEYS)
+        errors++;
+    errors += thread_errors;
+
+    n_log(LOG_INFO, "skiplist test: %d errors", errors);
+    exit(errors == 0 ? 0 : 1);
+}
@@ -28,6 +28,8 @@
 #include <errno.h>
 #include <string.h>
 #include <sys/types.h>
+#include <pthread.h>
+#include <sched.h>
 
 #include "nilorea/n_common.h"
 #include "nilorea/n_log.h"
@@ -92,6 +94,140 @@ void process_args(int argc, char** argv) {
     set_log_level(log_level);
 } /* void process_args( ... ) */
 
+
+/*! number of values sent through the SPSC test stack */
+#define SPSC_NB_VALUES 200000
+
+/* push and pop arrays of values, around the end of the ring */
+int test_bulk(int packed) {
+    int errors = 0;
+    STACK* stack = packed ? new_stack_ex(10, STACK_PACKED, STACK_ITEM_INT32) : new_stack(10);
+    int32_t in[16], out[16];
+    for (int32_t it = 0; it < 16; it++) in[it] = it * 7 - 20;
+
+    for (int round = 0; round < 5; round++) {
+        /* only size - 1 cells are usable */
+        size_t nb = stack_push_many_i32(stack, in, 16);
+        if (nb != 9) {
+            n_log(LOG_ERR, "pushed %zu values instead of 9", nb);
+            errors++;
+        }
+        if (stack_push(stack, (int32_t)1) != FALSE) {
+            n_log(LOG_ERR, "pushed in a full stack");
+            errors++;
+        }
+        /* pop a few to move tail, so that the next round wraps around */
+        nb = stack_pop_many_i32(stack, out, (size_t)(3 + round));
+        for (size_t it = 0; it < nb; it++) {
+            if (out[it] != in[it]) {
+                n_log(LOG_ERR, "popped %d instead of %d", out[it], in[it]);
+                errors++;
+            }
+        }
+        uint8_t status = STACK_IS_UNDEFINED;
+        for (size_t it = nb; it < 9; it++) {
+            int32_t val = stack_pop_i32(stack, &status);
+            if (status != STACK_ITEM_OK || val != in[it]) {
+                n_log(LOG_ERR, "popped %d status %d instead of %d", val, status, in[it]);
+                errors++;
+            }
+        }
+        if (!stack_is_empty(stack) || stack->nb_items != 0) {
+            n_log(LOG_ERR, "stack not empty after popping all the values");
+            errors++;
+        }
+        /* shift the positions for the next round */
+        stack_push(stack, (int32_t)0);
+        stack_pop_i32(stack, &status);
+    }
+
+    /* a packed stack refuses the other types, a plain one stops at them */
+    if (packed) {
+        if (stack_push(stack, 1.0) != FALSE || stack_push_many_ui8(stack, (uint8_t*)in, 4) != 0) {
+            n_log(LOG_ERR, "packed int32_t stack accepted a double");
+            errors++;
+        }
+    } else {
+        stack_push(stack, (int32_t)5);
+        stack_push(stack, 1.5);
+        if (stack_pop_many_i32(stack, out, 16) != 1 || stack_pop_many_i32(stack, out, 16) != 0 || stack->nb_items != 1) {
+            n_log(LOG_ERR, "stack_pop_many_i32 went past a double");
+            errors++;
+        }
+        uint8_t status = STACK_IS_UNDEFINED;
+        if (stack_pop_d(stack, &status) != 1.5 || status != STACK_ITEM_OK) {
+            n_log(LOG_ERR, "could not pop the double after the bulk pop");
+            errors++;
+        }
+    }
+    delete_stack(&stack);
+    return errors;
+}
+
+/* producer side of the SPSC test */
+void* spsc_producer(void* ptr) {
+    STACK* stack = (STACK*)ptr;
+    uint32_t batch[64];
+    uint32_t next = 0;
+    while (next < SPSC_NB_VALUES) {
+        /* mix single and bulk pushes */
+        if (next % 3 == 0) {
+            if (stack_push(stack, next))
+                next++;
+            else
+                sched_yield();
+            continue;
+        }
+        size_t nb = 0;
+        for (nb = 0; nb < 64 && next + nb < SPSC_NB_VALUES; nb++) batch[nb] = next + (uint32_t)nb;
+        size_t pushed = stack_push_many_ui32(stack, batch, nb);
+        if (pushed == 0) sched_yield();
+        next += (uint32_t)pushed;
+    }
+    return NULL;
+}
+
+/* push from a thread and pop from the main one, checking the order */
+int test_spsc(int flags) {
+    int errors = 0;
+    STACK* stack = new_stack_ex(257, STACK_SPSC | flags, STACK_ITEM_UINT32);
+    pthread_t producer;
+    pthread_create(&producer, NULL, spsc_producer, stack);
+
+    /* pop every value, even after errors, so that the producer never waits on a full stack and can be joined */
+    uint32_t expected = 0;
+    uint32_t batch[50];
+    while (expected < SPSC_NB_VALUES) {
+        size_t nb = 0;
+        if (expected % 2 == 0) {
+            uint8_t status = STACK_IS_UNDEFINED;
+            batch[0] = stack_pop_ui32(stack, &status);
+            nb = (status == STACK_ITEM_OK) ? 1 : 0;
+        } else {
+            nb = stack_pop_many_ui32(stack, batch, 50);
+        }
+        if (nb == 0) {
+            sched_yield();
+            continue;
+        }
+        for (size_t it = 0; it < nb; it++) {
+            if (batch[it] != expected) {
+                if (errors < 10)
+                    n_log(LOG_ERR, "SPSC popped %u instead of %u", batch[it], expected);
+                errors++;
+            }
+            expected++;
+        }
+    }
+    pthread_join(producer, NULL);
+    if (!stack_is_empty(stack)) {
+        n_log(LOG_ERR, "SPSC stack not empty at the end");
+        errors++;
+    }
+    delete_stack(&stack);
+    return errors;
+}
+
 int main(int argc, char** argv) {
     set_log_level(LOG_INFO);
 
@@ -226,5 +362,12 @@ int main(int argc, char** argv) {
     n_log(LOG_INFO, "stack_is_empty after pops: %d", stack_is_empty(stack));
     delete_stack(&stack);
 
-    exit(0);
+    int errors = 0;
+    errors += test_bulk(0);
+    errors += test_bulk(1);
+    errors += test_spsc(0);
+    errors += test_spsc(STACK_PACKED);
+    n_log(LOG_INFO, "stack bulk and SPSC tests: %d errors", errors);
+
+    exit(errors == 0 ? 0 : 1);
 }
@@ -32,6 +32,22 @@
 #include "nilorea/n_time.h"
 #include "nilorea/n_thread_pool.h"
 
+#define NB_SORTED_ITEMS 100000
+
+/*! item of the parallel sort test */
+typedef struct SORT_ITEM {
+    /*! sort key, with duplicates */
+    int key;
+    /*! insertion rank, to check the sort is stable */
+    int rank;
+} SORT_ITEM;
+
+int compare_sort_items(const void* a, const void* b) {
+    const SORT_ITEM* item_a = (const SORT_ITEM*)a;
+    const SORT_ITEM* item_b = (const SORT_ITEM*)b;
+    return (item_a->key > item_b->key) - (item_a->key < item_b->key);
+}
+
 void usage(void) {
     fprintf(stderr,
             "     -v version\n"
@@ -150,6 +166,39 @@ int main(int argc, char** argv) {
     refresh_thread_pool(thread_pool);
 
     destroy_threaded_pool(&thread_pool, 1000);
+
+    /* sort a list on a pool, at least 4 threads so the sublists are merged even on a single core */
+    n_log(LOG_INFO, "--- Parallel list sort test ---");
+    thread_pool = new_thread_pool((size_t)(nb_active_threads > 4 ? nb_active_threads : 4), 0);
+    LIST* list = new_generic_list(UNLIMITED_LIST_ITEMS);
+    SORT_ITEM* items = NULL;
+    Malloc(items, SORT_ITEM, NB_SORTED_ITEMS);
+    __n_assert(items, exit(1));
+    for (int it = 0; it < NB_SORTED_ITEMS; it++) {
+        items[it].key = rand() % 1000;
+        items[it].rank = it;
+        list_push(list, &items[it], NULL);
+    }
+    list_sort_parallel(list, compare_sort_items, thread_pool);
+    int sort_errors = (list->nb_items != NB_SORTED_ITEMS) ? 1 : 0;
+    const SORT_ITEM* previous = NULL;
+    list_foreach(node, list) {
+        const SORT_ITEM* item = (const SORT_ITEM*)node->ptr;
+        if (previous && (previous->key > item->key || (previous->key == item->key && previous->rank > item->rank)))
+            sort_errors++;
+        if ((node->prev ? node->prev->ptr : NULL) != previous)
+            sort_errors++;
+        previous = item;
+    }
+    if (!list->end || list->end->ptr != previous)
+        sort_errors++;
+    n_log(LOG_INFO, "Parallel list sort of %d items: %d errors", NB_SORTED_ITEMS, sort_errors);
+    list_destroy(&list);
+    Free(items);
+    destroy_threaded_pool(&thread_pool, 1000);
+    if (sort_errors > 0)
+        exit(1);
+
     n_log(LOG_INFO, "All thread pool tests done.");
 
     exit(0);
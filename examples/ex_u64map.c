@@ -0,0 +1,201 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ *@example ex_u64map.c
+ *@brief Nilorea Library integer keyed map API
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+#include "nilorea/n_str.h"
+#include "nilorea/n_u64map.h"
+
+/*! number of values destroyed by the map */
+static size_t nb_destroyed = 0;
+
+/**
+ *@brief value destructor counting its calls
+ *@param ptr value to free
+ */
+static void destroy_value(void* ptr) {
+    nb_destroyed++;
+    Free(ptr);
+}
+
+/**
+ *@brief allocate a value holding its key
+ *@param key key of the value
+ *@return the new value
+ */
+static void* new_value(int64_t key) {
+    int64_t* value = NULL;
+    Malloc(value, int64_t, 1);
+    __n_assert(value, exit(1));
+    (*value) = key;
+    return value;
+}
+
+void usage(void) {
+    fprintf(stderr,
+            "     -v version\n"
+            "     -V log level: LOG_INFO, LOG_NOTICE, LOG_ERR, LOG_DEBUG\n"
+            "     -h help\n");
+}
+
+void process_args(int argc, char** argv) {
+    int getoptret = 0,
+        log_level = LOG_DEBUG; /* default log level */
+
+    /* Arguments optionnels */
+    /* -v version
+     * -V log level
+     * -h help
+     */
+    while ((getoptret = getopt(argc, argv, "hvV:")) != EOF) {
+        switch (getoptret) {
+            case 'v':
+                fprintf(stderr, "Date de compilation : %s a %s.\n", __DATE__, __TIME__);
+                exit(1);
+            case 'V':
+                if (!strcmp("LOG_NULL", optarg))
+                    log_level = LOG_NULL;
+                else if (!strcmp("LOG_NOTICE", optarg))
+                    log_level = LOG_NOTICE;
+                else if (!strcmp("LOG_INFO", optarg))
+                    log_level = LOG_INFO;
+                else if (!strcmp("LOG_ERR", optarg))
+                    log_level = LOG_ERR;
+                else if (!strcmp("LOG_DEBUG", optarg))
+                    log_level = LOG_DEBUG;
+                else {
+                    fprintf(stderr, "%s n'est pas un niveau de log valide.\n", optarg);
+                    exit(-1);
+                }
+                break;
+            default:
+            case '?': {
+                if (optopt == 'V') {
+                    fprintf(stderr, "\n      Missing log level\n");
+                } else if (optopt == 'p') {
+                    fprintf(stderr, "\n      Missing port\n");
+                } else if (optopt != 's') {
+                    fprintf(stderr, "\n      Unknow missing option %c\n", optopt);
+                }
+                usage();
+                exit(1);
+            }
+            case 'h': {
+                usage();
+                exit(1);
+            }
+        }
+    }
+    set_log_level(log_level);
+} /* void process_args( ... ) */
+
+/*! number of keys put in the test map */
+#define NB_KEYS 100000
+
+int main(int argc, char** argv) {
+    set_log_level(LOG_INFO);
+
+    /* processing args and set log_level */
+    process_args(argc, argv);
+
+    int errors = 0;
+
+    /* start tiny so the map has to grow, keys spread like entity ids */
+    U64MAP* map = new_u64map(1, destroy_value);
+    for (uint64_t key = 0; key < NB_KEYS; key++) {
+        if (u64map_put(map, key * 7919, new_value((int64_t)(key * 7919))) == FALSE)
+            errors++;
+    }
+    /* replacing a value destroys the old one */
+    u64map_put(map, 0, new_value(0));
+    if (nb_destroyed != 1 || map->nb_items != NB_KEYS)
+        errors++;
+    n_log(LOG_INFO, "put %zu keys in %zu slots", map->nb_items, map->size);
+
+    for (uint64_t key = 0; key < NB_KEYS; key += 2) {
+        if (u64map_remove(map, key * 7919) == FALSE)
+            errors++;
+    }
+    if (u64map_remove(map, 2) == TRUE)
+        errors++;
+    for (uint64_t key = 0; key < NB_KEYS; key++) {
+        void* value = NULL;
+        int found = u64map_get(map, key * 7919, &value);
+        if ((key % 2 == 0 && found == TRUE) || (key % 2 == 1 && (found == FALSE || *(uint64_t*)value != key * 7919)))
+            errors++;
+    }
+
+    /* bulk operations: put the removed keys back, then look everything up at once */
+    uint64_t* keys = NULL;
+    void** values = NULL;
+    Malloc(keys, uint64_t, NB_KEYS);
+    Malloc(values, void*, NB_KEYS);
+    __n_assert(keys && values, exit(1));
+    for (uint64_t key = 0; key < NB_KEYS / 2; key++) {
+        keys[key] = key * 2 * 7919;
+        values[key] = new_value((int64_t)keys[key]);
+    }
+    if (u64map_put_many(map, keys, values, NB_KEYS / 2) != NB_KEYS / 2)
+        errors++;
+    for (uint64_t key = 0; key < NB_KEYS; key++) {
+        keys[key] = (key % 10 == 9) ? key * 7919 + 1 : key * 7919;
+    }
+    size_t nb_found = u64map_get_many(map, keys, NB_KEYS, values);
+    if (nb_found != NB_KEYS - NB_KEYS / 10)
+        errors++;
+    for (uint64_t key = 0; key < NB_KEYS; key++) {
+        if ((key % 10 == 9 && values[key] != NULL) || (key % 10 != 9 && (!values[key] || *(uint64_t*)values[key] != keys[key])))
+            errors++;
+    }
+    Free(keys);
+    Free(values);
+
+    size_t nb_iterated = 0;
+    u64map_foreach(it, map) {
+        if (*(uint64_t*)map->values[it] != map->keys[it])
+            errors++;
+        nb_iterated++;
+    }
+    if (nb_iterated != NB_KEYS || map->nb_items != NB_KEYS)
+        errors++;
+    n_log(LOG_INFO, "%zu keys in %zu slots, %zu found in bulk", map->nb_items, map->size, nb_found);
+
+    u64map_empty(map);
+    if (map->nb_items != 0 || nb_destroyed != 1 + NB_KEYS / 2 + NB_KEYS)
+        errors++;
+    u64map_put(map, 42, new_value(42));
+    destroy_u64map(&map);
+    if (map != NULL || nb_destroyed != 2 + NB_KEYS / 2 + NB_KEYS)
+        errors++;
+
+    n_log(LOG_INFO, "u64map test: %d errors", errors);
+    exit(errors == 0 ? 0 : 1);
+}
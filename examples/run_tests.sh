@@ -150,6 +150,11 @@ asan_test "ex_exceptions"
 # data structure examples
 asan_test "ex_list"
 asan_test "ex_hash"
+asan_test "ex_u64map"
+asan_test "ex_skiplist"
+asan_test "ex_btree"
+asan_test "ex_pqueue"
+asan_test "ex_bitset"
 asan_test "ex_nstr"
 asan_test "ex_stack"
 asan_test "ex_trees"
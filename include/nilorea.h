@@ -50,6 +50,7 @@ extern "C" {
 #include <nilorea/n_str.h>
 #include <nilorea/n_thread_pool.h>
 #include <nilorea/n_time.h>
+#include <nilorea/n_u64map.h>
 #include <nilorea/n_user.h>
 #include <nilorea/n_zlib.h>
 #include <nilorea/n_games.h>
@@ -67,6 +67,8 @@ extern "C" {
 #include <stdlib.h>
 #include <stdint.h>
 
+#include "nilorea/n_bitset.h"
+
 /* Constants */
 
 /*! Movement mode: 4-dir (2D) or 6-dir (3D) */
@@ -126,35 +128,23 @@ typedef struct ASTAR_PATH {
 
 /*! Internal node data used during pathfinding */
 typedef struct ASTAR_CELL {
-    int g;          /*!< cost from start to this cell */
-    int h;          /*!< heuristic estimate to goal */
-    int f;          /*!< g + h */
-    int parent_x;   /*!< parent cell X (-1 if none) */
-    int parent_y;   /*!< parent cell Y */
-    int parent_z;   /*!< parent cell Z */
-    uint8_t status; /*!< ASTAR_NODE_NONE / OPEN / CLOSED */
+    int g;              /*!< cost from start to this cell */
+    int h;              /*!< heuristic estimate to goal */
+    int f;              /*!< g + h */
+    int parent_x;       /*!< parent cell X (-1 if none) */
+    int parent_y;       /*!< parent cell Y */
+    int parent_z;       /*!< parent cell Z */
+    uint8_t status;     /*!< ASTAR_NODE_NONE / OPEN / CLOSED */
+    size_t open_handle; /*!< handle in the open list while OPEN */
 } ASTAR_CELL;
 
-/*! Min-heap entry for the open list priority queue */
-typedef struct ASTAR_HEAP_NODE {
-    int x, y, z; /*!< grid coordinates */
-    int f;       /*!< priority (f = g + h) */
-} ASTAR_HEAP_NODE;
-
-/*! Binary min-heap (priority queue) for the open list */
-typedef struct ASTAR_HEAP {
-    ASTAR_HEAP_NODE* data; /*!< heap array */
-    int size;              /*!< current number of elements */
-    int capacity;          /*!< allocated capacity */
-} ASTAR_HEAP;
-
 /*! Grid structure holding walkability, costs, and dimensions */
 typedef struct ASTAR_GRID {
-    int width;         /*!< grid width (X axis) */
-    int height;        /*!< grid height (Y axis) */
-    int depth;         /*!< grid depth (Z axis, 1 for 2D) */
-    uint8_t* walkable; /*!< walkability map: 1=passable, 0=blocked */
-    int* cost;         /*!< per-cell movement cost multiplier (x1000) */
+    int width;          /*!< grid width (X axis) */
+    int height;         /*!< grid height (Y axis) */
+    int depth;          /*!< grid depth (Z axis, 1 for 2D) */
+    N_BITSET* walkable; /*!< walkability map, one bit per cell: 1=passable, 0=blocked */
+    int* cost;          /*!< per-cell movement cost multiplier (x1000) */
 } ASTAR_GRID;
 
 /* API Functions */
@@ -0,0 +1,158 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**@file n_bitset.h
+ *  Fixed size bitsets and compressed roaring bitmaps
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#ifndef __N_BITSET_HEADER
+#define __N_BITSET_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**@defgroup BITSET BITSETS: fixed bitsets and roaring bitmaps
+  @addtogroup BITSET
+  @{
+  */
+
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+
+#include <stdint.h>
+
+/*! value returned by the scans when there is no more matching bit */
+#define BITSET_NONE SIZE_MAX
+/*! number of bits in a bitset word */
+#define BITSET_WORD_BITS 64
+
+/*! fixed size bitset, one bit per index in 64 bits words */
+typedef struct N_BITSET {
+    /*! words, bit it is bit (it % 64) of words[it / 64]. The bits past nb_bits are always 0 */
+    uint64_t* words;
+    /*! number of bits */
+    size_t nb_bits;
+    /*! number of words */
+    size_t nb_words;
+} N_BITSET;
+
+/*! number of values of a roaring array container before it turns into a bitmap container */
+#define ROARING_ARRAY_MAX 4096
+/*! number of words of a roaring bitmap container, 65536 bits */
+#define ROARING_BITMAP_WORDS 1024
+
+/*! set of the values of a roaring bitmap sharing the same 16 high bits */
+typedef struct N_ROARING_CONTAINER {
+    /*! sorted low 16 bits of the values if there are at most ROARING_ARRAY_MAX of them, else NULL */
+    uint16_t* values;
+    /*! bitmap of the low 16 bits if there are more than ROARING_ARRAY_MAX values, else NULL */
+    uint64_t* words;
+    /*! number of values */
+    uint32_t cardinality;
+    /*! number of allocated values */
+    uint32_t capacity;
+} N_ROARING_CONTAINER;
+
+/*! compressed set of uint32_t, split by their 16 high bits into sorted arrays or bitmaps */
+typedef struct N_ROARING {
+    /*! sorted high 16 bits of the containers */
+    uint16_t* keys;
+    /*! containers, in the order of keys */
+    N_ROARING_CONTAINER* containers;
+    /*! number of containers */
+    size_t nb_containers;
+    /*! number of allocated keys and containers */
+    size_t capacity;
+} N_ROARING;
+
+/*! @brief create a new bitset of nb_bits cleared bits */
+N_BITSET* new_bitset(size_t nb_bits);
+/*! @brief destroy a bitset and set it to NULL */
+int destroy_bitset(N_BITSET** bitset);
+/*! @brief set or clear all the bits */
+int bitset_fill(N_BITSET* bitset, int value);
+/*! @brief set or clear the bits from start to end excluded */
+int bitset_fill_range(N_BITSET* bitset, size_t start, size_t end, int value);
+/*! @brief count the set bits */
+size_t bitset_count(const N_BITSET* bitset);
+/*! @brief get the index of the first set bit at or after start */
+size_t bitset_next_set(const N_BITSET* bitset, size_t start);
+/*! @brief get the index of the first cleared bit at or after start */
+size_t bitset_next_clear(const N_BITSET* bitset, size_t start);
+/*! @brief dst = dst AND src */
+int bitset_and(N_BITSET* dst, const N_BITSET* src);
+/*! @brief dst = dst OR src */
+int bitset_or(N_BITSET* dst, const N_BITSET* src);
+/*! @brief dst = dst XOR src */
+int bitset_xor(N_BITSET* dst, const N_BITSET* src);
+/*! @brief dst = dst AND NOT src */
+int bitset_andnot(N_BITSET* dst, const N_BITSET* src);
+/*! @brief count the bits set in both bitsets */
+size_t bitset_and_count(const N_BITSET* a, const N_BITSET* b);
+
+/*! @brief set a bit, bit must be lower than nb_bits */
+static inline void bitset_set(N_BITSET* bitset, size_t bit) {
+    bitset->words[bit / BITSET_WORD_BITS] |= (uint64_t)1 << (bit % BITSET_WORD_BITS);
+}
+
+/*! @brief clear a bit, bit must be lower than nb_bits */
+static inline void bitset_clear(N_BITSET* bitset, size_t bit) {
+    bitset->words[bit / BITSET_WORD_BITS] &= ~((uint64_t)1 << (bit % BITSET_WORD_BITS));
+}
+
+/*! @brief get a bit, bit must be lower than nb_bits */
+static inline int bitset_test(const N_BITSET* bitset, size_t bit) {
+    return (int)((bitset->words[bit / BITSET_WORD_BITS] >> (bit % BITSET_WORD_BITS)) & 1);
+}
+
+/*! @brief create a new empty roaring bitmap */
+N_ROARING* new_roaring(void);
+/*! @brief destroy a roaring bitmap and set it to NULL */
+int destroy_roaring(N_ROARING** roaring);
+/*! @brief add a value */
+int roaring_add(N_ROARING* roaring, uint32_t value);
+/*! @brief remove a value */
+int roaring_remove(N_ROARING* roaring, uint32_t value);
+/*! @brief tell if a value is in the set */
+int roaring_contains(const N_ROARING* roaring, uint32_t value);
+/*! @brief count the values */
+size_t roaring_cardinality(const N_ROARING* roaring);
+/*! @brief call func on each value in increasing order */
+size_t roaring_foreach(const N_ROARING* roaring, int (*func)(uint32_t value, void* user_data), void* user_data);
+/*! @brief new set of the values in both a and b */
+N_ROARING* roaring_and(const N_ROARING* a, const N_ROARING* b);
+/*! @brief new set of the values in a or b */
+N_ROARING* roaring_or(const N_ROARING* a, const N_ROARING* b);
+/*! @brief new set of the values in a and not in b */
+N_ROARING* roaring_andnot(const N_ROARING* a, const N_ROARING* b);
+/*! @brief remove all the values */
+int roaring_empty(N_ROARING* roaring);
+
+/**
+  @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
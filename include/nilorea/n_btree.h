@@ -0,0 +1,143 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**@file n_btree.h
+ *  Ordered map, B+tree with wide cache line aligned nodes
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#ifndef __N_BTREE_HEADER
+#define __N_BTREE_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**@defgroup BTREE BTREE: int64_t keyed ordered map with rank and select
+  @addtogroup BTREE
+  @{
+  */
+
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+
+#include <stdint.h>
+
+/*! alignment in bytes of the nodes, one cache line */
+#define BTREE_NODE_ALIGN 64
+/*! maximum number of keys of a leaf */
+#define BTREE_LEAF_SIZE 32
+/*! maximum number of keys of an inner node, which has one more child */
+#define BTREE_INNER_SIZE 32
+/*! minimum number of keys of a leaf other than the root */
+#define BTREE_LEAF_MIN (BTREE_LEAF_SIZE / 2)
+/*! minimum number of keys of an inner node other than the root */
+#define BTREE_INNER_MIN ((BTREE_INNER_SIZE - 1) / 2)
+
+/*! leaf node, keys and values in sorted arrays, chained to its neighbours for the cursors */
+typedef struct BTREE_LEAF {
+    /*! sorted keys */
+    int64_t keys[BTREE_LEAF_SIZE];
+    /*! values of the keys */
+    void* values[BTREE_LEAF_SIZE];
+    /*! previous leaf in key order */
+    struct BTREE_LEAF* prev;
+    /*! next leaf in key order */
+    struct BTREE_LEAF* next;
+    /*! number of keys */
+    uint32_t nb_keys;
+} BTREE_LEAF;
+
+/*! inner node. keys[it] is lower or equal to every key under children[it + 1] and greater than every key under children[it] */
+typedef struct BTREE_INNER {
+    /*! separator keys */
+    int64_t keys[BTREE_INNER_SIZE];
+    /*! children, leaves if the node is just above the leaves, else inner nodes */
+    void* children[BTREE_INNER_SIZE + 1];
+    /*! number of keys under each child, for rank and select */
+    size_t counts[BTREE_INNER_SIZE + 1];
+    /*! number of separator keys */
+    uint32_t nb_keys;
+} BTREE_INNER;
+
+/*! structure of a B+tree ordered map */
+typedef struct BTREE {
+    /*! root node, a leaf if height is 0, NULL if the tree is empty */
+    void* root;
+    /*! number of inner levels above the leaves */
+    size_t height;
+    /*! number of keys in the tree */
+    size_t nb_items;
+    /*! leaf of the smallest keys */
+    BTREE_LEAF* first;
+    /*! leaf of the greatest keys */
+    BTREE_LEAF* last;
+    /*! destructor called on the values replaced, removed or left in the tree, or NULL */
+    void (*destroy_func)(void* ptr);
+} BTREE;
+
+/*! position of a cursor on a key of a BTREE. Valid until the tree is modified */
+typedef struct BTREE_CURSOR {
+    /*! current leaf, NULL past the ends */
+    BTREE_LEAF* leaf;
+    /*! index of the key in leaf */
+    uint32_t pos;
+} BTREE_CURSOR;
+
+/*! @brief create a new B+tree ordered map */
+BTREE* new_btree(void (*destructor)(void* ptr));
+/*! @brief put a value at key, replacing the previous one */
+int btree_put(BTREE* tree, int64_t key, void* value);
+/*! @brief get the value at key */
+int btree_get(const BTREE* tree, int64_t key, void** value);
+/*! @brief remove key and destroy its value */
+int btree_remove(BTREE* tree, int64_t key);
+/*! @brief fill an empty tree from strictly increasing keys */
+int btree_bulk_load(BTREE* tree, const int64_t* keys, void* const* values, size_t nb);
+/*! @brief get the number of keys lower than key */
+size_t btree_rank(const BTREE* tree, int64_t key);
+/*! @brief get the key and value of a given rank */
+int btree_select(const BTREE* tree, size_t rank, int64_t* key, void** value);
+/*! @brief put a cursor on the smallest key */
+int btree_cursor_first(const BTREE* tree, BTREE_CURSOR* cursor);
+/*! @brief put a cursor on the greatest key */
+int btree_cursor_last(const BTREE* tree, BTREE_CURSOR* cursor);
+/*! @brief put a cursor on the smallest key greater or equal to key */
+int btree_cursor_seek(const BTREE* tree, BTREE_CURSOR* cursor, int64_t key);
+/*! @brief move a cursor to the next key */
+int btree_cursor_next(BTREE_CURSOR* cursor);
+/*! @brief move a cursor to the previous key */
+int btree_cursor_prev(BTREE_CURSOR* cursor);
+/*! @brief get the key and value under a cursor */
+int btree_cursor_get(const BTREE_CURSOR* cursor, int64_t* key, void** value);
+/*! @brief remove all the keys */
+int btree_empty(BTREE* tree);
+/*! @brief destroy a tree and set it to NULL */
+int destroy_btree(BTREE** tree);
+
+/**
+  @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -31,7 +31,7 @@
 extern "C" {
 #endif
 
-/**@defgroup HASH_TABLE HASH TABLES: classic or trie tree hash_tables
+/**@defgroup HASH_TABLE HASH TABLES: classic, trie tree, open addressing or concurrent hash_tables
   @addtogroup HASH_TABLE
   @{
   */
@@ -44,6 +44,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <pthread.h>
 
 #include "n_common.h"
 #include "n_list.h"
@@ -79,6 +80,55 @@ extern "C" {
 #define HASH_CLASSIC 128
 /*! TRIE tree using hash key string */
 #define HASH_TRIE 256
+/*! Open addressing (Robin Hood) table with inline nodes, using hash key string */
+#define HASH_OPEN 512
+
+/*! HASH_OPEN mode: maximum load factor in percent before the table grows */
+#define HASH_OPEN_MAX_LOAD_PERCENT 85
+/*! HASH_OPEN mode: minimum number of slots */
+#define HASH_OPEN_MIN_SIZE 8
+/*! Sharded table with per shard writer locks and lock free readers, using hash key string */
+#define HASH_CONCURRENT 1024
+/*! HASH_CONCURRENT mode: number of unlinked entries kept by a shard before trying to free them */
+#define HASH_CONCURRENT_RETIRE_BATCH 64
+/*! HASH_CONCURRENT mode: number of yields a writer waits for readers to leave before delaying the reclamation */
+#define HASH_CONCURRENT_SYNC_SPINS 1000
+/*! Read only memory mapped image written by ht_save_snapshot, later changes going to an overlay */
+#define HASH_SNAPSHOT 2048
+/*! HASH_SNAPSHOT mode: magic string at the start of an image file */
+#define HASH_SNAPSHOT_MAGIC "NHTSNAP"
+/*! HASH_SNAPSHOT mode: version of the image file format */
+#define HASH_SNAPSHOT_VERSION 1
+/*! HASH_SNAPSHOT mode: maximum load factor in percent of the image slots */
+#define HASH_SNAPSHOT_MAX_LOAD_PERCENT 70
+
+/*! HASH_TRIE mode: adaptive radix tree node with up to 4 children */
+#define HASH_ART_KIND4 1
+/*! HASH_TRIE mode: adaptive radix tree node with up to 16 children */
+#define HASH_ART_KIND16 2
+/*! HASH_TRIE mode: adaptive radix tree node with up to 48 children */
+#define HASH_ART_KIND48 3
+/*! HASH_TRIE mode: adaptive radix tree node with up to 256 children */
+#define HASH_ART_KIND256 4
+/*! HASH_TRIE mode: number of compressed path bytes stored in a node, longer paths are checked against a leaf key */
+#define HASH_ART_MAX_PREFIX 10
+
+/*! HASH_CLASSIC mode: suggested number of keys per bucket, in percent, to give to ht_set_max_load */
+#define HASH_CLASSIC_MAX_LOAD_PERCENT 100
+/*! HASH_CLASSIC mode: number of buckets migrated by each put or remove while an incremental resize is in progress */
+#define HASH_REHASH_STEP_BUCKETS 2
+/*! HASH_CLASSIC mode: number of empty buckets a rehash step may skip for each bucket it has to migrate */
+#define HASH_REHASH_EMPTY_VISITS 10
+/*! number of keys hashed and prefetched ahead by ht_get_ptr_many and ht_put_ptr_many */
+#define HASH_BATCH_SIZE 32
+/*! HASH_TRIE cursors: initial number of frames of the walk stack, doubled when a deeper key is reached */
+#define HASH_CURSOR_STACK_SIZE 16
+/*! HASH_TRIE mode: initial number of candidates of the ranked completion search, doubled when needed */
+#define HASH_RANKED_HEAP_SIZE 64
+/*! new_ht_ex flag, HASH_CLASSIC mode: carve nodes and interned keys from per table memory blocks released in bulk */
+#define HT_ARENA 1
+/*! HT_ARENA tables: size in bytes of the memory blocks */
+#define HASH_ARENA_BLOCK_SIZE 65536
 
 #ifdef ENV_32BITS
 /*! Murmur hash macro helper 32 bits */
@@ -111,28 +161,195 @@ union HASH_DATA {
 typedef struct HASH_NODE {
     /*! string key of the node if any, else NULL */
     char* key;
-    /*! key id of the node if any */
-    char key_id;
     /*! numeric key of the node if any, else < 0 */
     HASH_VALUE hash_value;
-    /*! type of the node */
-    int type;
     /*! data inside the node */
     union HASH_DATA data;
     /*! destroy_func */
     void (*destroy_func)(void* ptr);
     /*! duplicator_func */
     void* (*duplicate_func)(void* ptr);
+    /*! type of the node */
+    int type;
     /*! HASH_TRIE mode: does it have a value */
     int is_leaf;
-    /*! flag to mark a node for rehash */
-    int need_rehash;
-    /*! HASH_TRIE mode: pointers to children */
-    struct HASH_NODE** children;
-    /*! HASH_TRIE mode: size of alphabet and so size of children allocated array */
-    size_t alphabet_length;
+    /*! key id of the node if any */
+    char key_id;
 } HASH_NODE;
 
+/*! HASH_TRIE mode: leaf of the adaptive radix tree, the HASH_NODE comes first so that a leaf is used and freed as a HASH_NODE */
+typedef struct HASH_ART_LEAF_NODE {
+    /*! key and value of the leaf */
+    HASH_NODE node;
+    /*! rank of the key in ht_get_completion_list_ranked, set by ht_trie_set_weight */
+    size_t weight;
+} HASH_ART_LEAF_NODE;
+
+/*! HASH_TRIE mode: completion weight of a leaf HASH_NODE */
+#define HASH_ART_WEIGHT(__node) (((HASH_ART_LEAF_NODE*)(__node))->weight)
+
+/*! HASH_TRIE mode: tell if an adaptive radix tree child pointer is a leaf HASH_NODE */
+#define HASH_ART_IS_LEAF(__ptr) (((uintptr_t)(__ptr)) & 1)
+/*! HASH_TRIE mode: get the HASH_NODE of a leaf child pointer */
+#define HASH_ART_LEAF(__ptr) ((HASH_NODE*)(((uintptr_t)(__ptr)) & ~(uintptr_t)1))
+/*! HASH_TRIE mode: make a leaf child pointer from a HASH_NODE */
+#define HASH_ART_TAG_LEAF(__node) ((void*)(((uintptr_t)(__node)) | 1))
+
+/*! HASH_TRIE mode: common header of the adaptive radix tree inner nodes */
+typedef struct HASH_ART_NODE {
+    /*! HASH_ART_KIND4, HASH_ART_KIND16, HASH_ART_KIND48 or HASH_ART_KIND256 */
+    uint8_t kind;
+    /*! number of children */
+    uint16_t nb_children;
+    /*! length of the compressed path leading to the node children */
+    uint32_t prefix_len;
+    /*! first bytes of the compressed path */
+    uint8_t prefix[HASH_ART_MAX_PREFIX];
+    /*! node of the key ending right after the compressed path, or NULL */
+    HASH_NODE* leaf;
+    /*! highest weight of the leaves below the node, an upper bound between two removals and a weight update */
+    size_t max_weight;
+} HASH_ART_NODE;
+
+/*! HASH_TRIE mode: candidate of the best first search of ht_get_completion_list_ranked */
+typedef struct HASH_ART_RANKED {
+    /*! weight of a leaf, or highest weight below an inner node */
+    size_t weight;
+    /*! inner node or tagged leaf */
+    const void* ptr;
+} HASH_ART_RANKED;
+
+/*! HASH_TRIE mode: inner node with up to 4 children, keys sorted */
+typedef struct HASH_ART_NODE4 {
+    /*! common header */
+    HASH_ART_NODE header;
+    /*! child key bytes */
+    uint8_t keys[4];
+    /*! child pointers, inner nodes or tagged leaves */
+    void* children[4];
+} HASH_ART_NODE4;
+
+/*! HASH_TRIE mode: inner node with up to 16 children, keys sorted */
+typedef struct HASH_ART_NODE16 {
+    /*! common header */
+    HASH_ART_NODE header;
+    /*! child key bytes */
+    uint8_t keys[16];
+    /*! child pointers, inner nodes or tagged leaves */
+    void* children[16];
+} HASH_ART_NODE16;
+
+/*! HASH_TRIE mode: inner node with up to 48 children, indexed by key byte */
+typedef struct HASH_ART_NODE48 {
+    /*! common header */
+    HASH_ART_NODE header;
+    /*! slot in children plus one for each key byte, 0 if none */
+    uint8_t child_index[256];
+    /*! child pointers, inner nodes or tagged leaves */
+    void* children[48];
+} HASH_ART_NODE48;
+
+/*! HASH_TRIE mode: inner node with a child slot for each key byte */
+typedef struct HASH_ART_NODE256 {
+    /*! common header */
+    HASH_ART_NODE header;
+    /*! child pointers, inner nodes or tagged leaves */
+    void* children[256];
+} HASH_ART_NODE256;
+
+/*! HT_ARENA tables: header of a memory block, its data follows the header */
+typedef struct HASH_ARENA_BLOCK {
+    /*! next block, previously filled */
+    struct HASH_ARENA_BLOCK* next;
+    /*! capacity of the block, in entries for node blocks or in bytes for key blocks */
+    size_t size;
+    /*! used part of the block, same unit as size */
+    size_t used;
+} HASH_ARENA_BLOCK;
+
+/*! HT_ARENA tables: bucket list node and hash node carved together from a block */
+typedef struct HASH_ARENA_ENTRY {
+    /*! bucket list node, its next field links the free entries */
+    LIST_NODE list_node;
+    /*! key and value of the entry, type HASH_UNKNOWN once released */
+    HASH_NODE node;
+} HASH_ARENA_ENTRY;
+
+/*! HASH_CONCURRENT mode: bucket chain entry, walked by readers without locking */
+typedef struct HASH_CONCURRENT_ENTRY {
+    /*! next entry in the bucket chain, left untouched once unlinked so that readers standing on the entry can go on */
+    struct HASH_CONCURRENT_ENTRY* next;
+    /*! next entry in the shard retired list */
+    struct HASH_CONCURRENT_ENTRY* retired_next;
+    /*! key and value of the entry */
+    HASH_NODE node;
+} HASH_CONCURRENT_ENTRY;
+
+/*! HASH_CONCURRENT mode: one shard of the table, with its own writer lock and reader epoch */
+typedef struct HASH_CONCURRENT_SHARD {
+    /*! serialize writers of the shard */
+    pthread_mutex_t lock;
+    /*! bucket chains */
+    HASH_CONCURRENT_ENTRY** buckets;
+    /*! number of buckets */
+    size_t size;
+    /*! incremented by each reclamation, its parity tells readers which counter to use */
+    size_t epoch;
+    /*! number of readers inside a read section, per epoch parity */
+    size_t readers[2];
+    /*! entries unlinked from the buckets, waiting for the readers to leave */
+    HASH_CONCURRENT_ENTRY* retired;
+    /*! number of entries in retired */
+    size_t nb_retired;
+    /*! nb_retired value at which the next reclamation is tried */
+    size_t retire_threshold;
+} HASH_CONCURRENT_SHARD;
+
+/*! HASH_SNAPSHOT mode: header at offset 0 of an image file. All the offsets are in bytes from the start of the file, the image being position independent */
+typedef struct HASH_SNAPSHOT_HEADER {
+    /*! HASH_SNAPSHOT_MAGIC, zero padded */
+    char magic[8];
+    /*! HASH_SNAPSHOT_VERSION */
+    uint32_t version;
+    /*! sizeof(HASH_VALUE) of the writer, images are only readable with the same hash width */
+    uint32_t hash_size;
+    /*! 0x01020304 in the writer byte order */
+    uint32_t byte_order;
+    /*! unused, 0 */
+    uint32_t reserved;
+    /*! seed of the key hashes */
+    uint64_t seed;
+    /*! number of keys in the image */
+    uint64_t nb_keys;
+    /*! number of slots, a power of two */
+    uint64_t nb_slots;
+    /*! offset of the slot array, the pool of keys and string values lying between the header and the slots */
+    uint64_t slots_offset;
+    /*! size of the image file */
+    uint64_t file_size;
+} HASH_SNAPSHOT_HEADER;
+
+/*! HASH_SNAPSHOT mode: one slot of an image, linear probing from hash_value modulo nb_slots */
+typedef struct HASH_SNAPSHOT_SLOT {
+    /*! hash value of the key */
+    uint64_t hash_value;
+    /*! offset of the null terminated key, 0 for an empty slot */
+    uint64_t key_offset;
+    /*! length of the key */
+    uint32_t key_len;
+    /*! HASH_INT, HASH_DOUBLE or HASH_STRING */
+    uint32_t type;
+    /*! value of the key */
+    union {
+        /*! HASH_INT value */
+        int64_t ival;
+        /*! HASH_DOUBLE value */
+        double fval;
+        /*! HASH_STRING value: offset of the null terminated string, 0 for a NULL string */
+        uint64_t string_offset;
+    } value;
+} HASH_SNAPSHOT_SLOT;
+
 /*! structure of a hash table */
 typedef struct HASH_TABLE {
     /*! size of the hash table */
@@ -143,13 +360,55 @@ typedef struct HASH_TABLE {
     size_t seed;
     /*! HASH_CLASSIC mode: preallocated hash table */
     LIST** hash_table;
-    /*! HASH_TRIE mode: Start of tree */
-    HASH_NODE* root;
+    /*! HASH_CLASSIC mode: bucket array filled by an incremental resize, NULL when no resize is in progress */
+    LIST** rehash_table;
+    /*! HASH_CLASSIC mode: size of rehash_table */
+    size_t rehash_size;
+    /*! HASH_CLASSIC mode: index of the next hash_table bucket to migrate into rehash_table */
+    size_t rehash_index;
+    /*! HASH_CLASSIC mode: load factor in percent of nb_keys / size triggering an incremental grow, 0 to disable */
+    size_t max_load_percent;
+    /*! HASH_CLASSIC mode: number of open cursors, the buckets are not migrated while there are some */
+    size_t nb_cursors;
+    /*! HASH_CLASSIC mode: new_ht_ex flags, 0 or HT_ARENA */
+    unsigned int flags;
+    /*! HT_ARENA tables: blocks of HASH_ARENA_ENTRY, current block first */
+    HASH_ARENA_BLOCK* arena_entries;
+    /*! HT_ARENA tables: blocks of interned key strings, current block first */
+    HASH_ARENA_BLOCK* arena_keys;
+    /*! HT_ARENA tables: released entries, linked by their list_node.next */
+    HASH_ARENA_ENTRY* arena_free;
+    /*! HT_ARENA tables: open addressing set of the interned keys */
+    char** arena_interned;
+    /*! HT_ARENA tables: number of slots of arena_interned, a power of two */
+    size_t arena_interned_size;
+    /*! HT_ARENA tables: number of keys in arena_interned */
+    size_t arena_nb_interned;
+    /*! HASH_TRIE mode: root of the adaptive radix tree */
+    HASH_ART_NODE* root;
     /*! HASH_TRIE mode: size of the alphabet */
     size_t alphabet_length;
     /*! HASH_TRIE mode: offset to deduce to individual key digits */
     size_t alphabet_offset;
-    /*! hashing mode, murmurhash and classic HASH_MURMUR, or HASH_TRIE */
+    /*! HASH_OPEN mode: flat array of size inline nodes */
+    HASH_NODE* open_nodes;
+    /*! HASH_OPEN mode: per slot probe distance plus one, 0 for an empty slot */
+    uint8_t* open_dist;
+    /*! HASH_CONCURRENT mode: array of nb_shards shards */
+    HASH_CONCURRENT_SHARD* shards;
+    /*! HASH_CONCURRENT mode: number of shards */
+    size_t nb_shards;
+    /*! HASH_SNAPSHOT mode: mapped image, NULL once the table is emptied */
+    const char* snapshot_image;
+    /*! HASH_SNAPSHOT mode: size in bytes of snapshot_image */
+    size_t snapshot_image_size;
+    /*! HASH_SNAPSHOT mode: slot array of the image, size slots */
+    const HASH_SNAPSHOT_SLOT* snapshot_slots;
+    /*! HASH_SNAPSHOT mode: HASH_OPEN table of the keys put since the image was opened, shadowing the image ones */
+    struct HASH_TABLE* snapshot_overlay;
+    /*! HASH_SNAPSHOT mode: HASH_OPEN table of the image keys removed since the image was opened */
+    struct HASH_TABLE* snapshot_removed;
+    /*! hashing mode, murmurhash and classic HASH_MURMUR, HASH_TRIE, HASH_OPEN, HASH_CONCURRENT or HASH_SNAPSHOT */
     unsigned int mode;
     /*! get HASH_NODE at 'key' from table */
     HASH_NODE* (*ht_get_node)(struct HASH_TABLE* table, const char* key);
@@ -183,10 +442,55 @@ typedef struct HASH_TABLE {
     void (*ht_print)(struct HASH_TABLE* table);
 } HASH_TABLE;
 
+/*! HASH_TRIE cursors: one level of the tree walk */
+typedef struct HASH_CURSOR_FRAME {
+    /*! inner node or tagged leaf */
+    const void* ptr;
+    /*! inner nodes: next child key byte to visit */
+    size_t byte;
+    /*! inner nodes: TRUE once the node leaf was visited */
+    int leaf_done;
+} HASH_CURSOR_FRAME;
+
+/*! resumable walk over the nodes of a table, optionally restricted to the keys starting with a prefix */
+typedef struct HASH_CURSOR {
+    /*! walked table */
+    HASH_TABLE* table;
+    /*! copy of the key prefix, NULL to walk the whole table */
+    char* prefix;
+    /*! length of prefix */
+    size_t prefix_len;
+    /*! HASH_CLASSIC, HASH_OPEN and HASH_SNAPSHOT modes: index of the next bucket or slot */
+    size_t position;
+    /*! HASH_CLASSIC mode: last returned list node, NULL to start the bucket at position */
+    LIST_NODE* list_node;
+    /*! HASH_SNAPSHOT mode: storage of the last node read from the image */
+    HASH_NODE image_node;
+    /*! HASH_TRIE mode: root of the walked subtree, NULL if no key has the prefix */
+    const void* trie_start;
+    /*! HASH_TRIE mode: key position of trie_start */
+    size_t trie_start_depth;
+    /*! HASH_TRIE mode: walk stack */
+    HASH_CURSOR_FRAME* stack;
+    /*! HASH_TRIE mode: number of allocated frames in stack */
+    size_t stack_size;
+    /*! HASH_TRIE mode: number of used frames in stack */
+    size_t stack_depth;
+} HASH_CURSOR;
+
 /*! Cast a HASH_NODE element */
 #define hash_val(node, type) \
     ((node && node->ptr) ? ((type*)(((HASH_NODE*)node->ptr)->data.ptr)) : NULL)
 
+/*! HASH_CLASSIC mode: first LIST_NODE of the bucket at iteration index __IT_, in [ 0 , size + rehash_size [. Buckets of hash_table come first, then the ones of rehash_table during an incremental resize. Migrated or not yet created buckets are NULL */
+#define ht_bucket_start(__HASH_, __IT_)                                                                          \
+    (((__IT_) < (__HASH_)->size) ? (((__HASH_)->hash_table[(__IT_)])                                              \
+                                        ? (__HASH_)->hash_table[(__IT_)]->start                                   \
+                                        : NULL)                                                                   \
+                                 : (((__HASH_)->rehash_table[(__IT_) - (__HASH_)->size])                          \
+                                        ? (__HASH_)->rehash_table[(__IT_) - (__HASH_)->size]->start               \
+                                        : NULL))
+
 /*! ForEach macro helper (classic / old) */
 #define ht_foreach(__ITEM_, __HASH_)                                                                              \
     if (!__HASH_) {                                                                                               \
@@ -194,8 +498,8 @@ typedef struct HASH_TABLE {
     } else if (__HASH_->mode != HASH_CLASSIC) {                                                                   \
         n_log(LOG_ERR, "Error in ht_foreach( %s , %s ) unsupportted mode %d", #__ITEM_, #__HASH_, __HASH_->mode); \
     } else                                                                                                        \
-        for (size_t __hash_it = 0; __hash_it < __HASH_->size; __hash_it++)                                        \
-            for (LIST_NODE* __ITEM_ = __HASH_->hash_table[__hash_it]->start; __ITEM_ != NULL; __ITEM_ = __ITEM_->next)
+        for (size_t __hash_it = 0; __hash_it < __HASH_->size + __HASH_->rehash_size; __hash_it++)                 \
+            for (LIST_NODE* __ITEM_ = ht_bucket_start(__HASH_, __hash_it); __ITEM_ != NULL; __ITEM_ = __ITEM_->next)
 
 /*! ForEach macro helper, reentrant (classic / old)  */
 #define ht_foreach_r(__ITEM_, __HASH_, __ITERATOR_)                                      \
@@ -204,8 +508,8 @@ typedef struct HASH_TABLE {
     } else if (__HASH_->mode != HASH_CLASSIC) {                                          \
         n_log(LOG_ERR, "Error in ht_foreach, %d is an unsupported mode", __HASH_->mode); \
     } else                                                                               \
-        for (size_t __ITERATOR_ = 0; __ITERATOR_ < __HASH_->size; __ITERATOR_++)         \
-            for (LIST_NODE* __ITEM_ = __HASH_->hash_table[__ITERATOR_]->start; __ITEM_ != NULL; __ITEM_ = __ITEM_->next)
+        for (size_t __ITERATOR_ = 0; __ITERATOR_ < __HASH_->size + __HASH_->rehash_size; __ITERATOR_++) \
+            for (LIST_NODE* __ITEM_ = ht_bucket_start(__HASH_, __ITERATOR_); __ITEM_ != NULL; __ITEM_ = __ITEM_->next)
 
 /*! Cast a HASH_NODE element */
 #define HASH_VAL(node, type) \
@@ -220,8 +524,8 @@ typedef struct HASH_TABLE {
             } else {                                                                                                                                                                                 \
                 if (__HASH_->mode == HASH_CLASSIC) {                                                                                                                                                 \
                     int CONCAT(__ht_node_trie_func_macro_break_flag_classic, __LINE__) = 0;                                                                                                          \
-                    for (size_t __hash_it = 0; __hash_it < __HASH_->size; __hash_it++) {                                                                                                             \
-                        for (LIST_NODE* __ht_list_node = __HASH_->hash_table[__hash_it]->start; __ht_list_node != NULL; __ht_list_node = __ht_list_node->next) {                                     \
+                    for (size_t __hash_it = 0; __hash_it < __HASH_->size + __HASH_->rehash_size; __hash_it++) {                                                                                      \
+                        for (LIST_NODE* __ht_list_node = ht_bucket_start(__HASH_, __hash_it); __ht_list_node != NULL; __ht_list_node = __ht_list_node->next) {                                       \
                             HASH_NODE* __ITEM_ = (HASH_NODE*)__ht_list_node->ptr;                                                                                                                    \
                             CONCAT(__ht_node_trie_func_macro_break_flag_classic, __LINE__) = 1;                                                                                                      \
                             __VA_ARGS__                                                                                                                                                              \
@@ -230,25 +534,60 @@ typedef struct HASH_TABLE {
                         if (CONCAT(__ht_node_trie_func_macro_break_flag_classic, __LINE__) == 1)                                                                                                     \
                             break;                                                                                                                                                                   \
                     }                                                                                                                                                                                \
+                } else if (__HASH_->mode == HASH_OPEN) {                                                                                                                                             \
+                    for (size_t __hash_it = 0; __hash_it < __HASH_->size; __hash_it++) {                                                                                                             \
+                        if (__HASH_->open_dist[__hash_it] != 0) {                                                                                                                                    \
+                            HASH_NODE* __ITEM_ = &__HASH_->open_nodes[__hash_it];                                                                                                                    \
+                            __VA_ARGS__                                                                                                                                                              \
+                        }                                                                                                                                                                            \
+                    }                                                                                                                                                                                \
+                } else if (__HASH_->mode == HASH_CONCURRENT) {                                                                                                                                       \
+                    int CONCAT(__ht_concurrent_break_flag, __LINE__) = 0;                                                                                                                            \
+                    for (size_t __ht_shard_it = 0; __ht_shard_it < __HASH_->nb_shards && CONCAT(__ht_concurrent_break_flag, __LINE__) == 0; __ht_shard_it++) {                                       \
+                        HASH_CONCURRENT_SHARD* CONCAT(__ht_shard, __LINE__) = &__HASH_->shards[__ht_shard_it];                                                                                       \
+                        size_t CONCAT(__ht_parity, __LINE__) = ht_concurrent_read_enter(CONCAT(__ht_shard, __LINE__));                                                                               \
+                        for (size_t __hash_it = 0; __hash_it < CONCAT(__ht_shard, __LINE__)->size; __hash_it++) {                                                                                    \
+                            for (HASH_CONCURRENT_ENTRY* __ht_entry = __atomic_load_n(&CONCAT(__ht_shard, __LINE__)->buckets[__hash_it], __ATOMIC_ACQUIRE); __ht_entry != NULL; __ht_entry = __atomic_load_n(&__ht_entry->next, __ATOMIC_ACQUIRE)) {\
+                                HASH_NODE* __ITEM_ = &__ht_entry->node;                                                                                                                              \
+                                CONCAT(__ht_concurrent_break_flag, __LINE__) = 1;                                                                                                                    \
+                                __VA_ARGS__                                                                                                                                                          \
+                                CONCAT(__ht_concurrent_break_flag, __LINE__) = 0;                                                                                                                    \
+                            }                                                                                                                                                                        \
+                            if (CONCAT(__ht_concurrent_break_flag, __LINE__) == 1)                                                                                                                   \
+                                break;                                                                                                                                                               \
+                        }                                                                                                                                                                            \
+                        ht_concurrent_read_exit(CONCAT(__ht_shard, __LINE__), CONCAT(__ht_parity, __LINE__));                                                                                        \
+                    }                                                                                                                                                                                \
+                } else if (__HASH_->mode == HASH_SNAPSHOT) {                                                                                                                                          \
+                    HASH_NODE CONCAT(__ht_snapshot_node, __LINE__);                                                                                                                                   \
+                    size_t CONCAT(__ht_snapshot_position, __LINE__) = 0;                                                                                                                              \
+                    for (HASH_NODE* __ITEM_ = ht_snapshot_next(__HASH_, &CONCAT(__ht_snapshot_position, __LINE__), &CONCAT(__ht_snapshot_node, __LINE__)); __ITEM_ != NULL; __ITEM_ = ht_snapshot_next(__HASH_, &CONCAT(__ht_snapshot_position, __LINE__), &CONCAT(__ht_snapshot_node, __LINE__))) { \
+                        __VA_ARGS__                                                                                                                                                                   \
+                    }                                                                                                                                                                                 \
                 } else if (__HASH_->mode == HASH_TRIE) {                                                                                                                                             \
-                    int CONCAT(__ht_node_trie_func_macro, __LINE__)(HASH_NODE * __ITEM_) {                                                                                                           \
-                        if (!__ITEM_) return TRUE;                                                                                                                                                   \
-                        int CONCAT(__ht_node_trie_func_macro_break_flag, __LINE__) = 1;                                                                                                              \
-                        if (__ITEM_->is_leaf) {                                                                                                                                                      \
+                    int CONCAT(__ht_node_trie_func_macro, __LINE__)(void* __ht_art_ptr) {                                                                                                            \
+                        if (!__ht_art_ptr) return TRUE;                                                                                                                                              \
+                        if (HASH_ART_IS_LEAF(__ht_art_ptr)) {                                                                                                                                        \
+                            HASH_NODE* __ITEM_ = HASH_ART_LEAF(__ht_art_ptr);                                                                                                                        \
+                            int CONCAT(__ht_node_trie_func_macro_break_flag, __LINE__) = 1;                                                                                                          \
                             do {                                                                                                                                                                     \
                                 __VA_ARGS__                                                                                                                                                          \
                                 CONCAT(__ht_node_trie_func_macro_break_flag, __LINE__) = 0;                                                                                                          \
                             } while (0);                                                                                                                                                             \
+                            return (CONCAT(__ht_node_trie_func_macro_break_flag, __LINE__) == 1) ? FALSE : TRUE;                                                                                     \
                         }                                                                                                                                                                            \
-                        if (CONCAT(__ht_node_trie_func_macro_break_flag, __LINE__) == 1) return FALSE;                                                                                               \
-                        for (size_t CONCAT(__ht_node_trie_func_it, __LINE__) = 0; CONCAT(__ht_node_trie_func_it, __LINE__) < __ITEM_->alphabet_length; CONCAT(__ht_node_trie_func_it, __LINE__)++) { \
-                            if (CONCAT(__ht_node_trie_func_macro, __LINE__)(__ITEM_->children[CONCAT(__ht_node_trie_func_it, __LINE__)]) == FALSE)                                                   \
+                        HASH_ART_NODE* CONCAT(__ht_art_node, __LINE__) = (HASH_ART_NODE*)__ht_art_ptr;                                                                                               \
+                        if (CONCAT(__ht_art_node, __LINE__)->leaf && CONCAT(__ht_node_trie_func_macro, __LINE__)(HASH_ART_TAG_LEAF(CONCAT(__ht_art_node, __LINE__)->leaf)) == FALSE)                 \
+                            return FALSE;                                                                                                                                                            \
+                        for (size_t CONCAT(__ht_art_byte, __LINE__) = 0;; CONCAT(__ht_art_byte, __LINE__)++) {                                                                                       \
+                            void* CONCAT(__ht_art_child, __LINE__) = ht_art_next_child(CONCAT(__ht_art_node, __LINE__), &CONCAT(__ht_art_byte, __LINE__));                                           \
+                            if (!CONCAT(__ht_art_child, __LINE__)) break;                                                                                                                            \
+                            if (CONCAT(__ht_node_trie_func_macro, __LINE__)(CONCAT(__ht_art_child, __LINE__)) == FALSE)                                                                              \
                                 return FALSE;                                                                                                                                                        \
                         }                                                                                                                                                                            \
                         return TRUE;                                                                                                                                                                 \
                     }                                                                                                                                                                                \
-                    CONCAT(__ht_node_trie_func_macro, __LINE__)                                                                                                                                      \
-                    (__HASH_->root);                                                                                                                                                                 \
+                    CONCAT(__ht_node_trie_func_macro, __LINE__)(__HASH_->root);                                                                                                                      \
                 } else {                                                                                                                                                                             \
                     n_log(LOG_ERR, "Error in ht_foreach, %d is an unsupported mode", __HASH_->mode);                                                                                                 \
                     break;                                                                                                                                                                           \
@@ -267,8 +606,8 @@ typedef struct HASH_TABLE {
                 if (__HASH_->mode == HASH_CLASSIC) {                                                                                                                                                                                   \
                     int CONCAT(__ht_node_trie_func_macro_break_flag_classic, __LINE__) = 0;                                                                                                                                            \
                     LIST_NODE* CONCAT(__ht_list_node_r, __LINE__) = NULL;                                                                                                                                                              \
-                    for (size_t __ITERATOR = 0; __ITERATOR < __HASH_->size; __ITERATOR++) {                                                                                                                                            \
-                        for (CONCAT(__ht_list_node_r, __LINE__) = __HASH_->hash_table[__ITERATOR]->start; CONCAT(__ht_list_node_r, __LINE__) != NULL; CONCAT(__ht_list_node_r, __LINE__) = CONCAT(__ht_list_node_r, __LINE__)->next) { \
+                    for (size_t __ITERATOR = 0; __ITERATOR < __HASH_->size + __HASH_->rehash_size; __ITERATOR++) {                                                                                                                     \
+                        for (CONCAT(__ht_list_node_r, __LINE__) = ht_bucket_start(__HASH_, __ITERATOR); CONCAT(__ht_list_node_r, __LINE__) != NULL; CONCAT(__ht_list_node_r, __LINE__) = CONCAT(__ht_list_node_r, __LINE__)->next) { \
                             HASH_NODE* __ITEM_ = (HASH_NODE*)CONCAT(__ht_list_node_r, __LINE__)->ptr;                                                                                                                                  \
                             CONCAT(__ht_node_trie_func_macro_break_flag_classic, __LINE__) = 1;                                                                                                                                        \
                             __VA_ARGS__                                                                                                                                                                                                \
@@ -277,25 +616,60 @@ typedef struct HASH_TABLE {
                         if (CONCAT(__ht_node_trie_func_macro_break_flag_classic, __LINE__) == 1)                                                                                                                                       \
                             break;                                                                                                                                                                                                     \
                     }                                                                                                                                                                                                                  \
+                } else if (__HASH_->mode == HASH_OPEN) {                                                                                                                                                                               \
+                    for (size_t __ITERATOR = 0; __ITERATOR < __HASH_->size; __ITERATOR++) {                                                                                                                                            \
+                        if (__HASH_->open_dist[__ITERATOR] != 0) {                                                                                                                                                                     \
+                            HASH_NODE* __ITEM_ = &__HASH_->open_nodes[__ITERATOR];                                                                                                                                                     \
+                            __VA_ARGS__                                                                                                                                                                                                \
+                        }                                                                                                                                                                                                              \
+                    }                                                                                                                                                                                                                  \
+                } else if (__HASH_->mode == HASH_CONCURRENT) {                                                                                                                                                                         \
+                    int CONCAT(__ht_concurrent_break_flag, __LINE__) = 0;                                                                                                                                                              \
+                    for (size_t __ht_shard_it = 0; __ht_shard_it < __HASH_->nb_shards && CONCAT(__ht_concurrent_break_flag, __LINE__) == 0; __ht_shard_it++) {                                                                         \
+                        HASH_CONCURRENT_SHARD* CONCAT(__ht_shard, __LINE__) = &__HASH_->shards[__ht_shard_it];                                                                                                                         \
+                        size_t CONCAT(__ht_parity, __LINE__) = ht_concurrent_read_enter(CONCAT(__ht_shard, __LINE__));                                                                                                                 \
+                        for (size_t __ITERATOR = 0; __ITERATOR < CONCAT(__ht_shard, __LINE__)->size; __ITERATOR++) {                                                                                                                   \
+                            for (HASH_CONCURRENT_ENTRY* __ht_entry = __atomic_load_n(&CONCAT(__ht_shard, __LINE__)->buckets[__ITERATOR], __ATOMIC_ACQUIRE); __ht_entry != NULL; __ht_entry = __atomic_load_n(&__ht_entry->next, __ATOMIC_ACQUIRE)) {\
+                                HASH_NODE* __ITEM_ = &__ht_entry->node;                                                                                                                                                                \
+                                CONCAT(__ht_concurrent_break_flag, __LINE__) = 1;                                                                                                                                                      \
+                                __VA_ARGS__                                                                                                                                                                                            \
+                                CONCAT(__ht_concurrent_break_flag, __LINE__) = 0;                                                                                                                                                      \
+                            }                                                                                                                                                                                                          \
+                            if (CONCAT(__ht_concurrent_break_flag, __LINE__) == 1)                                                                                                                                                     \
+                                break;                                                                                                                                                                                                 \
+                        }                                                                                                                                                                                                              \
+                        ht_concurrent_read_exit(CONCAT(__ht_shard, __LINE__), CONCAT(__ht_parity, __LINE__));                                                                                                                          \
+                    }                                                                                                                                                                                                                  \
+                } else if (__HASH_->mode == HASH_SNAPSHOT) {                                                                                                                                                                            \
+                    HASH_NODE CONCAT(__ht_snapshot_node, __LINE__);                                                                                                                                                                     \
+                    size_t __ITERATOR = 0;                                                                                                                                                                                              \
+                    for (HASH_NODE* __ITEM_ = ht_snapshot_next(__HASH_, &__ITERATOR, &CONCAT(__ht_snapshot_node, __LINE__)); __ITEM_ != NULL; __ITEM_ = ht_snapshot_next(__HASH_, &__ITERATOR, &CONCAT(__ht_snapshot_node, __LINE__))) { \
+                        __VA_ARGS__                                                                                                                                                                                                     \
+                    }                                                                                                                                                                                                                   \
                 } else if (__HASH_->mode == HASH_TRIE) {                                                                                                                                                                               \
-                    int CONCAT(__ht_node_trie_func_macro, __LINE__)(HASH_NODE * __ITEM_) {                                                                                                                                             \
-                        if (!__ITEM_) return TRUE;                                                                                                                                                                                     \
-                        int CONCAT(__ht_node_trie_func_macro_break_flag, __LINE__) = 1;                                                                                                                                                \
-                        if (__ITEM_->is_leaf) {                                                                                                                                                                                        \
+                    int CONCAT(__ht_node_trie_func_macro, __LINE__)(void* __ht_art_ptr) {                                                                                                                                              \
+                        if (!__ht_art_ptr) return TRUE;                                                                                                                                                                                \
+                        if (HASH_ART_IS_LEAF(__ht_art_ptr)) {                                                                                                                                                                          \
+                            HASH_NODE* __ITEM_ = HASH_ART_LEAF(__ht_art_ptr);                                                                                                                                                          \
+                            int CONCAT(__ht_node_trie_func_macro_break_flag, __LINE__) = 1;                                                                                                                                            \
                             do {                                                                                                                                                                                                       \
                                 __VA_ARGS__                                                                                                                                                                                            \
                                 CONCAT(__ht_node_trie_func_macro_break_flag, __LINE__) = 0;                                                                                                                                            \
                             } while (0);                                                                                                                                                                                               \
+                            return (CONCAT(__ht_node_trie_func_macro_break_flag, __LINE__) == 1) ? FALSE : TRUE;                                                                                                                       \
                         }                                                                                                                                                                                                              \
-                        if (CONCAT(__ht_node_trie_func_macro_break_flag, __LINE__) == 1) return FALSE;                                                                                                                                 \
-                        for (size_t it = 0; it < __ITEM_->alphabet_length; it++) {                                                                                                                                                     \
-                            if (CONCAT(__ht_node_trie_func_macro, __LINE__)(__ITEM_->children[it]) == FALSE)                                                                                                                           \
+                        HASH_ART_NODE* CONCAT(__ht_art_node, __LINE__) = (HASH_ART_NODE*)__ht_art_ptr;                                                                                                                                 \
+                        if (CONCAT(__ht_art_node, __LINE__)->leaf && CONCAT(__ht_node_trie_func_macro, __LINE__)(HASH_ART_TAG_LEAF(CONCAT(__ht_art_node, __LINE__)->leaf)) == FALSE)                                                   \
+                            return FALSE;                                                                                                                                                                                              \
+                        for (size_t CONCAT(__ht_art_byte, __LINE__) = 0;; CONCAT(__ht_art_byte, __LINE__)++) {                                                                                                                         \
+                            void* CONCAT(__ht_art_child, __LINE__) = ht_art_next_child(CONCAT(__ht_art_node, __LINE__), &CONCAT(__ht_art_byte, __LINE__));                                                                             \
+                            if (!CONCAT(__ht_art_child, __LINE__)) break;                                                                                                                                                              \
+                            if (CONCAT(__ht_node_trie_func_macro, __LINE__)(CONCAT(__ht_art_child, __LINE__)) == FALSE)                                                                                                                \
                                 return FALSE;                                                                                                                                                                                          \
                         }                                                                                                                                                                                                              \
                         return TRUE;                                                                                                                                                                                                   \
                     }                                                                                                                                                                                                                  \
-                    CONCAT(__ht_node_trie_func_macro, __LINE__)                                                                                                                                                                        \
-                    (__HASH_->root);                                                                                                                                                                                                   \
+                    CONCAT(__ht_node_trie_func_macro, __LINE__)(__HASH_->root);                                                                                                                                                        \
                 } else {                                                                                                                                                                                                               \
                     n_log(LOG_ERR, "Error in ht_foreach, %d is an unsupported mode", __HASH_->mode);                                                                                                                                   \
                     break;                                                                                                                                                                                                             \
@@ -319,8 +693,35 @@ HASH_NODE* ht_get_node(HASH_TABLE* table, const char* key);
 
 /*! @brief create a new classic hash table of the given size */
 HASH_TABLE* new_ht(size_t size);
+/*! @brief create a new classic hash table of the given size, with new_ht_ex flags */
+HASH_TABLE* new_ht_ex(size_t size, unsigned int flags);
 /*! @brief create a new trie hash table with the given alphabet size and offset */
 HASH_TABLE* new_ht_trie(size_t alphabet_size, size_t alphabet_offset);
+/*! @brief create a new open addressing hash table able to hold size keys before growing */
+HASH_TABLE* new_ht_open(size_t size);
+/*! @brief create a concurrent sharded hash table with lock free readers */
+HASH_TABLE* new_ht_concurrent(size_t size, size_t nb_shards);
+/*! @brief write the keys and int, double or string values of a table to a memory mappable image file */
+int ht_save_snapshot(HASH_TABLE* table, const char* path);
+/*! @brief open an image file written by ht_save_snapshot as a HASH_SNAPSHOT table */
+HASH_TABLE* ht_open_snapshot(const char* path);
+/*! @brief enter a lock free read section on a HASH_CONCURRENT shard */
+size_t ht_concurrent_read_enter(HASH_CONCURRENT_SHARD* shard);
+/*! @brief leave a lock free read section on a HASH_CONCURRENT shard */
+void ht_concurrent_read_exit(HASH_CONCURRENT_SHARD* shard, size_t parity);
+/*! @brief enter the read section of the shard of a HASH_CONCURRENT key, the values got inside stay valid until ht_concurrent_read_unlock */
+size_t ht_concurrent_read_lock(HASH_TABLE* table, const char* key);
+/*! @brief leave a read section entered by ht_concurrent_read_lock */
+void ht_concurrent_read_unlock(HASH_TABLE* table, const char* key, size_t parity);
+/*! @brief ht_concurrent_read_lock for a key hashed by ht_hash_key */
+size_t ht_concurrent_read_lock_hashed(HASH_TABLE* table, HASH_VALUE hash_value);
+/*! @brief leave a read section entered by ht_concurrent_read_lock_hashed */
+void ht_concurrent_read_unlock_hashed(HASH_TABLE* table, HASH_VALUE hash_value, size_t parity);
+/*! @brief get the next node of a HASH_SNAPSHOT table, overlay first, then image */
+HASH_NODE* ht_snapshot_next(HASH_TABLE* table, size_t* position, HASH_NODE* image_node);
+
+/*! @brief get the first child of an adaptive radix tree node with a key byte greater or equal to byte */
+void* ht_art_next_child(const HASH_ART_NODE* node, size_t* byte);
 
 /*! @brief get a double value from the hash table by key */
 int ht_get_double(HASH_TABLE* table, const char* key, double* val);
@@ -360,6 +761,33 @@ int ht_get_ptr_ex(HASH_TABLE* table, HASH_VALUE hash_value, void** val);
 /*! @brief remove a node by numeric hash value */
 int ht_remove_ex(HASH_TABLE* table, HASH_VALUE hash_value);
 
+/*! @brief get the pointer values of nb keys, hashing and prefetching in batches */
+size_t ht_get_ptr_many(HASH_TABLE* table, const char* const* keys, size_t nb, void** values);
+/*! @brief put nb pointer values at their keys, hashing and prefetching in batches */
+size_t ht_put_ptr_many(HASH_TABLE* table, const char* const* keys, size_t nb, void* const* values, void (*destructor)(void* ptr), void* (*duplicator)(void* ptr));
+/*! @brief get the hash of a key as computed by a table */
+HASH_VALUE ht_hash_key(const HASH_TABLE* table, const char* key, size_t len);
+/*! @brief get a string value from a key and its hash given by ht_hash_key */
+int ht_get_string_hashed(HASH_TABLE* table, const char* key, HASH_VALUE hash_value, char** val);
+
+/*! @brief set the completion weight of a HASH_TRIE key */
+int ht_trie_set_weight(HASH_TABLE* table, const char* key, size_t weight);
+/*! @brief add to the completion weight of a HASH_TRIE key */
+int ht_trie_add_weight(HASH_TABLE* table, const char* key, size_t delta);
+/*! @brief get the max_results heaviest keys starting with keybud, heaviest first */
+LIST* ht_get_completion_list_ranked(HASH_TABLE* table, const char* keybud, size_t max_results);
+
+/*! @brief open a cursor on the nodes of a table, optionally restricted to the keys starting with prefix */
+HASH_CURSOR* ht_cursor_open(HASH_TABLE* table, const char* prefix);
+/*! @brief get the next node of a cursor */
+HASH_NODE* ht_cursor_next(HASH_CURSOR* cursor);
+/*! @brief restart a cursor from its first node */
+int ht_cursor_rewind(HASH_CURSOR* cursor);
+/*! @brief resume a cursor after key, a key previously returned by a cursor on the same table */
+int ht_cursor_seek(HASH_CURSOR* cursor, const char* key);
+/*! @brief close a cursor and set it to NULL */
+int ht_cursor_close(HASH_CURSOR** cursor);
+
 /*! @brief get a list of key completions matching the given prefix */
 LIST* ht_get_completion_list(HASH_TABLE* table, const char* keybud, size_t max_results);
 
@@ -376,6 +804,12 @@ size_t ht_get_optimal_size(HASH_TABLE* table);
 int ht_resize(HASH_TABLE** table, size_t size);
 /*! @brief optimize a hash table by resizing to the optimal size */
 int ht_optimize(HASH_TABLE** table);
+/*! @brief set the load factor triggering an incremental grow of a HASH_CLASSIC table */
+int ht_set_max_load(HASH_TABLE* table, size_t max_load_percent);
+/*! @brief start an incremental resize of a HASH_CLASSIC table */
+int ht_resize_incremental(HASH_TABLE* table, size_t size);
+/*! @brief migrate some buckets of an in progress incremental resize */
+int ht_rehash_step(HASH_TABLE* table, size_t nb_buckets);
 /*! @brief duplicate a hash table */
 HASH_TABLE* ht_duplicate(HASH_TABLE* table);
 
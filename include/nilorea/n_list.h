@@ -38,6 +38,7 @@ extern "C" {
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 
 /*! Structure of a generic list node */
 typedef struct LIST_NODE {
@@ -66,8 +67,57 @@ typedef struct LIST {
     /*! pointer to the end of the list */
     LIST_NODE* end;
 
+    /*! released nodes kept for the next insertions, linked by their next pointer */
+    LIST_NODE* free_nodes;
+    /*! number of nodes in free_nodes */
+    size_t nb_free_nodes;
+    /*! maximum number of nodes kept in free_nodes, 0 to free the released nodes */
+    size_t nb_max_free_nodes;
+
 } LIST;
 
+/*! link of an intrusive list, to embed in the structures put in an ILIST */
+typedef struct ILIST_LINK {
+    /*! next link, or the list head for the last one */
+    struct ILIST_LINK* next;
+    /*! previous link, or the list head for the first one */
+    struct ILIST_LINK* prev;
+} ILIST_LINK;
+
+/*! Structure of an intrusive list: the links live in the items, pushing and removing never allocate */
+typedef struct ILIST {
+    /*! circular head, head.next is the first link and head.prev the last one */
+    ILIST_LINK head;
+    /*! number of items currently in the list */
+    size_t nb_items;
+} ILIST;
+
+/*! node of a MPSC_QUEUE */
+typedef struct MPSC_NODE {
+    /*! next node, written once by the producer which queued it after this one */
+    struct MPSC_NODE* next;
+    /*! queued pointer */
+    void* ptr;
+} MPSC_NODE;
+
+/*! Structure of a lock-free multiple producers / single consumer queue (intrusive Vyukov queue). Any thread can push, only one at a time can pop. */
+typedef struct MPSC_QUEUE {
+    /*! last queued node, swapped by the producers */
+    MPSC_NODE* head;
+    /*! padding between the producers side and the consumer side of the queue */
+    char head_pad[64 - sizeof(MPSC_NODE*)];
+    /*! oldest node, only touched by the consumer */
+    MPSC_NODE* tail;
+    /*! empty node keeping the queue linked when everything was popped */
+    MPSC_NODE stub;
+    /*! number of items currently in the queue, atomic */
+    size_t nb_items;
+    /*! Maximum number of items in the queue. 0 means unlimited */
+    size_t nb_max_items;
+    /*! destructor for the pointers left in the queue, or NULL */
+    void (*destroy_func)(void* ptr);
+} MPSC_QUEUE;
+
 /*! flag to pass to new_generic_list for an unlimited number of item in the list. Can be dangerous ! */
 #define UNLIMITED_LIST_ITEMS 0
 /*! flag to pass to new_generic_list for the maximum possible number of item in a list */
@@ -89,6 +139,17 @@ typedef struct LIST {
     for (LIST_NODE* __ITEM_ = (__LIST_) ? (__LIST_)->start : NULL, *__next_##__ITEM_ = __ITEM_ ? __ITEM_->next : NULL; __ITEM_; __ITEM_ = __next_##__ITEM_, \
                     __next_##__ITEM_ = __ITEM_ ? __ITEM_->next : NULL)
 
+/*! default number of released nodes kept by list_node_cache */
+#define LIST_NODE_CACHE_SIZE 1024
+
+/*! get the structure of type __TYPE_ holding the ILIST_LINK __LINK_ as its member __MEMBER_ */
+#define ilist_entry(__LINK_, __TYPE_, __MEMBER_) ((__TYPE_*)(void*)((char*)(__LINK_) - offsetof(__TYPE_, __MEMBER_)))
+
+/*! ForEach macro helper for intrusive lists, safe for link removal during iteration */
+#define ilist_foreach(__LINK_, __ILIST_)                                                                                      \
+    for (ILIST_LINK* __LINK_ = (__ILIST_)->head.next, *__next_##__LINK_ = __LINK_->next; __LINK_ != &(__ILIST_)->head; \
+         __LINK_ = __next_##__LINK_, __next_##__LINK_ = __LINK_->next)
+
 /*! Pop macro helper for void pointer casting */
 #define list_pop(__LIST_, __TYPE_) (__TYPE_*)list_pop_f(__LIST_)
 /*! Shift macro helper for void pointer casting */
@@ -120,6 +181,11 @@ int list_unshift(LIST* list, void* ptr, void (*destructor)(void* ptr));
 /*! put a pointer sorted via comparator from the start to the end */
 int list_unshift_sorted(LIST* list, void* ptr, int (*comparator)(const void* a, const void* b), void (*destructor)(void* ptr));
 
+/*! sort a list with a stable merge sort */
+int list_sort(LIST* list, int (*comparator)(const void* a, const void* b));
+/*! merge the sorted list src into the sorted list dest */
+int list_merge_sorted(LIST* dest, LIST* src, int (*comparator)(const void* a, const void* b));
+
 /*! get last ptr from list */
 void* list_pop_f(LIST* list);
 /*! get first ptr from list */
@@ -138,6 +204,43 @@ int list_empty_with_f(LIST* list, void (*free_fnct)(void* ptr));
 /*! free the list */
 int list_destroy(LIST** list);
 
+/*! keep up to max_free_nodes released nodes in the list for the next insertions */
+int list_node_cache(LIST* list, size_t max_free_nodes);
+/*! allocate nodes in the list cache ahead of insertions */
+int list_reserve_nodes(LIST* list, size_t nb_nodes);
+
+/*! create a multiple producers / single consumer queue */
+MPSC_QUEUE* new_mpsc_queue(size_t max_items, void (*destructor)(void* ptr));
+/*! add a pointer at the end of the queue, from any thread */
+int mpsc_push(MPSC_QUEUE* queue, void* ptr);
+/*! get the pointer at the start of the queue, from the consumer thread */
+void* mpsc_pop(MPSC_QUEUE* queue);
+/*! get the number of items in the queue */
+size_t mpsc_nb_items(MPSC_QUEUE* queue);
+/*! empty the queue, from the consumer thread */
+int mpsc_empty(MPSC_QUEUE* queue);
+/*! free the queue */
+int destroy_mpsc_queue(MPSC_QUEUE** queue);
+
+/*! initialize an intrusive list */
+void ilist_init(ILIST* list);
+/*! tell if a link is in no intrusive list */
+int ilist_is_unlinked(const ILIST_LINK* link);
+/*! add a link at the end of an intrusive list */
+void ilist_push(ILIST* list, ILIST_LINK* link);
+/*! add a link at the beginning of an intrusive list */
+void ilist_unshift(ILIST* list, ILIST_LINK* link);
+/*! add a link after another one of an intrusive list */
+void ilist_insert_after(ILIST* list, ILIST_LINK* where, ILIST_LINK* link);
+/*! remove a link from an intrusive list */
+void ilist_remove(ILIST* list, ILIST_LINK* link);
+/*! remove and return the last link of an intrusive list */
+ILIST_LINK* ilist_pop(ILIST* list);
+/*! remove and return the first link of an intrusive list */
+ILIST_LINK* ilist_shift(ILIST* list);
+/*! move all the links of an intrusive list at the end of another one */
+void ilist_splice(ILIST* dest, ILIST* src);
+
 /**
   @}
   */
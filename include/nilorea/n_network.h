@@ -386,19 +386,27 @@ typedef struct NETWORK {
     /*!networking socket*/
     N_SOCKET link;
 
-    /*!sending buffer (for outgoing queuing )*/
-    LIST* send_buf;
-    /*!reveicing buffer (for incomming usage)*/
-    LIST* recv_buf;
+    /*!sending buffer (for outgoing queuing ), lock-free for the producers */
+    MPSC_QUEUE* send_buf;
+    /*!reveicing buffer (for incomming usage), lock-free for the producers */
+    MPSC_QUEUE* recv_buf;
+    /*! number of producers inside a push to send_buf, drained by netw_set before destroying it */
+    int send_buf_pushers;
+    /*! number of producers inside a push to recv_buf, drained by netw_set before destroying it */
+    int recv_buf_pushers;
+    /*! set by netw_set before destroying send_buf, later pushes fail */
+    int send_buf_closing;
+    /*! set by netw_set before destroying recv_buf, later pushes fail */
+    int recv_buf_closing;
 
     /*!sending thread*/
     pthread_t send_thr;
     /*!receiving thread*/
     pthread_t recv_thr;
 
-    /*!mutex for threaded access of send_buf */
+    /*!mutex serializing the consumers of send_buf, producers do not take it */
     pthread_mutex_t sendbolt;
-    /*!mutex for threaded access of recv buf */
+    /*!mutex serializing the consumers of recv_buf, producers do not take it */
     pthread_mutex_t recvbolt;
     /*!mutex for threaded access of state event */
     pthread_mutex_t eventbolt;
@@ -675,6 +683,8 @@ int netw_add_msg(NETWORK* netw, N_STR* msg);
 int netw_add_msg_ex(NETWORK* netw, char* str, unsigned int length);
 /*! Get a message from aimed NETWORK. Instant return to NULL if no MSG */
 N_STR* netw_get_msg(NETWORK* netw);
+/*! Push a received message to the receive queue of a NETWORK, fails if the queue is being destroyed */
+int netw_push_recv_msg(NETWORK* netw, N_STR* msg);
 /*! Wait a message from aimed NETWORK. Recheck each 'refresh' usec until 'timeout' usec */
 N_STR* netw_wait_msg(NETWORK* netw, unsigned int refresh, size_t timeout);
 /*! Create the sending and receiving thread of a NETWORK */
@@ -753,6 +763,10 @@ const char* netw_get_http_status_message(int status_code);
 int netw_get_http_date(char* buffer, size_t buffer_size);
 /*! build HTTP response */
 int netw_build_http_response(N_STR** http_response, int status_code, const char* server_name, const char* content_type, char* additional_headers, N_STR* body);
+/*! build HTTP response in a string builder, referencing the body */
+int netw_build_http_response_builder(N_STR_BUILDER* builder, int status_code, const char* server_name, const char* content_type, char* additional_headers, N_STR* body);
+/*! send a string builder without flattening it */
+ssize_t netw_send_builder(NETWORK* netw, const N_STR_BUILDER* builder);
 
 /**
  * @brief Parsed proxy URL components.
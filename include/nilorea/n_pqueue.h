@@ -0,0 +1,119 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**@file n_pqueue.h
+ *  Priority queue, d-ary min heap with handles
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#ifndef __N_PQUEUE_HEADER
+#define __N_PQUEUE_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**@defgroup PQUEUE PRIORITY QUEUE: d-ary min heap with decrease-key
+  @addtogroup PQUEUE
+  @{
+  */
+
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+
+#include <stdint.h>
+
+/*! default number of children per heap node, four 16 bytes entries filling a cache line */
+#define PQUEUE_DEFAULT_ARITY 4
+/*! default number of entries allocated by new_pqueue */
+#define PQUEUE_DEFAULT_CAPACITY 64
+/*! value of an invalid handle */
+#define PQUEUE_NO_HANDLE SIZE_MAX
+
+/*! heap entry, the key is kept next to the handle so that sifting never leaves the heap array */
+typedef struct PQUEUE_ENTRY {
+    /*! priority, the smallest comes first */
+    int64_t key;
+    /*! handle of the item */
+    size_t handle;
+} PQUEUE_ENTRY;
+
+/*! item of a handle */
+typedef struct PQUEUE_ITEM {
+    /*! user data */
+    void* ptr;
+    /*! index of the item in the heap, PQUEUE_NO_HANDLE if the handle is free */
+    size_t pos;
+} PQUEUE_ITEM;
+
+/*! structure of a priority queue */
+typedef struct PQUEUE {
+    /*! heap array */
+    PQUEUE_ENTRY* heap;
+    /*! items, indexed by handle */
+    PQUEUE_ITEM* items;
+    /*! stack of the free handles */
+    size_t* free_handles;
+    /*! number of free handles */
+    size_t nb_free_handles;
+    /*! number of handles given so far */
+    size_t nb_handles;
+    /*! number of entries in the heap */
+    size_t nb_items;
+    /*! number of allocated heap entries, items and free handles */
+    size_t capacity;
+    /*! number of children per node */
+    size_t arity;
+    /*! destructor called on the data removed or left in the queue, or NULL */
+    void (*destroy_func)(void* ptr);
+} PQUEUE;
+
+/*! @brief create a new priority queue */
+PQUEUE* new_pqueue(size_t arity, size_t capacity, void (*destructor)(void* ptr));
+/*! @brief add an item and get its handle */
+size_t pqueue_push(PQUEUE* pq, int64_t key, void* ptr);
+/*! @brief add items in bulk and restore the heap in linear time */
+int pqueue_heapify(PQUEUE* pq, const int64_t* keys, void* const* ptrs, size_t nb, size_t* handles);
+/*! @brief get the item with the smallest key without removing it */
+int pqueue_peek(const PQUEUE* pq, int64_t* key, void** ptr);
+/*! @brief remove the item with the smallest key and give it to the caller */
+int pqueue_pop(PQUEUE* pq, int64_t* key, void** ptr);
+/*! @brief get the key and data of a handle */
+int pqueue_get(const PQUEUE* pq, size_t handle, int64_t* key, void** ptr);
+/*! @brief lower the key of a handle */
+int pqueue_decrease_key(PQUEUE* pq, size_t handle, int64_t key);
+/*! @brief change the key of a handle */
+int pqueue_update_key(PQUEUE* pq, size_t handle, int64_t key);
+/*! @brief remove a handle and destroy its data */
+int pqueue_remove(PQUEUE* pq, size_t handle);
+/*! @brief remove all the items */
+int pqueue_empty(PQUEUE* pq);
+/*! @brief destroy a priority queue and set it to NULL */
+int destroy_pqueue(PQUEUE** pq);
+
+/**
+  @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**@file n_skiplist.h
+ *  Lock free ordered map, skip list with epoch based reclamation
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#ifndef __N_SKIPLIST_HEADER
+#define __N_SKIPLIST_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**@defgroup SKIPLIST SKIPLIST: lock free int64_t keyed ordered map
+  @addtogroup SKIPLIST
+  @{
+  */
+
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+#include "nilorea/n_hash.h"
+
+#include <stdint.h>
+#include <pthread.h>
+
+/*! maximum number of levels of a node */
+#define SKIPLIST_MAX_LEVEL 24
+/*! number of unlinked nodes and values kept before trying to free them */
+#define SKIPLIST_RETIRE_BATCH 64
+/*! number of yields a reclamation waits for readers to leave before delaying the frees */
+#define SKIPLIST_SYNC_SPINS 1000
+
+/*! typed value of a key, swapped as a whole when the key is put again */
+typedef struct SKIPLIST_VALUE {
+    /*! value */
+    union HASH_DATA data;
+    /*! type of the value: HASH_INT, HASH_DOUBLE, HASH_STRING or HASH_PTR */
+    int type;
+    /*! HASH_PTR destructor, or NULL */
+    void (*destroy_func)(void* ptr);
+    /*! next value waiting for reclamation */
+    struct SKIPLIST_VALUE* retired_next;
+} SKIPLIST_VALUE;
+
+/*! skip list node. The lowest bit of a next pointer marks the node as removed at that level */
+typedef struct SKIPLIST_NODE {
+    /*! key of the node */
+    int64_t key;
+    /*! current value, NULL once taken by the remover */
+    SKIPLIST_VALUE* value;
+    /*! 2 while both the inserter and a remover may still link or unlink the node, freed at 0 */
+    int link_refs;
+    /*! number of levels of the node */
+    int level;
+    /*! next node waiting for reclamation */
+    struct SKIPLIST_NODE* retired_next;
+    /*! per level marked next pointers */
+    struct SKIPLIST_NODE* next[];
+} SKIPLIST_NODE;
+
+/*! structure of a lock free skip list map */
+typedef struct SKIPLIST {
+    /*! head sentinel, SKIPLIST_MAX_LEVEL levels */
+    SKIPLIST_NODE* head;
+    /*! number of keys in the map */
+    size_t nb_items;
+    /*! level generator state */
+    uint64_t seed;
+    /*! reclamation epoch, its parity selects the readers counter */
+    size_t epoch;
+    /*! number of readers per epoch parity */
+    size_t readers[2];
+    /*! unlinked nodes, pushed without lock */
+    SKIPLIST_NODE* retired_nodes;
+    /*! replaced or removed values, pushed without lock */
+    SKIPLIST_VALUE* retired_values;
+    /*! popped value records whose data was given to the caller, pushed without lock */
+    SKIPLIST_VALUE* retired_records;
+    /*! number of retired nodes and values */
+    size_t nb_retired;
+    /*! reclamation lock, only taken with trylock by the writers */
+    pthread_mutex_t reclaim_lock;
+    /*! retired nodes taken by a reclamation that timed out */
+    SKIPLIST_NODE* pending_nodes;
+    /*! retired values taken by a reclamation that timed out */
+    SKIPLIST_VALUE* pending_values;
+    /*! retired records taken by a reclamation that timed out */
+    SKIPLIST_VALUE* pending_records;
+} SKIPLIST;
+
+/*! @brief create a new lock free skip list map */
+SKIPLIST* new_skiplist(void);
+/*! @brief enter a read section, the nodes and values seen inside are not freed before skiplist_read_exit */
+size_t skiplist_read_enter(SKIPLIST* sl);
+/*! @brief leave a read section */
+void skiplist_read_exit(SKIPLIST* sl, size_t parity);
+/*! @brief put an integer at key */
+int skiplist_put_int(SKIPLIST* sl, int64_t key, HASH_INT_TYPE value);
+/*! @brief put a double at key */
+int skiplist_put_double(SKIPLIST* sl, int64_t key, double value);
+/*! @brief put a copy of a string at key */
+int skiplist_put_string(SKIPLIST* sl, int64_t key, char* string);
+/*! @brief put a string at key, the map takes ownership of it */
+int skiplist_put_string_ptr(SKIPLIST* sl, int64_t key, char* string);
+/*! @brief put a pointer at key, destroyed by destructor when replaced or removed */
+int skiplist_put_ptr(SKIPLIST* sl, int64_t key, void* ptr, void (*destructor)(void* ptr));
+/*! @brief get the integer at key */
+int skiplist_get_int(SKIPLIST* sl, int64_t key, HASH_INT_TYPE* val);
+/*! @brief get the double at key */
+int skiplist_get_double(SKIPLIST* sl, int64_t key, double* val);
+/*! @brief get the string at key */
+int skiplist_get_string(SKIPLIST* sl, int64_t key, char** val);
+/*! @brief get the pointer at key */
+int skiplist_get_ptr(SKIPLIST* sl, int64_t key, void** val);
+/*! @brief remove key and destroy its value */
+int skiplist_remove(SKIPLIST* sl, int64_t key);
+/*! @brief remove the smallest key and give its value to the caller, whose data must not be freed while other threads may still read it */
+int skiplist_pop_first(SKIPLIST* sl, int64_t* key, int* type, union HASH_DATA* data);
+/*! @brief get the greatest key lower or equal to key */
+int skiplist_floor(SKIPLIST* sl, int64_t key, int64_t* found);
+/*! @brief get the smallest key greater or equal to key */
+int skiplist_ceiling(SKIPLIST* sl, int64_t key, int64_t* found);
+/*! @brief call func on the keys from min to max, in order */
+size_t skiplist_range(SKIPLIST* sl, int64_t min, int64_t max, int (*func)(int64_t key, int type, union HASH_DATA data, void* user_data), void* user_data);
+/*! @brief get the number of keys */
+size_t skiplist_nb_items(SKIPLIST* sl);
+/*! @brief free the retired nodes and values that no reader can see anymore */
+int skiplist_reclaim(SKIPLIST* sl);
+/*! @brief destroy a skip list and set it to NULL */
+int destroy_skiplist(SKIPLIST** sl);
+
+/**
+  @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -71,6 +71,11 @@ extern "C" {
 /*! code for a successfully retrieved item */
 #define STACK_ITEM_OK 4
 
+/*! new_stack_ex flag: store raw values of a single type, without the STACK_ITEM wrapper */
+#define STACK_PACKED 1
+/*! new_stack_ex flag: one producer thread and one consumer thread may use the stack without lock */
+#define STACK_SPSC 2
+
 /*! structure of a STACK_ITEM data */
 union STACK_DATA {
     /*! boolean */
@@ -115,8 +120,10 @@ typedef struct STACK_ITEM {
 
 /*! STACK structure */
 typedef struct STACK {
-    /*! STACK_ITEM array */
+    /*! STACK_ITEM array, NULL for STACK_PACKED stacks */
     STACK_ITEM* stack_array;
+    /*! raw values array of STACK_PACKED stacks, else NULL */
+    void* packed_array;
     /*! Size of array */
     size_t size;
     /*! position of head */
@@ -125,6 +132,12 @@ typedef struct STACK {
     size_t tail;
     /*! number of item inside stack */
     size_t nb_items;
+    /*! STACK_PACKED stacks: type of the values */
+    uint8_t v_type;
+    /*! STACK_PACKED stacks: size of a value */
+    size_t item_size;
+    /*! 0 or a mix of STACK_PACKED and STACK_SPSC */
+    int flags;
 } STACK;
 
 /* stack_push_p_default is declared below with the other push functions.
@@ -194,6 +207,8 @@ typedef struct STACK {
 
 /*! allocate a new stack */
 STACK* new_stack(size_t nb_items);
+/*! allocate a new stack with a packed and/or single producer single consumer layout */
+STACK* new_stack_ex(size_t size, int flags, uint8_t v_type);
 /*! delete a stack and free its memory */
 bool delete_stack(STACK** stack);
 /*! check if the stack is full */
@@ -243,6 +258,47 @@ double stack_pop_d(STACK* stack, uint8_t* status);
 /*! pop a pointer from the stack */
 void* stack_pop_p(STACK* stack, uint8_t* status);
 
+/*! push an array of raw values of one type */
+size_t stack_push_many(STACK* stack, uint8_t v_type, const void* values, size_t nb);
+/*! pop an array of raw values of one type */
+size_t stack_pop_many(STACK* stack, uint8_t v_type, void* values, size_t nb);
+/*! push an array of bool onto the stack */
+size_t stack_push_many_b(STACK* stack, const bool* values, size_t nb);
+/*! pop an array of bool from the stack */
+size_t stack_pop_many_b(STACK* stack, bool* values, size_t nb);
+/*! push an array of char onto the stack */
+size_t stack_push_many_c(STACK* stack, const char* values, size_t nb);
+/*! pop an array of char from the stack */
+size_t stack_pop_many_c(STACK* stack, char* values, size_t nb);
+/*! push an array of uint8_t onto the stack */
+size_t stack_push_many_ui8(STACK* stack, const uint8_t* values, size_t nb);
+/*! pop an array of uint8_t from the stack */
+size_t stack_pop_many_ui8(STACK* stack, uint8_t* values, size_t nb);
+/*! push an array of int8_t onto the stack */
+size_t stack_push_many_i8(STACK* stack, const int8_t* values, size_t nb);
+/*! pop an array of int8_t from the stack */
+size_t stack_pop_many_i8(STACK* stack, int8_t* values, size_t nb);
+/*! push an array of uint32_t onto the stack */
+size_t stack_push_many_ui32(STACK* stack, const uint32_t* values, size_t nb);
+/*! pop an array of uint32_t from the stack */
+size_t stack_pop_many_ui32(STACK* stack, uint32_t* values, size_t nb);
+/*! push an array of int32_t onto the stack */
+size_t stack_push_many_i32(STACK* stack, const int32_t* values, size_t nb);
+/*! pop an array of int32_t from the stack */
+size_t stack_pop_many_i32(STACK* stack, int32_t* values, size_t nb);
+/*! push an array of float onto the stack */
+size_t stack_push_many_f(STACK* stack, const float* values, size_t nb);
+/*! pop an array of float from the stack */
+size_t stack_pop_many_f(STACK* stack, float* values, size_t nb);
+/*! push an array of double onto the stack */
+size_t stack_push_many_d(STACK* stack, const double* values, size_t nb);
+/*! pop an array of double from the stack */
+size_t stack_pop_many_d(STACK* stack, double* values, size_t nb);
+/*! push an array of pointers onto the stack, with a p_type of 0 */
+size_t stack_push_many_p(STACK* stack, void* const* values, size_t nb);
+/*! pop an array of pointers from the stack */
+size_t stack_pop_many_p(STACK* stack, void** values, size_t nb);
+
 #ifdef ENV_64BITS
 /*! push a uint64_t onto the stack */
 bool stack_push_ui64(STACK* stack, uint64_t ui64_t);
@@ -252,6 +308,14 @@ bool stack_push_i64(STACK* stack, int64_t i64);
 uint64_t stack_pop_ui64(STACK* stack, uint8_t* status);
 /*! pop an int64_t from the stack */
 int64_t stack_pop_i64(STACK* stack, uint8_t* status);
+/*! push an array of uint64_t onto the stack */
+size_t stack_push_many_ui64(STACK* stack, const uint64_t* values, size_t nb);
+/*! pop an array of uint64_t from the stack */
+size_t stack_pop_many_ui64(STACK* stack, uint64_t* values, size_t nb);
+/*! push an array of int64_t onto the stack */
+size_t stack_push_many_i64(STACK* stack, const int64_t* values, size_t nb);
+/*! pop an array of int64_t from the stack */
+size_t stack_pop_many_i64(STACK* stack, int64_t* values, size_t nb);
 #endif
 
 /**
@@ -65,8 +65,156 @@ typedef struct N_STR {
     /*! number of meaningful bytes in data, excluding the null terminator;
      *  the size including the null terminator is `written + 1`. */
     size_t written;
+    /*! NSTR_INLINE if data was stored right after the structure, in the same allocation, NSTR_MAPPED if it is a file mapping, NSTR_CACHED if it is a block of the allocation cache */
+    int flags;
 } N_STR;
 
+/*! N_STR flag: data lives in the same allocation as the structure. Such a data
+ *  pointer can't be freed, reallocated or kept after the N_STR is freed. Use
+ *  nstr_detach_data() to take it, or nstr_free_data() before replacing it. */
+#define NSTR_INLINE 1
+/*! N_STR flag: data is a private, copy on write mapping of a file made by n_file_map(). Its length leaves no spare room, so growing the string moves it to the heap first */
+#define NSTR_MAPPED 2
+/*! N_STR flag: data is a block of the N_STR allocation cache of length bytes, given back to the cache when released. Data set by the caller has not this flag and is free()d: use nstr_free_data() before replacing a flagged data pointer */
+#define NSTR_CACHED 4
+/*! largest allocation, structure included, of a string made by new_nstr_inline */
+#define NSTR_INLINE_MAX 256
+/*! maximum number of free blocks kept per size class by each thread, 0 to disable the cache */
+#ifndef NSTR_CACHE_MAX_BLOCKS
+#define NSTR_CACHE_MAX_BLOCKS 64
+#endif
+/*! largest block kept by the N_STR allocation cache */
+#define NSTR_CACHE_MAX_SIZE 4096
+
+/*! default buffer size of a N_LINE_READER */
+#define NSTR_LINE_READER_BUFFER_SIZE (1024 * 1024)
+
+/*! line reader, giving the lines of a file as pointers in a buffer reused from one read to the next */
+typedef struct N_LINE_READER {
+    /*! read buffer, one byte bigger than size */
+    char* buffer;
+    /*! usable size of the buffer */
+    size_t size;
+    /*! start of the next line in the buffer */
+    size_t start;
+    /*! position where the search of the next delimiter resumes */
+    size_t scan;
+    /*! end of the bytes read in the buffer */
+    size_t end;
+    /*! number of lines given so far */
+    size_t line_number;
+    /*! file descriptor being read */
+    int fd;
+    /*! 1 if fd was opened by the reader and has to be closed with it */
+    int own_fd;
+    /*! 1 once the end of the file was reached */
+    int eof;
+    /*! 1 if a read or an allocation failed */
+    int error;
+    /*! end of line byte */
+    char delimiter;
+} N_LINE_READER;
+
+/*! default size of the chunks of a N_STR_BUILDER */
+#define NSTR_BUILDER_CHUNK_SIZE 4096
+/*! maximum number of chunks given to a single writev call */
+#define NSTR_BUILDER_IOV_MAX 64
+/*! N_STR_CHUNK flag: data belongs to the caller and is only referenced */
+#define NSTR_CHUNK_REF 1
+
+/*! one chunk of a N_STR_BUILDER */
+typedef struct N_STR_CHUNK {
+    /*! next chunk, NULL for the last one */
+    struct N_STR_CHUNK* next;
+    /*! chunk bytes, right after the structure or referenced caller memory */
+    char* data;
+    /*! number of bytes that data can hold */
+    size_t size;
+    /*! number of bytes written in data */
+    size_t written;
+    /*! NSTR_CHUNK_REF if data is caller memory */
+    int flags;
+} N_STR_CHUNK;
+
+/*! string builder appending into a chain of fixed size chunks, so that growing never moves what was already written */
+typedef struct N_STR_BUILDER {
+    /*! first chunk, NULL if nothing was written */
+    N_STR_CHUNK* first;
+    /*! chunk being filled */
+    N_STR_CHUNK* last;
+    /*! size of the chunks owned by the builder */
+    size_t chunk_size;
+    /*! total number of bytes in the chunks */
+    size_t written;
+    /*! number of chunks in the chain */
+    size_t nb_chunks;
+} N_STR_BUILDER;
+
+/*! string kernels SIMD level: scalar code only */
+#define NSTR_SIMD_NONE 0
+/*! string kernels SIMD level: SSE2, always there on x86_64 */
+#define NSTR_SIMD_SSE2 1
+/*! string kernels SIMD level: AVX2 */
+#define NSTR_SIMD_AVX2 2
+/*! biggest str_sanitize mask handled by the SIMD kernels, bigger ones use a lookup table */
+#define NSTR_SIMD_MASK_MAX 16
+/*! number of spans split() keeps on the stack before allocating them */
+#define NSTR_SPLIT_LOCAL_SPANS 64
+
+/*! size of a buffer for n_double_to_chars */
+#define NSTR_DOUBLE_MAX_LEN 32
+
+/*! section of a buffer, as given by split_spans */
+typedef struct N_STR_SPAN {
+    /*! position of the first byte of the section */
+    size_t offset;
+    /*! number of bytes of the section */
+    size_t length;
+} N_STR_SPAN;
+
+/*! keys of n_str_template_expand placeholders are shorter than this, longer ones are left as text */
+#define N_STR_TEMPLATE_MAX_KEY 256
+
+/*! part of a compiled template, literal text or {{key}} placeholder */
+typedef struct N_STR_TEMPLATE_SEGMENT {
+    /*! position of the segment in the template text */
+    size_t offset;
+    /*! number of bytes of the segment, braces included for a placeholder */
+    size_t length;
+    /*! key of a placeholder, NULL for literal text */
+    char* key;
+    /*! length of key */
+    size_t key_length;
+    /*! hash of key for tables of seed hash_seed */
+    size_t hash;
+    /*! value found by the last render, or the placeholder itself */
+    const char* value;
+    /*! length of value */
+    size_t value_length;
+    /*! parity of the read section held on the shard of key while rendering with a HASH_CONCURRENT table */
+    size_t read_parity;
+} N_STR_TEMPLATE_SEGMENT;
+
+/*! template parsed once by n_str_template_compile, rendered many times by n_str_template_render */
+typedef struct N_STR_TEMPLATE {
+    /*! copy of the template text */
+    char* text;
+    /*! keys of the placeholders, each ending with a '\0' */
+    char* keys;
+    /*! segments, in template order */
+    N_STR_TEMPLATE_SEGMENT* segments;
+    /*! number of segments */
+    size_t nb_segments;
+    /*! number of placeholders */
+    size_t nb_keys;
+    /*! number of bytes of the literal segments */
+    size_t literal_length;
+    /*! seed of the table the keys were hashed for */
+    size_t hash_seed;
+    /*! set once the keys are hashed */
+    int hashed;
+} N_STR_TEMPLATE;
+
 /*! Abort code to sped up pattern matching. Special thanks to Lars Mathiesen <thorinn@diku.dk> for the ABORT code.*/
 #define WILDMAT_ABORT -2
 /*! What character marks an inverted character class? */
@@ -74,6 +222,47 @@ typedef struct N_STR {
 /*! Do tar(1) matching rules, which ignore a trailing slash? */
 #undef WILDMAT_MATCH_TAR_PATTERN
 
+/*! n_glob_compile flag: match without case like wildmatcase */
+#define N_GLOB_CASELESS 1
+/*! maximum number of '?', '[class]', literal and '*' items of a compiled pattern, longer ones are matched with wildmat */
+#define N_GLOB_MAX_TOKENS 63
+
+/*! wildmat pattern compiled into a bit-parallel automaton, bit k of a state is set when the first k items of the pattern match */
+typedef struct N_GLOB {
+    /*! copy of the source pattern */
+    char* pattern;
+    /*! 0 or N_GLOB_CASELESS */
+    int flags;
+    /*! set if the pattern has too many items and is matched with wildmat */
+    int fallback;
+    /*! for each byte, the bits of the items that accept it */
+    uint64_t accept[256];
+    /*! bits of the stars, which stay set on any byte */
+    uint64_t star_loop;
+    /*! bits before the stars, which also set the next bit since a star can match nothing */
+    uint64_t star_eps;
+    /*! state before the first byte */
+    uint64_t start;
+    /*! bit of the whole pattern */
+    uint64_t final;
+    /*! number of items */
+    size_t nb_tokens;
+    /*! number of stars */
+    size_t nb_stars;
+    /*! length of the shortest matching text */
+    size_t min_len;
+    /*! literal bytes at the start of the pattern */
+    char head[N_GLOB_MAX_TOKENS];
+    /*! literal bytes after the last star */
+    char tail[N_GLOB_MAX_TOKENS];
+    /*! number of bytes in head */
+    size_t head_len;
+    /*! number of bytes in tail */
+    size_t tail_len;
+    /*! set if the pattern is head, one star and tail, so that checking both ends is enough */
+    int ends_only;
+} N_GLOB;
+
 /*! local strdup */
 #define local_strdup(__src_)                                                                                         \
     ({                                                                                                               \
@@ -149,7 +338,7 @@ typedef struct N_STR {
         if (__nstr_var && __nstr_var->data && __nstr_var->written > 0) {           \
             char* __replaced = str_replace(__nstr_var->data, "\r", __replacement); \
             if (__replaced) {                                                      \
-                Free(__nstr_var->data);                                            \
+                nstr_free_data(__nstr_var);                                        \
                 __nstr_var->data = __replaced;                                     \
                 __nstr_var->written = strlen(__nstr_var->data);                    \
                 __nstr_var->length = __nstr_var->written + 1;                      \
@@ -169,6 +358,18 @@ char* trim(const char* s);
 char* nfgets(char* buffer, NSTRBYTE size, FILE* stream);
 /*! @brief create a new string */
 N_STR* new_nstr(NSTRBYTE size);
+/*! @brief create a new string, keeping small ones in a single allocation */
+N_STR* new_nstr_inline(NSTRBYTE size);
+/*! @brief release the data of a N_STR and reset it */
+void nstr_free_data(N_STR* nstr);
+/*! @brief take the data of a N_STR as a buffer to free() */
+char* nstr_detach_data(N_STR* nstr);
+/*! @brief free the blocks cached by the calling thread */
+void nstr_cache_flush(void);
+/*! @brief get the SIMD level used by the string kernels */
+int nstr_simd_level(void);
+/*! @brief limit the SIMD level used by the string kernels */
+int nstr_set_simd_level(int level);
 /*! @brief reinitialize a nstr */
 int empty_nstr(N_STR* nstr);
 /*! @brief make a copy of a N_STR */
@@ -193,10 +394,40 @@ N_STR* nstrprintf_ex(N_STR** nstr_var, const char* format, ...);
 N_STR* nstrprintf_cat_ex(N_STR** nstr_var, const char* format, ...);
 /*! @brief load a whole file into a N_STR */
 N_STR* file_to_nstr(char* filename);
+/*! @brief map a whole file as a copy on write N_STR */
+N_STR* n_file_map(const char* filename);
+/*! @brief release a N_STR made by n_file_map */
+int n_file_unmap(N_STR** str);
+/*! @brief create a line reader on an open file descriptor */
+N_LINE_READER* new_line_reader(int fd, size_t buffer_size, char delimiter);
+/*! @brief open a file and create a line reader on it */
+N_LINE_READER* open_line_reader(const char* filename, size_t buffer_size, char delimiter);
+/*! @brief get the next line of a line reader, without copying it */
+int line_reader_next(N_LINE_READER* reader, char** line, size_t* length);
+/*! @brief destroy a line reader */
+int destroy_line_reader(N_LINE_READER** reader);
 /*! @brief write a whole N_STR into an open file descriptor */
 int nstr_to_fd(N_STR* str, FILE* out, int lock);
 /*! @brief write a whole N_STR into a file */
 int nstr_to_file(N_STR* n_str, char* filename);
+/*! @brief create a new chunked string builder */
+N_STR_BUILDER* new_nstr_builder(size_t chunk_size);
+/*! @brief append bytes to a string builder */
+int nstr_builder_append(N_STR_BUILDER* builder, const void* data, size_t size);
+/*! @brief append a N_STR to a string builder */
+int nstr_builder_append_nstr(N_STR_BUILDER* builder, const N_STR* str);
+/*! @brief append caller memory to a string builder without copying it */
+int nstr_builder_append_ref(N_STR_BUILDER* builder, const void* data, size_t size);
+/*! @brief printf at the end of a string builder */
+int nstr_builder_printf(N_STR_BUILDER* builder, const char* format, ...);
+/*! @brief copy the content of a string builder into a new N_STR */
+N_STR* nstr_builder_to_nstr(const N_STR_BUILDER* builder);
+/*! @brief write the content of a string builder into a file descriptor */
+ssize_t nstr_builder_write_fd(const N_STR_BUILDER* builder, int fd);
+/*! @brief remove the content of a string builder */
+int nstr_builder_empty(N_STR_BUILDER* builder);
+/*! @brief destroy a string builder and set it to NULL */
+int destroy_nstr_builder(N_STR_BUILDER** builder);
 
 /*! free a N_STR structure and set the pointer to NULL */
 #define free_nstr(__ptr)                                    \
@@ -230,6 +461,20 @@ int str_to_int_ex(const char* s, NSTRBYTE start, NSTRBYTE end, int* i, const int
 int str_to_int_nolog(const char* s, NSTRBYTE start, NSTRBYTE end, int* i, const int base, N_STR** infos);
 /*! @brief string to integer, shorter version */
 int str_to_int(const char* s, int* i, const int base);
+/*! @brief parse a signed 64 bits integer from a span, without copying it */
+int n_str_span_to_i64(const char* s, size_t len, int base, int64_t* value, size_t* parsed);
+/*! @brief parse an unsigned 64 bits integer from a span, without copying it */
+int n_str_span_to_u64(const char* s, size_t len, int base, uint64_t* value, size_t* parsed);
+/*! @brief parse a double from a span */
+int n_str_span_to_double(const char* s, size_t len, double* value, size_t* parsed);
+/*! @brief append the decimal text of a signed 64 bits integer */
+N_STR* n_nstr_cat_i64(N_STR** dest, int64_t value);
+/*! @brief append the decimal text of an unsigned 64 bits integer */
+N_STR* n_nstr_cat_u64(N_STR** dest, uint64_t value);
+/*! @brief append the shortest text of a double that reads back as the same value */
+N_STR* n_nstr_cat_double(N_STR** dest, double value);
+/*! @brief write the shortest text of a double that reads back as the same value */
+size_t n_double_to_chars(double value, char* buffer);
 /*! @brief skip characters in string while string[iterator] == toskip */
 int skipw(const char* string, char toskip, NSTRBYTE* iterator, int inc);
 /*! @brief skip characters in string until string[iterator] == toskip */
@@ -242,6 +487,8 @@ int strlo(const char* string, char* dest);
 int strcpy_u(const char* from, char* to, NSTRBYTE to_size, char split, NSTRBYTE* it);
 /*! @brief return an array of char pointers to the split sections */
 char** split(const char* str, const char* delim, int empty);
+/*! @brief give the sections of a split as (offset, length) spans, without allocating */
+size_t split_spans(const char* str, size_t len, const char* delim, int empty, N_STR_SPAN* spans, size_t max_spans);
 /*! @brief count split elements */
 int split_count(char** split_result);
 /*! @brief free a char **tab and set it to NULL */
@@ -256,10 +503,18 @@ int write_and_fit(char** dest, NSTRBYTE* size, NSTRBYTE* written, const char* sr
 int scan_dir(const char* dir, LIST* result, const int recurse);
 /*! @brief get a list of files in a directory, extended N_STR version */
 int scan_dir_ex(const char* dir, const char* pattern, LIST* result, const int recurse, const int mode);
+/*! @brief get a list of files in a directory matching a compiled pattern */
+int scan_dir_glob(const char* dir, const N_GLOB* glob, LIST* result, const int recurse, const int mode);
 /*! @brief pattern matching */
 int wildmat(register const char* text, register const char* p);
 /*! @brief pattern matching, case insensitive */
 int wildmatcase(register const char* text, register const char* p);
+/*! @brief compile a wildmat pattern */
+N_GLOB* n_glob_compile(const char* pattern, int flags);
+/*! @brief match a text against a compiled pattern */
+int n_glob_match(const N_GLOB* glob, const char* text);
+/*! @brief destroy a compiled pattern */
+int n_glob_delete(N_GLOB** glob);
 /*! @brief return a new string with all occurrences of substr replaced */
 char* str_replace(const char* string, const char* substr, const char* replacement);
 /*! @brief sanitize a string using a character mask */
@@ -273,6 +528,12 @@ int str_sanitize(char* string, const char* mask, const char replacement);
  *  @param vars Hash table mapping key to value. May be NULL.
  *  @return Newly allocated N_STR with expanded result, or NULL on failure. */
 N_STR* n_str_template_expand(const char* tmpl, struct HASH_TABLE* vars);
+/*! @brief parse a template once for n_str_template_render */
+N_STR_TEMPLATE* n_str_template_compile(const char* tmpl);
+/*! @brief append a compiled template expanded with vars to an N_STR */
+int n_str_template_render(N_STR_TEMPLATE* compiled, struct HASH_TABLE* vars, N_STR** out);
+/*! @brief destroy a compiled template and set it to NULL */
+int n_str_template_delete(N_STR_TEMPLATE** compiled);
 
 /*! @brief Percent-encode a string per RFC 3986 (unreserved chars kept).
  *
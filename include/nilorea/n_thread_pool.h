@@ -61,6 +61,8 @@ extern "C" {
 #define EXITED_THREAD 512
 /*! if passed to add_threaded_process, skip main table lock in case we are in a func which is already locking it */
 #define NO_LOCK 1024
+/*! lists shorter than this are sorted by list_sort_parallel in the calling thread */
+#define LIST_SORT_PARALLEL_MIN_ITEMS 8192
 
 /*! A thread pool node */
 typedef struct THREAD_POOL_NODE {
@@ -140,6 +142,8 @@ int wait_for_threaded_pool(THREAD_POOL* thread_pool);
 int destroy_threaded_pool(THREAD_POOL** thread_pool, unsigned int delay);
 /*! try to add some waiting process on some free thread slots, else do nothing */
 int refresh_thread_pool(THREAD_POOL* thread_pool);
+/*! sort a list by sorting and merging sublists on a thread pool */
+int list_sort_parallel(LIST* list, int (*comparator)(const void* a, const void* b), THREAD_POOL* thread_pool);
 
 /**
 @}
@@ -0,0 +1,107 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**@file n_u64map.h
+ *  Integer keyed map, open addressing with grouped control bytes
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#ifndef __N_U64MAP_HEADER
+#define __N_U64MAP_HEADER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**@defgroup U64MAP INTEGER MAPS: uint64_t keyed maps without key allocation
+  @addtogroup U64MAP
+  @{
+  */
+
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+
+#include <stdint.h>
+
+/*! number of slots probed together, one control byte each */
+#define U64MAP_GROUP_SIZE 16
+/*! control byte of a never used slot */
+#define U64MAP_EMPTY 0x80
+/*! control byte of a slot whose key was removed */
+#define U64MAP_DELETED 0xFE
+/*! maximum load factor in percent, removed slots included, before the map grows */
+#define U64MAP_MAX_LOAD_PERCENT 87
+/*! number of keys hashed and prefetched ahead by the bulk functions */
+#define U64MAP_BATCH_SIZE 32
+
+/*! tell if a control byte belongs to a used slot, whose control byte holds 7 bits of the key hash */
+#define U64MAP_SLOT_IS_FULL(__ctrl_) (((__ctrl_) & 0x80) == 0)
+
+/*! iterate over the used slots of a U64MAP, __IT_ being the slot index in keys and values */
+#define u64map_foreach(__IT_, __MAP_)                            \
+    for (size_t __IT_ = 0; __IT_ < (__MAP_)->size; __IT_++)   \
+        if (U64MAP_SLOT_IS_FULL((__MAP_)->ctrl[__IT_]))
+
+/*! structure of an integer keyed map */
+typedef struct U64MAP {
+    /*! per slot control byte: U64MAP_EMPTY, U64MAP_DELETED or 7 bits of the key hash */
+    uint8_t* ctrl;
+    /*! per slot key */
+    uint64_t* keys;
+    /*! per slot value */
+    void** values;
+    /*! number of slots, a power of two multiple of U64MAP_GROUP_SIZE */
+    size_t size;
+    /*! number of keys in the map */
+    size_t nb_items;
+    /*! number of U64MAP_DELETED slots */
+    size_t nb_deleted;
+    /*! destructor called on the values replaced, removed or left in the map, or NULL */
+    void (*destroy_func)(void* ptr);
+} U64MAP;
+
+/*! @brief create a new integer keyed map able to hold size keys before growing */
+U64MAP* new_u64map(size_t size, void (*destructor)(void* ptr));
+/*! @brief make room for nb_items keys without growing */
+int u64map_reserve(U64MAP* map, size_t nb_items);
+/*! @brief put a value at key, replacing the previous one */
+int u64map_put(U64MAP* map, uint64_t key, void* value);
+/*! @brief get the value at key */
+int u64map_get(const U64MAP* map, uint64_t key, void** value);
+/*! @brief remove key and destroy its value */
+int u64map_remove(U64MAP* map, uint64_t key);
+/*! @brief put nb values at their keys, hashing and prefetching in batches */
+size_t u64map_put_many(U64MAP* map, const uint64_t* keys, void* const* values, size_t nb);
+/*! @brief get the values of nb keys, hashing and prefetching in batches */
+size_t u64map_get_many(const U64MAP* map, const uint64_t* keys, size_t nb, void** values);
+/*! @brief remove all the keys */
+int u64map_empty(U64MAP* map);
+/*! @brief destroy a map and set it to NULL */
+int destroy_u64map(U64MAP** map);
+
+/**
+  @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
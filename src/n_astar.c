@@ -20,9 +20,10 @@
  *@file n_astar.c
  *@brief A* Pathfinding implementation for 2D and 3D grids
  *
- * Uses a binary min-heap as the open list priority queue for O(log n)
- * insert/extract operations, and a flat array for O(1) closed-set
- * membership checks.
+ * Uses a 4-ary PQUEUE min-heap as the open list priority queue for O(log n)
+ * insert/extract operations, lowering the key of an open cell in place when a
+ * shorter path reaches it, and a flat array for O(1) closed-set membership
+ * checks.
  *
  * Based on:
  * - GameDev.net Article 2003: "A* Pathfinding for Beginners"
@@ -34,6 +35,8 @@
  */
 
 #include "nilorea/n_astar.h"
+#include "nilorea/n_pqueue.h"
+#include "nilorea/n_bitset.h"
 #include <string.h>
 #include <math.h>
 
@@ -79,94 +82,24 @@ static inline int iabs(int v) {
     return v < 0 ? -v : v;
 }
 
-/* Binary Min-Heap (priority queue) */
+/* Open list */
 
-static ASTAR_HEAP* heap_new(int capacity) {
-    ASTAR_HEAP* h = (ASTAR_HEAP*)calloc(1, sizeof(ASTAR_HEAP));
-    if (!h) return NULL;
-
-    h->data = (ASTAR_HEAP_NODE*)malloc((size_t)capacity * sizeof(ASTAR_HEAP_NODE));
-    if (!h->data) {
-        free(h);
-        return NULL;
+/*! Put a cell in the open list, or lower its priority in place if a
+ *  shorter path reached it while it was already open.
+ *  Return 0 if the open list could not grow, the cell is left unopened */
+static int open_cell(PQUEUE* open, ASTAR_CELL* cell, int index) {
+    if (cell->status == ASTAR_NODE_OPEN) {
+        pqueue_decrease_key(open, cell->open_handle, cell->f);
+        return 1;
     }
-    h->size = 0;
-    h->capacity = capacity;
-    return h;
-}
-
-static void heap_free(ASTAR_HEAP* h) {
-    if (!h) return;
-    free(h->data);
-    free(h);
-}
-
-static int heap_grow(ASTAR_HEAP* h) {
-    int new_cap = h->capacity * 2;
-    ASTAR_HEAP_NODE* new_data = (ASTAR_HEAP_NODE*)realloc(
-        h->data, (size_t)new_cap * sizeof(ASTAR_HEAP_NODE));
-    if (!new_data) return 0;
-    h->data = new_data;
-    h->capacity = new_cap;
+    size_t handle = pqueue_push(open, cell->f, (void*)(intptr_t)index);
+    if (handle == PQUEUE_NO_HANDLE)
+        return 0;
+    cell->status = ASTAR_NODE_OPEN;
+    cell->open_handle = handle;
     return 1;
 }
 
-static void heap_swap(ASTAR_HEAP_NODE* a, ASTAR_HEAP_NODE* b) {
-    ASTAR_HEAP_NODE tmp = *a;
-    *a = *b;
-    *b = tmp;
-}
-
-static void heap_push(ASTAR_HEAP* h, int x, int y, int z, int f) {
-    if (h->size >= h->capacity) {
-        if (!heap_grow(h)) return;
-    }
-
-    int i = h->size++;
-    h->data[i].x = x;
-    h->data[i].y = y;
-    h->data[i].z = z;
-    h->data[i].f = f;
-
-    /* Sift up */
-    while (i > 0) {
-        int parent = (i - 1) / 2;
-        if (h->data[i].f < h->data[parent].f) {
-            heap_swap(&h->data[i], &h->data[parent]);
-            i = parent;
-        } else {
-            break;
-        }
-    }
-}
-
-static ASTAR_HEAP_NODE heap_pop(ASTAR_HEAP* h) {
-    ASTAR_HEAP_NODE top = h->data[0];
-    h->data[0] = h->data[--h->size];
-
-    /* Sift down */
-    int i = 0;
-    for (;;) {
-        int left = 2 * i + 1;
-        int right = 2 * i + 2;
-        int smallest = i;
-
-        if (left < h->size && h->data[left].f < h->data[smallest].f)
-            smallest = left;
-        if (right < h->size && h->data[right].f < h->data[smallest].f)
-            smallest = right;
-
-        if (smallest != i) {
-            heap_swap(&h->data[i], &h->data[smallest]);
-            i = smallest;
-        } else {
-            break;
-        }
-    }
-
-    return top;
-}
-
 /* Heuristic Functions */
 
 /**
@@ -243,16 +176,16 @@ ASTAR_GRID* n_astar_grid_new(int width, int height, int depth) {
 
     size_t total = (size_t)width * (size_t)height * (size_t)depth;
 
-    grid->walkable = (uint8_t*)malloc(total);
+    grid->walkable = new_bitset(total);
     if (!grid->walkable) {
         free(grid);
         return NULL;
     }
-    memset(grid->walkable, 1, total);
+    bitset_fill(grid->walkable, 1);
 
     grid->cost = (int*)malloc(total * sizeof(int));
     if (!grid->cost) {
-        free(grid->walkable);
+        destroy_bitset(&grid->walkable);
         free(grid);
         return NULL;
     }
@@ -269,7 +202,7 @@ ASTAR_GRID* n_astar_grid_new(int width, int height, int depth) {
  */
 void n_astar_grid_free(ASTAR_GRID* grid) {
     if (!grid) return;
-    free(grid->walkable);
+    if (grid->walkable) destroy_bitset(&grid->walkable);
     free(grid->cost);
     free(grid);
 }
@@ -284,7 +217,10 @@ void n_astar_grid_free(ASTAR_GRID* grid) {
  */
 void n_astar_grid_set_walkable(ASTAR_GRID* grid, int x, int y, int z, uint8_t walkable) {
     if (!grid || !in_bounds(grid, x, y, z)) return;
-    grid->walkable[grid_index(grid, x, y, z)] = walkable;
+    if (walkable)
+        bitset_set(grid->walkable, (size_t)grid_index(grid, x, y, z));
+    else
+        bitset_clear(grid->walkable, (size_t)grid_index(grid, x, y, z));
 }
 
 /**
@@ -297,7 +233,7 @@ void n_astar_grid_set_walkable(ASTAR_GRID* grid, int x, int y, int z, uint8_t wa
  */
 uint8_t n_astar_grid_get_walkable(const ASTAR_GRID* grid, int x, int y, int z) {
     if (!grid || !in_bounds(grid, x, y, z)) return 0;
-    return grid->walkable[grid_index(grid, x, y, z)];
+    return (uint8_t)bitset_test(grid->walkable, (size_t)grid_index(grid, x, y, z));
 }
 
 /**
@@ -360,10 +296,14 @@ void n_astar_grid_set_rect_blocked(ASTAR_GRID* grid,
         z2 = t;
     }
 
+    /* out of bounds cells are ignored, rows are contiguous in the bitset */
+    if (x1 < 0) x1 = 0;
+    if (x2 >= grid->width) x2 = grid->width - 1;
+    if (x1 > x2) return;
     for (int z = z1; z <= z2; z++)
         for (int y = y1; y <= y2; y++)
-            for (int x = x1; x <= x2; x++)
-                n_astar_grid_set_walkable(grid, x, y, z, 0);
+            if (in_bounds(grid, x1, y, z))
+                bitset_fill_range(grid->walkable, (size_t)grid_index(grid, x1, y, z), (size_t)grid_index(grid, x2, y, z) + 1, 0);
 }
 
 /* Path Reconstruction */
@@ -478,8 +418,8 @@ static const int dir3d_diagonal[][3] = {
  *@param gz goal Z
  *@param diagonal ASTAR_CARDINAL_ONLY or ASTAR_ALLOW_DIAGONAL
  *@param heuristic heuristic function to use
- *@return path from start to goal, or NULL if no path exists.
- *        Caller must free with n_astar_path_free().
+ *@return path from start to goal, or NULL if no path exists or the
+ *        open list could not grow. Caller must free with n_astar_path_free().
  */
 ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
                               int sx,
@@ -492,8 +432,8 @@ ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
                               ASTAR_HEURISTIC heuristic) {
     if (!grid) return NULL;
     if (!in_bounds(grid, sx, sy, sz) || !in_bounds(grid, gx, gy, gz)) return NULL;
-    if (!grid->walkable[grid_index(grid, sx, sy, sz)]) return NULL;
-    if (!grid->walkable[grid_index(grid, gx, gy, gz)]) return NULL;
+    if (!bitset_test(grid->walkable, (size_t)grid_index(grid, sx, sy, sz))) return NULL;
+    if (!bitset_test(grid->walkable, (size_t)grid_index(grid, gx, gy, gz))) return NULL;
 
     /* Trivial case */
     if (sx == gx && sy == gy && sz == gz) {
@@ -558,7 +498,7 @@ ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
     ASTAR_CELL* cells = (ASTAR_CELL*)calloc(btotal, sizeof(ASTAR_CELL));
     if (!cells) return NULL;
 
-    ASTAR_HEAP* open = heap_new(256);
+    PQUEUE* open = new_pqueue(PQUEUE_DEFAULT_ARITY, 256, NULL);
     if (!open) {
         free(cells);
         return NULL;
@@ -568,14 +508,18 @@ ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
     cells[si].g = 0;
     cells[si].h = n_astar_heuristic(sx, sy, sz, gx, gy, gz, heuristic);
     cells[si].f = cells[si].h;
-    cells[si].status = ASTAR_NODE_OPEN;
-    heap_push(open, sx, sy, sz, cells[si].f);
+    /* a cell that cannot be opened ends the search without a path */
+    int failed = !open_cell(open, &cells[si], si);
 
     ASTAR_PATH* result = NULL;
 
-    while (open->size > 0) {
-        ASTAR_HEAP_NODE current = heap_pop(open);
-        int cx = current.x, cy = current.y, cz = current.z;
+    void* current = NULL;
+    while (!failed && pqueue_pop(open, NULL, &current)) {
+        /* the open list carries window-local indexes */
+        int cur = (int)(intptr_t)current;
+        int cx = box.minx + cur % box.bw;
+        int cy = box.miny + (cur / box.bw) % box.bh;
+        int cz = box.minz + cur / (box.bw * box.bh);
         int ci = grid_index(grid, cx, cy, cz);   /* absolute: cost[] */
         int lci = box_index(&box, cx, cy, cz);   /* window-local: cells[] */
 
@@ -599,7 +543,7 @@ ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
 
                 int ni = grid_index(grid, nx, ny, nz);
                 int lni = box_index(&box, nx, ny, nz);
-                if (!grid->walkable[ni] || cells[lni].status == ASTAR_NODE_CLOSED)
+                if (!bitset_test(grid->walkable, (size_t)ni) || cells[lni].status == ASTAR_NODE_CLOSED)
                     continue;
 
                 int move_cost = (grid->cost[ci] + grid->cost[ni]) / 2;
@@ -612,8 +556,8 @@ ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
                     cells[lni].parent_x = cx;
                     cells[lni].parent_y = cy;
                     cells[lni].parent_z = cz;
-                    cells[lni].status = ASTAR_NODE_OPEN;
-                    heap_push(open, nx, ny, nz, cells[lni].f);
+                    if (!open_cell(open, &cells[lni], lni))
+                        failed = 1;
                 }
             }
 
@@ -630,22 +574,22 @@ ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
 
                     int ni = grid_index(grid, nx, ny, nz);
                     int lni = box_index(&box, nx, ny, nz);
-                    if (!grid->walkable[ni] || cells[lni].status == ASTAR_NODE_CLOSED)
+                    if (!bitset_test(grid->walkable, (size_t)ni) || cells[lni].status == ASTAR_NODE_CLOSED)
                         continue;
 
                     /* Corner-cutting check */
                     int blocked = 0;
-                    if (ddx != 0 && ddy != 0 && !grid->walkable[grid_index(grid, cx + ddx, cy, cz)])
+                    if (ddx != 0 && ddy != 0 && !bitset_test(grid->walkable, (size_t)grid_index(grid, cx + ddx, cy, cz)))
                         blocked = 1;
-                    if (ddx != 0 && ddy != 0 && !grid->walkable[grid_index(grid, cx, cy + ddy, cz)])
+                    if (ddx != 0 && ddy != 0 && !bitset_test(grid->walkable, (size_t)grid_index(grid, cx, cy + ddy, cz)))
                         blocked = 1;
-                    if (ddx != 0 && ddz != 0 && !grid->walkable[grid_index(grid, cx + ddx, cy, cz)])
+                    if (ddx != 0 && ddz != 0 && !bitset_test(grid->walkable, (size_t)grid_index(grid, cx + ddx, cy, cz)))
                         blocked = 1;
-                    if (ddx != 0 && ddz != 0 && !grid->walkable[grid_index(grid, cx, cy, cz + ddz)])
+                    if (ddx != 0 && ddz != 0 && !bitset_test(grid->walkable, (size_t)grid_index(grid, cx, cy, cz + ddz)))
                         blocked = 1;
-                    if (ddy != 0 && ddz != 0 && !grid->walkable[grid_index(grid, cx, cy + ddy, cz)])
+                    if (ddy != 0 && ddz != 0 && !bitset_test(grid->walkable, (size_t)grid_index(grid, cx, cy + ddy, cz)))
                         blocked = 1;
-                    if (ddy != 0 && ddz != 0 && !grid->walkable[grid_index(grid, cx, cy, cz + ddz)])
+                    if (ddy != 0 && ddz != 0 && !bitset_test(grid->walkable, (size_t)grid_index(grid, cx, cy, cz + ddz)))
                         blocked = 1;
                     if (blocked) continue;
 
@@ -667,8 +611,8 @@ ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
                         cells[lni].parent_x = cx;
                         cells[lni].parent_y = cy;
                         cells[lni].parent_z = cz;
-                        cells[lni].status = ASTAR_NODE_OPEN;
-                        heap_push(open, nx, ny, nz, cells[lni].f);
+                        if (!open_cell(open, &cells[lni], lni))
+                            failed = 1;
                     }
                 }
             }
@@ -681,7 +625,7 @@ ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
 
                 int ni = grid_index(grid, nx, ny, 0);
                 int lni = box_index(&box, nx, ny, 0);
-                if (!grid->walkable[ni] || cells[lni].status == ASTAR_NODE_CLOSED)
+                if (!bitset_test(grid->walkable, (size_t)ni) || cells[lni].status == ASTAR_NODE_CLOSED)
                     continue;
 
                 int move_cost = (grid->cost[ci] + grid->cost[ni]) / 2;
@@ -694,8 +638,8 @@ ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
                     cells[lni].parent_x = cx;
                     cells[lni].parent_y = cy;
                     cells[lni].parent_z = 0;
-                    cells[lni].status = ASTAR_NODE_OPEN;
-                    heap_push(open, nx, ny, 0, cells[lni].f);
+                    if (!open_cell(open, &cells[lni], lni))
+                        failed = 1;
                 }
             }
 
@@ -710,11 +654,11 @@ ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
 
                     int ni = grid_index(grid, nx, ny, 0);
                     int lni = box_index(&box, nx, ny, 0);
-                    if (!grid->walkable[ni] || cells[lni].status == ASTAR_NODE_CLOSED)
+                    if (!bitset_test(grid->walkable, (size_t)ni) || cells[lni].status == ASTAR_NODE_CLOSED)
                         continue;
 
-                    if (!grid->walkable[grid_index(grid, cx + ddx, cy, 0)] ||
-                        !grid->walkable[grid_index(grid, cx, cy + ddy, 0)])
+                    if (!bitset_test(grid->walkable, (size_t)grid_index(grid, cx + ddx, cy, 0)) ||
+                        !bitset_test(grid->walkable, (size_t)grid_index(grid, cx, cy + ddy, 0)))
                         continue;
 
                     int cell_cost = (grid->cost[ci] + grid->cost[ni]) / 2;
@@ -728,15 +672,15 @@ ASTAR_PATH* n_astar_find_path(const ASTAR_GRID* grid,
                         cells[lni].parent_x = cx;
                         cells[lni].parent_y = cy;
                         cells[lni].parent_z = 0;
-                        cells[lni].status = ASTAR_NODE_OPEN;
-                        heap_push(open, nx, ny, 0, cells[lni].f);
+                        if (!open_cell(open, &cells[lni], lni))
+                            failed = 1;
                     }
                 }
             }
         }
     }
 
-    heap_free(open);
+    destroy_pqueue(&open);
     free(cells);
     return result;
 }
@@ -1137,22 +1137,22 @@ int avro_json_to_file(const char* avro_filename, const char* schema_filename, co
     __n_assert(json_filename, return FALSE);
 
     /* load schema file */
-    N_STR* schema_str = file_to_nstr((char*)schema_filename);
+    N_STR* schema_str = n_file_map(schema_filename);
     __n_assert(schema_str, return FALSE);
 
     AVRO_SCHEMA* schema = avro_schema_parse(schema_str->data);
-    free_nstr(&schema_str);
+    n_file_unmap(&schema_str);
     __n_assert(schema, return FALSE);
 
     /* load JSON file */
-    N_STR* json_str = file_to_nstr((char*)json_filename);
+    N_STR* json_str = n_file_map(json_filename);
     if (!json_str) {
         avro_schema_free(&schema);
         return FALSE;
     }
 
     cJSON* json = cJSON_Parse(json_str->data);
-    free_nstr(&json_str);
+    n_file_unmap(&json_str);
     if (!json) {
         n_log(LOG_ERR, "failed to parse JSON file %s: %s", json_filename, _str(cJSON_GetErrorPtr()));
         avro_schema_free(&schema);
@@ -1201,15 +1201,15 @@ int avro_file_to_json(const char* avro_filename, const char* schema_filename, co
     __n_assert(json_filename, return FALSE);
 
     /* load schema file */
-    N_STR* schema_str = file_to_nstr((char*)schema_filename);
+    N_STR* schema_str = n_file_map(schema_filename);
     __n_assert(schema_str, return FALSE);
 
     AVRO_SCHEMA* schema = avro_schema_parse(schema_str->data);
-    free_nstr(&schema_str);
+    n_file_unmap(&schema_str);
     __n_assert(schema, return FALSE);
 
     /* load Avro file */
-    N_STR* avro_data = file_to_nstr((char*)avro_filename);
+    N_STR* avro_data = n_file_map(avro_filename);
     if (!avro_data) {
         avro_schema_free(&schema);
         return FALSE;
@@ -1217,7 +1217,7 @@ int avro_file_to_json(const char* avro_filename, const char* schema_filename, co
 
     /* decode from Avro container */
     cJSON* records = avro_decode_container(schema, avro_data);
-    free_nstr(&avro_data);
+    n_file_unmap(&avro_data);
     avro_schema_free(&schema);
 
     if (!records) {
@@ -0,0 +1,838 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ *@file n_bitset.c
+ *@brief Fixed size bitsets and compressed roaring bitmaps
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#include "nilorea/n_bitset.h"
+
+#include <string.h>
+
+/*! roaring container operation: values in both containers */
+#define ROARING_OP_AND 0
+/*! roaring container operation: values in any container */
+#define ROARING_OP_OR 1
+/*! roaring container operation: values in the first container only */
+#define ROARING_OP_ANDNOT 2
+
+/**
+ *@brief create a new bitset
+ *@param nb_bits number of bits, all cleared
+ *@return a new N_BITSET or NULL
+ */
+N_BITSET* new_bitset(size_t nb_bits) {
+    if (nb_bits == 0) {
+        n_log(LOG_ERR, "bitset size cannot be 0");
+        return NULL;
+    }
+    N_BITSET* bitset = NULL;
+    Malloc(bitset, N_BITSET, 1);
+    __n_assert(bitset, return NULL);
+    bitset->nb_bits = nb_bits;
+    bitset->nb_words = (nb_bits + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS;
+    Malloc(bitset->words, uint64_t, bitset->nb_words);
+    __n_assert(bitset->words, Free(bitset); return NULL);
+    return bitset;
+} /* new_bitset(...) */
+
+/**
+ *@brief destroy a bitset and set it to NULL
+ *@param bitset pointer to the bitset to destroy
+ *@return TRUE or FALSE
+ */
+int destroy_bitset(N_BITSET** bitset) {
+    __n_assert(bitset, return FALSE);
+    __n_assert((*bitset), return FALSE);
+    Free((*bitset)->words);
+    Free((*bitset));
+    return TRUE;
+} /* destroy_bitset(...) */
+
+/**
+ *@brief clear the bits of the last word past nb_bits, so that counts and scans can work on whole words
+ *@param bitset targeted bitset
+ */
+void _bitset_trim(N_BITSET* bitset) {
+    size_t tail_bits = bitset->nb_bits % BITSET_WORD_BITS;
+    if (tail_bits != 0)
+        bitset->words[bitset->nb_words - 1] &= ((uint64_t)1 << tail_bits) - 1;
+} /* _bitset_trim(...) */
+
+/**
+ *@brief set or clear all the bits
+ *@param bitset targeted bitset
+ *@param value TRUE to set the bits, FALSE to clear them
+ *@return TRUE or FALSE
+ */
+int bitset_fill(N_BITSET* bitset, int value) {
+    __n_assert(bitset, return FALSE);
+    memset(bitset->words, value ? 0xFF : 0, bitset->nb_words * sizeof(uint64_t));
+    _bitset_trim(bitset);
+    return TRUE;
+} /* bitset_fill(...) */
+
+/**
+ *@brief set or clear the bits from start to end excluded, a word at a time
+ *@param bitset targeted bitset
+ *@param start first bit
+ *@param end bit after the last one, at most nb_bits
+ *@param value TRUE to set the bits, FALSE to clear them
+ *@return TRUE or FALSE
+ */
+int bitset_fill_range(N_BITSET* bitset, size_t start, size_t end, int value) {
+    __n_assert(bitset, return FALSE);
+    if (start > end || end > bitset->nb_bits) {
+        n_log(LOG_ERR, "invalid range [%zu, %zu) in a bitset of %zu bits", start, end, bitset->nb_bits);
+        return FALSE;
+    }
+    if (start == end)
+        return TRUE;
+
+    size_t first = start / BITSET_WORD_BITS;
+    size_t last = (end - 1) / BITSET_WORD_BITS;
+    uint64_t first_mask = ~(uint64_t)0 << (start % BITSET_WORD_BITS);
+    uint64_t last_mask = ~(uint64_t)0 >> (BITSET_WORD_BITS - 1 - (end - 1) % BITSET_WORD_BITS);
+    if (first == last)
+        first_mask &= last_mask;
+
+    if (value)
+        bitset->words[first] |= first_mask;
+    else
+        bitset->words[first] &= ~first_mask;
+    if (first == last)
+        return TRUE;
+    for (size_t it = first + 1; it < last; it++)
+        bitset->words[it] = value ? ~(uint64_t)0 : 0;
+    if (value)
+        bitset->words[last] |= last_mask;
+    else
+        bitset->words[last] &= ~last_mask;
+    return TRUE;
+} /* bitset_fill_range(...) */
+
+/**
+ *@brief count the set bits
+ *@param bitset targeted bitset
+ *@return the number of set bits
+ */
+size_t bitset_count(const N_BITSET* bitset) {
+    __n_assert(bitset, return 0);
+    size_t count = 0;
+    for (size_t it = 0; it < bitset->nb_words; it++)
+        count += (size_t)__builtin_popcountll(bitset->words[it]);
+    return count;
+} /* bitset_count(...) */
+
+/**
+ *@brief get the index of the first set bit at or after start, skipping empty words
+ *@param bitset targeted bitset
+ *@param start first bit to look at
+ *@return the index of the bit or BITSET_NONE
+ */
+size_t bitset_next_set(const N_BITSET* bitset, size_t start) {
+    __n_assert(bitset, return BITSET_NONE);
+    if (start >= bitset->nb_bits)
+        return BITSET_NONE;
+    size_t index = start / BITSET_WORD_BITS;
+    uint64_t word = bitset->words[index] & (~(uint64_t)0 << (start % BITSET_WORD_BITS));
+    while (word == 0) {
+        if (++index >= bitset->nb_words)
+            return BITSET_NONE;
+        word = bitset->words[index];
+    }
+    return index * BITSET_WORD_BITS + (size_t)__builtin_ctzll(word);
+} /* bitset_next_set(...) */
+
+/**
+ *@brief get the index of the first cleared bit at or after start, skipping full words
+ *@param bitset targeted bitset
+ *@param start first bit to look at
+ *@return the index of the bit or BITSET_NONE
+ */
+size_t bitset_next_clear(const N_BITSET* bitset, size_t start) {
+    __n_assert(bitset, return BITSET_NONE);
+    if (start >= bitset->nb_bits)
+        return BITSET_NONE;
+    size_t index = start / BITSET_WORD_BITS;
+    uint64_t word = ~bitset->words[index] & (~(uint64_t)0 << (start % BITSET_WORD_BITS));
+    while (word == 0) {
+        if (++index >= bitset->nb_words)
+            return BITSET_NONE;
+        word = ~bitset->words[index];
+    }
+    size_t bit = index * BITSET_WORD_BITS + (size_t)__builtin_ctzll(word);
+    return (bit < bitset->nb_bits) ? bit : BITSET_NONE;
+} /* bitset_next_clear(...) */
+
+/**
+ *@brief check that two bitsets can be combined
+ *@param dst first bitset
+ *@param src second bitset
+ *@return TRUE or FALSE
+ */
+int _bitset_same_size(const N_BITSET* dst, const N_BITSET* src) {
+    __n_assert(dst, return FALSE);
+    __n_assert(src, return FALSE);
+    if (dst->nb_bits != src->nb_bits) {
+        n_log(LOG_ERR, "can't combine bitsets of %zu and %zu bits", dst->nb_bits, src->nb_bits);
+        return FALSE;
+    }
+    return TRUE;
+} /* _bitset_same_size(...) */
+
+/**
+ *@brief dst = dst AND src. The loop has no dependency between words, so the compiler vectorizes it.
+ *@param dst bitset receiving the result
+ *@param src bitset of the same size
+ *@return TRUE or FALSE
+ */
+int bitset_and(N_BITSET* dst, const N_BITSET* src) {
+    if (_bitset_same_size(dst, src) == FALSE)
+        return FALSE;
+    for (size_t it = 0; it < dst->nb_words; it++)
+        dst->words[it] &= src->words[it];
+    return TRUE;
+} /* bitset_and(...) */
+
+/**
+ *@brief dst = dst OR src
+ *@param dst bitset receiving the result
+ *@param src bitset of the same size
+ *@return TRUE or FALSE
+ */
+int bitset_or(N_BITSET* dst, const N_BITSET* src) {
+    if (_bitset_same_size(dst, src) == FALSE)
+        return FALSE;
+    for (size_t it = 0; it < dst->nb_words; it++)
+        dst->words[it] |= src->words[it];
+    return TRUE;
+} /* bitset_or(...) */
+
+/**
+ *@brief dst = dst XOR src
+ *@param dst bitset receiving the result
+ *@param src bitset of the same size
+ *@return TRUE or FALSE
+ */
+int bitset_xor(N_BITSET* dst, const N_BITSET* src) {
+    if (_bitset_same_size(dst, src) == FALSE)
+        return FALSE;
+    for (size_t it = 0; it < dst->nb_words; it++)
+        dst->words[it] ^= src->words[it];
+    return TRUE;
+} /* bitset_xor(...) */
+
+/**
+ *@brief dst = dst AND NOT src
+ *@param dst bitset receiving the result
+ *@param src bitset of the same size
+ *@return TRUE or FALSE
+ */
+int bitset_andnot(N_BITSET* dst, const N_BITSET* src) {
+    if (_bitset_same_size(dst, src) == FALSE)
+        return FALSE;
+    for (size_t it = 0; it < dst->nb_words; it++)
+        dst->words[it] &= ~src->words[it];
+    return TRUE;
+} /* bitset_andnot(...) */
+
+/**
+ *@brief count the bits set in both bitsets, without building their intersection
+ *@param a first bitset
+ *@param b bitset of the same size
+ *@return the number of common set bits
+ */
+size_t bitset_and_count(const N_BITSET* a, const N_BITSET* b) {
+    if (_bitset_same_size(a, b) == FALSE)
+        return 0;
+    size_t count = 0;
+    for (size_t it = 0; it < a->nb_words; it++)
+        count += (size_t)__builtin_popcountll(a->words[it] & b->words[it]);
+    return count;
+} /* bitset_and_count(...) */
+
+/**
+ *@brief create a new empty roaring bitmap
+ *@return a new N_ROARING or NULL
+ */
+N_ROARING* new_roaring(void) {
+    N_ROARING* roaring = NULL;
+    Malloc(roaring, N_ROARING, 1);
+    __n_assert(roaring, return NULL);
+    return roaring;
+} /* new_roaring(...) */
+
+/**
+ *@brief free the storage of a container
+ *@param container targeted container
+ */
+void _roaring_container_free(N_ROARING_CONTAINER* container) {
+    FreeNoLog(container->values);
+    FreeNoLog(container->words);
+    container->cardinality = 0;
+    container->capacity = 0;
+} /* _roaring_container_free(...) */
+
+/**
+ *@brief remove all the values
+ *@param roaring targeted roaring bitmap
+ *@return TRUE or FALSE
+ */
+int roaring_empty(N_ROARING* roaring) {
+    __n_assert(roaring, return FALSE);
+    for (size_t it = 0; it < roaring->nb_containers; it++)
+        _roaring_container_free(&roaring->containers[it]);
+    roaring->nb_containers = 0;
+    return TRUE;
+} /* roaring_empty(...) */
+
+/**
+ *@brief destroy a roaring bitmap and set it to NULL
+ *@param roaring pointer to the roaring bitmap to destroy
+ *@return TRUE or FALSE
+ */
+int destroy_roaring(N_ROARING** roaring) {
+    __n_assert(roaring, return FALSE);
+    __n_assert((*roaring), return FALSE);
+    roaring_empty((*roaring));
+    FreeNoLog((*roaring)->keys);
+    FreeNoLog((*roaring)->containers);
+    Free((*roaring));
+    return TRUE;
+} /* destroy_roaring(...) */
+
+/**
+ *@brief binary search of the high 16 bits of a value
+ *@param roaring targeted roaring bitmap
+ *@param key high 16 bits
+ *@param pos set to the index of the container, or to the index where it would be inserted
+ *@return TRUE if the container exists, else FALSE
+ */
+int _roaring_find_key(const N_ROARING* roaring, uint16_t key, size_t* pos) {
+    size_t low = 0, high = roaring->nb_containers;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (roaring->keys[mid] < key)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    (*pos) = low;
+    return (low < roaring->nb_containers && roaring->keys[low] == key) ? TRUE : FALSE;
+} /* _roaring_find_key(...) */
+
+/**
+ *@brief binary search of the low 16 bits of a value in an array container
+ *@param container array container
+ *@param low low 16 bits
+ *@param pos set to the index of the value, or to the index where it would be inserted
+ *@return TRUE if the value exists, else FALSE
+ */
+int _roaring_array_find(const N_ROARING_CONTAINER* container, uint16_t low, uint32_t* pos) {
+    uint32_t first = 0, last = container->cardinality;
+    while (first < last) {
+        uint32_t mid = (first + last) / 2;
+        if (container->values[mid] < low)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+    (*pos) = first;
+    return (first < container->cardinality && container->values[first] == low) ? TRUE : FALSE;
+} /* _roaring_array_find(...) */
+
+/**
+ *@brief turn an array container into a bitmap container
+ *@param container array container
+ *@return TRUE or FALSE
+ */
+int _roaring_to_bitmap(N_ROARING_CONTAINER* container) {
+    uint64_t* words = NULL;
+    Malloc(words, uint64_t, ROARING_BITMAP_WORDS);
+    __n_assert(words, return FALSE);
+    for (uint32_t it = 0; it < container->cardinality; it++)
+        words[container->values[it] / 64] |= (uint64_t)1 << (container->values[it] % 64);
+    FreeNoLog(container->values);
+    container->words = words;
+    container->capacity = 0;
+    return TRUE;
+} /* _roaring_to_bitmap(...) */
+
+/**
+ *@brief turn a bitmap container of at most ROARING_ARRAY_MAX values into an array container
+ *@param container bitmap container
+ *@return TRUE or FALSE
+ */
+int _roaring_to_array(N_ROARING_CONTAINER* container) {
+    uint16_t* values = NULL;
+    uint32_t capacity = container->cardinality > 0 ? container->cardinality : 1;
+    Malloc(values, uint16_t, capacity);
+    __n_assert(values, return FALSE);
+    uint32_t nb = 0;
+    for (uint32_t it = 0; it < ROARING_BITMAP_WORDS; it++) {
+        uint64_t word = container->words[it];
+        while (word) {
+            values[nb++] = (uint16_t)(it * 64 + (uint32_t)__builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+    FreeNoLog(container->words);
+    container->values = values;
+    container->capacity = capacity;
+    return TRUE;
+} /* _roaring_to_array(...) */
+
+/**
+ *@brief add the low 16 bits of a value to a container
+ *@param container targeted container
+ *@param low low 16 bits
+ *@return 1 if the value was added, 0 if it was already there, -1 on error
+ */
+int _roaring_container_add(N_ROARING_CONTAINER* container, uint16_t low) {
+    if (container->words) {
+        uint64_t bit = (uint64_t)1 << (low % 64);
+        if (container->words[low / 64] & bit)
+            return 0;
+        container->words[low / 64] |= bit;
+        container->cardinality++;
+        return 1;
+    }
+    uint32_t pos = 0;
+    if (_roaring_array_find(container, low, &pos) == TRUE)
+        return 0;
+    if (container->cardinality == ROARING_ARRAY_MAX) {
+        if (_roaring_to_bitmap(container) == FALSE)
+            return -1;
+        return _roaring_container_add(container, low);
+    }
+    if (container->cardinality == container->capacity) {
+        size_t capacity = container->capacity ? (size_t)container->capacity * 2 : 4;
+        if (capacity > ROARING_ARRAY_MAX)
+            capacity = ROARING_ARRAY_MAX;
+        if (Realloc(container->values, uint16_t, capacity) == FALSE)
+            return -1;
+        container->capacity = (uint32_t)capacity;
+    }
+    memmove(container->values + pos + 1, container->values + pos, (container->cardinality - pos) * sizeof(uint16_t));
+    container->values[pos] = low;
+    container->cardinality++;
+    return 1;
+} /* _roaring_container_add(...) */
+
+/**
+ *@brief remove the low 16 bits of a value from a container
+ *@param container targeted container
+ *@param low low 16 bits
+ *@return TRUE if the value was removed, FALSE if it was not there
+ */
+int _roaring_container_remove(N_ROARING_CONTAINER* container, uint16_t low) {
+    if (container->words) {
+        uint64_t bit = (uint64_t)1 << (low % 64);
+        if (!(container->words[low / 64] & bit))
+            return FALSE;
+        container->words[low / 64] &= ~bit;
+        container->cardinality--;
+        /* keeps the bitmap if the array can't be allocated, both layouts are valid */
+        if (container->cardinality == ROARING_ARRAY_MAX)
+            _roaring_to_array(container);
+        return TRUE;
+    }
+    uint32_t pos = 0;
+    if (_roaring_array_find(container, low, &pos) == FALSE)
+        return FALSE;
+    memmove(container->values + pos, container->values + pos + 1, (container->cardinality - pos - 1) * sizeof(uint16_t));
+    container->cardinality--;
+    return TRUE;
+} /* _roaring_container_remove(...) */
+
+/**
+ *@brief insert an empty container
+ *@param roaring targeted roaring bitmap
+ *@param pos index of the new container
+ *@param key high 16 bits of the container
+ *@return the new container or NULL
+ */
+N_ROARING_CONTAINER* _roaring_insert_container(N_ROARING* roaring, size_t pos, uint16_t key) {
+    if (roaring->nb_containers == roaring->capacity) {
+        size_t capacity = roaring->capacity ? roaring->capacity * 2 : 4;
+        if (Realloc(roaring->keys, uint16_t, capacity) == FALSE)
+            return NULL;
+        if (Realloc(roaring->containers, N_ROARING_CONTAINER, capacity) == FALSE)
+            return NULL;
+        roaring->capacity = capacity;
+    }
+    memmove(roaring->keys + pos + 1, roaring->keys + pos, (roaring->nb_containers - pos) * sizeof(uint16_t));
+    memmove(roaring->containers + pos + 1, roaring->containers + pos, (roaring->nb_containers - pos) * sizeof(N_ROARING_CONTAINER));
+    roaring->keys[pos] = key;
+    memset(&roaring->containers[pos], 0, sizeof(N_ROARING_CONTAINER));
+    roaring->nb_containers++;
+    return &roaring->containers[pos];
+} /* _roaring_insert_container(...) */
+
+/**
+ *@brief add a value
+ *@param roaring targeted roaring bitmap
+ *@param value value to add
+ *@return TRUE if the value is in the set, FALSE on error
+ */
+int roaring_add(N_ROARING* roaring, uint32_t value) {
+    __n_assert(roaring, return FALSE);
+    uint16_t key = (uint16_t)(value >> 16);
+    size_t pos = 0;
+    N_ROARING_CONTAINER* container = NULL;
+    if (_roaring_find_key(roaring, key, &pos) == TRUE) {
+        container = &roaring->containers[pos];
+    } else {
+        container = _roaring_insert_container(roaring, pos, key);
+        __n_assert(container, return FALSE);
+    }
+    int added = _roaring_container_add(container, (uint16_t)(value & 0xFFFF));
+    if (added < 0 && container->cardinality == 0) {
+        _roaring_container_free(container);
+        memmove(roaring->keys + pos, roaring->keys + pos + 1, (roaring->nb_containers - pos - 1) * sizeof(uint16_t));
+        memmove(roaring->containers + pos, roaring->containers + pos + 1, (roaring->nb_containers - pos - 1) * sizeof(N_ROARING_CONTAINER));
+        roaring->nb_containers--;
+    }
+    return (added >= 0) ? TRUE : FALSE;
+} /* roaring_add(...) */
+
+/**
+ *@brief remove a value
+ *@param roaring targeted roaring bitmap
+ *@param value value to remove
+ *@return TRUE if the value was removed, FALSE if it was not in the set
+ */
+int roaring_remove(N_ROARING* roaring, uint32_t value) {
+    __n_assert(roaring, return FALSE);
+    size_t pos = 0;
+    if (_roaring_find_key(roaring, (uint16_t)(value >> 16), &pos) == FALSE)
+        return FALSE;
+    N_ROARING_CONTAINER* container = &roaring->containers[pos];
+    if (_roaring_container_remove(container, (uint16_t)(value & 0xFFFF)) == FALSE)
+        return FALSE;
+    if (container->cardinality == 0) {
+        _roaring_container_free(container);
+        memmove(roaring->keys + pos, roaring->keys + pos + 1, (roaring->nb_containers - pos - 1) * sizeof(uint16_t));
+        memmove(roaring->containers + pos, roaring->containers + pos + 1, (roaring->nb_containers - pos - 1) * sizeof(N_ROARING_CONTAINER));
+        roaring->nb_containers--;
+    }
+    return TRUE;
+} /* roaring_remove(...) */
+
+/**
+ *@brief tell if a value is in the set
+ *@param roaring targeted roaring bitmap
+ *@param value value to look for
+ *@return TRUE or FALSE
+ */
+int roaring_contains(const N_ROARING* roaring, uint32_t value) {
+    __n_assert(roaring, return FALSE);
+    size_t pos = 0;
+    if (_roaring_find_key(roaring, (uint16_t)(value >> 16), &pos) == FALSE)
+        return FALSE;
+    const N_ROARING_CONTAINER* container = &roaring->containers[pos];
+    uint16_t low = (uint16_t)(value & 0xFFFF);
+    if (container->words)
+        return (int)((container->words[low / 64] >> (low % 64)) & 1);
+    uint32_t index = 0;
+    return _roaring_array_find(container, low, &index);
+} /* roaring_contains(...) */
+
+/**
+ *@brief count the values
+ *@param roaring targeted roaring bitmap
+ *@return the number of values
+ */
+size_t roaring_cardinality(const N_ROARING* roaring) {
+    __n_assert(roaring, return 0);
+    size_t count = 0;
+    for (size_t it = 0; it < roaring->nb_containers; it++)
+        count += roaring->containers[it].cardinality;
+    return count;
+} /* roaring_cardinality(...) */
+
+/**
+ *@brief call func on each value in increasing order
+ *@param roaring targeted roaring bitmap
+ *@param func called with each value, returns TRUE to go on or FALSE to stop
+ *@param user_data passed to func
+ *@return the number of values given to func
+ */
+size_t roaring_foreach(const N_ROARING* roaring, int (*func)(uint32_t value, void* user_data), void* user_data) {
+    __n_assert(roaring, return 0);
+    __n_assert(func, return 0);
+    size_t count = 0;
+    for (size_t it = 0; it < roaring->nb_containers; it++) {
+        const N_ROARING_CONTAINER* container = &roaring->containers[it];
+        uint32_t high = (uint32_t)roaring->keys[it] << 16;
+        if (container->words) {
+            for (uint32_t word_it = 0; word_it < ROARING_BITMAP_WORDS; word_it++) {
+                uint64_t word = container->words[word_it];
+                while (word) {
+                    count++;
+                    if (func(high | (word_it * 64 + (uint32_t)__builtin_ctzll(word)), user_data) == FALSE)
+                        return count;
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (uint32_t value_it = 0; value_it < container->cardinality; value_it++) {
+                count++;
+                if (func(high | container->values[value_it], user_data) == FALSE)
+                    return count;
+            }
+        }
+    }
+    return count;
+} /* roaring_foreach(...) */
+
+/**
+ *@brief copy a container
+ *@param src container to copy
+ *@param dst container receiving the copy
+ *@return TRUE or FALSE
+ */
+int _roaring_container_copy(const N_ROARING_CONTAINER* src, N_ROARING_CONTAINER* dst) {
+    memset(dst, 0, sizeof(N_ROARING_CONTAINER));
+    if (src->words) {
+        Malloc(dst->words, uint64_t, ROARING_BITMAP_WORDS);
+        __n_assert(dst->words, return FALSE);
+        memcpy(dst->words, src->words, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+    } else {
+        Malloc(dst->values, uint16_t, src->cardinality);
+        __n_assert(dst->values, return FALSE);
+        memcpy(dst->values, src->values, src->cardinality * sizeof(uint16_t));
+        dst->capacity = src->cardinality;
+    }
+    dst->cardinality = src->cardinality;
+    return TRUE;
+} /* _roaring_container_copy(...) */
+
+/**
+ *@brief combine two array containers by merging their sorted values
+ *@param a first array container
+ *@param b second array container
+ *@param op ROARING_OP_AND, ROARING_OP_OR or ROARING_OP_ANDNOT
+ *@param out container receiving the result
+ *@return TRUE or FALSE
+ */
+int _roaring_array_op(const N_ROARING_CONTAINER* a, const N_ROARING_CONTAINER* b, int op, N_ROARING_CONTAINER* out) {
+    uint32_t capacity = (op == ROARING_OP_OR) ? a->cardinality + b->cardinality : a->cardinality;
+    Malloc(out->values, uint16_t, capacity > 0 ? capacity : 1);
+    __n_assert(out->values, return FALSE);
+    out->capacity = capacity > 0 ? capacity : 1;
+
+    uint32_t ia = 0, ib = 0, nb = 0;
+    while (ia < a->cardinality && ib < b->cardinality) {
+        uint16_t va = a->values[ia], vb = b->values[ib];
+        if (va < vb) {
+            if (op != ROARING_OP_AND) out->values[nb++] = va;
+            ia++;
+        } else if (vb < va) {
+            if (op == ROARING_OP_OR) out->values[nb++] = vb;
+            ib++;
+        } else {
+            if (op != ROARING_OP_ANDNOT) out->values[nb++] = va;
+            ia++;
+            ib++;
+        }
+    }
+    if (op != ROARING_OP_AND) {
+        while (ia < a->cardinality) out->values[nb++] = a->values[ia++];
+    }
+    if (op == ROARING_OP_OR) {
+        while (ib < b->cardinality) out->values[nb++] = b->values[ib++];
+    }
+    out->cardinality = nb;
+    if (nb > ROARING_ARRAY_MAX)
+        return _roaring_to_bitmap(out);
+    return TRUE;
+} /* _roaring_array_op(...) */
+
+/**
+ *@brief keep the values of an array container that are, or are not, in a bitmap container
+ *@param array array container
+ *@param bitmap bitmap container
+ *@param keep_set TRUE to keep the values set in bitmap, FALSE to keep the others
+ *@param out container receiving the result
+ *@return TRUE or FALSE
+ */
+int _roaring_array_filter(const N_ROARING_CONTAINER* array, const N_ROARING_CONTAINER* bitmap, int keep_set, N_ROARING_CONTAINER* out) {
+    Malloc(out->values, uint16_t, array->cardinality > 0 ? array->cardinality : 1);
+    __n_assert(out->values, return FALSE);
+    out->capacity = array->cardinality > 0 ? array->cardinality : 1;
+    uint32_t nb = 0;
+    for (uint32_t it = 0; it < array->cardinality; it++) {
+        uint16_t value = array->values[it];
+        int is_set = (int)((bitmap->words[value / 64] >> (value % 64)) & 1);
+        if (is_set == keep_set)
+            out->values[nb++] = value;
+    }
+    out->cardinality = nb;
+    return TRUE;
+} /* _roaring_array_filter(...) */
+
+/**
+ *@brief combine two containers. Two arrays are merged, an array and a bitmap are filtered when possible, else both are combined as bitmaps one word at a time, in a loop that the compiler vectorizes.
+ *@param a first container
+ *@param b second container
+ *@param op ROARING_OP_AND, ROARING_OP_OR or ROARING_OP_ANDNOT
+ *@param out container receiving the result, possibly empty
+ *@return TRUE or FALSE
+ */
+int _roaring_container_op(const N_ROARING_CONTAINER* a, const N_ROARING_CONTAINER* b, int op, N_ROARING_CONTAINER* out) {
+    memset(out, 0, sizeof(N_ROARING_CONTAINER));
+    if (!a->words && !b->words)
+        return _roaring_array_op(a, b, op, out);
+    if (!a->words && op != ROARING_OP_OR)
+        return _roaring_array_filter(a, b, (op == ROARING_OP_AND) ? 1 : 0, out);
+    if (!b->words && op == ROARING_OP_AND)
+        return _roaring_array_filter(b, a, 1, out);
+
+    uint64_t a_words[ROARING_BITMAP_WORDS];
+    uint64_t b_words[ROARING_BITMAP_WORDS];
+    const uint64_t* wa = a->words;
+    const uint64_t* wb = b->words;
+    if (!wa) {
+        memset(a_words, 0, sizeof(a_words));
+        for (uint32_t it = 0; it < a->cardinality; it++) a_words[a->values[it] / 64] |= (uint64_t)1 << (a->values[it] % 64);
+        wa = a_words;
+    }
+    if (!wb) {
+        memset(b_words, 0, sizeof(b_words));
+        for (uint32_t it = 0; it < b->cardinality; it++) b_words[b->values[it] / 64] |= (uint64_t)1 << (b->values[it] % 64);
+        wb = b_words;
+    }
+
+    Malloc(out->words, uint64_t, ROARING_BITMAP_WORDS);
+    __n_assert(out->words, return FALSE);
+    if (op == ROARING_OP_AND) {
+        for (uint32_t it = 0; it < ROARING_BITMAP_WORDS; it++) out->words[it] = wa[it] & wb[it];
+    } else if (op == ROARING_OP_OR) {
+        for (uint32_t it = 0; it < ROARING_BITMAP_WORDS; it++) out->words[it] = wa[it] | wb[it];
+    } else {
+        for (uint32_t it = 0; it < ROARING_BITMAP_WORDS; it++) out->words[it] = wa[it] & ~wb[it];
+    }
+    uint32_t cardinality = 0;
+    for (uint32_t it = 0; it < ROARING_BITMAP_WORDS; it++) cardinality += (uint32_t)__builtin_popcountll(out->words[it]);
+    out->cardinality = cardinality;
+    if (cardinality <= ROARING_ARRAY_MAX)
+        return _roaring_to_array(out);
+    return TRUE;
+} /* _roaring_container_op(...) */
+
+/**
+ *@brief append a container to a roaring bitmap being built in key order, taking its storage
+ *@param roaring targeted roaring bitmap
+ *@param key high 16 bits of the container, greater than the last one
+ *@param container container to append, dropped if empty
+ *@return TRUE or FALSE
+ */
+int _roaring_append(N_ROARING* roaring, uint16_t key, N_ROARING_CONTAINER* container) {
+    if (container->cardinality == 0) {
+        _roaring_container_free(container);
+        return TRUE;
+    }
+    N_ROARING_CONTAINER* slot = _roaring_insert_container(roaring, roaring->nb_containers, key);
+    if (!slot) {
+        _roaring_container_free(container);
+        return FALSE;
+    }
+    (*slot) = (*container);
+    return TRUE;
+} /* _roaring_append(...) */
+
+/**
+ *@brief build a new roaring bitmap from two others, walking their containers in key order
+ *@param a first roaring bitmap
+ *@param b second roaring bitmap
+ *@param op ROARING_OP_AND, ROARING_OP_OR or ROARING_OP_ANDNOT
+ *@return a new N_ROARING or NULL
+ */
+N_ROARING* _roaring_op(const N_ROARING* a, const N_ROARING* b, int op) {
+    __n_assert(a, return NULL);
+    __n_assert(b, return NULL);
+    N_ROARING* result = new_roaring();
+    __n_assert(result, return NULL);
+
+    size_t ia = 0, ib = 0;
+    while (ia < a->nb_containers || ib < b->nb_containers) {
+        N_ROARING_CONTAINER container;
+        int ok = TRUE;
+        uint16_t key = 0;
+        if (ib >= b->nb_containers || (ia < a->nb_containers && a->keys[ia] < b->keys[ib])) {
+            if (op == ROARING_OP_AND) {
+                ia++;
+                continue;
+            }
+            key = a->keys[ia];
+            ok = _roaring_container_copy(&a->containers[ia++], &container);
+        } else if (ia >= a->nb_containers || b->keys[ib] < a->keys[ia]) {
+            if (op != ROARING_OP_OR) {
+                ib++;
+                continue;
+            }
+            key = b->keys[ib];
+            ok = _roaring_container_copy(&b->containers[ib++], &container);
+        } else {
+            key = a->keys[ia];
+            ok = _roaring_container_op(&a->containers[ia++], &b->containers[ib++], op, &container);
+        }
+        if (ok == FALSE || _roaring_append(result, key, &container) == FALSE) {
+            if (ok == FALSE) _roaring_container_free(&container);
+            destroy_roaring(&result);
+            return NULL;
+        }
+    }
+    return result;
+} /* _roaring_op(...) */
+
+/**
+ *@brief new set of the values in both a and b
+ *@param a first roaring bitmap
+ *@param b second roaring bitmap
+ *@return a new N_ROARING or NULL
+ */
+N_ROARING* roaring_and(const N_ROARING* a, const N_ROARING* b) {
+    return _roaring_op(a, b, ROARING_OP_AND);
+} /* roaring_and(...) */
+
+/**
+ *@brief new set of the values in a or b
+ *@param a first roaring bitmap
+ *@param b second roaring bitmap
+ *@return a new N_ROARING or NULL
+ */
+N_ROARING* roaring_or(const N_ROARING* a, const N_ROARING* b) {
+    return _roaring_op(a, b, ROARING_OP_OR);
+} /* roaring_or(...) */
+
+/**
+ *@brief new set of the values in a and not in b
+ *@param a first roaring bitmap
+ *@param b second roaring bitmap
+ *@return a new N_ROARING or NULL
+ */
+N_ROARING* roaring_andnot(const N_ROARING* a, const N_ROARING* b) {
+    return _roaring_op(a, b, ROARING_OP_ANDNOT);
+} /* roaring_andnot(...) */
@@ -0,0 +1,888 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ *@file n_btree.c
+ *@brief B+tree ordered map functions
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#include "nilorea/n_btree.h"
+
+#include <string.h>
+#include <stdlib.h>
+#ifdef __windows__
+#include <malloc.h>
+#endif
+
+/**
+ *@brief allocate a zeroed node aligned on BTREE_NODE_ALIGN
+ *@param size size of the node
+ *@return the node or NULL
+ */
+void* _btree_alloc_node(size_t size) {
+    void* node = NULL;
+#ifdef __windows__
+    node = _aligned_malloc(size, BTREE_NODE_ALIGN);
+#else
+    if (posix_memalign(&node, BTREE_NODE_ALIGN, size) != 0)
+        node = NULL;
+#endif
+    if (!node) {
+        n_log(LOG_ERR, "could not allocate a %zu bytes btree node", size);
+        return NULL;
+    }
+    memset(node, 0, size);
+    return node;
+} /* _btree_alloc_node(...) */
+
+/**
+ *@brief free a node allocated by _btree_alloc_node
+ *@param node node to free
+ */
+void _btree_free_node(void* node) {
+#ifdef __windows__
+    _aligned_free(node);
+#else
+    free(node);
+#endif
+} /* _btree_free_node(...) */
+
+/**
+ *@brief get the index of the first key greater or equal to key
+ *@param keys sorted keys
+ *@param nb number of keys
+ *@param key key to look for
+ *@return an index between 0 and nb
+ */
+FORCE_INLINE uint32_t _btree_lower_bound(const int64_t* keys, uint32_t nb, int64_t key) {
+    uint32_t low = 0;
+    while (nb > 0) {
+        uint32_t half = nb / 2;
+        if (keys[low + half] < key) {
+            low += half + 1;
+            nb -= half + 1;
+        } else {
+            nb = half;
+        }
+    }
+    return low;
+} /* _btree_lower_bound(...) */
+
+/**
+ *@brief get the index of the first key greater than key, which is also the child of an inner node holding key
+ *@param keys sorted keys
+ *@param nb number of keys
+ *@param key key to look for
+ *@return an index between 0 and nb
+ */
+FORCE_INLINE uint32_t _btree_upper_bound(const int64_t* keys, uint32_t nb, int64_t key) {
+    uint32_t low = 0;
+    while (nb > 0) {
+        uint32_t half = nb / 2;
+        if (keys[low + half] <= key) {
+            low += half + 1;
+            nb -= half + 1;
+        } else {
+            nb = half;
+        }
+    }
+    return low;
+} /* _btree_upper_bound(...) */
+
+/**
+ *@brief get the number of keys under a node
+ *@param node leaf or inner node
+ *@param height height of the node, 0 for a leaf
+ *@return the number of keys
+ */
+size_t _btree_node_count(const void* node, size_t height) {
+    if (height == 0)
+        return ((const BTREE_LEAF*)node)->nb_keys;
+    const BTREE_INNER* inner = (const BTREE_INNER*)node;
+    size_t count = 0;
+    for (uint32_t it = 0; it <= inner->nb_keys; it++)
+        count += inner->counts[it];
+    return count;
+} /* _btree_node_count(...) */
+
+/**
+ *@brief get the leaf that holds key, or would hold it
+ *@param tree targeted tree, not empty
+ *@param key key to look for
+ *@return the leaf
+ */
+BTREE_LEAF* _btree_find_leaf(const BTREE* tree, int64_t key) {
+    void* node = tree->root;
+    for (size_t height = tree->height; height > 0; height--) {
+        const BTREE_INNER* inner = (const BTREE_INNER*)node;
+        node = inner->children[_btree_upper_bound(inner->keys, inner->nb_keys, key)];
+    }
+    return (BTREE_LEAF*)node;
+} /* _btree_find_leaf(...) */
+
+/**
+ *@brief create a new B+tree ordered map
+ *@param destructor called on the values replaced, removed or left in the tree, or NULL
+ *@return a new BTREE or NULL
+ */
+BTREE* new_btree(void (*destructor)(void* ptr)) {
+    BTREE* tree = NULL;
+    Malloc(tree, BTREE, 1);
+    __n_assert(tree, return NULL);
+    tree->destroy_func = destructor;
+    return tree;
+} /* new_btree(...) */
+
+/**
+ *@brief insert a key in a leaf with room for it
+ *@param leaf targeted leaf
+ *@param pos insertion index
+ *@param key key to insert
+ *@param value value of the key
+ */
+void _btree_leaf_insert_at(BTREE_LEAF* leaf, uint32_t pos, int64_t key, void* value) {
+    memmove(&leaf->keys[pos + 1], &leaf->keys[pos], (leaf->nb_keys - pos) * sizeof(int64_t));
+    memmove(&leaf->values[pos + 1], &leaf->values[pos], (leaf->nb_keys - pos) * sizeof(void*));
+    leaf->keys[pos] = key;
+    leaf->values[pos] = value;
+    leaf->nb_keys++;
+} /* _btree_leaf_insert_at(...) */
+
+/**
+ *@brief insert a separator and the child on its right in an inner node with room for them
+ *@param inner targeted inner node
+ *@param pos index of the separator
+ *@param key separator key
+ *@param child new child, placed at pos + 1
+ *@param count number of keys under child
+ */
+void _btree_inner_insert_at(BTREE_INNER* inner, uint32_t pos, int64_t key, void* child, size_t count) {
+    memmove(&inner->keys[pos + 1], &inner->keys[pos], (inner->nb_keys - pos) * sizeof(int64_t));
+    memmove(&inner->children[pos + 2], &inner->children[pos + 1], (inner->nb_keys - pos) * sizeof(void*));
+    memmove(&inner->counts[pos + 2], &inner->counts[pos + 1], (inner->nb_keys - pos) * sizeof(size_t));
+    inner->keys[pos] = key;
+    inner->children[pos + 1] = child;
+    inner->counts[pos + 1] = count;
+    inner->nb_keys++;
+} /* _btree_inner_insert_at(...) */
+
+/**
+ *@brief remove a separator and the child on its right from an inner node
+ *@param inner targeted inner node
+ *@param pos index of the separator
+ */
+void _btree_inner_remove_at(BTREE_INNER* inner, uint32_t pos) {
+    memmove(&inner->keys[pos], &inner->keys[pos + 1], (inner->nb_keys - pos - 1) * sizeof(int64_t));
+    memmove(&inner->children[pos + 1], &inner->children[pos + 2], (inner->nb_keys - pos - 1) * sizeof(void*));
+    memmove(&inner->counts[pos + 1], &inner->counts[pos + 2], (inner->nb_keys - pos - 1) * sizeof(size_t));
+    inner->nb_keys--;
+} /* _btree_inner_remove_at(...) */
+
+/**
+ *@brief count the nodes a put of key splits: the full nodes closing the path from the root to the key, none if the key is already in the tree
+ *@param tree targeted tree, not empty
+ *@param key key to put
+ *@return number of nodes splitting, tree->height + 1 if the root splits
+ */
+size_t _btree_nb_splits(const BTREE* tree, int64_t key) {
+    size_t nb_splits = 0;
+    const void* node = tree->root;
+    for (size_t height = tree->height; height > 0; height--) {
+        const BTREE_INNER* inner = (const BTREE_INNER*)node;
+        nb_splits = (inner->nb_keys < BTREE_INNER_SIZE) ? 0 : nb_splits + 1;
+        node = inner->children[_btree_upper_bound(inner->keys, inner->nb_keys, key)];
+    }
+    const BTREE_LEAF* leaf = (const BTREE_LEAF*)node;
+    uint32_t pos = _btree_lower_bound(leaf->keys, leaf->nb_keys, key);
+    if (leaf->nb_keys < BTREE_LEAF_SIZE || (pos < leaf->nb_keys && leaf->keys[pos] == key))
+        return 0;
+    return nb_splits + 1;
+} /* _btree_nb_splits(...) */
+
+/**
+ *@brief take an inner node from a chain of spare nodes
+ *@param spare_inners chain of spare inner nodes, linked by children[0]
+ *@return the zeroed node or NULL if the chain is empty
+ */
+BTREE_INNER* _btree_pop_spare(BTREE_INNER** spare_inners) {
+    BTREE_INNER* spare = (*spare_inners);
+    if (spare) {
+        (*spare_inners) = (BTREE_INNER*)spare->children[0];
+        spare->children[0] = NULL;
+    }
+    return spare;
+} /* _btree_pop_spare(...) */
+
+/**
+ *@brief free the spare nodes left by a put
+ *@param spare_leaf spare leaf or NULL
+ *@param spare_inners chain of spare inner nodes, linked by children[0]
+ */
+void _btree_free_spares(BTREE_LEAF* spare_leaf, BTREE_INNER* spare_inners) {
+    if (spare_leaf)
+        _btree_free_node(spare_leaf);
+    for (BTREE_INNER* spare = _btree_pop_spare(&spare_inners); spare; spare = _btree_pop_spare(&spare_inners))
+        _btree_free_node(spare);
+} /* _btree_free_spares(...) */
+
+/**
+ *@brief put a key under a node, splitting the full nodes on the way back up
+ *@param tree targeted tree
+ *@param node leaf or inner node
+ *@param height height of node
+ *@param key key to put
+ *@param value value to put
+ *@param spare_leaf leaf allocated by the caller for a leaf split, taken and set to NULL if used
+ *@param spare_inners inner nodes allocated by the caller for the inner splits, chained by children[0]
+ *@param split set to the new right sibling if node was split, else left untouched
+ *@param split_key set to the separator key between node and split
+ *@return 1 if the key was added, 0 if it was replaced, -1 on error
+ */
+int _btree_insert(BTREE* tree, void* node, size_t height, int64_t key, void* value, BTREE_LEAF** spare_leaf, BTREE_INNER** spare_inners, void** split, int64_t* split_key) {
+    if (height == 0) {
+        BTREE_LEAF* leaf = (BTREE_LEAF*)node;
+        uint32_t pos = _btree_lower_bound(leaf->keys, leaf->nb_keys, key);
+        if (pos < leaf->nb_keys && leaf->keys[pos] == key) {
+            if (tree->destroy_func && leaf->values[pos] && leaf->values[pos] != value)
+                tree->destroy_func(leaf->values[pos]);
+            leaf->values[pos] = value;
+            return 0;
+        }
+        if (leaf->nb_keys < BTREE_LEAF_SIZE) {
+            _btree_leaf_insert_at(leaf, pos, key, value);
+            return 1;
+        }
+        BTREE_LEAF* right = (*spare_leaf);
+        __n_assert(right, return -1);
+        (*spare_leaf) = NULL;
+        uint32_t half = BTREE_LEAF_SIZE / 2;
+        right->nb_keys = BTREE_LEAF_SIZE - half;
+        memcpy(right->keys, &leaf->keys[half], right->nb_keys * sizeof(int64_t));
+        memcpy(right->values, &leaf->values[half], right->nb_keys * sizeof(void*));
+        leaf->nb_keys = half;
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next)
+            leaf->next->prev = right;
+        else
+            tree->last = right;
+        leaf->next = right;
+        if (pos > half)
+            _btree_leaf_insert_at(right, pos - half, key, value);
+        else
+            _btree_leaf_insert_at(leaf, pos, key, value);
+        (*split) = right;
+        (*split_key) = right->keys[0];
+        return 1;
+    }
+
+    BTREE_INNER* inner = (BTREE_INNER*)node;
+    uint32_t pos = _btree_upper_bound(inner->keys, inner->nb_keys, key);
+    void* child_split = NULL;
+    int64_t child_key = 0;
+    int added = _btree_insert(tree, inner->children[pos], height - 1, key, value, spare_leaf, spare_inners, &child_split, &child_key);
+    if (added < 0)
+        return added;
+    inner->counts[pos] += (size_t)added;
+    if (!child_split)
+        return added;
+
+    size_t child_count = _btree_node_count(child_split, height - 1);
+    inner->counts[pos] -= child_count;
+    if (inner->nb_keys < BTREE_INNER_SIZE) {
+        _btree_inner_insert_at(inner, pos, child_key, child_split, child_count);
+        return added;
+    }
+
+    /* full: the middle separator goes up, the upper half to a new sibling */
+    BTREE_INNER* right = _btree_pop_spare(spare_inners);
+    __n_assert(right, return -1);
+    uint32_t half = BTREE_INNER_SIZE / 2;
+    right->nb_keys = BTREE_INNER_SIZE - half - 1;
+    memcpy(right->keys, &inner->keys[half + 1], right->nb_keys * sizeof(int64_t));
+    memcpy(right->children, &inner->children[half + 1], (right->nb_keys + 1) * sizeof(void*));
+    memcpy(right->counts, &inner->counts[half + 1], (right->nb_keys + 1) * sizeof(size_t));
+    inner->nb_keys = half;
+    (*split_key) = inner->keys[half];
+    if (pos <= half)
+        _btree_inner_insert_at(inner, pos, child_key, child_split, child_count);
+    else
+        _btree_inner_insert_at(right, pos - half - 1, child_key, child_split, child_count);
+    (*split) = right;
+    return added;
+} /* _btree_insert(...) */
+
+/**
+ *@brief put a value at key. The value previously at key is destroyed.
+ *@param tree targeted tree
+ *@param key key of the value
+ *@param value value to put
+ *@return TRUE or FALSE
+ */
+int btree_put(BTREE* tree, int64_t key, void* value) {
+    __n_assert(tree, return FALSE);
+
+    if (!tree->root) {
+        BTREE_LEAF* leaf = _btree_alloc_node(sizeof(BTREE_LEAF));
+        __n_assert(leaf, return FALSE);
+        tree->root = tree->first = tree->last = leaf;
+        tree->height = 0;
+    }
+
+    /* allocate the nodes of the splits first, so that a failure leaves the tree untouched */
+    size_t nb_splits = _btree_nb_splits(tree, key);
+    size_t nb_inners = (nb_splits > 0) ? nb_splits - 1 : 0;
+    if (nb_splits > tree->height)
+        nb_inners++;
+    BTREE_LEAF* spare_leaf = NULL;
+    BTREE_INNER* spare_inners = NULL;
+    if (nb_splits > 0) {
+        spare_leaf = _btree_alloc_node(sizeof(BTREE_LEAF));
+        __n_assert(spare_leaf, return FALSE);
+    }
+    for (size_t it = 0; it < nb_inners; it++) {
+        BTREE_INNER* spare = _btree_alloc_node(sizeof(BTREE_INNER));
+        __n_assert(spare, _btree_free_spares(spare_leaf, spare_inners); return FALSE);
+        spare->children[0] = spare_inners;
+        spare_inners = spare;
+    }
+
+    void* split = NULL;
+    int64_t split_key = 0;
+    int added = _btree_insert(tree, tree->root, tree->height, key, value, &spare_leaf, &spare_inners, &split, &split_key);
+    if (added < 0) {
+        _btree_free_spares(spare_leaf, spare_inners);
+        return FALSE;
+    }
+    tree->nb_items += (size_t)added;
+    if (split) {
+        BTREE_INNER* root = _btree_pop_spare(&spare_inners);
+        root->nb_keys = 1;
+        root->keys[0] = split_key;
+        root->children[0] = tree->root;
+        root->children[1] = split;
+        root->counts[1] = _btree_node_count(split, tree->height);
+        root->counts[0] = tree->nb_items - root->counts[1];
+        tree->root = root;
+        tree->height++;
+    }
+    _btree_free_spares(spare_leaf, spare_inners);
+    return TRUE;
+} /* btree_put(...) */
+
+/**
+ *@brief get the value at key. Leave value untouched if key is not found.
+ *@param tree targeted tree
+ *@param key key of the value
+ *@param value set to the value
+ *@return TRUE or FALSE
+ */
+int btree_get(const BTREE* tree, int64_t key, void** value) {
+    __n_assert(tree, return FALSE);
+    if (!tree->root)
+        return FALSE;
+    const BTREE_LEAF* leaf = _btree_find_leaf(tree, key);
+    uint32_t pos = _btree_lower_bound(leaf->keys, leaf->nb_keys, key);
+    if (pos >= leaf->nb_keys || leaf->keys[pos] != key)
+        return FALSE;
+    (*value) = leaf->values[pos];
+    return TRUE;
+} /* btree_get(...) */
+
+/**
+ *@brief refill the child of an inner node that fell below its minimum, from its left or right sibling, merging the two if they fit in one node
+ *@param tree targeted tree
+ *@param inner parent node
+ *@param pos index of the underfull child
+ *@param height height of the child
+ */
+void _btree_fix_child(BTREE* tree, BTREE_INNER* inner, uint32_t pos, size_t height) {
+    /* left and right children around separator sep */
+    uint32_t sep = (pos > 0) ? pos - 1 : pos;
+    int left_underfull = (sep == pos) ? TRUE : FALSE;
+
+    if (height == 0) {
+        BTREE_LEAF* left = (BTREE_LEAF*)inner->children[sep];
+        BTREE_LEAF* right = (BTREE_LEAF*)inner->children[sep + 1];
+        if (left->nb_keys + right->nb_keys <= BTREE_LEAF_SIZE) {
+            memcpy(&left->keys[left->nb_keys], right->keys, right->nb_keys * sizeof(int64_t));
+            memcpy(&left->values[left->nb_keys], right->values, right->nb_keys * sizeof(void*));
+            left->nb_keys += right->nb_keys;
+            left->next = right->next;
+            if (right->next)
+                right->next->prev = left;
+            else
+                tree->last = left;
+            inner->counts[sep] += inner->counts[sep + 1];
+            _btree_inner_remove_at(inner, sep);
+            _btree_free_node(right);
+            return;
+        }
+        if (left_underfull) {
+            _btree_leaf_insert_at(left, left->nb_keys, right->keys[0], right->values[0]);
+            right->nb_keys--;
+            memmove(right->keys, &right->keys[1], right->nb_keys * sizeof(int64_t));
+            memmove(right->values, &right->values[1], right->nb_keys * sizeof(void*));
+            inner->counts[sep]++;
+            inner->counts[sep + 1]--;
+        } else {
+            left->nb_keys--;
+            _btree_leaf_insert_at(right, 0, left->keys[left->nb_keys], left->values[left->nb_keys]);
+            inner->counts[sep]--;
+            inner->counts[sep + 1]++;
+        }
+        inner->keys[sep] = right->keys[0];
+        return;
+    }
+
+    BTREE_INNER* left = (BTREE_INNER*)inner->children[sep];
+    BTREE_INNER* right = (BTREE_INNER*)inner->children[sep + 1];
+    if (left->nb_keys + right->nb_keys + 1 <= BTREE_INNER_SIZE) {
+        left->keys[left->nb_keys] = inner->keys[sep];
+        memcpy(&left->keys[left->nb_keys + 1], right->keys, right->nb_keys * sizeof(int64_t));
+        memcpy(&left->children[left->nb_keys + 1], right->children, (right->nb_keys + 1) * sizeof(void*));
+        memcpy(&left->counts[left->nb_keys + 1], right->counts, (right->nb_keys + 1) * sizeof(size_t));
+        left->nb_keys += right->nb_keys + 1;
+        inner->counts[sep] += inner->counts[sep + 1];
+        _btree_inner_remove_at(inner, sep);
+        _btree_free_node(right);
+        return;
+    }
+    if (left_underfull) {
+        /* rotate the first child of right through the separator */
+        size_t moved = right->counts[0];
+        left->keys[left->nb_keys] = inner->keys[sep];
+        left->children[left->nb_keys + 1] = right->children[0];
+        left->counts[left->nb_keys + 1] = moved;
+        left->nb_keys++;
+        inner->keys[sep] = right->keys[0];
+        memmove(right->keys, &right->keys[1], (right->nb_keys - 1) * sizeof(int64_t));
+        memmove(right->children, &right->children[1], right->nb_keys * sizeof(void*));
+        memmove(right->counts, &right->counts[1], right->nb_keys * sizeof(size_t));
+        right->nb_keys--;
+        inner->counts[sep] += moved;
+        inner->counts[sep + 1] -= moved;
+    } else {
+        /* rotate the last child of left through the separator */
+        size_t moved = left->counts[left->nb_keys];
+        memmove(&right->keys[1], right->keys, right->nb_keys * sizeof(int64_t));
+        memmove(&right->children[1], right->children, (right->nb_keys + 1) * sizeof(void*));
+        memmove(&right->counts[1], right->counts, (right->nb_keys + 1) * sizeof(size_t));
+        right->keys[0] = inner->keys[sep];
+        right->children[0] = left->children[left->nb_keys];
+        right->counts[0] = moved;
+        right->nb_keys++;
+        inner->keys[sep] = left->keys[left->nb_keys - 1];
+        left->nb_keys--;
+        inner->counts[sep] -= moved;
+        inner->counts[sep + 1] += moved;
+    }
+} /* _btree_fix_child(...) */
+
+/**
+ *@brief remove a key under a node, refilling the children that fall below their minimum
+ *@param tree targeted tree
+ *@param node leaf or inner node
+ *@param height height of node
+ *@param key key to remove
+ *@return TRUE or FALSE if key was not found
+ */
+int _btree_delete(BTREE* tree, void* node, size_t height, int64_t key) {
+    if (height == 0) {
+        BTREE_LEAF* leaf = (BTREE_LEAF*)node;
+        uint32_t pos = _btree_lower_bound(leaf->keys, leaf->nb_keys, key);
+        if (pos >= leaf->nb_keys || leaf->keys[pos] != key)
+            return FALSE;
+        if (tree->destroy_func && leaf->values[pos])
+            tree->destroy_func(leaf->values[pos]);
+        leaf->nb_keys--;
+        memmove(&leaf->keys[pos], &leaf->keys[pos + 1], (leaf->nb_keys - pos) * sizeof(int64_t));
+        memmove(&leaf->values[pos], &leaf->values[pos + 1], (leaf->nb_keys - pos) * sizeof(void*));
+        return TRUE;
+    }
+
+    BTREE_INNER* inner = (BTREE_INNER*)node;
+    uint32_t pos = _btree_upper_bound(inner->keys, inner->nb_keys, key);
+    if (_btree_delete(tree, inner->children[pos], height - 1, key) == FALSE)
+        return FALSE;
+    inner->counts[pos]--;
+    uint32_t child_keys = (height == 1) ? ((BTREE_LEAF*)inner->children[pos])->nb_keys : ((BTREE_INNER*)inner->children[pos])->nb_keys;
+    if (child_keys < ((height == 1) ? BTREE_LEAF_MIN : BTREE_INNER_MIN))
+        _btree_fix_child(tree, inner, pos, height - 1);
+    return TRUE;
+} /* _btree_delete(...) */
+
+/**
+ *@brief remove key and destroy its value
+ *@param tree targeted tree
+ *@param key key to remove
+ *@return TRUE or FALSE if key was not found
+ */
+int btree_remove(BTREE* tree, int64_t key) {
+    __n_assert(tree, return FALSE);
+    if (!tree->root)
+        return FALSE;
+    if (_btree_delete(tree, tree->root, tree->height, key) == FALSE)
+        return FALSE;
+    tree->nb_items--;
+
+    /* shrink the tree when the root is left with a single child, or nothing */
+    if (tree->height > 0 && ((BTREE_INNER*)tree->root)->nb_keys == 0) {
+        void* root = tree->root;
+        tree->root = ((BTREE_INNER*)root)->children[0];
+        tree->height--;
+        _btree_free_node(root);
+    } else if (tree->height == 0 && tree->nb_items == 0) {
+        _btree_free_node(tree->root);
+        tree->root = tree->first = tree->last = NULL;
+    }
+    return TRUE;
+} /* btree_remove(...) */
+
+/**
+ *@brief fill an empty tree from strictly increasing keys, packing the nodes instead of splitting them one key at a time
+ *@param tree targeted tree, must be empty
+ *@param keys strictly increasing keys
+ *@param values values of the keys
+ *@param nb number of keys
+ *@return TRUE or FALSE
+ */
+int btree_bulk_load(BTREE* tree, const int64_t* keys, void* const* values, size_t nb) {
+    __n_assert(tree, return FALSE);
+    __n_assert(keys, return FALSE);
+    __n_assert(values, return FALSE);
+    if (tree->root) {
+        n_log(LOG_ERR, "btree_bulk_load needs an empty tree, it has %zu keys", tree->nb_items);
+        return FALSE;
+    }
+    for (size_t it = 1; it < nb; it++) {
+        if (keys[it] <= keys[it - 1]) {
+            n_log(LOG_ERR, "btree_bulk_load keys are not strictly increasing at index %zu", it);
+            return FALSE;
+        }
+    }
+    if (nb == 0)
+        return TRUE;
+
+    /* allocate every node first, so that a failure leaves the tree empty and the values to the caller */
+    size_t nb_leaves = (nb + BTREE_LEAF_SIZE - 1) / BTREE_LEAF_SIZE;
+    size_t nb_total = nb_leaves;
+    for (size_t level = nb_leaves; level > 1; nb_total += level)
+        level = (level + BTREE_INNER_SIZE) / (BTREE_INNER_SIZE + 1);
+    void** pool = NULL;
+    void** nodes = NULL;
+    size_t* counts = NULL;
+    int64_t* min_keys = NULL;
+    Malloc(pool, void*, nb_total);
+    Malloc(nodes, void*, nb_leaves);
+    Malloc(counts, size_t, nb_leaves);
+    Malloc(min_keys, int64_t, nb_leaves);
+    size_t nb_allocated = 0;
+    if (pool && nodes && counts && min_keys) {
+        while (nb_allocated < nb_total) {
+            pool[nb_allocated] = _btree_alloc_node(nb_allocated < nb_leaves ? sizeof(BTREE_LEAF) : sizeof(BTREE_INNER));
+            if (!pool[nb_allocated])
+                break;
+            nb_allocated++;
+        }
+    }
+    if (nb_allocated < nb_total) {
+        for (size_t it = 0; it < nb_allocated; it++)
+            _btree_free_node(pool[it]);
+        FreeNoLog(pool);
+        FreeNoLog(nodes);
+        FreeNoLog(counts);
+        FreeNoLog(min_keys);
+        return FALSE;
+    }
+
+    /* keys spread evenly so that every leaf holds at least BTREE_LEAF_MIN of them */
+    size_t done = 0;
+    BTREE_LEAF* prev = NULL;
+    for (size_t it = 0; it < nb_leaves; it++) {
+        BTREE_LEAF* leaf = (BTREE_LEAF*)pool[it];
+        size_t size = nb / nb_leaves + ((it < nb % nb_leaves) ? 1 : 0);
+        memcpy(leaf->keys, &keys[done], size * sizeof(int64_t));
+        memcpy(leaf->values, &values[done], size * sizeof(void*));
+        leaf->nb_keys = (uint32_t)size;
+        leaf->prev = prev;
+        if (prev)
+            prev->next = leaf;
+        prev = leaf;
+        nodes[it] = leaf;
+        counts[it] = size;
+        min_keys[it] = keys[done];
+        done += size;
+    }
+    tree->first = (BTREE_LEAF*)pool[0];
+    tree->last = prev;
+    tree->nb_items = nb;
+    tree->height = 0;
+
+    /* same even spread for the children of each inner level, built until a single root is left */
+    size_t nb_nodes = nb_leaves;
+    size_t next_node = nb_leaves;
+    while (nb_nodes > 1) {
+        size_t nb_parents = (nb_nodes + BTREE_INNER_SIZE) / (BTREE_INNER_SIZE + 1);
+        size_t child = 0;
+        for (size_t it = 0; it < nb_parents; it++) {
+            BTREE_INNER* inner = (BTREE_INNER*)pool[next_node++];
+            size_t size = nb_nodes / nb_parents + ((it < nb_nodes % nb_parents) ? 1 : 0);
+            size_t count = 0;
+            int64_t min_key = min_keys[child];
+            for (size_t c = 0; c < size; c++, child++) {
+                inner->children[c] = nodes[child];
+                inner->counts[c] = counts[child];
+                if (c > 0)
+                    inner->keys[c - 1] = min_keys[child];
+                count += counts[child];
+            }
+            inner->nb_keys = (uint32_t)(size - 1);
+            /* parents are written behind the children already read */
+            nodes[it] = inner;
+            counts[it] = count;
+            min_keys[it] = min_key;
+        }
+        nb_nodes = nb_parents;
+        tree->height++;
+    }
+    tree->root = nodes[0];
+
+    Free(pool);
+    Free(nodes);
+    Free(counts);
+    Free(min_keys);
+    return TRUE;
+} /* btree_bulk_load(...) */
+
+/**
+ *@brief get the number of keys lower than key, i.e. the rank key has or would have
+ *@param tree targeted tree
+ *@param key key to rank
+ *@return the number of keys lower than key
+ */
+size_t btree_rank(const BTREE* tree, int64_t key) {
+    __n_assert(tree, return 0);
+    if (!tree->root)
+        return 0;
+    size_t rank = 0;
+    const void* node = tree->root;
+    for (size_t height = tree->height; height > 0; height--) {
+        const BTREE_INNER* inner = (const BTREE_INNER*)node;
+        uint32_t pos = _btree_upper_bound(inner->keys, inner->nb_keys, key);
+        for (uint32_t it = 0; it < pos; it++)
+            rank += inner->counts[it];
+        node = inner->children[pos];
+    }
+    const BTREE_LEAF* leaf = (const BTREE_LEAF*)node;
+    return rank + _btree_lower_bound(leaf->keys, leaf->nb_keys, key);
+} /* btree_rank(...) */
+
+/**
+ *@brief get the key and value of a given rank, 0 being the smallest key
+ *@param tree targeted tree
+ *@param rank rank of the key
+ *@param key set to the key, or NULL
+ *@param value set to the value, or NULL
+ *@return TRUE or FALSE if rank is out of the tree
+ */
+int btree_select(const BTREE* tree, size_t rank, int64_t* key, void** value) {
+    __n_assert(tree, return FALSE);
+    if (rank >= tree->nb_items)
+        return FALSE;
+    const void* node = tree->root;
+    for (size_t height = tree->height; height > 0; height--) {
+        const BTREE_INNER* inner = (const BTREE_INNER*)node;
+        uint32_t pos = 0;
+        while (rank >= inner->counts[pos]) {
+            rank -= inner->counts[pos];
+            pos++;
+        }
+        node = inner->children[pos];
+    }
+    const BTREE_LEAF* leaf = (const BTREE_LEAF*)node;
+    if (key)
+        (*key) = leaf->keys[rank];
+    if (value)
+        (*value) = leaf->values[rank];
+    return TRUE;
+} /* btree_select(...) */
+
+/**
+ *@brief put a cursor on the smallest key
+ *@param tree targeted tree
+ *@param cursor cursor to set
+ *@return TRUE or FALSE if the tree is empty
+ */
+int btree_cursor_first(const BTREE* tree, BTREE_CURSOR* cursor) {
+    __n_assert(tree, return FALSE);
+    __n_assert(cursor, return FALSE);
+    cursor->leaf = tree->first;
+    cursor->pos = 0;
+    return cursor->leaf ? TRUE : FALSE;
+} /* btree_cursor_first(...) */
+
+/**
+ *@brief put a cursor on the greatest key
+ *@param tree targeted tree
+ *@param cursor cursor to set
+ *@return TRUE or FALSE if the tree is empty
+ */
+int btree_cursor_last(const BTREE* tree, BTREE_CURSOR* cursor) {
+    __n_assert(tree, return FALSE);
+    __n_assert(cursor, return FALSE);
+    cursor->leaf = tree->last;
+    cursor->pos = cursor->leaf ? cursor->leaf->nb_keys - 1 : 0;
+    return cursor->leaf ? TRUE : FALSE;
+} /* btree_cursor_last(...) */
+
+/**
+ *@brief put a cursor on the smallest key greater or equal to key, the start of a range scan
+ *@param tree targeted tree
+ *@param cursor cursor to set
+ *@param key lower bound of the range
+ *@return TRUE or FALSE if all the keys are lower than key
+ */
+int btree_cursor_seek(const BTREE* tree, BTREE_CURSOR* cursor, int64_t key) {
+    __n_assert(tree, return FALSE);
+    __n_assert(cursor, return FALSE);
+    cursor->leaf = NULL;
+    cursor->pos = 0;
+    if (!tree->root)
+        return FALSE;
+    BTREE_LEAF* leaf = _btree_find_leaf(tree, key);
+    uint32_t pos = _btree_lower_bound(leaf->keys, leaf->nb_keys, key);
+    if (pos >= leaf->nb_keys) {
+        leaf = leaf->next;
+        pos = 0;
+    }
+    cursor->leaf = leaf;
+    cursor->pos = pos;
+    return leaf ? TRUE : FALSE;
+} /* btree_cursor_seek(...) */
+
+/**
+ *@brief move a cursor to the next key
+ *@param cursor targeted cursor
+ *@return TRUE or FALSE if there is no next key
+ */
+int btree_cursor_next(BTREE_CURSOR* cursor) {
+    __n_assert(cursor, return FALSE);
+    if (!cursor->leaf)
+        return FALSE;
+    if (cursor->pos + 1 < cursor->leaf->nb_keys) {
+        cursor->pos++;
+        return TRUE;
+    }
+    cursor->leaf = cursor->leaf->next;
+    cursor->pos = 0;
+    return cursor->leaf ? TRUE : FALSE;
+} /* btree_cursor_next(...) */
+
+/**
+ *@brief move a cursor to the previous key
+ *@param cursor targeted cursor
+ *@return TRUE or FALSE if there is no previous key
+ */
+int btree_cursor_prev(BTREE_CURSOR* cursor) {
+    __n_assert(cursor, return FALSE);
+    if (!cursor->leaf)
+        return FALSE;
+    if (cursor->pos > 0) {
+        cursor->pos--;
+        return TRUE;
+    }
+    cursor->leaf = cursor->leaf->prev;
+    cursor->pos = cursor->leaf ? cursor->leaf->nb_keys - 1 : 0;
+    return cursor->leaf ? TRUE : FALSE;
+} /* btree_cursor_prev(...) */
+
+/**
+ *@brief get the key and value under a cursor
+ *@param cursor targeted cursor
+ *@param key set to the key, or NULL
+ *@param value set to the value, or NULL
+ *@return TRUE or FALSE if the cursor is past the ends
+ */
+int btree_cursor_get(const BTREE_CURSOR* cursor, int64_t* key, void** value) {
+    __n_assert(cursor, return FALSE);
+    if (!cursor->leaf)
+        return FALSE;
+    if (key)
+        (*key) = cursor->leaf->keys[cursor->pos];
+    if (value)
+        (*value) = cursor->leaf->values[cursor->pos];
+    return TRUE;
+} /* btree_cursor_get(...) */
+
+/**
+ *@brief free the inner nodes under a node
+ *@param node inner node
+ *@param height height of node, at least 1
+ */
+void _btree_free_inner(void* node, size_t height) {
+    BTREE_INNER* inner = (BTREE_INNER*)node;
+    if (height > 1) {
+        for (uint32_t it = 0; it <= inner->nb_keys; it++)
+            _btree_free_inner(inner->children[it], height - 1);
+    }
+    _btree_free_node(inner);
+} /* _btree_free_inner(...) */
+
+/**
+ *@brief remove all the keys and destroy their values
+ *@param tree targeted tree
+ *@return TRUE or FALSE
+ */
+int btree_empty(BTREE* tree) {
+    __n_assert(tree, return FALSE);
+    /* the leaves are chained, only the inner nodes need a walk */
+    if (tree->root && tree->height > 0)
+        _btree_free_inner(tree->root, tree->height);
+    BTREE_LEAF* leaf = tree->first;
+    while (leaf) {
+        BTREE_LEAF* next = leaf->next;
+        if (tree->destroy_func) {
+            for (uint32_t it = 0; it < leaf->nb_keys; it++) {
+                if (leaf->values[it])
+                    tree->destroy_func(leaf->values[it]);
+            }
+        }
+        _btree_free_node(leaf);
+        leaf = next;
+    }
+    tree->root = tree->first = tree->last = NULL;
+    tree->height = 0;
+    tree->nb_items = 0;
+    return TRUE;
+} /* btree_empty(...) */
+
+/**
+ *@brief destroy a tree and the values left in it
+ *@param tree pointer to the tree to destroy
+ *@return TRUE or FALSE
+ */
+int destroy_btree(BTREE** tree) {
+    __n_assert(tree && (*tree), return FALSE);
+    btree_empty(*tree);
+    Free((*tree));
+    return TRUE;
+} /* destroy_btree(...) */
@@ -64,28 +64,17 @@ void destroy_config_file_section(void* ptr) {
 CONFIG_FILE* load_config_file(char* filename, int* errors) {
     CONFIG_FILE* cfg_file = NULL;
     CONFIG_FILE_SECTION* section = NULL;
-    char buffer[MAX_CONFIG_LINE_LEN] = "";
+    char* buffer = NULL;
+    size_t buffer_len = 0;
     char** split_result = NULL;
     N_PCRE* npcre = npcre_new("(.*?=)(.*)", 0);
-    int error = 0;
-    FILE* in = NULL;
+    N_LINE_READER* in = NULL;
 
     __n_assert(filename, return NULL);
-    int fd = open(filename, O_RDONLY);
-    error = errno;
-
-    if (fd == -1) {
-        n_log(LOG_ERR, "Unable to open %s: %s", _str(filename), strerror(error));
-        (*errors)++;
-        npcre_delete(&npcre);
-        return NULL;
-    }
-
-    in = fdopen(fd, "r");
-    error = errno;
+    /* lines longer than MAX_CONFIG_LINE_LEN make the reader buffer grow */
+    in = open_line_reader(filename, MAX_CONFIG_LINE_LEN, '\n');
     if (!in) {
-        n_log(LOG_ERR, "fdopen failed for %s (fd=%d): %s", _str(filename), fd, strerror(error));
-        close(fd);
+        n_log(LOG_ERR, "Unable to open %s", _str(filename));
         (*errors)++;
         npcre_delete(&npcre);
         return NULL;
@@ -93,14 +82,14 @@ CONFIG_FILE* load_config_file(char* filename, int* errors) {
 
     Malloc(cfg_file, CONFIG_FILE, 1);
     if (!cfg_file) {
-        fclose(in);
+        destroy_line_reader(&in);
         npcre_delete(&npcre);
         return NULL;
     }
     cfg_file->sections = new_generic_list(MAX_LIST_ITEMS);
     if (!cfg_file->sections) {
         Free(cfg_file);
-        fclose(in);
+        destroy_line_reader(&in);
         npcre_delete(&npcre);
         return NULL;
     }
@@ -110,7 +99,7 @@ CONFIG_FILE* load_config_file(char* filename, int* errors) {
         (*errors)++;
         list_destroy(&cfg_file->sections);
         Free(cfg_file);
-        fclose(in);
+        destroy_line_reader(&in);
         npcre_delete(&npcre);
         return NULL;
     }
@@ -123,7 +112,7 @@ CONFIG_FILE* load_config_file(char* filename, int* errors) {
         list_destroy(&cfg_file->sections);
         Free(cfg_file->filename);
         Free(cfg_file);
-        fclose(in);
+        destroy_line_reader(&in);
         npcre_delete(&npcre);
         return NULL;
     }
@@ -136,7 +125,7 @@ CONFIG_FILE* load_config_file(char* filename, int* errors) {
         Free(cfg_file->filename);
         Free(default_section);
         Free(cfg_file);
-        fclose(in);
+        destroy_line_reader(&in);
         npcre_delete(&npcre);
         return NULL;
     }
@@ -150,14 +139,14 @@ CONFIG_FILE* load_config_file(char* filename, int* errors) {
         Free(default_section->section_name);
         Free(default_section);
         Free(cfg_file);
-        fclose(in);
+        destroy_line_reader(&in);
         npcre_delete(&npcre);
         return NULL;
     }
     list_push(cfg_file->sections, default_section, &destroy_config_file_section);
 
     size_t line_number = 0;
-    while (fgets(buffer, MAX_CONFIG_LINE_LEN, in)) {
+    while (line_reader_next(in, &buffer, &buffer_len)) {
         NSTRBYTE end = 0;
 
         line_number++;
@@ -349,11 +338,11 @@ CONFIG_FILE* load_config_file(char* filename, int* errors) {
         }
     }
     npcre_delete(&npcre);
-    if (!feof(in)) {
+    if (!in->eof) {
         n_log(LOG_ERR, "couldn't read EOF for %s", filename);
         (*errors)++;
     }
-    fclose(in);
+    destroy_line_reader(&in);
 
     return cfg_file;
 
@@ -156,34 +156,16 @@ void n_set_time_from_stat(N_FILE_INFO* file, const struct stat* st) {
 }
 
 /**
- * @brief Scan a directory and append only regular files into a sorted list (oldest first).
- *
- * This function:
- *   - Opens @p dir with opendir()
- *   - Iterates entries via readdir()
- *   - Builds full path for each entry (no chdir())
- *   - Uses stat() to detect file type and modification time
- *   - If recursion enabled and entry is a directory, scans it recursively
- *   - If entry is a regular file, pushes an allocated N_FILE_INFO into @p result,
- *     keeping @p result sorted by n_comp_file_info (oldest -> newest).
- *
- * Error handling:
- *   - If opendir() fails: returns FALSE.
- *   - If stat() fails for an entry: logs and continues.
- *   - If readdir() fails: logs and returns FALSE.
- *
+ * @brief recursive, append the regular files of dir to result, unsorted, helper for n_scan_dir
  * @param dir     Directory to scan (non-NULL)
  * @param result  LIST to fill (non-NULL)
  * @param recurse TRUE/FALSE recursion flag
  * @return TRUE on success, FALSE on fatal error.
  */
-int n_scan_dir(const char* dir, LIST* result, const int recurse) {
+static int _n_scan_dir(const char* dir, LIST* result, const int recurse) {
     DIR* dp = NULL;
     const struct dirent* entry = NULL;
 
-    __n_assert(dir, return FALSE);
-    __n_assert(result, return FALSE);
-
     int error = 0;
     dp = opendir(dir);
     error = errno;
@@ -217,7 +199,7 @@ int n_scan_dir(const char* dir, LIST* result, const int recurse) {
 
         if (S_ISDIR(st.st_mode)) {
             if (recurse != FALSE) {
-                if (n_scan_dir(fullpath, result, recurse) == FALSE) {
+                if (_n_scan_dir(fullpath, result, recurse) == FALSE) {
                     n_log(LOG_ERR, "error while recursively scanning %s", fullpath);
                 }
             }
@@ -230,7 +212,8 @@ int n_scan_dir(const char* dir, LIST* result, const int recurse) {
                 file->name = strdup(fullpath);
                 n_set_time_from_stat(file, &st);
 
-                list_push_sorted(result, file, n_comp_file_info, n_free_file_info);
+                if (list_push(result, file, n_free_file_info) == FALSE)
+                    n_free_file_info(file);
             }
         } else {
             /* Ignore non-regular / non-directory entries (symlinks, sockets, etc.) */
@@ -249,4 +232,36 @@ int n_scan_dir(const char* dir, LIST* result, const int recurse) {
 
     closedir(dp);
     return TRUE;
+} /* _n_scan_dir(...) */
+
+/**
+ * @brief Scan a directory and append only regular files into a sorted list (oldest first).
+ *
+ * This function:
+ *   - Opens @p dir with opendir()
+ *   - Iterates entries via readdir()
+ *   - Builds full path for each entry (no chdir())
+ *   - Uses stat() to detect file type and modification time
+ *   - If recursion enabled and entry is a directory, scans it recursively
+ *   - If entry is a regular file, pushes an allocated N_FILE_INFO into @p result
+ *   - Sorts @p result once with list_sort and n_comp_file_info (oldest -> newest),
+ *     instead of a sorted insert per file.
+ *
+ * Error handling:
+ *   - If opendir() fails: returns FALSE.
+ *   - If stat() fails for an entry: logs and continues.
+ *   - If readdir() fails: logs and returns FALSE.
+ *
+ * @param dir     Directory to scan (non-NULL)
+ * @param result  LIST to fill (non-NULL)
+ * @param recurse TRUE/FALSE recursion flag
+ * @return TRUE on success, FALSE on fatal error.
+ */
+int n_scan_dir(const char* dir, LIST* result, const int recurse) {
+    __n_assert(dir, return FALSE);
+    __n_assert(result, return FALSE);
+
+    int ret = _n_scan_dir(dir, result, recurse);
+    list_sort(result, n_comp_file_info);
+    return ret;
 }
@@ -30,185 +30,778 @@
 #include "nilorea/n_str.h"
 
 #include <pthread.h>
+#include <sched.h>
 #include <string.h>
 #include <strings.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifdef __windows__
 #include <winsock.h>
 #else
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
-/* Trie tree tables */
+/* Trie tree tables, stored as an adaptive radix tree */
 
 /**
- *@brief node creation, HASH_CLASSIC mode
- *@param table targeted table
- *@param key key of new node
- *@return NULL or a new HASH_NODE *
+ *@brief release the value held by a HASH_NODE (string copy, or pointer through its destroy_func). The node itself is kept.
+ *@param node_ptr The node holding the value to release
  */
-HASH_NODE* _ht_new_node_trie(HASH_TABLE* table, const char key) {
-    __n_assert(table, return NULL);
+void _ht_node_destroy_value(HASH_NODE* node_ptr) {
+    __n_assert(node_ptr, return);
+    if (node_ptr->type == HASH_STRING) {
+        Free(node_ptr->data.string);
+    }
+    if (node_ptr->type == HASH_PTR) {
+        if (node_ptr->destroy_func && node_ptr->data.ptr) {
+            node_ptr->destroy_func(node_ptr->data.ptr);
+        }
+        /* No free by default. must be passed as a destroy_func
+           else
+           {
+           Free( node_ptr  -> data . ptr );
+           }
+           */
+    }
+} /* _ht_node_destroy_value */
 
-    HASH_NODE* new_hash_node = NULL;
-    Malloc(new_hash_node, HASH_NODE, 1);
-    __n_assert(new_hash_node, n_log(LOG_ERR, "Could not allocate new_hash_node"); return NULL);
-    new_hash_node->key = NULL;
-    new_hash_node->hash_value = 0;
-    new_hash_node->data.ptr = NULL;
-    new_hash_node->destroy_func = NULL;
-    new_hash_node->children = NULL;
-    new_hash_node->is_leaf = 0;
-    new_hash_node->need_rehash = 0;
-    new_hash_node->alphabet_length = table->alphabet_length;
+/**
+ *@brief destroy a HASH_NODE by first calling the HASH_NODE destructor
+ *@param node The node to kill
+ */
+void _ht_node_destroy(void* node) {
+    HASH_NODE* node_ptr = (HASH_NODE*)node;
+    __n_assert(node_ptr, return);
+    _ht_node_destroy_value(node_ptr);
+    FreeNoLog(node_ptr->key);
+    Free(node_ptr);
+} /* _ht_node_destroy */
 
-    Malloc(new_hash_node->children, HASH_NODE*, table->alphabet_length);
-    __n_assert(new_hash_node->children, n_log(LOG_ERR, "Could not allocate new_hash_node"); Free(new_hash_node); return NULL);
+/**
+ *@brief get the tree byte of the character at position pos in key, HASH_TRIE mode. Characters outside of the table alphabet give 0.
+ *@param table targeted table
+ *@param key key to read
+ *@param pos position in key
+ *@return the byte used to index the tree
+ */
+uint8_t _ht_art_byte(const HASH_TABLE* table, const char* key, size_t pos) {
+    size_t index = (size_t)key[pos] - table->alphabet_offset;
+    if (index >= table->alphabet_length || index > UINT8_MAX)
+        return 0;
+    return (uint8_t)index;
+} /* _ht_art_byte(...) */
 
-    /* n_log( LOG_DEBUG , "node: %d %c table: alpha: %d / offset %d" , key , key , table -> alphabet_length , table -> alphabet_offset ); */
+/**
+ *@brief check that every character of key is in the table alphabet, HASH_TRIE mode
+ *@param table targeted table
+ *@param key key to check
+ *@param log_level level used to log the invalid characters
+ *@return TRUE or FALSE
+ */
+int _ht_art_check_key(const HASH_TABLE* table, const char* key, int log_level) {
+    int valid = TRUE;
+    for (size_t it = 0; key[it] != '\0'; it++) {
+        size_t index = (size_t)key[it] - table->alphabet_offset;
+        if (index >= table->alphabet_length || index > UINT8_MAX) {
+            n_log(log_level, "Invalid value %zu for character at position %zu of %s, set to 0", index, it, key);
+            valid = FALSE;
+        }
+    }
+    return valid;
+} /* _ht_art_check_key(...) */
 
-    for (size_t it = 0; it < table->alphabet_length; it++) {
-        new_hash_node->children[it] = NULL;
+/**
+ *@brief tell if two keys follow the same path in the tree, HASH_TRIE mode
+ *@param table targeted table
+ *@param key1 first key
+ *@param key2 second key
+ *@return TRUE or FALSE
+ */
+int _ht_art_key_equal(const HASH_TABLE* table, const char* key1, const char* key2) {
+    size_t it = 0;
+    for (; key1[it] != '\0' && key2[it] != '\0'; it++) {
+        if (key1[it] != key2[it] && _ht_art_byte(table, key1, it) != _ht_art_byte(table, key2, it))
+            return FALSE;
     }
-    new_hash_node->is_leaf = 0;
-    new_hash_node->key_id = key;
+    return (key1[it] == '\0' && key2[it] == '\0') ? TRUE : FALSE;
+} /* _ht_art_key_equal(...) */
+
+/**
+ *@brief allocate a leaf node holding a copy of key and no value yet, HASH_TRIE mode
+ *@param key key of the new node
+ *@return NULL or a new HASH_NODE *
+ */
+HASH_NODE* _ht_art_new_leaf(const char* key) {
+    HASH_ART_LEAF_NODE* new_leaf = NULL;
+    Malloc(new_leaf, HASH_ART_LEAF_NODE, 1);
+    __n_assert(new_leaf, n_log(LOG_ERR, "Could not allocate new_leaf"); return NULL);
+    HASH_NODE* new_hash_node = &new_leaf->node;
+    new_hash_node->key = strdup(key);
+    __n_assert(new_hash_node->key, n_log(LOG_ERR, "Could not allocate new_hash_node->key"); Free(new_hash_node); return NULL);
+    new_hash_node->type = HASH_UNKNOWN;
+    new_hash_node->is_leaf = 1;
     return new_hash_node;
-} /* _ht_new_node_trie(...) */
+} /* _ht_art_new_leaf(...) */
 
 /**
- *@brief  Search a key and tell if it's holding a value (leaf)
- *@param table targeted hash table
- *@param key key verify
- *@return 1 or 0
+ *@brief allocate an empty inner node, HASH_TRIE mode
+ *@param kind HASH_ART_KIND4, HASH_ART_KIND16, HASH_ART_KIND48 or HASH_ART_KIND256
+ *@return NULL or a new HASH_ART_NODE *
+ */
+HASH_ART_NODE* _ht_art_new_node(uint8_t kind) {
+    HASH_ART_NODE* node = NULL;
+    switch (kind) {
+        case HASH_ART_KIND4: {
+            HASH_ART_NODE4* node4 = NULL;
+            Malloc(node4, HASH_ART_NODE4, 1);
+            node = (HASH_ART_NODE*)node4;
+        } break;
+        case HASH_ART_KIND16: {
+            HASH_ART_NODE16* node16 = NULL;
+            Malloc(node16, HASH_ART_NODE16, 1);
+            node = (HASH_ART_NODE*)node16;
+        } break;
+        case HASH_ART_KIND48: {
+            HASH_ART_NODE48* node48 = NULL;
+            Malloc(node48, HASH_ART_NODE48, 1);
+            node = (HASH_ART_NODE*)node48;
+        } break;
+        default: {
+            HASH_ART_NODE256* node256 = NULL;
+            Malloc(node256, HASH_ART_NODE256, 1);
+            node = (HASH_ART_NODE*)node256;
+        } break;
+    }
+    __n_assert(node, n_log(LOG_ERR, "Could not allocate adaptive radix tree node of kind %d", kind); return NULL);
+    node->kind = kind;
+    return node;
+} /* _ht_art_new_node(...) */
+
+/**
+ *@brief get the first child of an inner node with a key byte greater or equal to byte, HASH_TRIE mode. Used to walk the children in key order.
+ *@param node inner node
+ *@param byte in: first key byte to look at, out: key byte of the returned child
+ *@return NULL or the child, an inner node or a tagged leaf
  */
-int _ht_is_leaf_node_trie(HASH_TABLE* table, const char* key) {
-    __n_assert(table, return -1);
+void* ht_art_next_child(const HASH_ART_NODE* node, size_t* byte) {
+    __n_assert(node, return NULL);
+    __n_assert(byte, return NULL);
+
+    switch (node->kind) {
+        case HASH_ART_KIND4: {
+            const HASH_ART_NODE4* node4 = (const HASH_ART_NODE4*)node;
+            for (uint16_t it = 0; it < node->nb_children; it++) {
+                if (node4->keys[it] >= (*byte)) {
+                    (*byte) = node4->keys[it];
+                    return node4->children[it];
+                }
+            }
+        } break;
+        case HASH_ART_KIND16: {
+            const HASH_ART_NODE16* node16 = (const HASH_ART_NODE16*)node;
+            for (uint16_t it = 0; it < node->nb_children; it++) {
+                if (node16->keys[it] >= (*byte)) {
+                    (*byte) = node16->keys[it];
+                    return node16->children[it];
+                }
+            }
+        } break;
+        case HASH_ART_KIND48: {
+            const HASH_ART_NODE48* node48 = (const HASH_ART_NODE48*)node;
+            for (size_t it = (*byte); it < 256; it++) {
+                if (node48->child_index[it] != 0) {
+                    (*byte) = it;
+                    return node48->children[node48->child_index[it] - 1];
+                }
+            }
+        } break;
+        default: {
+            const HASH_ART_NODE256* node256 = (const HASH_ART_NODE256*)node;
+            for (size_t it = (*byte); it < 256; it++) {
+                if (node256->children[it]) {
+                    (*byte) = it;
+                    return node256->children[it];
+                }
+            }
+        } break;
+    }
+    return NULL;
+} /* ht_art_next_child(...) */
 
-    /* checks if the prefix match of key and root is a leaf node */
-    HASH_NODE* node = table->root;
-    for (size_t it = 0; key[it]; it++) {
-        size_t index = (size_t)key[it] - table->alphabet_offset;
-        if (index >= table->alphabet_length) {
-            n_log(LOG_ERR, "Invalid value %d for charater at position %d of %s, set to 0", index, it, key);
-            index = 0;
+/**
+ *@brief find the slot holding the child of an inner node for a key byte, HASH_TRIE mode
+ *@param node inner node
+ *@param byte key byte of the child
+ *@return NULL or the address of the child pointer
+ */
+void** _ht_art_find_child(HASH_ART_NODE* node, uint8_t byte) {
+    switch (node->kind) {
+        case HASH_ART_KIND4: {
+            HASH_ART_NODE4* node4 = (HASH_ART_NODE4*)node;
+            for (uint16_t it = 0; it < node->nb_children; it++) {
+                if (node4->keys[it] == byte)
+                    return &node4->children[it];
+            }
+        } break;
+        case HASH_ART_KIND16: {
+            HASH_ART_NODE16* node16 = (HASH_ART_NODE16*)node;
+#ifdef __SSE2__
+            __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)byte), _mm_loadu_si128((const __m128i*)node16->keys));
+            int mask = _mm_movemask_epi8(cmp) & ((1 << node->nb_children) - 1);
+            if (mask)
+                return &node16->children[__builtin_ctz((unsigned int)mask)];
+#else
+            for (uint16_t it = 0; it < node->nb_children; it++) {
+                if (node16->keys[it] == byte)
+                    return &node16->children[it];
+            }
+#endif
+        } break;
+        case HASH_ART_KIND48: {
+            HASH_ART_NODE48* node48 = (HASH_ART_NODE48*)node;
+            if (node48->child_index[byte] != 0)
+                return &node48->children[node48->child_index[byte] - 1];
+        } break;
+        default: {
+            HASH_ART_NODE256* node256 = (HASH_ART_NODE256*)node;
+            if (node256->children[byte])
+                return &node256->children[byte];
+        } break;
+    }
+    return NULL;
+} /* _ht_art_find_child(...) */
+
+/**
+ *@brief copy the header of an inner node into a node of another kind, HASH_TRIE mode
+ *@param dest new node
+ *@param src old node
+ */
+void _ht_art_copy_header(HASH_ART_NODE* dest, const HASH_ART_NODE* src) {
+    dest->nb_children = src->nb_children;
+    dest->prefix_len = src->prefix_len;
+    memcpy(dest->prefix, src->prefix, HASH_ART_MAX_PREFIX);
+    dest->leaf = src->leaf;
+    dest->max_weight = src->max_weight;
+} /* _ht_art_copy_header(...) */
+
+/**
+ *@brief recompute the highest weight below an inner node from its leaf and children, HASH_TRIE mode
+ *@param node inner node
+ */
+void _ht_art_refresh_weight(HASH_ART_NODE* node) {
+    size_t max_weight = node->leaf ? HASH_ART_WEIGHT(node->leaf) : 0;
+    size_t byte = 0;
+    for (const void* child = ht_art_next_child(node, &byte); child; byte++, child = ht_art_next_child(node, &byte)) {
+        size_t weight = HASH_ART_IS_LEAF(child) ? HASH_ART_WEIGHT(HASH_ART_LEAF(child)) : ((const HASH_ART_NODE*)child)->max_weight;
+        if (weight > max_weight)
+            max_weight = weight;
+    }
+    node->max_weight = max_weight;
+} /* _ht_art_refresh_weight(...) */
+
+/**
+ *@brief add a child to an inner node, moving it to a bigger kind when it is full, HASH_TRIE mode
+ *@param ref address of the pointer to the inner node, updated if the node is replaced
+ *@param byte key byte of the new child, not already used in the node
+ *@param child new child, an inner node or a tagged leaf
+ *@return TRUE or FALSE
+ */
+int _ht_art_add_child(HASH_ART_NODE** ref, uint8_t byte, void* child) {
+    HASH_ART_NODE* node = (*ref);
+    switch (node->kind) {
+        case HASH_ART_KIND4:
+        case HASH_ART_KIND16: {
+            uint8_t* keys = (node->kind == HASH_ART_KIND4) ? ((HASH_ART_NODE4*)node)->keys : ((HASH_ART_NODE16*)node)->keys;
+            void** children = (node->kind == HASH_ART_KIND4) ? ((HASH_ART_NODE4*)node)->children : ((HASH_ART_NODE16*)node)->children;
+            uint16_t capacity = (node->kind == HASH_ART_KIND4) ? 4 : 16;
+            if (node->nb_children < capacity) {
+                /* keep the keys sorted */
+                uint16_t pos = 0;
+                while (pos < node->nb_children && keys[pos] < byte) pos++;
+                memmove(keys + pos + 1, keys + pos, (size_t)(node->nb_children - pos) * sizeof(uint8_t));
+                memmove(children + pos + 1, children + pos, (size_t)(node->nb_children - pos) * sizeof(void*));
+                keys[pos] = byte;
+                children[pos] = child;
+                node->nb_children++;
+                return TRUE;
+            }
+            HASH_ART_NODE* bigger = _ht_art_new_node(node->kind == HASH_ART_KIND4 ? HASH_ART_KIND16 : HASH_ART_KIND48);
+            __n_assert(bigger, return FALSE);
+            _ht_art_copy_header(bigger, node);
+            if (bigger->kind == HASH_ART_KIND16) {
+                memcpy(((HASH_ART_NODE16*)bigger)->keys, keys, capacity * sizeof(uint8_t));
+                memcpy(((HASH_ART_NODE16*)bigger)->children, children, capacity * sizeof(void*));
+            } else {
+                for (uint16_t it = 0; it < capacity; it++) {
+                    ((HASH_ART_NODE48*)bigger)->child_index[keys[it]] = (uint8_t)(it + 1);
+                    ((HASH_ART_NODE48*)bigger)->children[it] = children[it];
+                }
+            }
+            Free(node);
+            (*ref) = bigger;
+            return _ht_art_add_child(ref, byte, child);
         }
-        if (node->children[index]) {
-            node = node->children[index];
-        } else {
-            return 0;
+        case HASH_ART_KIND48: {
+            HASH_ART_NODE48* node48 = (HASH_ART_NODE48*)node;
+            if (node->nb_children < 48) {
+                uint8_t slot = 0;
+                while (node48->children[slot]) slot++;
+                node48->children[slot] = child;
+                node48->child_index[byte] = (uint8_t)(slot + 1);
+                node->nb_children++;
+                return TRUE;
+            }
+            HASH_ART_NODE256* node256 = (HASH_ART_NODE256*)_ht_art_new_node(HASH_ART_KIND256);
+            __n_assert(node256, return FALSE);
+            _ht_art_copy_header(&node256->header, node);
+            for (size_t it = 0; it < 256; it++) {
+                if (node48->child_index[it] != 0)
+                    node256->children[it] = node48->children[node48->child_index[it] - 1];
+            }
+            Free(node);
+            (*ref) = &node256->header;
+            return _ht_art_add_child(ref, byte, child);
+        }
+        default: {
+            ((HASH_ART_NODE256*)node)->children[byte] = child;
+            node->nb_children++;
+            return TRUE;
         }
     }
-    return node->is_leaf;
-} /* _ht_is_leaf_node_trie(...) */
+} /* _ht_art_add_child(...) */
 
 /**
- *@brief destroy a HASH_NODE by first calling the HASH_NODE destructor
- *@param node The node to kill
+ *@brief remove a child from an inner node, moving it to a smaller kind when it gets sparse, HASH_TRIE mode
+ *@param ref address of the pointer to the inner node, updated if the node is replaced
+ *@param byte key byte of the child to remove
  */
-void _ht_node_destroy(void* node) {
-    HASH_NODE* node_ptr = (HASH_NODE*)node;
-    __n_assert(node_ptr, return);
-    if (node_ptr->type == HASH_STRING) {
-        Free(node_ptr->data.string);
+void _ht_art_remove_child(HASH_ART_NODE** ref, uint8_t byte) {
+    HASH_ART_NODE* node = (*ref);
+    switch (node->kind) {
+        case HASH_ART_KIND4:
+        case HASH_ART_KIND16: {
+            uint8_t* keys = (node->kind == HASH_ART_KIND4) ? ((HASH_ART_NODE4*)node)->keys : ((HASH_ART_NODE16*)node)->keys;
+            void** children = (node->kind == HASH_ART_KIND4) ? ((HASH_ART_NODE4*)node)->children : ((HASH_ART_NODE16*)node)->children;
+            uint16_t pos = 0;
+            while (pos < node->nb_children && keys[pos] != byte) pos++;
+            if (pos == node->nb_children)
+                return;
+            memmove(keys + pos, keys + pos + 1, (size_t)(node->nb_children - pos - 1) * sizeof(uint8_t));
+            memmove(children + pos, children + pos + 1, (size_t)(node->nb_children - pos - 1) * sizeof(void*));
+            node->nb_children--;
+            if (node->kind == HASH_ART_KIND16 && node->nb_children <= 3) {
+                HASH_ART_NODE4* node4 = (HASH_ART_NODE4*)_ht_art_new_node(HASH_ART_KIND4);
+                if (!node4)
+                    return;
+                _ht_art_copy_header(&node4->header, node);
+                memcpy(node4->keys, keys, node->nb_children * sizeof(uint8_t));
+                memcpy(node4->children, children, node->nb_children * sizeof(void*));
+                Free(node);
+                (*ref) = &node4->header;
+            }
+        } break;
+        case HASH_ART_KIND48: {
+            HASH_ART_NODE48* node48 = (HASH_ART_NODE48*)node;
+            if (node48->child_index[byte] == 0)
+                return;
+            node48->children[node48->child_index[byte] - 1] = NULL;
+            node48->child_index[byte] = 0;
+            node->nb_children--;
+            if (node->nb_children <= 12) {
+                HASH_ART_NODE16* node16 = (HASH_ART_NODE16*)_ht_art_new_node(HASH_ART_KIND16);
+                if (!node16)
+                    return;
+                _ht_art_copy_header(&node16->header, node);
+                uint16_t pos = 0;
+                for (size_t it = 0; it < 256; it++) {
+                    if (node48->child_index[it] != 0) {
+                        node16->keys[pos] = (uint8_t)it;
+                        node16->children[pos] = node48->children[node48->child_index[it] - 1];
+                        pos++;
+                    }
+                }
+                Free(node);
+                (*ref) = &node16->header;
+            }
+        } break;
+        default: {
+            HASH_ART_NODE256* node256 = (HASH_ART_NODE256*)node;
+            if (!node256->children[byte])
+                return;
+            node256->children[byte] = NULL;
+            node->nb_children--;
+            if (node->nb_children <= 37) {
+                HASH_ART_NODE48* node48 = (HASH_ART_NODE48*)_ht_art_new_node(HASH_ART_KIND48);
+                if (!node48)
+                    return;
+                _ht_art_copy_header(&node48->header, node);
+                uint8_t slot = 0;
+                for (size_t it = 0; it < 256; it++) {
+                    if (node256->children[it]) {
+                        node48->children[slot] = node256->children[it];
+                        node48->child_index[it] = (uint8_t)(slot + 1);
+                        slot++;
+                    }
+                }
+                Free(node);
+                (*ref) = &node48->header;
+            }
+        } break;
     }
-    if (node_ptr->type == HASH_PTR) {
-        if (node_ptr->destroy_func && node_ptr->data.ptr) {
-            node_ptr->destroy_func(node_ptr->data.ptr);
+} /* _ht_art_remove_child(...) */
+
+/**
+ *@brief get the first leaf below a tree pointer, HASH_TRIE mode. Every leaf below an inner node shares its compressed path.
+ *@param ptr inner node or tagged leaf
+ *@return NULL or the first leaf
+ */
+HASH_NODE* _ht_art_minimum(const void* ptr) {
+    while (ptr) {
+        if (HASH_ART_IS_LEAF(ptr))
+            return HASH_ART_LEAF(ptr);
+        const HASH_ART_NODE* node = (const HASH_ART_NODE*)ptr;
+        if (node->leaf)
+            return node->leaf;
+        size_t byte = 0;
+        ptr = ht_art_next_child(node, &byte);
+    }
+    return NULL;
+} /* _ht_art_minimum(...) */
+
+/**
+ *@brief get the number of compressed path bytes of node matching key from depth, HASH_TRIE mode. The bytes past HASH_ART_MAX_PREFIX are read from a leaf key.
+ *@param table targeted table
+ *@param node inner node
+ *@param key key to compare
+ *@param len length of key
+ *@param depth position in key of the node compressed path
+ *@return the number of matching bytes, node->prefix_len if the whole path matches
+ */
+size_t _ht_art_prefix_mismatch(const HASH_TABLE* table, const HASH_ART_NODE* node, const char* key, size_t len, size_t depth) {
+    size_t it = 0;
+    size_t stored = (node->prefix_len < HASH_ART_MAX_PREFIX) ? node->prefix_len : HASH_ART_MAX_PREFIX;
+    for (; it < stored; it++) {
+        if (depth + it >= len || node->prefix[it] != _ht_art_byte(table, key, depth + it))
+            return it;
+    }
+    if (node->prefix_len > HASH_ART_MAX_PREFIX) {
+        const HASH_NODE* leaf = _ht_art_minimum(node);
+        for (; it < node->prefix_len; it++) {
+            if (depth + it >= len || _ht_art_byte(table, leaf->key, depth + it) != _ht_art_byte(table, key, depth + it))
+                return it;
         }
-        /* No free by default. must be passed as a destroy_func
-           else
-           {
-           Free( node_ptr  -> data . ptr );
-           }
-           */
     }
-    FreeNoLog(node_ptr->key);
-    if (node_ptr->alphabet_length > 0) {
-        for (size_t it = 0; it < node_ptr->alphabet_length; it++) {
-            if (node_ptr->children[it]) {
-                _ht_node_destroy(node_ptr->children[it]);
+    return it;
+} /* _ht_art_prefix_mismatch(...) */
+
+/**
+ *@brief find the leaf of key in the tree, HASH_TRIE mode
+ *@param table targeted table
+ *@param key key to find
+ *@return NULL or the leaf node
+ */
+HASH_NODE* _ht_art_search(const HASH_TABLE* table, const char* key) {
+    size_t len = strlen(key);
+    size_t depth = 0;
+    void* ptr = table->root;
+    while (ptr) {
+        if (HASH_ART_IS_LEAF(ptr)) {
+            HASH_NODE* leaf = HASH_ART_LEAF(ptr);
+            return (_ht_art_key_equal(table, leaf->key, key) == TRUE) ? leaf : NULL;
+        }
+        HASH_ART_NODE* node = (HASH_ART_NODE*)ptr;
+        if (node->prefix_len > 0) {
+            /* optimistic check on the stored bytes, the leaf comparison catches the rest */
+            size_t stored = (node->prefix_len < HASH_ART_MAX_PREFIX) ? node->prefix_len : HASH_ART_MAX_PREFIX;
+            for (size_t it = 0; it < stored; it++) {
+                if (depth + it >= len || node->prefix[it] != _ht_art_byte(table, key, depth + it))
+                    return NULL;
             }
+            depth += node->prefix_len;
+            if (depth > len)
+                return NULL;
         }
-        Free(node_ptr->children);
+        if (depth == len)
+            return (node->leaf && _ht_art_key_equal(table, node->leaf->key, key) == TRUE) ? node->leaf : NULL;
+        void** child = _ht_art_find_child(node, _ht_art_byte(table, key, depth));
+        ptr = child ? (*child) : NULL;
+        depth++;
     }
-    Free(node_ptr);
-} /* _ht_node_destroy */
+    return NULL;
+} /* _ht_art_search(...) */
 
 /**
- *@brief check and return branching index in key if any
- *@param table targeted hash table
- *@param key associated value's key
- *@return index of the divergence or SIZE_MAX on error
- */
-size_t _ht_check_trie_divergence(HASH_TABLE* table, const char* key) {
-    __n_assert(table, return SIZE_MAX);
-    __n_assert(key, return SIZE_MAX);
-    __n_assert(table->root, return SIZE_MAX);
-
-    HASH_NODE* node = table->root;
-
-    size_t last_index = 0;
-    /* `node` is non-null on entry (table->root checked above) and only ever
-     * gets reassigned from `node->children[index]` after that slot was
-     * verified non-null. We still gate the loop on `node` so the static
-     * analyzer narrows `node` to non-null at every dereference inside the
-     * body, older clang static analyzers (the one in Ubuntu's clang-tools
-     * package, used by CI) don't track that constraint through the
-     * children[] reassignment, even though it holds. */
-    for (size_t it = 0; node && key[it] != '\0'; it++) {
-        size_t index = (size_t)key[it] - table->alphabet_offset;
-        if (index >= table->alphabet_length) {
-            n_log(LOG_ERR, "Invalid value %d for charater at position %d of %s, set to 0", index, it, key);
-            index = 0;
-        }
-        HASH_NODE* child = node->children[index];
-        if (child) {
-            /* child check */
-            for (size_t it2 = 0; it2 < table->alphabet_length; it2++) {
-                if (it2 != (unsigned)index && node->children[it2]) {
-                    /* child found, update branch index */
-                    last_index = it + 1;
-                    break;
-                }
+ *@brief set the compressed path of a new inner node from the bytes of key, HASH_TRIE mode
+ *@param table targeted table
+ *@param node inner node
+ *@param key key holding the path
+ *@param depth position of the path in key
+ *@param prefix_len length of the path
+ */
+void _ht_art_set_prefix(const HASH_TABLE* table, HASH_ART_NODE* node, const char* key, size_t depth, size_t prefix_len) {
+    node->prefix_len = (uint32_t)prefix_len;
+    for (size_t it = 0; it < prefix_len && it < HASH_ART_MAX_PREFIX; it++) {
+        node->prefix[it] = _ht_art_byte(table, key, depth + it);
+    }
+} /* _ht_art_set_prefix(...) */
+
+/**
+ *@brief hang a leaf below a new inner node, either as the node leaf or as a child, HASH_TRIE mode
+ *@param table targeted table
+ *@param node new inner node, with a free slot
+ *@param leaf leaf to hang
+ *@param depth depth of the node children
+ *@return TRUE or FALSE
+ */
+int _ht_art_hang_leaf(const HASH_TABLE* table, HASH_ART_NODE** node, HASH_NODE* leaf, size_t depth) {
+    if (leaf->key[depth] == '\0') {
+        (*node)->leaf = leaf;
+        return TRUE;
+    }
+    return _ht_art_add_child(node, _ht_art_byte(table, leaf->key, depth), HASH_ART_TAG_LEAF(leaf));
+} /* _ht_art_hang_leaf(...) */
+
+/**
+ *@brief recursive, return the leaf of key, inserting it if missing, HASH_TRIE mode
+ *@param table targeted table
+ *@param ref address of the tree pointer to insert into
+ *@param key key to insert
+ *@param len length of key
+ *@param depth position in key of ref
+ *@param created set to TRUE if the leaf was inserted
+ *@return NULL or the leaf of key
+ */
+HASH_NODE* _ht_art_insert(HASH_TABLE* table, void** ref, const char* key, size_t len, size_t depth, int* created) {
+    void* ptr = (*ref);
+    if (!ptr) {
+        HASH_NODE* leaf = _ht_art_new_leaf(key);
+        __n_assert(leaf, return NULL);
+        (*ref) = HASH_ART_TAG_LEAF(leaf);
+        (*created) = TRUE;
+        return leaf;
+    }
+
+    if (HASH_ART_IS_LEAF(ptr)) {
+        HASH_NODE* existing = HASH_ART_LEAF(ptr);
+        if (_ht_art_key_equal(table, existing->key, key) == TRUE)
+            return existing;
+        /* lazy expansion: split the leaf on the bytes both keys share */
+        size_t common = 0;
+        while (depth + common < len && existing->key[depth + common] != '\0' && _ht_art_byte(table, existing->key, depth + common) == _ht_art_byte(table, key, depth + common))
+            common++;
+        HASH_ART_NODE* node = _ht_art_new_node(HASH_ART_KIND4);
+        __n_assert(node, return NULL);
+        HASH_NODE* leaf = _ht_art_new_leaf(key);
+        __n_assert(leaf, Free(node); return NULL);
+        _ht_art_set_prefix(table, node, key, depth, common);
+        _ht_art_hang_leaf(table, &node, existing, depth + common);
+        _ht_art_hang_leaf(table, &node, leaf, depth + common);
+        node->max_weight = HASH_ART_WEIGHT(existing);
+        (*ref) = node;
+        (*created) = TRUE;
+        return leaf;
+    }
+
+    HASH_ART_NODE* node = (HASH_ART_NODE*)ptr;
+    if (node->prefix_len > 0) {
+        size_t mismatch = _ht_art_prefix_mismatch(table, node, key, len, depth);
+        if (mismatch < node->prefix_len) {
+            /* split the compressed path where key leaves it */
+            HASH_ART_NODE* parent = _ht_art_new_node(HASH_ART_KIND4);
+            __n_assert(parent, return NULL);
+            HASH_NODE* leaf = _ht_art_new_leaf(key);
+            __n_assert(leaf, Free(parent); return NULL);
+            parent->prefix_len = (uint32_t)mismatch;
+            memcpy(parent->prefix, node->prefix, (mismatch < HASH_ART_MAX_PREFIX) ? mismatch : HASH_ART_MAX_PREFIX);
+            uint8_t node_byte = 0;
+            if (node->prefix_len <= HASH_ART_MAX_PREFIX) {
+                node_byte = node->prefix[mismatch];
+                node->prefix_len -= (uint32_t)(mismatch + 1);
+                memmove(node->prefix, node->prefix + mismatch + 1, node->prefix_len);
+            } else {
+                const HASH_NODE* min_leaf = _ht_art_minimum(node);
+                node_byte = _ht_art_byte(table, min_leaf->key, depth + mismatch);
+                _ht_art_set_prefix(table, node, min_leaf->key, depth + mismatch + 1, node->prefix_len - (mismatch + 1));
             }
-            /* Go to the next child in the sequence */
-            node = child;
+            _ht_art_add_child(&parent, node_byte, node);
+            _ht_art_hang_leaf(table, &parent, leaf, depth + mismatch);
+            parent->max_weight = node->max_weight;
+            (*ref) = parent;
+            (*created) = TRUE;
+            return leaf;
         }
+        depth += node->prefix_len;
     }
-    return last_index;
-} /* _ht_check_trie_divergence(...) */
+
+    if (depth == len) {
+        if (!node->leaf) {
+            node->leaf = _ht_art_new_leaf(key);
+            __n_assert(node->leaf, return NULL);
+            (*created) = TRUE;
+        }
+        return node->leaf;
+    }
+
+    uint8_t byte = _ht_art_byte(table, key, depth);
+    void** child = _ht_art_find_child(node, byte);
+    if (child)
+        return _ht_art_insert(table, child, key, len, depth + 1, created);
+
+    HASH_NODE* leaf = _ht_art_new_leaf(key);
+    __n_assert(leaf, return NULL);
+    if (_ht_art_add_child((HASH_ART_NODE**)ref, byte, HASH_ART_TAG_LEAF(leaf)) == FALSE) {
+        _ht_node_destroy(leaf);
+        return NULL;
+    }
+    (*created) = TRUE;
+    return leaf;
+} /* _ht_art_insert(...) */
 
 /**
- *@brief  find the longest prefix string that is not the current key
- *@param table targeted hash table
- *@param key key to search prefix for
- *@return TRUE or FALSE
+ *@brief replace an inner node left with a single entry by that entry, HASH_TRIE mode
+ *@param ref address of the pointer to the inner node
+ */
+void _ht_art_collapse(void** ref) {
+    HASH_ART_NODE* node = (HASH_ART_NODE*)(*ref);
+    if (node->nb_children == 0) {
+        /* the leaf holds its whole key, it can hang directly from the parent */
+        (*ref) = node->leaf ? HASH_ART_TAG_LEAF(node->leaf) : NULL;
+        Free(node);
+        return;
+    }
+    if (node->nb_children > 1 || node->leaf)
+        return;
+
+    size_t byte = 0;
+    void* child = ht_art_next_child(node, &byte);
+    if (!HASH_ART_IS_LEAF(child)) {
+        /* merge node path, the child byte and the child path */
+        HASH_ART_NODE* child_node = (HASH_ART_NODE*)child;
+        uint8_t prefix[HASH_ART_MAX_PREFIX];
+        size_t stored = 0;
+        for (size_t it = 0; it < node->prefix_len && stored < HASH_ART_MAX_PREFIX; it++) {
+            prefix[stored++] = node->prefix[it];
+        }
+        if (stored < HASH_ART_MAX_PREFIX)
+            prefix[stored++] = (uint8_t)byte;
+        for (size_t it = 0; it < child_node->prefix_len && stored < HASH_ART_MAX_PREFIX; it++) {
+            prefix[stored++] = child_node->prefix[it];
+        }
+        memcpy(child_node->prefix, prefix, stored);
+        child_node->prefix_len += node->prefix_len + 1;
+    }
+    (*ref) = child;
+    Free(node);
+} /* _ht_art_collapse(...) */
+
+/**
+ *@brief recursive, unlink the leaf of key from the tree, HASH_TRIE mode
+ *@param table targeted table
+ *@param ref address of the tree pointer to remove from
+ *@param key key to remove
+ *@param len length of key
+ *@param depth position in key of ref
+ *@return NULL or the unlinked leaf
+ */
+HASH_NODE* _ht_art_delete(HASH_TABLE* table, void** ref, const char* key, size_t len, size_t depth) {
+    HASH_ART_NODE* node = (HASH_ART_NODE*)(*ref);
+    int is_root = (node == table->root) ? TRUE : FALSE;
+    if (node->prefix_len > 0) {
+        if (_ht_art_prefix_mismatch(table, node, key, len, depth) != node->prefix_len)
+            return NULL;
+        depth += node->prefix_len;
+    }
+
+    HASH_NODE* removed = NULL;
+    if (depth == len) {
+        if (!node->leaf || _ht_art_key_equal(table, node->leaf->key, key) == FALSE)
+            return NULL;
+        removed = node->leaf;
+        node->leaf = NULL;
+    } else {
+        uint8_t byte = _ht_art_byte(table, key, depth);
+        void** child = _ht_art_find_child(node, byte);
+        if (!child)
+            return NULL;
+        if (HASH_ART_IS_LEAF(*child)) {
+            if (_ht_art_key_equal(table, HASH_ART_LEAF(*child)->key, key) == FALSE)
+                return NULL;
+            removed = HASH_ART_LEAF(*child);
+            _ht_art_remove_child((HASH_ART_NODE**)ref, byte);
+        } else {
+            removed = _ht_art_delete(table, child, key, len, depth + 1);
+            if (removed && HASH_ART_WEIGHT(removed) >= node->max_weight)
+                _ht_art_refresh_weight(node);
+            return removed;
+        }
+    }
+    if (HASH_ART_WEIGHT(removed) >= ((HASH_ART_NODE*)(*ref))->max_weight)
+        _ht_art_refresh_weight((HASH_ART_NODE*)(*ref));
+    /* the root stays in place, even empty */
+    if (is_root == FALSE)
+        _ht_art_collapse(ref);
+    return removed;
+} /* _ht_art_delete(...) */
+
+/**
+ *@brief recursive, free a tree and all its leaves, HASH_TRIE mode
+ *@param ptr inner node or tagged leaf
+ */
+void _ht_art_destroy(void* ptr) {
+    if (!ptr)
+        return;
+    if (HASH_ART_IS_LEAF(ptr)) {
+        _ht_node_destroy(HASH_ART_LEAF(ptr));
+        return;
+    }
+    HASH_ART_NODE* node = (HASH_ART_NODE*)ptr;
+    if (node->leaf)
+        _ht_node_destroy(node->leaf);
+    size_t byte = 0;
+    for (void* child = ht_art_next_child(node, &byte); child; byte++, child = ht_art_next_child(node, &byte)) {
+        _ht_art_destroy(child);
+    }
+    Free(node);
+} /* _ht_art_destroy(...) */
+
+/**
+ *@brief return the leaf of key, inserting a HASH_UNKNOWN leaf if missing, HASH_TRIE mode
+ *@param table targeted table
+ *@param key key of the leaf
+ *@param created set to TRUE if the leaf was inserted, else FALSE
+ *@return NULL or the leaf
  */
-char* _ht_find_longest_prefix_trie(HASH_TABLE* table, const char* key) {
+HASH_NODE* _ht_art_get_or_insert(HASH_TABLE* table, const char* key, int* created) {
     __n_assert(table, return NULL);
+    __n_assert(table->root, return NULL);
     __n_assert(key, return NULL);
 
-    size_t len = strlen(key);
-
-    /* start with full key and backtrack to search for divergences */
-    char* longest_prefix = NULL;
-    Malloc(longest_prefix, char, len + 1);
-    __n_assert(longest_prefix, return NULL);
-    memcpy(longest_prefix, key, len);
-    /* memcpy does not add a null terminator; set it explicitly */
-    longest_prefix[len] = '\0';
+    (*created) = FALSE;
+    _ht_art_check_key(table, key, LOG_ERR);
 
-    /* check branching from the root */
-    size_t branch_index = _ht_check_trie_divergence(table, longest_prefix);
-    if (branch_index > 0 && branch_index != SIZE_MAX) {
-        /* truncate to the branch point */
-        longest_prefix[branch_index - 1] = '\0';
-        /* shrink the allocation; Realloc preserves the original pointer on
-           failure so the caller still gets a valid terminated string */
-        Realloc(longest_prefix, char, branch_index + 1);
+    void* root = table->root;
+    HASH_NODE* leaf = _ht_art_insert(table, &root, key, strlen(key), 0, created);
+    table->root = (HASH_ART_NODE*)root;
+    if (!leaf)
+        return NULL;
+    if ((*created) == TRUE) {
+        table->nb_keys++;
+    } else if (strcmp(leaf->key, key) != 0) {
+        /* same path with other out of alphabet characters: the last key put wins */
+        char* new_key = strdup(key);
+        __n_assert(new_key, return NULL);
+        Free(leaf->key);
+        leaf->key = new_key;
     }
-    return longest_prefix;
-} /* _ht_find_longest_prefix_trie(...) */
+    return leaf;
+} /* _ht_art_get_or_insert(...) */
 
 /**
  *@brief Remove a key from a trie table and destroy the node
@@ -221,55 +814,12 @@ int _ht_remove_trie(HASH_TABLE* table, const char* key) {
     __n_assert(table->root, return FALSE);
     __n_assert(key, return FALSE);
 
-    /* stop if matching node not a leaf node */
-    if (!_ht_is_leaf_node_trie(table, key)) {
-        return FALSE;
-    }
-
-    HASH_NODE* node = table->root;
-    /* find the longest prefix string that is not the current key */
-    char* longest_prefix = _ht_find_longest_prefix_trie(table, key);
-    if (!longest_prefix) {
-        n_log(LOG_ERR, "couldn't find longest prefix for key %s", key);
+    void* root = table->root;
+    HASH_NODE* leaf = _ht_art_delete(table, &root, key, strlen(key), 0);
+    table->root = (HASH_ART_NODE*)root;
+    if (!leaf)
         return FALSE;
-    }
-    if (longest_prefix[0] == '\0') {
-        Free(longest_prefix);
-        return FALSE;
-    }
-    /* keep track of position in the tree */
-    size_t it = 0;
-    for (it = 0; longest_prefix[it] != '\0'; it++) {
-        size_t index = (size_t)longest_prefix[it] - table->alphabet_offset;
-        if (index >= table->alphabet_length) {
-            n_log(LOG_ERR, "Invalid value %d for charater at position %d of %s, set to 0", index, it, key);
-            index = 0;
-        }
-        if (node->children[index] != NULL) {
-            /* common prefix, keep moving */
-            node = node->children[index];
-        } else {
-            /* not found */
-            Free(longest_prefix);
-            return FALSE;
-        }
-    }
-    /* deepest common node between the two strings */
-    /* deleting the sequence corresponding to key */
-    for (; key[it] != '\0'; it++) {
-        size_t index = (size_t)key[it] - table->alphabet_offset;
-        if (index >= table->alphabet_length) {
-            n_log(LOG_ERR, "Invalid value %d for charater at position %d of %s, set to 0", index, it, key);
-            index = 0;
-        }
-        if (node->children[index]) {
-            /* delete the remaining sequence */
-            HASH_NODE* node_to_kill = node->children[index];
-            node->children[index] = NULL;
-            _ht_node_destroy(node_to_kill);
-        }
-    }
-    Free(longest_prefix);
+    _ht_node_destroy(leaf);
 
     table->nb_keys--;
 
@@ -287,47 +837,14 @@ int _ht_put_int_trie(HASH_TABLE* table, const char* key, HASH_INT_TYPE value) {
     __n_assert(table, return FALSE);
     __n_assert(key, return FALSE);
 
-    HASH_NODE* node = table->root;
-
-    for (size_t it = 0; key[it] != '\0'; it++) {
-        size_t index = (size_t)key[it] - table->alphabet_offset;
-        if (index >= table->alphabet_length) {
-            n_log(LOG_ERR, "Invalid value %d for charater at position %d of %s, set to 0", index, it, key);
-            index = 0;
-        }
-        /* n_log( LOG_DEBUG , "index:%d" , index ); */
-        if (node->children[index] == NULL) {
-            /* create a node */
-            node->children[index] = _ht_new_node_trie(table, key[it]);
-            __n_assert(node->children[index], return FALSE);
-        } else {
-            /* nothing to do since node is existing */
-        }
-        /* go down a level, to the child referenced by index */
-        node = node->children[index];
-    }
-    /* At the end of the key, mark this node as the leaf node */
-    int was_leaf = node->is_leaf;
-    if (was_leaf) {
-        FreeNoLog(node->key);
-    }
-    node->is_leaf = 1;
-    /* Put the key */
-    node->key = strdup(key);
-    if (!node->key) {
-        n_log(LOG_ERR, "strdup failure for key [%s]", key);
-        table->nb_keys++; /* compensate for upcoming remove */
-        _ht_remove_trie(table, key);
+    int created = FALSE;
+    HASH_NODE* node = _ht_art_get_or_insert(table, key, &created);
+    if (!node)
         return FALSE;
-    }
-    /* Put the value */
+    _ht_node_destroy_value(node);
     node->data.ival = value;
     node->type = HASH_INT;
 
-    if (!was_leaf) {
-        table->nb_keys++;
-    }
-
     return TRUE;
 } /* _ht_put_int_trie(...) */
 
@@ -342,46 +859,14 @@ int _ht_put_double_trie(HASH_TABLE* table, const char* key, double value) {
     __n_assert(table, return FALSE);
     __n_assert(key, return FALSE);
 
-    HASH_NODE* node = table->root;
-
-    for (size_t it = 0; key[it] != '\0'; it++) {
-        size_t index = (size_t)key[it] - table->alphabet_offset;
-        if (index >= table->alphabet_length) {
-            n_log(LOG_ERR, "Invalid value %d for charater at position %d of %s, set to 0", index, it, key);
-            index = 0;
-        }
-        if (node->children[index] == NULL) {
-            /* create a node */
-            node->children[index] = _ht_new_node_trie(table, key[it]);
-            __n_assert(node->children[index], return FALSE);
-        } else {
-            /* nothing to do since node is existing */
-        }
-        /* go down a level, to the child referenced by index */
-        node = node->children[index];
-    }
-    /* At the end of the key, mark this node as the leaf node */
-    int was_leaf = node->is_leaf;
-    if (was_leaf) {
-        FreeNoLog(node->key);
-    }
-    node->is_leaf = 1;
-    /* Put the key */
-    node->key = strdup(key);
-    if (!node->key) {
-        n_log(LOG_ERR, "strdup failure for key [%s]", key);
-        table->nb_keys++; /* compensate for upcoming remove */
-        _ht_remove_trie(table, key);
+    int created = FALSE;
+    HASH_NODE* node = _ht_art_get_or_insert(table, key, &created);
+    if (!node)
         return FALSE;
-    }
-    /* Put the value */
+    _ht_node_destroy_value(node);
     node->data.fval = value;
     node->type = HASH_DOUBLE;
 
-    if (!was_leaf) {
-        table->nb_keys++;
-    }
-
     return TRUE;
 } /* _ht_put_double_trie(...) */
 
@@ -397,58 +882,23 @@ int _ht_put_string_trie(HASH_TABLE* table, const char* key, char* string) {
     __n_assert(table, return FALSE);
     __n_assert(key, return FALSE);
 
-    HASH_NODE* node = table->root;
-
-    for (size_t it = 0; key[it] != '\0'; it++) {
-        size_t index = (size_t)key[it] - table->alphabet_offset;
-        if (index >= table->alphabet_length) {
-            n_log(LOG_ERR, "Invalid value %d for charater at position %d of %s, set to 0", index, it, key);
-            index = 0;
-        }
-        if (node->children[index] == NULL) {
-            /* create a node */
-            node->children[index] = _ht_new_node_trie(table, key[it]);
-            __n_assert(node->children[index], return FALSE);
-        } else {
-            /* nothing to do since node is existing */
-        }
-        /* go down a level, to the child referenced by index */
-        node = node->children[index];
-    }
-    /* At the end of the key, mark this node as the leaf node */
-    int was_leaf = node->is_leaf;
-    if (was_leaf) {
-        FreeNoLog(node->key);
-        FreeNoLog(node->data.string);
-    }
-    node->is_leaf = 1;
-    /* Put the key */
-    node->key = strdup(key);
-    if (!node->key) {
-        n_log(LOG_ERR, "strdup failure for key [%s]", key);
-        table->nb_keys++; /* compensate for upcoming remove */
-        _ht_remove_trie(table, key);
-        return FALSE;
-    }
-    /* Put the value */
+    char* new_str = NULL;
     if (string) {
-        node->data.string = strdup(string);
-        if (!node->data.string) {
+        new_str = strdup(string);
+        if (!new_str) {
             n_log(LOG_ERR, "strdup failure for value at key [%s]", key);
-            Free(node->key);
-            table->nb_keys++; /* compensate for upcoming remove */
-            _ht_remove_trie(table, key);
             return FALSE;
         }
-    } else {
-        node->data.string = NULL;
     }
-
-    node->type = HASH_STRING;
-
-    if (!was_leaf) {
-        table->nb_keys++;
+    int created = FALSE;
+    HASH_NODE* node = _ht_art_get_or_insert(table, key, &created);
+    if (!node) {
+        FreeNoLog(new_str);
+        return FALSE;
     }
+    _ht_node_destroy_value(node);
+    node->data.string = new_str;
+    node->type = HASH_STRING;
 
     return TRUE;
 } /* _ht_put_string_trie(...) */
@@ -464,47 +914,15 @@ int _ht_put_string_ptr_trie(HASH_TABLE* table, const char* key, char* string) {
     __n_assert(table, return FALSE);
     __n_assert(key, return FALSE);
 
-    HASH_NODE* node = table->root;
-
-    for (size_t it = 0; key[it] != '\0'; it++) {
-        size_t index = (size_t)key[it] - table->alphabet_offset;
-        if (index >= table->alphabet_length) {
-            n_log(LOG_ERR, "Invalid value %d for charater at position %d of %s, set to 0", index, it, key);
-            index = 0;
-        }
-        if (node->children[index] == NULL) {
-            /* create a node */
-            node->children[index] = _ht_new_node_trie(table, key[it]);
-            __n_assert(node->children[index], return FALSE);
-        } else {
-            /* nothing to do since node is existing */
-        }
-        /* go down a level, to the child referenced by index */
-        node = node->children[index];
-    }
-    /* At the end of the key, mark this node as the leaf node */
-    int was_leaf = node->is_leaf;
-    if (was_leaf) {
-        FreeNoLog(node->key);
-        FreeNoLog(node->data.string);
-    }
-    node->is_leaf = 1;
-    /* Put the key - string pointer variant does not strdup the value, but key must be duplicated */
-    node->key = strdup(key);
-    if (!node->key) {
-        n_log(LOG_ERR, "strdup failure for key [%s]", key);
-        table->nb_keys++; /* compensate for upcoming remove */
-        _ht_remove_trie(table, key);
+    int created = FALSE;
+    HASH_NODE* node = _ht_art_get_or_insert(table, key, &created);
+    if (!node)
         return FALSE;
-    }
+    _ht_node_destroy_value(node);
     /* Put the string pointer (not a copy - caller owns the string) */
     node->data.string = string;
     node->type = HASH_STRING;
 
-    if (!was_leaf) {
-        table->nb_keys++;
-    }
-
     return TRUE;
 } /* _ht_put_string_ptr_trie(...) */
 
@@ -521,52 +939,17 @@ int _ht_put_ptr_trie(HASH_TABLE* table, const char* key, void* ptr, void (*destr
     __n_assert(table, return FALSE);
     __n_assert(key, return FALSE);
 
-    HASH_NODE* node = table->root;
-
-    for (size_t it = 0; key[it] != '\0'; it++) {
-        size_t index = (size_t)key[it] - table->alphabet_offset;
-        if (index >= table->alphabet_length) {
-            n_log(LOG_ERR, "Invalid value %zu for character at position %zu of %s, set to 0", index, it, key);
-            index = 0;
-        }
-        if (node->children[index] == NULL) {
-            /* create a node */
-            node->children[index] = _ht_new_node_trie(table, key[it]);
-            __n_assert(node->children[index], return FALSE);
-        } else {
-            /* nothing to do since node is existing */
-        }
-        /* go down a level, to the child referenced by index */
-        node = node->children[index];
-    }
-    /* At the end of the key, mark this node as the leaf node */
-    int was_leaf = node->is_leaf;
-    if (was_leaf) {
-        FreeNoLog(node->key);
-        /* free old value if a destructor was set */
-        if (node->destroy_func && node->data.ptr) {
-            node->destroy_func(node->data.ptr);
-        }
-    }
-    node->is_leaf = 1;
-    /* Put the key */
-    node->key = strdup(key);
-    if (!node->key) {
-        n_log(LOG_ERR, "strdup failure for key [%s]", key);
-        table->nb_keys++; /* compensate for upcoming remove */
-        _ht_remove_trie(table, key);
+    int created = FALSE;
+    HASH_NODE* node = _ht_art_get_or_insert(table, key, &created);
+    if (!node)
         return FALSE;
-    }
-    /* Put the value */
+    /* free old value if a destructor was set */
+    _ht_node_destroy_value(node);
     node->data.ptr = ptr;
     node->destroy_func = destructor;
     node->duplicate_func = duplicator;
     node->type = HASH_PTR;
 
-    if (!was_leaf) {
-        table->nb_keys++;
-    }
-
     return TRUE;
 } /* _ht_put_ptr_trie(...) */
 
@@ -580,26 +963,11 @@ HASH_NODE* _ht_get_node_trie(HASH_TABLE* table, const char* key) {
     __n_assert(table, return NULL);
     __n_assert(key, return NULL);
 
-    HASH_NODE* node = NULL;
-
-    if (key[0] != '\0') {
-        node = table->root;
-        for (size_t it = 0; key[it] != '\0'; it++) {
-            size_t index = (size_t)key[it] - table->alphabet_offset;
-            if (index >= table->alphabet_length) {
-                n_log(LOG_DEBUG, "Invalid value %d for charater at index %d of %s, set to 0", index, it, key);
-                return NULL;
-            }
-            if (node->children[index] == NULL) {
-                /* not found */
-                return NULL;
-            }
-            node = node->children[index];
-        }
-    } else {
-        node = NULL;
-    }
-    return node;
+    if (key[0] == '\0')
+        return NULL;
+    if (_ht_art_check_key(table, key, LOG_DEBUG) == FALSE)
+        return NULL;
+    return _ht_art_search(table, key);
 } /* _ht_get_node_trie(...) */
 
 /**
@@ -722,9 +1090,10 @@ int _ht_get_ptr_trie(HASH_TABLE* table, const char* key, void** val) {
 int _empty_ht_trie(HASH_TABLE* table) {
     __n_assert(table, return FALSE);
 
-    _ht_node_destroy(table->root);
+    _ht_art_destroy(table->root);
 
-    table->root = _ht_new_node_trie(table, '\0');
+    table->root = _ht_art_new_node(HASH_ART_KIND4);
+    __n_assert(table->root, return FALSE);
 
     table->nb_keys = 0;
     return TRUE;
@@ -738,7 +1107,7 @@ int _empty_ht_trie(HASH_TABLE* table) {
 int _destroy_ht_trie(HASH_TABLE** table) {
     __n_assert(table && (*table), n_log(LOG_ERR, "Can't destroy table: already NULL"); return FALSE);
 
-    _ht_node_destroy((*table)->root);
+    _ht_art_destroy((*table)->root);
 
     Free((*table));
 
@@ -747,14 +1116,14 @@ int _destroy_ht_trie(HASH_TABLE** table) {
 
 /**
  *@brief Recursive function to print trie tree's keys and values
- *@param table targeted hash table
- *@param node current node
+ *@param ptr current inner node or tagged leaf
  */
-void _ht_print_trie_helper(HASH_TABLE* table, HASH_NODE* node) {
-    if (!node)
+void _ht_print_trie_helper(const void* ptr) {
+    if (!ptr)
         return;
 
-    if (node->is_leaf) {
+    if (HASH_ART_IS_LEAF(ptr)) {
+        const HASH_NODE* node = HASH_ART_LEAF(ptr);
         printf("key: %s, val: ", node->key);
         switch (node->type) {
             case HASH_INT:
@@ -774,9 +1143,14 @@ void _ht_print_trie_helper(HASH_TABLE* table, HASH_NODE* node) {
                 break;
         }
         printf("\n");
+        return;
     }
-    for (size_t it = 0; it < table->alphabet_length; it++) {
-        _ht_print_trie_helper(table, node->children[it]);
+    const HASH_ART_NODE* node = (const HASH_ART_NODE*)ptr;
+    if (node->leaf)
+        _ht_print_trie_helper(HASH_ART_TAG_LEAF(node->leaf));
+    size_t byte = 0;
+    for (void* child = ht_art_next_child(node, &byte); child; byte++, child = ht_art_next_child(node, &byte)) {
+        _ht_print_trie_helper(child);
     }
 } /* _ht_print_trie_helper(...) */
 
@@ -788,9 +1162,7 @@ void _ht_print_trie(HASH_TABLE* table) {
     __n_assert(table, return);
     __n_assert(table->root, return);
 
-    HASH_NODE* node = table->root;
-
-    _ht_print_trie_helper(table, node);
+    _ht_print_trie_helper(table->root);
 
     return;
 } /* _ht_print_trie(...) */
@@ -798,22 +1170,28 @@ void _ht_print_trie(HASH_TABLE* table) {
 /**
  *@brief Recursive function to search tree's keys and apply a matching func to put results in the list
  *@param results targeted and initialized LIST in which the matching nodes will be put
- *@param node targeted starting trie node
+ *@param ptr current inner node or tagged leaf
  *@param node_is_matching pointer to a matching function to use
  */
-void _ht_search_trie_helper(LIST* results, HASH_NODE* node, int (*node_is_matching)(HASH_NODE* node)) {
-    if (!node)
+void _ht_search_trie_helper(LIST* results, const void* ptr, int (*node_is_matching)(HASH_NODE* node)) {
+    if (!ptr)
         return;
 
-    if (node->is_leaf) {
+    if (HASH_ART_IS_LEAF(ptr)) {
+        HASH_NODE* node = HASH_ART_LEAF(ptr);
         if (node_is_matching(node) == TRUE) {
             list_push(results, strdup(node->key), &free);
         }
+        return;
     }
-    for (size_t it = 0; it < node->alphabet_length; it++) {
-        _ht_search_trie_helper(results, node->children[it], node_is_matching);
+    const HASH_ART_NODE* node = (const HASH_ART_NODE*)ptr;
+    if (node->leaf)
+        _ht_search_trie_helper(results, HASH_ART_TAG_LEAF(node->leaf), node_is_matching);
+    size_t byte = 0;
+    for (void* child = ht_art_next_child(node, &byte); child; byte++, child = ht_art_next_child(node, &byte)) {
+        _ht_search_trie_helper(results, child, node_is_matching);
     }
-}
+} /* _ht_search_trie_helper(...) */
 
 /**
  *@brief Search tree's keys and apply a matching func to put results in the list
@@ -836,28 +1214,118 @@ LIST* _ht_search_trie(HASH_TABLE* table, int (*node_is_matching)(HASH_NODE* node
 } /* _ht_search_trie(...) */
 
 /**
- *@brief recursive, helper for ht_get_completion_list, get the list of leaf starting from node
- *@param node starting node
- *@param results initialized LIST * for the matching NODES
+ *@brief recursive, helper for ht_get_completion_list, push the keys of the leaves below ptr in key order
+ *@param ptr starting inner node or tagged leaf
+ *@param results initialized LIST * for the matching keys, filled up to its nb_max_items
+ *@param skip_key key already in results, not pushed again
  *@return TRUE or FALSE
  */
-int _ht_depth_first_search(HASH_NODE* node, LIST* results) {
+int _ht_art_collect_keys(const void* ptr, LIST* results, const char* skip_key) {
     __n_assert(results, return FALSE);
 
-    if (!node)
+    if (!ptr)
         return FALSE;
 
-    for (size_t it = 0; it < node->alphabet_length; it++) {
-        _ht_depth_first_search(node->children[it], results);
-    }
-    if (node->is_leaf) {
-        if (results->nb_items < results->nb_max_items) {
+    if (HASH_ART_IS_LEAF(ptr)) {
+        const HASH_NODE* node = HASH_ART_LEAF(ptr);
+        if (results->nb_items < results->nb_max_items && strcmp(node->key, skip_key) != 0) {
             return list_push(results, strdup(node->key), &free);
         }
         return TRUE;
     }
+    const HASH_ART_NODE* node = (const HASH_ART_NODE*)ptr;
+    if (node->leaf)
+        _ht_art_collect_keys(HASH_ART_TAG_LEAF(node->leaf), results, skip_key);
+    size_t byte = 0;
+    for (void* child = ht_art_next_child(node, &byte); child && results->nb_items < results->nb_max_items; byte++, child = ht_art_next_child(node, &byte)) {
+        _ht_art_collect_keys(child, results, skip_key);
+    }
     return TRUE;
-} /* _ht_depth_first_search(...) */
+} /* _ht_art_collect_keys(...) */
+
+/**
+ *@brief find the subtree holding every key starting with keybud, HASH_TRIE mode
+ *@param table targeted table
+ *@param keybud starting characters of the keys
+ *@param start_depth if not NULL, set to the key position of the returned subtree
+ *@return NULL or the subtree, an inner node or a tagged leaf
+ */
+void* _ht_art_find_prefix(const HASH_TABLE* table, const char* keybud, size_t* start_depth) {
+    size_t len = strlen(keybud);
+    size_t depth = 0;
+    void* ptr = table->root;
+    while (ptr && depth < len) {
+        if (HASH_ART_IS_LEAF(ptr)) {
+            const HASH_NODE* leaf = HASH_ART_LEAF(ptr);
+            for (size_t it = depth; it < len; it++) {
+                if (leaf->key[it] == '\0' || _ht_art_byte(table, leaf->key, it) != _ht_art_byte(table, keybud, it))
+                    return NULL;
+            }
+            break;
+        }
+        const HASH_ART_NODE* node = (const HASH_ART_NODE*)ptr;
+        if (node->prefix_len > 0) {
+            size_t mismatch = _ht_art_prefix_mismatch(table, node, keybud, len, depth);
+            if (mismatch < node->prefix_len) {
+                /* keybud may end inside the compressed path */
+                if (depth + mismatch != len)
+                    return NULL;
+                break;
+            }
+            if (depth + node->prefix_len == len)
+                break;
+            depth += node->prefix_len;
+        }
+        void** child = _ht_art_find_child((HASH_ART_NODE*)node, _ht_art_byte(table, keybud, depth));
+        ptr = child ? (*child) : NULL;
+        depth++;
+    }
+    if (ptr && start_depth)
+        (*start_depth) = depth;
+    return ptr;
+} /* _ht_art_find_prefix(...) */
+
+/**
+ *@brief compare the compressed path of node with key from depth, in tree order, HASH_TRIE mode
+ *@param table targeted table
+ *@param node inner node
+ *@param key key to compare
+ *@param len length of key
+ *@param depth position in key of the node compressed path
+ *@return negative if all the keys below node come before key, positive if they all come after it, 0 if key follows the whole path
+ */
+int _ht_art_compare_path(const HASH_TABLE* table, const HASH_ART_NODE* node, const char* key, size_t len, size_t depth) {
+    const HASH_NODE* leaf = (node->prefix_len > HASH_ART_MAX_PREFIX) ? _ht_art_minimum(node) : NULL;
+    for (size_t it = 0; it < node->prefix_len; it++) {
+        /* a key ending inside the path is a prefix of every key below node */
+        if (depth + it >= len)
+            return 1;
+        uint8_t path_byte = (it < HASH_ART_MAX_PREFIX) ? node->prefix[it] : _ht_art_byte(table, leaf->key, depth + it);
+        uint8_t key_byte = _ht_art_byte(table, key, depth + it);
+        if (path_byte != key_byte)
+            return (path_byte < key_byte) ? -1 : 1;
+    }
+    return 0;
+} /* _ht_art_compare_path(...) */
+
+/**
+ *@brief compare two keys from depth, in tree order, HASH_TRIE mode
+ *@param table targeted table
+ *@param key1 first key
+ *@param key2 second key
+ *@param depth position from which the keys may differ
+ *@return negative, 0 or positive if key1 comes before, at the same place or after key2
+ */
+int _ht_art_compare_keys(const HASH_TABLE* table, const char* key1, const char* key2, size_t depth) {
+    for (size_t it = depth;; it++) {
+        if (key1[it] == '\0' || key2[it] == '\0')
+            return (key1[it] == '\0') ? ((key2[it] == '\0') ? 0 : -1) : 1;
+        uint8_t byte1 = _ht_art_byte(table, key1, it);
+        uint8_t byte2 = _ht_art_byte(table, key2, it);
+        if (byte1 != byte2)
+            return (byte1 < byte2) ? -1 : 1;
+    }
+} /* _ht_art_compare_keys(...) */
 
 /* Classic hash table */
 /*! 64 bit rotate left */
@@ -1339,6 +1807,435 @@ char* ht_node_type(const HASH_NODE* node) {
     }
 } /* ht_node_type(...) */
 
+/**
+ *@brief return the rehash_table bucket at index, creating its list on first use, HASH_CLASSIC mode
+ *@param table targeted table, with an incremental resize in progress
+ *@param index bucket index in rehash_table
+ *@return NULL or the bucket list
+ */
+LIST* _ht_rehash_bucket(HASH_TABLE* table, size_t index) {
+    if (!table->rehash_table[index]) {
+        table->rehash_table[index] = new_generic_list(MAX_LIST_ITEMS);
+        __n_assert(table->rehash_table[index], n_log(LOG_ERR, "Can't allocate table -> rehash_table[ %zu ] !", index); return NULL);
+    }
+    return table->rehash_table[index];
+} /* _ht_rehash_bucket(...) */
+
+/**
+ *@brief migrate the hash_table bucket at rehash_index into rehash_table, HASH_CLASSIC mode. The rehash_table lists matching that bucket are created on the way, so that all of them exist once the last bucket has been migrated, and the emptied list is destroyed.
+ *@param table targeted table, with an incremental resize in progress
+ *@return TRUE or FALSE if a list could not be allocated, in which case the bucket is left in place
+ */
+int _ht_rehash_migrate_bucket(HASH_TABLE* table) {
+    size_t fill_ratio = table->rehash_size / table->size + 1;
+    size_t fill_start = table->rehash_index * fill_ratio;
+    for (size_t it = fill_start; it < fill_start + fill_ratio && it < table->rehash_size; it++) {
+        if (!_ht_rehash_bucket(table, it))
+            return FALSE;
+    }
+
+    LIST* bucket = table->hash_table[table->rehash_index];
+    while (bucket->start) {
+        const HASH_NODE* hash_node = (const HASH_NODE*)bucket->start->ptr;
+        LIST* target = _ht_rehash_bucket(table, hash_node->hash_value % table->rehash_size);
+        if (!target)
+            return FALSE;
+        LIST_NODE* node = list_node_shift(bucket);
+        node->next = node->prev = NULL;
+        list_node_push(target, node);
+    }
+    list_destroy(&table->hash_table[table->rehash_index]);
+    table->rehash_index++;
+    return TRUE;
+} /* _ht_rehash_migrate_bucket(...) */
+
+/**
+ *@brief swap rehash_table in place of the fully migrated hash_table, whose lists were all destroyed by the migration, HASH_CLASSIC mode
+ *@param table targeted table, with every bucket migrated
+ *@return TRUE or FALSE
+ */
+int _ht_rehash_complete(HASH_TABLE* table) {
+    for (size_t it = 0; it < table->rehash_size; it++) {
+        if (!_ht_rehash_bucket(table, it))
+            return FALSE;
+    }
+    Free(table->hash_table);
+    table->hash_table = table->rehash_table;
+    table->size = table->rehash_size;
+    table->rehash_table = NULL;
+    table->rehash_size = 0;
+    table->rehash_index = 0;
+    return TRUE;
+} /* _ht_rehash_complete(...) */
+
+/**
+ *@brief migrate up to nb_buckets non empty buckets of an in progress incremental resize, skipping at most HASH_REHASH_EMPTY_VISITS empty buckets for each of them. Nothing is migrated while cursors are open on the table.
+ *@param table targeted table
+ *@param nb_buckets maximum number of non empty buckets to migrate, SIZE_MAX to finish the resize
+ *@return TRUE if a resize is still in progress after the step, FALSE if the table is not resizing anymore or on error
+ */
+int ht_rehash_step(HASH_TABLE* table, size_t nb_buckets) {
+    __n_assert(table, return FALSE);
+    if (table->mode != HASH_CLASSIC || !table->rehash_table)
+        return FALSE;
+    /* the cursors hold list nodes of the buckets */
+    if (table->nb_cursors > 0)
+        return TRUE;
+
+    size_t empty_visits = (nb_buckets > SIZE_MAX / HASH_REHASH_EMPTY_VISITS) ? SIZE_MAX : nb_buckets * HASH_REHASH_EMPTY_VISITS;
+    while (nb_buckets > 0 && table->rehash_index < table->size) {
+        if (table->hash_table[table->rehash_index]->start) {
+            nb_buckets--;
+        } else if (empty_visits > 0) {
+            empty_visits--;
+        } else {
+            break;
+        }
+        if (_ht_rehash_migrate_bucket(table) == FALSE)
+            return TRUE;
+    }
+    if (table->rehash_index >= table->size && _ht_rehash_complete(table) == TRUE)
+        return FALSE;
+    return TRUE;
+} /* ht_rehash_step(...) */
+
+/**
+ *@brief start an incremental resize of a HASH_CLASSIC table. Only the bucket pointers are allocated here, the buckets are then migrated a few at a time by each following put or remove, or by ht_rehash_step. A resize already in progress is finished first. Fails while cursors are open on the table.
+ *@param table targeted table
+ *@param size new number of buckets
+ *@return TRUE or FALSE
+ */
+int ht_resize_incremental(HASH_TABLE* table, size_t size) {
+    __n_assert(table, return FALSE);
+    if (table->mode != HASH_CLASSIC) {
+        n_log(LOG_ERR, "unsupported table->mode (%d instead or %d)", table->mode, HASH_CLASSIC);
+        return FALSE;
+    }
+    if (size < 1) {
+        n_log(LOG_ERR, "invalid size %zu for hash table %p", size, (void*)table);
+        return FALSE;
+    }
+    if (table->nb_cursors > 0) {
+        n_log(LOG_ERR, "can't resize hash table %p while %zu cursors are open on it", (void*)table, table->nb_cursors);
+        return FALSE;
+    }
+    if (table->rehash_table && ht_rehash_step(table, SIZE_MAX) == TRUE) {
+        n_log(LOG_ERR, "could not finish the previous resize of hash table %p", (void*)table);
+        return FALSE;
+    }
+    if (size == table->size)
+        return TRUE;
+
+    Malloc(table->rehash_table, LIST*, size);
+    __n_assert(table->rehash_table, n_log(LOG_ERR, "Can't allocate table -> rehash_table with size %zu !", size); return FALSE);
+    table->rehash_size = size;
+    table->rehash_index = 0;
+    return TRUE;
+} /* ht_resize_incremental(...) */
+
+/**
+ *@brief set the load factor triggering an incremental grow of a HASH_CLASSIC table, off by default. When a put brings nb_keys over size * max_load_percent / 100, the bucket array is resized to the next prime after twice its size. A growing table moves its nodes between buckets, so ht_foreach and HT_FOREACH loops must not put in it.
+ *@param table targeted table
+ *@param max_load_percent load factor in percent, 0 to disable the auto grow
+ *@return TRUE or FALSE
+ */
+int ht_set_max_load(HASH_TABLE* table, size_t max_load_percent) {
+    __n_assert(table, return FALSE);
+    if (table->mode != HASH_CLASSIC) {
+        n_log(LOG_ERR, "unsupported table->mode (%d instead or %d)", table->mode, HASH_CLASSIC);
+        return FALSE;
+    }
+    table->max_load_percent = max_load_percent;
+    return TRUE;
+} /* ht_set_max_load(...) */
+
+/**
+ *@brief find the list node holding a key, looking in both bucket arrays during an incremental resize, HASH_CLASSIC mode
+ *@param table targeted table
+ *@param key key to find, or NULL to match on hash_value only
+ *@param hash_value hash value of the key
+ *@param bucket if not NULL, set to the list holding the found node
+ *@return The found list node, or NULL
+ */
+LIST_NODE* _ht_find_list_node(HASH_TABLE* table, const char* key, HASH_VALUE hash_value, LIST** bucket) {
+    LIST* lists[2] = {NULL, NULL};
+    size_t index = hash_value % table->size;
+    /* buckets below rehash_index have already been moved to rehash_table */
+    if (!table->rehash_table || index >= table->rehash_index)
+        lists[0] = table->hash_table[index];
+    if (table->rehash_table)
+        lists[1] = table->rehash_table[hash_value % table->rehash_size];
+
+    for (int it = 0; it < 2; it++) {
+        if (!lists[it])
+            continue;
+        list_foreach(list_node, lists[it]) {
+            const HASH_NODE* node_ptr = (const HASH_NODE*)list_node->ptr;
+            if (hash_value == node_ptr->hash_value && (!key || (node_ptr->key && !strcmp(key, node_ptr->key)))) {
+                if (bucket)
+                    (*bucket) = lists[it];
+                return list_node;
+            }
+        }
+    }
+    return NULL;
+} /* _ht_find_list_node(...) */
+
+/**
+ *@brief allocate a memory block and put it in front of a block list, HT_ARENA tables
+ *@param blocks address of the block list head
+ *@param size capacity of the block
+ *@param unit size in bytes of one unit of capacity
+ *@return NULL or the new block
+ */
+HASH_ARENA_BLOCK* _ht_arena_new_block(HASH_ARENA_BLOCK** blocks, size_t size, size_t unit) {
+    char* raw = NULL;
+    Malloc(raw, char, sizeof(HASH_ARENA_BLOCK) + size * unit);
+    __n_assert(raw, n_log(LOG_ERR, "Could not allocate an arena block of %zu bytes", size * unit); return NULL);
+    HASH_ARENA_BLOCK* block = (HASH_ARENA_BLOCK*)raw;
+    block->size = size;
+    block->used = 0;
+    block->next = (*blocks);
+    (*blocks) = block;
+    return block;
+} /* _ht_arena_new_block(...) */
+
+/**
+ *@brief get a zeroed entry from the free entries or the current block, HT_ARENA tables
+ *@param table targeted table
+ *@return NULL or the entry
+ */
+HASH_ARENA_ENTRY* _ht_arena_new_entry(HASH_TABLE* table) {
+    HASH_ARENA_ENTRY* entry = table->arena_free;
+    if (entry) {
+        table->arena_free = (HASH_ARENA_ENTRY*)entry->list_node.next;
+        memset(entry, 0, sizeof(HASH_ARENA_ENTRY));
+        return entry;
+    }
+    HASH_ARENA_BLOCK* block = table->arena_entries;
+    if (!block || block->used == block->size) {
+        block = _ht_arena_new_block(&table->arena_entries, HASH_ARENA_BLOCK_SIZE / sizeof(HASH_ARENA_ENTRY), sizeof(HASH_ARENA_ENTRY));
+        __n_assert(block, return NULL);
+    }
+    /* blocks are zeroed by Malloc and recycled ones by _ht_arena_release */
+    entry = (HASH_ARENA_ENTRY*)(block + 1) + block->used;
+    block->used++;
+    return entry;
+} /* _ht_arena_new_entry(...) */
+
+/**
+ *@brief copy a key into the key blocks, HT_ARENA tables
+ *@param table targeted table
+ *@param key key to copy
+ *@param len length of key
+ *@return NULL or the copy
+ */
+char* _ht_arena_strdup(HASH_TABLE* table, const char* key, size_t len) {
+    HASH_ARENA_BLOCK* block = table->arena_keys;
+    if (!block || block->size - block->used < len + 1) {
+        if (len + 1 > HASH_ARENA_BLOCK_SIZE / 4) {
+            /* big key: give it its own block, behind the current one so the current one keeps filling */
+            HASH_ARENA_BLOCK* big_block = NULL;
+            HASH_ARENA_BLOCK** head = block ? &block->next : &table->arena_keys;
+            big_block = _ht_arena_new_block(head, len + 1, 1);
+            __n_assert(big_block, return NULL);
+            big_block->used = len + 1;
+            memcpy(big_block + 1, key, len + 1);
+            return (char*)(big_block + 1);
+        }
+        block = _ht_arena_new_block(&table->arena_keys, HASH_ARENA_BLOCK_SIZE, 1);
+        __n_assert(block, return NULL);
+    }
+    char* copy = (char*)(block + 1) + block->used;
+    memcpy(copy, key, len + 1);
+    block->used += len + 1;
+    return copy;
+} /* _ht_arena_strdup(...) */
+
+/**
+ *@brief return the interned copy of key, copying it in the key blocks on first use, HT_ARENA tables. Interned keys stay until the table is emptied, so a key removed and put again is not copied twice.
+ *@param table targeted table
+ *@param key key to intern
+ *@param hash_value hash value of key
+ *@return NULL or the interned key
+ */
+char* _ht_arena_intern(HASH_TABLE* table, const char* key, HASH_VALUE hash_value) {
+    if ((table->arena_nb_interned + 1) * 2 > table->arena_interned_size) {
+        size_t new_size = table->arena_interned_size > 0 ? table->arena_interned_size * 2 : 64;
+        char** new_interned = NULL;
+        Malloc(new_interned, char*, new_size);
+        __n_assert(new_interned, return NULL);
+        for (size_t it = 0; it < table->arena_interned_size; it++) {
+            char* interned = table->arena_interned[it];
+            if (!interned)
+                continue;
+            HASH_VALUE interned_hash[2] = {0, 0};
+            MurmurHash(interned, strlen(interned), table->seed, &interned_hash);
+            size_t index = interned_hash[0] & (new_size - 1);
+            while (new_interned[index]) index = (index + 1) & (new_size - 1);
+            new_interned[index] = interned;
+        }
+        FreeNoLog(table->arena_interned);
+        table->arena_interned = new_interned;
+        table->arena_interned_size = new_size;
+    }
+    size_t mask = table->arena_interned_size - 1;
+    size_t index = hash_value & mask;
+    while (table->arena_interned[index]) {
+        if (strcmp(table->arena_interned[index], key) == 0)
+            return table->arena_interned[index];
+        index = (index + 1) & mask;
+    }
+    char* interned = _ht_arena_strdup(table, key, strlen(key));
+    __n_assert(interned, return NULL);
+    table->arena_interned[index] = interned;
+    table->arena_nb_interned++;
+    return interned;
+} /* _ht_arena_intern(...) */
+
+/**
+ *@brief release the values of all the entries and empty the buckets, then keep the current blocks for reuse or free them all, HT_ARENA tables
+ *@param table targeted table
+ *@param keep_blocks TRUE to keep the current block of each list (empty_ht), FALSE to free everything (destroy_ht)
+ */
+void _ht_arena_release(HASH_TABLE* table, int keep_blocks) {
+    for (HASH_ARENA_BLOCK* block = table->arena_entries; block; block = block->next) {
+        HASH_ARENA_ENTRY* entries = (HASH_ARENA_ENTRY*)(block + 1);
+        for (size_t it = 0; it < block->used; it++) {
+            if (entries[it].node.type != HASH_UNKNOWN)
+                _ht_node_destroy_value(&entries[it].node);
+        }
+    }
+    /* the list nodes live in the blocks, just forget them */
+    for (size_t it = 0; it < table->size; it++) {
+        if (table->hash_table[it]) {
+            table->hash_table[it]->start = table->hash_table[it]->end = NULL;
+            table->hash_table[it]->nb_items = 0;
+        }
+    }
+    for (size_t it = 0; it < table->rehash_size; it++) {
+        if (table->rehash_table[it]) {
+            table->rehash_table[it]->start = table->rehash_table[it]->end = NULL;
+            table->rehash_table[it]->nb_items = 0;
+        }
+    }
+
+    HASH_ARENA_BLOCK** lists[2] = {&table->arena_entries, &table->arena_keys};
+    for (size_t list = 0; list < 2; list++) {
+        HASH_ARENA_BLOCK* block = (*lists[list]);
+        if (keep_blocks == TRUE && block) {
+            if (list == 0)
+                memset(block + 1, 0, block->used * sizeof(HASH_ARENA_ENTRY));
+            block->used = 0;
+            HASH_ARENA_BLOCK* next = block->next;
+            block->next = NULL;
+            block = next;
+        } else {
+            (*lists[list]) = NULL;
+        }
+        while (block) {
+            HASH_ARENA_BLOCK* next = block->next;
+            Free(block);
+            block = next;
+        }
+    }
+    table->arena_free = NULL;
+    if (keep_blocks == TRUE && table->arena_interned) {
+        memset(table->arena_interned, 0, table->arena_interned_size * sizeof(char*));
+    } else {
+        FreeNoLog(table->arena_interned);
+        table->arena_interned_size = 0;
+    }
+    table->arena_nb_interned = 0;
+} /* _ht_arena_release(...) */
+
+/**
+ *@brief allocate a zeroed HASH_NODE, from the table blocks for HT_ARENA tables, HASH_CLASSIC mode
+ *@param table targeted table
+ *@return NULL or the node
+ */
+HASH_NODE* _ht_node_alloc(HASH_TABLE* table) {
+    if (table->flags & HT_ARENA) {
+        HASH_ARENA_ENTRY* entry = _ht_arena_new_entry(table);
+        __n_assert(entry, return NULL);
+        return &entry->node;
+    }
+    HASH_NODE* node = NULL;
+    Malloc(node, HASH_NODE, 1);
+    return node;
+} /* _ht_node_alloc(...) */
+
+/**
+ *@brief release a HASH_NODE and its value. HT_ARENA tables keep the interned key and recycle the entry, HASH_CLASSIC mode
+ *@param table targeted table
+ *@param node node to release, already unlinked from its bucket
+ */
+void _ht_node_release(HASH_TABLE* table, HASH_NODE* node) {
+    if (table->flags & HT_ARENA) {
+        HASH_ARENA_ENTRY* entry = (HASH_ARENA_ENTRY*)((char*)node - offsetof(HASH_ARENA_ENTRY, node));
+        _ht_node_destroy_value(node);
+        node->type = HASH_UNKNOWN;
+        entry->list_node.next = (LIST_NODE*)table->arena_free;
+        table->arena_free = entry;
+        return;
+    }
+    _ht_node_destroy(node);
+} /* _ht_node_release(...) */
+
+/**
+ *@brief unlink a list node from its bucket and return its HASH_NODE, HASH_CLASSIC mode. The list node is freed unless it lives in the table blocks.
+ *@param table targeted table
+ *@param bucket bucket holding list_node
+ *@param list_node list node to unlink
+ *@return the unlinked HASH_NODE
+ */
+HASH_NODE* _ht_unlink_node(const HASH_TABLE* table, LIST* bucket, LIST_NODE* list_node) {
+    if (!(table->flags & HT_ARENA))
+        return remove_list_node(bucket, list_node, HASH_NODE);
+
+    if (list_node->prev)
+        list_node->prev->next = list_node->next;
+    else
+        bucket->start = list_node->next;
+    if (list_node->next)
+        list_node->next->prev = list_node->prev;
+    else
+        bucket->end = list_node->prev;
+    bucket->nb_items--;
+    return (HASH_NODE*)list_node->ptr;
+} /* _ht_unlink_node(...) */
+
+/**
+ *@brief push a new node in a HASH_CLASSIC table, advancing any incremental resize by HASH_REHASH_STEP_BUCKETS and starting one if the load factor goes over max_load_percent while no cursor is open
+ *@param table targeted table
+ *@param node_ptr new node, with a key not already in the table
+ *@return TRUE or FALSE
+ */
+int _ht_push_node(HASH_TABLE* table, HASH_NODE* node_ptr) {
+    LIST* bucket = NULL;
+    if (table->rehash_table && ht_rehash_step(table, HASH_REHASH_STEP_BUCKETS) == TRUE) {
+        bucket = _ht_rehash_bucket(table, node_ptr->hash_value % table->rehash_size);
+        __n_assert(bucket, return FALSE);
+    } else {
+        bucket = table->hash_table[node_ptr->hash_value % table->size];
+    }
+    if (table->flags & HT_ARENA) {
+        LIST_NODE* list_node = &((HASH_ARENA_ENTRY*)((char*)node_ptr - offsetof(HASH_ARENA_ENTRY, node)))->list_node;
+        list_node->ptr = node_ptr;
+        list_node->destroy_func = NULL;
+        if (list_node_push(bucket, list_node) == FALSE)
+            return FALSE;
+    } else if (list_push(bucket, node_ptr, &_ht_node_destroy) == FALSE) {
+        return FALSE;
+    }
+    table->nb_keys++;
+
+    if (!table->rehash_table && table->nb_cursors == 0 && table->max_load_percent > 0 && table->nb_keys * 100 > table->size * table->max_load_percent) {
+        ht_resize_incremental(table, next_prime(table->size * 2));
+    }
+    return TRUE;
+} /* _ht_push_node(...) */
+
 /**
  *@brief return the associated key's node inside the hash_table
  *@param table targeted table
@@ -1347,7 +2244,6 @@ char* ht_node_type(const HASH_NODE* node) {
  */
 HASH_NODE* _ht_get_node(HASH_TABLE* table, const char* key) {
     HASH_VALUE hash_value[2] = {0, 0};
-    size_t index = 0;
 
     __n_assert(table, return NULL);
     __n_assert(key, return NULL);
@@ -1356,68 +2252,78 @@ HASH_NODE* _ht_get_node(HASH_TABLE* table, const char* key) {
         return NULL;
 
     MurmurHash(key, strlen(key), table->seed, &hash_value);
-    index = (hash_value[0]) % (table->size);
 
-    if (!table->hash_table[index]->start)
+    LIST_NODE* list_node = _ht_find_list_node(table, key, hash_value[0], NULL);
+    if (!list_node)
         return NULL;
-
-    list_foreach(list_node, table->hash_table[index]) {
-        HASH_NODE* node_ptr = (HASH_NODE*)list_node->ptr;
-        if (!strcmp(key, node_ptr->key)) {
-            return node_ptr;
-        }
-    }
-    return NULL;
+    return (HASH_NODE*)list_node->ptr;
 } /* _ht_get_node() */
 
 /**
- *@brief node creation, HASH_CLASSIC mode
+ *@brief node creation from a key already hashed, HASH_CLASSIC mode
  *@param table targeted table
  *@param key key of new node
+ *@param hash_value hash value of key
  *@return NULL or a new HASH_NODE *
  */
-HASH_NODE* _ht_new_node(const HASH_TABLE* table, const char* key) {
+HASH_NODE* _ht_new_node_hashed(HASH_TABLE* table, const char* key, HASH_VALUE hash_value) {
     __n_assert(table, return NULL);
     __n_assert(key, return NULL);
 
     HASH_NODE* new_hash_node = NULL;
 
-    HASH_VALUE hash_value[2] = {0, 0};
-
-    if (strlen(key) == 0)
+    if (key[0] == '\0')
         return NULL;
 
-    MurmurHash(key, strlen(key), table->seed, &hash_value);
-
-    Malloc(new_hash_node, HASH_NODE, 1);
+    new_hash_node = _ht_node_alloc(table);
     __n_assert(new_hash_node, n_log(LOG_ERR, "Could not allocate new_hash_node"); return NULL);
-    new_hash_node->key = strdup(key);
+    if (table->flags & HT_ARENA) {
+        new_hash_node->key = _ht_arena_intern(table, key, hash_value);
+        __n_assert(new_hash_node->key, n_log(LOG_ERR, "Could not intern new_hash_node->key"); _ht_node_release(table, new_hash_node); return NULL);
+    } else {
+        new_hash_node->key = strdup(key);
+        __n_assert(new_hash_node->key, n_log(LOG_ERR, "Could not allocate new_hash_node->key"); Free(new_hash_node); return NULL);
+    }
     new_hash_node->key_id = '\0';
-    __n_assert(new_hash_node->key, n_log(LOG_ERR, "Could not allocate new_hash_node->key"); Free(new_hash_node); return NULL);
-    new_hash_node->hash_value = hash_value[0];
+    new_hash_node->hash_value = hash_value;
     new_hash_node->data.ptr = NULL;
     new_hash_node->destroy_func = NULL;
-    new_hash_node->children = NULL;
     new_hash_node->is_leaf = 0;
-    new_hash_node->need_rehash = 0;
-    new_hash_node->alphabet_length = 0;
 
     return new_hash_node;
-} /* _ht_new_node */
+} /* _ht_new_node_hashed */
 
 /**
  *@brief node creation, HASH_CLASSIC mode
  *@param table targeted table
  *@param key key of new node
- *@param value int value of key
  *@return NULL or a new HASH_NODE *
  */
-HASH_NODE* _ht_new_int_node(HASH_TABLE* table, const char* key, HASH_INT_TYPE value) {
+HASH_NODE* _ht_new_node(HASH_TABLE* table, const char* key) {
     __n_assert(table, return NULL);
     __n_assert(key, return NULL);
 
-    HASH_NODE* new_hash_node = NULL;
-    new_hash_node = _ht_new_node(table, key);
+    if (key[0] == '\0')
+        return NULL;
+
+    HASH_VALUE hash_value[2] = {0, 0};
+    MurmurHash(key, strlen(key), table->seed, &hash_value);
+    return _ht_new_node_hashed(table, key, hash_value[0]);
+} /* _ht_new_node */
+
+/**
+ *@brief node creation, HASH_CLASSIC mode
+ *@param table targeted table
+ *@param key key of new node
+ *@param value int value of key
+ *@return NULL or a new HASH_NODE *
+ */
+HASH_NODE* _ht_new_int_node(HASH_TABLE* table, const char* key, HASH_INT_TYPE value) {
+    __n_assert(table, return NULL);
+    __n_assert(key, return NULL);
+
+    HASH_NODE* new_hash_node = NULL;
+    new_hash_node = _ht_new_node(table, key);
     if (new_hash_node) {
         new_hash_node->data.ival = value;
         new_hash_node->type = HASH_INT;
@@ -1547,11 +2453,7 @@ int _ht_put_int(HASH_TABLE* table, const char* key, HASH_INT_TYPE value) {
     int retcode = FALSE;
     node_ptr = _ht_new_int_node(table, key, value);
     if (node_ptr) {
-        size_t index = (node_ptr->hash_value) % (table->size);
-        retcode = list_push(table->hash_table[index], node_ptr, &_ht_node_destroy);
-        if (retcode == TRUE) {
-            table->nb_keys++;
-        }
+        retcode = _ht_push_node(table, node_ptr);
     }
     return retcode;
 } /*_ht_put_int() */
@@ -1581,31 +2483,26 @@ int _ht_put_double(HASH_TABLE* table, const char* key, double value) {
     int retcode = FALSE;
     node_ptr = _ht_new_double_node(table, key, value);
     if (node_ptr) {
-        HASH_VALUE index = (node_ptr->hash_value) % (table->size);
-        retcode = list_push(table->hash_table[index], node_ptr, &_ht_node_destroy);
-        if (retcode == TRUE) {
-            table->nb_keys++;
-        }
+        retcode = _ht_push_node(table, node_ptr);
     }
     return retcode;
 } /*_ht_put_double()*/
 
 /**
- *@brief put a pointer value with given key in the targeted hash table
+ *@brief put a pointer value with a key already hashed in the targeted hash table, HASH_CLASSIC mode
  *@param table targeted hash table
  *@param key Associated value's key
+ *@param hash_value hash value of key
  *@param ptr pointer value to put
  *@param destructor Pointer to the ptr type destructor function. Leave to NULL if there isn't
  *@param duplicator Pointer to the ptr type duplicator function. Leave to NULL if there isn't
  *@return TRUE or FALSE
  */
-int _ht_put_ptr(HASH_TABLE* table, const char* key, void* ptr, void (*destructor)(void* ptr), void* (*duplicator)(void* ptr)) {
+int _ht_put_ptr_hashed(HASH_TABLE* table, const char* key, HASH_VALUE hash_value, void* ptr, void (*destructor)(void* ptr), void* (*duplicator)(void* ptr)) {
     HASH_NODE* node_ptr = NULL;
+    LIST_NODE* list_node = (key[0] != '\0') ? _ht_find_list_node(table, key, hash_value, NULL) : NULL;
 
-    __n_assert(table, return FALSE);
-    __n_assert(key, return FALSE);
-
-    if ((node_ptr = _ht_get_node(table, key))) {
+    if (list_node && (node_ptr = (HASH_NODE*)list_node->ptr)) {
         /* let's check the key isn't already assigned with another data type */
         if (node_ptr->type == HASH_PTR) {
             /* free the old value if a destructor is set */
@@ -1623,15 +2520,35 @@ int _ht_put_ptr(HASH_TABLE* table, const char* key, void* ptr, void (*destructor
     }
 
     int retcode = FALSE;
-    node_ptr = _ht_new_ptr_node(table, key, ptr, destructor, duplicator);
+    node_ptr = _ht_new_node_hashed(table, key, hash_value);
     if (node_ptr) {
-        HASH_VALUE index = (node_ptr->hash_value) % (table->size);
-        retcode = list_push(table->hash_table[index], node_ptr, &_ht_node_destroy);
-        if (retcode == TRUE) {
-            table->nb_keys++;
-        }
+        node_ptr->data.ptr = ptr;
+        node_ptr->destroy_func = destructor;
+        node_ptr->duplicate_func = duplicator;
+        node_ptr->type = HASH_PTR;
+        retcode = _ht_push_node(table, node_ptr);
+    } else {
+        n_log(LOG_ERR, "Could not get a new node in table %p with key %s", table, key);
     }
     return retcode;
+} /* _ht_put_ptr_hashed() */
+
+/**
+ *@brief put a pointer value with given key in the targeted hash table
+ *@param table targeted hash table
+ *@param key Associated value's key
+ *@param ptr pointer value to put
+ *@param destructor Pointer to the ptr type destructor function. Leave to NULL if there isn't
+ *@param duplicator Pointer to the ptr type duplicator function. Leave to NULL if there isn't
+ *@return TRUE or FALSE
+ */
+int _ht_put_ptr(HASH_TABLE* table, const char* key, void* ptr, void (*destructor)(void* ptr), void* (*duplicator)(void* ptr)) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    HASH_VALUE hash_value[2] = {0, 0};
+    MurmurHash(key, strlen(key), table->seed, &hash_value);
+    return _ht_put_ptr_hashed(table, key, hash_value[0], ptr, destructor, duplicator);
 } /* _ht_put_ptr() */
 
 /**
@@ -1669,11 +2586,7 @@ int _ht_put_string(HASH_TABLE* table, const char* key, char* string) {
     int retcode = FALSE;
     node_ptr = _ht_new_string_node(table, key, string);
     if (node_ptr) {
-        HASH_VALUE index = (node_ptr->hash_value) % (table->size);
-        retcode = list_push(table->hash_table[index], node_ptr, &_ht_node_destroy);
-        if (retcode == TRUE) {
-            table->nb_keys++;
-        }
+        retcode = _ht_push_node(table, node_ptr);
     }
     return retcode;
 } /*_ht_put_string */
@@ -1705,11 +2618,7 @@ int _ht_put_string_ptr(HASH_TABLE* table, const char* key, char* string) {
     int retcode = FALSE;
     node_ptr = _ht_new_string_ptr_node(table, key, string);
     if (node_ptr) {
-        HASH_VALUE index = (node_ptr->hash_value) % (table->size);
-        retcode = list_push(table->hash_table[index], node_ptr, &_ht_node_destroy);
-        if (retcode == TRUE) {
-            table->nb_keys++;
-        }
+        retcode = _ht_push_node(table, node_ptr);
     }
     return retcode;
 } /*_ht_put_string_ptr */
@@ -1833,9 +2742,8 @@ int _ht_get_string(HASH_TABLE* table, const char* key, char** val) {
  */
 int _ht_remove(HASH_TABLE* table, const char* key) {
     HASH_VALUE hash_value[2] = {0, 0};
-    size_t index = 0;
 
-    HASH_NODE* node_ptr = NULL;
+    LIST* bucket = NULL;
     LIST_NODE* node_to_kill = NULL;
 
     __n_assert(table, return FALSE);
@@ -1843,120 +2751,1904 @@ int _ht_remove(HASH_TABLE* table, const char* key) {
     if (strlen(key) == 0)
         return FALSE;
 
+    ht_rehash_step(table, HASH_REHASH_STEP_BUCKETS);
+
     MurmurHash(key, strlen(key), table->seed, &hash_value);
-    index = (hash_value[0]) % (table->size);
 
-    if (!table->hash_table[index]->start) {
+    if (table->nb_keys == 0) {
         n_log(LOG_ERR, "Can't remove key[\"%s\"], table is empty", key);
         return FALSE;
     }
 
-    list_foreach(list_node, table->hash_table[index]) {
-        node_ptr = (HASH_NODE*)list_node->ptr;
-        /* if we found the same */
-        if (!strcmp(key, node_ptr->key)) {
-            node_to_kill = list_node;
-            break;
-        }
-    }
+    node_to_kill = _ht_find_list_node(table, key, hash_value[0], &bucket);
     if (node_to_kill) {
-        node_ptr = remove_list_node(table->hash_table[index], node_to_kill, HASH_NODE);
-        _ht_node_destroy(node_ptr);
+        HASH_NODE* node_ptr = _ht_unlink_node(table, bucket, node_to_kill);
+        _ht_node_release(table, node_ptr);
 
         table->nb_keys--;
 
-        return TRUE;
+        return TRUE;
+    }
+    n_log(LOG_ERR, "Can't delete key[\"%s\"]: inexisting key", key);
+    return FALSE;
+} /* ht_remove() */
+
+/**
+ *@brief Empty a hash table (CLASSIC mode)
+ *@param table targeted hash table
+ *@return TRUE or FALSE.
+ */
+int _empty_ht(HASH_TABLE* table) {
+    __n_assert(table, return FALSE);
+
+    if (table->flags & HT_ARENA) {
+        _ht_arena_release(table, TRUE);
+        table->nb_keys = 0;
+        return TRUE;
+    }
+
+    HASH_VALUE index = 0;
+    for (index = 0; index < table->size; index++) {
+        while (table->hash_table[index] && table->hash_table[index]->start) {
+            HASH_NODE* hash_node = remove_list_node(table->hash_table[index], table->hash_table[index]->start, HASH_NODE);
+            _ht_node_destroy(hash_node);
+        }
+    }
+    for (index = 0; index < table->rehash_size; index++) {
+        while (table->rehash_table[index] && table->rehash_table[index]->start) {
+            HASH_NODE* hash_node = remove_list_node(table->rehash_table[index], table->rehash_table[index]->start, HASH_NODE);
+            _ht_node_destroy(hash_node);
+        }
+    }
+    table->nb_keys = 0;
+    return TRUE;
+} /* empty_ht */
+
+/**
+ *@brief Free and set the table to NULL
+ *@param table targeted hash table
+ *@return TRUE or FALSE.
+ */
+int _destroy_ht(HASH_TABLE** table) {
+    __n_assert(table && (*table), n_log(LOG_ERR, "Can't destroy table: already NULL"); return FALSE);
+
+    if ((*table)->flags & HT_ARENA)
+        _ht_arena_release((*table), FALSE);
+
+    if ((*table)->hash_table) {
+        // empty_ht( (*table) );
+
+        HASH_VALUE it = 0;
+        for (it = 0; it < (*table)->size; it++) {
+            if ((*table)->hash_table[it])
+                list_destroy(&(*table)->hash_table[it]);
+        }
+        Free((*table)->hash_table);
+    }
+    if ((*table)->rehash_table) {
+        for (size_t it = 0; it < (*table)->rehash_size; it++) {
+            if ((*table)->rehash_table[it])
+                list_destroy(&(*table)->rehash_table[it]);
+        }
+        Free((*table)->rehash_table);
+    }
+    Free((*table));
+    return TRUE;
+} /* _destroy_ht */
+
+/**
+ *@brief Generic print func call for classic hash tables
+ *@param table targeted hash table
+ */
+void _ht_print(HASH_TABLE* table) {
+    __n_assert(table, return);
+    __n_assert(table->hash_table, return);
+    // cppcheck-suppress constVariablePointer ; node is generated by ht_foreach macro
+    ht_foreach(node, table) {
+        const HASH_NODE* ht_node = (const HASH_NODE*)node->ptr;
+        printf("key:%s node:%s\n", ht_node->key, ht_node->key);
+    }
+
+    return;
+} /* _ht_print(...) */
+
+/**
+ *@brief Search hash table's keys and apply a matching func to put results in the list
+ *@param table targeted table
+ *@param node_is_matching pointer to a matching function to use
+ *@return NULL or a LIST *list of HASH_NODE *elements
+ */
+LIST* _ht_search(HASH_TABLE* table, int (*node_is_matching)(HASH_NODE* node)) {
+    __n_assert(table, return NULL);
+
+    LIST* results = new_generic_list(MAX_LIST_ITEMS);
+    __n_assert(results, return NULL);
+
+    ht_foreach(node, table) {
+        HASH_NODE* hnode = (HASH_NODE*)node->ptr;
+        if (node_is_matching(hnode) == TRUE) {
+            list_push(results, strdup(hnode->key), &free);
+        }
+    }
+
+    if (results->nb_items < 1)
+        list_destroy(&results);
+
+    return results;
+} /* _ht_search(...) */
+
+/* Open addressing hash table */
+
+/**
+ *@brief compute the hash value of a key, HASH_OPEN mode
+ *@param table targeted table
+ *@param key key to hash
+ *@return the hash value of key
+ */
+HASH_VALUE _ht_open_hash(const HASH_TABLE* table, const char* key) {
+    HASH_VALUE hash_value[2] = {0, 0};
+    MurmurHash(key, strlen(key), table->seed, &hash_value);
+    return hash_value[0];
+} /* _ht_open_hash(...) */
+
+/**
+ *@brief find the slot holding key, HASH_OPEN mode
+ *@param table targeted table
+ *@param key key to search
+ *@param hash_value precomputed hash value of key
+ *@return the slot index or SIZE_MAX if key is not in table
+ */
+size_t _ht_open_find_slot(const HASH_TABLE* table, const char* key, HASH_VALUE hash_value) {
+    size_t mask = table->size - 1;
+    size_t index = hash_value & mask;
+    for (size_t dist = 1; dist <= UINT8_MAX; dist++) {
+        /* Robin Hood invariant: key would have displaced any slot closer to its home */
+        if (table->open_dist[index] < dist)
+            return SIZE_MAX;
+        const HASH_NODE* node_ptr = &table->open_nodes[index];
+        if (node_ptr->hash_value == hash_value && !strcmp(key, node_ptr->key))
+            return index;
+        index = (index + 1) & mask;
+    }
+    return SIZE_MAX;
+} /* _ht_open_find_slot(...) */
+
+int _ht_open_rehash(HASH_TABLE* table, size_t new_size);
+
+/**
+ *@brief move a node inside the table using Robin Hood displacement, HASH_OPEN mode. On failure the node content is released.
+ *@param table targeted table
+ *@param node node to move in, copied by value
+ *@return TRUE or FALSE
+ */
+int _ht_open_place(HASH_TABLE* table, const HASH_NODE* node) {
+    HASH_NODE carried = *node;
+    size_t mask = table->size - 1;
+    size_t index = carried.hash_value & mask;
+    uint8_t dist = 1;
+
+    while (TRUE) {
+        if (table->open_dist[index] == 0) {
+            table->open_nodes[index] = carried;
+            table->open_dist[index] = dist;
+            return TRUE;
+        }
+        if (table->open_dist[index] < dist) {
+            /* take the slot from the richer node and carry it further */
+            HASH_NODE swapped = table->open_nodes[index];
+            uint8_t swapped_dist = table->open_dist[index];
+            table->open_nodes[index] = carried;
+            table->open_dist[index] = dist;
+            carried = swapped;
+            dist = swapped_dist;
+        }
+        if (dist == UINT8_MAX) {
+            /* probe distance no longer fits in a slot byte: grow, then restart from the carried node home */
+            if (_ht_open_rehash(table, table->size * 2) == FALSE) {
+                n_log(LOG_ERR, "could not grow table %p, key[\"%s\"] is lost", table, _str(carried.key));
+                _ht_node_destroy_value(&carried);
+                FreeNoLog(carried.key);
+                table->nb_keys--;
+                return FALSE;
+            }
+            mask = table->size - 1;
+            index = carried.hash_value & mask;
+            dist = 1;
+            continue;
+        }
+        index = (index + 1) & mask;
+        dist++;
+    }
+} /* _ht_open_place(...) */
+
+/**
+ *@brief move all the nodes into a new slot array of new_size slots, HASH_OPEN mode
+ *@param table targeted table
+ *@param new_size new number of slots, must be a power of two
+ *@return TRUE or FALSE
+ */
+int _ht_open_rehash(HASH_TABLE* table, size_t new_size) {
+    __n_assert(table, return FALSE);
+    if (new_size < table->size || (new_size & (new_size - 1)) != 0) {
+        n_log(LOG_ERR, "invalid size %zu for open table %p", new_size, table);
+        return FALSE;
+    }
+
+    HASH_NODE* old_nodes = table->open_nodes;
+    uint8_t* old_dist = table->open_dist;
+    size_t old_size = table->size;
+
+    HASH_NODE* new_nodes = NULL;
+    uint8_t* new_dist = NULL;
+    Malloc(new_nodes, HASH_NODE, new_size);
+    __n_assert(new_nodes, n_log(LOG_ERR, "Can't allocate %zu open slots", new_size); return FALSE);
+    Malloc(new_dist, uint8_t, new_size);
+    __n_assert(new_dist, n_log(LOG_ERR, "Can't allocate %zu open slots", new_size); Free(new_nodes); return FALSE);
+
+    table->open_nodes = new_nodes;
+    table->open_dist = new_dist;
+    table->size = new_size;
+
+    for (size_t it = 0; it < old_size; it++) {
+        if (old_dist[it] != 0) {
+            _ht_open_place(table, &old_nodes[it]);
+        }
+    }
+    Free(old_nodes);
+    Free(old_dist);
+
+    return TRUE;
+} /* _ht_open_rehash(...) */
+
+/**
+ *@brief return the node of a key already hashed, inserting a HASH_UNKNOWN node if missing, HASH_OPEN mode
+ *@param table targeted table
+ *@param key key of the node, not empty
+ *@param hash_value hash value of key
+ *@param created set to TRUE if the node was inserted, else FALSE
+ *@return NULL or the node, valid until the next put or remove in table
+ */
+HASH_NODE* _ht_open_get_or_insert_hashed(HASH_TABLE* table, const char* key, HASH_VALUE hash_value, int* created) {
+    (*created) = FALSE;
+    size_t index = _ht_open_find_slot(table, key, hash_value);
+    if (index != SIZE_MAX)
+        return &table->open_nodes[index];
+
+    if ((table->nb_keys + 1) * 100 > table->size * HASH_OPEN_MAX_LOAD_PERCENT) {
+        if (_ht_open_rehash(table, table->size * 2) == FALSE) {
+            n_log(LOG_ERR, "Could not grow table %p from %zu slots", table, table->size);
+            return NULL;
+        }
+    }
+
+    HASH_NODE new_hash_node;
+    memset(&new_hash_node, 0, sizeof(HASH_NODE));
+    new_hash_node.key = strdup(key);
+    __n_assert(new_hash_node.key, n_log(LOG_ERR, "Could not allocate new_hash_node.key"); return NULL);
+    new_hash_node.hash_value = hash_value;
+    new_hash_node.type = HASH_UNKNOWN;
+
+    table->nb_keys++;
+    if (_ht_open_place(table, &new_hash_node) == FALSE)
+        return NULL;
+
+    /* placement may have grown the table, look the slot up again */
+    index = _ht_open_find_slot(table, key, hash_value);
+    __n_assert(index != SIZE_MAX, return NULL);
+    (*created) = TRUE;
+    return &table->open_nodes[index];
+} /* _ht_open_get_or_insert_hashed(...) */
+
+/**
+ *@brief return the node of key, inserting a HASH_UNKNOWN node if missing, HASH_OPEN mode
+ *@param table targeted table
+ *@param key key of the node
+ *@param created set to TRUE if the node was inserted, else FALSE
+ *@return NULL or the node, valid until the next put or remove in table
+ */
+HASH_NODE* _ht_open_get_or_insert(HASH_TABLE* table, const char* key, int* created) {
+    __n_assert(table, return NULL);
+    __n_assert(key, return NULL);
+
+    (*created) = FALSE;
+    if (key[0] == '\0')
+        return NULL;
+
+    return _ht_open_get_or_insert_hashed(table, key, _ht_open_hash(table, key), created);
+} /* _ht_open_get_or_insert(...) */
+
+/**
+ *@brief return the associated key's node inside the table, HASH_OPEN mode
+ *@param table targeted table
+ *@param key Associated value's key
+ *@return The found node, or NULL. The node is moved by the next put or remove in table.
+ */
+HASH_NODE* _ht_get_node_open(HASH_TABLE* table, const char* key) {
+    __n_assert(table, return NULL);
+    __n_assert(key, return NULL);
+
+    if (key[0] == '\0')
+        return NULL;
+
+    size_t index = _ht_open_find_slot(table, key, _ht_open_hash(table, key));
+    if (index == SIZE_MAX)
+        return NULL;
+    return &table->open_nodes[index];
+} /* _ht_get_node_open(...) */
+
+int _ht_remove_open(HASH_TABLE* table, const char* key);
+
+/**
+ *@brief put an integral value with given key in the targeted hash table [OPEN HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param value integral value to put
+ *@return TRUE or FALSE
+ */
+int _ht_put_int_open(HASH_TABLE* table, const char* key, HASH_INT_TYPE value) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    int created = FALSE;
+    HASH_NODE* node_ptr = _ht_open_get_or_insert(table, key, &created);
+    if (!node_ptr)
+        return FALSE;
+    if (!created && node_ptr->type != HASH_INT) {
+        n_log(LOG_ERR, "Can't add key[\"%s\"] with type HASH_INT, key already exist with type %s", node_ptr->key, ht_node_type(node_ptr));
+        return FALSE; /* key registered with another data type */
+    }
+    node_ptr->data.ival = value;
+    node_ptr->type = HASH_INT;
+    return TRUE;
+} /* _ht_put_int_open(...) */
+
+/**
+ *@brief put a double value with given key in the targeted hash table [OPEN HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param value double value to put
+ *@return TRUE or FALSE
+ */
+int _ht_put_double_open(HASH_TABLE* table, const char* key, double value) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    int created = FALSE;
+    HASH_NODE* node_ptr = _ht_open_get_or_insert(table, key, &created);
+    if (!node_ptr)
+        return FALSE;
+    if (!created && node_ptr->type != HASH_DOUBLE) {
+        n_log(LOG_ERR, "Can't add key[\"%s\"] with type HASH_DOUBLE, key already exist with type %s", node_ptr->key, ht_node_type(node_ptr));
+        return FALSE; /* key registered with another data type */
+    }
+    node_ptr->data.fval = value;
+    node_ptr->type = HASH_DOUBLE;
+    return TRUE;
+} /* _ht_put_double_open(...) */
+
+/**
+ *@brief put a pointer value with a key already hashed in the targeted hash table [OPEN HASH TABLE]
+ *@param table targeted hash table
+ *@param key Associated value's key, not empty
+ *@param hash_value hash value of key
+ *@param ptr pointer value to put
+ *@param destructor Pointer to the ptr type destructor function. Leave to NULL if there isn't
+ *@param duplicator Pointer to the ptr type duplicator function. Leave to NULL if there isn't
+ *@return TRUE or FALSE
+ */
+int _ht_put_ptr_open_hashed(HASH_TABLE* table, const char* key, HASH_VALUE hash_value, void* ptr, void (*destructor)(void* ptr), void* (*duplicator)(void* ptr)) {
+    int created = FALSE;
+    HASH_NODE* node_ptr = _ht_open_get_or_insert_hashed(table, key, hash_value, &created);
+    if (!node_ptr)
+        return FALSE;
+    if (!created) {
+        if (node_ptr->type != HASH_PTR) {
+            n_log(LOG_ERR, "Can't add key[\"%s\"] with type HASH_PTR , key already exist with type %s", node_ptr->key, ht_node_type(node_ptr));
+            return FALSE; /* key registered with another data type */
+        }
+        /* free the old value if a destructor is set */
+        if (node_ptr->destroy_func && node_ptr->data.ptr) {
+            node_ptr->destroy_func(node_ptr->data.ptr);
+        }
+    }
+    node_ptr->data.ptr = ptr;
+    node_ptr->destroy_func = destructor;
+    node_ptr->duplicate_func = duplicator;
+    node_ptr->type = HASH_PTR;
+    return TRUE;
+} /* _ht_put_ptr_open_hashed(...) */
+
+/**
+ *@brief put a pointer value with given key in the targeted hash table [OPEN HASH TABLE]
+ *@param table targeted hash table
+ *@param key Associated value's key
+ *@param ptr pointer value to put
+ *@param destructor Pointer to the ptr type destructor function. Leave to NULL if there isn't
+ *@param duplicator Pointer to the ptr type duplicator function. Leave to NULL if there isn't
+ *@return TRUE or FALSE
+ */
+int _ht_put_ptr_open(HASH_TABLE* table, const char* key, void* ptr, void (*destructor)(void* ptr), void* (*duplicator)(void* ptr)) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    if (key[0] == '\0')
+        return FALSE;
+    return _ht_put_ptr_open_hashed(table, key, _ht_open_hash(table, key), ptr, destructor, duplicator);
+} /* _ht_put_ptr_open(...) */
+
+/**
+ *@brief put a null terminated char *string with given key in the targeted hash table (copy of string) [OPEN HASH TABLE]
+ *@param table targeted hash table
+ *@param key Associated value's key
+ *@param string string value to put (will be strdup'ed)
+ *@return TRUE or FALSE
+ */
+int _ht_put_string_open(HASH_TABLE* table, const char* key, char* string) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    int created = FALSE;
+    HASH_NODE* node_ptr = _ht_open_get_or_insert(table, key, &created);
+    if (!node_ptr)
+        return FALSE;
+    if (!created && node_ptr->type != HASH_STRING) {
+        n_log(LOG_ERR, "Can't add key[\"%s\"] with type HASH_STRING , key already exist with type %s", node_ptr->key, ht_node_type(node_ptr));
+        return FALSE; /* key registered with another data type */
+    }
+    char* new_str = NULL;
+    if (string) {
+        new_str = strdup(string);
+        if (!new_str) {
+            n_log(LOG_ERR, "could not strdup char *string at %p, didn't overwrite %s", string, key);
+            if (created)
+                _ht_remove_open(table, key);
+            return FALSE;
+        }
+    }
+    if (!created) {
+        FreeNoLog(node_ptr->data.string);
+    }
+    node_ptr->data.string = new_str;
+    node_ptr->type = HASH_STRING;
+    return TRUE;
+} /* _ht_put_string_open(...) */
+
+/**
+ *@brief put a null terminated char *string with given key in the targeted hash table (pointer) [OPEN HASH TABLE]
+ *@param table targeted hash table
+ *@param key Associated value's key
+ *@param string The string to put
+ *@return TRUE or FALSE
+ */
+int _ht_put_string_ptr_open(HASH_TABLE* table, const char* key, char* string) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    int created = FALSE;
+    HASH_NODE* node_ptr = _ht_open_get_or_insert(table, key, &created);
+    if (!node_ptr)
+        return FALSE;
+    if (!created) {
+        if (node_ptr->type != HASH_STRING) {
+            n_log(LOG_ERR, "Can't add key[\"%s\"] with type HASH_STRING , key already exist with type %s", node_ptr->key, ht_node_type(node_ptr));
+            return FALSE; /* key registered with another data type */
+        }
+        FreeNoLog(node_ptr->data.string);
+    }
+    node_ptr->data.string = string;
+    node_ptr->type = HASH_STRING;
+    return TRUE;
+} /* _ht_put_string_ptr_open(...) */
+
+/**
+ *@brief Retrieve an integral value in the hash table, at the given key. Leave val untouched if key is not found. [OPEN HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to a destination integer
+ *@return TRUE or FALSE.
+ */
+int _ht_get_int_open(HASH_TABLE* table, const char* key, HASH_INT_TYPE* val) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    const HASH_NODE* node = _ht_get_node_open(table, key);
+    if (!node)
+        return FALSE;
+
+    if (node->type != HASH_INT) {
+        n_log(LOG_ERR, "Can't get key[\"%s\"] of type HASH_INT, key is type %s", key, ht_node_type(node));
+        return FALSE;
+    }
+    (*val) = node->data.ival;
+    return TRUE;
+} /* _ht_get_int_open(...) */
+
+/**
+ *@brief Retrieve a double value in the hash table, at the given key. Leave val untouched if key is not found. [OPEN HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to a destination double
+ *@return TRUE or FALSE.
+ */
+int _ht_get_double_open(HASH_TABLE* table, const char* key, double* val) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    const HASH_NODE* node = _ht_get_node_open(table, key);
+    if (!node)
+        return FALSE;
+
+    if (node->type != HASH_DOUBLE) {
+        n_log(LOG_ERR, "Can't get key[\"%s\"] of type HASH_DOUBLE, key is type %s", key, ht_node_type(node));
+        return FALSE;
+    }
+    (*val) = node->data.fval;
+    return TRUE;
+} /* _ht_get_double_open(...) */
+
+/**
+ *@brief Retrieve a pointer value in the hash table, at the given key. Leave val untouched if key is not found. [OPEN HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to an empty pointer store
+ *@return TRUE or FALSE.
+ */
+int _ht_get_ptr_open(HASH_TABLE* table, const char* key, void** val) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    const HASH_NODE* node = _ht_get_node_open(table, key);
+    if (!node)
+        return FALSE;
+
+    if (node->type != HASH_PTR) {
+        n_log(LOG_ERR, "Can't get key[\"%s\"] of type HASH_PTR, key is type %s", key, ht_node_type(node));
+        return FALSE;
+    }
+    (*val) = node->data.ptr;
+    return TRUE;
+} /* _ht_get_ptr_open(...) */
+
+/**
+ *@brief Retrieve a char *string value in the hash table, at the given key. Leave val untouched if key is not found. [OPEN HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to an empty destination char *string
+ *@return TRUE or FALSE.
+ */
+int _ht_get_string_open(HASH_TABLE* table, const char* key, char** val) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    const HASH_NODE* node = _ht_get_node_open(table, key);
+    if (!node)
+        return FALSE;
+
+    if (node->type != HASH_STRING) {
+        n_log(LOG_ERR, "Can't get key[\"%s\"] of type HASH_STRING, key is type %s", key, ht_node_type(node));
+        return FALSE;
+    }
+    (*val) = node->data.string;
+    return TRUE;
+} /* _ht_get_string_open(...) */
+
+/**
+ *@brief Remove a key from a hash table [OPEN HASH TABLE]
+ *@param table targeted hash table
+ *@param key Key to remove
+ *@return TRUE or FALSE.
+ */
+int _ht_remove_open(HASH_TABLE* table, const char* key) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    if (key[0] == '\0')
+        return FALSE;
+
+    size_t index = _ht_open_find_slot(table, key, _ht_open_hash(table, key));
+    if (index == SIZE_MAX) {
+        n_log(LOG_ERR, "Can't delete key[\"%s\"]: inexisting key", key);
+        return FALSE;
+    }
+    _ht_node_destroy_value(&table->open_nodes[index]);
+    FreeNoLog(table->open_nodes[index].key);
+
+    /* backward shift deletion: pull the following displaced nodes one slot closer to their home */
+    size_t mask = table->size - 1;
+    size_t next = (index + 1) & mask;
+    while (table->open_dist[next] > 1) {
+        table->open_nodes[index] = table->open_nodes[next];
+        table->open_dist[index] = (uint8_t)(table->open_dist[next] - 1);
+        index = next;
+        next = (next + 1) & mask;
+    }
+    memset(&table->open_nodes[index], 0, sizeof(HASH_NODE));
+    table->open_dist[index] = 0;
+
+    table->nb_keys--;
+
+    return TRUE;
+} /* _ht_remove_open(...) */
+
+/**
+ *@brief Empty a hash table (OPEN mode)
+ *@param table targeted hash table
+ *@return TRUE or FALSE.
+ */
+int _empty_ht_open(HASH_TABLE* table) {
+    __n_assert(table, return FALSE);
+
+    for (size_t it = 0; it < table->size; it++) {
+        if (table->open_dist[it] != 0) {
+            _ht_node_destroy_value(&table->open_nodes[it]);
+            FreeNoLog(table->open_nodes[it].key);
+        }
+    }
+    memset(table->open_nodes, 0, table->size * sizeof(HASH_NODE));
+    memset(table->open_dist, 0, table->size * sizeof(uint8_t));
+    table->nb_keys = 0;
+    return TRUE;
+} /* _empty_ht_open(...) */
+
+/**
+ *@brief Free and set the table to NULL (OPEN mode)
+ *@param table targeted hash table
+ *@return TRUE or FALSE.
+ */
+int _destroy_ht_open(HASH_TABLE** table) {
+    __n_assert(table && (*table), n_log(LOG_ERR, "Can't destroy table: already NULL"); return FALSE);
+
+    if ((*table)->open_nodes && (*table)->open_dist) {
+        _empty_ht_open((*table));
+    }
+    FreeNoLog((*table)->open_nodes);
+    FreeNoLog((*table)->open_dist);
+    Free((*table));
+    return TRUE;
+} /* _destroy_ht_open(...) */
+
+/**
+ *@brief Generic print func call for open hash tables
+ *@param table targeted hash table
+ */
+void _ht_print_open(HASH_TABLE* table) {
+    __n_assert(table, return);
+    __n_assert(table->open_nodes, return);
+
+    for (size_t it = 0; it < table->size; it++) {
+        if (table->open_dist[it] != 0) {
+            printf("key:%s slot:%zu probe:%d\n", table->open_nodes[it].key, it, table->open_dist[it] - 1);
+        }
+    }
+    return;
+} /* _ht_print_open(...) */
+
+/**
+ *@brief Search hash table's keys and apply a matching func to put results in the list [OPEN HASH TABLE]
+ *@param table targeted table
+ *@param node_is_matching pointer to a matching function to use
+ *@return NULL or a LIST *list of HASH_NODE *elements
+ */
+LIST* _ht_search_open(HASH_TABLE* table, int (*node_is_matching)(HASH_NODE* node)) {
+    __n_assert(table, return NULL);
+
+    LIST* results = new_generic_list(MAX_LIST_ITEMS);
+    __n_assert(results, return NULL);
+
+    for (size_t it = 0; it < table->size; it++) {
+        if (table->open_dist[it] != 0 && node_is_matching(&table->open_nodes[it]) == TRUE) {
+            list_push(results, strdup(table->open_nodes[it].key), &free);
+        }
+    }
+
+    if (results->nb_items < 1)
+        list_destroy(&results);
+
+    return results;
+} /* _ht_search_open(...) */
+
+/* Concurrent sharded hash table */
+
+/**
+ *@brief enter a lock free read section on a shard, HASH_CONCURRENT mode. The entries reachable from the shard buckets are not freed before the matching ht_concurrent_read_exit.
+ *@param shard targeted shard
+ *@return the epoch parity to give back to ht_concurrent_read_exit
+ */
+size_t ht_concurrent_read_enter(HASH_CONCURRENT_SHARD* shard) {
+    while (TRUE) {
+        size_t epoch = __atomic_load_n(&shard->epoch, __ATOMIC_SEQ_CST);
+        size_t parity = epoch & 1;
+        __atomic_add_fetch(&shard->readers[parity], 1, __ATOMIC_SEQ_CST);
+        /* a reclamation flipped the epoch meanwhile and may not have counted us, register again */
+        if (__atomic_load_n(&shard->epoch, __ATOMIC_SEQ_CST) == epoch)
+            return parity;
+        __atomic_sub_fetch(&shard->readers[parity], 1, __ATOMIC_SEQ_CST);
+    }
+} /* ht_concurrent_read_enter(...) */
+
+/**
+ *@brief leave a lock free read section on a shard, HASH_CONCURRENT mode
+ *@param shard targeted shard
+ *@param parity value returned by the matching ht_concurrent_read_enter
+ */
+void ht_concurrent_read_exit(HASH_CONCURRENT_SHARD* shard, size_t parity) {
+    __atomic_sub_fetch(&shard->readers[parity], 1, __ATOMIC_SEQ_CST);
+} /* ht_concurrent_read_exit(...) */
+
+/**
+ *@brief enter the read section of the shard holding a key given by its hash, HASH_CONCURRENT mode. The string, pointer and node values of the shard got inside are not freed before the matching ht_concurrent_read_unlock_hashed, even if a concurrent put or remove replaces them. Writers must not be called on the same shard from inside, their reclamation would wait for the section to end.
+ *@param table targeted HASH_CONCURRENT table
+ *@param hash_value hash of the key given by ht_hash_key
+ *@return the epoch parity to give back to ht_concurrent_read_unlock_hashed
+ */
+size_t ht_concurrent_read_lock_hashed(HASH_TABLE* table, HASH_VALUE hash_value) {
+    return ht_concurrent_read_enter(&table->shards[hash_value % table->nb_shards]);
+} /* ht_concurrent_read_lock_hashed(...) */
+
+/**
+ *@brief leave a read section entered by ht_concurrent_read_lock_hashed, HASH_CONCURRENT mode
+ *@param table targeted HASH_CONCURRENT table
+ *@param hash_value hash of the key given to ht_concurrent_read_lock_hashed
+ *@param parity value returned by ht_concurrent_read_lock_hashed
+ */
+void ht_concurrent_read_unlock_hashed(HASH_TABLE* table, HASH_VALUE hash_value, size_t parity) {
+    ht_concurrent_read_exit(&table->shards[hash_value % table->nb_shards], parity);
+} /* ht_concurrent_read_unlock_hashed(...) */
+
+/**
+ *@brief enter the read section of the shard holding key, HASH_CONCURRENT mode. The string, pointer and node values of key got with ht_get_string, ht_get_ptr or ht_get_node inside stay valid until the matching ht_concurrent_read_unlock, even if a concurrent put or remove replaces them. Writers must not be called on the same key from inside, their reclamation would wait for the section to end.
+ *@param table targeted HASH_CONCURRENT table
+ *@param key key to read
+ *@return the epoch parity to give back to ht_concurrent_read_unlock
+ */
+size_t ht_concurrent_read_lock(HASH_TABLE* table, const char* key) {
+    return ht_concurrent_read_lock_hashed(table, ht_hash_key(table, key, strlen(key)));
+} /* ht_concurrent_read_lock(...) */
+
+/**
+ *@brief leave a read section entered by ht_concurrent_read_lock, HASH_CONCURRENT mode
+ *@param table targeted HASH_CONCURRENT table
+ *@param key key given to ht_concurrent_read_lock
+ *@param parity value returned by ht_concurrent_read_lock
+ */
+void ht_concurrent_read_unlock(HASH_TABLE* table, const char* key, size_t parity) {
+    ht_concurrent_read_unlock_hashed(table, ht_hash_key(table, key, strlen(key)), parity);
+} /* ht_concurrent_read_unlock(...) */
+
+/**
+ *@brief free an entry and its key and value, HASH_CONCURRENT mode
+ *@param entry entry no reader can reach anymore
+ */
+void _ht_concurrent_free_entry(HASH_CONCURRENT_ENTRY* entry) {
+    _ht_node_destroy_value(&entry->node);
+    FreeNoLog(entry->node.key);
+    Free(entry);
+} /* _ht_concurrent_free_entry(...) */
+
+/**
+ *@brief wait until no reader of the given parity is left in the shard, HASH_CONCURRENT mode
+ *@param shard targeted shard
+ *@param parity epoch parity to wait for
+ *@return TRUE or FALSE if readers were still there after HASH_CONCURRENT_SYNC_SPINS yields
+ */
+int _ht_concurrent_wait_readers(HASH_CONCURRENT_SHARD* shard, size_t parity) {
+    for (size_t spins = 0; __atomic_load_n(&shard->readers[parity], __ATOMIC_SEQ_CST) != 0; spins++) {
+        if (spins >= HASH_CONCURRENT_SYNC_SPINS)
+            return FALSE;
+        sched_yield();
+    }
+    return TRUE;
+} /* _ht_concurrent_wait_readers(...) */
+
+/**
+ *@brief free the retired entries of a shard once the readers that could see them have left, HASH_CONCURRENT mode. Must be called with the shard lock held. If readers stay too long (i.e. a writer called from inside a read section) the entries are kept for a later try.
+ *@param shard targeted shard
+ *@return TRUE or FALSE if the entries are still pending
+ */
+int _ht_concurrent_reclaim(HASH_CONCURRENT_SHARD* shard) {
+    if (!shard->retired)
+        return TRUE;
+
+    size_t parity = __atomic_load_n(&shard->epoch, __ATOMIC_SEQ_CST) & 1;
+    /* readers left over from a previous, timed out, reclamation */
+    int synced = _ht_concurrent_wait_readers(shard, parity ^ 1);
+    if (synced == TRUE) {
+        /* new readers go to the other counter, and can't reach the unlinked entries */
+        __atomic_add_fetch(&shard->epoch, 1, __ATOMIC_SEQ_CST);
+        synced = _ht_concurrent_wait_readers(shard, parity);
+    }
+    if (synced == FALSE) {
+        shard->retire_threshold = shard->nb_retired + HASH_CONCURRENT_RETIRE_BATCH;
+        return FALSE;
+    }
+
+    while (shard->retired) {
+        HASH_CONCURRENT_ENTRY* entry = shard->retired;
+        shard->retired = entry->retired_next;
+        _ht_concurrent_free_entry(entry);
+    }
+    shard->nb_retired = 0;
+    shard->retire_threshold = HASH_CONCURRENT_RETIRE_BATCH;
+    return TRUE;
+} /* _ht_concurrent_reclaim(...) */
+
+/**
+ *@brief queue an unlinked entry for reclamation, HASH_CONCURRENT mode. Must be called with the shard lock held.
+ *@param shard targeted shard
+ *@param entry entry removed from the bucket chains
+ */
+void _ht_concurrent_retire(HASH_CONCURRENT_SHARD* shard, HASH_CONCURRENT_ENTRY* entry) {
+    entry->retired_next = shard->retired;
+    shard->retired = entry;
+    shard->nb_retired++;
+    if (shard->nb_retired >= shard->retire_threshold)
+        _ht_concurrent_reclaim(shard);
+} /* _ht_concurrent_retire(...) */
+
+/**
+ *@brief compute the hash of key and return its shard and bucket, HASH_CONCURRENT mode
+ *@param table targeted table
+ *@param key key to place
+ *@param hash_value set to the hash value of key
+ *@param bucket set to the bucket index of key in the returned shard
+ *@return the shard of key
+ */
+HASH_CONCURRENT_SHARD* _ht_concurrent_locate(const HASH_TABLE* table, const char* key, HASH_VALUE* hash_value, size_t* bucket) {
+    HASH_VALUE hash[2] = {0, 0};
+    MurmurHash(key, strlen(key), table->seed, &hash);
+    (*hash_value) = hash[0];
+    HASH_CONCURRENT_SHARD* shard = &table->shards[hash[0] % table->nb_shards];
+    (*bucket) = (hash[0] / table->nb_shards) % shard->size;
+    return shard;
+} /* _ht_concurrent_locate(...) */
+
+/**
+ *@brief find the entry of a key in a bucket chain, HASH_CONCURRENT mode. Must be called inside a read section or with the shard lock held.
+ *@param shard shard of the key
+ *@param bucket bucket index of the key
+ *@param key key to find
+ *@param hash_value hash value of key
+ *@param link if not NULL, set to the address of the pointer to the found entry
+ *@return NULL or the found entry
+ */
+HASH_CONCURRENT_ENTRY* _ht_concurrent_find(HASH_CONCURRENT_SHARD* shard, size_t bucket, const char* key, HASH_VALUE hash_value, HASH_CONCURRENT_ENTRY*** link) {
+    HASH_CONCURRENT_ENTRY** prev = &shard->buckets[bucket];
+    for (HASH_CONCURRENT_ENTRY* entry = __atomic_load_n(prev, __ATOMIC_ACQUIRE); entry != NULL; entry = __atomic_load_n(prev, __ATOMIC_ACQUIRE)) {
+        if (entry->node.hash_value == hash_value && !strcmp(key, entry->node.key)) {
+            if (link)
+                (*link) = prev;
+            return entry;
+        }
+        prev = &entry->next;
+    }
+    return NULL;
+} /* _ht_concurrent_find(...) */
+
+/**
+ *@brief _ht_concurrent_put for a key already hashed, HASH_CONCURRENT mode
+ *@param table targeted table
+ *@param key key of the value, not empty
+ *@param hash_value hash value of key
+ *@param value node holding the type, data and functions of the value. The key is copied.
+ *@return TRUE or FALSE, in which case value is left to the caller
+ */
+int _ht_concurrent_put_hashed(HASH_TABLE* table, const char* key, HASH_VALUE hash_value, const HASH_NODE* value) {
+    HASH_CONCURRENT_SHARD* shard = &table->shards[hash_value % table->nb_shards];
+    size_t bucket = (hash_value / table->nb_shards) % shard->size;
+
+    HASH_CONCURRENT_ENTRY* entry = NULL;
+    Malloc(entry, HASH_CONCURRENT_ENTRY, 1);
+    __n_assert(entry, n_log(LOG_ERR, "Could not allocate new entry for key %s", key); return FALSE);
+    entry->node = (*value);
+    entry->node.key = strdup(key);
+    __n_assert(entry->node.key, n_log(LOG_ERR, "Could not allocate entry->node.key"); Free(entry); return FALSE);
+    entry->node.hash_value = hash_value;
+
+    pthread_mutex_lock(&shard->lock);
+    HASH_CONCURRENT_ENTRY** link = NULL;
+    HASH_CONCURRENT_ENTRY* old = _ht_concurrent_find(shard, bucket, key, hash_value, &link);
+    if (old) {
+        if (old->node.type != value->type) {
+            pthread_mutex_unlock(&shard->lock);
+            n_log(LOG_ERR, "Can't add key[\"%s\"] with type %s, key already exist with type %s", key, ht_node_type(value), ht_node_type(&old->node));
+            FreeNoLog(entry->node.key);
+            Free(entry);
+            return FALSE; /* key registered with another data type */
+        }
+        entry->next = old->next;
+        __atomic_store_n(link, entry, __ATOMIC_RELEASE);
+        _ht_concurrent_retire(shard, old);
+    } else {
+        entry->next = shard->buckets[bucket];
+        __atomic_store_n(&shard->buckets[bucket], entry, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&table->nb_keys, 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return TRUE;
+} /* _ht_concurrent_put_hashed(...) */
+
+/**
+ *@brief insert a new entry holding value, or replace the entry already holding key, HASH_CONCURRENT mode. A replaced entry is retired with its value, readers keep seeing either the old or the new value.
+ *@param table targeted table
+ *@param key key of the value
+ *@param value node holding the type, data and functions of the value. The key is copied.
+ *@return TRUE or FALSE, in which case value is left to the caller
+ */
+int _ht_concurrent_put(HASH_TABLE* table, const char* key, const HASH_NODE* value) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    if (key[0] == '\0')
+        return FALSE;
+
+    HASH_VALUE hash_value[2] = {0, 0};
+    MurmurHash(key, strlen(key), table->seed, &hash_value);
+    return _ht_concurrent_put_hashed(table, key, hash_value[0], value);
+} /* _ht_concurrent_put(...) */
+
+/**
+ *@brief put an integral value with given key in the targeted hash table [CONCURRENT HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param value integral value to put
+ *@return TRUE or FALSE
+ */
+int _ht_put_int_concurrent(HASH_TABLE* table, const char* key, HASH_INT_TYPE value) {
+    HASH_NODE node;
+    memset(&node, 0, sizeof(HASH_NODE));
+    node.type = HASH_INT;
+    node.data.ival = value;
+    return _ht_concurrent_put(table, key, &node);
+} /* _ht_put_int_concurrent(...) */
+
+/**
+ *@brief put a double value with given key in the targeted hash table [CONCURRENT HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param value double value to put
+ *@return TRUE or FALSE
+ */
+int _ht_put_double_concurrent(HASH_TABLE* table, const char* key, double value) {
+    HASH_NODE node;
+    memset(&node, 0, sizeof(HASH_NODE));
+    node.type = HASH_DOUBLE;
+    node.data.fval = value;
+    return _ht_concurrent_put(table, key, &node);
+} /* _ht_put_double_concurrent(...) */
+
+/**
+ *@brief put a pointer value with given key in the targeted hash table [CONCURRENT HASH TABLE]. A replaced pointer is destroyed once the readers that could see it have left.
+ *@param table targeted hash table
+ *@param key Associated value's key
+ *@param ptr pointer value to put
+ *@param destructor Pointer to the ptr type destructor function. Leave to NULL if there isn't
+ *@param duplicator Pointer to the ptr type duplicator function. Leave to NULL if there isn't
+ *@return TRUE or FALSE
+ */
+int _ht_put_ptr_concurrent(HASH_TABLE* table, const char* key, void* ptr, void (*destructor)(void* ptr), void* (*duplicator)(void* ptr)) {
+    HASH_NODE node;
+    memset(&node, 0, sizeof(HASH_NODE));
+    node.type = HASH_PTR;
+    node.data.ptr = ptr;
+    node.destroy_func = destructor;
+    node.duplicate_func = duplicator;
+    return _ht_concurrent_put(table, key, &node);
+} /* _ht_put_ptr_concurrent(...) */
+
+/**
+ *@brief put a null terminated char *string with given key in the targeted hash table (copy of string) [CONCURRENT HASH TABLE]
+ *@param table targeted hash table
+ *@param key Associated value's key
+ *@param string string value to put (will be strdup'ed)
+ *@return TRUE or FALSE
+ */
+int _ht_put_string_concurrent(HASH_TABLE* table, const char* key, char* string) {
+    HASH_NODE node;
+    memset(&node, 0, sizeof(HASH_NODE));
+    node.type = HASH_STRING;
+    if (string) {
+        node.data.string = strdup(string);
+        if (!node.data.string) {
+            n_log(LOG_ERR, "could not strdup char *string at %p, didn't overwrite %s", string, _str(key));
+            return FALSE;
+        }
+    }
+    if (_ht_concurrent_put(table, key, &node) == FALSE) {
+        FreeNoLog(node.data.string);
+        return FALSE;
+    }
+    return TRUE;
+} /* _ht_put_string_concurrent(...) */
+
+/**
+ *@brief put a null terminated char *string with given key in the targeted hash table (pointer) [CONCURRENT HASH TABLE]
+ *@param table targeted hash table
+ *@param key Associated value's key
+ *@param string The string to put
+ *@return TRUE or FALSE
+ */
+int _ht_put_string_ptr_concurrent(HASH_TABLE* table, const char* key, char* string) {
+    HASH_NODE node;
+    memset(&node, 0, sizeof(HASH_NODE));
+    node.type = HASH_STRING;
+    node.data.string = string;
+    return _ht_concurrent_put(table, key, &node);
+} /* _ht_put_string_ptr_concurrent(...) */
+
+/**
+ *@brief copy the value of a key from a read section, HASH_CONCURRENT mode. For a string or a pointer only the address is copied, the value is freed some time after a concurrent put or remove of the same key unless the caller holds ht_concurrent_read_lock on key
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param type expected type of the value
+ *@param val set to the value if key is found with the expected type
+ *@return TRUE or FALSE
+ */
+int _ht_concurrent_get(HASH_TABLE* table, const char* key, int type, union HASH_DATA* val) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    if (key[0] == '\0')
+        return FALSE;
+
+    HASH_VALUE hash_value = 0;
+    size_t bucket = 0;
+    HASH_CONCURRENT_SHARD* shard = _ht_concurrent_locate(table, key, &hash_value, &bucket);
+
+    int found_type = 0;
+    size_t parity = ht_concurrent_read_enter(shard);
+    const HASH_CONCURRENT_ENTRY* entry = _ht_concurrent_find(shard, bucket, key, hash_value, NULL);
+    if (entry) {
+        found_type = entry->node.type;
+        if (found_type == type)
+            (*val) = entry->node.data;
+    }
+    ht_concurrent_read_exit(shard, parity);
+
+    if (!entry)
+        return FALSE;
+    if (found_type != type) {
+        HASH_NODE expected = {.type = type};
+        HASH_NODE found = {.type = found_type};
+        n_log(LOG_ERR, "Can't get key[\"%s\"] of type %s, key is type %s", key, ht_node_type(&expected), ht_node_type(&found));
+        return FALSE;
+    }
+    return TRUE;
+} /* _ht_concurrent_get(...) */
+
+/**
+ *@brief return the associated key's node inside the table, HASH_CONCURRENT mode
+ *@param table targeted table
+ *@param key Associated value's key
+ *@return The found node, or NULL. The node is freed some time after a concurrent put or remove of the same key, unless the caller holds ht_concurrent_read_lock on key.
+ */
+HASH_NODE* _ht_get_node_concurrent(HASH_TABLE* table, const char* key) {
+    __n_assert(table, return NULL);
+    __n_assert(key, return NULL);
+
+    if (key[0] == '\0')
+        return NULL;
+
+    HASH_VALUE hash_value = 0;
+    size_t bucket = 0;
+    HASH_CONCURRENT_SHARD* shard = _ht_concurrent_locate(table, key, &hash_value, &bucket);
+
+    size_t parity = ht_concurrent_read_enter(shard);
+    HASH_CONCURRENT_ENTRY* entry = _ht_concurrent_find(shard, bucket, key, hash_value, NULL);
+    ht_concurrent_read_exit(shard, parity);
+
+    return entry ? &entry->node : NULL;
+} /* _ht_get_node_concurrent(...) */
+
+/**
+ *@brief Retrieve an integral value in the hash table, at the given key. Leave val untouched if key is not found. [CONCURRENT HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to a destination integer
+ *@return TRUE or FALSE.
+ */
+int _ht_get_int_concurrent(HASH_TABLE* table, const char* key, HASH_INT_TYPE* val) {
+    union HASH_DATA data;
+    if (_ht_concurrent_get(table, key, HASH_INT, &data) == FALSE)
+        return FALSE;
+    (*val) = data.ival;
+    return TRUE;
+} /* _ht_get_int_concurrent(...) */
+
+/**
+ *@brief Retrieve a double value in the hash table, at the given key. Leave val untouched if key is not found. [CONCURRENT HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to a destination double
+ *@return TRUE or FALSE.
+ */
+int _ht_get_double_concurrent(HASH_TABLE* table, const char* key, double* val) {
+    union HASH_DATA data;
+    if (_ht_concurrent_get(table, key, HASH_DOUBLE, &data) == FALSE)
+        return FALSE;
+    (*val) = data.fval;
+    return TRUE;
+} /* _ht_get_double_concurrent(...) */
+
+/**
+ *@brief Retrieve a pointer value in the hash table, at the given key. Leave val untouched if key is not found. [CONCURRENT HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to an empty pointer store
+ *@return TRUE or FALSE.
+ */
+int _ht_get_ptr_concurrent(HASH_TABLE* table, const char* key, void** val) {
+    union HASH_DATA data;
+    if (_ht_concurrent_get(table, key, HASH_PTR, &data) == FALSE)
+        return FALSE;
+    (*val) = data.ptr;
+    return TRUE;
+} /* _ht_get_ptr_concurrent(...) */
+
+/**
+ *@brief Retrieve a char *string value in the hash table, at the given key. Leave val untouched if key is not found. [CONCURRENT HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to an empty destination char *string
+ *@return TRUE or FALSE.
+ */
+int _ht_get_string_concurrent(HASH_TABLE* table, const char* key, char** val) {
+    union HASH_DATA data;
+    if (_ht_concurrent_get(table, key, HASH_STRING, &data) == FALSE)
+        return FALSE;
+    (*val) = data.string;
+    return TRUE;
+} /* _ht_get_string_concurrent(...) */
+
+/**
+ *@brief Remove a key from a hash table [CONCURRENT HASH TABLE]. The entry and its value are freed once the readers that could see it have left.
+ *@param table targeted hash table
+ *@param key Key to remove
+ *@return TRUE or FALSE.
+ */
+int _ht_remove_concurrent(HASH_TABLE* table, const char* key) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    if (key[0] == '\0')
+        return FALSE;
+
+    HASH_VALUE hash_value = 0;
+    size_t bucket = 0;
+    HASH_CONCURRENT_SHARD* shard = _ht_concurrent_locate(table, key, &hash_value, &bucket);
+
+    pthread_mutex_lock(&shard->lock);
+    HASH_CONCURRENT_ENTRY** link = NULL;
+    HASH_CONCURRENT_ENTRY* entry = _ht_concurrent_find(shard, bucket, key, hash_value, &link);
+    if (!entry) {
+        pthread_mutex_unlock(&shard->lock);
+        n_log(LOG_ERR, "Can't delete key[\"%s\"]: inexisting key", key);
+        return FALSE;
+    }
+    /* entry->next is kept so that readers standing on entry still reach the rest of the chain */
+    __atomic_store_n(link, entry->next, __ATOMIC_RELEASE);
+    _ht_concurrent_retire(shard, entry);
+    __atomic_sub_fetch(&table->nb_keys, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&shard->lock);
+
+    return TRUE;
+} /* _ht_remove_concurrent(...) */
+
+/**
+ *@brief Empty a hash table (CONCURRENT mode). Shards are emptied one after the other.
+ *@param table targeted hash table
+ *@return TRUE or FALSE.
+ */
+int _empty_ht_concurrent(HASH_TABLE* table) {
+    __n_assert(table, return FALSE);
+
+    for (size_t it = 0; it < table->nb_shards; it++) {
+        HASH_CONCURRENT_SHARD* shard = &table->shards[it];
+        pthread_mutex_lock(&shard->lock);
+        size_t nb_removed = 0;
+        for (size_t bucket = 0; bucket < shard->size; bucket++) {
+            HASH_CONCURRENT_ENTRY* entry = shard->buckets[bucket];
+            __atomic_store_n(&shard->buckets[bucket], NULL, __ATOMIC_RELEASE);
+            while (entry) {
+                HASH_CONCURRENT_ENTRY* next = entry->next;
+                entry->retired_next = shard->retired;
+                shard->retired = entry;
+                shard->nb_retired++;
+                nb_removed++;
+                entry = next;
+            }
+        }
+        _ht_concurrent_reclaim(shard);
+        __atomic_sub_fetch(&table->nb_keys, nb_removed, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return TRUE;
+} /* _empty_ht_concurrent(...) */
+
+/**
+ *@brief Free and set the table to NULL (CONCURRENT mode). No other thread must be using the table.
+ *@param table targeted hash table
+ *@return TRUE or FALSE.
+ */
+int _destroy_ht_concurrent(HASH_TABLE** table) {
+    __n_assert(table && (*table), n_log(LOG_ERR, "Can't destroy table: already NULL"); return FALSE);
+
+    if ((*table)->shards) {
+        for (size_t it = 0; it < (*table)->nb_shards; it++) {
+            HASH_CONCURRENT_SHARD* shard = &(*table)->shards[it];
+            for (size_t bucket = 0; bucket < shard->size; bucket++) {
+                while (shard->buckets[bucket]) {
+                    HASH_CONCURRENT_ENTRY* entry = shard->buckets[bucket];
+                    shard->buckets[bucket] = entry->next;
+                    _ht_concurrent_free_entry(entry);
+                }
+            }
+            while (shard->retired) {
+                HASH_CONCURRENT_ENTRY* entry = shard->retired;
+                shard->retired = entry->retired_next;
+                _ht_concurrent_free_entry(entry);
+            }
+            pthread_mutex_destroy(&shard->lock);
+            Free(shard->buckets);
+        }
+        Free((*table)->shards);
+    }
+    Free((*table));
+    return TRUE;
+} /* _destroy_ht_concurrent(...) */
+
+/**
+ *@brief Generic print func call for concurrent hash tables
+ *@param table targeted hash table
+ */
+void _ht_print_concurrent(HASH_TABLE* table) {
+    __n_assert(table, return);
+    __n_assert(table->shards, return);
+
+    HT_FOREACH(node, table, {
+        printf("key: %s, val: ", node->key);
+        switch (node->type) {
+            case HASH_INT:
+                printf("int: %ld", (long)node->data.ival);
+                break;
+            case HASH_DOUBLE:
+                printf("double: %f", node->data.fval);
+                break;
+            case HASH_PTR:
+                printf("ptr: %p", node->data.ptr);
+                break;
+            case HASH_STRING:
+                printf("%s", node->data.string);
+                break;
+            default:
+                printf("unknwow type %d", node->type);
+                break;
+        }
+        printf("\n");
+    });
+    return;
+} /* _ht_print_concurrent(...) */
+
+/**
+ *@brief Search hash table's keys and apply a matching func to put results in the list [CONCURRENT HASH TABLE]. Each shard is searched inside its own read section.
+ *@param table targeted table
+ *@param node_is_matching pointer to a matching function to use
+ *@return NULL or a LIST *list of HASH_NODE *elements
+ */
+LIST* _ht_search_concurrent(HASH_TABLE* table, int (*node_is_matching)(HASH_NODE* node)) {
+    __n_assert(table, return NULL);
+
+    LIST* results = new_generic_list(MAX_LIST_ITEMS);
+    __n_assert(results, return NULL);
+
+    HT_FOREACH(node, table, {
+        if (node_is_matching(node) == TRUE) {
+            list_push(results, strdup(node->key), &free);
+        }
+    });
+
+    if (results->nb_items < 1)
+        list_destroy(&results);
+
+    return results;
+} /* _ht_search_concurrent(...) */
+
+/* Memory mapped snapshot tables */
+
+int _ht_duplicate_node(HASH_TABLE* duplicated_table, const HASH_NODE* hash_node);
+
+/**
+ *@brief tell if a string of len bytes plus its null terminator at offset lies in the key and string pool of the image, HASH_SNAPSHOT mode
+ *@param table targeted table
+ *@param offset offset of the string in the image
+ *@param len length of the string
+ *@return TRUE or FALSE
+ */
+FORCE_INLINE int _ht_snapshot_in_pool(const HASH_TABLE* table, uint64_t offset, uint64_t len) {
+    uint64_t pool_end = (uint64_t)((const char*)table->snapshot_slots - table->snapshot_image);
+    return (offset >= sizeof(HASH_SNAPSHOT_HEADER) && offset < pool_end && len < pool_end - offset) ? TRUE : FALSE;
+} /* _ht_snapshot_in_pool(...) */
+
+/**
+ *@brief find the image slot holding key, HASH_SNAPSHOT mode
+ *@param table targeted table
+ *@param key key to search
+ *@param hash_value hash value of key
+ *@return the slot or NULL if key is not in the image
+ */
+const HASH_SNAPSHOT_SLOT* _ht_snapshot_find_slot(const HASH_TABLE* table, const char* key, HASH_VALUE hash_value) {
+    if (!table->snapshot_slots)
+        return NULL;
+    size_t key_len = strlen(key);
+    size_t mask = table->size - 1;
+    size_t index = hash_value & mask;
+    for (size_t probe = 0; probe < table->size; probe++) {
+        const HASH_SNAPSHOT_SLOT* slot = &table->snapshot_slots[index];
+        if (slot->key_offset == 0)
+            return NULL;
+        if (slot->hash_value == (uint64_t)hash_value && slot->key_len == key_len && _ht_snapshot_in_pool(table, slot->key_offset, key_len) && !memcmp(key, table->snapshot_image + slot->key_offset, key_len))
+            return slot;
+        index = (index + 1) & mask;
+    }
+    return NULL;
+} /* _ht_snapshot_find_slot(...) */
+
+/**
+ *@brief fill a HASH_NODE with the content of an image slot, HASH_SNAPSHOT mode. The node key and string value point into the read only image.
+ *@param table targeted table
+ *@param slot image slot
+ *@param node node to fill
+ *@return TRUE or FALSE if the slot is corrupted
+ */
+int _ht_snapshot_fill_node(const HASH_TABLE* table, const HASH_SNAPSHOT_SLOT* slot, HASH_NODE* node) {
+    memset(node, 0, sizeof(HASH_NODE));
+    if (_ht_snapshot_in_pool(table, slot->key_offset, slot->key_len) == FALSE) {
+        n_log(LOG_ERR, "corrupted snapshot slot: key offset %zu out of the image", (size_t)slot->key_offset);
+        return FALSE;
+    }
+    node->key = (char*)(table->snapshot_image + slot->key_offset);
+    node->hash_value = (HASH_VALUE)slot->hash_value;
+    node->type = (int)slot->type;
+    switch (slot->type) {
+        case HASH_INT:
+            node->data.ival = (HASH_INT_TYPE)slot->value.ival;
+            break;
+        case HASH_DOUBLE:
+            node->data.fval = slot->value.fval;
+            break;
+        case HASH_STRING:
+            if (slot->value.string_offset == 0)
+                break;
+            if (_ht_snapshot_in_pool(table, slot->value.string_offset, 0) == FALSE) {
+                n_log(LOG_ERR, "corrupted snapshot slot: key[\"%s\"] string offset %zu out of the image", node->key, (size_t)slot->value.string_offset);
+                return FALSE;
+            }
+            node->data.string = (char*)(table->snapshot_image + slot->value.string_offset);
+            break;
+        default:
+            n_log(LOG_ERR, "corrupted snapshot slot: key[\"%s\"] has unknown type %u", node->key, slot->type);
+            return FALSE;
+    }
+    return TRUE;
+} /* _ht_snapshot_fill_node(...) */
+
+/**
+ *@brief find the node of key, in the overlay first, then in the image unless the key was removed, HASH_SNAPSHOT mode
+ *@param table targeted table
+ *@param key key to search
+ *@param hash_value hash value of key, overlay and removed tables sharing the image seed
+ *@param image_node storage for a node found in the image
+ *@return NULL, an overlay node or image_node
+ */
+HASH_NODE* _ht_snapshot_lookup(HASH_TABLE* table, const char* key, HASH_VALUE hash_value, HASH_NODE* image_node) {
+    if (table->snapshot_overlay->nb_keys > 0) {
+        size_t index = _ht_open_find_slot(table->snapshot_overlay, key, hash_value);
+        if (index != SIZE_MAX)
+            return &table->snapshot_overlay->open_nodes[index];
+    }
+    if (table->snapshot_removed->nb_keys > 0 && _ht_open_find_slot(table->snapshot_removed, key, hash_value) != SIZE_MAX)
+        return NULL;
+    const HASH_SNAPSHOT_SLOT* slot = _ht_snapshot_find_slot(table, key, hash_value);
+    if (!slot || _ht_snapshot_fill_node(table, slot, image_node) == FALSE)
+        return NULL;
+    return image_node;
+} /* _ht_snapshot_lookup(...) */
+
+/**
+ *@brief get the next node of a HASH_SNAPSHOT table, iteration helper of HT_FOREACH. The overlay nodes come first, then the image ones neither put again nor removed since the image was opened. The table must not be modified during the iteration.
+ *@param table targeted table
+ *@param position iteration position, 0 to start
+ *@param image_node storage for the nodes read from the image. Their key and string value point into the read only image.
+ *@return the next node or NULL at the end of the table
+ */
+HASH_NODE* ht_snapshot_next(HASH_TABLE* table, size_t* position, HASH_NODE* image_node) {
+    __n_assert(table, return NULL);
+    __n_assert(position, return NULL);
+    __n_assert(image_node, return NULL);
+
+    const HASH_TABLE* overlay = table->snapshot_overlay;
+    while ((*position) < overlay->size) {
+        size_t index = (*position)++;
+        if (overlay->open_dist[index] != 0)
+            return &overlay->open_nodes[index];
+    }
+    int is_shadowed = (overlay->nb_keys > 0 || table->snapshot_removed->nb_keys > 0);
+    while ((*position) < overlay->size + table->size) {
+        const HASH_SNAPSHOT_SLOT* slot = &table->snapshot_slots[(*position)++ - overlay->size];
+        if (slot->key_offset == 0 || _ht_snapshot_fill_node(table, slot, image_node) == FALSE)
+            continue;
+        if (is_shadowed && (_ht_open_find_slot(overlay, image_node->key, image_node->hash_value) != SIZE_MAX || _ht_open_find_slot(table->snapshot_removed, image_node->key, image_node->hash_value) != SIZE_MAX))
+            continue;
+        return image_node;
+    }
+    return NULL;
+} /* ht_snapshot_next(...) */
+
+/**
+ *@brief map an image file in memory, read only. Pages are loaded on first access.
+ *@param path image file
+ *@param image set to the mapped image
+ *@param image_size set to the size of the image
+ *@return TRUE or FALSE
+ */
+int _ht_snapshot_map(const char* path, const char** image, size_t* image_size) {
+#ifndef __windows__
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        n_log(LOG_ERR, "Can't open snapshot %s: %s", path, strerror(errno));
+        return FALSE;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(HASH_SNAPSHOT_HEADER)) {
+        n_log(LOG_ERR, "Can't use snapshot %s: unreadable or smaller than its header", path);
+        close(fd);
+        return FALSE;
+    }
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        n_log(LOG_ERR, "Can't map snapshot %s: %s", path, strerror(errno));
+        return FALSE;
+    }
+    /* slots are probed at random, reading ahead would only load pages nobody asked for */
+    madvise(map, (size_t)st.st_size, MADV_RANDOM);
+    (*image) = (const char*)map;
+    (*image_size) = (size_t)st.st_size;
+    return TRUE;
+#else
+    /* no mmap: the image is read in memory, it is still used without any parsing */
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        n_log(LOG_ERR, "Can't open snapshot %s: %s", path, strerror(errno));
+        return FALSE;
+    }
+    long size = -1;
+    if (fseek(in, 0, SEEK_END) == 0)
+        size = ftell(in);
+    if (size < (long)sizeof(HASH_SNAPSHOT_HEADER) || fseek(in, 0, SEEK_SET) != 0) {
+        n_log(LOG_ERR, "Can't use snapshot %s: unreadable or smaller than its header", path);
+        fclose(in);
+        return FALSE;
+    }
+    char* buffer = NULL;
+    Malloc(buffer, char, (size_t)size);
+    __n_assert(buffer, fclose(in); return FALSE);
+    if (fread(buffer, 1, (size_t)size, in) != (size_t)size) {
+        n_log(LOG_ERR, "Can't read snapshot %s", path);
+        Free(buffer);
+        fclose(in);
+        return FALSE;
+    }
+    fclose(in);
+    (*image) = buffer;
+    (*image_size) = (size_t)size;
+    return TRUE;
+#endif
+} /* _ht_snapshot_map(...) */
+
+/**
+ *@brief release an image mapped by _ht_snapshot_map
+ *@param image mapped image
+ *@param image_size size of the image
+ */
+void _ht_snapshot_unmap(const char* image, size_t image_size) {
+    if (!image)
+        return;
+#ifndef __windows__
+    munmap((void*)image, image_size);
+#else
+    (void)image_size;
+    char* buffer = (char*)image;
+    Free(buffer);
+#endif
+} /* _ht_snapshot_unmap(...) */
+
+/**
+ *@brief check the header of an image against its size, so that lookups only have to check the offsets they follow
+ *@param path image file, for the logs
+ *@param image mapped image
+ *@param image_size size of the image
+ *@return TRUE or FALSE
+ */
+int _ht_snapshot_check_image(const char* path, const char* image, size_t image_size) {
+    const HASH_SNAPSHOT_HEADER* header = (const HASH_SNAPSHOT_HEADER*)image;
+    if (memcmp(header->magic, HASH_SNAPSHOT_MAGIC, sizeof(HASH_SNAPSHOT_MAGIC)) != 0) {
+        n_log(LOG_ERR, "%s is not a snapshot image", path);
+        return FALSE;
+    }
+    if (header->version != HASH_SNAPSHOT_VERSION || header->hash_size != sizeof(HASH_VALUE) || header->byte_order != 0x01020304) {
+        n_log(LOG_ERR, "%s: snapshot version %u, hash size %u, byte order %x, expected %d, %zu, 1020304", path, header->version, header->hash_size, header->byte_order, HASH_SNAPSHOT_VERSION, sizeof(HASH_VALUE));
+        return FALSE;
+    }
+    if (header->file_size != image_size || header->slots_offset < sizeof(HASH_SNAPSHOT_HEADER) || header->slots_offset > image_size || header->slots_offset % sizeof(uint64_t) != 0) {
+        n_log(LOG_ERR, "%s: truncated or corrupted snapshot, %zu bytes", path, image_size);
+        return FALSE;
+    }
+    if (header->nb_slots == 0 || (header->nb_slots & (header->nb_slots - 1)) != 0 || header->nb_keys >= header->nb_slots || header->nb_slots != (image_size - header->slots_offset) / sizeof(HASH_SNAPSHOT_SLOT) || (image_size - header->slots_offset) % sizeof(HASH_SNAPSHOT_SLOT) != 0) {
+        n_log(LOG_ERR, "%s: corrupted snapshot, %zu slots for %zu keys", path, (size_t)header->nb_slots, (size_t)header->nb_keys);
+        return FALSE;
+    }
+    /* a null byte closing the pool stops any string read from it */
+    if (header->slots_offset > sizeof(HASH_SNAPSHOT_HEADER) && image[header->slots_offset - 1] != '\0') {
+        n_log(LOG_ERR, "%s: corrupted snapshot, unterminated string pool", path);
+        return FALSE;
+    }
+    return TRUE;
+} /* _ht_snapshot_check_image(...) */
+
+/**
+ *@brief return the associated key's node, HASH_SNAPSHOT mode. A key found in the image is first copied into the overlay, so that the returned node can be modified like the ones of the other modes.
+ *@param table targeted table
+ *@param key Associated value's key
+ *@return The found node, or NULL. The node is moved by the next put or remove in table.
+ */
+HASH_NODE* _ht_get_node_snapshot(HASH_TABLE* table, const char* key) {
+    __n_assert(table, return NULL);
+    __n_assert(key, return NULL);
+
+    if (key[0] == '\0')
+        return NULL;
+
+    HASH_NODE image_node;
+    HASH_NODE* node = _ht_snapshot_lookup(table, key, _ht_open_hash(table, key), &image_node);
+    if (node != &image_node)
+        return node;
+    if (_ht_duplicate_node(table->snapshot_overlay, &image_node) == FALSE)
+        return NULL;
+    return _ht_get_node_open(table->snapshot_overlay, key);
+} /* _ht_get_node_snapshot(...) */
+
+/**
+ *@brief get the value of key if it has the expected type, HASH_SNAPSHOT mode. Image values are read in place.
+ *@param table targeted table
+ *@param key associated value's key
+ *@param type expected type of the value
+ *@param val set to the value if key is found with the expected type
+ *@return TRUE or FALSE
+ */
+int _ht_snapshot_get(HASH_TABLE* table, const char* key, int type, union HASH_DATA* val) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    if (key[0] == '\0')
+        return FALSE;
+
+    HASH_NODE image_node;
+    const HASH_NODE* node = _ht_snapshot_lookup(table, key, _ht_open_hash(table, key), &image_node);
+    if (!node)
+        return FALSE;
+    if (node->type != type) {
+        HASH_NODE expected = {.type = type};
+        n_log(LOG_ERR, "Can't get key[\"%s\"] of type %s, key is type %s", key, ht_node_type(&expected), ht_node_type(node));
+        return FALSE;
+    }
+    (*val) = node->data;
+    return TRUE;
+} /* _ht_snapshot_get(...) */
+
+/**
+ *@brief Retrieve an integral value in the hash table, at the given key. Leave val untouched if key is not found. [SNAPSHOT HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to a destination integer
+ *@return TRUE or FALSE.
+ */
+int _ht_get_int_snapshot(HASH_TABLE* table, const char* key, HASH_INT_TYPE* val) {
+    union HASH_DATA data;
+    if (_ht_snapshot_get(table, key, HASH_INT, &data) == FALSE)
+        return FALSE;
+    (*val) = data.ival;
+    return TRUE;
+} /* _ht_get_int_snapshot(...) */
+
+/**
+ *@brief Retrieve a double value in the hash table, at the given key. Leave val untouched if key is not found. [SNAPSHOT HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to a destination double
+ *@return TRUE or FALSE.
+ */
+int _ht_get_double_snapshot(HASH_TABLE* table, const char* key, double* val) {
+    union HASH_DATA data;
+    if (_ht_snapshot_get(table, key, HASH_DOUBLE, &data) == FALSE)
+        return FALSE;
+    (*val) = data.fval;
+    return TRUE;
+} /* _ht_get_double_snapshot(...) */
+
+/**
+ *@brief Retrieve a pointer value in the hash table, at the given key. Leave val untouched if key is not found. [SNAPSHOT HASH TABLE]. Pointers are never in the image, only in the overlay.
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to an empty pointer store
+ *@return TRUE or FALSE.
+ */
+int _ht_get_ptr_snapshot(HASH_TABLE* table, const char* key, void** val) {
+    union HASH_DATA data;
+    if (_ht_snapshot_get(table, key, HASH_PTR, &data) == FALSE)
+        return FALSE;
+    (*val) = data.ptr;
+    return TRUE;
+} /* _ht_get_ptr_snapshot(...) */
+
+/**
+ *@brief Retrieve a char *string value in the hash table, at the given key. Leave val untouched if key is not found. [SNAPSHOT HASH TABLE]. Strings of the image are read only.
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param val A pointer to an empty destination char *string
+ *@return TRUE or FALSE.
+ */
+int _ht_get_string_snapshot(HASH_TABLE* table, const char* key, char** val) {
+    union HASH_DATA data;
+    if (_ht_snapshot_get(table, key, HASH_STRING, &data) == FALSE)
+        return FALSE;
+    (*val) = data.string;
+    return TRUE;
+} /* _ht_get_string_snapshot(...) */
+
+/**
+ *@brief check that key can be put with the given type, HASH_SNAPSHOT mode
+ *@param table targeted table
+ *@param key key to put
+ *@param hash_value hash value of key
+ *@param type type of the new value
+ *@param exists set to TRUE if key is already in the table, overlay or image
+ *@return TRUE, or FALSE if key already holds another type
+ */
+int _ht_snapshot_prepare_put(HASH_TABLE* table, const char* key, HASH_VALUE hash_value, int type, int* exists) {
+    HASH_NODE image_node;
+    const HASH_NODE* node = _ht_snapshot_lookup(table, key, hash_value, &image_node);
+    (*exists) = node ? TRUE : FALSE;
+    if (node && node->type != type) {
+        HASH_NODE expected = {.type = type};
+        n_log(LOG_ERR, "Can't add key[\"%s\"] with type %s, key already exist with type %s", key, ht_node_type(&expected), ht_node_type(node));
+        return FALSE;
+    }
+    return TRUE;
+} /* _ht_snapshot_prepare_put(...) */
+
+/**
+ *@brief account for a put into the overlay, HASH_SNAPSHOT mode
+ *@param table targeted table
+ *@param key key put
+ *@param exists value set by _ht_snapshot_prepare_put
+ *@param has_succeeded result of the overlay put
+ *@return has_succeeded
+ */
+int _ht_snapshot_commit_put(HASH_TABLE* table, const char* key, int exists, int has_succeeded) {
+    if (has_succeeded == FALSE || exists == TRUE)
+        return has_succeeded;
+    table->nb_keys++;
+    /* an image key put back after its removal is shadowed by the overlay again */
+    if (table->snapshot_removed->nb_keys > 0 && _ht_get_node_open(table->snapshot_removed, key))
+        _ht_remove_open(table->snapshot_removed, key);
+    return TRUE;
+} /* _ht_snapshot_commit_put(...) */
+
+/**
+ *@brief put an integral value with given key in the targeted hash table [SNAPSHOT HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param value integral value to put
+ *@return TRUE or FALSE
+ */
+int _ht_put_int_snapshot(HASH_TABLE* table, const char* key, HASH_INT_TYPE value) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    int exists = FALSE;
+    if (_ht_snapshot_prepare_put(table, key, _ht_open_hash(table, key), HASH_INT, &exists) == FALSE)
+        return FALSE;
+    return _ht_snapshot_commit_put(table, key, exists, _ht_put_int_open(table->snapshot_overlay, key, value));
+} /* _ht_put_int_snapshot(...) */
+
+/**
+ *@brief put a double value with given key in the targeted hash table [SNAPSHOT HASH TABLE]
+ *@param table targeted hash table
+ *@param key associated value's key
+ *@param value double value to put
+ *@return TRUE or FALSE
+ */
+int _ht_put_double_snapshot(HASH_TABLE* table, const char* key, double value) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    int exists = FALSE;
+    if (_ht_snapshot_prepare_put(table, key, _ht_open_hash(table, key), HASH_DOUBLE, &exists) == FALSE)
+        return FALSE;
+    return _ht_snapshot_commit_put(table, key, exists, _ht_put_double_open(table->snapshot_overlay, key, value));
+} /* _ht_put_double_snapshot(...) */
+
+/**
+ *@brief put a pointer value with a key already hashed in the targeted hash table [SNAPSHOT HASH TABLE]
+ *@param table targeted hash table
+ *@param key Associated value's key, not empty
+ *@param hash_value hash value of key, the overlay sharing the image seed
+ *@param ptr pointer value to put
+ *@param destructor Pointer to the ptr type destructor function. Leave to NULL if there isn't
+ *@param duplicator Pointer to the ptr type duplicator function. Leave to NULL if there isn't
+ *@return TRUE or FALSE
+ */
+int _ht_put_ptr_snapshot_hashed(HASH_TABLE* table, const char* key, HASH_VALUE hash_value, void* ptr, void (*destructor)(void* ptr), void* (*duplicator)(void* ptr)) {
+    int exists = FALSE;
+    if (_ht_snapshot_prepare_put(table, key, hash_value, HASH_PTR, &exists) == FALSE)
+        return FALSE;
+    return _ht_snapshot_commit_put(table, key, exists, _ht_put_ptr_open_hashed(table->snapshot_overlay, key, hash_value, ptr, destructor, duplicator));
+} /* _ht_put_ptr_snapshot_hashed(...) */
+
+/**
+ *@brief put a pointer value with given key in the targeted hash table [SNAPSHOT HASH TABLE]
+ *@param table targeted hash table
+ *@param key Associated value's key
+ *@param ptr pointer value to put
+ *@param destructor Pointer to the ptr type destructor function. Leave to NULL if there isn't
+ *@param duplicator Pointer to the ptr type duplicator function. Leave to NULL if there isn't
+ *@return TRUE or FALSE
+ */
+int _ht_put_ptr_snapshot(HASH_TABLE* table, const char* key, void* ptr, void (*destructor)(void* ptr), void* (*duplicator)(void* ptr)) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    if (key[0] == '\0')
+        return FALSE;
+    return _ht_put_ptr_snapshot_hashed(table, key, _ht_open_hash(table, key), ptr, destructor, duplicator);
+} /* _ht_put_ptr_snapshot(...) */
+
+/**
+ *@brief put a null terminated char *string with given key in the targeted hash table (copy of string) [SNAPSHOT HASH TABLE]
+ *@param table targeted hash table
+ *@param key Associated value's key
+ *@param string string value to put (will be strdup'ed)
+ *@return TRUE or FALSE
+ */
+int _ht_put_string_snapshot(HASH_TABLE* table, const char* key, char* string) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    int exists = FALSE;
+    if (_ht_snapshot_prepare_put(table, key, _ht_open_hash(table, key), HASH_STRING, &exists) == FALSE)
+        return FALSE;
+    return _ht_snapshot_commit_put(table, key, exists, _ht_put_string_open(table->snapshot_overlay, key, string));
+} /* _ht_put_string_snapshot(...) */
+
+/**
+ *@brief put a null terminated char *string with given key in the targeted hash table (pointer, the table takes ownership) [SNAPSHOT HASH TABLE]
+ *@param table targeted hash table
+ *@param key Associated value's key
+ *@param string string value to put
+ *@return TRUE or FALSE
+ */
+int _ht_put_string_ptr_snapshot(HASH_TABLE* table, const char* key, char* string) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    int exists = FALSE;
+    if (_ht_snapshot_prepare_put(table, key, _ht_open_hash(table, key), HASH_STRING, &exists) == FALSE)
+        return FALSE;
+    return _ht_snapshot_commit_put(table, key, exists, _ht_put_string_ptr_open(table->snapshot_overlay, key, string));
+} /* _ht_put_string_ptr_snapshot(...) */
+
+/**
+ *@brief Remove a key from a hash table [SNAPSHOT HASH TABLE]. Image keys are recorded as removed, the image itself is never written.
+ *@param table targeted hash table
+ *@param key Key to remove
+ *@return TRUE or FALSE.
+ */
+int _ht_remove_snapshot(HASH_TABLE* table, const char* key) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    if (key[0] == '\0')
+        return FALSE;
+
+    HASH_VALUE hash_value = _ht_open_hash(table, key);
+    HASH_NODE image_node;
+    if (!_ht_snapshot_lookup(table, key, hash_value, &image_node)) {
+        n_log(LOG_ERR, "Can't delete key[\"%s\"]: inexisting key", key);
+        return FALSE;
     }
-    n_log(LOG_ERR, "Can't delete key[\"%s\"]: inexisting key", key);
-    return FALSE;
-} /* ht_remove() */
+    if (_ht_snapshot_find_slot(table, key, hash_value) && _ht_put_int_open(table->snapshot_removed, key, 1) == FALSE)
+        return FALSE;
+    if (_ht_open_find_slot(table->snapshot_overlay, key, hash_value) != SIZE_MAX)
+        _ht_remove_open(table->snapshot_overlay, key);
+    table->nb_keys--;
+    return TRUE;
+} /* _ht_remove_snapshot(...) */
 
 /**
- *@brief Empty a hash table (CLASSIC mode)
+ *@brief Empty a hash table (SNAPSHOT mode). The image is unmapped, the table goes on as an empty overlay.
  *@param table targeted hash table
  *@return TRUE or FALSE.
  */
-int _empty_ht(HASH_TABLE* table) {
+int _empty_ht_snapshot(HASH_TABLE* table) {
     __n_assert(table, return FALSE);
 
-    HASH_VALUE index = 0;
-    for (index = 0; index < table->size; index++) {
-        while (table->hash_table[index] && table->hash_table[index]->start) {
-            HASH_NODE* hash_node = remove_list_node(table->hash_table[index], table->hash_table[index]->start, HASH_NODE);
-            _ht_node_destroy(hash_node);
-        }
-    }
+    _empty_ht_open(table->snapshot_overlay);
+    _empty_ht_open(table->snapshot_removed);
+    _ht_snapshot_unmap(table->snapshot_image, table->snapshot_image_size);
+    table->snapshot_image = NULL;
+    table->snapshot_image_size = 0;
+    table->snapshot_slots = NULL;
+    table->size = 0;
     table->nb_keys = 0;
     return TRUE;
-} /* empty_ht */
+} /* _empty_ht_snapshot(...) */
 
 /**
- *@brief Free and set the table to NULL
+ *@brief Free and set the table to NULL (SNAPSHOT mode). The image file is left untouched.
  *@param table targeted hash table
  *@return TRUE or FALSE.
  */
-int _destroy_ht(HASH_TABLE** table) {
+int _destroy_ht_snapshot(HASH_TABLE** table) {
     __n_assert(table && (*table), n_log(LOG_ERR, "Can't destroy table: already NULL"); return FALSE);
 
-    if ((*table)->hash_table) {
-        // empty_ht( (*table) );
-
-        HASH_VALUE it = 0;
-        for (it = 0; it < (*table)->size; it++) {
-            if ((*table)->hash_table[it])
-                list_destroy(&(*table)->hash_table[it]);
-        }
-        Free((*table)->hash_table);
-    }
+    if ((*table)->snapshot_overlay)
+        _destroy_ht_open(&(*table)->snapshot_overlay);
+    if ((*table)->snapshot_removed)
+        _destroy_ht_open(&(*table)->snapshot_removed);
+    _ht_snapshot_unmap((*table)->snapshot_image, (*table)->snapshot_image_size);
     Free((*table));
     return TRUE;
-} /* _destroy_ht */
+} /* _destroy_ht_snapshot(...) */
 
 /**
- *@brief Generic print func call for classic hash tables
+ *@brief Generic print func call for snapshot hash tables
  *@param table targeted hash table
  */
-void _ht_print(HASH_TABLE* table) {
+void _ht_print_snapshot(HASH_TABLE* table) {
     __n_assert(table, return);
-    __n_assert(table->hash_table, return);
-    // cppcheck-suppress constVariablePointer ; node is generated by ht_foreach macro
-    ht_foreach(node, table) {
-        const HASH_NODE* ht_node = (const HASH_NODE*)node->ptr;
-        printf("key:%s node:%s\n", ht_node->key, ht_node->key);
-    }
 
+    HT_FOREACH(node, table, { printf("key:%s type:%s\n", node->key, ht_node_type(node)); });
     return;
-} /* _ht_print(...) */
+} /* _ht_print_snapshot(...) */
 
 /**
- *@brief Search hash table's keys and apply a matching func to put results in the list
+ *@brief Search hash table's keys and apply a matching func to put results in the list [SNAPSHOT HASH TABLE]
  *@param table targeted table
  *@param node_is_matching pointer to a matching function to use
  *@return NULL or a LIST *list of HASH_NODE *elements
  */
-LIST* _ht_search(HASH_TABLE* table, int (*node_is_matching)(HASH_NODE* node)) {
+LIST* _ht_search_snapshot(HASH_TABLE* table, int (*node_is_matching)(HASH_NODE* node)) {
     __n_assert(table, return NULL);
 
     LIST* results = new_generic_list(MAX_LIST_ITEMS);
     __n_assert(results, return NULL);
 
-    ht_foreach(node, table) {
-        HASH_NODE* hnode = (HASH_NODE*)node->ptr;
-        if (node_is_matching(hnode) == TRUE) {
-            list_push(results, strdup(hnode->key), &free);
+    HT_FOREACH(node, table, {
+        if (node_is_matching(node) == TRUE) {
+            list_push(results, strdup(node->key), &free);
         }
-    }
+    });
 
     if (results->nb_items < 1)
         list_destroy(&results);
 
     return results;
-} /* _ht_search(...) */
+} /* _ht_search_snapshot(...) */
 
 /* Hash tables function pointers and common table type functions */
 
 /**
- *@brief create a TRIE hash table with the alphabet_size, each key value beeing decreased by alphabet_offset
+ *@brief create a TRIE hash table with the alphabet_size, each key value beeing decreased by alphabet_offset. Keys are stored in an adaptive radix tree, characters mapped past 255 are handled like the ones outside of the alphabet
  *@param alphabet_length of the alphabet
  *@param alphabet_offset offset of each character in a key (i.e: to have 'a->z' with 'a' starting at zero, offset must be 32.
  *@return NULL or the new allocated hash table
@@ -1982,6 +4674,7 @@ HASH_TABLE* new_ht_trie(size_t alphabet_length, size_t alphabet_offset) {
     table->ht_get_double = _ht_get_double_trie;
     table->ht_get_string = _ht_get_string_trie;
     table->ht_get_ptr = _ht_get_ptr_trie;
+    table->ht_get_node = _ht_get_node_trie;
     table->ht_remove = _ht_remove_trie;
     table->ht_search = _ht_search_trie;
     table->empty_ht = _empty_ht_trie;
@@ -1991,7 +4684,7 @@ HASH_TABLE* new_ht_trie(size_t alphabet_length, size_t alphabet_offset) {
     table->alphabet_length = alphabet_length;
     table->alphabet_offset = alphabet_offset;
 
-    table->root = _ht_new_node_trie(table, '\0');
+    table->root = _ht_art_new_node(HASH_ART_KIND4);
     if (!table->root) {
         n_log(LOG_ERR, "Couldn't allocate new_ht_trie with alphabet_length of %zu and alphabet offset of %zu", alphabet_length, alphabet_offset);
         Free(table);
@@ -2003,7 +4696,7 @@ HASH_TABLE* new_ht_trie(size_t alphabet_length, size_t alphabet_offset) {
 } /* new_ht_trie */
 
 /**
- *@brief Create a hash table with the given size
+ *@brief Create a hash table with the given size. It keeps its size unless resized, or given a load factor with ht_set_max_load to grow incrementally
  *@param size Size of the root hash node table
  *@return NULL or the new allocated hash table
  */
@@ -2020,6 +4713,11 @@ HASH_TABLE* new_ht(size_t size) {
     table->size = size;
     table->seed = (uint32_t)rand() % 100000;
     table->nb_keys = 0;
+    table->rehash_table = NULL;
+    table->rehash_size = 0;
+    table->rehash_index = 0;
+    table->max_load_percent = 0;
+    table->nb_cursors = 0;
     errno = 0;
     Malloc(table->hash_table, LIST*, size);
     // table -> hash_table = (LIST **)calloc( size, sizeof( LIST *) );
@@ -2061,11 +4759,327 @@ HASH_TABLE* new_ht(size_t size) {
     return table;
 } /* new_ht(...) */
 
+/**
+ *@brief Create a classic hash table with the given size and flags. With HT_ARENA the nodes, their bucket list nodes and the interned keys are carved from HASH_ARENA_BLOCK_SIZE blocks owned by the table: a put does no allocation once the blocks are warm, removed entries are recycled, and empty_ht / destroy_ht release the blocks in bulk. Interned keys are only reclaimed by empty_ht or destroy_ht.
+ *@param size Size of the root hash node table
+ *@param flags 0 or HT_ARENA
+ *@return NULL or the new allocated hash table
+ */
+HASH_TABLE* new_ht_ex(size_t size, unsigned int flags) {
+    if (flags & ~(unsigned int)HT_ARENA) {
+        n_log(LOG_ERR, "Invalid flags %u for new_ht_ex()", flags);
+        return NULL;
+    }
+    HASH_TABLE* table = new_ht(size);
+    __n_assert(table, return NULL);
+    table->flags = flags;
+    return table;
+} /* new_ht_ex(...) */
+
+/**
+ *@brief Create an open addressing hash table. Keys, cached hashes and values are stored inline in one flat array of slots, placed with Robin Hood probing. The table doubles when it gets over HASH_OPEN_MAX_LOAD_PERCENT. Be aware that the HASH_NODE returned by ht_get_node (or iterated by HT_FOREACH) are moved by any following put or remove.
+ *@param size Number of keys the table can hold before growing
+ *@return NULL or the new allocated hash table
+ */
+HASH_TABLE* new_ht_open(size_t size) {
+    HASH_TABLE* table = NULL;
+
+    if (size < 1 || size > SIZE_MAX / 100) {
+        n_log(LOG_ERR, "Invalid size %zu for new_ht_open()", size);
+        return NULL;
+    }
+    Malloc(table, HASH_TABLE, 1);
+    __n_assert(table, n_log(LOG_ERR, "Error allocating HASH_TABLE *table"); return NULL);
+
+    /* power of two number of slots so the home slot is a mask of the hash */
+    size_t nb_slots = HASH_OPEN_MIN_SIZE;
+    while (nb_slots * HASH_OPEN_MAX_LOAD_PERCENT < size * 100) {
+        nb_slots *= 2;
+    }
+
+    table->size = nb_slots;
+    table->seed = (uint32_t)rand() % 100000;
+    table->nb_keys = 0;
+    errno = 0;
+    Malloc(table->open_nodes, HASH_NODE, nb_slots);
+    __n_assert(table->open_nodes, n_log(LOG_ERR, "Can't allocate table -> open_nodes with size %zu !", nb_slots); Free(table); return NULL);
+    Malloc(table->open_dist, uint8_t, nb_slots);
+    __n_assert(table->open_dist, n_log(LOG_ERR, "Can't allocate table -> open_dist with size %zu !", nb_slots); Free(table->open_nodes); Free(table); return NULL);
+    table->mode = HASH_OPEN;
+
+    table->ht_put_int = _ht_put_int_open;
+    table->ht_put_double = _ht_put_double_open;
+    table->ht_put_ptr = _ht_put_ptr_open;
+    table->ht_put_string = _ht_put_string_open;
+    table->ht_put_string_ptr = _ht_put_string_ptr_open;
+    table->ht_get_int = _ht_get_int_open;
+    table->ht_get_double = _ht_get_double_open;
+    table->ht_get_string = _ht_get_string_open;
+    table->ht_get_ptr = _ht_get_ptr_open;
+    table->ht_get_node = _ht_get_node_open;
+    table->ht_remove = _ht_remove_open;
+    table->ht_search = _ht_search_open;
+    table->empty_ht = _empty_ht_open;
+    table->destroy_ht = _destroy_ht_open;
+    table->ht_print = _ht_print_open;
+
+    return table;
+} /* new_ht_open(...) */
+
+/**
+ *@brief Create a concurrent hash table split in nb_shards shards. Writers lock only the shard of their key, while readers never lock: they walk the bucket chains inside an epoch read section, and unlinked entries are freed once the readers that could see them have left. The shards do not grow, size should be close to the expected number of keys. String and pointer values returned by the get functions, and the HASH_NODE returned by ht_get_node, are freed some time after a concurrent put or remove of their key: with concurrent writers, get and use them between ht_concurrent_read_lock and ht_concurrent_read_unlock on the key.
+ *@param size Total number of buckets, spread over the shards
+ *@param nb_shards Number of shards, each one with its own writer lock
+ *@return NULL or the new allocated hash table
+ */
+HASH_TABLE* new_ht_concurrent(size_t size, size_t nb_shards) {
+    HASH_TABLE* table = NULL;
+
+    if (size < 1 || nb_shards < 1) {
+        n_log(LOG_ERR, "Invalid size %zu or nb_shards %zu for new_ht_concurrent()", size, nb_shards);
+        return NULL;
+    }
+    Malloc(table, HASH_TABLE, 1);
+    __n_assert(table, n_log(LOG_ERR, "Error allocating HASH_TABLE *table"); return NULL);
+
+    size_t shard_size = (size + nb_shards - 1) / nb_shards;
+
+    table->size = shard_size * nb_shards;
+    table->seed = (uint32_t)rand() % 100000;
+    table->nb_keys = 0;
+    errno = 0;
+    Malloc(table->shards, HASH_CONCURRENT_SHARD, nb_shards);
+    __n_assert(table->shards, n_log(LOG_ERR, "Can't allocate table -> shards with nb_shards %zu !", nb_shards); Free(table); return NULL);
+    for (size_t it = 0; it < nb_shards; it++) {
+        HASH_CONCURRENT_SHARD* shard = &table->shards[it];
+        Malloc(shard->buckets, HASH_CONCURRENT_ENTRY*, shard_size);
+        if (!shard->buckets) {
+            n_log(LOG_ERR, "Can't allocate table -> shards[ %zu ] with size %zu !", it, shard_size);
+            for (size_t it_delete = 0; it_delete < it; it_delete++) {
+                pthread_mutex_destroy(&table->shards[it_delete].lock);
+                Free(table->shards[it_delete].buckets);
+            }
+            Free(table->shards);
+            Free(table);
+            return NULL;
+        }
+        pthread_mutex_init(&shard->lock, NULL);
+        shard->size = shard_size;
+        shard->retire_threshold = HASH_CONCURRENT_RETIRE_BATCH;
+    }
+    table->nb_shards = nb_shards;
+    table->mode = HASH_CONCURRENT;
+
+    table->ht_put_int = _ht_put_int_concurrent;
+    table->ht_put_double = _ht_put_double_concurrent;
+    table->ht_put_ptr = _ht_put_ptr_concurrent;
+    table->ht_put_string = _ht_put_string_concurrent;
+    table->ht_put_string_ptr = _ht_put_string_ptr_concurrent;
+    table->ht_get_int = _ht_get_int_concurrent;
+    table->ht_get_double = _ht_get_double_concurrent;
+    table->ht_get_string = _ht_get_string_concurrent;
+    table->ht_get_ptr = _ht_get_ptr_concurrent;
+    table->ht_get_node = _ht_get_node_concurrent;
+    table->ht_remove = _ht_remove_concurrent;
+    table->ht_search = _ht_search_concurrent;
+    table->empty_ht = _empty_ht_concurrent;
+    table->destroy_ht = _destroy_ht_concurrent;
+    table->ht_print = _ht_print_concurrent;
+
+    return table;
+} /* new_ht_concurrent(...) */
+
+/**
+ *@brief write the keys and int, double or string values of a table to an image file that ht_open_snapshot maps without parsing it. Pointer values can't be saved and are skipped. The image is written to path.tmp, then renamed to path.
+ *@param table table to save, any mode
+ *@param path destination image file
+ *@return TRUE or FALSE
+ */
+int ht_save_snapshot(HASH_TABLE* table, const char* path) {
+    __n_assert(table, return FALSE);
+    __n_assert(path, return FALSE);
+
+    size_t nb_keys = 0;
+    size_t nb_skipped = 0;
+    HT_FOREACH(node, table, {
+        if (node->type == HASH_INT || node->type == HASH_DOUBLE || node->type == HASH_STRING) {
+            nb_keys++;
+        } else {
+            nb_skipped++;
+        }
+    });
+    if (nb_skipped > 0)
+        n_log(LOG_INFO, "%zu pointer values of table %p skipped, they can't be saved in a snapshot", nb_skipped, table);
+
+    size_t nb_slots = HASH_OPEN_MIN_SIZE;
+    while (nb_slots * HASH_SNAPSHOT_MAX_LOAD_PERCENT < nb_keys * 100) {
+        nb_slots *= 2;
+    }
+    HASH_SNAPSHOT_SLOT* slots = NULL;
+    Malloc(slots, HASH_SNAPSHOT_SLOT, nb_slots);
+    __n_assert(slots, n_log(LOG_ERR, "Can't allocate %zu snapshot slots", nb_slots); return FALSE);
+
+    size_t tmp_path_len = strlen(path) + 5;
+    char* tmp_path = NULL;
+    Malloc(tmp_path, char, tmp_path_len);
+    __n_assert(tmp_path, Free(slots); return FALSE);
+    snprintf(tmp_path, tmp_path_len, "%s.tmp", path);
+
+    FILE* out = fopen(tmp_path, "wb");
+    if (!out) {
+        n_log(LOG_ERR, "Can't open %s for writing: %s", tmp_path, strerror(errno));
+        Free(tmp_path);
+        Free(slots);
+        return FALSE;
+    }
+
+    /* header is rewritten once the layout is known, keys and strings are streamed right after it */
+    HASH_SNAPSHOT_HEADER header;
+    memset(&header, 0, sizeof(HASH_SNAPSHOT_HEADER));
+    int has_succeeded = (fwrite(&header, sizeof(HASH_SNAPSHOT_HEADER), 1, out) == 1) ? TRUE : FALSE;
+    uint64_t offset = sizeof(HASH_SNAPSHOT_HEADER);
+    size_t nb_written = 0;
+    HT_FOREACH(node, table, {
+        if (has_succeeded == FALSE)
+            break;
+        if (node->type == HASH_INT || node->type == HASH_DOUBLE || node->type == HASH_STRING) {
+            size_t key_len = strlen(node->key);
+            HASH_VALUE hash_value[2] = {0, 0};
+            MurmurHash(node->key, key_len, table->seed, &hash_value);
+            size_t index = hash_value[0] & (nb_slots - 1);
+            while (slots[index].key_offset != 0) {
+                index = (index + 1) & (nb_slots - 1);
+            }
+            HASH_SNAPSHOT_SLOT* slot = &slots[index];
+            slot->hash_value = hash_value[0];
+            slot->key_offset = offset;
+            slot->key_len = (uint32_t)key_len;
+            slot->type = (uint32_t)node->type;
+            if (key_len > UINT32_MAX || fwrite(node->key, 1, key_len + 1, out) != key_len + 1) {
+                has_succeeded = FALSE;
+            }
+            offset += key_len + 1;
+            if (node->type == HASH_INT) {
+                slot->value.ival = node->data.ival;
+            } else if (node->type == HASH_DOUBLE) {
+                slot->value.fval = node->data.fval;
+            } else if (node->data.string) {
+                size_t string_len = strlen(node->data.string) + 1;
+                slot->value.string_offset = offset;
+                if (fwrite(node->data.string, 1, string_len, out) != string_len) {
+                    has_succeeded = FALSE;
+                }
+                offset += string_len;
+            }
+            nb_written++;
+        }
+    });
+
+    /* the slots are read in place and must be aligned */
+    static const char padding[sizeof(uint64_t)] = {0};
+    size_t padding_len = (size_t)((sizeof(uint64_t) - offset % sizeof(uint64_t)) % sizeof(uint64_t));
+    if (has_succeeded == TRUE && padding_len > 0 && fwrite(padding, 1, padding_len, out) != padding_len)
+        has_succeeded = FALSE;
+    offset += padding_len;
+    if (has_succeeded == TRUE && fwrite(slots, sizeof(HASH_SNAPSHOT_SLOT), nb_slots, out) != nb_slots)
+        has_succeeded = FALSE;
+
+    memcpy(header.magic, HASH_SNAPSHOT_MAGIC, sizeof(HASH_SNAPSHOT_MAGIC));
+    header.version = HASH_SNAPSHOT_VERSION;
+    header.hash_size = sizeof(HASH_VALUE);
+    header.byte_order = 0x01020304;
+    header.seed = table->seed;
+    header.nb_keys = nb_written;
+    header.nb_slots = nb_slots;
+    header.slots_offset = offset;
+    header.file_size = offset + nb_slots * sizeof(HASH_SNAPSHOT_SLOT);
+    if (has_succeeded == TRUE && (fseek(out, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(HASH_SNAPSHOT_HEADER), 1, out) != 1))
+        has_succeeded = FALSE;
+    if (fclose(out) != 0)
+        has_succeeded = FALSE;
+    Free(slots);
+
+    if (has_succeeded == TRUE && rename(tmp_path, path) != 0) {
+        n_log(LOG_ERR, "Can't rename %s to %s: %s", tmp_path, path, strerror(errno));
+        has_succeeded = FALSE;
+    }
+    if (has_succeeded == FALSE) {
+        n_log(LOG_ERR, "Can't write snapshot %s of table %p", path, table);
+        unlink(tmp_path);
+    }
+    Free(tmp_path);
+    return has_succeeded;
+} /* ht_save_snapshot(...) */
+
+/**
+ *@brief open an image file written by ht_save_snapshot as a HASH_SNAPSHOT table. The image is memory mapped read only and queried in place, its pages being loaded on first access. Puts and removes go to an in memory overlay, ht_save_snapshot writing back the merged content.
+ *@param path image file
+ *@return NULL or the new allocated hash table
+ */
+HASH_TABLE* ht_open_snapshot(const char* path) {
+    __n_assert(path, return NULL);
+
+    const char* image = NULL;
+    size_t image_size = 0;
+    if (_ht_snapshot_map(path, &image, &image_size) == FALSE)
+        return NULL;
+    if (_ht_snapshot_check_image(path, image, image_size) == FALSE) {
+        _ht_snapshot_unmap(image, image_size);
+        return NULL;
+    }
+    const HASH_SNAPSHOT_HEADER* header = (const HASH_SNAPSHOT_HEADER*)image;
+
+    HASH_TABLE* table = NULL;
+    Malloc(table, HASH_TABLE, 1);
+    __n_assert(table, n_log(LOG_ERR, "Error allocating HASH_TABLE *table"); _ht_snapshot_unmap(image, image_size); return NULL);
+
+    table->snapshot_overlay = new_ht_open(HASH_OPEN_MIN_SIZE);
+    table->snapshot_removed = new_ht_open(HASH_OPEN_MIN_SIZE);
+    if (!table->snapshot_overlay || !table->snapshot_removed) {
+        n_log(LOG_ERR, "Can't allocate the overlay of snapshot %s", path);
+        if (table->snapshot_overlay)
+            _destroy_ht_open(&table->snapshot_overlay);
+        if (table->snapshot_removed)
+            _destroy_ht_open(&table->snapshot_removed);
+        _ht_snapshot_unmap(image, image_size);
+        Free(table);
+        return NULL;
+    }
+    table->seed = (size_t)header->seed;
+    /* one hash per key serves the overlay, removed and image lookups */
+    table->snapshot_overlay->seed = table->seed;
+    table->snapshot_removed->seed = table->seed;
+    table->size = (size_t)header->nb_slots;
+    table->nb_keys = (size_t)header->nb_keys;
+    table->snapshot_image = image;
+    table->snapshot_image_size = image_size;
+    table->snapshot_slots = (const HASH_SNAPSHOT_SLOT*)(image + header->slots_offset);
+    table->mode = HASH_SNAPSHOT;
+
+    table->ht_put_int = _ht_put_int_snapshot;
+    table->ht_put_double = _ht_put_double_snapshot;
+    table->ht_put_ptr = _ht_put_ptr_snapshot;
+    table->ht_put_string = _ht_put_string_snapshot;
+    table->ht_put_string_ptr = _ht_put_string_ptr_snapshot;
+    table->ht_get_int = _ht_get_int_snapshot;
+    table->ht_get_double = _ht_get_double_snapshot;
+    table->ht_get_string = _ht_get_string_snapshot;
+    table->ht_get_ptr = _ht_get_ptr_snapshot;
+    table->ht_get_node = _ht_get_node_snapshot;
+    table->ht_remove = _ht_remove_snapshot;
+    table->ht_search = _ht_search_snapshot;
+    table->empty_ht = _empty_ht_snapshot;
+    table->destroy_ht = _destroy_ht_snapshot;
+    table->ht_print = _ht_print_snapshot;
+
+    return table;
+} /* ht_open_snapshot(...) */
+
 /**
  *@brief get node at 'key' from 'table'
  *@param table targeted table
  *@param key key to retrieve
- *@return NULL or the matching HASH_NODE *node
+ *@return NULL or the matching HASH_NODE *node. On a HASH_CONCURRENT table with concurrent writers, the node is only safe to use while holding ht_concurrent_read_lock on key
  */
 HASH_NODE* ht_get_node(HASH_TABLE* table, const char* key) {
     __n_assert(table, return NULL);
@@ -2103,7 +5117,7 @@ int ht_get_int(HASH_TABLE* table, const char* key, HASH_INT_TYPE* val) {
  *@brief get pointer at 'key' from 'table'
  *@param table targeted table
  *@param key key to retrieve
- *@param val pointer to pointer storage
+ *@param val pointer to pointer storage. On a HASH_CONCURRENT table with concurrent writers, the pointer is only safe to use while holding ht_concurrent_read_lock on key
  *@return TRUE if found, else FALSE. 'val' value is preserved if no key is matching.
  */
 int ht_get_ptr(HASH_TABLE* table, const char* key, void** val) {
@@ -2116,7 +5130,7 @@ int ht_get_ptr(HASH_TABLE* table, const char* key, void** val) {
  *@brief get string at 'key' from 'table'
  *@param table targeted table
  *@param key key to retrieve
- *@param val pointer to string storage
+ *@param val pointer to string storage. On a HASH_CONCURRENT table with concurrent writers, the string is only safe to use while holding ht_concurrent_read_lock on key
  *@return TRUE if found, else FALSE. 'val' value is preserved if no key is matching.
  */
 int ht_get_string(HASH_TABLE* table, const char* key, char** val) {
@@ -2245,6 +5259,274 @@ int destroy_ht(HASH_TABLE** table) {
     return (*table)->destroy_ht(table);
 } /* destroy_ht(...) */
 
+/**
+ *@brief hash a batch of keys and prefetch the memory their lookup will touch first, so that the cache misses of the whole batch overlap instead of being paid one key after the other
+ *@param table targeted table
+ *@param keys array of nb keys
+ *@param nb number of keys, at most HASH_BATCH_SIZE
+ *@param hashes set to the hash value of each key, not set for NULL or empty keys nor in HASH_TRIE mode
+ */
+void _ht_prefetch_batch(const HASH_TABLE* table, const char* const* keys, size_t nb, HASH_VALUE* hashes) {
+    HASH_VALUE hash_value[2] = {0, 0};
+    if (table->mode == HASH_TRIE)
+        return;
+    for (size_t it = 0; it < nb; it++) {
+        if (!keys[it] || keys[it][0] == '\0')
+            continue;
+        MurmurHash(keys[it], strlen(keys[it]), table->seed, &hash_value);
+        hashes[it] = hash_value[0];
+        switch (table->mode) {
+            case HASH_CLASSIC:
+                __builtin_prefetch(&table->hash_table[hashes[it] % table->size], 0, 1);
+                if (table->rehash_table)
+                    __builtin_prefetch(&table->rehash_table[hashes[it] % table->rehash_size], 0, 1);
+                break;
+            case HASH_OPEN:
+                __builtin_prefetch(&table->open_dist[hashes[it] & (table->size - 1)], 0, 1);
+                __builtin_prefetch(&table->open_nodes[hashes[it] & (table->size - 1)], 0, 1);
+                break;
+            case HASH_CONCURRENT: {
+                const HASH_CONCURRENT_SHARD* shard = &table->shards[hashes[it] % table->nb_shards];
+                __builtin_prefetch(&shard->buckets[(hashes[it] / table->nb_shards) % shard->size], 0, 1);
+                break;
+            }
+            case HASH_SNAPSHOT:
+                if (table->snapshot_slots)
+                    __builtin_prefetch(&table->snapshot_slots[hashes[it] & (table->size - 1)], 0, 1);
+                break;
+            default:
+                break;
+        }
+    }
+    if (table->mode != HASH_CLASSIC)
+        return;
+    /* classic buckets are two dependent loads away from the node: prefetch the lists, then their first node */
+    for (size_t it = 0; it < nb; it++) {
+        if (!keys[it] || keys[it][0] == '\0')
+            continue;
+        const LIST* list = table->hash_table[hashes[it] % table->size];
+        if (list)
+            __builtin_prefetch(list, 0, 1);
+    }
+    for (size_t it = 0; it < nb; it++) {
+        if (!keys[it] || keys[it][0] == '\0')
+            continue;
+        const LIST* list = table->hash_table[hashes[it] % table->size];
+        if (list && list->start) {
+            __builtin_prefetch(list->start, 0, 1);
+            __builtin_prefetch(list->start->ptr, 0, 1);
+        }
+    }
+} /* _ht_prefetch_batch(...) */
+
+/**
+ *@brief get the pointer values of nb keys. Keys are hashed and their buckets prefetched by batches of HASH_BATCH_SIZE before being resolved. HASH_TRIE tables are resolved one key after the other.
+ *@param table targeted table
+ *@param keys array of nb keys
+ *@param nb number of keys
+ *@param values destination array of nb values, NULL for the keys not found or not holding a HASH_PTR. On a HASH_CONCURRENT table with concurrent writers, a value is only safe to use while holding ht_concurrent_read_lock on its key
+ *@return the number of keys found
+ */
+size_t ht_get_ptr_many(HASH_TABLE* table, const char* const* keys, size_t nb, void** values) {
+    __n_assert(table, return 0);
+    __n_assert(keys, return 0);
+    __n_assert(values, return 0);
+
+    size_t nb_found = 0;
+    HASH_VALUE hashes[HASH_BATCH_SIZE];
+    for (size_t base = 0; base < nb; base += HASH_BATCH_SIZE) {
+        size_t batch = (nb - base < HASH_BATCH_SIZE) ? nb - base : HASH_BATCH_SIZE;
+        _ht_prefetch_batch(table, keys + base, batch, hashes);
+        for (size_t it = 0; it < batch; it++) {
+            const char* key = keys[base + it];
+            const HASH_NODE* node = NULL;
+            values[base + it] = NULL;
+            if (!key || key[0] == '\0')
+                continue;
+            switch (table->mode) {
+                case HASH_CLASSIC: {
+                    const LIST_NODE* list_node = _ht_find_list_node(table, key, hashes[it], NULL);
+                    if (list_node)
+                        node = (const HASH_NODE*)list_node->ptr;
+                    break;
+                }
+                case HASH_OPEN: {
+                    size_t index = _ht_open_find_slot(table, key, hashes[it]);
+                    if (index != SIZE_MAX)
+                        node = &table->open_nodes[index];
+                    break;
+                }
+                case HASH_CONCURRENT: {
+                    HASH_CONCURRENT_SHARD* shard = &table->shards[hashes[it] % table->nb_shards];
+                    size_t parity = ht_concurrent_read_enter(shard);
+                    const HASH_CONCURRENT_ENTRY* entry = _ht_concurrent_find(shard, (hashes[it] / table->nb_shards) % shard->size, key, hashes[it], NULL);
+                    if (entry && entry->node.type == HASH_PTR) {
+                        values[base + it] = entry->node.data.ptr;
+                        nb_found++;
+                    }
+                    ht_concurrent_read_exit(shard, parity);
+                    continue;
+                }
+                case HASH_TRIE:
+                    node = _ht_get_node_trie(table, key);
+                    break;
+                case HASH_SNAPSHOT: {
+                    HASH_NODE image_node;
+                    node = _ht_snapshot_lookup(table, key, hashes[it], &image_node);
+                    /* the image never holds pointers, image_node is not used past this point */
+                    if (node == &image_node)
+                        node = NULL;
+                    break;
+                }
+                default:
+                    break;
+            }
+            if (node && node->type == HASH_PTR) {
+                values[base + it] = node->data.ptr;
+                nb_found++;
+            }
+        }
+    }
+    return nb_found;
+} /* ht_get_ptr_many(...) */
+
+/**
+ *@brief put nb pointer values at their keys, replacing the previous values. Keys are hashed and their buckets prefetched by batches of HASH_BATCH_SIZE, then inserted with these hashes. HASH_TRIE tables are filled one key after the other. NULL and empty keys are skipped.
+ *@param table targeted table
+ *@param keys array of nb keys
+ *@param nb number of keys
+ *@param values array of nb pointer values
+ *@param destructor pointer to a destructor function or NULL, used for all the values
+ *@param duplicator pointer to a duplicator function or NULL, used for all the values
+ *@return the number of values put
+ */
+size_t ht_put_ptr_many(HASH_TABLE* table, const char* const* keys, size_t nb, void* const* values, void (*destructor)(void* ptr), void* (*duplicator)(void* ptr)) {
+    __n_assert(table, return 0);
+    __n_assert(keys, return 0);
+    __n_assert(values, return 0);
+
+    size_t nb_put = 0;
+    HASH_VALUE hashes[HASH_BATCH_SIZE];
+    for (size_t base = 0; base < nb; base += HASH_BATCH_SIZE) {
+        size_t batch = (nb - base < HASH_BATCH_SIZE) ? nb - base : HASH_BATCH_SIZE;
+        _ht_prefetch_batch(table, keys + base, batch, hashes);
+        for (size_t it = 0; it < batch; it++) {
+            const char* key = keys[base + it];
+            if (!key || key[0] == '\0')
+                continue;
+            int has_put = FALSE;
+            switch (table->mode) {
+                case HASH_CLASSIC:
+                    has_put = _ht_put_ptr_hashed(table, key, hashes[it], values[base + it], destructor, duplicator);
+                    break;
+                case HASH_OPEN:
+                    has_put = _ht_put_ptr_open_hashed(table, key, hashes[it], values[base + it], destructor, duplicator);
+                    break;
+                case HASH_CONCURRENT: {
+                    HASH_NODE node;
+                    memset(&node, 0, sizeof(HASH_NODE));
+                    node.type = HASH_PTR;
+                    node.data.ptr = values[base + it];
+                    node.destroy_func = destructor;
+                    node.duplicate_func = duplicator;
+                    has_put = _ht_concurrent_put_hashed(table, key, hashes[it], &node);
+                    break;
+                }
+                case HASH_SNAPSHOT:
+                    has_put = _ht_put_ptr_snapshot_hashed(table, key, hashes[it], values[base + it], destructor, duplicator);
+                    break;
+                default:
+                    has_put = table->ht_put_ptr(table, key, values[base + it], destructor, duplicator);
+                    break;
+            }
+            if (has_put == TRUE)
+                nb_put++;
+        }
+    }
+    return nb_put;
+} /* ht_put_ptr_many(...) */
+
+/**
+ *@brief get the hash of a key as computed by a table, to look it up later with ht_get_string_hashed. The hash only depends on the seed of the table, tables with the same seed give the same hash
+ *@param table targeted table
+ *@param key key to hash
+ *@param len length of key
+ *@return the hash of key, 0 for HASH_TRIE tables which do not hash their keys
+ */
+HASH_VALUE ht_hash_key(const HASH_TABLE* table, const char* key, size_t len) {
+    __n_assert(table, return 0);
+    __n_assert(key, return 0);
+    if (table->mode == HASH_TRIE)
+        return 0;
+    HASH_VALUE hash_value[2] = {0, 0};
+    MurmurHash(key, len, table->seed, &hash_value);
+    return hash_value[0];
+} /* ht_hash_key(...) */
+
+/**
+ *@brief get a string value from a key and its hash given by ht_hash_key, saving the hashing of the key
+ *@param table targeted table
+ *@param key key to retrieve
+ *@param hash_value hash of key given by ht_hash_key for this table or a table with the same seed
+ *@param val pointer to the string value. On a HASH_CONCURRENT table with concurrent writers, it is only safe to use while holding ht_concurrent_read_lock_hashed on hash_value
+ *@return TRUE or FALSE
+ */
+int ht_get_string_hashed(HASH_TABLE* table, const char* key, HASH_VALUE hash_value, char** val) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+    __n_assert(val, return FALSE);
+
+    if (key[0] == '\0')
+        return FALSE;
+
+    const HASH_NODE* node = NULL;
+    HASH_NODE found = {.type = 0};
+    switch (table->mode) {
+        case HASH_CLASSIC: {
+            const LIST_NODE* list_node = _ht_find_list_node(table, key, hash_value, NULL);
+            if (list_node)
+                node = (const HASH_NODE*)list_node->ptr;
+            break;
+        }
+        case HASH_OPEN: {
+            size_t index = _ht_open_find_slot(table, key, hash_value);
+            if (index != SIZE_MAX)
+                node = &table->open_nodes[index];
+            break;
+        }
+        case HASH_CONCURRENT: {
+            HASH_CONCURRENT_SHARD* shard = &table->shards[hash_value % table->nb_shards];
+            size_t parity = ht_concurrent_read_enter(shard);
+            const HASH_CONCURRENT_ENTRY* entry = _ht_concurrent_find(shard, (hash_value / table->nb_shards) % shard->size, key, hash_value, NULL);
+            /* only the node fields are copied, the string stays owned by the entry and is only safe while the caller holds ht_concurrent_read_lock_hashed */
+            if (entry) {
+                found = entry->node;
+                node = &found;
+            }
+            ht_concurrent_read_exit(shard, parity);
+            break;
+        }
+        case HASH_TRIE:
+            node = _ht_get_node_trie(table, key);
+            break;
+        case HASH_SNAPSHOT:
+            node = _ht_snapshot_lookup(table, key, hash_value, &found);
+            break;
+        default:
+            n_log(LOG_ERR, "unsupported mode %d", table->mode);
+            return FALSE;
+    }
+    if (!node)
+        return FALSE;
+
+    if (node->type != HASH_STRING) {
+        n_log(LOG_ERR, "Can't get key[\"%s\"] of type HASH_STRING, key is type %s", key, ht_node_type(node));
+        return FALSE;
+    }
+    (*val) = node->data.string;
+    return TRUE;
+} /* ht_get_string_hashed(...) */
+
 /**
  *@brief return the associated key's node inside the hash_table (HASH_CLASSIC only)
  *@param table Targeted hash table
@@ -2255,18 +5537,10 @@ HASH_NODE* ht_get_node_ex(HASH_TABLE* table, HASH_VALUE hash_value) {
     __n_assert(table, return NULL);
     __n_assert(table->mode == HASH_CLASSIC, return NULL);
 
-    size_t index = (hash_value) % (table->size);
-    if (!table->hash_table[index]->start) {
+    LIST_NODE* list_node = _ht_find_list_node(table, NULL, hash_value, NULL);
+    if (!list_node)
         return NULL;
-    }
-
-    list_foreach(list_node, table->hash_table[index]) {
-        HASH_NODE* node_ptr = (HASH_NODE*)list_node->ptr;
-        if (hash_value == node_ptr->hash_value) {
-            return node_ptr;
-        }
-    }
-    return NULL;
+    return (HASH_NODE*)list_node->ptr;
 } /* ht_get_node_ex() */
 
 /**
@@ -2307,35 +5581,28 @@ int ht_put_ptr_ex(HASH_TABLE* table, HASH_VALUE hash_value, void* val, void (*de
     __n_assert(table, return FALSE);
     __n_assert(table->mode == HASH_CLASSIC, return FALSE);
 
-    size_t index = 0;
     HASH_NODE* new_hash_node = NULL;
-    HASH_NODE* node_ptr = NULL;
 
-    index = (hash_value) % (table->size);
-
-    /* we have some nodes here. Let's check if the key already exists */
-    list_foreach(list_node, table->hash_table[index]) {
-        node_ptr = (HASH_NODE*)list_node->ptr;
-        /* if we found the same key we just replace the value and return */
-        if (hash_value == node_ptr->hash_value) {
-            /* let's check the key isn't already assigned with another data type */
-            if (node_ptr->type == HASH_PTR) {
-                if (node_ptr->destroy_func && node_ptr->data.ptr) {
-                    node_ptr->destroy_func(node_ptr->data.ptr);
-                } else if (!node_ptr->destroy_func && node_ptr->data.ptr) {
-                    n_log(LOG_ERR, "Can't free previous key[\"%s\"] with type HASH_PTR , no hash node destroy func", node_ptr->key);
-                }
-                node_ptr->destroy_func = destructor;
-                node_ptr->duplicate_func = duplicator;
-                node_ptr->data.ptr = val;
-                return TRUE;
+    /* if we found the same key we just replace the value and return */
+    HASH_NODE* node_ptr = ht_get_node_ex(table, hash_value);
+    if (node_ptr) {
+        /* let's check the key isn't already assigned with another data type */
+        if (node_ptr->type == HASH_PTR) {
+            if (node_ptr->destroy_func && node_ptr->data.ptr) {
+                node_ptr->destroy_func(node_ptr->data.ptr);
+            } else if (!node_ptr->destroy_func && node_ptr->data.ptr) {
+                n_log(LOG_ERR, "Can't free previous key[\"%s\"] with type HASH_PTR , no hash node destroy func", node_ptr->key);
             }
-            n_log(LOG_ERR, "Can't add key[\"%s\"] with type HASH_PTR , key already exist with type %s", node_ptr->key, ht_node_type(node_ptr));
-            return FALSE; /* key registered with another data type */
+            node_ptr->destroy_func = destructor;
+            node_ptr->duplicate_func = duplicator;
+            node_ptr->data.ptr = val;
+            return TRUE;
         }
+        n_log(LOG_ERR, "Can't add key[\"%s\"] with type HASH_PTR , key already exist with type %s", node_ptr->key, ht_node_type(node_ptr));
+        return FALSE; /* key registered with another data type */
     }
 
-    Malloc(new_hash_node, HASH_NODE, 1);
+    new_hash_node = _ht_node_alloc(table);
     __n_assert(new_hash_node, n_log(LOG_ERR, "Could not allocate new_hash_node"); return FALSE);
 
     new_hash_node->key = NULL;
@@ -2345,9 +5612,13 @@ int ht_put_ptr_ex(HASH_TABLE* table, HASH_VALUE hash_value, void* val, void (*de
     new_hash_node->destroy_func = destructor;
     new_hash_node->duplicate_func = duplicator;
 
-    table->nb_keys++;
-
-    return list_push(table->hash_table[index], new_hash_node, &_ht_node_destroy);
+    if (_ht_push_node(table, new_hash_node) == FALSE) {
+        /* val stays owned by the caller */
+        new_hash_node->destroy_func = NULL;
+        _ht_node_release(table, new_hash_node);
+        return FALSE;
+    }
+    return TRUE;
 } /* ht_put_ptr_ex() */
 
 /**
@@ -2360,27 +5631,20 @@ int ht_remove_ex(HASH_TABLE* table, HASH_VALUE hash_value) {
     __n_assert(table, return FALSE);
     __n_assert(table->mode == HASH_CLASSIC, return FALSE);
 
-    size_t index = 0;
-    HASH_NODE* node_ptr = NULL;
+    LIST* bucket = NULL;
     LIST_NODE* node_to_kill = NULL;
 
-    index = (hash_value) % (table->size);
-    if (!table->hash_table[index]->start) {
+    ht_rehash_step(table, HASH_REHASH_STEP_BUCKETS);
+
+    if (table->nb_keys == 0) {
         n_log(LOG_ERR, "Can't remove key[\"%zu\"], table is empty", hash_value);
         return FALSE;
     }
 
-    list_foreach(list_node, table->hash_table[index]) {
-        node_ptr = (HASH_NODE*)list_node->ptr;
-        /* if we found the same */
-        if (hash_value == node_ptr->hash_value) {
-            node_to_kill = list_node;
-            break;
-        }
-    }
+    node_to_kill = _ht_find_list_node(table, NULL, hash_value, &bucket);
     if (node_to_kill) {
-        node_ptr = remove_list_node(table->hash_table[index], node_to_kill, HASH_NODE);
-        _ht_node_destroy(node_ptr);
+        HASH_NODE* node_ptr = _ht_unlink_node(table, bucket, node_to_kill);
+        _ht_node_release(table, node_ptr);
 
         table->nb_keys--;
 
@@ -2403,19 +5667,17 @@ LIST* ht_get_completion_list(HASH_TABLE* table, const char* keybud, size_t max_r
 
     LIST* results = new_generic_list(max_results);
     if (table->mode == HASH_TRIE) {
-        HASH_NODE* node = _ht_get_node_trie(table, keybud);
-        if (node) {
+        const void* subtree = (keybud[0] != '\0') ? _ht_art_find_prefix(table, keybud, NULL) : NULL;
+        if (subtree) {
             if (list_push(results, strdup(keybud), &free) == TRUE) {
-                _ht_depth_first_search(node, results);
+                _ht_art_collect_keys(subtree, results, keybud);
             }
         } else {
-            node = table->root;
-            for (size_t it = 0; it < table->alphabet_length; it++) {
-                if (node->children[it]) {
-                    char new_keybud[3] = "";
-                    new_keybud[0] = (char)(it + table->alphabet_offset);
-                    list_push(results, strdup(new_keybud), &free);
-                }
+            size_t byte = 0;
+            for (const void* child = ht_art_next_child(table->root, &byte); child; byte++, child = ht_art_next_child(table->root, &byte)) {
+                char new_keybud[3] = "";
+                new_keybud[0] = (char)(byte + table->alphabet_offset);
+                list_push(results, strdup(new_keybud), &free);
             }
         }
     } else if (table->mode == HASH_CLASSIC) {
@@ -2429,6 +5691,26 @@ LIST* ht_get_completion_list(HASH_TABLE* table, const char* keybud, size_t max_r
                 }
             }
         }
+    } else if (table->mode == HASH_OPEN) {
+        for (size_t it = 0; it < table->size; it++) {
+            if (table->open_dist[it] != 0 && strncasecmp(keybud, table->open_nodes[it].key, strlen(keybud)) == 0) {
+                char* key = strdup(table->open_nodes[it].key);
+                if (list_push(results, key, &free) == FALSE) {
+                    n_log(LOG_ERR, "not enough space in list or memory error, key %s not pushed !", key);
+                    Free(key);
+                }
+            }
+        }
+    } else if (table->mode == HASH_CONCURRENT || table->mode == HASH_SNAPSHOT) {
+        HT_FOREACH(hnode, table, {
+            if (strncasecmp(keybud, hnode->key, strlen(keybud)) == 0) {
+                char* key = strdup(hnode->key);
+                if (list_push(results, key, &free) == FALSE) {
+                    n_log(LOG_ERR, "not enough space in list or memory error, key %s not pushed !", key);
+                    Free(key);
+                }
+            }
+        });
     } else {
         n_log(LOG_ERR, "unsupported mode %d", table->mode);
         list_destroy(&results);
@@ -2439,6 +5721,510 @@ LIST* ht_get_completion_list(HASH_TABLE* table, const char* keybud, size_t max_r
     return results;
 } /* ht_get_completion_list(...) */
 
+/**
+ *@brief recursive, set the weight of the leaf of key and update the highest weights on its path, HASH_TRIE mode
+ *@param table targeted table
+ *@param ptr inner node or tagged leaf to search from
+ *@param key key of the leaf
+ *@param len length of key
+ *@param depth position in key of ptr
+ *@param weight new weight of the leaf
+ *@param old_weight set to the previous weight of the leaf
+ *@return NULL or the updated leaf
+ */
+HASH_NODE* _ht_art_set_weight(const HASH_TABLE* table, void* ptr, const char* key, size_t len, size_t depth, size_t weight, size_t* old_weight) {
+    if (!ptr)
+        return NULL;
+    if (HASH_ART_IS_LEAF(ptr)) {
+        HASH_NODE* leaf = HASH_ART_LEAF(ptr);
+        if (_ht_art_key_equal(table, leaf->key, key) == FALSE)
+            return NULL;
+        (*old_weight) = HASH_ART_WEIGHT(leaf);
+        HASH_ART_WEIGHT(leaf) = weight;
+        return leaf;
+    }
+
+    HASH_ART_NODE* node = (HASH_ART_NODE*)ptr;
+    if (node->prefix_len > 0) {
+        if (_ht_art_prefix_mismatch(table, node, key, len, depth) != node->prefix_len)
+            return NULL;
+        depth += node->prefix_len;
+    }
+    HASH_NODE* leaf = NULL;
+    if (depth == len) {
+        leaf = node->leaf ? _ht_art_set_weight(table, HASH_ART_TAG_LEAF(node->leaf), key, len, depth, weight, old_weight) : NULL;
+    } else {
+        void** child = _ht_art_find_child(node, _ht_art_byte(table, key, depth));
+        leaf = child ? _ht_art_set_weight(table, (*child), key, len, depth + 1, weight, old_weight) : NULL;
+    }
+    if (!leaf)
+        return NULL;
+    if (weight >= node->max_weight) {
+        node->max_weight = weight;
+    } else if ((*old_weight) == node->max_weight) {
+        _ht_art_refresh_weight(node);
+    }
+    return leaf;
+} /* _ht_art_set_weight(...) */
+
+/**
+ *@brief set the completion weight of a key, used to rank the results of ht_get_completion_list_ranked. Keys are put with a weight of 0. HASH_TRIE mode only.
+ *@param table targeted table
+ *@param key key of an existing node
+ *@param weight new weight of the key
+ *@return TRUE or FALSE
+ */
+int ht_trie_set_weight(HASH_TABLE* table, const char* key, size_t weight) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    if (table->mode != HASH_TRIE) {
+        n_log(LOG_ERR, "table %p is not a HASH_TRIE table", table);
+        return FALSE;
+    }
+    size_t old_weight = 0;
+    if (!_ht_art_set_weight(table, table->root, key, strlen(key), 0, weight, &old_weight)) {
+        n_log(LOG_DEBUG, "key %s not found in table %p", key, table);
+        return FALSE;
+    }
+    return TRUE;
+} /* ht_trie_set_weight(...) */
+
+/**
+ *@brief add delta to the completion weight of a key, saturating at SIZE_MAX, to count how often the key is used. HASH_TRIE mode only.
+ *@param table targeted table
+ *@param key key of an existing node
+ *@param delta weight to add
+ *@return TRUE or FALSE
+ */
+int ht_trie_add_weight(HASH_TABLE* table, const char* key, size_t delta) {
+    __n_assert(table, return FALSE);
+    __n_assert(key, return FALSE);
+
+    if (table->mode != HASH_TRIE) {
+        n_log(LOG_ERR, "table %p is not a HASH_TRIE table", table);
+        return FALSE;
+    }
+    const HASH_NODE* leaf = _ht_art_search(table, key);
+    if (!leaf) {
+        n_log(LOG_DEBUG, "key %s not found in table %p", key, table);
+        return FALSE;
+    }
+    size_t weight = (HASH_ART_WEIGHT(leaf) > SIZE_MAX - delta) ? SIZE_MAX : HASH_ART_WEIGHT(leaf) + delta;
+    return ht_trie_set_weight(table, key, weight);
+} /* ht_trie_add_weight(...) */
+
+/**
+ *@brief push a candidate on the max heap of ht_get_completion_list_ranked, HASH_TRIE mode
+ *@param heap address of the heap array, grown if full
+ *@param heap_size number of allocated entries in the heap
+ *@param nb_entries number of used entries in the heap
+ *@param weight weight of the candidate
+ *@param ptr inner node or tagged leaf
+ *@return TRUE or FALSE
+ */
+int _ht_art_ranked_push(HASH_ART_RANKED** heap, size_t* heap_size, size_t* nb_entries, size_t weight, const void* ptr) {
+    if ((*nb_entries) == (*heap_size)) {
+        size_t new_size = (*heap_size) * 2;
+        Realloc((*heap), HASH_ART_RANKED, new_size);
+        __n_assert((*heap), return FALSE);
+        (*heap_size) = new_size;
+    }
+    size_t pos = (*nb_entries)++;
+    while (pos > 0 && (*heap)[(pos - 1) / 2].weight < weight) {
+        (*heap)[pos] = (*heap)[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    (*heap)[pos].weight = weight;
+    (*heap)[pos].ptr = ptr;
+    return TRUE;
+} /* _ht_art_ranked_push(...) */
+
+/**
+ *@brief pop the heaviest candidate from the max heap of ht_get_completion_list_ranked, HASH_TRIE mode
+ *@param heap heap array
+ *@param nb_entries number of used entries in the heap, not 0
+ *@return the heaviest candidate
+ */
+HASH_ART_RANKED _ht_art_ranked_pop(HASH_ART_RANKED* heap, size_t* nb_entries) {
+    HASH_ART_RANKED top = heap[0];
+    HASH_ART_RANKED last = heap[--(*nb_entries)];
+    size_t pos = 0;
+    for (;;) {
+        size_t child = 2 * pos + 1;
+        if (child >= (*nb_entries))
+            break;
+        if (child + 1 < (*nb_entries) && heap[child + 1].weight > heap[child].weight)
+            child++;
+        if (heap[child].weight <= last.weight)
+            break;
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    if ((*nb_entries) > 0)
+        heap[pos] = last;
+    return top;
+} /* _ht_art_ranked_pop(...) */
+
+/**
+ *@brief get the heaviest keys starting with keybud, set with ht_trie_set_weight / ht_trie_add_weight. Best first search using the highest weight kept in each inner node, only the subtrees that can still hold one of the results are opened. HASH_TRIE mode only.
+ *@param table targeted hash table
+ *@param keybud starting characters of the keys we want, "" for all the keys
+ *@param max_results maximum number of matching keys in list. From UNLIMITED_LIST_ITEMS (0) to MAX_LIST_ITEMS (SIZE_MAX).
+ *@return NULL or a LIST *list of the matching keys, heaviest first
+ */
+LIST* ht_get_completion_list_ranked(HASH_TABLE* table, const char* keybud, size_t max_results) {
+    __n_assert(table, return NULL);
+    __n_assert(keybud, return NULL);
+
+    if (table->mode != HASH_TRIE) {
+        n_log(LOG_ERR, "table %p is not a HASH_TRIE table", table);
+        return NULL;
+    }
+    const void* subtree = (keybud[0] != '\0') ? _ht_art_find_prefix(table, keybud, NULL) : table->root;
+    if (!subtree)
+        return NULL;
+
+    HASH_ART_RANKED* heap = NULL;
+    size_t heap_size = HASH_RANKED_HEAP_SIZE;
+    size_t nb_entries = 0;
+    Malloc(heap, HASH_ART_RANKED, heap_size);
+    __n_assert(heap, return NULL);
+    LIST* results = new_generic_list(max_results);
+    __n_assert(results, Free(heap); return NULL);
+
+    size_t weight = HASH_ART_IS_LEAF(subtree) ? HASH_ART_WEIGHT(HASH_ART_LEAF(subtree)) : ((const HASH_ART_NODE*)subtree)->max_weight;
+    int has_succeeded = _ht_art_ranked_push(&heap, &heap_size, &nb_entries, weight, subtree);
+    while (has_succeeded == TRUE && nb_entries > 0 && (results->nb_max_items == UNLIMITED_LIST_ITEMS || results->nb_items < results->nb_max_items)) {
+        HASH_ART_RANKED best = _ht_art_ranked_pop(heap, &nb_entries);
+        if (HASH_ART_IS_LEAF(best.ptr)) {
+            char* key = strdup(HASH_ART_LEAF(best.ptr)->key);
+            __n_assert(key, has_succeeded = FALSE; break);
+            if (list_push(results, key, &free) == FALSE) {
+                n_log(LOG_ERR, "not enough space in list or memory error, key %s not pushed !", key);
+                Free(key);
+                has_succeeded = FALSE;
+            }
+            continue;
+        }
+        const HASH_ART_NODE* node = (const HASH_ART_NODE*)best.ptr;
+        if (node->leaf)
+            has_succeeded = _ht_art_ranked_push(&heap, &heap_size, &nb_entries, HASH_ART_WEIGHT(node->leaf), HASH_ART_TAG_LEAF(node->leaf));
+        size_t byte = 0;
+        for (const void* child = ht_art_next_child(node, &byte); child && has_succeeded == TRUE; byte++, child = ht_art_next_child(node, &byte)) {
+            weight = HASH_ART_IS_LEAF(child) ? HASH_ART_WEIGHT(HASH_ART_LEAF(child)) : ((const HASH_ART_NODE*)child)->max_weight;
+            has_succeeded = _ht_art_ranked_push(&heap, &heap_size, &nb_entries, weight, child);
+        }
+    }
+    Free(heap);
+    if (results->nb_items < 1)
+        list_destroy(&results);
+    return results;
+} /* ht_get_completion_list_ranked(...) */
+
+/**
+ *@brief push a frame on the walk stack of a cursor, HASH_TRIE mode
+ *@param cursor targeted cursor
+ *@param ptr inner node or tagged leaf
+ *@param byte next child key byte to visit
+ *@param leaf_done TRUE if the node leaf must not be visited
+ *@return TRUE or FALSE
+ */
+int _ht_cursor_push(HASH_CURSOR* cursor, const void* ptr, size_t byte, int leaf_done) {
+    if (cursor->stack_depth == cursor->stack_size) {
+        size_t new_size = cursor->stack_size * 2;
+        if (Realloc(cursor->stack, HASH_CURSOR_FRAME, new_size) == FALSE)
+            return FALSE;
+        cursor->stack_size = new_size;
+    }
+    HASH_CURSOR_FRAME* frame = &cursor->stack[cursor->stack_depth++];
+    frame->ptr = ptr;
+    frame->byte = byte;
+    frame->leaf_done = leaf_done;
+    return TRUE;
+} /* _ht_cursor_push(...) */
+
+/**
+ *@brief tell if a key is in the range of a cursor
+ *@param cursor targeted cursor
+ *@param key key to test, NULL for the nodes only known by their hash value
+ *@return TRUE or FALSE
+ */
+FORCE_INLINE int _ht_cursor_matches(const HASH_CURSOR* cursor, const char* key) {
+    return (cursor->prefix_len == 0 || (key && strncmp(key, cursor->prefix, cursor->prefix_len) == 0)) ? TRUE : FALSE;
+} /* _ht_cursor_matches(...) */
+
+/**
+ *@brief open a cursor on the nodes of a table. Nodes are returned one by one by ht_cursor_next without allocating anything. HASH_CLASSIC, HASH_OPEN and HASH_SNAPSHOT tables are walked in slot order and filtered by prefix. A HASH_CLASSIC table is not resized while cursors are open on it: its buckets stay in place until they are all closed. HASH_TRIE tables are walked in key order, inside the subtree of prefix only. HASH_CONCURRENT tables are not supported, a reader can't keep a read section open between two calls.
+ *@param table targeted table
+ *@param prefix NULL or "" to walk the whole table, else the starting characters of the walked keys
+ *@return NULL or a new cursor, to close with ht_cursor_close
+ */
+HASH_CURSOR* ht_cursor_open(HASH_TABLE* table, const char* prefix) {
+    __n_assert(table, return NULL);
+
+    if (table->mode != HASH_CLASSIC && table->mode != HASH_TRIE && table->mode != HASH_OPEN && table->mode != HASH_SNAPSHOT) {
+        n_log(LOG_ERR, "unsupported mode %d for a cursor on table %p", table->mode, table);
+        return NULL;
+    }
+    HASH_CURSOR* cursor = NULL;
+    Malloc(cursor, HASH_CURSOR, 1);
+    __n_assert(cursor, n_log(LOG_ERR, "Error allocating HASH_CURSOR *cursor"); return NULL);
+    cursor->table = table;
+    if (prefix && prefix[0] != '\0') {
+        cursor->prefix = strdup(prefix);
+        __n_assert(cursor->prefix, Free(cursor); return NULL);
+        cursor->prefix_len = strlen(prefix);
+    }
+    if (table->mode == HASH_TRIE) {
+        cursor->stack_size = HASH_CURSOR_STACK_SIZE;
+        Malloc(cursor->stack, HASH_CURSOR_FRAME, cursor->stack_size);
+        __n_assert(cursor->stack, FreeNoLog(cursor->prefix); Free(cursor); return NULL);
+    }
+    if (table->mode == HASH_CLASSIC)
+        table->nb_cursors++;
+    if (ht_cursor_rewind(cursor) == FALSE) {
+        ht_cursor_close(&cursor);
+        return NULL;
+    }
+    return cursor;
+} /* ht_cursor_open(...) */
+
+/**
+ *@brief restart a cursor from its first node
+ *@param cursor targeted cursor
+ *@return TRUE or FALSE
+ */
+int ht_cursor_rewind(HASH_CURSOR* cursor) {
+    __n_assert(cursor, return FALSE);
+
+    cursor->position = 0;
+    cursor->list_node = NULL;
+    if (cursor->table->mode == HASH_TRIE) {
+        cursor->stack_depth = 0;
+        cursor->trie_start_depth = 0;
+        cursor->trie_start = cursor->prefix ? _ht_art_find_prefix(cursor->table, cursor->prefix, &cursor->trie_start_depth) : cursor->table->root;
+        if (cursor->trie_start)
+            return _ht_cursor_push(cursor, cursor->trie_start, 0, FALSE);
+    }
+    return TRUE;
+} /* ht_cursor_rewind(...) */
+
+/**
+ *@brief get the next node of a cursor on a HASH_CLASSIC table
+ *@param cursor targeted cursor
+ *@return NULL or the next node
+ */
+HASH_NODE* _ht_cursor_next_classic(HASH_CURSOR* cursor) {
+    const HASH_TABLE* table = cursor->table;
+    LIST_NODE* list_node = cursor->list_node ? cursor->list_node->next : NULL;
+    while (TRUE) {
+        for (; list_node; list_node = list_node->next) {
+            HASH_NODE* node = (HASH_NODE*)list_node->ptr;
+            if (_ht_cursor_matches(cursor, node->key)) {
+                cursor->list_node = list_node;
+                return node;
+            }
+        }
+        cursor->list_node = NULL;
+        if (cursor->position >= table->size + table->rehash_size)
+            return NULL;
+        list_node = ht_bucket_start(table, cursor->position);
+        cursor->position++;
+    }
+} /* _ht_cursor_next_classic(...) */
+
+/**
+ *@brief get the next node of a cursor on a HASH_TRIE table, in key order
+ *@param cursor targeted cursor
+ *@return NULL or the next node
+ */
+HASH_NODE* _ht_cursor_next_trie(HASH_CURSOR* cursor) {
+    while (cursor->stack_depth > 0) {
+        HASH_CURSOR_FRAME* frame = &cursor->stack[cursor->stack_depth - 1];
+        if (HASH_ART_IS_LEAF(frame->ptr)) {
+            cursor->stack_depth--;
+            HASH_NODE* leaf = HASH_ART_LEAF(frame->ptr);
+            if (_ht_cursor_matches(cursor, leaf->key))
+                return leaf;
+            continue;
+        }
+        const HASH_ART_NODE* node = (const HASH_ART_NODE*)frame->ptr;
+        if (!frame->leaf_done) {
+            frame->leaf_done = TRUE;
+            if (node->leaf && _ht_cursor_matches(cursor, node->leaf->key))
+                return node->leaf;
+        }
+        void* child = ht_art_next_child(node, &frame->byte);
+        if (!child) {
+            cursor->stack_depth--;
+            continue;
+        }
+        frame->byte++;
+        if (_ht_cursor_push(cursor, child, 0, FALSE) == FALSE)
+            return NULL;
+    }
+    return NULL;
+} /* _ht_cursor_next_trie(...) */
+
+/**
+ *@brief get the next node of a cursor. The table must not be modified between two calls, use ht_cursor_seek with the last returned key to resume after a modification.
+ *@param cursor targeted cursor
+ *@return NULL at the end of the walk, or the next node
+ */
+HASH_NODE* ht_cursor_next(HASH_CURSOR* cursor) {
+    __n_assert(cursor, return NULL);
+
+    HASH_TABLE* table = cursor->table;
+    switch (table->mode) {
+        case HASH_CLASSIC:
+            return _ht_cursor_next_classic(cursor);
+        case HASH_TRIE:
+            return _ht_cursor_next_trie(cursor);
+        case HASH_OPEN:
+            while (cursor->position < table->size) {
+                size_t index = cursor->position++;
+                if (table->open_dist[index] != 0 && _ht_cursor_matches(cursor, table->open_nodes[index].key))
+                    return &table->open_nodes[index];
+            }
+            return NULL;
+        case HASH_SNAPSHOT: {
+            HASH_NODE* node = NULL;
+            while ((node = ht_snapshot_next(table, &cursor->position, &cursor->image_node)) != NULL) {
+                if (_ht_cursor_matches(cursor, node->key))
+                    return node;
+            }
+            return NULL;
+        }
+        default:
+            return NULL;
+    }
+} /* ht_cursor_next(...) */
+
+/**
+ *@brief position a cursor right after key, HASH_TRIE mode. key needs not to be in the tree anymore.
+ *@param cursor targeted cursor
+ *@param key key to resume after
+ *@return TRUE or FALSE
+ */
+int _ht_cursor_seek_trie(HASH_CURSOR* cursor, const char* key) {
+    const HASH_TABLE* table = cursor->table;
+    if (cursor->prefix) {
+        int cmp = strncmp(key, cursor->prefix, cursor->prefix_len);
+        /* a key before the range leaves the cursor at its start, a key after it exhausts the cursor */
+        if (cmp < 0)
+            return TRUE;
+        if (cmp > 0) {
+            cursor->stack_depth = 0;
+            return TRUE;
+        }
+    }
+    cursor->stack_depth = 0;
+    size_t len = strlen(key);
+    size_t depth = cursor->trie_start_depth;
+    const void* ptr = cursor->trie_start;
+    while (ptr) {
+        if (HASH_ART_IS_LEAF(ptr)) {
+            if (_ht_art_compare_keys(table, HASH_ART_LEAF(ptr)->key, key, depth) > 0)
+                return _ht_cursor_push(cursor, ptr, 0, FALSE);
+            return TRUE;
+        }
+        const HASH_ART_NODE* node = (const HASH_ART_NODE*)ptr;
+        if (node->prefix_len > 0) {
+            int cmp = _ht_art_compare_path(table, node, key, len, depth);
+            if (cmp < 0)
+                return TRUE;
+            if (cmp > 0)
+                return _ht_cursor_push(cursor, node, 0, FALSE);
+            depth += node->prefix_len;
+        }
+        /* the node leaf is key itself, or a prefix of it: already visited either way */
+        if (depth >= len)
+            return _ht_cursor_push(cursor, node, 0, TRUE);
+        uint8_t byte = _ht_art_byte(table, key, depth);
+        if (_ht_cursor_push(cursor, node, (size_t)byte + 1, TRUE) == FALSE)
+            return FALSE;
+        void** child = _ht_art_find_child((HASH_ART_NODE*)node, byte);
+        ptr = child ? (*child) : NULL;
+        depth++;
+    }
+    return TRUE;
+} /* _ht_cursor_seek_trie(...) */
+
+/**
+ *@brief resume a cursor after key, so that a walk can be continued later, by another cursor or after the table was modified. HASH_TRIE cursors resume at the next key in key order, key needing not to be in the table anymore. The other modes resume after the slot of key, provided the table was not resized. If key was removed they resume at the start of its bucket, possibly returning again a few nodes.
+ *@param cursor targeted cursor
+ *@param key key to resume after, usually the key of the last node returned by a cursor on the same table
+ *@return TRUE or FALSE
+ */
+int ht_cursor_seek(HASH_CURSOR* cursor, const char* key) {
+    __n_assert(cursor, return FALSE);
+    __n_assert(key, return FALSE);
+
+    if (ht_cursor_rewind(cursor) == FALSE)
+        return FALSE;
+    if (key[0] == '\0')
+        return TRUE;
+
+    HASH_TABLE* table = cursor->table;
+    switch (table->mode) {
+        case HASH_TRIE:
+            return _ht_cursor_seek_trie(cursor, key);
+        case HASH_CLASSIC: {
+            HASH_VALUE hash_value[2] = {0, 0};
+            MurmurHash(key, strlen(key), table->seed, &hash_value);
+            size_t index = hash_value[0] % table->size;
+            size_t rehash_index = table->rehash_table ? table->size + hash_value[0] % table->rehash_size : 0;
+            LIST* bucket = NULL;
+            LIST_NODE* list_node = _ht_find_list_node(table, key, hash_value[0], &bucket);
+            if (list_node) {
+                cursor->position = ((bucket == table->hash_table[index]) ? index : rehash_index) + 1;
+                cursor->list_node = list_node;
+            } else {
+                cursor->position = (!table->rehash_table || index >= table->rehash_index) ? index : rehash_index;
+            }
+            return TRUE;
+        }
+        case HASH_OPEN: {
+            HASH_VALUE hash_value = _ht_open_hash(table, key);
+            size_t index = _ht_open_find_slot(table, key, hash_value);
+            cursor->position = (index != SIZE_MAX) ? index + 1 : (hash_value & (table->size - 1));
+            return TRUE;
+        }
+        case HASH_SNAPSHOT: {
+            HASH_VALUE hash_value = _ht_open_hash(table, key);
+            size_t index = _ht_open_find_slot(table->snapshot_overlay, key, hash_value);
+            const HASH_SNAPSHOT_SLOT* slot = (index == SIZE_MAX) ? _ht_snapshot_find_slot(table, key, hash_value) : NULL;
+            if (index != SIZE_MAX) {
+                cursor->position = index + 1;
+            } else if (slot) {
+                cursor->position = table->snapshot_overlay->size + (size_t)(slot - table->snapshot_slots) + 1;
+            } else {
+                cursor->position = table->snapshot_overlay->size + ((table->size > 0) ? (hash_value & (table->size - 1)) : 0);
+            }
+            return TRUE;
+        }
+        default:
+            return FALSE;
+    }
+} /* ht_cursor_seek(...) */
+
+/**
+ *@brief close a cursor and set it to NULL. The table is left untouched, a HASH_CLASSIC one can be resized again once its last cursor is closed.
+ *@param cursor pointer to the cursor to close
+ *@return TRUE or FALSE
+ */
+int ht_cursor_close(HASH_CURSOR** cursor) {
+    __n_assert(cursor && (*cursor), n_log(LOG_ERR, "Can't close cursor: already NULL"); return FALSE);
+
+    if ((*cursor)->table->mode == HASH_CLASSIC && (*cursor)->table->nb_cursors > 0)
+        (*cursor)->table->nb_cursors--;
+    FreeNoLog((*cursor)->prefix);
+    FreeNoLog((*cursor)->stack);
+    Free((*cursor));
+    return TRUE;
+} /* ht_cursor_close(...) */
+
 /**
  *@brief test if number is a prime number or not
  *@param nb number to test
@@ -2498,7 +6284,14 @@ int ht_get_table_collision_percentage(HASH_TABLE* table) {
             nb_collisionned_lists++;
         }
     }
-    size_t collision_percentage = (100 * nb_collisionned_lists) / table->size;
+    for (size_t hash_it = 0; hash_it < table->rehash_size; hash_it++) {
+        if (table->rehash_table[hash_it] && table->rehash_table[hash_it]->nb_items > 1) {
+            nb_collisionned_lists++;
+        }
+    }
+    /* during an incremental resize the keys are spread over the new bucket array */
+    size_t nb_lists = (table->rehash_table) ? table->rehash_size : table->size;
+    size_t collision_percentage = (100 * nb_collisionned_lists) / nb_lists;
     return (int)collision_percentage;
 } /* ht_get_table_collision_percentage() */
 
@@ -2521,91 +6314,22 @@ size_t ht_get_optimal_size(HASH_TABLE* table) {
 } /* ht_get_optimal_size() */
 
 /**
- *@brief rehash table according to size (HASH_CLASSIC mode only)
+ *@brief rehash table according to size, migrating all the keys before returning (HASH_CLASSIC mode only). Use ht_resize_incremental to spread the work over the following puts and removes instead.
  *@param table targeted table
  *@param size new hash table size
  *@return TRUE or FALSE
  */
 int ht_resize(HASH_TABLE** table, size_t size) {
-    __n_assert((*table), return FALSE);
-    if ((*table)->mode != HASH_CLASSIC) {
-        n_log(LOG_ERR, "unsupported table->mode (%d instead or %d)", (*table)->mode, HASH_CLASSIC);
-        return FALSE;
-    }
-    if (size < 1) {
-        n_log(LOG_ERR, "invalid size %zu for hash table %p", size, (void*)(*table));
+    __n_assert(table && (*table), return FALSE);
+
+    if (ht_resize_incremental((*table), size) == FALSE)
         return FALSE;
-    }
-    /* mark every existing entry for rehash before resizing.
-     * Using ht_foreach (plain for-loop macro) instead of HT_FOREACH
-     * because the body needs no break/continue, and HT_FOREACH's
-     * GCC nested-function expansion is rejected by clang's parser. */
-    ht_foreach(it_node, (*table)) {
-        HASH_NODE* node = (HASH_NODE*)it_node->ptr;
-        node->need_rehash = 1;
-    }
 
-    if (size > (*table)->size) {
-        if (Realloc((*table)->hash_table, LIST*, size) == FALSE) {
-            return FALSE;
-        }
-        for (size_t it = (*table)->size; it < size; it++) {
-            (*table)->hash_table[it] = new_generic_list(MAX_LIST_ITEMS);
-            if (!(*table)->hash_table[it]) {
-                n_log(LOG_ERR, "Can't allocate table -> hash_table[ %zu ] !", it);
-                /* destroy newly added slots and shrink back */
-                for (size_t it_delete = (*table)->size; it_delete < it; it_delete++) {
-                    list_destroy(&(*table)->hash_table[it_delete]);
-                }
-                /* best-effort rollback: shrink back to original size.
-                   Realloc preserves the pointer on failure, which is fine here. */
-                Realloc((*table)->hash_table, LIST*, (*table)->size);
-                return FALSE;
-            }
-        }
-        /* rehash all marked nodes into their new positions */
-        for (size_t it = 0; it < size; it++) {
-            if ((*table)->hash_table[it]) {
-                while ((*table)->hash_table[it]->start) {
-                    HASH_NODE* hash_node = (HASH_NODE*)(*table)->hash_table[it]->start->ptr;
-                    if (hash_node->need_rehash == 0)
-                        break;
-                    hash_node->need_rehash = 0;
-                    LIST_NODE* node = list_node_shift((*table)->hash_table[it]);
-                    node->next = node->prev = NULL;
-                    size_t index = (hash_node->hash_value) % (size);
-                    list_node_push((*table)->hash_table[index], node);
-                }
-            }
-        }
-    } else {
-        /* rehash nodes that need it into the smaller index space */
-        for (size_t it = 0; it < (*table)->size; it++) {
-            if ((*table)->hash_table[it]) {
-                while ((*table)->hash_table[it]->start) {
-                    HASH_NODE* hash_node = (HASH_NODE*)(*table)->hash_table[it]->start->ptr;
-                    if (hash_node->need_rehash == 0)
-                        break;
-                    hash_node->need_rehash = 0;
-                    LIST_NODE* node = list_node_shift((*table)->hash_table[it]);
-                    node->next = node->prev = NULL;
-                    size_t index = (hash_node->hash_value) % (size);
-                    list_node_push((*table)->hash_table[index], node);
-                }
-            }
-        }
-        /* destroy trailing slots that are now unused */
-        for (size_t it = size; it < (*table)->size; it++) {
-            list_destroy(&(*table)->hash_table[it]);
-        }
-        /* shrink the backing array; Realloc preserves the pointer on failure.
-           Trailing slots have already been list_destroy'd so they are NULL.
-           (*table)->size is updated below regardless, keeping the table
-           consistent even if the allocator cannot shrink in-place. */
-        Realloc((*table)->hash_table, LIST*, size);
+    /* migrate every bucket right away */
+    if (ht_rehash_step((*table), SIZE_MAX) == TRUE) {
+        n_log(LOG_ERR, "could not finish the resize of hash table %p to size %zu", (void*)(*table), size);
+        return FALSE;
     }
-    (*table)->size = size;
-
     return TRUE;
 } /* ht_resize() */
 
@@ -2644,7 +6368,48 @@ int ht_optimize(HASH_TABLE** table) {
 } /* ht_optimize() */
 
 /**
- *@brief duplicate a hash table (all pointers should have a duplicator func set)
+ *@brief put a copy of hash_node in duplicated_table, helper for ht_duplicate
+ *@param duplicated_table destination table
+ *@param hash_node node to copy
+ *@return TRUE or FALSE
+ */
+int _ht_duplicate_node(HASH_TABLE* duplicated_table, const HASH_NODE* hash_node) {
+    int has_succeeded = TRUE;
+    switch (hash_node->type) {
+        case HASH_INT:
+            has_succeeded = ht_put_int(duplicated_table, hash_node->key, hash_node->data.ival);
+            break;
+        case HASH_DOUBLE:
+            has_succeeded = ht_put_double(duplicated_table, hash_node->key, hash_node->data.fval);
+            break;
+        case HASH_PTR: {
+            if (hash_node->duplicate_func && hash_node->data.ptr) {
+                /* deep copy: new entry takes ownership with the same funcs */
+                void* duplicated_ptr = hash_node->duplicate_func(hash_node->data.ptr);
+                if (!duplicated_ptr) {
+                    n_log(LOG_ERR, "duplicate_func returned NULL for key [%s]", hash_node->key);
+                    has_succeeded = FALSE;
+                    break;
+                }
+                has_succeeded = ht_put_ptr(duplicated_table, hash_node->key, duplicated_ptr, hash_node->destroy_func, hash_node->duplicate_func);
+            } else {
+                /* shallow copy: pass NULL destroy/duplicate so the duplicate table
+                   does not take ownership; only the source table will free the pointer */
+                has_succeeded = ht_put_ptr(duplicated_table, hash_node->key, hash_node->data.ptr, NULL, NULL);
+            }
+        } break;
+        case HASH_STRING:
+            has_succeeded = ht_put_string(duplicated_table, hash_node->key, hash_node->data.string);
+            break;
+        default:
+            n_log(LOG_ERR, "unknown node type %d for key [%s], skipping", hash_node->type, hash_node->key);
+            break;
+    }
+    return has_succeeded;
+} /* _ht_duplicate_node() */
+
+/**
+ *@brief duplicate a hash table (all pointers should have a duplicator func set). HASH_CLASSIC, HASH_OPEN, HASH_CONCURRENT and HASH_SNAPSHOT modes, snapshots being duplicated as HASH_OPEN tables.
  *@param table the HASH_TABLE *table to duplicate
  *@return NULL or and allocated duplicated HASH_TABLE
  */
@@ -2652,57 +6417,50 @@ HASH_TABLE* ht_duplicate(HASH_TABLE* table) {
     __n_assert(table, return NULL);
     HASH_TABLE* duplicated_table = NULL;
 
-    if (table->mode != HASH_CLASSIC) {
+    if (table->mode == HASH_CLASSIC) {
+        duplicated_table = new_ht_ex(table->size, table->flags);
+    } else if (table->mode == HASH_OPEN) {
+        duplicated_table = new_ht_open(table->nb_keys > 0 ? table->nb_keys : 1);
+    } else if (table->mode == HASH_CONCURRENT) {
+        duplicated_table = new_ht_concurrent(table->size, table->nb_shards);
+    } else if (table->mode == HASH_SNAPSHOT) {
+        /* the copy is a writable in memory table */
+        duplicated_table = new_ht_open(table->nb_keys > 0 ? table->nb_keys : 1);
+    } else {
         n_log(LOG_ERR, "unsupported mode %d for table %p", table->mode, table);
         return NULL;
     }
-
-    duplicated_table = new_ht(table->size);
     if (!duplicated_table) {
         n_log(LOG_ERR, "couldn't allocate duplicated table of %zu elements", table->size);
         return NULL;
     }
 
-    ht_foreach(node, table) {
-        HASH_NODE* hash_node = (HASH_NODE*)node->ptr;
-        int has_succeeded = TRUE;
-        switch (hash_node->type) {
-            case HASH_INT:
-                has_succeeded = ht_put_int(duplicated_table, hash_node->key, hash_node->data.ival);
-                break;
-            case HASH_DOUBLE:
-                has_succeeded = ht_put_double(duplicated_table, hash_node->key, hash_node->data.fval);
-                break;
-            case HASH_PTR: {
-                if (hash_node->duplicate_func && hash_node->data.ptr) {
-                    /* deep copy: new entry takes ownership with the same funcs */
-                    void* duplicated_ptr = hash_node->duplicate_func(hash_node->data.ptr);
-                    if (!duplicated_ptr) {
-                        n_log(LOG_ERR, "duplicate_func returned NULL for key [%s]", hash_node->key);
-                        has_succeeded = FALSE;
-                        break;
-                    }
-                    has_succeeded = ht_put_ptr(duplicated_table, hash_node->key, duplicated_ptr, hash_node->destroy_func, hash_node->duplicate_func);
-                } else {
-                    /* shallow copy: pass NULL destroy/duplicate so the duplicate table
-                       does not take ownership; only the source table will free the pointer */
-                    has_succeeded = ht_put_ptr(duplicated_table, hash_node->key, hash_node->data.ptr, NULL, NULL);
-                }
-            } break;
-            case HASH_STRING:
-                has_succeeded = ht_put_string(duplicated_table, hash_node->key, hash_node->data.string);
-                break;
-            default:
-                n_log(LOG_ERR, "unknown node type %d for key [%s], skipping", hash_node->type, hash_node->key);
-                break;
+    int has_succeeded = TRUE;
+    if (table->mode == HASH_CLASSIC) {
+        ht_foreach(node, table) {
+            if (has_succeeded == TRUE) {
+                has_succeeded = _ht_duplicate_node(duplicated_table, (HASH_NODE*)node->ptr);
+            }
         }
-
-        if (has_succeeded == FALSE) {
-            n_log(LOG_ERR, "problem when trying to duplicate value in %p, duplication cancelled", table);
-            destroy_ht(&duplicated_table);
-            return NULL;
+    } else if (table->mode == HASH_CONCURRENT || table->mode == HASH_SNAPSHOT) {
+        HT_FOREACH(hash_node, table, {
+            if (has_succeeded == TRUE) {
+                has_succeeded = _ht_duplicate_node(duplicated_table, hash_node);
+            }
+        });
+    } else {
+        for (size_t it = 0; it < table->size && has_succeeded == TRUE; it++) {
+            if (table->open_dist[it] != 0) {
+                has_succeeded = _ht_duplicate_node(duplicated_table, &table->open_nodes[it]);
+            }
         }
     }
 
+    if (has_succeeded == FALSE) {
+        n_log(LOG_ERR, "problem when trying to duplicate value in %p, duplication cancelled", table);
+        destroy_ht(&duplicated_table);
+        return NULL;
+    }
+
     return duplicated_table;
 }
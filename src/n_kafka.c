@@ -444,6 +444,9 @@ N_KAFKA* n_kafka_new(int32_t poll_timeout, int32_t poll_interval, size_t errstr_
     kafka->received_events = new_generic_list(MAX_LIST_ITEMS);
     __n_assert(kafka->received_events, n_kafka_delete(kafka); return NULL);
 
+    list_node_cache(kafka->events_to_send, LIST_NODE_CACHE_SIZE);
+    list_node_cache(kafka->received_events, LIST_NODE_CACHE_SIZE);
+
     if (init_lock(kafka->rwlock) != 0) {
         n_log(LOG_ERR, "could not init kafka rwlock in kafka structure at address %p", kafka);
         n_kafka_delete(kafka);
@@ -684,8 +687,7 @@ N_KAFKA* n_kafka_load_config(char* config_file, int mode) {
                 n_log(LOG_DEBUG, "group.id is not set and group.id.autogen is not set, generated unique group id: %s", _nstr(groupid));
             }
             free(topics);
-            kafka->groupid = groupid->data;
-            groupid->data = NULL;
+            kafka->groupid = nstr_detach_data(groupid);
             free_nstr(&groupid);
         }
         if (rd_kafka_conf_set(kafka->rd_kafka_conf, "group.id", kafka->groupid, _nstr(kafka->errstr), kafka->errstr->length) != RD_KAFKA_CONF_OK) {
@@ -998,11 +1000,12 @@ N_KAFKA_EVENT* n_kafka_new_event_from_string(const N_STR* string, int schema_id)
 N_KAFKA_EVENT* n_kafka_new_event_from_file(char* filename, int schema_id) {
     __n_assert(filename, return NULL);
 
-    N_STR* from = file_to_nstr(filename);
+    /* mapped, the event is the only copy of the file */
+    N_STR* from = n_file_map(filename);
     __n_assert(from, return NULL);
 
     N_KAFKA_EVENT* event = n_kafka_new_event_from_string(from, schema_id);
-    free_nstr(&from);
+    n_file_unmap(&from);
 
     return event;
 } /* n_kafka_new_event_from_file */
@@ -28,6 +28,8 @@
 #include "nilorea/n_log.h"
 #include "nilorea/n_list.h"
 
+#include <sched.h>
+
 /**
  *@brief Initialiaze a generic list container to max_items pointers.
  *@param max_items Specify a max size for the list container. From UNLIMITED_LIST_ITEMS (0) to MAX_LIST_ITEMS (SIZE_MAX).
@@ -44,6 +46,10 @@ LIST* new_generic_list(size_t max_items) {
 
     list->start = list->end = NULL;
 
+    list->free_nodes = NULL;
+    list->nb_free_nodes = 0;
+    list->nb_max_free_nodes = 0;
+
     return list;
 } /* new_generic_list */
 
@@ -66,6 +72,44 @@ LIST_NODE* new_list_node(void* ptr, void (*destructor)(void* ptr)) {
     return node;
 } /* new_list_node(...) */
 
+/**
+ *@brief get a node for a new item of list, from its node cache if possible
+ *@param list The list the node is for
+ *@param ptr The pointer you want to put in the node.
+ *@param destructor Pointer to the ptr type destructor function. Leave to NULL if there isn't.
+ *@return A new node or NULL on error
+ */
+static LIST_NODE* _list_get_node(LIST* list, void* ptr, void (*destructor)(void* ptr)) {
+    LIST_NODE* node = list->free_nodes;
+    if (!node)
+        return new_list_node(ptr, destructor);
+
+    list->free_nodes = node->next;
+    list->nb_free_nodes--;
+    node->ptr = ptr;
+    node->destroy_func = destructor;
+    node->next = node->prev = NULL;
+    return node;
+} /* _list_get_node(...) */
+
+/**
+ *@brief give back a node taken out of list, kept in its node cache if there is room else freed
+ *@param list The list the node was in
+ *@param node The unlinked node
+ */
+static void _list_release_node(LIST* list, LIST_NODE* node) {
+    if (list->nb_free_nodes >= list->nb_max_free_nodes) {
+        Free(node);
+        return;
+    }
+    node->ptr = NULL;
+    node->destroy_func = NULL;
+    node->prev = NULL;
+    node->next = list->free_nodes;
+    list->free_nodes = node;
+    list->nb_free_nodes++;
+} /* _list_release_node(...) */
+
 /**
  *@brief Internal function called each time we need to get a node out of a list
  *@param list The list to pick in
@@ -100,7 +144,7 @@ void* remove_list_node_f(LIST* list, LIST_NODE* node) {
             }
         }
     }
-    Free(node);
+    _list_release_node(list, node);
     if (list->nb_items > 0) {
         list->nb_items--;
     }
@@ -235,7 +279,7 @@ int list_push(LIST* list, void* ptr, void (*destructor)(void* ptr)) {
         return FALSE;
     }
 
-    node = new_list_node(ptr, destructor);
+    node = _list_get_node(list, ptr, destructor);
     __n_assert(node, n_log(LOG_ERR, "Couldn't allocate new node"); return FALSE);
 
     if (list->end) {
@@ -285,7 +329,7 @@ int list_push_sorted(LIST* list, void* ptr, int (*comparator)(const void* a, con
         } else {
             /* we have a match inside the list. let's insert the datas */
             LIST_NODE* node_next = nodeptr->next;
-            LIST_NODE* newnode = new_list_node(ptr, destructor);
+            LIST_NODE* newnode = _list_get_node(list, ptr, destructor);
             __n_assert(newnode, n_log(LOG_ERR, "Couldn't allocate new node"); return FALSE);
 
             if (node_next) {
@@ -323,7 +367,7 @@ int list_unshift(LIST* list, void* ptr, void (*destructor)(void* ptr)) {
         n_log(LOG_ERR, "list is full");
         return FALSE;
     }
-    node = new_list_node(ptr, destructor);
+    node = _list_get_node(list, ptr, destructor);
     __n_assert(node, n_log(LOG_ERR, "Couldn't allocate new node"); return FALSE);
 
     if (list->start) {
@@ -373,7 +417,7 @@ int list_unshift_sorted(LIST* list, void* ptr, int (*comparator)(const void* a,
         } else {
             /* we have a match inside the list. let's insert the datas */
             LIST_NODE* node_prev = nodeptr->prev;
-            LIST_NODE* newnode = new_list_node(ptr, destructor);
+            LIST_NODE* newnode = _list_get_node(list, ptr, destructor);
             __n_assert(newnode, n_log(LOG_ERR, "Couldn't allocate new node"); return FALSE);
 
             if (node_prev) {
@@ -394,6 +438,114 @@ int list_unshift_sorted(LIST* list, void* ptr, int (*comparator)(const void* a,
     return ret;
 } /* list_unshift_sorted(...) */
 
+/**
+ *@brief merge two sorted chains of nodes linked by their next pointers, equal items of a first
+ *@param a chain holding the items that came first in the list
+ *@param b chain holding the items that came after
+ *@param comparator A pointer to a function which take two void * pointers and return an int.
+ *@return The head of the merged chain
+ */
+static LIST_NODE* _list_merge_chains(LIST_NODE* a, LIST_NODE* b, int (*comparator)(const void* a, const void* b)) {
+    LIST_NODE head;
+    LIST_NODE* tail = &head;
+    while (a && b) {
+        if (comparator(a->ptr, b->ptr) <= 0) {
+            tail->next = a;
+            a = a->next;
+        } else {
+            tail->next = b;
+            b = b->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = a ? a : b;
+    return head.next;
+} /* _list_merge_chains(...) */
+
+/**
+ *@brief make a chain of nodes linked by their next pointers the content of list, restoring the prev pointers
+ *@param list The list to fill
+ *@param chain The head of the chain
+ */
+static void _list_set_chain(LIST* list, LIST_NODE* chain) {
+    LIST_NODE* prev = NULL;
+    list->start = chain;
+    for (LIST_NODE* node = chain; node; node = node->next) {
+        node->prev = prev;
+        prev = node;
+    }
+    list->end = prev;
+} /* _list_set_chain(...) */
+
+/**
+ *@brief Sort a list with a stable bottom-up merge sort, in O(n log n). The nodes are relinked in place, none is allocated. Items comparing equal keep their order.
+ *@param list An initilized list container. A null value will cause an error and a _log message.
+ *@param comparator A pointer to a function which take two void * pointers and return an int.
+ *@return TRUE or FALSE. Check error messages in DEBUG mode.
+ */
+int list_sort(LIST* list, int (*comparator)(const void* a, const void* b)) {
+    __n_assert(list, n_log(LOG_ERR, "invalid list: NULL"); return FALSE);
+    __n_assert(comparator, n_log(LOG_ERR, "invalid comparator: NULL"); return FALSE);
+
+    if (list->nb_items < 2)
+        return TRUE;
+
+    /* bins[ it ] is NULL or a sorted chain of 2^it nodes, higher bins holding earlier nodes */
+    LIST_NODE* bins[sizeof(size_t) * 8] = {NULL};
+    size_t nb_bins = 0;
+    LIST_NODE* node = list->start;
+    while (node) {
+        LIST_NODE* next = node->next;
+        node->next = NULL;
+        LIST_NODE* carry = node;
+        size_t it = 0;
+        for (; it < nb_bins && bins[it]; it++) {
+            carry = _list_merge_chains(bins[it], carry, comparator);
+            bins[it] = NULL;
+        }
+        bins[it] = carry;
+        if (it == nb_bins)
+            nb_bins++;
+        node = next;
+    }
+    LIST_NODE* sorted = NULL;
+    for (size_t it = 0; it < nb_bins; it++) {
+        if (bins[it])
+            sorted = sorted ? _list_merge_chains(bins[it], sorted, comparator) : bins[it];
+    }
+    _list_set_chain(list, sorted);
+    return TRUE;
+} /* list_sort(...) */
+
+/**
+ *@brief Merge the sorted list src into the sorted list dest, in O(n). The nodes of src are moved, src is left empty. Items comparing equal come from dest first.
+ *@param dest An initilized sorted list, receiving the items
+ *@param src An initilized sorted list, emptied
+ *@param comparator A pointer to a function which take two void * pointers and return an int.
+ *@return TRUE or FALSE. Check error messages in DEBUG mode.
+ */
+int list_merge_sorted(LIST* dest, LIST* src, int (*comparator)(const void* a, const void* b)) {
+    __n_assert(dest, n_log(LOG_ERR, "invalid dest: NULL"); return FALSE);
+    __n_assert(src, n_log(LOG_ERR, "invalid src: NULL"); return FALSE);
+    __n_assert(comparator, n_log(LOG_ERR, "invalid comparator: NULL"); return FALSE);
+
+    if (dest->nb_max_items > 0 && src->nb_items > dest->nb_max_items - dest->nb_items) {
+        n_log(LOG_ERR, "list is full");
+        return FALSE;
+    }
+    if (src->nb_items == 0)
+        return TRUE;
+
+    if (dest->end)
+        dest->end->next = NULL;
+    src->end->next = NULL;
+    _list_set_chain(dest, _list_merge_chains(dest->start, src->start, comparator));
+    dest->nb_items += src->nb_items;
+    src->start = src->end = NULL;
+    src->nb_items = 0;
+    return TRUE;
+} /* list_merge_sorted(...) */
+
 /**
  *@brief Get a pointer from the end of the list
  *@param list An initilized list container. A null value will cause an error and a _log message.
@@ -420,7 +572,7 @@ void* list_pop_f(LIST* list) {
     if (list->nb_items == 0)
         list->start = list->end = NULL;
 
-    Free(nodeptr);
+    _list_release_node(list, nodeptr);
 
     return ptr;
 } /* list_pop_f( ... ) */
@@ -454,7 +606,7 @@ void* list_shift_f(LIST* list, char* file, size_t line) {
     if (list->nb_items == 0)
         list->start = list->end = NULL;
 
-    Free(nodeptr);
+    _list_release_node(list, nodeptr);
 
     return ptr;
 } /* list_shift_f(...)*/
@@ -509,7 +661,7 @@ int list_empty(LIST* list) {
         if (node_ptr->destroy_func != NULL) {
             node_ptr->destroy_func(node_ptr->ptr);
         }
-        Free(node_ptr);
+        _list_release_node(list, node_ptr);
     }
     list->start = list->end = NULL;
     list->nb_items = 0;
@@ -532,7 +684,7 @@ int list_empty_with_f(LIST* list, void (*free_fnct)(void* ptr)) {
         LIST_NODE* node_ptr = node;
         node = node->next;
         if (free_fnct) free_fnct(node_ptr->ptr);
-        Free(node_ptr);
+        _list_release_node(list, node_ptr);
     }
     list->start = list->end = NULL;
     list->nb_items = 0;
@@ -547,6 +699,302 @@ int list_empty_with_f(LIST* list, void (*free_fnct)(void* ptr)) {
 int list_destroy(LIST** list) {
     __n_assert(list && (*list), n_log(LOG_ERR, "list already destroyed"); return FALSE);
     list_empty((*list));
+    list_node_cache((*list), 0);
     Free((*list));
     return TRUE;
 } /* free_list( ... ) */
+
+/**
+ *@brief Keep the nodes released by the removals in the list, to reuse them on the next insertions instead of allocating. Disabled by default. Cached nodes are allocated one by one, so list_node_pop / list_node_shift callers can still free them.
+ *@param list The targeted list
+ *@param max_free_nodes Maximum number of cached nodes, LIST_NODE_CACHE_SIZE is a sensible value. 0 disables the cache and frees the cached nodes.
+ *@return TRUE or FALSE
+ */
+int list_node_cache(LIST* list, size_t max_free_nodes) {
+    __n_assert(list, n_log(LOG_ERR, "list is NULL"); return FALSE);
+
+    list->nb_max_free_nodes = max_free_nodes;
+    while (list->nb_free_nodes > max_free_nodes) {
+        LIST_NODE* node = list->free_nodes;
+        list->free_nodes = node->next;
+        list->nb_free_nodes--;
+        Free(node);
+    }
+    return TRUE;
+} /* list_node_cache(...) */
+
+/**
+ *@brief Fill the node cache of a list ahead of insertions, so that the next nb_nodes pushes do not allocate. The cache limit is raised to nb_nodes if needed.
+ *@param list The targeted list
+ *@param nb_nodes Number of nodes the cache should hold
+ *@return TRUE or FALSE
+ */
+int list_reserve_nodes(LIST* list, size_t nb_nodes) {
+    __n_assert(list, n_log(LOG_ERR, "list is NULL"); return FALSE);
+
+    if (list->nb_max_free_nodes < nb_nodes)
+        list->nb_max_free_nodes = nb_nodes;
+    while (list->nb_free_nodes < nb_nodes) {
+        LIST_NODE* node = new_list_node(NULL, NULL);
+        __n_assert(node, return FALSE);
+        node->next = list->free_nodes;
+        list->free_nodes = node;
+        list->nb_free_nodes++;
+    }
+    return TRUE;
+} /* list_reserve_nodes(...) */
+
+/**
+ *@brief Create a lock-free multiple producers / single consumer queue. Producers never block each other nor the consumer, which suits many threads feeding one connection.
+ *@param max_items Maximum number of queued pointers. From UNLIMITED_LIST_ITEMS (0) to MAX_LIST_ITEMS (SIZE_MAX).
+ *@param destructor Destructor of the pointers still queued when the queue is emptied or destroyed, or NULL
+ *@return a new MPSC_QUEUE or NULL
+ */
+MPSC_QUEUE* new_mpsc_queue(size_t max_items, void (*destructor)(void* ptr)) {
+    MPSC_QUEUE* queue = NULL;
+    Malloc(queue, MPSC_QUEUE, 1);
+    __n_assert(queue, return NULL);
+
+    queue->stub.next = NULL;
+    queue->head = queue->tail = &queue->stub;
+    queue->nb_items = 0;
+    queue->nb_max_items = max_items;
+    queue->destroy_func = destructor;
+    return queue;
+} /* new_mpsc_queue(...) */
+
+/**
+ *@brief link a node at the end of the queue, producer side
+ *@param queue The targeted queue
+ *@param node The node to link
+ */
+static void _mpsc_link(MPSC_QUEUE* queue, MPSC_NODE* node) {
+    __atomic_store_n(&node->next, NULL, __ATOMIC_RELAXED);
+    MPSC_NODE* prev = __atomic_exchange_n(&queue->head, node, __ATOMIC_ACQ_REL);
+    /* until this store the consumer sees the queue ending at prev */
+    __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+} /* _mpsc_link(...) */
+
+/**
+ *@brief Add a pointer at the end of the queue. Can be called from any number of threads at once.
+ *@param queue The targeted queue
+ *@param ptr The pointer to queue, not NULL
+ *@return TRUE or FALSE if the queue is full or on allocation error
+ */
+int mpsc_push(MPSC_QUEUE* queue, void* ptr) {
+    __n_assert(queue, n_log(LOG_ERR, "invalid queue: NULL"); return FALSE);
+    __n_assert(ptr, n_log(LOG_ERR, "invalid ptr: NULL"); return FALSE);
+
+    size_t nb_items = __atomic_add_fetch(&queue->nb_items, 1, __ATOMIC_RELAXED);
+    if (queue->nb_max_items > 0 && nb_items > queue->nb_max_items) {
+        __atomic_sub_fetch(&queue->nb_items, 1, __ATOMIC_RELAXED);
+        n_log(LOG_ERR, "queue is full");
+        return FALSE;
+    }
+    MPSC_NODE* node = NULL;
+    Malloc(node, MPSC_NODE, 1);
+    __n_assert(node, __atomic_sub_fetch(&queue->nb_items, 1, __ATOMIC_RELAXED); return FALSE);
+    node->ptr = ptr;
+    _mpsc_link(queue, node);
+    return TRUE;
+} /* mpsc_push(...) */
+
+/**
+ *@brief Get the pointer at the start of the queue. Only one thread at a time can pop. When a producer was preempted between swapping the queue head and linking its node, yields until the node is linked, so a pointer pushed before a pop started is never missed.
+ *@param queue The targeted queue
+ *@return The oldest queued pointer or NULL
+ */
+void* mpsc_pop(MPSC_QUEUE* queue) {
+    __n_assert(queue, n_log(LOG_ERR, "invalid queue: NULL"); return NULL);
+
+    MPSC_NODE* tail = queue->tail;
+    MPSC_NODE* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (tail == &queue->stub) {
+        if (!next)
+            return NULL;
+        queue->tail = tail = next;
+        next = __atomic_load_n(&next->next, __ATOMIC_ACQUIRE);
+    }
+    if (!next) {
+        while (tail != __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE)) {
+            /* a producer swapped head but did not link its node yet */
+            next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+            if (next)
+                break;
+            sched_yield();
+        }
+    }
+    if (!next) {
+        /* tail is the last node: put the stub behind it so it can be popped */
+        _mpsc_link(queue, &queue->stub);
+        next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+        if (!next)
+            return NULL;
+    }
+    queue->tail = next;
+    void* ptr = tail->ptr;
+    Free(tail);
+    __atomic_sub_fetch(&queue->nb_items, 1, __ATOMIC_RELAXED);
+    return ptr;
+} /* mpsc_pop(...) */
+
+/**
+ *@brief Get the number of items in the queue, a hint while producers are pushing
+ *@param queue The targeted queue
+ *@return number of queued items
+ */
+size_t mpsc_nb_items(MPSC_QUEUE* queue) {
+    __n_assert(queue, return 0);
+    return __atomic_load_n(&queue->nb_items, __ATOMIC_RELAXED);
+} /* mpsc_nb_items(...) */
+
+/**
+ *@brief Empty the queue, calling its destructor on each pointer. Consumer side, items pushed meanwhile may stay.
+ *@param queue The queue to empty
+ *@return TRUE or FALSE
+ */
+int mpsc_empty(MPSC_QUEUE* queue) {
+    __n_assert(queue, n_log(LOG_ERR, "queue is NULL"); return FALSE);
+
+    void* ptr = NULL;
+    while ((ptr = mpsc_pop(queue))) {
+        if (queue->destroy_func)
+            queue->destroy_func(ptr);
+    }
+    return TRUE;
+} /* mpsc_empty(...) */
+
+/**
+ *@brief Empty and free a queue. No producer must be using it anymore.
+ *@param queue The queue to destroy
+ *@return TRUE or FALSE
+ */
+int destroy_mpsc_queue(MPSC_QUEUE** queue) {
+    __n_assert(queue && (*queue), n_log(LOG_ERR, "queue already destroyed"); return FALSE);
+    mpsc_empty((*queue));
+    Free((*queue));
+    return TRUE;
+} /* destroy_mpsc_queue(...) */
+
+/**
+ *@brief Initialize an intrusive list. Its items embed an ILIST_LINK, pushing and removing them never allocate, and ilist_entry gets the item back from its link.
+ *@param list The intrusive list to initialize
+ */
+void ilist_init(ILIST* list) {
+    __n_assert(list, return);
+    list->head.next = list->head.prev = &list->head;
+    list->nb_items = 0;
+} /* ilist_init(...) */
+
+/**
+ *@brief Tell if a link is in no intrusive list. Zeroed links and removed links are unlinked.
+ *@param link The link to check
+ *@return TRUE or FALSE
+ */
+int ilist_is_unlinked(const ILIST_LINK* link) {
+    __n_assert(link, return FALSE);
+    return link->next == NULL ? TRUE : FALSE;
+} /* ilist_is_unlinked(...) */
+
+/**
+ *@brief Add a link after another one of an intrusive list
+ *@param list The targeted intrusive list
+ *@param where A link of list, or &list->head to add at the beginning
+ *@param link An unlinked link
+ */
+void ilist_insert_after(ILIST* list, ILIST_LINK* where, ILIST_LINK* link) {
+    __n_assert(list, return);
+    __n_assert(where, return);
+    __n_assert(link, return);
+
+    link->prev = where;
+    link->next = where->next;
+    where->next->prev = link;
+    where->next = link;
+    list->nb_items++;
+} /* ilist_insert_after(...) */
+
+/**
+ *@brief Add a link at the end of an intrusive list
+ *@param list The targeted intrusive list
+ *@param link An unlinked link
+ */
+void ilist_push(ILIST* list, ILIST_LINK* link) {
+    __n_assert(list, return);
+    ilist_insert_after(list, list->head.prev, link);
+} /* ilist_push(...) */
+
+/**
+ *@brief Add a link at the beginning of an intrusive list
+ *@param list The targeted intrusive list
+ *@param link An unlinked link
+ */
+void ilist_unshift(ILIST* list, ILIST_LINK* link) {
+    __n_assert(list, return);
+    ilist_insert_after(list, &list->head, link);
+} /* ilist_unshift(...) */
+
+/**
+ *@brief Remove a link from an intrusive list. The link is left unlinked.
+ *@param list The intrusive list holding link
+ *@param link The link to remove
+ */
+void ilist_remove(ILIST* list, ILIST_LINK* link) {
+    __n_assert(list, return);
+    __n_assert(link, return);
+    if (!link->next) {
+        n_log(LOG_ERR, "link %p is not in a list", link);
+        return;
+    }
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->next = link->prev = NULL;
+    list->nb_items--;
+} /* ilist_remove(...) */
+
+/**
+ *@brief Remove the last link of an intrusive list
+ *@param list The targeted intrusive list
+ *@return The unlinked link or NULL if the list is empty
+ */
+ILIST_LINK* ilist_pop(ILIST* list) {
+    __n_assert(list, return NULL);
+    if (list->head.prev == &list->head)
+        return NULL;
+    ILIST_LINK* link = list->head.prev;
+    ilist_remove(list, link);
+    return link;
+} /* ilist_pop(...) */
+
+/**
+ *@brief Remove the first link of an intrusive list
+ *@param list The targeted intrusive list
+ *@return The unlinked link or NULL if the list is empty
+ */
+ILIST_LINK* ilist_shift(ILIST* list) {
+    __n_assert(list, return NULL);
+    if (list->head.next == &list->head)
+        return NULL;
+    ILIST_LINK* link = list->head.next;
+    ilist_remove(list, link);
+    return link;
+} /* ilist_shift(...) */
+
+/**
+ *@brief Move all the links of src at the end of dest in constant time, src is left empty
+ *@param dest The receiving intrusive list
+ *@param src The intrusive list to empty into dest
+ */
+void ilist_splice(ILIST* dest, ILIST* src) {
+    __n_assert(dest, return);
+    __n_assert(src, return);
+    if (src->head.next == &src->head)
+        return;
+
+    src->head.next->prev = dest->head.prev;
+    dest->head.prev->next = src->head.next;
+    src->head.prev->next = &dest->head;
+    dest->head.prev = src->head.prev;
+    dest->nb_items += src->nb_items;
+    ilist_init(src);
+} /* ilist_splice(...) */
@@ -28,6 +28,7 @@
 #include <limits.h>
 #include <stdarg.h>
 #include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
 #include <string.h>
 #include <ctype.h>
@@ -763,13 +764,13 @@ NETWORK* netw_new(size_t send_list_limit, size_t recv_list_limit) {
         return NULL;
     }
     /*initialize queues */
-    netw->recv_buf = new_generic_list(recv_list_limit);
+    netw->recv_buf = new_mpsc_queue(recv_list_limit, free_nstr_ptr);
     if (!netw->recv_buf) {
         n_log(LOG_ERR, "Error when creating receive list with %d item limit", recv_list_limit);
         netw_close(&netw);
         return NULL;
     }
-    netw->send_buf = new_generic_list(send_list_limit);
+    netw->send_buf = new_mpsc_queue(send_list_limit, free_nstr_ptr);
     if (!netw->send_buf) {
         n_log(LOG_ERR, "Error when creating send list with %d item limit", send_list_limit);
         netw_close(&netw);
@@ -2172,6 +2173,45 @@ int netw_get_state(NETWORK* netw, uint32_t* state, int* thr_engine_status) {
     return FALSE;
 } /*netw_get_state() */
 
+/**
+ *@brief push to a queue of a NETWORK without lock. The producer is counted while it uses the queue, so that _netw_queue_destroy never frees it under a push
+ *@param queue address of the send_buf or recv_buf queue pointer
+ *@param pushers counter of the producers inside a push
+ *@param closing flag set when the queue is being destroyed
+ *@param msg message to push
+ *@return TRUE or FALSE if the queue is full, destroyed or being destroyed
+ */
+static int _netw_queue_push(MPSC_QUEUE** queue, int* pushers, int* closing, N_STR* msg) {
+    int ret = FALSE;
+    /* sequentially consistent with the closing store in _netw_queue_destroy: either the producer sees the flag or the destroyer sees the producer */
+    __atomic_add_fetch(pushers, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(closing, __ATOMIC_SEQ_CST)) {
+        MPSC_QUEUE* target = __atomic_load_n(queue, __ATOMIC_ACQUIRE);
+        if (target)
+            ret = mpsc_push(target, msg);
+    }
+    __atomic_sub_fetch(pushers, 1, __ATOMIC_RELEASE);
+    return ret;
+} /* _netw_queue_push(...) */
+
+/**
+ *@brief destroy a queue of a NETWORK: refuse new pushes, wait for the ones in progress, then free it under the consumer mutex
+ *@param bolt consumer mutex of the queue
+ *@param queue address of the send_buf or recv_buf queue pointer
+ *@param pushers counter of the producers inside a push
+ *@param closing flag refusing the pushes, left set
+ */
+static void _netw_queue_destroy(pthread_mutex_t* bolt, MPSC_QUEUE** queue, int* pushers, int* closing) {
+    __atomic_store_n(closing, 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(pushers, __ATOMIC_ACQUIRE) > 0) {
+        sched_yield();
+    }
+    pthread_mutex_lock(bolt);
+    if ((*queue))
+        destroy_mpsc_queue(queue);
+    pthread_mutex_unlock(bolt);
+} /* _netw_queue_destroy(...) */
+
 /**
  *@brief Restart or reset the specified network ability
  *@param netw The NETWORK *connection to modify
@@ -2183,26 +2223,20 @@ int netw_set(NETWORK* netw, int flag) {
     if (flag & NETW_EMPTY_SENDBUF) {
         pthread_mutex_lock(&netw->sendbolt);
         if (netw->send_buf)
-            list_empty(netw->send_buf);
+            mpsc_empty(netw->send_buf);
         pthread_mutex_unlock(&netw->sendbolt);
     };
     if (flag & NETW_EMPTY_RECVBUF) {
         pthread_mutex_lock(&netw->recvbolt);
         if (netw->recv_buf)
-            list_empty(netw->recv_buf);
+            mpsc_empty(netw->recv_buf);
         pthread_mutex_unlock(&netw->recvbolt);
     }
     if (flag & NETW_DESTROY_SENDBUF) {
-        pthread_mutex_lock(&netw->sendbolt);
-        if (netw->send_buf)
-            list_destroy(&netw->send_buf);
-        pthread_mutex_unlock(&netw->sendbolt);
+        _netw_queue_destroy(&netw->sendbolt, &netw->send_buf, &netw->send_buf_pushers, &netw->send_buf_closing);
     };
     if (flag & NETW_DESTROY_RECVBUF) {
-        pthread_mutex_lock(&netw->recvbolt);
-        if (netw->recv_buf)
-            list_destroy(&netw->recv_buf);
-        pthread_mutex_unlock(&netw->recvbolt);
+        _netw_queue_destroy(&netw->recvbolt, &netw->recv_buf, &netw->recv_buf_pushers, &netw->recv_buf_closing);
     }
     pthread_mutex_lock(&netw->eventbolt);
     if (flag & NETW_CLIENT) {
@@ -2238,7 +2272,7 @@ int netw_set(NETWORK* netw, int flag) {
      * and posting unconditionally creates a spurious wakeup that,
      * paired with an empty send_buf, produces the classic
      * "offset-by-one semaphore" bug where every subsequent real
-     * list_push leaves one extra post in the semaphore for the next
+     * mpsc_push leaves one extra post in the semaphore for the next
      * sem_wait to consume on a drained list. Avoiding the spurious
      * post here is the root cause fix and removes the need for a
      * defensive branch in the common path. */
@@ -3205,24 +3239,21 @@ int netw_add_msg(NETWORK* netw, N_STR* msg) {
     }
 
     /* Capture msg->written for the byte counter before the push:
-     * list_push transfers ownership to send_buf with free_nstr_ptr
-     * as the destructor, so once we release sendbolt the consumer
-     * (send thread or reactor) can shift, send, and free `msg`,
-     * making any post-unlock `msg->written` read a use-after-free.
+     * mpsc_push transfers ownership to send_buf, whose destructor is
+     * free_nstr_ptr, so once the node is linked the consumer
+     * (send thread or reactor) can pop, send, and free `msg`,
+     * making any post-push `msg->written` read a use-after-free.
      * The race is mostly latent in thread mode (send thread blocks
      * on the syscall before freeing) but the reactor consumes within
      * microseconds and TSan flags it consistently. */
     long long bytes_for_counter = (long long)msg->written;
 
-    pthread_mutex_lock(&netw->sendbolt);
-
-    if (list_push(netw->send_buf, msg, free_nstr_ptr) == FALSE) {
-        pthread_mutex_unlock(&netw->sendbolt);
+    /* lock-free: game threads feeding the same connection do not
+     * contend with each other nor with the send thread */
+    if (_netw_queue_push(&netw->send_buf, &netw->send_buf_pushers, &netw->send_buf_closing, msg) == FALSE) {
         return FALSE;
     }
 
-    pthread_mutex_unlock(&netw->sendbolt);
-
     /* Reactor mode: wake the reactor's epoll_wait via its
      * wake-eventfd so it picks up the new send_buf entry. The
      * thread engine's sem_post path stays as the default; the wake
@@ -3273,12 +3304,9 @@ int netw_add_msg_ex(NETWORK* netw, char* str, unsigned int length) {
     nstr->data = str;
     nstr->written = nstr->length = length;
 
-    pthread_mutex_lock(&netw->sendbolt);
-    if (list_push(netw->send_buf, nstr, free_nstr_ptr) == FALSE) {
-        pthread_mutex_unlock(&netw->sendbolt);
+    if (_netw_queue_push(&netw->send_buf, &netw->send_buf_pushers, &netw->send_buf_closing, nstr) == FALSE) {
         return FALSE;
     }
-    pthread_mutex_unlock(&netw->sendbolt);
 
     sem_post(&netw->send_blocker);
 
@@ -3295,9 +3323,10 @@ N_STR* netw_get_msg(NETWORK* netw) {
 
     __n_assert(netw, return NULL);
 
+    /* recv_buf has a single consumer side, several threads may call netw_get_msg */
     pthread_mutex_lock(&netw->recvbolt);
 
-    ptr = list_shift(netw->recv_buf, N_STR);
+    ptr = (N_STR*)mpsc_pop(netw->recv_buf);
 
     pthread_mutex_unlock(&netw->recvbolt);
 
@@ -3305,6 +3334,18 @@ N_STR* netw_get_msg(NETWORK* netw) {
     return ptr;
 } /* netw_get_msg(...)*/
 
+/**
+ *@brief Push a received message to the receive queue of a NETWORK, without lock
+ *@param netw NETWORK receiving the message
+ *@param msg message, owned by the queue on success
+ *@return TRUE or FALSE if the queue is full or being destroyed
+ */
+int netw_push_recv_msg(NETWORK* netw, N_STR* msg) {
+    __n_assert(netw, return FALSE);
+    __n_assert(msg, return FALSE);
+    return _netw_queue_push(&netw->recv_buf, &netw->recv_buf_pushers, &netw->recv_buf_closing, msg);
+} /* netw_push_recv_msg(...) */
+
 /**
  *@brief Wait a message from aimed NETWORK. Recheck each usec until a valid
  *@param netw The link on which we wait a message
@@ -3445,7 +3486,7 @@ void* netw_send_func(void* NET) {
                 n_log(LOG_DEBUG, "%d Quit sent!", netw->link.sock);
             } else {
                 pthread_mutex_lock(&netw->sendbolt);
-                ptr = list_shift(netw->send_buf, N_STR);
+                ptr = (N_STR*)mpsc_pop(netw->send_buf);
                 pthread_mutex_unlock(&netw->sendbolt);
                 if (ptr && ptr->length > 0 && ptr->data) {
                     /* Headroom for the 8-byte state+length header so
@@ -3533,12 +3574,10 @@ void* netw_send_func(void* NET) {
                 } else {
                     /* Empty send_buf or malformed head entry: the
                      * producer-consumer contract means sem_post was
-                     * called without a usable list_push, or a state
+                     * called without a usable mpsc_push, or a state
                      * transition posted without a real message. Break
                      * out of the inner loop and block on sem_wait
-                     * rather than spinning, spinning grabs sendbolt
-                     * at MHz rates and creates main-thread contention
-                     * in netw_add_msg. */
+                     * rather than spinning on an empty queue. */
                     if (ptr) free_nstr(&ptr);
                     message_sent = 1;
                 }
@@ -3647,17 +3686,16 @@ void* netw_recv_func(void* NET) {
                         tmpstate = ntohl(nboctet);
                         nboctet = tmpstate;
 
-                        Malloc(recvdmsg, N_STR, 1);
+                        /* small messages get their structure and data in one cached block */
+                        recvdmsg = new_nstr_inline(nboctet);
                         if (!recvdmsg) {
                             DONE = 3;
                         } else {
                             n_log(LOG_DEBUG, "socket %d : %" PRIu32 " octets to receive...", netw->link.sock, nboctet);
-                            Malloc(recvdmsg->data, char, nboctet + 1);
                             if (!recvdmsg->data) {
                                 free_nstr(&recvdmsg);
                                 DONE = 4;
                             } else {
-                                recvdmsg->length = nboctet + 1;
                                 recvdmsg->written = nboctet;
 
                                 /* receiving the data itself */
@@ -3693,10 +3731,10 @@ void* netw_recv_func(void* NET) {
                                         }
                                     }
                                     if (!DONE) {
-                                        pthread_mutex_lock(&netw->recvbolt);
-                                        if (list_push(netw->recv_buf, recvdmsg, free_nstr_ptr) == FALSE)
+                                        if (netw_push_recv_msg(netw, recvdmsg) == FALSE) {
+                                            free_nstr(&recvdmsg);
                                             DONE = 6;
-                                        pthread_mutex_unlock(&netw->recvbolt);
+                                        }
                                         n_log(LOG_DEBUG, "socket %d : %" PRIu32 " octets received !", netw->link.sock, nboctet);
                                     }
                                 } /* recv data */
@@ -4591,13 +4629,8 @@ ssize_t recv_php(SOCKET s, int* _code, char** buf) {
 int netw_get_queue_status(NETWORK* netw, size_t* nb_to_send, size_t* nb_to_read) {
     __n_assert(netw, return FALSE);
 
-    pthread_mutex_lock(&netw->sendbolt);
-    (*nb_to_send) = netw->send_buf->nb_items;
-    pthread_mutex_unlock(&netw->sendbolt);
-
-    pthread_mutex_lock(&netw->recvbolt);
-    (*nb_to_read) = netw->recv_buf->nb_items;
-    pthread_mutex_unlock(&netw->recvbolt);
+    (*nb_to_send) = mpsc_nb_items(netw->send_buf);
+    (*nb_to_read) = mpsc_nb_items(netw->recv_buf);
 
     return TRUE;
 } /* get queue states */
@@ -5374,6 +5407,142 @@ int netw_build_http_response(N_STR** http_response, int status_code, const char*
     return TRUE;
 }
 
+/**
+ * @brief function to dynamically generate an HTTP response in a string builder. The headers are printed in the builder and the body is only referenced, so a big body is never copied before being sent with netw_send_builder
+ * @param builder N_STR_BUILDER receiving the response. It is emptied first
+ * @param status_code response http status code
+ * @param server_name response 'Server' in headers
+ * @param content_type response 'Content-Type' in headers
+ * @param additional_headers additional response headers, can be "" if no additional headers, else 'backslash r backslash n' separated key: values
+ * @param body response body, can be NULL. It must stay valid until the builder is sent and emptied
+ * @return TRUE if the http response was built, FALSE if not
+ */
+int netw_build_http_response_builder(N_STR_BUILDER* builder, int status_code, const char* server_name, const char* content_type, char* additional_headers, N_STR* body) {
+    __n_assert(builder, return FALSE);
+    __n_assert(server_name, return FALSE);
+    __n_assert(content_type, return FALSE);
+    __n_assert(additional_headers, return FALSE);
+
+    const char* status_message = netw_get_http_status_message(status_code);
+    const char* connection_type = "close";
+
+    char date_buffer[128] = "";
+    netw_get_http_date(date_buffer, sizeof(date_buffer));
+
+    nstr_builder_empty(builder);
+
+    if (!body || body->written == 0) {
+        return nstr_builder_printf(builder,
+                                   "HTTP/1.1 %d %s\r\n"
+                                   "Date: %s\r\n"
+                                   "Server: %s\r\n"
+                                   "Content-Length: 0\r\n"
+                                   "%s"
+                                   "Connection: %s\r\n\r\n",
+                                   status_code, status_message, date_buffer, server_name, additional_headers, connection_type);
+    }
+    if (nstr_builder_printf(builder,
+                            "HTTP/1.1 %d %s\r\n"
+                            "Date: %s\r\n"
+                            "Server: %s\r\n"
+                            "Content-Type: %s\r\n"
+                            "Content-Length: %zu\r\n"
+                            "%s"
+                            "Connection: %s\r\n\r\n",
+                            status_code, status_message, date_buffer, server_name, content_type, body->written, additional_headers, connection_type) == FALSE) {
+        return FALSE;
+    }
+    return nstr_builder_append_ref(builder, body->data, body->written);
+} /* netw_build_http_response_builder(...) */
+
+/**
+ * @brief send the content of a string builder on a connected NETWORK without flattening it. Plain sockets gather the chunks with sendmsg, SSL connections write them one after the other
+ * @param netw connected NETWORK
+ * @param builder N_STR_BUILDER to send
+ * @return number of bytes sent, NETW_SOCKET_DISCONNECTED on disconnection, NETW_SOCKET_ERROR on error
+ */
+ssize_t netw_send_builder(NETWORK* netw, const N_STR_BUILDER* builder) {
+    __n_assert(netw, return NETW_SOCKET_ERROR);
+    __n_assert(builder, return NETW_SOCKET_ERROR);
+
+    size_t total = 0;
+#ifndef __windows__
+    if (netw->crypto_algo != NETW_ENCRYPT_OPENSSL) {
+        SOCKET s = netw->link.sock;
+        struct iovec iov[NSTR_BUILDER_IOV_MAX];
+        N_STR_CHUNK* chunk = builder->first;
+        size_t offset = 0;
+        while (chunk) {
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            N_STR_CHUNK* it = chunk;
+            size_t it_offset = offset;
+            while (it && msg.msg_iovlen < NSTR_BUILDER_IOV_MAX) {
+                if (it->written > it_offset) {
+                    iov[msg.msg_iovlen].iov_base = it->data + it_offset;
+                    iov[msg.msg_iovlen].iov_len = it->written - it_offset;
+                    msg.msg_iovlen++;
+                }
+                it = it->next;
+                it_offset = 0;
+            }
+            if (msg.msg_iovlen == 0)
+                break;
+            msg.msg_iov = iov;
+
+            ssize_t bs = 0;
+            NETW_CALL_RETRY(bs, sendmsg(s, &msg, NETFLAGS), NETW_MAX_RETRIES);
+            int error = neterrno;
+            if (bs > 0) {
+                total += (size_t)bs;
+                /* skip what was sent, a partial send leaves chunk and offset in the middle */
+                size_t done = (size_t)bs;
+                while (chunk && done >= chunk->written - offset) {
+                    done -= chunk->written - offset;
+                    chunk = chunk->next;
+                    offset = 0;
+                }
+                offset += done;
+            } else if (bs == 0 || error == ECONNRESET || error == ENOTCONN || error == EPIPE) {
+                n_log(LOG_DEBUG, "socket %d disconnected !", s);
+                return NETW_SOCKET_DISCONNECTED;
+            } else if (bs == -2) {
+                _netw_capture_error(netw, "Socket %d : retry storm on send (%d retries)", s, NETW_MAX_RETRIES);
+                n_log(LOG_ERR, "Socket %d : retry storm on send (%d retries)", s, NETW_MAX_RETRIES);
+                return NETW_SOCKET_ERROR;
+            } else {
+                char* errmsg = netstrerror(error);
+                _netw_capture_error(netw, "Socket %d sendmsg error: %d, %s", s, bs, _str(errmsg));
+                n_log(LOG_ERR, "Socket %d sendmsg error: %d, %s", s, bs, _str(errmsg));
+                FreeNoLog(errmsg);
+                return NETW_SOCKET_ERROR;
+            }
+        }
+        return (ssize_t)total;
+    }
+#endif
+    for (N_STR_CHUNK* chunk = builder->first; chunk; chunk = chunk->next) {
+        size_t offset = 0;
+        while (offset < chunk->written) {
+            size_t len = chunk->written - offset;
+            if (len > UINT32_MAX)
+                len = UINT32_MAX;
+            ssize_t bs = 0;
+#ifdef HAVE_OPENSSL
+            if (netw->crypto_algo == NETW_ENCRYPT_OPENSSL)
+                bs = send_ssl_data(netw, chunk->data + offset, (uint32_t)len);
+            else
+#endif
+                bs = send_data(netw, chunk->data + offset, (uint32_t)len);
+            if (bs <= 0)
+                return (bs == 0) ? NETW_SOCKET_DISCONNECTED : bs;
+            offset += (size_t)bs;
+        }
+        total += chunk->written;
+    }
+    return (ssize_t)total;
+} /* netw_send_builder(...) */
+
 #ifdef HAVE_OPENSSL
 
 /*! @brief write bytes to a WebSocket connection (SSL or plain)
@@ -375,8 +375,8 @@ int get_str_from_msg(NETW_MSG* msg, char** value) {
             n_log(LOG_ERR, "Previous pointer value %p overriden by pointer %p", (*value), val);
         }
 
-        (*value) = val->data;
-        Free(val);
+        (*value) = nstr_detach_data(val);
+        free_nstr(&val);
         return TRUE;
     }
     return FALSE;
@@ -401,20 +401,20 @@ int get_bytes_from_msg(NETW_MSG* msg, void** out_bytes, size_t* out_len) {
     if (!val) return FALSE;
 
     if (!val->data || val->written == 0) {
-        FreeNoLog(val->data);
-        Free(val);
+        free_nstr(&val);
         *out_bytes = NULL;
         *out_len = 0;
         return FALSE;
     }
 
     /* Hand the allocation to the caller, reuses the N_STR buffer to
-     * avoid an extra copy. The caller frees with plain free(). */
-    *out_bytes = val->data;
-    *out_len = val->written;
-    val->data = NULL;
-    Free(val);
-    return TRUE;
+     * avoid an extra copy unless it is inline. The caller frees with
+     * plain free(). */
+    size_t written = val->written;
+    *out_bytes = nstr_detach_data(val);
+    *out_len = (*out_bytes) ? written : 0;
+    free_nstr(&val);
+    return (*out_bytes) ? TRUE : FALSE;
 } /* get_bytes_from_msg(...) */
 
 /**
@@ -446,13 +446,11 @@ N_STR* make_str_from_msg(NETW_MSG* msg) {
         node = node->next;
     }
 
-    /* preparing the new string */
-    Malloc(generated_str, N_STR, 1);
+    /* preparing the new string, small messages are kept in one allocation */
+    generated_str = new_nstr_inline(str_length);
     __n_assert(generated_str, return NULL);
-    Malloc(generated_str->data, char, str_length + 1);
-    __n_assert(generated_str->data, Free(generated_str); return NULL);
+    __n_assert(generated_str->data, free_nstr(&generated_str); return NULL);
 
-    generated_str->length = str_length + 1;
     generated_str->written = str_length;
 
     /* copying header */
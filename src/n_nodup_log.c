@@ -101,8 +101,8 @@ static char* get_nodup_key(const char* file, const char* func, int line) {
     char* ptr = NULL;
     nstrprintf(nstr, "%s%s%d", file, func, line);
     __n_assert(nstr, return NULL);
-    ptr = nstr->data;
-    Free(nstr);
+    ptr = nstr_detach_data(nstr);
+    free_nstr(&nstr);
     return ptr;
 } /* get_nodup_key */
 
@@ -119,8 +119,8 @@ static char* get_nodup_indexed_key(const char* file, const char* func, const cha
     char* ptr = NULL;
     nstrprintf(nstr, "%s%s%s%d", file, func, prefix, line);
     __n_assert(nstr, return NULL);
-    ptr = nstr->data;
-    Free(nstr);
+    ptr = nstr_detach_data(nstr);
+    free_nstr(&nstr);
     return ptr;
 } /* get_nodup_indexed_key */
 
@@ -354,11 +354,9 @@ int dump_nodup_log(char* file) {
     __n_assert(out, close(fd); Free(tmpfile); return FALSE);
 
     if (_n_nodup_table) {
-        for (unsigned long int it = 0; it < _n_nodup_table->size; it++) {
-            list_foreach(list_node, _n_nodup_table->hash_table[it]) {
-                const HASH_NODE* hash_node = (const HASH_NODE*)list_node->ptr;
-                fprintf(out, "%s\n", hash_node->data.string);
-            }
+        ht_foreach(list_node, _n_nodup_table) {
+            const HASH_NODE* hash_node = (const HASH_NODE*)list_node->ptr;
+            fprintf(out, "%s\n", hash_node->data.string);
         }
     }
     fclose(out);
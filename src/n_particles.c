@@ -47,6 +47,9 @@ int init_particle_system(PARTICLE_SYSTEM** psys, int max, double x, double y, do
 
     size_t list_max = (max <= 0) ? UNLIMITED_LIST_ITEMS : (size_t)max;
     (*psys)->list = new_generic_list(list_max);
+    __n_assert((*psys)->list, Free((*psys)); return FALSE);
+    /* particles die and spawn every frame, keep their list nodes */
+    list_node_cache((*psys)->list, (list_max > 0 && list_max < LIST_NODE_CACHE_SIZE) ? list_max : LIST_NODE_CACHE_SIZE);
 
     (*psys)->source[0] = x;
     (*psys)->source[1] = y;
@@ -0,0 +1,394 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ *@file n_pqueue.c
+ *@brief Priority queue functions
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#include "nilorea/n_pqueue.h"
+
+#include <string.h>
+#include <inttypes.h>
+
+/**
+ *@brief create a new priority queue
+ *@param arity number of children per heap node, 0 for PQUEUE_DEFAULT_ARITY. Wider heaps are shallower, so pushes and decrease-key climb fewer levels, while pops compare more children per level.
+ *@param capacity number of entries to allocate, 0 for PQUEUE_DEFAULT_CAPACITY. The queue grows as needed.
+ *@param destructor called on the data removed by pqueue_remove or left in the queue, or NULL
+ *@return a new PQUEUE or NULL
+ */
+PQUEUE* new_pqueue(size_t arity, size_t capacity, void (*destructor)(void* ptr)) {
+    if (arity == 0)
+        arity = PQUEUE_DEFAULT_ARITY;
+    if (arity < 2) {
+        n_log(LOG_ERR, "priority queue arity must be at least 2, got %zu", arity);
+        return NULL;
+    }
+    if (capacity == 0)
+        capacity = PQUEUE_DEFAULT_CAPACITY;
+
+    PQUEUE* pq = NULL;
+    Malloc(pq, PQUEUE, 1);
+    __n_assert(pq, return NULL);
+    Malloc(pq->heap, PQUEUE_ENTRY, capacity);
+    Malloc(pq->items, PQUEUE_ITEM, capacity);
+    Malloc(pq->free_handles, size_t, capacity);
+    if (!pq->heap || !pq->items || !pq->free_handles) {
+        FreeNoLog(pq->heap);
+        FreeNoLog(pq->items);
+        FreeNoLog(pq->free_handles);
+        Free(pq);
+        return NULL;
+    }
+    pq->capacity = capacity;
+    pq->arity = arity;
+    pq->destroy_func = destructor;
+    return pq;
+} /* new_pqueue(...) */
+
+/**
+ *@brief make room for nb_items entries
+ *@param pq targeted queue
+ *@param nb_items number of entries needed
+ *@return TRUE or FALSE
+ */
+int _pqueue_reserve(PQUEUE* pq, size_t nb_items) {
+    if (nb_items <= pq->capacity)
+        return TRUE;
+    size_t capacity = pq->capacity * 2;
+    if (capacity < nb_items)
+        capacity = nb_items;
+    if (Realloc(pq->heap, PQUEUE_ENTRY, capacity) == FALSE)
+        return FALSE;
+    if (Realloc(pq->items, PQUEUE_ITEM, capacity) == FALSE)
+        return FALSE;
+    if (Realloc(pq->free_handles, size_t, capacity) == FALSE)
+        return FALSE;
+    pq->capacity = capacity;
+    return TRUE;
+} /* _pqueue_reserve(...) */
+
+/**
+ *@brief get a free handle, room must have been reserved
+ *@param pq targeted queue
+ *@param ptr data of the handle
+ *@return the handle
+ */
+size_t _pqueue_new_handle(PQUEUE* pq, void* ptr) {
+    size_t handle = (pq->nb_free_handles > 0) ? pq->free_handles[--pq->nb_free_handles] : pq->nb_handles++;
+    pq->items[handle].ptr = ptr;
+    return handle;
+} /* _pqueue_new_handle(...) */
+
+/**
+ *@brief tell if a handle is in the queue
+ *@param pq targeted queue
+ *@param handle handle to check
+ *@return TRUE or FALSE
+ */
+FORCE_INLINE int _pqueue_valid_handle(const PQUEUE* pq, size_t handle) {
+    return (handle < pq->nb_handles && pq->items[handle].pos != PQUEUE_NO_HANDLE) ? TRUE : FALSE;
+} /* _pqueue_valid_handle(...) */
+
+/**
+ *@brief move an entry towards the root until its parent is not greater. The entry is carried as a hole instead of being swapped at each level.
+ *@param pq targeted queue
+ *@param pos index of the entry
+ */
+void _pqueue_sift_up(PQUEUE* pq, size_t pos) {
+    PQUEUE_ENTRY entry = pq->heap[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / pq->arity;
+        if (pq->heap[parent].key <= entry.key)
+            break;
+        pq->heap[pos] = pq->heap[parent];
+        pq->items[pq->heap[pos].handle].pos = pos;
+        pos = parent;
+    }
+    pq->heap[pos] = entry;
+    pq->items[entry.handle].pos = pos;
+} /* _pqueue_sift_up(...) */
+
+/**
+ *@brief move an entry towards the leaves until no child is smaller
+ *@param pq targeted queue
+ *@param pos index of the entry
+ */
+void _pqueue_sift_down(PQUEUE* pq, size_t pos) {
+    PQUEUE_ENTRY entry = pq->heap[pos];
+    while (TRUE) {
+        size_t first = pos * pq->arity + 1;
+        if (first >= pq->nb_items)
+            break;
+        size_t end = first + pq->arity;
+        if (end > pq->nb_items)
+            end = pq->nb_items;
+        /* the children are contiguous, one pass over them finds the smallest */
+        size_t smallest = first;
+        for (size_t child = first + 1; child < end; child++) {
+            if (pq->heap[child].key < pq->heap[smallest].key)
+                smallest = child;
+        }
+        if (pq->heap[smallest].key >= entry.key)
+            break;
+        pq->heap[pos] = pq->heap[smallest];
+        pq->items[pq->heap[pos].handle].pos = pos;
+        pos = smallest;
+    }
+    pq->heap[pos] = entry;
+    pq->items[entry.handle].pos = pos;
+} /* _pqueue_sift_down(...) */
+
+/**
+ *@brief add an item
+ *@param pq targeted queue
+ *@param key priority of the item, the smallest comes first
+ *@param ptr data of the item
+ *@return the handle of the item, valid until it is popped or removed, or PQUEUE_NO_HANDLE on error
+ */
+size_t pqueue_push(PQUEUE* pq, int64_t key, void* ptr) {
+    __n_assert(pq, return PQUEUE_NO_HANDLE);
+    if (_pqueue_reserve(pq, pq->nb_items + 1) == FALSE)
+        return PQUEUE_NO_HANDLE;
+    size_t handle = _pqueue_new_handle(pq, ptr);
+    size_t pos = pq->nb_items++;
+    pq->heap[pos].key = key;
+    pq->heap[pos].handle = handle;
+    _pqueue_sift_up(pq, pos);
+    return handle;
+} /* pqueue_push(...) */
+
+/**
+ *@brief add items in bulk. When they outnumber the items already queued, the whole heap is rebuilt bottom-up in linear time instead of sifting each new item up.
+ *@param pq targeted queue
+ *@param keys priorities of the items
+ *@param ptrs data of the items
+ *@param nb number of items
+ *@param handles set to the handles of the items, or NULL
+ *@return TRUE or FALSE
+ */
+int pqueue_heapify(PQUEUE* pq, const int64_t* keys, void* const* ptrs, size_t nb, size_t* handles) {
+    __n_assert(pq, return FALSE);
+    __n_assert(keys, return FALSE);
+    __n_assert(ptrs, return FALSE);
+    if (_pqueue_reserve(pq, pq->nb_items + nb) == FALSE)
+        return FALSE;
+
+    size_t first_new = pq->nb_items;
+    for (size_t it = 0; it < nb; it++) {
+        size_t handle = _pqueue_new_handle(pq, ptrs[it]);
+        size_t pos = pq->nb_items++;
+        pq->heap[pos].key = keys[it];
+        pq->heap[pos].handle = handle;
+        pq->items[handle].pos = pos;
+        if (handles)
+            handles[it] = handle;
+    }
+    if (nb > first_new) {
+        if (pq->nb_items > 1) {
+            for (size_t pos = (pq->nb_items - 2) / pq->arity + 1; pos > 0; pos--)
+                _pqueue_sift_down(pq, pos - 1);
+        }
+    } else {
+        for (size_t pos = first_new; pos < pq->nb_items; pos++)
+            _pqueue_sift_up(pq, pos);
+    }
+    return TRUE;
+} /* pqueue_heapify(...) */
+
+/**
+ *@brief get the item with the smallest key without removing it
+ *@param pq targeted queue
+ *@param key set to the key, or NULL
+ *@param ptr set to the data, or NULL
+ *@return TRUE or FALSE if the queue is empty
+ */
+int pqueue_peek(const PQUEUE* pq, int64_t* key, void** ptr) {
+    __n_assert(pq, return FALSE);
+    if (pq->nb_items == 0)
+        return FALSE;
+    if (key)
+        (*key) = pq->heap[0].key;
+    if (ptr)
+        (*ptr) = pq->items[pq->heap[0].handle].ptr;
+    return TRUE;
+} /* pqueue_peek(...) */
+
+/**
+ *@brief take an entry out of the heap and free its handle
+ *@param pq targeted queue
+ *@param pos index of the entry
+ *@return the data of the entry
+ */
+void* _pqueue_take(PQUEUE* pq, size_t pos) {
+    PQUEUE_ENTRY taken = pq->heap[pos];
+    void* ptr = pq->items[taken.handle].ptr;
+    pq->items[taken.handle].pos = PQUEUE_NO_HANDLE;
+    pq->items[taken.handle].ptr = NULL;
+    pq->free_handles[pq->nb_free_handles++] = taken.handle;
+
+    pq->nb_items--;
+    if (pos < pq->nb_items) {
+        /* the last entry fills the hole, then goes where its key belongs */
+        pq->heap[pos] = pq->heap[pq->nb_items];
+        if (pq->heap[pos].key < taken.key)
+            _pqueue_sift_up(pq, pos);
+        else
+            _pqueue_sift_down(pq, pos);
+    }
+    return ptr;
+} /* _pqueue_take(...) */
+
+/**
+ *@brief remove the item with the smallest key and give it to the caller. Among equal keys the order is unspecified.
+ *@param pq targeted queue
+ *@param key set to the key, or NULL
+ *@param ptr set to the data, or NULL
+ *@return TRUE or FALSE if the queue is empty
+ */
+int pqueue_pop(PQUEUE* pq, int64_t* key, void** ptr) {
+    __n_assert(pq, return FALSE);
+    if (pq->nb_items == 0)
+        return FALSE;
+    if (key)
+        (*key) = pq->heap[0].key;
+    void* data = _pqueue_take(pq, 0);
+    if (ptr)
+        (*ptr) = data;
+    return TRUE;
+} /* pqueue_pop(...) */
+
+/**
+ *@brief get the key and data of a handle
+ *@param pq targeted queue
+ *@param handle handle of the item
+ *@param key set to the key, or NULL
+ *@param ptr set to the data, or NULL
+ *@return TRUE or FALSE if the handle is not in the queue
+ */
+int pqueue_get(const PQUEUE* pq, size_t handle, int64_t* key, void** ptr) {
+    __n_assert(pq, return FALSE);
+    if (_pqueue_valid_handle(pq, handle) == FALSE)
+        return FALSE;
+    if (key)
+        (*key) = pq->heap[pq->items[handle].pos].key;
+    if (ptr)
+        (*ptr) = pq->items[handle].ptr;
+    return TRUE;
+} /* pqueue_get(...) */
+
+/**
+ *@brief change the key of a handle and move it where the new key belongs
+ *@param pq targeted queue
+ *@param handle handle of the item
+ *@param key new key
+ *@return TRUE or FALSE if the handle is not in the queue
+ */
+int pqueue_update_key(PQUEUE* pq, size_t handle, int64_t key) {
+    __n_assert(pq, return FALSE);
+    if (_pqueue_valid_handle(pq, handle) == FALSE) {
+        n_log(LOG_ERR, "handle %zu is not in the priority queue", handle);
+        return FALSE;
+    }
+    size_t pos = pq->items[handle].pos;
+    int64_t old_key = pq->heap[pos].key;
+    pq->heap[pos].key = key;
+    if (key < old_key)
+        _pqueue_sift_up(pq, pos);
+    else if (key > old_key)
+        _pqueue_sift_down(pq, pos);
+    return TRUE;
+} /* pqueue_update_key(...) */
+
+/**
+ *@brief lower the key of a handle, i.e. a shorter path found to an open node
+ *@param pq targeted queue
+ *@param handle handle of the item
+ *@param key new key, lower or equal to the current one
+ *@return TRUE or FALSE if the handle is not in the queue or key is greater than the current one
+ */
+int pqueue_decrease_key(PQUEUE* pq, size_t handle, int64_t key) {
+    __n_assert(pq, return FALSE);
+    if (_pqueue_valid_handle(pq, handle) == FALSE) {
+        n_log(LOG_ERR, "handle %zu is not in the priority queue", handle);
+        return FALSE;
+    }
+    size_t pos = pq->items[handle].pos;
+    if (key > pq->heap[pos].key) {
+        n_log(LOG_ERR, "can't decrease the key of handle %zu from %" PRId64 " to %" PRId64, handle, pq->heap[pos].key, key);
+        return FALSE;
+    }
+    pq->heap[pos].key = key;
+    _pqueue_sift_up(pq, pos);
+    return TRUE;
+} /* pqueue_decrease_key(...) */
+
+/**
+ *@brief remove a handle from the queue and destroy its data
+ *@param pq targeted queue
+ *@param handle handle of the item
+ *@return TRUE or FALSE if the handle is not in the queue
+ */
+int pqueue_remove(PQUEUE* pq, size_t handle) {
+    __n_assert(pq, return FALSE);
+    if (_pqueue_valid_handle(pq, handle) == FALSE)
+        return FALSE;
+    void* ptr = _pqueue_take(pq, pq->items[handle].pos);
+    if (pq->destroy_func && ptr)
+        pq->destroy_func(ptr);
+    return TRUE;
+} /* pqueue_remove(...) */
+
+/**
+ *@brief remove all the items and destroy their data. All the handles become invalid.
+ *@param pq targeted queue
+ *@return TRUE or FALSE
+ */
+int pqueue_empty(PQUEUE* pq) {
+    __n_assert(pq, return FALSE);
+    if (pq->destroy_func) {
+        for (size_t it = 0; it < pq->nb_items; it++) {
+            void* ptr = pq->items[pq->heap[it].handle].ptr;
+            if (ptr)
+                pq->destroy_func(ptr);
+        }
+    }
+    pq->nb_items = 0;
+    pq->nb_handles = 0;
+    pq->nb_free_handles = 0;
+    return TRUE;
+} /* pqueue_empty(...) */
+
+/**
+ *@brief destroy a priority queue and the data left in it
+ *@param pq pointer to the queue to destroy
+ *@return TRUE or FALSE
+ */
+int destroy_pqueue(PQUEUE** pq) {
+    __n_assert(pq && (*pq), return FALSE);
+    pqueue_empty(*pq);
+    Free((*pq)->heap);
+    Free((*pq)->items);
+    Free((*pq)->free_handles);
+    Free((*pq));
+    return TRUE;
+} /* destroy_pqueue(...) */
@@ -167,7 +167,7 @@ static int reactor_epoll_mod(n_reactor* r, NETWORK* netw, uint32_t ev_mask) {
     return epoll_ctl(r->epoll_fd, EPOLL_CTL_MOD, netw->link.sock, &ev) == 0;
 }
 
-/* Pop the next N_STR from netw->send_buf (under sendbolt) and pre-frame
+/* Pop the next N_STR from netw->send_buf (consumer side, under sendbolt) and pre-frame
  * it into a contiguous buffer ready to send: 4-byte state word + 4-byte
  * payload length + payload bytes, with optional zlib/lz4 compression
  * applied to the payload (same gating as netw_send_func: compress_mode
@@ -181,7 +181,7 @@ static int reactor_send_state_load_next(NETWORK* netw) {
     if (netw->reactor_send_buf) return 1; /* already loaded */
 
     pthread_mutex_lock(&netw->sendbolt);
-    N_STR* msg = list_shift(netw->send_buf, N_STR);
+    N_STR* msg = (N_STR*)mpsc_pop(netw->send_buf);
     pthread_mutex_unlock(&netw->sendbolt);
     if (!msg) return 0;
 
@@ -299,8 +299,8 @@ static int reactor_drain_writes(NETWORK* netw, n_reactor* reactor) {
 
 /* Push a fully-received frame onto the NETWORK's recv_buf. Mirrors
  * the thread-mode netw_recv_func tail: optionally decompresses
- * based on the frame's state-word flags, then list_push under the
- * recvbolt mutex. Frees pkt_payload on failure. */
+ * based on the frame's state-word flags, then a lock-free netw_push_recv_msg.
+ * Frees pkt_payload on failure. */
 static void reactor_recv_dispatch_frame(NETWORK* netw,
                                         uint32_t pkt_state,
                                         uint32_t pkt_length,
@@ -340,14 +340,11 @@ static void reactor_recv_dispatch_frame(NETWORK* netw,
         }
     }
 
-    pthread_mutex_lock(&netw->recvbolt);
-    if (list_push(netw->recv_buf, msg, free_nstr_ptr) == FALSE) {
-        pthread_mutex_unlock(&netw->recvbolt);
-        n_log(LOG_ERR, "n_reactor: recv_buf list_push failed; dropping frame");
+    if (netw_push_recv_msg(netw, msg) == FALSE) {
+        n_log(LOG_ERR, "n_reactor: recv_buf push failed; dropping frame");
         free_nstr(&msg);
         return;
     }
-    pthread_mutex_unlock(&netw->recvbolt);
 }
 
 /* Sweep the registered list for NETWORKs whose game thread has set
@@ -386,7 +383,7 @@ static void reactor_sweep_exit_asked(n_reactor* reactor) {
         /* Best-effort drain, peer is going away so partial is fine.
          * Swallow the return value: error / EAGAIN both lead to the
          * same teardown path next. */
-        if (n->reactor_send_buf || (n->send_buf && n->send_buf->nb_items > 0)) {
+        if (n->reactor_send_buf || (n->send_buf && mpsc_nb_items(n->send_buf) > 0)) {
             (void)reactor_drain_writes(n, reactor);
         }
         /* Half-close the write side so the peer's read side observes
@@ -737,12 +734,12 @@ void n_reactor_run(n_reactor* reactor) {
                          * message can be lost. */
                         __atomic_store_n(&netw->in_dirty_list, 0, __ATOMIC_RELEASE);
                         /* Quick check: nothing to do if both buffers
-                         * (in-flight + queue) are empty. The recvbolt
-                         * isn't taken, we read nb_items as a hint;
+                         * (in-flight + queue) are empty. No lock is
+                         * taken, we read nb_items as a hint;
                          * the producer may be in the middle of a
                          * push, but the next wake will catch it. */
                         int has_inflight = (netw->reactor_send_buf != NULL);
-                        int has_queued = (netw->send_buf->nb_items > 0);
+                        int has_queued = (mpsc_nb_items(netw->send_buf) > 0);
                         if (has_inflight || has_queued) {
                             drains_this_walk++;
                             int rc = reactor_drain_writes(netw, reactor);
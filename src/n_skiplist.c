@@ -0,0 +1,808 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ *@file n_skiplist.c
+ *@brief Lock free skip list map functions
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#include "nilorea/n_skiplist.h"
+
+#include <string.h>
+#include <inttypes.h>
+#include <sched.h>
+
+/*! tell if a next pointer carries the removed mark */
+#define SKIPLIST_IS_MARKED(__ptr_) (((uintptr_t)(__ptr_)) & 1)
+/*! get a next pointer with the removed mark */
+#define SKIPLIST_MARK(__ptr_) ((SKIPLIST_NODE*)(((uintptr_t)(__ptr_)) | 1))
+/*! get a next pointer without the removed mark */
+#define SKIPLIST_UNMARK(__ptr_) ((SKIPLIST_NODE*)(((uintptr_t)(__ptr_)) & ~(uintptr_t)1))
+
+/**
+ *@brief allocate a node
+ *@param key key of the node
+ *@param level number of levels of the node
+ *@return a new zeroed node or NULL
+ */
+SKIPLIST_NODE* _skiplist_new_node(int64_t key, int level) {
+    char* mem = NULL;
+    Malloc(mem, char, sizeof(SKIPLIST_NODE) + (size_t)level * sizeof(SKIPLIST_NODE*));
+    __n_assert(mem, return NULL);
+    SKIPLIST_NODE* node = (SKIPLIST_NODE*)mem;
+    node->key = key;
+    node->level = level;
+    node->link_refs = 2;
+    return node;
+} /* _skiplist_new_node(...) */
+
+/**
+ *@brief draw the number of levels of a new node, one more level with a probability of 1/4
+ *@param sl targeted skip list
+ *@return a level between 1 and SKIPLIST_MAX_LEVEL
+ */
+int _skiplist_random_level(SKIPLIST* sl) {
+    uint64_t bits = __atomic_add_fetch(&sl->seed, 0x9E3779B97F4A7C15ULL, __ATOMIC_RELAXED);
+    bits ^= bits >> 33;
+    bits *= 0xff51afd7ed558ccdULL;
+    bits ^= bits >> 33;
+    bits *= 0xc4ceb9fe1a85ec53ULL;
+    bits ^= bits >> 33;
+    int level = 1;
+    while ((bits & 3) == 0 && level < SKIPLIST_MAX_LEVEL) {
+        level++;
+        bits >>= 2;
+    }
+    return level;
+} /* _skiplist_random_level(...) */
+
+/**
+ *@brief destroy a value and its data
+ *@param value value no reader can reach anymore
+ */
+void _skiplist_free_value(SKIPLIST_VALUE* value) {
+    if (value->type == HASH_STRING) {
+        Free(value->data.string);
+    } else if (value->type == HASH_PTR && value->destroy_func && value->data.ptr) {
+        value->destroy_func(value->data.ptr);
+    }
+    Free(value);
+} /* _skiplist_free_value(...) */
+
+/**
+ *@brief create a new lock free skip list map. Keys are int64_t, i.e. timestamps: events sharing a timestamp must be given distinct keys to be kept apart.
+ *@return a new SKIPLIST or NULL
+ */
+SKIPLIST* new_skiplist(void) {
+    SKIPLIST* sl = NULL;
+    Malloc(sl, SKIPLIST, 1);
+    __n_assert(sl, return NULL);
+    sl->head = _skiplist_new_node(INT64_MIN, SKIPLIST_MAX_LEVEL);
+    if (!sl->head) {
+        Free(sl);
+        return NULL;
+    }
+    if (pthread_mutex_init(&sl->reclaim_lock, NULL) != 0) {
+        n_log(LOG_ERR, "could not init skip list reclaim lock");
+        Free(sl->head);
+        Free(sl);
+        return NULL;
+    }
+    return sl;
+} /* new_skiplist(...) */
+
+/**
+ *@brief enter a lock free read section. The nodes and values reachable from the list are not freed before the matching skiplist_read_exit. Writers can be called from inside, but their reclamation is then delayed.
+ *@param sl targeted skip list
+ *@return the epoch parity to give back to skiplist_read_exit
+ */
+size_t skiplist_read_enter(SKIPLIST* sl) {
+    while (TRUE) {
+        size_t epoch = __atomic_load_n(&sl->epoch, __ATOMIC_SEQ_CST);
+        size_t parity = epoch & 1;
+        __atomic_add_fetch(&sl->readers[parity], 1, __ATOMIC_SEQ_CST);
+        /* a reclamation flipped the epoch meanwhile and may not have counted us, register again */
+        if (__atomic_load_n(&sl->epoch, __ATOMIC_SEQ_CST) == epoch)
+            return parity;
+        __atomic_sub_fetch(&sl->readers[parity], 1, __ATOMIC_SEQ_CST);
+    }
+} /* skiplist_read_enter(...) */
+
+/**
+ *@brief leave a lock free read section
+ *@param sl targeted skip list
+ *@param parity value returned by the matching skiplist_read_enter
+ */
+void skiplist_read_exit(SKIPLIST* sl, size_t parity) {
+    __atomic_sub_fetch(&sl->readers[parity], 1, __ATOMIC_SEQ_CST);
+} /* skiplist_read_exit(...) */
+
+/**
+ *@brief queue a node unlinked from all its levels for reclamation
+ *@param sl targeted skip list
+ *@param node unlinked node
+ */
+void _skiplist_retire_node(SKIPLIST* sl, SKIPLIST_NODE* node) {
+    SKIPLIST_NODE* head = __atomic_load_n(&sl->retired_nodes, __ATOMIC_RELAXED);
+    do {
+        node->retired_next = head;
+    } while (!__atomic_compare_exchange_n(&sl->retired_nodes, &head, node, TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_add_fetch(&sl->nb_retired, 1, __ATOMIC_RELAXED);
+} /* _skiplist_retire_node(...) */
+
+/**
+ *@brief queue a replaced or removed value for reclamation
+ *@param sl targeted skip list
+ *@param value value no longer reachable from a node
+ */
+void _skiplist_retire_value(SKIPLIST* sl, SKIPLIST_VALUE* value) {
+    SKIPLIST_VALUE* head = __atomic_load_n(&sl->retired_values, __ATOMIC_RELAXED);
+    do {
+        value->retired_next = head;
+    } while (!__atomic_compare_exchange_n(&sl->retired_values, &head, value, TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_add_fetch(&sl->nb_retired, 1, __ATOMIC_RELAXED);
+} /* _skiplist_retire_value(...) */
+
+/**
+ *@brief queue a popped value record for reclamation. Only the record is freed, its data belongs to the caller of skiplist_pop_first.
+ *@param sl targeted skip list
+ *@param value record no longer reachable from a node
+ */
+void _skiplist_retire_record(SKIPLIST* sl, SKIPLIST_VALUE* value) {
+    SKIPLIST_VALUE* head = __atomic_load_n(&sl->retired_records, __ATOMIC_RELAXED);
+    do {
+        value->retired_next = head;
+    } while (!__atomic_compare_exchange_n(&sl->retired_records, &head, value, TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_add_fetch(&sl->nb_retired, 1, __ATOMIC_RELAXED);
+} /* _skiplist_retire_record(...) */
+
+/**
+ *@brief wait until no reader of the given parity is left
+ *@param sl targeted skip list
+ *@param parity epoch parity to wait for
+ *@return TRUE or FALSE if readers were still there after SKIPLIST_SYNC_SPINS yields
+ */
+int _skiplist_wait_readers(SKIPLIST* sl, size_t parity) {
+    for (size_t spins = 0; __atomic_load_n(&sl->readers[parity], __ATOMIC_SEQ_CST) != 0; spins++) {
+        if (spins >= SKIPLIST_SYNC_SPINS)
+            return FALSE;
+        sched_yield();
+    }
+    return TRUE;
+} /* _skiplist_wait_readers(...) */
+
+/**
+ *@brief free the retired nodes and values once the readers that could see them have left. Only one thread reclaims at a time, the others return at once. Must not be called from inside a read section, else the frees are delayed to a later call.
+ *@param sl targeted skip list
+ *@return TRUE or FALSE if some entries are still pending
+ */
+int skiplist_reclaim(SKIPLIST* sl) {
+    __n_assert(sl, return FALSE);
+
+    if (pthread_mutex_trylock(&sl->reclaim_lock) != 0)
+        return FALSE;
+
+    __atomic_store_n(&sl->nb_retired, 0, __ATOMIC_RELAXED);
+    SKIPLIST_NODE* nodes = __atomic_exchange_n(&sl->retired_nodes, NULL, __ATOMIC_ACQUIRE);
+    while (nodes) {
+        SKIPLIST_NODE* node = nodes;
+        nodes = node->retired_next;
+        node->retired_next = sl->pending_nodes;
+        sl->pending_nodes = node;
+    }
+    SKIPLIST_VALUE* values = __atomic_exchange_n(&sl->retired_values, NULL, __ATOMIC_ACQUIRE);
+    while (values) {
+        SKIPLIST_VALUE* value = values;
+        values = value->retired_next;
+        value->retired_next = sl->pending_values;
+        sl->pending_values = value;
+    }
+    SKIPLIST_VALUE* records = __atomic_exchange_n(&sl->retired_records, NULL, __ATOMIC_ACQUIRE);
+    while (records) {
+        SKIPLIST_VALUE* record = records;
+        records = record->retired_next;
+        record->retired_next = sl->pending_records;
+        sl->pending_records = record;
+    }
+    if (!sl->pending_nodes && !sl->pending_values && !sl->pending_records) {
+        pthread_mutex_unlock(&sl->reclaim_lock);
+        return TRUE;
+    }
+
+    size_t parity = __atomic_load_n(&sl->epoch, __ATOMIC_SEQ_CST) & 1;
+    /* readers left over from a previous, timed out, reclamation */
+    int synced = _skiplist_wait_readers(sl, parity ^ 1);
+    if (synced == TRUE) {
+        /* new readers go to the other counter, and can't reach the unlinked entries */
+        __atomic_add_fetch(&sl->epoch, 1, __ATOMIC_SEQ_CST);
+        synced = _skiplist_wait_readers(sl, parity);
+    }
+    if (synced == TRUE) {
+        while (sl->pending_nodes) {
+            SKIPLIST_NODE* node = sl->pending_nodes;
+            sl->pending_nodes = node->retired_next;
+            Free(node);
+        }
+        while (sl->pending_values) {
+            SKIPLIST_VALUE* value = sl->pending_values;
+            sl->pending_values = value->retired_next;
+            _skiplist_free_value(value);
+        }
+        while (sl->pending_records) {
+            SKIPLIST_VALUE* record = sl->pending_records;
+            sl->pending_records = record->retired_next;
+            Free(record);
+        }
+    }
+    pthread_mutex_unlock(&sl->reclaim_lock);
+    return synced;
+} /* skiplist_reclaim(...) */
+
+/**
+ *@brief reclaim the retired entries if there are enough of them. Called by the writers once out of their read section.
+ *@param sl targeted skip list
+ */
+void _skiplist_maybe_reclaim(SKIPLIST* sl) {
+    if (__atomic_load_n(&sl->nb_retired, __ATOMIC_RELAXED) >= SKIPLIST_RETIRE_BATCH)
+        skiplist_reclaim(sl);
+} /* _skiplist_maybe_reclaim(...) */
+
+/**
+ *@brief locate key at each level, unlinking the removed nodes met on the way. Must be called inside a read section.
+ *@param sl targeted skip list
+ *@param key key to locate
+ *@param preds set to the last node before key at each level
+ *@param succs set to the first node not before key at each level
+ *@return TRUE if succs[0] holds key, else FALSE
+ */
+int _skiplist_find(SKIPLIST* sl, int64_t key, SKIPLIST_NODE** preds, SKIPLIST_NODE** succs) {
+    SKIPLIST_NODE* pred = NULL;
+retry:
+    pred = sl->head;
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) {
+        SKIPLIST_NODE* curr = SKIPLIST_UNMARK(__atomic_load_n(&pred->next[level], __ATOMIC_ACQUIRE));
+        while (curr) {
+            SKIPLIST_NODE* succ = __atomic_load_n(&curr->next[level], __ATOMIC_ACQUIRE);
+            if (SKIPLIST_IS_MARKED(succ)) {
+                SKIPLIST_NODE* expected = curr;
+                /* pred was removed or changed meanwhile: start over */
+                if (!__atomic_compare_exchange_n(&pred->next[level], &expected, SKIPLIST_UNMARK(succ), FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                    goto retry;
+                curr = SKIPLIST_UNMARK(succ);
+                continue;
+            }
+            if (curr->key >= key)
+                break;
+            pred = curr;
+            curr = succ;
+        }
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+    return (succs[0] && succs[0]->key == key) ? TRUE : FALSE;
+} /* _skiplist_find(...) */
+
+/**
+ *@brief unlink all the removed nodes holding key, at every level. Unlike _skiplist_find it walks past the live node of the same key, behind which a late inserter may have linked a removed one. Must be called inside a read section.
+ *@param sl targeted skip list
+ *@param key key of the removed node
+ */
+void _skiplist_unlink(SKIPLIST* sl, int64_t key) {
+    SKIPLIST_NODE* pred = NULL;
+retry:
+    pred = sl->head;
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) {
+        SKIPLIST_NODE* level_pred = pred;
+        SKIPLIST_NODE* curr = SKIPLIST_UNMARK(__atomic_load_n(&level_pred->next[level], __ATOMIC_ACQUIRE));
+        while (curr && curr->key <= key) {
+            SKIPLIST_NODE* succ = __atomic_load_n(&curr->next[level], __ATOMIC_ACQUIRE);
+            if (SKIPLIST_IS_MARKED(succ)) {
+                SKIPLIST_NODE* expected = curr;
+                if (!__atomic_compare_exchange_n(&level_pred->next[level], &expected, SKIPLIST_UNMARK(succ), FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                    goto retry;
+                curr = SKIPLIST_UNMARK(succ);
+                continue;
+            }
+            level_pred = curr;
+            /* the next level starts from the last node before key */
+            if (curr->key < key)
+                pred = curr;
+            curr = succ;
+        }
+    }
+} /* _skiplist_unlink(...) */
+
+/**
+ *@brief drop one of the two link references of a node, and retire it when it is the last one
+ *@param sl targeted skip list
+ *@param node inserted or removed node
+ */
+void _skiplist_release_node(SKIPLIST* sl, SKIPLIST_NODE* node) {
+    if (__atomic_sub_fetch(&node->link_refs, 1, __ATOMIC_ACQ_REL) == 0)
+        _skiplist_retire_node(sl, node);
+} /* _skiplist_release_node(...) */
+
+/**
+ *@brief logically remove a node by marking its next pointers, then unlink it. Must be called inside a read section.
+ *@param sl targeted skip list
+ *@param node node to remove
+ *@return the value of the node, or NULL if another thread removed it first
+ */
+SKIPLIST_VALUE* _skiplist_remove_node(SKIPLIST* sl, SKIPLIST_NODE* node) {
+    for (int level = node->level - 1; level >= 1; level--) {
+        SKIPLIST_NODE* succ = __atomic_load_n(&node->next[level], __ATOMIC_ACQUIRE);
+        while (!SKIPLIST_IS_MARKED(succ)) {
+            if (__atomic_compare_exchange_n(&node->next[level], &succ, SKIPLIST_MARK(succ), FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                break;
+        }
+    }
+    /* marking the lowest level decides which remover wins */
+    SKIPLIST_NODE* succ = __atomic_load_n(&node->next[0], __ATOMIC_ACQUIRE);
+    while (TRUE) {
+        if (SKIPLIST_IS_MARKED(succ))
+            return NULL;
+        if (__atomic_compare_exchange_n(&node->next[0], &succ, SKIPLIST_MARK(succ), FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            break;
+    }
+    SKIPLIST_VALUE* value = __atomic_exchange_n(&node->value, NULL, __ATOMIC_ACQ_REL);
+    __atomic_sub_fetch(&sl->nb_items, 1, __ATOMIC_RELAXED);
+    _skiplist_unlink(sl, node->key);
+    _skiplist_release_node(sl, node);
+    return value;
+} /* _skiplist_remove_node(...) */
+
+/**
+ *@brief put a value at key, replacing and retiring the previous one. Must be called inside a read section.
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param value value to put
+ *@return TRUE or FALSE
+ */
+int _skiplist_insert(SKIPLIST* sl, int64_t key, SKIPLIST_VALUE* value) {
+    SKIPLIST_NODE* preds[SKIPLIST_MAX_LEVEL];
+    SKIPLIST_NODE* succs[SKIPLIST_MAX_LEVEL];
+    SKIPLIST_NODE* node = NULL;
+
+    while (TRUE) {
+        if (_skiplist_find(sl, key, preds, succs) == TRUE) {
+            SKIPLIST_NODE* found = succs[0];
+            SKIPLIST_VALUE* old = __atomic_load_n(&found->value, __ATOMIC_ACQUIRE);
+            while (old) {
+                if (__atomic_compare_exchange_n(&found->value, &old, value, FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                    _skiplist_retire_value(sl, old);
+                    if (node) {
+                        Free(node);
+                    }
+                    return TRUE;
+                }
+            }
+            /* the remover took the value, the node is on its way out */
+            continue;
+        }
+        if (!node) {
+            node = _skiplist_new_node(key, _skiplist_random_level(sl));
+            __n_assert(node, return FALSE);
+            node->value = value;
+        }
+        for (int level = 0; level < node->level; level++)
+            node->next[level] = succs[level];
+        SKIPLIST_NODE* expected = succs[0];
+        /* counted first so that a fast remover never takes the count below zero */
+        __atomic_add_fetch(&sl->nb_items, 1, __ATOMIC_RELAXED);
+        /* the node is in the map once linked at the lowest level */
+        if (__atomic_compare_exchange_n(&preds[0]->next[0], &expected, node, FALSE, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            break;
+        __atomic_sub_fetch(&sl->nb_items, 1, __ATOMIC_RELAXED);
+    }
+
+    for (int level = 1; level < node->level; level++) {
+        while (TRUE) {
+            SKIPLIST_NODE* succ = __atomic_load_n(&node->next[level], __ATOMIC_ACQUIRE);
+            if (SKIPLIST_IS_MARKED(succ))
+                goto linked;
+            if (succ != succs[level] && !__atomic_compare_exchange_n(&node->next[level], &succ, succs[level], FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                goto linked;
+            SKIPLIST_NODE* expected = succs[level];
+            if (__atomic_compare_exchange_n(&preds[level]->next[level], &expected, node, FALSE, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+                break;
+            /* the neighbours changed, locate them again unless the node was removed meanwhile */
+            if (_skiplist_find(sl, key, preds, succs) == FALSE || succs[0] != node)
+                goto linked;
+        }
+    }
+linked:
+    /* a remover may have run its unlink before we linked the upper levels */
+    if (SKIPLIST_IS_MARKED(__atomic_load_n(&node->next[0], __ATOMIC_ACQUIRE)))
+        _skiplist_unlink(sl, key);
+    _skiplist_release_node(sl, node);
+    return TRUE;
+} /* _skiplist_insert(...) */
+
+/**
+ *@brief get the first live node whose key is greater or equal to key, without writing. Must be called inside a read section.
+ *@param sl targeted skip list
+ *@param key key to look for
+ *@return the node or NULL
+ */
+SKIPLIST_NODE* _skiplist_ceiling_node(SKIPLIST* sl, int64_t key) {
+    SKIPLIST_NODE* pred = sl->head;
+    SKIPLIST_NODE* curr = NULL;
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) {
+        curr = SKIPLIST_UNMARK(__atomic_load_n(&pred->next[level], __ATOMIC_ACQUIRE));
+        while (curr && curr->key < key) {
+            pred = curr;
+            curr = SKIPLIST_UNMARK(__atomic_load_n(&curr->next[level], __ATOMIC_ACQUIRE));
+        }
+    }
+    while (curr && SKIPLIST_IS_MARKED(__atomic_load_n(&curr->next[0], __ATOMIC_ACQUIRE)))
+        curr = SKIPLIST_UNMARK(__atomic_load_n(&curr->next[0], __ATOMIC_ACQUIRE));
+    return curr;
+} /* _skiplist_ceiling_node(...) */
+
+/**
+ *@brief allocate a value record and put it at key
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param type HASH_INT, HASH_DOUBLE, HASH_STRING or HASH_PTR
+ *@param data value
+ *@param destructor HASH_PTR destructor or NULL
+ *@return TRUE or FALSE
+ */
+int _skiplist_put(SKIPLIST* sl, int64_t key, int type, union HASH_DATA data, void (*destructor)(void* ptr)) {
+    SKIPLIST_VALUE* value = NULL;
+    Malloc(value, SKIPLIST_VALUE, 1);
+    __n_assert(value, return FALSE);
+    value->type = type;
+    value->data = data;
+    value->destroy_func = destructor;
+
+    size_t parity = skiplist_read_enter(sl);
+    int ret = _skiplist_insert(sl, key, value);
+    skiplist_read_exit(sl, parity);
+    if (ret == FALSE) {
+        Free(value);
+    }
+    _skiplist_maybe_reclaim(sl);
+    return ret;
+} /* _skiplist_put(...) */
+
+/**
+ *@brief put an integer at key
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param value integer to put
+ *@return TRUE or FALSE
+ */
+int skiplist_put_int(SKIPLIST* sl, int64_t key, HASH_INT_TYPE value) {
+    __n_assert(sl, return FALSE);
+    union HASH_DATA data = {.ival = value};
+    return _skiplist_put(sl, key, HASH_INT, data, NULL);
+} /* skiplist_put_int(...) */
+
+/**
+ *@brief put a double at key
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param value double to put
+ *@return TRUE or FALSE
+ */
+int skiplist_put_double(SKIPLIST* sl, int64_t key, double value) {
+    __n_assert(sl, return FALSE);
+    union HASH_DATA data = {.fval = value};
+    return _skiplist_put(sl, key, HASH_DOUBLE, data, NULL);
+} /* skiplist_put_double(...) */
+
+/**
+ *@brief put a copy of a string at key
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param string string to copy, NULL is accepted
+ *@return TRUE or FALSE
+ */
+int skiplist_put_string(SKIPLIST* sl, int64_t key, char* string) {
+    __n_assert(sl, return FALSE);
+    union HASH_DATA data = {.string = NULL};
+    if (string) {
+        data.string = strdup(string);
+        __n_assert(data.string, return FALSE);
+    }
+    if (_skiplist_put(sl, key, HASH_STRING, data, NULL) == FALSE) {
+        FreeNoLog(data.string);
+        return FALSE;
+    }
+    return TRUE;
+} /* skiplist_put_string(...) */
+
+/**
+ *@brief put a string at key, the map takes ownership of it and frees it when it is replaced or removed
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param string allocated string
+ *@return TRUE or FALSE
+ */
+int skiplist_put_string_ptr(SKIPLIST* sl, int64_t key, char* string) {
+    __n_assert(sl, return FALSE);
+    union HASH_DATA data = {.string = string};
+    return _skiplist_put(sl, key, HASH_STRING, data, NULL);
+} /* skiplist_put_string_ptr(...) */
+
+/**
+ *@brief put a pointer at key
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param ptr pointer to put
+ *@param destructor called on ptr once it is replaced or removed and no reader can see it, or NULL
+ *@return TRUE or FALSE
+ */
+int skiplist_put_ptr(SKIPLIST* sl, int64_t key, void* ptr, void (*destructor)(void* ptr)) {
+    __n_assert(sl, return FALSE);
+    union HASH_DATA data = {.ptr = ptr};
+    return _skiplist_put(sl, key, HASH_PTR, data, destructor);
+} /* skiplist_put_ptr(...) */
+
+/**
+ *@brief copy the value at key if it has the given type
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param type expected type
+ *@param data set to the value
+ *@return TRUE or FALSE
+ */
+int _skiplist_get(SKIPLIST* sl, int64_t key, int type, union HASH_DATA* data) {
+    __n_assert(sl, return FALSE);
+    int ret = FALSE;
+    size_t parity = skiplist_read_enter(sl);
+    SKIPLIST_NODE* node = _skiplist_ceiling_node(sl, key);
+    if (node && node->key == key) {
+        SKIPLIST_VALUE* value = __atomic_load_n(&node->value, __ATOMIC_ACQUIRE);
+        if (value && value->type == type) {
+            (*data) = value->data;
+            ret = TRUE;
+        } else if (value) {
+            n_log(LOG_ERR, "Can't get key[%" PRId64 "] of type %d, key is type %d", key, type, value->type);
+        }
+    }
+    skiplist_read_exit(sl, parity);
+    return ret;
+} /* _skiplist_get(...) */
+
+/**
+ *@brief get the integer at key. Leave val untouched if key is not found.
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param val set to the integer
+ *@return TRUE or FALSE
+ */
+int skiplist_get_int(SKIPLIST* sl, int64_t key, HASH_INT_TYPE* val) {
+    union HASH_DATA data;
+    if (_skiplist_get(sl, key, HASH_INT, &data) == FALSE)
+        return FALSE;
+    (*val) = data.ival;
+    return TRUE;
+} /* skiplist_get_int(...) */
+
+/**
+ *@brief get the double at key. Leave val untouched if key is not found.
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param val set to the double
+ *@return TRUE or FALSE
+ */
+int skiplist_get_double(SKIPLIST* sl, int64_t key, double* val) {
+    union HASH_DATA data;
+    if (_skiplist_get(sl, key, HASH_DOUBLE, &data) == FALSE)
+        return FALSE;
+    (*val) = data.fval;
+    return TRUE;
+} /* skiplist_get_double(...) */
+
+/**
+ *@brief get the string at key. Leave val untouched if key is not found. The string stays owned by the map and is valid until the key is replaced or removed, or until the end of the caller's read section.
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param val set to the string
+ *@return TRUE or FALSE
+ */
+int skiplist_get_string(SKIPLIST* sl, int64_t key, char** val) {
+    union HASH_DATA data;
+    if (_skiplist_get(sl, key, HASH_STRING, &data) == FALSE)
+        return FALSE;
+    (*val) = data.string;
+    return TRUE;
+} /* skiplist_get_string(...) */
+
+/**
+ *@brief get the pointer at key. Leave val untouched if key is not found. Same lifetime as skiplist_get_string.
+ *@param sl targeted skip list
+ *@param key key of the value
+ *@param val set to the pointer
+ *@return TRUE or FALSE
+ */
+int skiplist_get_ptr(SKIPLIST* sl, int64_t key, void** val) {
+    union HASH_DATA data;
+    if (_skiplist_get(sl, key, HASH_PTR, &data) == FALSE)
+        return FALSE;
+    (*val) = data.ptr;
+    return TRUE;
+} /* skiplist_get_ptr(...) */
+
+/**
+ *@brief remove key. Its value is destroyed once no reader can see it.
+ *@param sl targeted skip list
+ *@param key key to remove
+ *@return TRUE or FALSE if key was not found
+ */
+int skiplist_remove(SKIPLIST* sl, int64_t key) {
+    __n_assert(sl, return FALSE);
+    SKIPLIST_NODE* preds[SKIPLIST_MAX_LEVEL];
+    SKIPLIST_NODE* succs[SKIPLIST_MAX_LEVEL];
+    SKIPLIST_VALUE* value = NULL;
+
+    size_t parity = skiplist_read_enter(sl);
+    if (_skiplist_find(sl, key, preds, succs) == TRUE)
+        value = _skiplist_remove_node(sl, succs[0]);
+    if (value)
+        _skiplist_retire_value(sl, value);
+    skiplist_read_exit(sl, parity);
+    _skiplist_maybe_reclaim(sl);
+    return value ? TRUE : FALSE;
+} /* skiplist_remove(...) */
+
+/**
+ *@brief remove the smallest key and give its value to the caller, who becomes responsible for freeing a HASH_STRING or destroying a HASH_PTR. Meant for draining events in order while other threads insert. Readers that got the value before the pop may still use it: when other threads read the list, call skiplist_reclaim until it returns TRUE, out of any read section, before freeing the popped data.
+ *@param sl targeted skip list
+ *@param key set to the removed key
+ *@param type set to the type of the value
+ *@param data set to the value
+ *@return TRUE or FALSE if the list is empty
+ */
+int skiplist_pop_first(SKIPLIST* sl, int64_t* key, int* type, union HASH_DATA* data) {
+    __n_assert(sl, return FALSE);
+    SKIPLIST_VALUE* value = NULL;
+
+    size_t parity = skiplist_read_enter(sl);
+    while (!value) {
+        SKIPLIST_NODE* node = _skiplist_ceiling_node(sl, INT64_MIN);
+        if (!node)
+            break;
+        value = _skiplist_remove_node(sl, node);
+        if (value) {
+            (*key) = node->key;
+            (*type) = value->type;
+            (*data) = value->data;
+        }
+    }
+    skiplist_read_exit(sl, parity);
+    if (!value)
+        return FALSE;
+    /* the caller owns the data now, only the record goes through reclamation */
+    _skiplist_retire_record(sl, value);
+    _skiplist_maybe_reclaim(sl);
+    return TRUE;
+} /* skiplist_pop_first(...) */
+
+/**
+ *@brief get the greatest key lower or equal to key
+ *@param sl targeted skip list
+ *@param key key to look for
+ *@param found set to the found key
+ *@return TRUE or FALSE if there is none
+ */
+int skiplist_floor(SKIPLIST* sl, int64_t key, int64_t* found) {
+    __n_assert(sl, return FALSE);
+    SKIPLIST_NODE* preds[SKIPLIST_MAX_LEVEL];
+    SKIPLIST_NODE* succs[SKIPLIST_MAX_LEVEL];
+    int ret = TRUE;
+
+    size_t parity = skiplist_read_enter(sl);
+    /* _skiplist_find only steps on nodes that were live, preds[0] is the floor when key is missing */
+    if (_skiplist_find(sl, key, preds, succs) == TRUE)
+        (*found) = key;
+    else if (preds[0] != sl->head)
+        (*found) = preds[0]->key;
+    else
+        ret = FALSE;
+    skiplist_read_exit(sl, parity);
+    return ret;
+} /* skiplist_floor(...) */
+
+/**
+ *@brief get the smallest key greater or equal to key
+ *@param sl targeted skip list
+ *@param key key to look for
+ *@param found set to the found key
+ *@return TRUE or FALSE if there is none
+ */
+int skiplist_ceiling(SKIPLIST* sl, int64_t key, int64_t* found) {
+    __n_assert(sl, return FALSE);
+    size_t parity = skiplist_read_enter(sl);
+    SKIPLIST_NODE* node = _skiplist_ceiling_node(sl, key);
+    if (node)
+        (*found) = node->key;
+    skiplist_read_exit(sl, parity);
+    return node ? TRUE : FALSE;
+} /* skiplist_ceiling(...) */
+
+/**
+ *@brief call func on each key from min to max included, in increasing order, inside a read section. Keys put or removed concurrently may or may not be seen.
+ *@param sl targeted skip list
+ *@param min first key of the range
+ *@param max last key of the range
+ *@param func called with each key and its value, returns TRUE to go on or FALSE to stop
+ *@param user_data passed to func
+ *@return the number of keys given to func
+ */
+size_t skiplist_range(SKIPLIST* sl, int64_t min, int64_t max, int (*func)(int64_t key, int type, union HASH_DATA data, void* user_data), void* user_data) {
+    __n_assert(sl, return 0);
+    __n_assert(func, return 0);
+    size_t nb = 0;
+
+    size_t parity = skiplist_read_enter(sl);
+    SKIPLIST_NODE* node = _skiplist_ceiling_node(sl, min);
+    while (node && node->key <= max) {
+        SKIPLIST_NODE* next = __atomic_load_n(&node->next[0], __ATOMIC_ACQUIRE);
+        SKIPLIST_VALUE* value = __atomic_load_n(&node->value, __ATOMIC_ACQUIRE);
+        if (!SKIPLIST_IS_MARKED(next) && value) {
+            nb++;
+            if (func(node->key, value->type, value->data, user_data) == FALSE)
+                break;
+        }
+        node = SKIPLIST_UNMARK(next);
+    }
+    skiplist_read_exit(sl, parity);
+    return nb;
+} /* skiplist_range(...) */
+
+/**
+ *@brief get the number of keys
+ *@param sl targeted skip list
+ *@return the number of keys in the map
+ */
+size_t skiplist_nb_items(SKIPLIST* sl) {
+    __n_assert(sl, return 0);
+    return __atomic_load_n(&sl->nb_items, __ATOMIC_RELAXED);
+} /* skiplist_nb_items(...) */
+
+/**
+ *@brief destroy a skip list, its nodes and values. No other thread may use it anymore.
+ *@param sl pointer to the skip list to destroy
+ *@return TRUE or FALSE
+ */
+int destroy_skiplist(SKIPLIST** sl) {
+    __n_assert(sl && (*sl), return FALSE);
+
+    SKIPLIST_NODE* node = SKIPLIST_UNMARK((*sl)->head->next[0]);
+    while (node) {
+        SKIPLIST_NODE* next = SKIPLIST_UNMARK(node->next[0]);
+        if (node->value)
+            _skiplist_free_value(node->value);
+        Free(node);
+        node = next;
+    }
+    Free((*sl)->head);
+
+    /* no reader left, everything retired can go */
+    skiplist_reclaim(*sl);
+
+    pthread_mutex_destroy(&(*sl)->reclaim_lock);
+    Free((*sl));
+    return TRUE;
+} /* destroy_skiplist(...) */
@@ -26,30 +26,92 @@
 
 #include "nilorea/n_stack.h"
 
+#include <string.h>
+
 /**
- * @brief allocate a new STACK
- * @param size size of the new stack
+ * @brief get the size of a raw value of a given type
+ * @param v_type type of the value, STACK_ITEM_BOOL to STACK_ITEM_PTR
+ * @return the size of the value, or 0 for an unknown type
+ */
+static size_t _stack_value_size(uint8_t v_type) {
+    switch (v_type) {
+        case STACK_ITEM_BOOL:
+            return sizeof(bool);
+        case STACK_ITEM_CHAR:
+            return sizeof(char);
+        case STACK_ITEM_UINT8:
+        case STACK_ITEM_INT8:
+            return sizeof(uint8_t);
+        case STACK_ITEM_UINT32:
+        case STACK_ITEM_INT32:
+            return sizeof(uint32_t);
+#ifdef ENV_64BITS
+        case STACK_ITEM_UINT64:
+        case STACK_ITEM_INT64:
+            return sizeof(uint64_t);
+#endif
+        case STACK_ITEM_FLOAT:
+            return sizeof(float);
+        case STACK_ITEM_DOUBLE:
+            return sizeof(double);
+        case STACK_ITEM_PTR:
+            return sizeof(void*);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief allocate a new STACK with a given layout
+ * @param size size of the new stack. One cell stays free to tell a full stack from an empty one.
+ * @param flags 0 or a mix of STACK_PACKED and STACK_SPSC. STACK_PACKED stacks hold raw values of v_type only, without the STACK_ITEM flags and union, and refuse the other types. STACK_SPSC stacks can be pushed by one thread and popped by another without lock.
+ * @param v_type STACK_PACKED stacks: type of all the values, else ignored
  * @return the new STACK *stack or NULL
  */
-STACK* new_stack(size_t size) {
+STACK* new_stack_ex(size_t size, int flags, uint8_t v_type) {
     STACK* stack = NULL;
 
     if (size == 0) {
         n_log(LOG_ERR, "stack size cannot be 0");
         return NULL;
     }
+    size_t item_size = 0;
+    if (flags & STACK_PACKED) {
+        item_size = _stack_value_size(v_type);
+        if (item_size == 0) {
+            n_log(LOG_ERR, "unknown packed stack value type %d", v_type);
+            return NULL;
+        }
+    }
 
     Malloc(stack, STACK, 1);
     __n_assert(stack, return NULL);
-    Malloc(stack->stack_array, STACK_ITEM, size);
-    __n_assert(stack->stack_array, Free(stack); return NULL;);
+    if (flags & STACK_PACKED) {
+        Malloc(stack->packed_array, char, size * item_size);
+        __n_assert(stack->packed_array, Free(stack); return NULL;);
+        stack->v_type = v_type;
+        stack->item_size = item_size;
+    } else {
+        Malloc(stack->stack_array, STACK_ITEM, size);
+        __n_assert(stack->stack_array, Free(stack); return NULL;);
+    }
 
     stack->size = size;
     stack->head = stack->tail = 0;
     stack->nb_items = 0;
+    stack->flags = flags;
     return stack;
 }
 
+/**
+ * @brief allocate a new STACK
+ * @param size size of the new stack
+ * @return the new STACK *stack or NULL
+ */
+STACK* new_stack(size_t size) {
+    return new_stack_ex(size, 0, 0);
+}
+
 /**
  * @brief delete a STACK *stack
  * @param stack pointer to the STACK *stack to delete
@@ -58,7 +120,8 @@ STACK* new_stack(size_t size) {
 bool delete_stack(STACK** stack) {
     __n_assert(stack, return FALSE);
     __n_assert((*stack), return FALSE);
-    Free((*stack)->stack_array);
+    FreeNoLog((*stack)->stack_array);
+    FreeNoLog((*stack)->packed_array);
     Free((*stack));
     return TRUE;
 }
@@ -70,7 +133,7 @@ bool delete_stack(STACK** stack) {
  */
 bool stack_is_full(const STACK* stack) {
     if (!stack) return false;
-    return ((stack->head + 1) % stack->size == stack->tail);
+    return ((__atomic_load_n(&stack->head, __ATOMIC_ACQUIRE) + 1) % stack->size == __atomic_load_n(&stack->tail, __ATOMIC_ACQUIRE));
 }
 
 /**
@@ -80,11 +143,11 @@ bool stack_is_full(const STACK* stack) {
  */
 bool stack_is_empty(const STACK* stack) {
     if (!stack) return false;
-    return (stack->nb_items == 0);
+    return (__atomic_load_n(&stack->head, __ATOMIC_ACQUIRE) == __atomic_load_n(&stack->tail, __ATOMIC_ACQUIRE));
 }
 
 /**
- * @brief peek in the stack without removing the stack item
+ * @brief peek in the stack without removing the stack item. Not available on STACK_PACKED stacks, and only from the consumer thread of a STACK_SPSC stack.
  * @param stack the STACK *stack to peek
  * @param position the position to peek
  * @return a pointer to a STACK_ITEM or NULL
@@ -93,16 +156,23 @@ STACK_ITEM* stack_peek(STACK* stack, size_t position) {
     STACK_ITEM* item = NULL;
     __n_assert(stack, return NULL);
 
+    if (stack->flags & STACK_PACKED) {
+        n_log(LOG_ERR, "can't peek a STACK_ITEM in a packed stack");
+        return NULL;
+    }
+
     if (stack_is_empty(stack)) {
         return NULL;
     }
 
-    if (stack->tail < stack->head) {
-        if (position >= stack->tail && position < stack->head && position < stack->size && stack->stack_array[position].is_set) {
+    size_t head = __atomic_load_n(&stack->head, __ATOMIC_ACQUIRE);
+    size_t tail = __atomic_load_n(&stack->tail, __ATOMIC_ACQUIRE);
+    if (tail < head) {
+        if (position >= tail && position < head && position < stack->size && stack->stack_array[position].is_set) {
             item = &stack->stack_array[position];
         }
-    } else if (stack->tail > stack->head) {
-        if ((position >= stack->tail || position < stack->head) && position < stack->size && stack->stack_array[position].is_set) {
+    } else if (tail > head) {
+        if ((position >= tail || position < head) && position < stack->size && stack->stack_array[position].is_set) {
             item = &stack->stack_array[position];
         }
     }
@@ -110,70 +180,193 @@ STACK_ITEM* stack_peek(STACK* stack, size_t position) {
 }
 
 /**
- * @brief helper for stack_push. Try to get a new cell in the stack, and store the result in status
+ * @brief add or remove nb items from the item counter, atomically on STACK_SPSC stacks
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_ITEM_OK,STACK_IS_FULL)
- * @return the position in the stack
- */
-size_t __stack_push(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return 0);
+ * @param nb number of items
+ * @param pushed true if the items were pushed, false if they were popped
+ */
+static inline void _stack_count(STACK* stack, size_t nb, bool pushed) {
+    if (stack->flags & STACK_SPSC) {
+        if (pushed)
+            __atomic_add_fetch(&stack->nb_items, nb, __ATOMIC_RELAXED);
+        else
+            __atomic_sub_fetch(&stack->nb_items, nb, __ATOMIC_RELAXED);
+    } else {
+        stack->nb_items = pushed ? stack->nb_items + nb : stack->nb_items - nb;
+    }
+}
 
-    (*status) = STACK_IS_FULL;
-    if (stack_is_full(stack))
-        return 0;
+/**
+ * @brief push a value in the next free cell. The value is written before head is published, so a STACK_SPSC consumer never sees a half written cell.
+ * @param stack target STACK *stack
+ * @param v_type type of the value
+ * @param data value
+ * @param p_type STACK_ITEM_PTR values: user defined pointer type
+ * @return TRUE or FALSE if the stack is full or, STACK_PACKED stacks, holds another type
+ */
+static bool _stack_push_data(STACK* stack, uint8_t v_type, union STACK_DATA data, uint16_t p_type) {
+    __n_assert(stack, return FALSE);
 
-    size_t next_pos = (stack->head + 1) % stack->size;
+    if ((stack->flags & STACK_PACKED) && v_type != stack->v_type) {
+        n_log(LOG_ERR, "can't push a value of type %d in a packed stack of type %d", v_type, stack->v_type);
+        return FALSE;
+    }
 
+    size_t head = __atomic_load_n(&stack->head, __ATOMIC_RELAXED);
+    size_t next_pos = (head + 1) % stack->size;
     // if next_pos == tail, the stack is full
-    if (next_pos == stack->tail) {
-        // status already set to (*status) = STACK_IS_FULL ;
-        return 0;
-    }
+    if (next_pos == __atomic_load_n(&stack->tail, __ATOMIC_ACQUIRE))
+        return FALSE;
 
-    // set data, move, set item status, inc counter
-    (*status) = STACK_ITEM_OK;
-    stack->stack_array[stack->head].is_set = 1;
-    stack->stack_array[stack->head].is_empty = 0;
-    // inc
-    stack->nb_items++;
-    return next_pos;
+    if (stack->flags & STACK_PACKED) {
+        // union members all start at its first byte
+        memcpy((char*)stack->packed_array + head * stack->item_size, &data, stack->item_size);
+    } else {
+        STACK_ITEM* item = &stack->stack_array[head];
+        item->data = data;
+        item->v_type = v_type;
+        item->p_type = p_type;
+        item->is_set = 1;
+        item->is_empty = 0;
+    }
+    __atomic_store_n(&stack->head, next_pos, __ATOMIC_RELEASE);
+    _stack_count(stack, 1, true);
+    return TRUE;
 }
 
 /**
- * @brief helper for stack_pop. Try to remove a new cell in the stack, and store the result in status
+ * @brief pop the oldest value if it has the given type. The cell is read before tail is published, so a STACK_SPSC producer never overwrites it too early.
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
- * @return the position in the stack
+ * @param v_type expected type of the value
+ * @param data set to the value
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
+ * @return TRUE or FALSE
  */
-size_t __stack_pop(STACK* stack, uint8_t* status) {
+static bool _stack_pop_data(STACK* stack, uint8_t v_type, union STACK_DATA* data, uint8_t* status) {
     (*status) = STACK_IS_UNDEFINED;
     __n_assert(stack, return FALSE);
 
-    size_t next_pos = 0;
-    size_t prev_pos = 0;
-
+    size_t tail = __atomic_load_n(&stack->tail, __ATOMIC_RELAXED);
     // if the head == tail, the stack is empty
-    if (stack->head == stack->tail) {
+    if (tail == __atomic_load_n(&stack->head, __ATOMIC_ACQUIRE)) {
         (*status) = STACK_IS_EMPTY;
-        return 0;
+        return FALSE;
     }
 
-    // item is here and read
+    if (stack->flags & STACK_PACKED) {
+        if (v_type != stack->v_type) {
+            (*status) = STACK_ITEM_WRONG_TYPE;
+            return FALSE;
+        }
+        memset(data, 0, sizeof(union STACK_DATA));
+        memcpy(data, (char*)stack->packed_array + tail * stack->item_size, stack->item_size);
+    } else {
+        STACK_ITEM* item = &stack->stack_array[tail];
+        if (item->v_type != v_type) {
+            (*status) = STACK_ITEM_WRONG_TYPE;
+            return FALSE;
+        }
+        (*data) = item->data;
+        item->is_set = 0;
+        item->is_empty = 1;
+    }
+    __atomic_store_n(&stack->tail, (tail + 1) % stack->size, __ATOMIC_RELEASE);
+    _stack_count(stack, 1, false);
     (*status) = STACK_ITEM_OK;
+    return TRUE;
+}
 
-    // next is where tail will point to after this read
-    next_pos = (stack->tail + 1) % stack->size;
+/**
+ * @brief push up to nb values of one type. STACK_PACKED stacks copy them in at most two contiguous runs, around the end of the ring.
+ * @param stack target STACK *stack
+ * @param v_type type of the values
+ * @param values array of nb raw values of type v_type
+ * @param nb number of values
+ * @return the number of values pushed, less than nb if the stack got full
+ */
+size_t stack_push_many(STACK* stack, uint8_t v_type, const void* values, size_t nb) {
+    __n_assert(stack, return 0);
+    __n_assert(values, return 0);
+    size_t value_size = _stack_value_size(v_type);
+    if (value_size == 0 || ((stack->flags & STACK_PACKED) && v_type != stack->v_type)) {
+        n_log(LOG_ERR, "can't push values of type %d in this stack", v_type);
+        return 0;
+    }
+
+    size_t head = __atomic_load_n(&stack->head, __ATOMIC_RELAXED);
+    size_t tail = __atomic_load_n(&stack->tail, __ATOMIC_ACQUIRE);
+    size_t room = (tail + stack->size - head - 1) % stack->size;
+    if (nb > room)
+        nb = room;
+    if (nb == 0)
+        return 0;
+
+    if (stack->flags & STACK_PACKED) {
+        size_t first_run = stack->size - head;
+        if (first_run > nb)
+            first_run = nb;
+        memcpy((char*)stack->packed_array + head * value_size, values, first_run * value_size);
+        memcpy(stack->packed_array, (const char*)values + first_run * value_size, (nb - first_run) * value_size);
+    } else {
+        for (size_t it = 0; it < nb; it++) {
+            STACK_ITEM* item = &stack->stack_array[(head + it) % stack->size];
+            memset(&item->data, 0, sizeof(union STACK_DATA));
+            memcpy(&item->data, (const char*)values + it * value_size, value_size);
+            item->v_type = v_type;
+            item->p_type = 0;
+            item->is_set = 1;
+            item->is_empty = 0;
+        }
+    }
+    __atomic_store_n(&stack->head, (head + nb) % stack->size, __ATOMIC_RELEASE);
+    _stack_count(stack, nb, true);
+    return nb;
+}
 
-    // set item status, dec counter, move, return value
-    stack->stack_array[stack->tail].is_set = 0;
-    stack->stack_array[stack->tail].is_empty = 1;
-    prev_pos = stack->tail;
-    // tail to next offset.
-    stack->tail = next_pos;
-    // dec
-    stack->nb_items--;
-    return prev_pos;
+/**
+ * @brief pop up to nb values of one type, stopping before the first value of another type
+ * @param stack target STACK *stack
+ * @param v_type type of the values
+ * @param values array receiving up to nb raw values of type v_type
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many(STACK* stack, uint8_t v_type, void* values, size_t nb) {
+    __n_assert(stack, return 0);
+    __n_assert(values, return 0);
+    size_t value_size = _stack_value_size(v_type);
+    if (value_size == 0 || ((stack->flags & STACK_PACKED) && v_type != stack->v_type))
+        return 0;
+
+    size_t tail = __atomic_load_n(&stack->tail, __ATOMIC_RELAXED);
+    size_t head = __atomic_load_n(&stack->head, __ATOMIC_ACQUIRE);
+    size_t available = (head + stack->size - tail) % stack->size;
+    if (nb > available)
+        nb = available;
+
+    if (stack->flags & STACK_PACKED) {
+        size_t first_run = stack->size - tail;
+        if (first_run > nb)
+            first_run = nb;
+        memcpy(values, (const char*)stack->packed_array + tail * value_size, first_run * value_size);
+        memcpy((char*)values + first_run * value_size, stack->packed_array, (nb - first_run) * value_size);
+    } else {
+        for (size_t it = 0; it < nb; it++) {
+            STACK_ITEM* item = &stack->stack_array[(tail + it) % stack->size];
+            if (item->v_type != v_type) {
+                nb = it;
+                break;
+            }
+            memcpy((char*)values + it * value_size, &item->data, value_size);
+            item->is_set = 0;
+            item->is_empty = 1;
+        }
+    }
+    if (nb == 0)
+        return 0;
+    __atomic_store_n(&stack->tail, (tail + nb) % stack->size, __ATOMIC_RELEASE);
+    _stack_count(stack, nb, false);
+    return nb;
 }
 
 /**
@@ -183,44 +376,21 @@ size_t __stack_pop(STACK* stack, uint8_t* status) {
  * @return TRUE or FALSE
  */
 bool stack_push_b(STACK* stack, bool b) {
-    uint8_t status = STACK_ITEM_OK;
-    size_t next_pos = __stack_push(stack, &status);
-    if (status != STACK_ITEM_OK)
-        return FALSE;
-    stack->stack_array[stack->head].data.b = b;
-    stack->stack_array[stack->head].v_type = STACK_ITEM_BOOL;
-    stack->head = next_pos;
-
-    return TRUE;
+    union STACK_DATA data = {.b = b};
+    return _stack_push_data(stack, STACK_ITEM_BOOL, data, 0);
 }
 
 /**
  * @brief helper to pop a bool
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
  * @return the popped bool
  */
 bool stack_pop_b(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return FALSE);
-
-    if (stack->head == stack->tail) {
-        (*status) = STACK_IS_EMPTY;
-        return 0;
-    }
-
-    if (stack->stack_array[stack->tail].v_type != STACK_ITEM_BOOL) {
-        (*status) = STACK_ITEM_WRONG_TYPE;
-        return 0;
-    }
-
-    uint8_t pop_status = STACK_IS_UNDEFINED;
-    size_t prev_pos = __stack_pop(stack, &pop_status);
-    if (pop_status != STACK_ITEM_OK) {
-        (*status) = pop_status;
+    union STACK_DATA data;
+    if (_stack_pop_data(stack, STACK_ITEM_BOOL, &data, status) == FALSE)
         return 0;
-    }
-    return stack->stack_array[prev_pos].data.b;
+    return data.b;
 }
 
 /**
@@ -230,46 +400,21 @@ bool stack_pop_b(STACK* stack, uint8_t* status) {
  * @return TRUE or FALSE
  */
 bool stack_push_c(STACK* stack, char c) {
-    uint8_t status = STACK_ITEM_OK;
-
-    size_t next_pos = __stack_push(stack, &status);
-    if (status != STACK_ITEM_OK)
-        return FALSE;
-
-    stack->stack_array[stack->head].data.c = c;
-    stack->stack_array[stack->head].v_type = STACK_ITEM_CHAR;
-    stack->head = next_pos;
-
-    return TRUE;
+    union STACK_DATA data = {.c = c};
+    return _stack_push_data(stack, STACK_ITEM_CHAR, data, 0);
 }
 
 /**
  * @brief helper to pop a char
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
  * @return the popped char
  */
 char stack_pop_c(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return FALSE);
-
-    if (stack->head == stack->tail) {
-        (*status) = STACK_IS_EMPTY;
+    union STACK_DATA data;
+    if (_stack_pop_data(stack, STACK_ITEM_CHAR, &data, status) == FALSE)
         return 0;
-    }
-
-    if (stack->stack_array[stack->tail].v_type != STACK_ITEM_CHAR) {
-        (*status) = STACK_ITEM_WRONG_TYPE;
-        return 0;
-    }
-
-    uint8_t pop_status = STACK_IS_UNDEFINED;
-    size_t prev_pos = __stack_pop(stack, &pop_status);
-    if (pop_status != STACK_ITEM_OK) {
-        (*status) = pop_status;
-        return 0;
-    }
-    return stack->stack_array[prev_pos].data.c;
+    return data.c;
 }
 
 /**
@@ -279,46 +424,21 @@ char stack_pop_c(STACK* stack, uint8_t* status) {
  * @return TRUE or FALSE
  */
 bool stack_push_ui8(STACK* stack, uint8_t ui8) {
-    uint8_t status = STACK_ITEM_OK;
-
-    size_t next_pos = __stack_push(stack, &status);
-    if (status != STACK_ITEM_OK)
-        return FALSE;
-
-    stack->stack_array[stack->head].data.ui8 = ui8;
-    stack->stack_array[stack->head].v_type = STACK_ITEM_UINT8;
-    stack->head = next_pos;
-
-    return TRUE;
+    union STACK_DATA data = {.ui8 = ui8};
+    return _stack_push_data(stack, STACK_ITEM_UINT8, data, 0);
 }
 
 /**
  * @brief helper to pop a uint8_t
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
  * @return the popped uint8_t
  */
 uint8_t stack_pop_ui8(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return FALSE);
-
-    if (stack->head == stack->tail) {
-        (*status) = STACK_IS_EMPTY;
-        return 0;
-    }
-
-    if (stack->stack_array[stack->tail].v_type != STACK_ITEM_UINT8) {
-        (*status) = STACK_ITEM_WRONG_TYPE;
-        return 0;
-    }
-
-    uint8_t pop_status = STACK_IS_UNDEFINED;
-    size_t prev_pos = __stack_pop(stack, &pop_status);
-    if (pop_status != STACK_ITEM_OK) {
-        (*status) = pop_status;
+    union STACK_DATA data;
+    if (_stack_pop_data(stack, STACK_ITEM_UINT8, &data, status) == FALSE)
         return 0;
-    }
-    return stack->stack_array[prev_pos].data.ui8;
+    return data.ui8;
 }
 
 /**
@@ -328,144 +448,69 @@ uint8_t stack_pop_ui8(STACK* stack, uint8_t* status) {
  * @return TRUE or FALSE
  */
 bool stack_push_i8(STACK* stack, int8_t i8) {
-    uint8_t status = STACK_ITEM_OK;
-
-    size_t next_pos = __stack_push(stack, &status);
-    if (status != STACK_ITEM_OK)
-        return FALSE;
-
-    stack->stack_array[stack->head].data.i8 = i8;
-    stack->stack_array[stack->head].v_type = STACK_ITEM_INT8;
-    stack->head = next_pos;
-
-    return TRUE;
+    union STACK_DATA data = {.i8 = i8};
+    return _stack_push_data(stack, STACK_ITEM_INT8, data, 0);
 }
 
 /**
  * @brief helper to pop a int8_t
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
  * @return the popped int8_t
  */
 int8_t stack_pop_i8(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return FALSE);
-
-    if (stack->head == stack->tail) {
-        (*status) = STACK_IS_EMPTY;
+    union STACK_DATA data;
+    if (_stack_pop_data(stack, STACK_ITEM_INT8, &data, status) == FALSE)
         return 0;
-    }
-
-    if (stack->stack_array[stack->tail].v_type != STACK_ITEM_INT8) {
-        (*status) = STACK_ITEM_WRONG_TYPE;
-        return 0;
-    }
-
-    uint8_t pop_status = STACK_IS_UNDEFINED;
-    size_t prev_pos = __stack_pop(stack, &pop_status);
-    if (pop_status != STACK_ITEM_OK) {
-        (*status) = pop_status;
-        return 0;
-    }
-    return stack->stack_array[prev_pos].data.i8;
+    return data.i8;
 }
 
 /**
  * @brief helper to push an uint32_t
  * @param stack target STACK *stack
- * @param ui32 the uint32 to push
+ * @param ui32 the uint32_t to push
  * @return TRUE or FALSE
  */
 bool stack_push_ui32(STACK* stack, uint32_t ui32) {
-    uint8_t status = STACK_ITEM_OK;
-
-    size_t next_pos = __stack_push(stack, &status);
-    if (status != STACK_ITEM_OK)
-        return FALSE;
-
-    stack->stack_array[stack->head].data.ui32 = ui32;
-    stack->stack_array[stack->head].v_type = STACK_ITEM_UINT32;
-    stack->head = next_pos;
-
-    return TRUE;
+    union STACK_DATA data = {.ui32 = ui32};
+    return _stack_push_data(stack, STACK_ITEM_UINT32, data, 0);
 }
 
 /**
  * @brief helper to pop a uint32_t
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
  * @return the popped uint32_t
  */
 uint32_t stack_pop_ui32(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return FALSE);
-
-    if (stack->head == stack->tail) {
-        (*status) = STACK_IS_EMPTY;
-        return 0;
-    }
-
-    if (stack->stack_array[stack->tail].v_type != STACK_ITEM_UINT32) {
-        (*status) = STACK_ITEM_WRONG_TYPE;
-        return 0;
-    }
-
-    uint8_t pop_status = STACK_IS_UNDEFINED;
-    size_t prev_pos = __stack_pop(stack, &pop_status);
-    if (pop_status != STACK_ITEM_OK) {
-        (*status) = pop_status;
+    union STACK_DATA data;
+    if (_stack_pop_data(stack, STACK_ITEM_UINT32, &data, status) == FALSE)
         return 0;
-    }
-    return stack->stack_array[prev_pos].data.ui32;
+    return data.ui32;
 }
 
 /**
  * @brief helper to push an int32_t
  * @param stack target STACK *stack
- * @param i32 the int32 to push
+ * @param i32 the int32_t to push
  * @return TRUE or FALSE
  */
 bool stack_push_i32(STACK* stack, int32_t i32) {
-    uint8_t status = STACK_ITEM_OK;
-
-    size_t next_pos = __stack_push(stack, &status);
-    if (status != STACK_ITEM_OK)
-        return FALSE;
-
-    stack->stack_array[stack->head].data.i32 = i32;
-    stack->stack_array[stack->head].v_type = STACK_ITEM_INT32;
-    stack->head = next_pos;
-
-    return TRUE;
+    union STACK_DATA data = {.i32 = i32};
+    return _stack_push_data(stack, STACK_ITEM_INT32, data, 0);
 }
 
 /**
  * @brief helper to pop a int32_t
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
  * @return the popped int32_t
  */
 int32_t stack_pop_i32(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return FALSE);
-
-    if (stack->head == stack->tail) {
-        (*status) = STACK_IS_EMPTY;
+    union STACK_DATA data;
+    if (_stack_pop_data(stack, STACK_ITEM_INT32, &data, status) == FALSE)
         return 0;
-    }
-
-    if (stack->stack_array[stack->tail].v_type != STACK_ITEM_INT32) {
-        (*status) = STACK_ITEM_WRONG_TYPE;
-        return 0;
-    }
-
-    uint8_t pop_status = STACK_IS_UNDEFINED;
-    size_t prev_pos = __stack_pop(stack, &pop_status);
-    if (pop_status != STACK_ITEM_OK) {
-        (*status) = pop_status;
-        return 0;
-    }
-    return stack->stack_array[prev_pos].data.i32;
+    return data.i32;
 }
 
 /**
@@ -475,46 +520,21 @@ int32_t stack_pop_i32(STACK* stack, uint8_t* status) {
  * @return TRUE or FALSE
  */
 bool stack_push_f(STACK* stack, float f) {
-    uint8_t status = STACK_ITEM_OK;
-
-    size_t next_pos = __stack_push(stack, &status);
-    if (status != STACK_ITEM_OK)
-        return FALSE;
-
-    stack->stack_array[stack->head].data.f = f;
-    stack->stack_array[stack->head].v_type = STACK_ITEM_FLOAT;
-    stack->head = next_pos;
-
-    return TRUE;
+    union STACK_DATA data = {.f = f};
+    return _stack_push_data(stack, STACK_ITEM_FLOAT, data, 0);
 }
 
 /**
  * @brief helper to pop a float
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
  * @return the popped float
  */
 float stack_pop_f(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return FALSE);
-
-    if (stack->head == stack->tail) {
-        (*status) = STACK_IS_EMPTY;
-        return 0;
-    }
-
-    if (stack->stack_array[stack->tail].v_type != STACK_ITEM_FLOAT) {
-        (*status) = STACK_ITEM_WRONG_TYPE;
-        return 0;
-    }
-
-    uint8_t pop_status = STACK_IS_UNDEFINED;
-    size_t prev_pos = __stack_pop(stack, &pop_status);
-    if (pop_status != STACK_ITEM_OK) {
-        (*status) = pop_status;
+    union STACK_DATA data;
+    if (_stack_pop_data(stack, STACK_ITEM_FLOAT, &data, status) == FALSE)
         return 0;
-    }
-    return stack->stack_array[prev_pos].data.f;
+    return data.f;
 }
 
 /**
@@ -524,97 +544,46 @@ float stack_pop_f(STACK* stack, uint8_t* status) {
  * @return TRUE or FALSE
  */
 bool stack_push_d(STACK* stack, double d) {
-    uint8_t status = STACK_ITEM_OK;
-
-    size_t next_pos = __stack_push(stack, &status);
-    if (status != STACK_ITEM_OK)
-        return FALSE;
-
-    stack->stack_array[stack->head].data.d = d;
-    stack->stack_array[stack->head].v_type = STACK_ITEM_DOUBLE;
-    stack->head = next_pos;
-
-    return TRUE;
+    union STACK_DATA data = {.d = d};
+    return _stack_push_data(stack, STACK_ITEM_DOUBLE, data, 0);
 }
 
 /**
  * @brief helper to pop a double
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
  * @return the popped double
  */
 double stack_pop_d(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return FALSE);
-
-    if (stack->head == stack->tail) {
-        (*status) = STACK_IS_EMPTY;
-        return 0;
-    }
-
-    if (stack->stack_array[stack->tail].v_type != STACK_ITEM_DOUBLE) {
-        (*status) = STACK_ITEM_WRONG_TYPE;
-        return 0;
-    }
-
-    uint8_t pop_status = STACK_IS_UNDEFINED;
-    size_t prev_pos = __stack_pop(stack, &pop_status);
-    if (pop_status != STACK_ITEM_OK) {
-        (*status) = pop_status;
+    union STACK_DATA data;
+    if (_stack_pop_data(stack, STACK_ITEM_DOUBLE, &data, status) == FALSE)
         return 0;
-    }
-    return stack->stack_array[prev_pos].data.d;
+    return data.d;
 }
 
 /**
  * @brief helper to push a pointer
  * @param stack target STACK *stack
  * @param p the pointer to push
- * @param p_type the pointer type
+ * @param p_type type of pointer
  * @return TRUE or FALSE
  */
 bool stack_push_p(STACK* stack, void* p, uint16_t p_type) {
-    uint8_t status = STACK_ITEM_OK;
-
-    size_t next_pos = __stack_push(stack, &status);
-    if (status != STACK_ITEM_OK)
-        return FALSE;
-
-    stack->stack_array[stack->head].data.p = p;
-    stack->stack_array[stack->head].v_type = STACK_ITEM_PTR;
-    stack->stack_array[stack->head].p_type = p_type;
-    stack->head = next_pos;
-
-    return TRUE;
+    union STACK_DATA data = {.p = p};
+    return _stack_push_data(stack, STACK_ITEM_PTR, data, p_type);
 }
 
 /**
  * @brief helper to pop a pointer
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
  * @return the popped pointer
  */
 void* stack_pop_p(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return NULL);
-
-    if (stack->head == stack->tail) {
-        (*status) = STACK_IS_EMPTY;
-        return 0;
-    }
-
-    if (stack->stack_array[stack->tail].v_type != STACK_ITEM_PTR) {
-        (*status) = STACK_ITEM_WRONG_TYPE;
-        return 0;
-    }
-
-    uint8_t pop_status = STACK_IS_UNDEFINED;
-    size_t prev_pos = __stack_pop(stack, &pop_status);
-    if (pop_status != STACK_ITEM_OK) {
-        (*status) = pop_status;
-        return 0;
-    }
-    return stack->stack_array[prev_pos].data.p;
+    union STACK_DATA data;
+    if (_stack_pop_data(stack, STACK_ITEM_PTR, &data, status) == FALSE)
+        return NULL;
+    return data.p;
 }
 
 /**
@@ -627,6 +596,204 @@ bool stack_push_p_default(STACK* stack, void* p) {
     return stack_push_p(stack, p, 0);
 }
 
+/**
+ * @brief push an array of bool
+ * @param stack target STACK *stack
+ * @param values the bool to push
+ * @param nb number of values
+ * @return the number of values pushed
+ */
+size_t stack_push_many_b(STACK* stack, const bool* values, size_t nb) {
+    return stack_push_many(stack, STACK_ITEM_BOOL, values, nb);
+}
+
+/**
+ * @brief pop an array of bool
+ * @param stack target STACK *stack
+ * @param values array receiving the popped bool
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many_b(STACK* stack, bool* values, size_t nb) {
+    return stack_pop_many(stack, STACK_ITEM_BOOL, values, nb);
+}
+
+/**
+ * @brief push an array of char
+ * @param stack target STACK *stack
+ * @param values the char to push
+ * @param nb number of values
+ * @return the number of values pushed
+ */
+size_t stack_push_many_c(STACK* stack, const char* values, size_t nb) {
+    return stack_push_many(stack, STACK_ITEM_CHAR, values, nb);
+}
+
+/**
+ * @brief pop an array of char
+ * @param stack target STACK *stack
+ * @param values array receiving the popped char
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many_c(STACK* stack, char* values, size_t nb) {
+    return stack_pop_many(stack, STACK_ITEM_CHAR, values, nb);
+}
+
+/**
+ * @brief push an array of uint8_t
+ * @param stack target STACK *stack
+ * @param values the uint8_t to push
+ * @param nb number of values
+ * @return the number of values pushed
+ */
+size_t stack_push_many_ui8(STACK* stack, const uint8_t* values, size_t nb) {
+    return stack_push_many(stack, STACK_ITEM_UINT8, values, nb);
+}
+
+/**
+ * @brief pop an array of uint8_t
+ * @param stack target STACK *stack
+ * @param values array receiving the popped uint8_t
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many_ui8(STACK* stack, uint8_t* values, size_t nb) {
+    return stack_pop_many(stack, STACK_ITEM_UINT8, values, nb);
+}
+
+/**
+ * @brief push an array of int8_t
+ * @param stack target STACK *stack
+ * @param values the int8_t to push
+ * @param nb number of values
+ * @return the number of values pushed
+ */
+size_t stack_push_many_i8(STACK* stack, const int8_t* values, size_t nb) {
+    return stack_push_many(stack, STACK_ITEM_INT8, values, nb);
+}
+
+/**
+ * @brief pop an array of int8_t
+ * @param stack target STACK *stack
+ * @param values array receiving the popped int8_t
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many_i8(STACK* stack, int8_t* values, size_t nb) {
+    return stack_pop_many(stack, STACK_ITEM_INT8, values, nb);
+}
+
+/**
+ * @brief push an array of uint32_t
+ * @param stack target STACK *stack
+ * @param values the uint32_t to push
+ * @param nb number of values
+ * @return the number of values pushed
+ */
+size_t stack_push_many_ui32(STACK* stack, const uint32_t* values, size_t nb) {
+    return stack_push_many(stack, STACK_ITEM_UINT32, values, nb);
+}
+
+/**
+ * @brief pop an array of uint32_t
+ * @param stack target STACK *stack
+ * @param values array receiving the popped uint32_t
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many_ui32(STACK* stack, uint32_t* values, size_t nb) {
+    return stack_pop_many(stack, STACK_ITEM_UINT32, values, nb);
+}
+
+/**
+ * @brief push an array of int32_t
+ * @param stack target STACK *stack
+ * @param values the int32_t to push
+ * @param nb number of values
+ * @return the number of values pushed
+ */
+size_t stack_push_many_i32(STACK* stack, const int32_t* values, size_t nb) {
+    return stack_push_many(stack, STACK_ITEM_INT32, values, nb);
+}
+
+/**
+ * @brief pop an array of int32_t
+ * @param stack target STACK *stack
+ * @param values array receiving the popped int32_t
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many_i32(STACK* stack, int32_t* values, size_t nb) {
+    return stack_pop_many(stack, STACK_ITEM_INT32, values, nb);
+}
+
+/**
+ * @brief push an array of float
+ * @param stack target STACK *stack
+ * @param values the float to push
+ * @param nb number of values
+ * @return the number of values pushed
+ */
+size_t stack_push_many_f(STACK* stack, const float* values, size_t nb) {
+    return stack_push_many(stack, STACK_ITEM_FLOAT, values, nb);
+}
+
+/**
+ * @brief pop an array of float
+ * @param stack target STACK *stack
+ * @param values array receiving the popped float
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many_f(STACK* stack, float* values, size_t nb) {
+    return stack_pop_many(stack, STACK_ITEM_FLOAT, values, nb);
+}
+
+/**
+ * @brief push an array of double
+ * @param stack target STACK *stack
+ * @param values the double to push
+ * @param nb number of values
+ * @return the number of values pushed
+ */
+size_t stack_push_many_d(STACK* stack, const double* values, size_t nb) {
+    return stack_push_many(stack, STACK_ITEM_DOUBLE, values, nb);
+}
+
+/**
+ * @brief pop an array of double
+ * @param stack target STACK *stack
+ * @param values array receiving the popped double
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many_d(STACK* stack, double* values, size_t nb) {
+    return stack_pop_many(stack, STACK_ITEM_DOUBLE, values, nb);
+}
+
+/**
+ * @brief push an array of void*
+ * @param stack target STACK *stack
+ * @param values the void* to push
+ * @param nb number of values
+ * @return the number of values pushed
+ */
+size_t stack_push_many_p(STACK* stack, void* const* values, size_t nb) {
+    return stack_push_many(stack, STACK_ITEM_PTR, values, nb);
+}
+
+/**
+ * @brief pop an array of void*
+ * @param stack target STACK *stack
+ * @param values array receiving the popped void*
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many_p(STACK* stack, void** values, size_t nb) {
+    return stack_pop_many(stack, STACK_ITEM_PTR, values, nb);
+}
+
 #ifdef ENV_64BITS
 /**
  * @brief helper to push an uint64_t
@@ -635,46 +802,21 @@ bool stack_push_p_default(STACK* stack, void* p) {
  * @return TRUE or FALSE
  */
 bool stack_push_ui64(STACK* stack, uint64_t ui64) {
-    uint8_t status = STACK_ITEM_OK;
-
-    size_t next_pos = __stack_push(stack, &status);
-    if (status != STACK_ITEM_OK)
-        return FALSE;
-
-    stack->stack_array[stack->head].data.ui64 = ui64;
-    stack->stack_array[stack->head].v_type = STACK_ITEM_UINT64;
-    stack->head = next_pos;
-
-    return TRUE;
+    union STACK_DATA data = {.ui64 = ui64};
+    return _stack_push_data(stack, STACK_ITEM_UINT64, data, 0);
 }
 
 /**
  * @brief helper to pop a uint64_t
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
  * @return the popped uint64_t
  */
 uint64_t stack_pop_ui64(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return FALSE);
-
-    if (stack->head == stack->tail) {
-        (*status) = STACK_IS_EMPTY;
+    union STACK_DATA data;
+    if (_stack_pop_data(stack, STACK_ITEM_UINT64, &data, status) == FALSE)
         return 0;
-    }
-
-    if (stack->stack_array[stack->tail].v_type != STACK_ITEM_UINT64) {
-        (*status) = STACK_ITEM_WRONG_TYPE;
-        return 0;
-    }
-
-    uint8_t pop_status = STACK_IS_UNDEFINED;
-    size_t prev_pos = __stack_pop(stack, &pop_status);
-    if (pop_status != STACK_ITEM_OK) {
-        (*status) = pop_status;
-        return 0;
-    }
-    return stack->stack_array[prev_pos].data.ui64;
+    return data.ui64;
 }
 
 /**
@@ -684,45 +826,64 @@ uint64_t stack_pop_ui64(STACK* stack, uint8_t* status) {
  * @return TRUE or FALSE
  */
 bool stack_push_i64(STACK* stack, int64_t i64) {
-    uint8_t status = STACK_ITEM_OK;
-
-    size_t next_pos = __stack_push(stack, &status);
-    if (status != STACK_ITEM_OK)
-        return FALSE;
-
-    stack->stack_array[stack->head].data.i64 = i64;
-    stack->stack_array[stack->head].v_type = STACK_ITEM_INT64;
-    stack->head = next_pos;
-
-    return TRUE;
+    union STACK_DATA data = {.i64 = i64};
+    return _stack_push_data(stack, STACK_ITEM_INT64, data, 0);
 }
 
 /**
  * @brief helper to pop a int64_t
  * @param stack target STACK *stack
- * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_OK)
+ * @param status pointer to uint8_t holding the result of the operation (STACK_IS_UNDEFINED,STACK_IS_EMPTY,STACK_ITEM_WRONG_TYPE,STACK_ITEM_OK)
  * @return the popped int64_t
  */
 int64_t stack_pop_i64(STACK* stack, uint8_t* status) {
-    (*status) = STACK_IS_UNDEFINED;
-    __n_assert(stack, return FALSE);
-
-    if (stack->head == stack->tail) {
-        (*status) = STACK_IS_EMPTY;
+    union STACK_DATA data;
+    if (_stack_pop_data(stack, STACK_ITEM_INT64, &data, status) == FALSE)
         return 0;
-    }
+    return data.i64;
+}
 
-    if (stack->stack_array[stack->tail].v_type != STACK_ITEM_INT64) {
-        (*status) = STACK_ITEM_WRONG_TYPE;
-        return 0;
-    }
+/**
+ * @brief push an array of uint64_t
+ * @param stack target STACK *stack
+ * @param values the uint64_t to push
+ * @param nb number of values
+ * @return the number of values pushed
+ */
+size_t stack_push_many_ui64(STACK* stack, const uint64_t* values, size_t nb) {
+    return stack_push_many(stack, STACK_ITEM_UINT64, values, nb);
+}
 
-    uint8_t pop_status = STACK_IS_UNDEFINED;
-    size_t prev_pos = __stack_pop(stack, &pop_status);
-    if (pop_status != STACK_ITEM_OK) {
-        (*status) = pop_status;
-        return 0;
-    }
-    return stack->stack_array[prev_pos].data.i64;
+/**
+ * @brief pop an array of uint64_t
+ * @param stack target STACK *stack
+ * @param values array receiving the popped uint64_t
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many_ui64(STACK* stack, uint64_t* values, size_t nb) {
+    return stack_pop_many(stack, STACK_ITEM_UINT64, values, nb);
+}
+
+/**
+ * @brief push an array of int64_t
+ * @param stack target STACK *stack
+ * @param values the int64_t to push
+ * @param nb number of values
+ * @return the number of values pushed
+ */
+size_t stack_push_many_i64(STACK* stack, const int64_t* values, size_t nb) {
+    return stack_push_many(stack, STACK_ITEM_INT64, values, nb);
+}
+
+/**
+ * @brief pop an array of int64_t
+ * @param stack target STACK *stack
+ * @param values array receiving the popped int64_t
+ * @param nb maximum number of values
+ * @return the number of values popped
+ */
+size_t stack_pop_many_i64(STACK* stack, int64_t* values, size_t nb) {
+    return stack_pop_many(stack, STACK_ITEM_INT64, values, nb);
 }
 #endif
@@ -42,6 +42,236 @@
 #include <stdlib.h>
 #include <dirent.h>
 
+#ifndef __windows__
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(NSTR_NO_SIMD)
+/*! SSE2 is part of x86_64, AVX2 kernels are compiled with a target attribute and picked at run time */
+#define NSTR_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/*! SIMD level used by the string kernels, -1 until detected */
+static int nstr_simd_current = -1;
+
+/**
+ *@brief get the SIMD level supported by the CPU
+ *@return NSTR_SIMD_NONE, NSTR_SIMD_SSE2 or NSTR_SIMD_AVX2
+ */
+static int _nstr_simd_detect(void) {
+#ifdef NSTR_SIMD_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? NSTR_SIMD_AVX2 : NSTR_SIMD_SSE2;
+#else
+    return NSTR_SIMD_NONE;
+#endif
+} /* _nstr_simd_detect(...) */
+
+/**
+ *@brief get the SIMD level used by the string kernels
+ *@return NSTR_SIMD_NONE, NSTR_SIMD_SSE2 or NSTR_SIMD_AVX2
+ */
+int nstr_simd_level(void) {
+    int level = __atomic_load_n(&nstr_simd_current, __ATOMIC_RELAXED);
+    if (level < 0) {
+        level = _nstr_simd_detect();
+        __atomic_store_n(&nstr_simd_current, level, __ATOMIC_RELAXED);
+    }
+    return level;
+} /* nstr_simd_level(...) */
+
+/**
+ *@brief limit the SIMD level used by the string kernels, to compare them with the scalar code or to work around a CPU issue
+ *@param level highest level to use, NSTR_SIMD_NONE for the scalar code only
+ *@return the level really used, which can't be higher than the CPU supports
+ */
+int nstr_set_simd_level(int level) {
+    int supported = _nstr_simd_detect();
+    if (level > supported)
+        level = supported;
+    if (level < NSTR_SIMD_NONE)
+        level = NSTR_SIMD_NONE;
+    __atomic_store_n(&nstr_simd_current, level, __ATOMIC_RELAXED);
+    return level;
+} /* nstr_set_simd_level(...) */
+
+/**
+ *@brief tell if a case conversion function only maps the ASCII range [first,last] to the other case, as the C locale does. Locales changing other ASCII letters can't use the SIMD kernels
+ *@param conv toupper or tolower
+ *@param first first letter to convert
+ *@param last last letter to convert
+ *@return TRUE or FALSE
+ */
+static int _nstr_ascii_case_is_standard(int (*conv)(int), int first, int last) {
+    for (int c = 0; c < 128; c++) {
+        int expected = (c >= first && c <= last) ? (c ^ 0x20) : c;
+        if (conv(c) != expected)
+            return FALSE;
+    }
+    return TRUE;
+} /* _nstr_ascii_case_is_standard(...) */
+
+#ifdef NSTR_SIMD_X86
+/**
+ *@brief SSE2 case conversion of the ASCII letters [first,last], 16 bytes at a time. Blocks holding non ASCII bytes are left to conv
+ *@param src source bytes
+ *@param dest destination, can be src
+ *@param len number of bytes
+ *@param conv toupper or tolower
+ *@param first first letter to convert
+ *@param last last letter to convert
+ *@return number of bytes processed, the tail is left to the caller
+ */
+static size_t _nstr_case_sse2(const char* src, char* dest, size_t len, int (*conv)(int), char first, char last) {
+    const __m128i lower_bound = _mm_set1_epi8((char)(first - 1));
+    const __m128i upper_bound = _mm_set1_epi8((char)(last + 1));
+    const __m128i flip = _mm_set1_epi8(0x20);
+    size_t it = 0;
+    for (; it + 16 <= len; it += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + it));
+        if (_mm_movemask_epi8(v)) {
+            for (size_t k = it; k < it + 16; k++)
+                dest[k] = (char)conv((unsigned char)src[k]);
+            continue;
+        }
+        __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(v, lower_bound), _mm_cmplt_epi8(v, upper_bound));
+        _mm_storeu_si128((__m128i*)(dest + it), _mm_xor_si128(v, _mm_and_si128(in_range, flip)));
+    }
+    return it;
+} /* _nstr_case_sse2(...) */
+
+/**
+ *@brief AVX2 case conversion of the ASCII letters [first,last], 32 bytes at a time. Blocks holding non ASCII bytes are left to conv
+ *@param src source bytes
+ *@param dest destination, can be src
+ *@param len number of bytes
+ *@param conv toupper or tolower
+ *@param first first letter to convert
+ *@param last last letter to convert
+ *@return number of bytes processed, the tail is left to the caller
+ */
+__attribute__((target("avx2"))) static size_t _nstr_case_avx2(const char* src, char* dest, size_t len, int (*conv)(int), char first, char last) {
+    const __m256i lower_bound = _mm256_set1_epi8((char)(first - 1));
+    const __m256i upper_bound = _mm256_set1_epi8((char)(last + 1));
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    size_t it = 0;
+    for (; it + 32 <= len; it += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + it));
+        if (_mm256_movemask_epi8(v)) {
+            for (size_t k = it; k < it + 32; k++)
+                dest[k] = (char)conv((unsigned char)src[k]);
+            continue;
+        }
+        __m256i in_range = _mm256_and_si256(_mm256_cmpgt_epi8(v, lower_bound), _mm256_cmpgt_epi8(upper_bound, v));
+        _mm256_storeu_si256((__m256i*)(dest + it), _mm256_xor_si256(v, _mm256_and_si256(in_range, flip)));
+    }
+    return it;
+} /* _nstr_case_avx2(...) */
+
+/**
+ *@brief SSE2 replacement of the bytes found in mask, 16 bytes at a time
+ *@param string bytes to clean
+ *@param len number of bytes
+ *@param mask bytes to replace
+ *@param masklen number of bytes in mask
+ *@param replacement replacement byte
+ *@return number of bytes processed, the tail is left to the caller
+ */
+static size_t _nstr_sanitize_sse2(char* string, size_t len, const char* mask, size_t masklen, char replacement) {
+    const __m128i repl = _mm_set1_epi8(replacement);
+    size_t it = 0;
+    for (; it + 16 <= len; it += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(string + it));
+        __m128i hit = _mm_setzero_si128();
+        for (size_t k = 0; k < masklen; k++)
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8(mask[k])));
+        if (_mm_movemask_epi8(hit))
+            _mm_storeu_si128((__m128i*)(string + it), _mm_or_si128(_mm_and_si128(hit, repl), _mm_andnot_si128(hit, v)));
+    }
+    return it;
+} /* _nstr_sanitize_sse2(...) */
+
+/**
+ *@brief AVX2 replacement of the bytes found in mask, 32 bytes at a time
+ *@param string bytes to clean
+ *@param len number of bytes
+ *@param mask bytes to replace
+ *@param masklen number of bytes in mask
+ *@param replacement replacement byte
+ *@return number of bytes processed, the tail is left to the caller
+ */
+__attribute__((target("avx2"))) static size_t _nstr_sanitize_avx2(char* string, size_t len, const char* mask, size_t masklen, char replacement) {
+    const __m256i repl = _mm256_set1_epi8(replacement);
+    size_t it = 0;
+    for (; it + 32 <= len; it += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(string + it));
+        __m256i hit = _mm256_setzero_si256();
+        for (size_t k = 0; k < masklen; k++)
+            hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(mask[k])));
+        if (_mm256_movemask_epi8(hit))
+            _mm256_storeu_si256((__m256i*)(string + it), _mm256_blendv_epi8(v, repl, hit));
+    }
+    return it;
+} /* _nstr_sanitize_avx2(...) */
+
+#ifdef __windows__
+/**
+ *@brief SSE2 search of the first of two bytes
+ *@param s bytes to search in
+ *@param len number of bytes
+ *@param c1 first byte to find
+ *@param c2 second byte to find
+ *@return the first position holding c1 or c2, or NULL
+ */
+static const char* _nstr_find_byte2_sse2(const char* s, size_t len, char c1, char c2) {
+    const __m128i v1 = _mm_set1_epi8(c1);
+    const __m128i v2 = _mm_set1_epi8(c2);
+    size_t it = 0;
+    for (; it + 16 <= len; it += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + it));
+        int bits = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, v1), _mm_cmpeq_epi8(v, v2)));
+        if (bits)
+            return s + it + __builtin_ctz((unsigned int)bits);
+    }
+    for (; it < len; it++) {
+        if (s[it] == c1 || s[it] == c2)
+            return s + it;
+    }
+    return NULL;
+} /* _nstr_find_byte2_sse2(...) */
+#endif
+#endif /* NSTR_SIMD_X86 */
+
+/**
+ *@brief convert the case of len bytes with conv, using the SIMD kernels when the locale maps ASCII letters the standard way
+ *@param src source bytes
+ *@param dest destination, can be src
+ *@param len number of bytes
+ *@param conv toupper or tolower
+ *@param first first letter converted by conv in the C locale
+ *@param last last letter converted by conv in the C locale
+ */
+static void _nstr_convert_case(const char* src, char* dest, size_t len, int (*conv)(int), char first, char last) {
+    size_t it = 0;
+#ifdef NSTR_SIMD_X86
+    /* checking the locale costs 128 calls, not worth it for short strings */
+    if (len >= 64 && _nstr_ascii_case_is_standard(conv, first, last)) {
+        if (nstr_simd_level() >= NSTR_SIMD_AVX2)
+            it = _nstr_case_avx2(src, dest, len, conv, first, last);
+        else if (nstr_simd_level() >= NSTR_SIMD_SSE2)
+            it = _nstr_case_sse2(src, dest, len, conv, first, last);
+    }
+#else
+    (void)first;
+    (void)last;
+#endif
+    for (; it < len; it++)
+        dest[it] = (char)conv((unsigned char)src[it]);
+} /* _nstr_convert_case(...) */
+
 #ifdef __windows__
 /**
  *@brief string case insensitive search
@@ -54,6 +284,20 @@ const char* strcasestr(const char* s1, const char* s2) {
     __n_assert(s2, return NULL);
 
     size_t n = strlen(s2);
+#ifdef NSTR_SIMD_X86
+    /* jump between the candidates for the first byte. 'i' is left to the slow loop, some locales map it out of ASCII */
+    unsigned char first = (unsigned char)s2[0];
+    if (n > 0 && first < 0x80 && first != 'i' && first != 'I' && nstr_simd_level() >= NSTR_SIMD_SSE2) {
+        const char* end = s1 + strlen(s1);
+        const char* candidate = s1;
+        while ((candidate = _nstr_find_byte2_sse2(candidate, (size_t)(end - candidate), (char)tolower(first), (char)toupper(first)))) {
+            if (!strnicmp(candidate, s2, n))
+                return candidate;
+            candidate++;
+        }
+        return NULL;
+    }
+#endif
     while (*s1) {
         if (!strnicmp(s1++, s2, n))
             return (s1 - 1);
@@ -62,6 +306,223 @@ const char* strcasestr(const char* s1, const char* s2) {
 } /* strcasestr */
 #endif
 
+/*! number of size classes of the N_STR allocation cache */
+#define NSTR_CACHE_NB_CLASSES 12
+
+/*! block sizes of the N_STR allocation cache. The first one fits the N_STR structures, the others are dense below 512 bytes where most strings are */
+static const size_t nstr_cache_sizes[NSTR_CACHE_NB_CLASSES] = {sizeof(N_STR), 48, 64, 96, 128, 192, 256, 384, 512, 1024, 2048, NSTR_CACHE_MAX_SIZE};
+
+/*! free lists of a thread, chained through the first bytes of the blocks */
+typedef struct NSTR_CACHE {
+    /*! first free block of each class */
+    void* blocks[NSTR_CACHE_NB_CLASSES];
+    /*! number of free blocks of each class */
+    size_t nb_blocks[NSTR_CACHE_NB_CLASSES];
+    /*! set once the thread exit destructor is registered */
+    int registered;
+    /*! set by the thread exit destructor, blocks are then freed directly */
+    int closed;
+} NSTR_CACHE;
+
+/*! allocation cache of the calling thread */
+static __thread NSTR_CACHE nstr_cache;
+/*! key used to empty the cache of exiting threads */
+static pthread_key_t nstr_cache_key;
+/*! result of the creation of nstr_cache_key */
+static int nstr_cache_key_ok = 0;
+/*! initialization of nstr_cache_key */
+static pthread_once_t nstr_cache_once = PTHREAD_ONCE_INIT;
+
+/**
+ *@brief free all the blocks of a cache
+ *@param cache targeted cache
+ */
+static void _nstr_cache_empty(NSTR_CACHE* cache) {
+    for (int it = 0; it < NSTR_CACHE_NB_CLASSES; it++) {
+        while (cache->blocks[it]) {
+            void* block = cache->blocks[it];
+            cache->blocks[it] = *(void**)block;
+            free(block);
+        }
+        cache->nb_blocks[it] = 0;
+    }
+} /* _nstr_cache_empty(...) */
+
+/**
+ *@brief thread exit destructor of the cache
+ *@param ptr cache of the exiting thread
+ */
+static void _nstr_cache_thread_exit(void* ptr) {
+    NSTR_CACHE* cache = (NSTR_CACHE*)ptr;
+    cache->closed = 1;
+    _nstr_cache_empty(cache);
+} /* _nstr_cache_thread_exit(...) */
+
+/**
+ *@brief create the key of the thread exit destructor
+ */
+static void _nstr_cache_key_init(void) {
+    nstr_cache_key_ok = (pthread_key_create(&nstr_cache_key, _nstr_cache_thread_exit) == 0);
+} /* _nstr_cache_key_init(...) */
+
+/**
+ *@brief get a zeroed block from the calling thread's N_STR allocation cache. Requests are rounded up to a size class and served from its free list, or from calloc when it is empty. Blocks come from plain calloc calls, so they can also be reallocated or released with free()
+ *@param size number of bytes needed
+ *@param allocated set to the real size of the block, which can be bigger than size
+ *@return the block or NULL
+ */
+static void* _nstr_cache_alloc(size_t size, size_t* allocated) {
+    char* block = NULL;
+    int class_id = 0;
+    while (class_id < NSTR_CACHE_NB_CLASSES && nstr_cache_sizes[class_id] < size) class_id++;
+    if (class_id == NSTR_CACHE_NB_CLASSES) {
+        Malloc(block, char, size);
+        __n_assert(block, return NULL);
+        (*allocated) = size;
+        return block;
+    }
+
+    size_t class_size = nstr_cache_sizes[class_id];
+    if (nstr_cache.blocks[class_id]) {
+        block = nstr_cache.blocks[class_id];
+        nstr_cache.blocks[class_id] = *(void**)block;
+        nstr_cache.nb_blocks[class_id]--;
+        memset(block, 0, class_size);
+    } else {
+        Malloc(block, char, class_size);
+        __n_assert(block, return NULL);
+    }
+    (*allocated) = class_size;
+    return block;
+} /* _nstr_cache_alloc(...) */
+
+/**
+ *@brief give a block back to the calling thread's N_STR allocation cache, or free it if its free list is full. Only blocks of _nstr_cache_alloc are given, see NSTR_CACHED: a block goes to the largest class not bigger than size, so it is never handed out bigger than it is
+ *@param block block to release, can be NULL
+ *@param size size of the block given by _nstr_cache_alloc
+ */
+static void _nstr_cache_release(void* block, size_t size) {
+    if (!block)
+        return;
+    int class_id = NSTR_CACHE_NB_CLASSES - 1;
+    while (class_id >= 0 && nstr_cache_sizes[class_id] > size) class_id--;
+    if (class_id < 0 || nstr_cache.closed || nstr_cache.nb_blocks[class_id] >= NSTR_CACHE_MAX_BLOCKS) {
+        free(block);
+        return;
+    }
+    if (!nstr_cache.registered) {
+        pthread_once(&nstr_cache_once, _nstr_cache_key_init);
+        if (!nstr_cache_key_ok || pthread_setspecific(nstr_cache_key, &nstr_cache) != 0) {
+            free(block);
+            return;
+        }
+        nstr_cache.registered = 1;
+    }
+    *(void**)block = nstr_cache.blocks[class_id];
+    nstr_cache.blocks[class_id] = block;
+    nstr_cache.nb_blocks[class_id]++;
+} /* _nstr_cache_release(...) */
+
+/**
+ *@brief free the blocks cached by the calling thread. Threads exiting through pthread do it automatically
+ */
+void nstr_cache_flush(void) {
+    _nstr_cache_empty(&nstr_cache);
+} /* nstr_cache_flush(...) */
+
+/**
+ *@brief tell if the data of a N_STR is in the same allocation as the structure
+ *@param str targeted N_STR
+ *@return TRUE or FALSE
+ */
+static inline int _nstr_is_inline(const N_STR* str) {
+    return ((str->flags & NSTR_INLINE) && str->data == (const char*)(str + 1)) ? TRUE : FALSE;
+} /* _nstr_is_inline(...) */
+
+/**
+ *@brief get the size of the mapping of a N_STR made by n_file_map, kept right after the structure
+ *@param str mapped N_STR
+ *@return size of the mapping
+ */
+static inline size_t _nstr_map_len(const N_STR* str) {
+    return *(const size_t*)(str + 1);
+} /* _nstr_map_len(...) */
+
+/**
+ *@brief release the separate data block of a N_STR, to the allocation cache if it came from it, else with free()
+ *@param str N_STR whose data is neither inline nor mapped
+ */
+static inline void _nstr_release_data(const N_STR* str) {
+    if (str->flags & NSTR_CACHED) {
+        _nstr_cache_release(str->data, str->length);
+    } else {
+        free(str->data);
+    }
+} /* _nstr_release_data(...) */
+
+/**
+ *@brief release a N_STR structure and its data to the allocation cache. Any structure can be cached, its size being known, while the data only is if flagged NSTR_CACHED
+ *@param str N_STR to release
+ */
+static void _nstr_release(N_STR* str) {
+    if (str->flags & NSTR_MAPPED) {
+        nstr_free_data(str);
+        _nstr_cache_release(str, sizeof(N_STR) + sizeof(size_t));
+        return;
+    }
+    if (_nstr_is_inline(str)) {
+        _nstr_cache_release(str, sizeof(N_STR) + str->length);
+        return;
+    }
+    _nstr_release_data(str);
+    /* a moved inline string keeps its bigger block, released as a bare structure */
+    _nstr_cache_release(str, sizeof(N_STR));
+} /* _nstr_release(...) */
+
+/**
+ *@brief release the data of a N_STR and reset it, the structure is kept. Needed before replacing the data pointer of a string that may be inline
+ *@param nstr targeted N_STR
+ */
+void nstr_free_data(N_STR* nstr) {
+    __n_assert(nstr, return);
+    if (nstr->flags & NSTR_MAPPED) {
+#ifndef __windows__
+        munmap(nstr->data, _nstr_map_len(nstr));
+#endif
+    } else if (!_nstr_is_inline(nstr)) {
+        _nstr_release_data(nstr);
+    }
+    nstr->data = NULL;
+    nstr->length = 0;
+    nstr->written = 0;
+    nstr->flags = 0;
+} /* nstr_free_data(...) */
+
+/**
+ *@brief take the data of a N_STR as a buffer the caller must free(). Inline data is copied out. The N_STR is left empty and must still be freed
+ *@param nstr targeted N_STR
+ *@return the data, or NULL if there was none or on error
+ */
+char* nstr_detach_data(N_STR* nstr) {
+    __n_assert(nstr, return NULL);
+    char* data = nstr->data;
+    if (data && (_nstr_is_inline(nstr) || (nstr->flags & NSTR_MAPPED))) {
+        data = NULL;
+        Malloc(data, char, nstr->written + 1);
+        __n_assert(data, return NULL);
+        memcpy(data, nstr->data, nstr->written);
+#ifndef __windows__
+        if (nstr->flags & NSTR_MAPPED)
+            munmap(nstr->data, _nstr_map_len(nstr));
+#endif
+    }
+    nstr->data = NULL;
+    nstr->length = 0;
+    nstr->written = 0;
+    nstr->flags = 0;
+    return data;
+} /* nstr_detach_data(...) */
+
 /**
  *@brief Free a N_STR pointer structure
  *@param ptr A N_STR *object to free
@@ -69,8 +530,7 @@ const char* strcasestr(const char* s1, const char* s2) {
 void free_nstr_ptr(void* ptr) {
     N_STR* strptr = (N_STR*)ptr;
     if (ptr && strptr) {
-        FreeNoLog(strptr->data);
-        FreeNoLog(strptr);
+        _nstr_release(strptr);
     }
 } /* free_nstr_ptr( ... ) */
 
@@ -82,8 +542,8 @@ void free_nstr_ptr(void* ptr) {
 int _free_nstr(N_STR** ptr) {
     __n_assert(ptr && (*ptr), return FALSE);
 
-    FreeNoLog((*ptr)->data);
-    FreeNoLog((*ptr));
+    _nstr_release((*ptr));
+    (*ptr) = NULL;
 
     return TRUE;
 } /* free_nstr( ... ) */
@@ -95,8 +555,8 @@ int _free_nstr(N_STR** ptr) {
  */
 int free_nstr_nolog(N_STR** ptr) {
     if ((*ptr)) {
-        FreeNoLog((*ptr)->data);
-        FreeNoLog((*ptr));
+        _nstr_release((*ptr));
+        (*ptr) = NULL;
     }
 
     return TRUE;
@@ -109,8 +569,7 @@ int free_nstr_nolog(N_STR** ptr) {
 void free_nstr_ptr_nolog(void* ptr) {
     N_STR* strptr = (N_STR*)ptr;
     if (strptr) {
-        FreeNoLog(strptr->data);
-        FreeNoLog(strptr);
+        _nstr_release(strptr);
     }
 } /* free_nstr_ptr_nolog( ... ) */
 
@@ -122,7 +581,8 @@ void free_nstr_ptr_nolog(void* ptr) {
 char* trim_nocopy(char* s) {
     __n_assert(s, return NULL);
 
-    if (strlen(s) == 0)
+    size_t len = strlen(s);
+    if (len == 0)
         return s;
 
     char* start = s;
@@ -131,7 +591,7 @@ char* trim_nocopy(char* s) {
     while (*start && isspace((unsigned char)*start))
         start++;
 
-    char* end = s + strlen(s) - 1;
+    char* end = s + len - 1;
     /* iterate over the rest remebering last non-whitespace */
     while (*end && isspace((unsigned char)*end) && end > s) {
         end--;
@@ -192,6 +652,11 @@ int empty_nstr(N_STR* nstr) {
     __n_assert(nstr, return FALSE);
     __n_assert(nstr->data, return FALSE);
 
+    if (nstr->flags & NSTR_MAPPED) {
+        nstr_free_data(nstr);
+        return resize_nstr(nstr, 1);
+    }
+
     nstr->written = 0;
     memset(nstr->data, 0, nstr->length);
 
@@ -199,14 +664,17 @@ int empty_nstr(N_STR* nstr) {
 }
 
 /**
- *@brief create a new N_STR string
+ *@brief create a new N_STR string. The structure and the data come from the N_STR allocation cache, and length is the real size of the data block
  *@param size Size of the new string. 0 for no allocation.
  *@return A new allocated N_STR or NULL
  */
 N_STR* new_nstr(NSTRBYTE size) {
-    N_STR* str = NULL;
-
-    Malloc(str, N_STR, 1);
+    if (size >= SIZE_MAX - 1) {
+        n_log(LOG_ERR, "size too large in new_nstr: %zu", size);
+        return NULL;
+    }
+    size_t allocated = 0;
+    N_STR* str = _nstr_cache_alloc(sizeof(N_STR), &allocated);
     __n_assert(str, return NULL);
 
     str->written = 0;
@@ -214,13 +682,31 @@ N_STR* new_nstr(NSTRBYTE size) {
         str->data = NULL;
         str->length = 0;
     } else {
-        Malloc(str->data, char, size + 1);
-        __n_assert(str->data, Free(str); return NULL);
-        str->length = size;
+        str->data = _nstr_cache_alloc(size + 1, &str->length);
+        __n_assert(str->data, _nstr_cache_release(str, sizeof(N_STR)); return NULL);
+        str->flags = NSTR_CACHED;
     }
     return str;
 } /* new_nstr(...) */
 
+/**
+ *@brief create a new N_STR string. If the structure and size + 1 bytes fit in NSTR_INLINE_MAX they share a single allocation, else it is a new_nstr. See NSTR_INLINE for the restrictions on the data pointer
+ *@param size Size of the new string
+ *@return A new allocated N_STR or NULL
+ */
+N_STR* new_nstr_inline(NSTRBYTE size) {
+    if (size >= NSTR_INLINE_MAX - sizeof(N_STR))
+        return new_nstr(size);
+    size_t allocated = 0;
+    N_STR* str = _nstr_cache_alloc(sizeof(N_STR) + size + 1, &allocated);
+    __n_assert(str, return NULL);
+    str->data = (char*)(str + 1);
+    str->length = allocated - sizeof(N_STR);
+    str->written = 0;
+    str->flags = NSTR_INLINE;
+    return str;
+} /* new_nstr_inline(...) */
+
 /**
  *@brief Convert a char into a N_STR, extended version
  *@param from A char *string to convert
@@ -441,56 +927,778 @@ int nstr_to_file(N_STR* str, char* filename) {
 } /* nstr_to_file(...) */
 
 /**
- * @brief Helper for string[start to end] to integer. Automatically add /0 for
- conversion. Leave values untouched if any error occur. Work on a copy of the
- chunk.
- * @param s String to convert
- * @param start Start position of the chunk
- * @param end End position of the chunk
- * @param i A pointer to an integer variable which will receive the value.
- * @param base Base for converting values
- * @return TRUE or FALSE
+ *@brief map a whole file as a N_STR. The pages are loaded by the system when they are read, so the file is neither copied nor fully resident. The data is followed by a '\0' like any N_STR. The mapping is private: in place changes copy the touched pages and never reach the file, and functions growing the string move it to the heap first. The file must not be truncated while it is mapped. On Windows it is a file_to_nstr
+ *@param filename file to map
+ *@return a N_STR to release with n_file_unmap() or free_nstr(), or NULL
  */
-int str_to_int_ex(const char* s, NSTRBYTE start, NSTRBYTE end, int* i, const int base) {
-    char* tmpstr = NULL;
-    char* endstr = NULL;
-    long int l = 0;
+N_STR* n_file_map(const char* filename) {
+    __n_assert(filename, return NULL);
+#ifdef __windows__
+    return file_to_nstr((char*)filename);
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        n_log(LOG_ERR, "Unable to open %s for reading. Errno: %s", filename, strerror(errno));
+        return NULL;
+    }
+    struct stat filestat;
+    if (fstat(fd, &filestat) != 0) {
+        n_log(LOG_ERR, "Couldn't stat %s. Errno: %s", filename, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    if (!S_ISREG(filestat.st_mode)) {
+        n_log(LOG_ERR, "%s is not a regular file, it can't be mapped", filename);
+        close(fd);
+        return NULL;
+    }
 
-    __n_assert(s, return FALSE);
+    size_t size = (size_t)filestat.st_size;
+    if (size == 0) {
+        close(fd);
+        return new_nstr(1);
+    }
 
-    if (start > end) return FALSE;
+    /* reserve at least one page more than the file: the bytes after its end read as '\0', even when it fills its last page */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t map_len = (size / page + 1) * page;
+    char* map = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        n_log(LOG_ERR, "Couldn't reserve %zu bytes to map %s. Errno: %s", map_len, filename, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    if (mmap(map, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        n_log(LOG_ERR, "Couldn't map %s. Errno: %s", filename, strerror(errno));
+        munmap(map, map_len);
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+
+    /* length leaves no room after the data, so that any growth moves the string to the heap first */
+    size_t allocated = 0;
+    N_STR* str = _nstr_cache_alloc(sizeof(N_STR) + sizeof(size_t), &allocated);
+    __n_assert(str, munmap(map, map_len); return NULL);
+    str->data = map;
+    str->length = size + 1;
+    str->written = size;
+    str->flags = NSTR_MAPPED;
+    *(size_t*)(str + 1) = map_len;
+    n_log(LOG_DEBUG, "%s mapped, file size is: %zu", filename, size);
+    return str;
+#endif
+} /* n_file_map(...) */
+
+/**
+ *@brief release a N_STR made by n_file_map and set it to NULL
+ *@param str N_STR to release
+ *@return TRUE or FALSE
+ */
+int n_file_unmap(N_STR** str) {
+    __n_assert(str && (*str), return FALSE);
+    free_nstr(str);
+    return TRUE;
+} /* n_file_unmap(...) */
 
-    Malloc(tmpstr, char, sizeof(int) + end - start + 8);
-    __n_assert(tmpstr, n_log(LOG_ERR, "Unable to Malloc( tmpstr , char ,  sizeof( int ) + %d - %d )", end, start); return FALSE);
+/**
+ *@brief create a line reader on an open file descriptor. Lines are read in a big buffer reused from one line to the next, and given as pointers in it, without any copy
+ *@param fd file descriptor to read, it is not closed by destroy_line_reader
+ *@param buffer_size starting size of the buffer, 0 for NSTR_LINE_READER_BUFFER_SIZE. It grows when a line doesn't fit
+ *@param delimiter end of line byte, usually '\n'
+ *@return a new N_LINE_READER or NULL
+ */
+N_LINE_READER* new_line_reader(int fd, size_t buffer_size, char delimiter) {
+    if (fd < 0) {
+        n_log(LOG_ERR, "invalid file descriptor %d", fd);
+        return NULL;
+    }
+    if (buffer_size == 0)
+        buffer_size = NSTR_LINE_READER_BUFFER_SIZE;
+    if (buffer_size >= SIZE_MAX) {
+        n_log(LOG_ERR, "buffer size too large: %zu", buffer_size);
+        return NULL;
+    }
 
-    memcpy(tmpstr, s + start, end - start);
+    N_LINE_READER* reader = NULL;
+    Malloc(reader, N_LINE_READER, 1);
+    __n_assert(reader, return NULL);
+    /* one more byte to always be able to end the last line with a '\0' */
+    Malloc(reader->buffer, char, buffer_size + 1);
+    __n_assert(reader->buffer, Free(reader); return NULL);
+    reader->size = buffer_size;
+    reader->fd = fd;
+    reader->delimiter = delimiter;
+    return reader;
+} /* new_line_reader(...) */
 
-    errno = 0;
-    l = strtol(tmpstr, &endstr, base);
-    if ((errno == ERANGE && l == LONG_MAX) || l > INT_MAX) {
-        n_log(LOG_ERR, "OVERFLOW reached when converting %s to int", tmpstr);
-        Free(tmpstr);
+/**
+ *@brief open a file and create a line reader on it
+ *@param filename file to read
+ *@param buffer_size starting size of the buffer, 0 for NSTR_LINE_READER_BUFFER_SIZE
+ *@param delimiter end of line byte, usually '\n'
+ *@return a new N_LINE_READER, closing the file when destroyed, or NULL
+ */
+N_LINE_READER* open_line_reader(const char* filename, size_t buffer_size, char delimiter) {
+    __n_assert(filename, return NULL);
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        n_log(LOG_ERR, "Unable to open %s for reading. Errno: %s", filename, strerror(errno));
+        return NULL;
+    }
+    N_LINE_READER* reader = new_line_reader(fd, buffer_size, delimiter);
+    if (!reader) {
+        close(fd);
+        return NULL;
+    }
+    reader->own_fd = 1;
+#if !defined(__windows__) && defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return reader;
+} /* open_line_reader(...) */
+
+/**
+ *@brief get the next line of a line reader. The delimiter is replaced by a '\0' in the buffer. The line is valid until the next call or the destruction of the reader, and can be modified in place
+ *@param reader targeted N_LINE_READER
+ *@param line set to the start of the line
+ *@param length set to the length of the line, delimiter excluded
+ *@return TRUE if a line was read, FALSE at the end of the file or on error (reader->error is then set)
+ */
+int line_reader_next(N_LINE_READER* reader, char** line, size_t* length) {
+    __n_assert(reader, return FALSE);
+    __n_assert(line, return FALSE);
+    __n_assert(length, return FALSE);
+
+    while (1) {
+        /* only the bytes read since the last search are searched */
+        char* found = memchr(reader->buffer + reader->scan, reader->delimiter, reader->end - reader->scan);
+        if (found) {
+            (*found) = '\0';
+            (*line) = reader->buffer + reader->start;
+            (*length) = (size_t)(found - (*line));
+            reader->start = reader->scan = (size_t)(found - reader->buffer) + 1;
+            reader->line_number++;
+            return TRUE;
+        }
+        reader->scan = reader->end;
+
+        if (reader->eof || reader->error) {
+            /* last line without a delimiter */
+            if (reader->start < reader->end) {
+                reader->buffer[reader->end] = '\0';
+                (*line) = reader->buffer + reader->start;
+                (*length) = reader->end - reader->start;
+                reader->start = reader->scan = reader->end;
+                reader->line_number++;
+                return TRUE;
+            }
+            return FALSE;
+        }
+
+        /* keep the partial line at the start of the buffer, grow it if the line fills it */
+        if (reader->start > 0) {
+            memmove(reader->buffer, reader->buffer + reader->start, reader->end - reader->start);
+            reader->end -= reader->start;
+            reader->scan -= reader->start;
+            reader->start = 0;
+        }
+        if (reader->end == reader->size) {
+            if (reader->size > (SIZE_MAX - 1) / 2) {
+                n_log(LOG_ERR, "line too long at line %zu", reader->line_number + 1);
+                reader->error = 1;
+                return FALSE;
+            }
+            size_t new_size = reader->size * 2;
+            if (Realloc(reader->buffer, char, new_size + 1) == FALSE) {
+                reader->error = 1;
+                return FALSE;
+            }
+            reader->size = new_size;
+        }
+
+        ssize_t got = read(reader->fd, reader->buffer + reader->end, reader->size - reader->end);
+        if (got < 0) {
+            if (errno == EINTR)
+                continue;
+            n_log(LOG_ERR, "read on fd %d failed: %s", reader->fd, strerror(errno));
+            reader->error = 1;
+        } else if (got == 0) {
+            reader->eof = 1;
+        } else {
+            reader->end += (size_t)got;
+        }
+    }
+} /* line_reader_next(...) */
+
+/**
+ *@brief destroy a line reader and set it to NULL. The file is closed if the reader opened it
+ *@param reader N_LINE_READER to destroy
+ *@return TRUE or FALSE
+ */
+int destroy_line_reader(N_LINE_READER** reader) {
+    __n_assert(reader && (*reader), return FALSE);
+    if ((*reader)->own_fd)
+        close((*reader)->fd);
+    Free((*reader)->buffer);
+    Free((*reader));
+    return TRUE;
+} /* destroy_line_reader(...) */
+
+/**
+ *@brief create a new chunked string builder. Appending never moves the bytes already written, and the content can be written out chunk by chunk without being flattened
+ *@param chunk_size size of the chunk allocations, header included, 0 for NSTR_BUILDER_CHUNK_SIZE. Chunks up to NSTR_CACHE_MAX_SIZE are recycled by the N_STR allocation cache
+ *@return a new N_STR_BUILDER or NULL
+ */
+N_STR_BUILDER* new_nstr_builder(size_t chunk_size) {
+    N_STR_BUILDER* builder = NULL;
+    Malloc(builder, N_STR_BUILDER, 1);
+    __n_assert(builder, return NULL);
+    if (chunk_size == 0)
+        chunk_size = NSTR_BUILDER_CHUNK_SIZE;
+    if (chunk_size < sizeof(N_STR_CHUNK) + 64)
+        chunk_size = sizeof(N_STR_CHUNK) + 64;
+    builder->chunk_size = chunk_size;
+    return builder;
+} /* new_nstr_builder(...) */
+
+/**
+ *@brief put a chunk at the end of a string builder
+ *@param builder targeted N_STR_BUILDER
+ *@param chunk chunk to link
+ */
+static void _nstr_builder_link(N_STR_BUILDER* builder, N_STR_CHUNK* chunk) {
+    if (builder->last)
+        builder->last->next = chunk;
+    else
+        builder->first = chunk;
+    builder->last = chunk;
+    builder->nb_chunks++;
+} /* _nstr_builder_link(...) */
+
+/**
+ *@brief add an owned chunk at the end of a string builder
+ *@param builder targeted N_STR_BUILDER
+ *@param min_size number of bytes the chunk must at least hold. Bigger than a chunk, it gets a chunk of its own so that big appends stay in one piece
+ *@return the new chunk or NULL
+ */
+static N_STR_CHUNK* _nstr_builder_add_chunk(N_STR_BUILDER* builder, size_t min_size) {
+    size_t size = builder->chunk_size;
+    if (min_size > SIZE_MAX - sizeof(N_STR_CHUNK)) {
+        n_log(LOG_ERR, "chunk size too large: %zu", min_size);
+        return NULL;
+    }
+    if (min_size + sizeof(N_STR_CHUNK) > size)
+        size = min_size + sizeof(N_STR_CHUNK);
+
+    size_t allocated = 0;
+    N_STR_CHUNK* chunk = _nstr_cache_alloc(size, &allocated);
+    __n_assert(chunk, return NULL);
+    chunk->data = (char*)(chunk + 1);
+    chunk->size = allocated - sizeof(N_STR_CHUNK);
+    _nstr_builder_link(builder, chunk);
+    return chunk;
+} /* _nstr_builder_add_chunk(...) */
+
+/**
+ *@brief append bytes to a string builder. They fill the room left in the last chunk, the rest goes in a new chunk
+ *@param builder targeted N_STR_BUILDER
+ *@param data bytes to append
+ *@param size number of bytes to append
+ *@return TRUE or FALSE
+ */
+int nstr_builder_append(N_STR_BUILDER* builder, const void* data, size_t size) {
+    __n_assert(builder, return FALSE);
+    if (size == 0)
+        return TRUE;
+    __n_assert(data, return FALSE);
+    if (size > SIZE_MAX - builder->written) {
+        n_log(LOG_ERR, "builder size overflow: %zu + %zu", builder->written, size);
         return FALSE;
     }
-    if ((errno == ERANGE && l == LONG_MIN) || l < INT_MIN) {
-        n_log(LOG_ERR, "UNDERFLOW reached when converting %s to int", tmpstr);
-        Free(tmpstr);
+
+    const char* src = data;
+    size_t total = size;
+    N_STR_CHUNK* chunk = builder->last;
+    if (chunk && !(chunk->flags & NSTR_CHUNK_REF) && chunk->written < chunk->size) {
+        size_t len = chunk->size - chunk->written;
+        if (len > size)
+            len = size;
+        memcpy(chunk->data + chunk->written, src, len);
+        chunk->written += len;
+        src += len;
+        size -= len;
+    }
+    if (size > 0) {
+        chunk = _nstr_builder_add_chunk(builder, size);
+        if (!chunk) {
+            builder->written += total - size;
+            return FALSE;
+        }
+        memcpy(chunk->data, src, size);
+        chunk->written = size;
+    }
+    builder->written += total;
+    return TRUE;
+} /* nstr_builder_append(...) */
+
+/**
+ *@brief append the content of a N_STR to a string builder
+ *@param builder targeted N_STR_BUILDER
+ *@param str N_STR to append
+ *@return TRUE or FALSE
+ */
+int nstr_builder_append_nstr(N_STR_BUILDER* builder, const N_STR* str) {
+    __n_assert(builder, return FALSE);
+    __n_assert(str, return FALSE);
+    return nstr_builder_append(builder, str->data, str->written);
+} /* nstr_builder_append_nstr(...) */
+
+/**
+ *@brief append caller memory to a string builder without copying it. The memory must stay valid and unchanged until the builder is emptied or destroyed
+ *@param builder targeted N_STR_BUILDER
+ *@param data bytes to reference
+ *@param size number of bytes to reference
+ *@return TRUE or FALSE
+ */
+int nstr_builder_append_ref(N_STR_BUILDER* builder, const void* data, size_t size) {
+    __n_assert(builder, return FALSE);
+    if (size == 0)
+        return TRUE;
+    __n_assert(data, return FALSE);
+    if (size > SIZE_MAX - builder->written) {
+        n_log(LOG_ERR, "builder size overflow: %zu + %zu", builder->written, size);
         return FALSE;
     }
-    if (*endstr != '\0' && *endstr != '\n') {
-        n_log(LOG_ERR, "Impossible conversion for %s", tmpstr);
-        Free(tmpstr);
+
+    size_t allocated = 0;
+    N_STR_CHUNK* chunk = _nstr_cache_alloc(sizeof(N_STR_CHUNK), &allocated);
+    __n_assert(chunk, return FALSE);
+    chunk->data = (char*)data;
+    chunk->size = size;
+    chunk->written = size;
+    chunk->flags = NSTR_CHUNK_REF;
+    _nstr_builder_link(builder, chunk);
+    builder->written += size;
+    return TRUE;
+} /* nstr_builder_append_ref(...) */
+
+/**
+ *@brief printf at the end of a string builder. The output is written in place when it fits in the last chunk, else in a new chunk big enough to hold it
+ *@param builder targeted N_STR_BUILDER
+ *@param format printf format
+ *@param ... printf arguments
+ *@return TRUE or FALSE
+ */
+int nstr_builder_printf(N_STR_BUILDER* builder, const char* format, ...) {
+    __n_assert(builder, return FALSE);
+    __n_assert(format, return FALSE);
+
+    va_list args;
+    va_list args_copy;
+    va_start(args, format);
+    va_copy(args_copy, args);
+
+    char* dst = NULL;
+    size_t room = 0;
+    N_STR_CHUNK* chunk = builder->last;
+    if (chunk && !(chunk->flags & NSTR_CHUNK_REF)) {
+        dst = chunk->data + chunk->written;
+        room = chunk->size - chunk->written;
+    }
+    int needed = vsnprintf(dst, room, format, args);
+    va_end(args);
+    if (needed < 0) {
+        va_end(args_copy);
+        n_log(LOG_ERR, "vsnprintf failed for format \"%s\"", format);
         return FALSE;
     }
-    Free(tmpstr);
-    *i = (int)l;
+    /* vsnprintf also writes a '\0', which must fit for the output to be complete */
+    if ((size_t)needed >= room) {
+        chunk = _nstr_builder_add_chunk(builder, (size_t)needed + 1);
+        if (!chunk) {
+            va_end(args_copy);
+            return FALSE;
+        }
+        vsnprintf(chunk->data, (size_t)needed + 1, format, args_copy);
+    }
+    va_end(args_copy);
+    chunk->written += (size_t)needed;
+    builder->written += (size_t)needed;
+    return TRUE;
+} /* nstr_builder_printf(...) */
+
+/**
+ *@brief copy the content of a string builder into a new N_STR, in one allocation
+ *@param builder N_STR_BUILDER to flatten
+ *@return a new N_STR or NULL
+ */
+N_STR* nstr_builder_to_nstr(const N_STR_BUILDER* builder) {
+    __n_assert(builder, return NULL);
+    N_STR* str = new_nstr(builder->written > 0 ? builder->written : 1);
+    __n_assert(str, return NULL);
+    for (N_STR_CHUNK* chunk = builder->first; chunk; chunk = chunk->next) {
+        memcpy(str->data + str->written, chunk->data, chunk->written);
+        str->written += chunk->written;
+    }
+    str->data[str->written] = '\0';
+    return str;
+} /* nstr_builder_to_nstr(...) */
+
+/**
+ *@brief write the content of a string builder into a file descriptor, the chunks being gathered by writev calls
+ *@param builder N_STR_BUILDER to write
+ *@param fd destination file descriptor
+ *@return number of bytes written, or -1 on error
+ */
+ssize_t nstr_builder_write_fd(const N_STR_BUILDER* builder, int fd) {
+    __n_assert(builder, return -1);
+    size_t total = 0;
+#ifndef __windows__
+    struct iovec iov[NSTR_BUILDER_IOV_MAX];
+    N_STR_CHUNK* chunk = builder->first;
+    size_t offset = 0;
+    while (chunk) {
+        int nb_iov = 0;
+        N_STR_CHUNK* it = chunk;
+        size_t it_offset = offset;
+        while (it && nb_iov < NSTR_BUILDER_IOV_MAX) {
+            if (it->written > it_offset) {
+                iov[nb_iov].iov_base = it->data + it_offset;
+                iov[nb_iov].iov_len = it->written - it_offset;
+                nb_iov++;
+            }
+            it = it->next;
+            it_offset = 0;
+        }
+        if (nb_iov == 0)
+            break;
+        ssize_t ret = writev(fd, iov, nb_iov);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0) {
+            n_log(LOG_ERR, "writev on fd %d failed: %s", fd, ret < 0 ? strerror(errno) : "nothing written");
+            return -1;
+        }
+        total += (size_t)ret;
+        /* skip what was written, a partial write leaves chunk and offset in the middle */
+        size_t done = (size_t)ret;
+        while (chunk && done >= chunk->written - offset) {
+            done -= chunk->written - offset;
+            chunk = chunk->next;
+            offset = 0;
+        }
+        offset += done;
+    }
+#else
+    for (N_STR_CHUNK* chunk = builder->first; chunk; chunk = chunk->next) {
+        size_t offset = 0;
+        while (offset < chunk->written) {
+            size_t len = chunk->written - offset;
+            if (len > INT_MAX)
+                len = INT_MAX;
+            int ret = write(fd, chunk->data + offset, (unsigned int)len);
+            if (ret < 0) {
+                if (errno == EINTR)
+                    continue;
+                n_log(LOG_ERR, "write on fd %d failed: %s", fd, strerror(errno));
+                return -1;
+            }
+            offset += (size_t)ret;
+        }
+        total += chunk->written;
+    }
+#endif
+    return (ssize_t)total;
+} /* nstr_builder_write_fd(...) */
+
+/**
+ *@brief remove the content of a string builder. Its chunks go back to the N_STR allocation cache
+ *@param builder N_STR_BUILDER to empty
+ *@return TRUE or FALSE
+ */
+int nstr_builder_empty(N_STR_BUILDER* builder) {
+    __n_assert(builder, return FALSE);
+    N_STR_CHUNK* chunk = builder->first;
+    while (chunk) {
+        N_STR_CHUNK* next = chunk->next;
+        if (chunk->flags & NSTR_CHUNK_REF)
+            _nstr_cache_release(chunk, sizeof(N_STR_CHUNK));
+        else
+            _nstr_cache_release(chunk, sizeof(N_STR_CHUNK) + chunk->size);
+        chunk = next;
+    }
+    builder->first = NULL;
+    builder->last = NULL;
+    builder->written = 0;
+    builder->nb_chunks = 0;
     return TRUE;
+} /* nstr_builder_empty(...) */
+
+/**
+ *@brief destroy a string builder and set it to NULL
+ *@param builder N_STR_BUILDER to destroy
+ *@return TRUE or FALSE
+ */
+int destroy_nstr_builder(N_STR_BUILDER** builder) {
+    __n_assert(builder && (*builder), return FALSE);
+    nstr_builder_empty((*builder));
+    Free((*builder));
+    return TRUE;
+} /* destroy_nstr_builder(...) */
+
+/**
+ *@brief parse the integer at the start of a span, with the strtol rules: leading spaces, optional sign, "0x" prefix in base 16, base 0 guessing the base from the prefix. Digits after an overflow are still read
+ *@param s start of the span
+ *@param len length of the span, a '\0' also ends it
+ *@param base base of the digits, 0 or 2 to 36
+ *@param limit largest magnitude of a positive number
+ *@param negative_limit largest magnitude of a negative number
+ *@param magnitude set to the absolute value, saturated to its limit on overflow
+ *@param negative set to TRUE if the number has a minus sign
+ *@param overflow set to TRUE if the magnitude is over its limit
+ *@return the number of bytes read, 0 if there is no digit
+ */
+static size_t _nstr_parse_integer(const char* s, size_t len, int base, uint64_t limit, uint64_t negative_limit, uint64_t* magnitude, int* negative, int* overflow) {
+    size_t it = 0;
+    (*magnitude) = 0;
+    (*negative) = FALSE;
+    (*overflow) = FALSE;
+
+    while (it < len && s[it] && isspace((unsigned char)s[it])) it++;
+    if (it < len && (s[it] == '-' || s[it] == '+')) {
+        (*negative) = (s[it] == '-') ? TRUE : FALSE;
+        it++;
+    }
+    /* "0x" is only a prefix if a hexadecimal digit follows, else the number is the '0' */
+    if ((base == 0 || base == 16) && it + 2 < len && s[it] == '0' && (s[it + 1] == 'x' || s[it + 1] == 'X') && isxdigit((unsigned char)s[it + 2])) {
+        it += 2;
+        base = 16;
+    } else if (base == 0) {
+        base = (it < len && s[it] == '0') ? 8 : 10;
+    }
+
+    uint64_t max = (*negative) ? negative_limit : limit;
+    uint64_t cutoff = max / (uint64_t)base;
+    uint64_t cutlim = max % (uint64_t)base;
+    uint64_t value = 0;
+    size_t digits_start = it;
+    for (; it < len; it++) {
+        unsigned char c = (unsigned char)s[it];
+        unsigned int digit = 0;
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (c >= 'a' && c <= 'z')
+            digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'Z')
+            digit = c - 'A' + 10;
+        else
+            break;
+        if (digit >= (unsigned int)base)
+            break;
+        if ((*overflow) || value > cutoff || (value == cutoff && digit > cutlim)) {
+            (*overflow) = TRUE;
+            value = max;
+        } else {
+            value = value * (uint64_t)base + digit;
+        }
+    }
+    if (it == digits_start)
+        return 0;
+    (*magnitude) = value;
+    return it;
+} /* _nstr_parse_integer(...) */
+
+/**
+ *@brief parse a signed 64 bits integer from a span, without copying it
+ *@param s start of the span
+ *@param len length of the span
+ *@param base base of the digits, 0 to guess it from the prefix like strtol, or 2 to 36
+ *@param value set to the number on success
+ *@param parsed if not NULL, set to the number of bytes read and the span may go on after the number. If NULL, the whole span must be the number
+ *@return TRUE, or FALSE if there is no number, it overflows or is followed by other bytes
+ */
+int n_str_span_to_i64(const char* s, size_t len, int base, int64_t* value, size_t* parsed) {
+    __n_assert(s, return FALSE);
+    __n_assert(value, return FALSE);
+    if (base != 0 && (base < 2 || base > 36))
+        return FALSE;
+
+    uint64_t magnitude = 0;
+    int negative = FALSE;
+    int overflow = FALSE;
+    size_t end = _nstr_parse_integer(s, len, base, (uint64_t)INT64_MAX, (uint64_t)INT64_MAX + 1, &magnitude, &negative, &overflow);
+    if (end == 0 || overflow || (!parsed && end != len))
+        return FALSE;
+    if (parsed)
+        (*parsed) = end;
+    (*value) = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+    return TRUE;
+} /* n_str_span_to_i64(...) */
+
+/**
+ *@brief parse an unsigned 64 bits integer from a span, without copying it. Unlike strtoull a minus sign is refused
+ *@param s start of the span
+ *@param len length of the span
+ *@param base base of the digits, 0 to guess it from the prefix like strtol, or 2 to 36
+ *@param value set to the number on success
+ *@param parsed if not NULL, set to the number of bytes read and the span may go on after the number. If NULL, the whole span must be the number
+ *@return TRUE, or FALSE if there is no number, it is negative, overflows or is followed by other bytes
+ */
+int n_str_span_to_u64(const char* s, size_t len, int base, uint64_t* value, size_t* parsed) {
+    __n_assert(s, return FALSE);
+    __n_assert(value, return FALSE);
+    if (base != 0 && (base < 2 || base > 36))
+        return FALSE;
+
+    uint64_t magnitude = 0;
+    int negative = FALSE;
+    int overflow = FALSE;
+    size_t end = _nstr_parse_integer(s, len, base, UINT64_MAX, 0, &magnitude, &negative, &overflow);
+    if (end == 0 || negative || overflow || (!parsed && end != len))
+        return FALSE;
+    if (parsed)
+        (*parsed) = end;
+    (*value) = magnitude;
+    return TRUE;
+} /* n_str_span_to_u64(...) */
+
+/*! powers of ten exactly represented by a double */
+static const double _nstr_exact_pow10[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                             1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/**
+ *@brief parse a double from a span. Decimal numbers of up to 19 significant digits with a mantissa and a power of ten exactly represented are computed directly, which rounds them correctly. The other ones, hexadecimal, infinity and nan included, go through strtod on a copy of the number
+ *@param s start of the span
+ *@param len length of the span
+ *@param value set to the number on success
+ *@param parsed if not NULL, set to the number of bytes read and the span may go on after the number. If NULL, the whole span must be the number
+ *@return TRUE, or FALSE if there is no number, it overflows or is followed by other bytes
+ */
+int n_str_span_to_double(const char* s, size_t len, double* value, size_t* parsed) {
+    __n_assert(s, return FALSE);
+    __n_assert(value, return FALSE);
+
+    size_t it = 0;
+    while (it < len && s[it] && isspace((unsigned char)s[it])) it++;
+    int negative = FALSE;
+    if (it < len && (s[it] == '-' || s[it] == '+')) {
+        negative = (s[it] == '-') ? TRUE : FALSE;
+        it++;
+    }
+
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int nb_digits = 0;
+    int exponent = 0;
+    int truncated = FALSE;
+    int hex = (it + 1 < len && s[it] == '0' && (s[it + 1] == 'x' || s[it + 1] == 'X')) ? TRUE : FALSE;
+    for (int fraction = 0; !hex && fraction < 2; fraction++) {
+        for (; it < len && s[it] >= '0' && s[it] <= '9'; it++) {
+            unsigned int digit = (unsigned int)(s[it] - '0');
+            nb_digits++;
+            if (fraction)
+                exponent--;
+            if (mantissa == 0 && digit == 0)
+                continue;
+            if (significant >= 19) {
+                truncated = TRUE;
+                continue;
+            }
+            mantissa = mantissa * 10 + digit;
+            significant++;
+        }
+        if (fraction || it >= len || s[it] != '.')
+            break;
+        it++;
+    }
+    if (nb_digits > 0 && it < len && (s[it] == 'e' || s[it] == 'E')) {
+        size_t exponent_start = it++;
+        int exponent_negative = FALSE;
+        if (it < len && (s[it] == '-' || s[it] == '+')) {
+            exponent_negative = (s[it] == '-') ? TRUE : FALSE;
+            it++;
+        }
+        if (it < len && s[it] >= '0' && s[it] <= '9') {
+            int exponent_value = 0;
+            for (; it < len && s[it] >= '0' && s[it] <= '9'; it++) {
+                if (exponent_value < 100000)
+                    exponent_value = exponent_value * 10 + (s[it] - '0');
+            }
+            exponent += exponent_negative ? -exponent_value : exponent_value;
+        } else {
+            /* 'e' without digits is not part of the number */
+            it = exponent_start;
+        }
+    }
+
+    int scanned = (!hex && nb_digits > 0) ? TRUE : FALSE;
+    if (scanned && !truncated && (mantissa == 0 || (mantissa <= ((uint64_t)1 << 53) && exponent >= -22 && exponent <= 22))) {
+        if (!parsed && it != len)
+            return FALSE;
+        double result = (double)mantissa;
+        if (mantissa != 0)
+            result = (exponent < 0) ? result / _nstr_exact_pow10[-exponent] : result * _nstr_exact_pow10[exponent];
+        (*value) = negative ? -result : result;
+        if (parsed)
+            (*parsed) = it;
+        return TRUE;
+    }
+
+    /* strtod needs a terminated string: copy the number, or when it was not scanned the characters a hexadecimal, inf or nan(...) token can hold */
+    size_t copy_len = it;
+    if (!scanned) {
+        copy_len = 0;
+        while (copy_len < len && s[copy_len] && isspace((unsigned char)s[copy_len])) copy_len++;
+        while (copy_len < len && (isalnum((unsigned char)s[copy_len]) || strchr("+-._()", s[copy_len]) != NULL) && s[copy_len]) copy_len++;
+    }
+    char local[128];
+    char* copy = local;
+    if (copy_len >= sizeof(local)) {
+        copy = NULL;
+        Malloc(copy, char, copy_len + 1);
+        __n_assert(copy, return FALSE);
+    }
+    memcpy(copy, s, copy_len);
+    copy[copy_len] = '\0';
+    char* endstr = NULL;
+    errno = 0;
+    double result = strtod(copy, &endstr);
+    int error = errno;
+    size_t end = (size_t)(endstr - copy);
+    if (copy != local) {
+        Free(copy);
+    }
+    if (end == 0 || (error == ERANGE && isinf(result)) || (!parsed && end != len))
+        return FALSE;
+    (*value) = result;
+    if (parsed)
+        (*parsed) = end;
+    return TRUE;
+} /* n_str_span_to_double(...) */
+
+/**
+ * @brief Helper for string[start to end] to integer. Leave values untouched if any error occur. The chunk is parsed in place, it may end with a '\n'
+ * @param s String to convert
+ * @param start Start position of the chunk
+ * @param end End position of the chunk
+ * @param i A pointer to an integer variable which will receive the value.
+ * @param base Base for converting values
+ * @return TRUE or FALSE
+ */
+int str_to_int_ex(const char* s, NSTRBYTE start, NSTRBYTE end, int* i, const int base) {
+    N_STR* infos = NULL;
+    int ret = str_to_int_nolog(s, start, end, i, base, &infos);
+    if (infos) {
+        n_log(LOG_ERR, "%s", _nstr(infos));
+        free_nstr(&infos);
+    }
+    return ret;
 } /* str_to_int_ex( ... ) */
 
 /**
- * @brief Helper for string[start to end] to integer. Automatically add /0 for
- conversion. Leave values untouched if any error occur. Work on a copy of the
- chunk.
+ * @brief Helper for string[start to end] to integer. Leave values untouched if any error occur. The chunk is parsed in place, it may end with a '\n'
  * @param s String to convert
  * @param start Start position of the chunk
  * @param end End position of the chunk
@@ -500,38 +1708,30 @@ int str_to_int_ex(const char* s, NSTRBYTE start, NSTRBYTE end, int* i, const int
  * @return TRUE or FALSE
  */
 int str_to_int_nolog(const char* s, NSTRBYTE start, NSTRBYTE end, int* i, const int base, N_STR** infos) {
-    char* tmpstr = NULL;
-    char* endstr = NULL;
-    long int l = 0;
-
     __n_assert(s, return FALSE);
 
     if (start > end) return FALSE;
 
-    Malloc(tmpstr, char, sizeof(int) + end - start + 8);
-    __n_assert(tmpstr, n_log(LOG_ERR, "Unable to Malloc( tmpstr , char ,  sizeof( int ) + %d - %d )", end, start); return FALSE);
-
-    memcpy(tmpstr, s + start, end - start);
-
-    errno = 0;
-    l = strtol(tmpstr, &endstr, base);
-    if ((errno == ERANGE && l == LONG_MAX) || l > INT_MAX) {
-        nstrprintf((*infos), "OVERFLOW reached when converting %s to int", tmpstr);
-        Free(tmpstr);
+    const char* chunk = s + start;
+    int len = (end - start > INT_MAX) ? INT_MAX : (int)(end - start);
+    if (base != 0 && (base < 2 || base > 36)) {
+        if (infos) nstrprintf((*infos), "Impossible conversion for %.*s in base %d", len, chunk, base);
         return FALSE;
     }
-    if ((errno == ERANGE && l == LONG_MIN) || l < INT_MIN) {
-        nstrprintf((*infos), "UNDERFLOW reached when converting %s to int", tmpstr);
-        Free(tmpstr);
+    uint64_t magnitude = 0;
+    int negative = FALSE;
+    int overflow = FALSE;
+    size_t parsed = _nstr_parse_integer(chunk, end - start, base, (uint64_t)INT_MAX, (uint64_t)INT_MAX + 1, &magnitude, &negative, &overflow);
+    if (overflow) {
+        if (infos) nstrprintf((*infos), "%s reached when converting %.*s to int", negative ? "UNDERFLOW" : "OVERFLOW", len, chunk);
         return FALSE;
     }
-    if (*endstr != '\0' && *endstr != '\n') {
-        nstrprintf((*infos), "Impossible conversion for %s", tmpstr);
-        Free(tmpstr);
+    /* like strtol, no digit converts to 0 and leaves the whole chunk to check */
+    if (parsed < end - start && chunk[parsed] != '\0' && chunk[parsed] != '\n') {
+        if (infos) nstrprintf((*infos), "Impossible conversion for %.*s", len, chunk);
         return FALSE;
     }
-    Free(tmpstr);
-    *i = (int)l;
+    *i = negative ? (int)(0 - (int64_t)magnitude) : (int)magnitude;
     return TRUE;
 } /* str_to_int_nolog( ... ) */
 
@@ -551,68 +1751,64 @@ int str_to_int(const char* s, int* i, const int base) {
 } /* str_to_int(...) */
 
 /**
- * @brief Helper for string[start to end] to long integer. Automatically add /0 for
- conversion. Leave values untouched if any error occur. Work on a copy of the
- chunk.
+ * @brief parse string[start to end] as an integer between min and max, in place, with the str_to_long_ex messages
  * @param s String to convert
  * @param start Start position of the chunk
  * @param end End position of the chunk
- * @param i A pointer to an integer variable which will receive the value.
  * @param base Base for converting values
+ * @param min smallest value
+ * @param max greatest value
+ * @param value set to the value on success
  * @return TRUE or FALSE
  */
-int str_to_long_ex(const char* s, NSTRBYTE start, NSTRBYTE end, long int* i, const int base) {
-    char* tmpstr = NULL;
-    char* endstr = NULL;
-    long l = 0;
-
+static int _str_to_ranged_integer(const char* s, NSTRBYTE start, NSTRBYTE end, const int base, int64_t min, int64_t max, int64_t* value) {
     __n_assert(s, return FALSE);
 
     if (start > end) return FALSE;
 
-    Malloc(tmpstr, char, sizeof(int) + end - start + 8);
-    __n_assert(tmpstr, n_log(LOG_ERR, "Unable to Malloc( tmpstr , char ,  sizeof( int ) + %d - %d )", end, start); return FALSE);
-
-    memcpy(tmpstr, s + start, end - start);
-
-    errno = 0;
-    l = strtol(tmpstr, &endstr, base);
-    int error = errno;
-
-    /* test return to number and errno values */
-    if (tmpstr == endstr) {
-        n_log(LOG_ERR, " number : %ld  invalid  (no digits found, 0 returned)", l);
-        Free(tmpstr);
+    const char* chunk = s + start;
+    int len = (end - start > INT_MAX) ? INT_MAX : (int)(end - start);
+    if (base != 0 && (base < 2 || base > 36)) {
+        n_log(LOG_ERR, "number: '%.*s' invalid (base contains unsupported value)", len, chunk);
         return FALSE;
-    } else if (error == ERANGE && l == LONG_MIN) {
-        n_log(LOG_ERR, " number : %ld  invalid  (underflow occurred)", l);
-        Free(tmpstr);
-        return FALSE;
-    } else if (error == ERANGE && l == LONG_MAX) {
-        n_log(LOG_ERR, " number : %ld  invalid  (overflow occurred)", l);
-        Free(tmpstr);
-        return FALSE;
-    } else if (error == EINVAL) /* not in all c99 implementations - gcc OK */
-    {
-        n_log(LOG_ERR, " number : %ld  invalid  (base contains unsupported value)", l);
-        Free(tmpstr);
+    }
+    uint64_t magnitude = 0;
+    int negative = FALSE;
+    int overflow = FALSE;
+    size_t parsed = _nstr_parse_integer(chunk, end - start, base, (uint64_t)max, (uint64_t)(-(min + 1)) + 1, &magnitude, &negative, &overflow);
+    if (parsed == 0) {
+        n_log(LOG_ERR, "number: '%.*s' invalid (no digits found, 0 returned)", len, chunk);
         return FALSE;
-    } else if (error != 0 && l == 0) {
-        n_log(LOG_ERR, " number : %ld  invalid  (unspecified error occurred)", l);
-        Free(tmpstr);
+    }
+    if (overflow) {
+        n_log(LOG_ERR, "number: '%.*s' invalid (%s occurred)", len, chunk, negative ? "underflow" : "overflow");
         return FALSE;
-    } else if (error == 0 && !*endstr) {
-        n_log(LOG_DEBUG, " number : %ld    valid  (and represents all characters read)", l);
-    } else if (error == 0 && *endstr != 0) {
-        n_log(LOG_DEBUG, " number : %ld    valid  (but additional characters remain", l);
     }
-    Free(tmpstr);
-    *i = l;
+    if (parsed < end - start && chunk[parsed] != '\0')
+        n_log(LOG_DEBUG, "number: '%.*s' valid (remaining characters: '%.*s')", len, chunk, len - (int)parsed, chunk + parsed);
+    (*value) = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+    return TRUE;
+} /* _str_to_ranged_integer(...) */
+
+/**
+ * @brief Helper for string[start to end] to long integer. Leave values untouched if any error occur. The chunk is parsed in place, characters after the number are ignored
+ * @param s String to convert
+ * @param start Start position of the chunk
+ * @param end End position of the chunk
+ * @param i A pointer to an integer variable which will receive the value.
+ * @param base Base for converting values
+ * @return TRUE or FALSE
+ */
+int str_to_long_ex(const char* s, NSTRBYTE start, NSTRBYTE end, long int* i, const int base) {
+    int64_t value = 0;
+    if (_str_to_ranged_integer(s, start, end, base, LONG_MIN, LONG_MAX, &value) == FALSE)
+        return FALSE;
+    *i = (long int)value;
     return TRUE;
 } /* str_to_long_ex( ... ) */
 
 /**
- * @brief Helper for string[start to end] to long long integer. Automatically add /0 for conversion. Leave values untouched if any error occur. Work on a copy of the chunk.
+ * @brief Helper for string[start to end] to long long integer. Leave values untouched if any error occur. The chunk is parsed in place, characters after the number are ignored
  * @param s String to convert
  * @param start Start position of the chunk
  * @param end End position of the chunk
@@ -621,52 +1817,10 @@ int str_to_long_ex(const char* s, NSTRBYTE start, NSTRBYTE end, long int* i, con
  * @return TRUE or FALSE
  */
 int str_to_long_long_ex(const char* s, NSTRBYTE start, NSTRBYTE end, long long int* i, const int base) {
-    char* tmpstr = NULL;
-    char* endstr = NULL;
-    long long l = 0;
-
-    __n_assert(s, return FALSE);
-
-    if (start > end) return FALSE;
-
-    Malloc(tmpstr, char, sizeof(int) + end - start + 8);
-    __n_assert(tmpstr, n_log(LOG_ERR, "Unable to Malloc( tmpstr , char ,  sizeof( int ) + %d - %d )", end, start); return FALSE);
-
-    memcpy(tmpstr, s + start, end - start);
-
-    errno = 0;
-    l = strtoll(tmpstr, &endstr, base);
-    int error = errno;
-
-    /* test return to number and errno values */
-    if (tmpstr == endstr) {
-        n_log(LOG_ERR, "number: '%s' invalid (no digits found, 0 returned)", s);
-        Free(tmpstr);
+    int64_t value = 0;
+    if (_str_to_ranged_integer(s, start, end, base, LLONG_MIN, LLONG_MAX, &value) == FALSE)
         return FALSE;
-    } else if (error == ERANGE && l == LLONG_MIN) {
-        n_log(LOG_ERR, "number: '%s' invalid (underflow occurred)", s);
-        Free(tmpstr);
-        return FALSE;
-    } else if (error == ERANGE && l == LLONG_MAX) {
-        n_log(LOG_ERR, "number: 's' invalid (overflow occurred)", s);
-        Free(tmpstr);
-        return FALSE;
-    } else if (error == EINVAL) /* not in all c99 implementations - gcc OK */
-    {
-        n_log(LOG_ERR, "number: '%s' invalid (base contains unsupported value)", s);
-        Free(tmpstr);
-        return FALSE;
-    } else if (error != 0 && l == 0) {
-        n_log(LOG_ERR, "number: '%s' invalid (unspecified error occurred)", s);
-        Free(tmpstr);
-        return FALSE;
-    } else if (error == 0 && !*endstr) {
-        n_log(LOG_DEBUG, "number : '%llu' valid (and represents all characters read)", l);
-    } else if (error == 0 && *endstr != 0) {
-        n_log(LOG_DEBUG, " number : '%llu' valid (remaining characters: '%s')", l, s);
-    }
-    Free(tmpstr);
-    *i = l;
+    *i = (long long int)value;
     return TRUE;
 } /* str_to_long_long_ex( ... ) */
 
@@ -715,7 +1869,6 @@ N_STR* nstrdup(N_STR* str) {
     if (new_str) {
         if (new_str->data) {
             memcpy(new_str->data, str->data, str->written);
-            new_str->length = str->length;
             new_str->written = str->written;
         } else {
             Free(new_str);
@@ -789,6 +1942,18 @@ int skipu(const char* string, char toskip, NSTRBYTE* iterator, int inc) {
     __n_assert(string, return FALSE);
 
     NSTRBYTE slen = (NSTRBYTE)strlen(string);
+    if (toskip != ' ' && inc == 1) {
+        if (*iterator > slen)
+            return FALSE;
+        /* the terminating '\0' is searched too, like the loop below does */
+        const char* found = memchr(string + *iterator, toskip, slen - *iterator + 1);
+        if (!found) {
+            *iterator = slen + 1;
+            return FALSE;
+        }
+        *iterator = (NSTRBYTE)(found - string);
+        return TRUE;
+    }
     if (toskip == ' ') {
         while (*iterator <= slen && !isspace((unsigned char)string[*iterator])) {
             if (inc < 0 && *iterator == 0) {
@@ -830,15 +1995,12 @@ int skipu(const char* string, char toskip, NSTRBYTE* iterator, int inc) {
  *@return TRUE or FALSE
  */
 int strup(const char* string, char* dest) {
-    NSTRBYTE it = 0;
-
     __n_assert(string, return FALSE);
     __n_assert(dest, return FALSE);
 
-    for (it = 0; it < (NSTRBYTE)strlen(string); it++)
-        dest[it] = (char)toupper(string[it]);
-
-    dest[strlen(string)] = '\0';
+    size_t len = strlen(string);
+    _nstr_convert_case(string, dest, len, toupper, 'a', 'z');
+    dest[len] = '\0';
 
     return TRUE;
 } /*strup(...)*/
@@ -851,15 +2013,12 @@ int strup(const char* string, char* dest) {
  *@return TRUE or FALSE
  */
 int strlo(const char* string, char* dest) {
-    NSTRBYTE it = 0;
-
     __n_assert(string, return FALSE);
     __n_assert(dest, return FALSE);
 
-    for (it = 0; it < (NSTRBYTE)strlen(string); it++)
-        dest[it] = (char)tolower(string[it]);
-
-    dest[strlen(string)] = '\0';
+    size_t len = strlen(string);
+    _nstr_convert_case(string, dest, len, tolower, 'A', 'Z');
+    dest[len] = '\0';
 
     return TRUE;
 } /*strlo(...)*/
@@ -893,93 +2052,114 @@ int strcpy_u(const char* from, char* to, NSTRBYTE to_size, char split, NSTRBYTE*
         return FALSE;
     }
 
-    to[_it] = '\0';
-
-    if (from[(*it)] != split) {
-        n_log(LOG_DEBUG, "strcpy_u: split value not found, written %d octet to dest (%d max) , %s: %d", _it, to_size, __FILE__, __LINE__);
-        return FALSE;
+    to[_it] = '\0';
+
+    if (from[(*it)] != split) {
+        n_log(LOG_DEBUG, "strcpy_u: split value not found, written %d octet to dest (%d max) , %s: %d", _it, to_size, __FILE__, __LINE__);
+        return FALSE;
+    }
+    return TRUE;
+} /* strcpy_u(...) */
+
+/**
+ *@brief split a buffer into (offset, length) spans, without any allocation. The sections are the same as the ones of split()
+ *@param str bytes to split, a '\0' in them is an ordinary byte
+ *@param len number of bytes of str
+ *@param delim The delimiter, one or more characters
+ *@param empty Empty flag. If 1, then empty delimited areas are given as empty spans, else they are skipped.
+ *@param spans array receiving the spans, can be NULL if max_spans is 0
+ *@param max_spans number of spans the array can hold
+ *@return the number of sections, which can be bigger than max_spans: only the first max_spans are written. 0 on error
+ */
+size_t split_spans(const char* str, size_t len, const char* delim, int empty, N_STR_SPAN* spans, size_t max_spans) {
+    __n_assert(str, return 0);
+    __n_assert(delim, return 0);
+
+    size_t delim_len = strlen(delim);
+    if (delim_len == 0) {
+        n_log(LOG_ERR, "empty delimiter");
+        return 0;
+    }
+
+    size_t nb_spans = 0;
+    size_t start = 0;
+    size_t pos = 0;
+    while (len - pos >= delim_len) {
+        /* memchr is the vectorized search of the C library, candidates are then checked for the rest of the delimiter */
+        const char* found = memchr(str + pos, delim[0], len - pos - delim_len + 1);
+        if (!found)
+            break;
+        size_t at = (size_t)(found - str);
+        if (delim_len > 1 && memcmp(found + 1, delim + 1, delim_len - 1) != 0) {
+            pos = at + 1;
+            continue;
+        }
+        if (empty == 1 || at > start) {
+            if (nb_spans < max_spans) {
+                spans[nb_spans].offset = start;
+                spans[nb_spans].length = at - start;
+            }
+            nb_spans++;
+        }
+        start = at + delim_len;
+        pos = start;
+    }
+
+    /* adding last part if any */
+    if (len > start || empty == 1) {
+        if (nb_spans < max_spans) {
+            spans[nb_spans].offset = start;
+            spans[nb_spans].length = len - start;
+        }
+        nb_spans++;
     }
-    return TRUE;
-} /* strcpy_u(...) */
+    return nb_spans;
+} /* split_spans(...) */
 
 /**
  *@brief split the strings into a an array of char *pointer	, ended by a NULL one.
  *@param str The char *str to split
  *@param delim The delimiter, one or more characters
- *@param empty Empty flag. If 1, then empty delimited areas will be added as NULL entries, else they will be skipped.
+ *@param empty Empty flag. If 1, then empty delimited areas will be added as empty strings, else they will be skipped.
  *@return An array of char *, ended by a NULL entry.
  */
 char** split(const char* str, const char* delim, int empty) {
-    char** tab = NULL;              /* result array */
-    char* ptr = NULL;               /* tmp pointer */
-    char** tmp = NULL;              /* temporary pointer for realloc */
-    size_t sizeStr = 0;             /* string token size */
-    size_t sizeTab = 0;             /* array size */
-    const char* largestring = NULL; /* pointer to start of string */
-
     __n_assert(str, return NULL);
     __n_assert(delim, return NULL);
-
-    size_t sizeDelim = strlen(delim);
-    largestring = str;
-
-    while ((ptr = strstr(largestring, delim)) != NULL) {
-        sizeStr = (size_t)(ptr - largestring);
-        if (empty == 1 || sizeStr != 0) {
-            sizeTab++;
-            tmp = (char**)realloc(tab, sizeof(char*) * sizeTab);
-            __n_assert(tmp, goto error);
-            tab = tmp;
-
-            Malloc(tab[sizeTab - 1], char, sizeof(char) * (sizeStr + 1));
-            __n_assert(tab[sizeTab - 1], goto error);
-
-            memcpy(tab[sizeTab - 1], largestring, sizeStr);
-            tab[sizeTab - 1][sizeStr] = '\0';
-        }
-        ptr = ptr + sizeDelim;
-        largestring = ptr;
+    if (delim[0] == '\0') {
+        n_log(LOG_ERR, "empty delimiter");
+        return NULL;
     }
 
-    /* adding last part if any */
-    if (strlen(largestring) != 0) {
-        sizeStr = strlen(largestring);
-        sizeTab++;
-
-        tmp = (char**)realloc(tab, sizeof(char*) * sizeTab);
-        __n_assert(tmp, goto error);
-        tab = tmp;
-
-        Malloc(tab[sizeTab - 1], char, sizeof(char) * (sizeStr + 1));
-        __n_assert(tab[sizeTab - 1], goto error);
-
-        memcpy(tab[sizeTab - 1], largestring, sizeStr);
-        tab[sizeTab - 1][sizeStr] = '\0';
-    } else {
-        if (empty == 1) {
-            sizeTab++;
-
-            tmp = (char**)realloc(tab, sizeof(char*) * sizeTab);
-            __n_assert(tmp, goto error);
-            tab = tmp;
-
-            Malloc(tab[sizeTab - 1], char, (int)(sizeof(char) * 1));
-            __n_assert(tab[sizeTab - 1], goto error);
-
-            tab[sizeTab - 1][0] = '\0';
-        }
+    size_t len = strlen(str);
+    N_STR_SPAN local_spans[NSTR_SPLIT_LOCAL_SPANS];
+    N_STR_SPAN* spans = local_spans;
+    size_t nb_spans = split_spans(str, len, delim, empty, spans, NSTR_SPLIT_LOCAL_SPANS);
+    if (nb_spans > NSTR_SPLIT_LOCAL_SPANS) {
+        spans = NULL;
+        Malloc(spans, N_STR_SPAN, nb_spans);
+        __n_assert(spans, return NULL);
+        split_spans(str, len, delim, empty, spans, nb_spans);
     }
 
-    /* on ajoute une case a null pour finir le tableau */
-    sizeTab++;
-    tmp = (char**)realloc(tab, sizeof(char*) * sizeTab);
-    __n_assert(tmp, goto error);
-    tab = tmp;
-    tab[sizeTab - 1] = NULL;
-
+    /* one more entry, left to NULL to end the array */
+    char** tab = NULL;
+    Malloc(tab, char*, nb_spans + 1);
+    __n_assert(tab, goto error);
+    for (size_t it = 0; it < nb_spans; it++) {
+        Malloc(tab[it], char, spans[it].length + 1);
+        __n_assert(tab[it], goto error);
+        memcpy(tab[it], str + spans[it].offset, spans[it].length);
+    }
+    if (spans != local_spans) {
+        Free(spans);
+    }
     return tab;
 
 error:
+    if (spans != local_spans) {
+        Free(spans);
+    }
     free_split_result(&tab);
     return NULL;
 } /* split( ... ) */
@@ -1120,8 +2300,7 @@ N_STR* nstrcat_ex(N_STR** dest, void* src, NSTRBYTE size, int resize_flag) {
     }
 
     if ((*dest)->length < (*dest)->written + size + 1) {
-        (*dest)->length = (*dest)->written + size + 1;
-        if (Reallocz((*dest)->data, char, (*dest)->written, (*dest)->length) == FALSE) {
+        if (resize_nstr((*dest), (*dest)->written + size + 1) == FALSE) {
             free_nstr(dest);
             return NULL;
         }
@@ -1243,10 +2422,59 @@ int scan_dir(const char* dir, LIST* result, const int recurse) {
  *@return TRUE or FALSE
  */
 int scan_dir_ex(const char* dir, const char* pattern, LIST* result, const int recurse, const int mode) {
+    __n_assert(pattern, return FALSE);
+    if (!result)
+        return FALSE;
+
+    /* compiled once for the whole tree instead of backtracking on each file */
+    N_GLOB* glob = n_glob_compile(pattern, N_GLOB_CASELESS);
+    __n_assert(glob, return FALSE);
+    int ret = scan_dir_glob(dir, glob, result, recurse, mode);
+    n_glob_delete(&glob);
+    return ret;
+} /*scan_dir_ex(...) */
+
+/**
+ *@brief get the type of a directory entry, from the entry itself when the system gives it, else with stat
+ *@param path full path of the entry
+ *@param entry directory entry
+ *@return 1 for a directory, 2 for a regular file, 0 for anything else
+ */
+static int _scan_dir_entry_type(const char* path, const struct dirent* entry) {
+#ifdef DT_DIR
+    if (entry->d_type == DT_DIR)
+        return 1;
+    if (entry->d_type == DT_REG)
+        return 2;
+#else
+    (void)entry;
+#endif
+    /* links and unknown types */
+    struct stat statbuf;
+    if (stat(path, &statbuf) < 0)
+        return 0;
+    if (S_ISDIR(statbuf.st_mode) != 0)
+        return 1;
+    if (S_ISREG(statbuf.st_mode) != 0)
+        return 2;
+    return 0;
+} /* _scan_dir_entry_type(...) */
+
+/**
+ *@brief Scan a list of directory and return a list of the files matching a compiled pattern
+ *@param dir The directory to scan
+ *@param glob Compiled pattern that files must follow to figure in the list, matched on their full path
+ *@param result A pointer to a valid LIST for the results
+ *@param recurse Recursive search if TRUE, directory only if FALSE
+ *@param mode 0 for a list of char* , 1 for a list of N_STR *
+ *@return TRUE or FALSE
+ */
+int scan_dir_glob(const char* dir, const N_GLOB* glob, LIST* result, const int recurse, const int mode) {
     DIR* dp = NULL;
     struct dirent* entry = NULL;
-    struct stat statbuf;
 
+    __n_assert(dir, return FALSE);
+    __n_assert(glob, return FALSE);
     if (!result)
         return FALSE;
 
@@ -1255,51 +2483,60 @@ int scan_dir_ex(const char* dir, const char* pattern, LIST* result, const int re
         return FALSE;
     }
 
-    N_STR* newname = NULL;
+    /* one path buffer for the directory, each name replaces the previous one after "dir/" */
+    N_STR* path = NULL;
+    if (!nstrprintf(path, "%s/", dir)) {
+        n_log(LOG_ERR, "could not allocate path for %s", dir);
+        closedir(dp);
+        return FALSE;
+    }
+    size_t dir_len = path->written;
+
+    int ret = TRUE;
     while ((entry = readdir(dp)) != NULL) {
-        if (!nstrprintf(newname, "%s/%s", dir, entry->d_name)) {
-            n_log(LOG_ERR, "could not allocate newname for %s/%s", dir, entry->d_name);
-            free_nstr(&newname);
+        if (strcmp(".", entry->d_name) == 0 || strcmp("..", entry->d_name) == 0)
             continue;
+
+        path->written = dir_len;
+        path->data[dir_len] = '\0';
+        if (!nstrcat_bytes(path, entry->d_name)) {
+            n_log(LOG_ERR, "could not allocate path for %s/%s", dir, entry->d_name);
+            ret = FALSE;
+            break;
         }
 
-        if (stat(newname->data, &statbuf) >= 0) {
-            if (S_ISDIR(statbuf.st_mode) != 0) {
-                if (strcmp(".", entry->d_name) == 0 || strcmp("..", entry->d_name) == 0) {
-                    free_nstr(&newname);
-                    continue;
+        int type = _scan_dir_entry_type(path->data, entry);
+        if (type == 1) {
+            /* Recurse */
+            if (recurse != FALSE) {
+                if (scan_dir_glob(path->data, glob, result, recurse, mode) != TRUE) {
+                    n_log(LOG_ERR, "scan_dir_glob( %s , %s , %p , %d , %d ) returned FALSE !", path->data, glob->pattern, result, recurse, mode);
                 }
-
-                /* Recurse */
-                if (recurse != FALSE) {
-                    if (scan_dir_ex(newname->data, pattern, result, recurse, mode) != TRUE) {
-                        n_log(LOG_ERR, "scan_dir_ex( %s , %s , %p , %d , %d ) returned FALSE !", newname->data, pattern, result, recurse, mode);
+            }
+        } else if (type == 2) {
+            if (n_glob_match(glob, path->data) == TRUE) {
+                if (mode == 0) {
+                    char* file = strdup(path->data);
+                    if (file) {
+                        list_push(result, file, &free);
+                    } else {
+                        n_log(LOG_ERR, "Error adding %s/%s to list", dir, entry->d_name);
                     }
-                }
-                free_nstr(&newname);
-                continue;
-            } else if (S_ISREG(statbuf.st_mode) != 0) {
-                if (wildmatcase(newname->data, pattern) == TRUE) {
-                    if (mode == 0) {
-                        char* file = strdup(newname->data);
-                        if (file) {
-                            list_push(result, file, &free);
-                        } else {
-                            n_log(LOG_ERR, "Error adding %s/%s to list", dir, entry->d_name);
-                        }
-                    } else if (mode == 1) {
-                        list_push(result, newname, &free_nstr_ptr);
-                        newname = NULL;
+                } else if (mode == 1) {
+                    N_STR* file = nstrdup(path);
+                    if (file) {
+                        list_push(result, file, &free_nstr_ptr);
+                    } else {
+                        n_log(LOG_ERR, "Error adding %s/%s to list", dir, entry->d_name);
                     }
                 }
             }
         }
-        if (newname)
-            free_nstr(&newname);
     }
+    free_nstr(&path);
     closedir(dp);
-    return TRUE;
-} /*scan_dir(...) */
+    return ret;
+} /*scan_dir_glob(...) */
 
 /**
  *@brief Written by Rich Salz rsalz at osf.org, refurbished by me. Wildcard pattern matching .
@@ -1428,6 +2665,207 @@ int wildmatcase(register const char* text, register const char* p) {
     return *text == '\0';
 } /* wildmatcase(...) */
 
+/**
+ *@brief tell if a character class of a pattern accepts a character, with the exact rules of wildmat and wildmatcase
+ *@param p pattern, on the opening '['
+ *@param t character to test
+ *@param caseless compare with toupper like wildmatcase
+ *@param end set to the closing ']' of the class, or to the end of the pattern if it has none
+ *@return TRUE or FALSE
+ */
+static int _n_glob_class_accepts(const char* p, char t, int caseless, const char** end) {
+    int last = 0;
+    int matched = FALSE;
+    int reverse = p[1] == WILDMAT_NEGATE_CLASS ? TRUE : FALSE;
+    if (reverse)
+        p++;
+    if (caseless) {
+        if (p[1] == ']' || p[1] == '-')
+            if (toupper(*++p) == toupper(t))
+                matched = TRUE;
+        for (last = toupper(*p); *++p && *p != ']'; last = toupper(*p))
+            if (*p == '-' && p[1] != ']'
+                    ? toupper(t) <= toupper(*++p) && toupper(t) >= last
+                    : toupper(t) == toupper(*p))
+                matched = TRUE;
+    } else {
+        if (p[1] == ']' || p[1] == '-')
+            if (*++p == t)
+                matched = TRUE;
+        for (last = *p; *++p && *p != ']'; last = *p)
+            if (*p == '-' && p[1] != ']'
+                    ? t <= *++p && t >= last
+                    : t == *p)
+                matched = TRUE;
+    }
+    (*end) = p;
+    return (matched != reverse) ? TRUE : FALSE;
+} /* _n_glob_class_accepts(...) */
+
+/**
+ *@brief compare bytes of a text with a literal part of a pattern
+ *@param text text bytes
+ *@param literal pattern bytes
+ *@param len number of bytes to compare
+ *@param caseless compare with toupper
+ *@return TRUE if they are equal
+ */
+static int _n_glob_equal(const char* text, const char* literal, size_t len, int caseless) {
+    if (!caseless)
+        return memcmp(text, literal, len) == 0 ? TRUE : FALSE;
+    for (size_t it = 0; it < len; it++) {
+        if (toupper(text[it]) != toupper(literal[it]))
+            return FALSE;
+    }
+    return TRUE;
+} /* _n_glob_equal(...) */
+
+/**
+ *@brief compile a wildmat pattern for n_glob_match. Each '?', '[class]' or literal of the pattern becomes a state of a bit-parallel automaton with a table of the characters it accepts, so that matching reads each character of the text once, where wildmat backtracks. The literal head and tail of the pattern are checked first, and patterns made of a head, a '*' and a tail need nothing else
+ *@param pattern wildmat pattern
+ *@param flags 0, or N_GLOB_CASELESS to match like wildmatcase
+ *@return a new N_GLOB to release with n_glob_delete, or NULL
+ */
+N_GLOB* n_glob_compile(const char* pattern, int flags) {
+    __n_assert(pattern, return NULL);
+
+    N_GLOB* glob = NULL;
+    Malloc(glob, N_GLOB, 1);
+    __n_assert(glob, return NULL);
+    glob->flags = flags;
+    glob->pattern = strdup(pattern);
+    __n_assert(glob->pattern, Free(glob); return NULL);
+    int caseless = (flags & N_GLOB_CASELESS) ? TRUE : FALSE;
+
+    /* literal value of each token, -1 for '?', classes and stars */
+    int* literals = NULL;
+    Malloc(literals, int, strlen(pattern) + 1);
+    __n_assert(literals, n_glob_delete(&glob); return NULL);
+
+    size_t nb_tokens = 0;
+    size_t nb_stars = 0;
+    for (const char* p = pattern; *p; p++) {
+        if (nb_tokens >= N_GLOB_MAX_TOKENS) {
+            /* too long for the automaton, n_glob_match falls back to wildmat */
+            Free(literals);
+            glob->nb_tokens = 0;
+            glob->fallback = 1;
+            return glob;
+        }
+        uint64_t bit = (uint64_t)1 << (nb_tokens + 1);
+        literals[nb_tokens] = -1;
+        switch (*p) {
+            case '*':
+                while (p[1] == '*')
+                    /* Consecutive stars act just like one. */
+                    p++;
+                glob->star_loop |= bit;
+                glob->star_eps |= bit >> 1;
+                nb_stars++;
+                break;
+            case '?':
+                for (int c = 1; c < 256; c++)
+                    glob->accept[c] |= bit;
+                break;
+            case '[': {
+                const char* end = p;
+                for (int c = 1; c < 256; c++) {
+                    if (_n_glob_class_accepts(p, (char)c, caseless, &end))
+                        glob->accept[c] |= bit;
+                }
+                p = end;
+                break;
+            }
+            case '\\':
+                /* Literal match with following character, a trailing backslash matches nothing */
+                p++;
+                /* FALLTHROUGH */
+            default:
+                if (*p)
+                    literals[nb_tokens] = (unsigned char)*p;
+                for (int c = 1; c < 256; c++) {
+                    if (caseless ? toupper((char)c) == toupper(*p) : (char)c == *p)
+                        glob->accept[c] |= bit;
+                }
+                break;
+        }
+        nb_tokens++;
+        /* an unterminated class or escape ends the pattern */
+        if (*p == '\0')
+            break;
+    }
+    glob->nb_tokens = nb_tokens;
+    glob->nb_stars = nb_stars;
+    glob->min_len = nb_tokens - nb_stars;
+    glob->start = 1 | ((1 & glob->star_eps) << 1);
+    glob->final = (uint64_t)1 << nb_tokens;
+
+    /* literal head, and literal tail after the last star */
+    size_t head = 0;
+    while (head < nb_tokens && literals[head] >= 0) head++;
+    size_t tail = 0;
+    if (nb_stars > 0) {
+        while (tail < nb_tokens && literals[nb_tokens - 1 - tail] >= 0) tail++;
+    }
+    for (size_t it = 0; it < head; it++) glob->head[it] = (char)literals[it];
+    for (size_t it = 0; it < tail; it++) glob->tail[it] = (char)literals[nb_tokens - tail + it];
+    glob->head_len = head;
+    glob->tail_len = tail;
+    /* head, one star and tail: checking both ends is the whole match */
+    glob->ends_only = (nb_stars == 1 && head + tail + 1 == nb_tokens) ? 1 : 0;
+
+    Free(literals);
+    return glob;
+} /* n_glob_compile(...) */
+
+/**
+ *@brief match a text against a compiled pattern, in a time linear in the text length
+ *@param glob pattern compiled by n_glob_compile
+ *@param text text to match
+ *@return TRUE if the whole text matches, else FALSE
+ */
+int n_glob_match(const N_GLOB* glob, const char* text) {
+    __n_assert(glob, return FALSE);
+    __n_assert(text, return FALSE);
+
+    int caseless = (glob->flags & N_GLOB_CASELESS) ? TRUE : FALSE;
+    if (glob->fallback)
+        return ((caseless ? wildmatcase(text, glob->pattern) : wildmat(text, glob->pattern)) == TRUE) ? TRUE : FALSE;
+
+    size_t len = strlen(text);
+    if (len < glob->min_len || (glob->nb_stars == 0 && len != glob->min_len))
+        return FALSE;
+    if (glob->head_len > 0 && !_n_glob_equal(text, glob->head, glob->head_len, caseless))
+        return FALSE;
+    if (glob->tail_len > 0 && !_n_glob_equal(text + len - glob->tail_len, glob->tail, glob->tail_len, caseless))
+        return FALSE;
+    if (glob->ends_only)
+        return TRUE;
+
+    /* bit k of state: the first k tokens match the text read so far */
+    uint64_t state = glob->start;
+    for (size_t it = 0; it < len; it++) {
+        state = ((state << 1) & glob->accept[(unsigned char)text[it]]) | (state & glob->star_loop);
+        /* a star can match nothing */
+        state |= (state & glob->star_eps) << 1;
+        if (!state)
+            return FALSE;
+    }
+    return (state & glob->final) ? TRUE : FALSE;
+} /* n_glob_match(...) */
+
+/**
+ *@brief destroy a compiled pattern and set it to NULL
+ *@param glob N_GLOB to destroy
+ *@return TRUE or FALSE
+ */
+int n_glob_delete(N_GLOB** glob) {
+    __n_assert(glob && (*glob), return FALSE);
+    FreeNoLog((*glob)->pattern);
+    Free((*glob));
+    return TRUE;
+} /* n_glob_delete(...) */
+
 /**
  *@brief Replace "substr" by "replacement" inside string
  taken from http://coding.debuntu.org/c-implementing-str_replace-replace-all-occurrences-substring
@@ -1438,9 +2876,7 @@ int wildmatcase(register const char* text, register const char* p) {
  *@return A copy of the sustituted string or NULL
  */
 char* str_replace(const char* string, const char* substr, const char* replacement) {
-    const char* tok = NULL;
-    char* newstr = NULL;
-    char* head = NULL;
+    __n_assert(string, return NULL);
 
     if (substr == NULL || substr[0] == '\0' || replacement == NULL)
         return strdup(string);
@@ -1448,36 +2884,44 @@ char* str_replace(const char* string, const char* substr, const char* replacemen
     size_t substr_len = strlen(substr);
     size_t replacement_len = strlen(replacement);
 
-    newstr = strdup(string);
-    if (!newstr) return NULL;
-    head = newstr;
-    while ((tok = strstr(head, substr))) {
-        char* oldstr = newstr;
-        size_t oldstr_len = strlen(oldstr);
-        size_t base_len = oldstr_len - substr_len;
+    /* count first, so that the result is allocated and written once */
+    size_t nb_found = 0;
+    for (const char* tok = strstr(string, substr); tok; tok = strstr(tok + substr_len, substr))
+        nb_found++;
+    if (nb_found == 0)
+        return strdup(string);
+
+    size_t string_len = strlen(string);
+    size_t newlen = string_len;
+    if (replacement_len >= substr_len) {
+        size_t extra = replacement_len - substr_len;
         /* Prevent size_t overflow in allocation size calculation */
-        if (base_len > SIZE_MAX - 8 ||
-            replacement_len > SIZE_MAX - base_len - 8) {
-            n_log(LOG_ERR, "str_replace: allocation size overflow (base_len=%zu, replacement_len=%zu)", base_len, replacement_len);
-            free(oldstr);
-            return NULL;
-        }
-        size_t newlen = base_len + replacement_len + 8;
-        Malloc(newstr, char, newlen);
-        /*failed to alloc mem, free old string and return NULL */
-        if (newstr == NULL) {
-            n_log(LOG_ERR, "str_replace: could not allocate newstr of size %zu", newlen);
-            free(oldstr);
+        if (extra > 0 && nb_found > (SIZE_MAX - string_len - 1) / extra) {
+            n_log(LOG_ERR, "str_replace: allocation size overflow (string_len=%zu, %zu replacements of %zu bytes)", string_len, nb_found, replacement_len);
             return NULL;
         }
-        memcpy(newstr, oldstr, (size_t)(tok - oldstr));
-        memcpy(newstr + (tok - oldstr), replacement, replacement_len);
-        memcpy(newstr + (tok - oldstr) + replacement_len, tok + substr_len, oldstr_len - substr_len - (size_t)(tok - oldstr));
-        memset(newstr + oldstr_len - substr_len + replacement_len, 0, 1);
-        /* move back head right after the last replacement */
-        head = newstr + (tok - oldstr) + replacement_len;
-        free(oldstr);
+        newlen += nb_found * extra;
+    } else {
+        newlen -= nb_found * (substr_len - replacement_len);
+    }
+
+    char* newstr = NULL;
+    Malloc(newstr, char, newlen + 1);
+    if (newstr == NULL) {
+        n_log(LOG_ERR, "str_replace: could not allocate newstr of size %zu", newlen + 1);
+        return NULL;
     }
+    char* dst = newstr;
+    const char* head = string;
+    for (const char* tok = strstr(head, substr); tok; tok = strstr(head, substr)) {
+        memcpy(dst, head, (size_t)(tok - head));
+        dst += tok - head;
+        memcpy(dst, replacement, replacement_len);
+        dst += replacement_len;
+        head = tok + substr_len;
+    }
+    memcpy(dst, head, string_len - (size_t)(head - string));
+    newstr[newlen] = '\0';
     return newstr;
 }
 
@@ -1494,14 +2938,28 @@ int str_sanitize_ex(char* string, const NSTRBYTE string_len, const char* mask, c
     __n_assert(string, return FALSE);
     __n_assert(mask, return FALSE);
 
+    /* the mask ends at its first '\0' */
+    size_t nb_mask = 0;
+    while (nb_mask < masklen && mask[nb_mask] != '\0') nb_mask++;
+    if (nb_mask == 0)
+        return TRUE;
+
     NSTRBYTE it = 0;
-    for (it = 0; it < string_len; it++) {
-        NSTRBYTE mask_it = 0;
-        while (mask_it < masklen && mask[mask_it] != '\0') {
-            if (string[it] == mask[mask_it])
-                string[it] = replacement;
-            mask_it++;
-        }
+#ifdef NSTR_SIMD_X86
+    /* one compare per mask byte and block, a lookup table is faster for bigger masks */
+    if (nb_mask <= NSTR_SIMD_MASK_MAX) {
+        if (nstr_simd_level() >= NSTR_SIMD_AVX2)
+            it = _nstr_sanitize_avx2(string, string_len, mask, nb_mask, replacement);
+        else if (nstr_simd_level() >= NSTR_SIMD_SSE2)
+            it = _nstr_sanitize_sse2(string, string_len, mask, nb_mask, replacement);
+    }
+#endif
+    uint8_t in_mask[256] = {0};
+    for (size_t mask_it = 0; mask_it < nb_mask; mask_it++)
+        in_mask[(unsigned char)mask[mask_it]] = 1;
+    for (; it < string_len; it++) {
+        if (in_mask[(unsigned char)string[it]])
+            string[it] = replacement;
     }
     return TRUE;
 }
@@ -1527,28 +2985,58 @@ int resize_nstr(N_STR* nstr, size_t size) {
     __n_assert(nstr, return FALSE);
     if (size == 0) {
         // Free the current buffer and reset fields
-        Free(nstr->data);
-        nstr->written = 0;
-        nstr->length = 0;
+        nstr_free_data(nstr);
+        return TRUE;
+    }
+
+    if (nstr->flags & NSTR_MAPPED) {
+        // a mapped file has no spare room, the data moves to the heap before being resized
+        size_t allocated = 0;
+        size_t keep = (nstr->written < size) ? nstr->written : size - 1;
+        char* data = _nstr_cache_alloc(size, &allocated);
+        __n_assert(data, return FALSE);
+        memcpy(data, nstr->data, keep);
+        nstr_free_data(nstr);
+        nstr->data = data;
+        nstr->length = allocated;
+        nstr->written = keep;
+        nstr->flags = NSTR_CACHED;
+        return TRUE;
+    }
+
+    if (_nstr_is_inline(nstr)) {
+        // the block is already big enough, else the data moves to its own block
+        if (size <= nstr->length)
+            return TRUE;
+        size_t allocated = 0;
+        char* data = _nstr_cache_alloc(size, &allocated);
+        __n_assert(data, return FALSE);
+        memcpy(data, nstr->data, nstr->length);
+        nstr->data = data;
+        nstr->length = allocated;
+        nstr->flags = NSTR_CACHED;
         return TRUE;
     }
 
     if (!nstr->data) {
-        Malloc(nstr->data, char, size);
-        __n_assert(nstr->data, return FALSE);
-    } else {
-        if (Reallocz(nstr->data, char, nstr->length, size) == FALSE) {
-            return FALSE;
-        }
+        nstr->data = _nstr_cache_alloc(size, &nstr->length);
+        __n_assert(nstr->data, nstr->length = 0; return FALSE);
+        nstr->flags |= NSTR_CACHED;
+        return TRUE;
+    }
+    if (Reallocz(nstr->data, char, nstr->length, size) == FALSE) {
+        return FALSE;
     }
 
     nstr->length = size;
+    /* a reallocated block is not a cache block anymore */
+    nstr->flags &= ~NSTR_CACHED;
 
     return TRUE;
 }
 
 /**
- * @brief Function to allocate and format a string into an N_STR object.
+ * @brief Function to allocate and format a string into an N_STR object. The text is first formatted in the current buffer, vsnprintf only runs a second time when it does not fit.
  * @param nstr_var Pointer to a pointer to the N_STR object to allocate/resize.
  * @param format The format string (like printf).
  * @param ... Arguments to be formatted.
@@ -1561,10 +3049,24 @@ N_STR* nstrprintf_ex(N_STR** nstr_var, const char* format, ...) {
     va_list args_copy;
     int needed_size = 0;
 
-    // Calculate the required size for the formatted string
     va_start(args, format);
     va_copy(args_copy, args);  // Copy args for reuse
-    needed_size = vsnprintf(NULL, 0, format, args);
+    if ((*nstr_var) && (*nstr_var)->data && (*nstr_var)->length > 0) {
+        // Most strings are reused with enough room: format in place, the result is the needed size if it does not fit
+        needed_size = vsnprintf((*nstr_var)->data, (*nstr_var)->length, format, args);
+        if (needed_size >= 0 && (size_t)needed_size < (*nstr_var)->length) {
+            va_end(args);
+            va_end(args_copy);
+            (*nstr_var)->written = (size_t)needed_size;
+            return (*nstr_var);
+        }
+        // the old content was overwritten by the attempt, leave an empty string if the function fails below
+        (*nstr_var)->data[0] = '\0';
+        (*nstr_var)->written = 0;
+    } else {
+        // Calculate the required size for the formatted string
+        needed_size = vsnprintf(NULL, 0, format, args);
+    }
     va_end(args);
 
     if (needed_size < 0) {
@@ -1600,7 +3102,7 @@ N_STR* nstrprintf_ex(N_STR** nstr_var, const char* format, ...) {
 }
 
 /**
- * @brief Function to allocate, format, and concatenate a string into an N_STR object.
+ * @brief Function to allocate, format, and concatenate a string into an N_STR object. The text is first formatted in the free space of the buffer, vsnprintf only runs a second time when it does not fit.
  * @param nstr_var Pointer to a pointer to the N_STR object to allocate/resize and concatenate.
  * @param format The format string (like printf).
  * @param ... Variadic arguments for formatting.
@@ -1616,8 +3118,23 @@ N_STR* nstrprintf_cat_ex(N_STR** nstr_var, const char* format, ...) {
     va_list args_copy;
     va_copy(args_copy, args);
 
-    // compute needed size
-    int needed_size = vsnprintf(NULL, 0, format, args_copy);
+    int needed_size = 0;
+    if ((*nstr_var) && (*nstr_var)->data && (*nstr_var)->length > (*nstr_var)->written) {
+        // format in the free space, the result is the needed size if it does not fit
+        size_t available = (*nstr_var)->length - (*nstr_var)->written;
+        needed_size = vsnprintf((*nstr_var)->data + (*nstr_var)->written, available, format, args_copy);
+        if (needed_size >= 0 && (size_t)needed_size < available) {
+            va_end(args_copy);
+            va_end(args);
+            (*nstr_var)->written += (size_t)needed_size;
+            return (*nstr_var);
+        }
+        if ((*nstr_var)->written < (*nstr_var)->length)
+            (*nstr_var)->data[(*nstr_var)->written] = '\0';
+    } else {
+        // compute needed size
+        needed_size = vsnprintf(NULL, 0, format, args_copy);
+    }
     va_end(args_copy);
 
     if (needed_size < 0) {
@@ -1670,37 +3187,587 @@ N_STR* nstrprintf_cat_ex(N_STR** nstr_var, const char* format, ...) {
     return *nstr_var;
 }
 
+/*! decimal digits of the numbers from 00 to 99 */
+static const char _nstr_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/**
+ *@brief write the decimal digits of a number, two at a time, backwards from the end of a buffer
+ *@param value number to write
+ *@param end position after the last digit
+ *@return position of the first digit
+ */
+static char* _nstr_write_u64(uint64_t value, char* end) {
+    while (value >= 100) {
+        size_t pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        *--end = _nstr_digit_pairs[pair + 1];
+        *--end = _nstr_digit_pairs[pair];
+    }
+    if (value >= 10) {
+        size_t pair = (size_t)value * 2;
+        *--end = _nstr_digit_pairs[pair + 1];
+        *--end = _nstr_digit_pairs[pair];
+    } else {
+        *--end = (char)('0' + value);
+    }
+    return end;
+} /* _nstr_write_u64(...) */
+
+/**
+ *@brief append bytes to an N_STR created if NULL. Unlike nstrcat_ex the buffer at least doubles when it grows, so that appending many small numbers reallocates a logarithmic number of times
+ *@param dest N_STR to append to
+ *@param src bytes to append
+ *@param size number of bytes
+ *@return the updated N_STR, or NULL with dest untouched
+ */
+static N_STR* _nstr_cat_number(N_STR** dest, const char* src, size_t size) {
+    if (!(*dest)) {
+        (*dest) = new_nstr(size);
+        __n_assert((*dest), return NULL);
+    }
+    size_t needed = (*dest)->written + size + 1;
+    if (needed > (*dest)->length) {
+        size_t grown = ((*dest)->length < SIZE_MAX / 2) ? (*dest)->length * 2 : needed;
+        if (resize_nstr((*dest), (grown > needed) ? grown : needed) == FALSE) {
+            n_log(LOG_ERR, "could not resize N_STR %p to size %zu", (*dest), needed);
+            return NULL;
+        }
+    }
+    memcpy((*dest)->data + (*dest)->written, src, size);
+    (*dest)->written += size;
+    (*dest)->data[(*dest)->written] = '\0';
+    return (*dest);
+} /* _nstr_cat_number(...) */
+
+/**
+ *@brief append the decimal text of a signed 64 bits integer, without the printf machinery
+ *@param dest N_STR to append to, created if NULL
+ *@param value number to append
+ *@return the updated N_STR, or NULL
+ */
+N_STR* n_nstr_cat_i64(N_STR** dest, int64_t value) {
+    __n_assert(dest, return NULL);
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* start = _nstr_write_u64((value < 0) ? 0 - (uint64_t)value : (uint64_t)value, end);
+    if (value < 0)
+        *--start = '-';
+    return _nstr_cat_number(dest, start, (size_t)(end - start));
+} /* n_nstr_cat_i64(...) */
+
+/**
+ *@brief append the decimal text of an unsigned 64 bits integer, without the printf machinery
+ *@param dest N_STR to append to, created if NULL
+ *@param value number to append
+ *@return the updated N_STR, or NULL
+ */
+N_STR* n_nstr_cat_u64(N_STR** dest, uint64_t value) {
+    __n_assert(dest, return NULL);
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* start = _nstr_write_u64(value, end);
+    return _nstr_cat_number(dest, start, (size_t)(end - start));
+} /* n_nstr_cat_u64(...) */
+
+/*! normalized 64 bits mantissas of the powers of ten 10^-348, 10^-340, ..., 10^340 */
+static const uint64_t _nstr_cached_pow10_f[87] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+    0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+    0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+    0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+    0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+    0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+    0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+    0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+    0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+    0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+    0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+    0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+    0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+    0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+    0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+
+/*! binary exponents of _nstr_cached_pow10_f */
+static const int16_t _nstr_cached_pow10_e[87] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066
+};
+
+/*! powers of ten as integers */
+static const uint64_t _nstr_pow10_u64[20] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+                                             10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+                                             10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL};
+
+/*! floating point number with a 64 bits mantissa, value f * 2^e */
+typedef struct N_DIYFP {
+    /*! mantissa */
+    uint64_t f;
+    /*! binary exponent */
+    int e;
+} N_DIYFP;
+
+/**
+ *@brief multiply two N_DIYFP, keeping the rounded upper 64 bits of the product
+ *@param x first factor
+ *@param y second factor
+ *@return x * y
+ */
+static N_DIYFP _nstr_diyfp_mul(N_DIYFP x, N_DIYFP y) {
+    const uint64_t mask32 = 0xFFFFFFFFULL;
+    uint64_t a = x.f >> 32, b = x.f & mask32, c = y.f >> 32, d = y.f & mask32;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & mask32) + (bc & mask32) + (1ULL << 31);
+    N_DIYFP product = {ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64};
+    return product;
+} /* _nstr_diyfp_mul(...) */
+
+/**
+ *@brief move the last digit of a Grisu3 result down while it gets closer to the exact value, then check that the digits are provably the closest shortest ones
+ *@param buffer digits
+ *@param len number of digits
+ *@param distance_too_high_w distance between the upper bound, widened by the error, and the value
+ *@param unsafe_interval width of the interval widened by the error
+ *@param rest distance between the digits and the upper bound
+ *@param ten_kappa weight of the last digit
+ *@param unit error of the scaled values
+ *@return TRUE if the digits are exact, FALSE if another algorithm has to decide
+ */
+static int _nstr_grisu_round_weed(char* buffer, size_t len, uint64_t distance_too_high_w, uint64_t unsafe_interval, uint64_t rest, uint64_t ten_kappa, uint64_t unit) {
+    uint64_t small_distance = distance_too_high_w - unit;
+    uint64_t big_distance = distance_too_high_w + unit;
+    while (rest < small_distance && unsafe_interval - rest >= ten_kappa && (rest + ten_kappa < small_distance || small_distance - rest >= rest + ten_kappa - small_distance)) {
+        buffer[len - 1]--;
+        rest += ten_kappa;
+    }
+    /* the value could be closer to the next digit down once the error is counted */
+    if (rest < big_distance && unsafe_interval - rest >= ten_kappa && (rest + ten_kappa < big_distance || big_distance - rest > rest + ten_kappa - big_distance))
+        return FALSE;
+    return (2 * unit <= rest && rest <= unsafe_interval - 4 * unit) ? TRUE : FALSE;
+} /* _nstr_grisu_round_weed(...) */
+
+/**
+ *@brief Grisu3 of Florian Loitsch: the shortest digits of a positive finite double that read back as the same value, and the closest ones among them. It gives up on about 0.5% of the values, when the error of its 64 bits arithmetic doesn't allow to decide
+ *@param value number, greater than 0
+ *@param buffer destination of at least 18 digits
+ *@param exponent set to the power of ten of the last digit
+ *@return number of digits, 0 if it gave up
+ */
+static size_t _nstr_grisu3(double value, char* buffer, int* exponent) {
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint64_t hidden_bit = 1ULL << 52;
+    int biased_e = (int)((bits >> 52) & 0x7FF);
+    N_DIYFP v = {bits & (hidden_bit - 1), 1 - 1075};
+    if (biased_e != 0) {
+        v.f += hidden_bit;
+        v.e = biased_e - 1075;
+    }
+
+    /* boundaries halfway to the neighbour doubles, the lower one is closer at a power of two */
+    N_DIYFP plus = {(v.f << 1) + 1, v.e - 1};
+    while (!(plus.f & (hidden_bit << 1))) {
+        plus.f <<= 1;
+        plus.e--;
+    }
+    plus.f <<= 10;
+    plus.e -= 10;
+    N_DIYFP minus = (v.f == hidden_bit && biased_e > 1) ? (N_DIYFP){(v.f << 2) - 1, v.e - 2} : (N_DIYFP){(v.f << 1) - 1, v.e - 1};
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+    while (!(v.f & (1ULL << 63))) {
+        v.f <<= 1;
+        v.e--;
+    }
+
+    /* scale by a cached power of ten so that the exponent of plus ends in [-60, -32] */
+    double dk = (-61 - plus.e) * 0.30102999566398114 + 347;
+    int k = (int)dk;
+    if (dk - k > 0.0)
+        k++;
+    size_t index = (size_t)((k >> 3) + 1);
+    N_DIYFP cached = {_nstr_cached_pow10_f[index], _nstr_cached_pow10_e[index]};
+    int decimal_exponent = 348 - (int)index * 8;
+
+    N_DIYFP w = _nstr_diyfp_mul(v, cached);
+    N_DIYFP too_low = _nstr_diyfp_mul(minus, cached);
+    N_DIYFP too_high = _nstr_diyfp_mul(plus, cached);
+
+    /* each product is off by at most one unit: widen the interval by it, the digits are checked against the error at the end */
+    uint64_t unit = 1;
+    too_low.f -= unit;
+    too_high.f += unit;
+    uint64_t unsafe_interval = too_high.f - too_low.f;
+    N_DIYFP one = {1ULL << -w.e, w.e};
+    uint32_t integrals = (uint32_t)(too_high.f >> -one.e);
+    uint64_t fractionals = too_high.f & (one.f - 1);
+    int kappa = 1;
+    while (kappa < 10 && integrals >= _nstr_pow10_u64[kappa]) kappa++;
+    size_t len = 0;
+    while (kappa > 0) {
+        uint32_t divisor = (uint32_t)_nstr_pow10_u64[kappa - 1];
+        buffer[len++] = (char)('0' + integrals / divisor);
+        integrals %= divisor;
+        kappa--;
+        uint64_t rest = ((uint64_t)integrals << -one.e) + fractionals;
+        if (rest < unsafe_interval) {
+            (*exponent) = kappa + decimal_exponent;
+            return _nstr_grisu_round_weed(buffer, len, too_high.f - w.f, unsafe_interval, rest, (uint64_t)divisor << -one.e, unit) ? len : 0;
+        }
+    }
+    for (;;) {
+        fractionals *= 10;
+        unit *= 10;
+        unsafe_interval *= 10;
+        buffer[len++] = (char)('0' + (fractionals >> -one.e));
+        fractionals &= one.f - 1;
+        kappa--;
+        if (fractionals < unsafe_interval) {
+            (*exponent) = kappa + decimal_exponent;
+            return _nstr_grisu_round_weed(buffer, len, (too_high.f - w.f) * unit, unsafe_interval, fractionals, one.f, unit) ? len : 0;
+        }
+    }
+} /* _nstr_grisu3(...) */
+
+/**
+ *@brief shortest digits of a positive finite double for the values Grisu3 gives up on: the correctly rounded 15, 16 or 17 digits, or the next decimal up, whichever reads back first as the same value. A double has at least 15 exact digits, so a shorter result shows up as trailing zeros
+ *@param value number, greater than 0
+ *@param buffer destination of at least 18 digits
+ *@param exponent set to the power of ten of the last digit
+ *@return number of digits
+ */
+static size_t _nstr_shortest_digits_fallback(double value, char* buffer, int* exponent) {
+    char text[32] = "";
+    uint64_t mantissa = 0;
+    for (int precision = 15; precision <= 17; precision++) {
+        snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+        mantissa = 0;
+        char* ptr = text;
+        for (; *ptr && *ptr != 'e'; ptr++) {
+            if (*ptr != '.')
+                mantissa = mantissa * 10 + (uint64_t)(*ptr - '0');
+        }
+        (*exponent) = atoi(ptr + 1) - (precision - 1);
+        if (strtod(text, NULL) == value)
+            break;
+        /* above a power of two the interval is wider over the value, the next decimal up may read back */
+        snprintf(text, sizeof(text), "%" PRIu64 "e%d", mantissa + 1, (*exponent));
+        if (strtod(text, NULL) == value) {
+            mantissa++;
+            break;
+        }
+    }
+    while (mantissa % 10 == 0) {
+        mantissa /= 10;
+        (*exponent)++;
+    }
+    char digits[24];
+    char* start = _nstr_write_u64(mantissa, digits + sizeof(digits));
+    size_t len = (size_t)(digits + sizeof(digits) - start);
+    memcpy(buffer, start, len);
+    return len;
+} /* _nstr_shortest_digits_fallback(...) */
+
+/**
+ *@brief write the shortest decimal text that reads back as the same double, computed with Grisu3 instead of trying printf precisions, printf deciding only for the few values Grisu3 can't. Values from 1e-5 to below 1e15 are written without exponent, the other ones like %g with an exponent of at least two digits: 0.1, 12.5, 123, 1e+20, 1.5e-07
+ *@param value number to write
+ *@param buffer destination of at least NSTR_DOUBLE_MAX_LEN bytes, not terminated
+ *@return number of bytes written
+ */
+size_t n_double_to_chars(double value, char* buffer) {
+    __n_assert(buffer, return 0);
+    char* out = buffer;
+    if (isnan(value)) {
+        memcpy(out, signbit(value) ? "-nan" : "nan", signbit(value) ? 4 : 3);
+        return signbit(value) ? 4 : 3;
+    }
+    if (signbit(value)) {
+        *out++ = '-';
+        value = -value;
+    }
+    if (isinf(value)) {
+        memcpy(out, "inf", 3);
+        return (size_t)(out - buffer) + 3;
+    }
+    if (value == 0) {
+        *out++ = '0';
+        return (size_t)(out - buffer);
+    }
+
+    char digits[24];
+    int exponent = 0;
+    size_t nb_digits = _nstr_grisu3(value, digits, &exponent);
+    if (nb_digits == 0)
+        nb_digits = _nstr_shortest_digits_fallback(value, digits, &exponent);
+    /* position of the decimal point from the first digit */
+    int point = (int)nb_digits + exponent;
+    if (point >= -4 && point <= 15) {
+        if (exponent >= 0) {
+            memcpy(out, digits, nb_digits);
+            out += nb_digits;
+            memset(out, '0', (size_t)exponent);
+            out += exponent;
+        } else if (point > 0) {
+            memcpy(out, digits, (size_t)point);
+            out += point;
+            *out++ = '.';
+            memcpy(out, digits + point, nb_digits - (size_t)point);
+            out += nb_digits - (size_t)point;
+        } else {
+            *out++ = '0';
+            *out++ = '.';
+            memset(out, '0', (size_t)-point);
+            out += -point;
+            memcpy(out, digits, nb_digits);
+            out += nb_digits;
+        }
+        return (size_t)(out - buffer);
+    }
+    *out++ = digits[0];
+    if (nb_digits > 1) {
+        *out++ = '.';
+        memcpy(out, digits + 1, nb_digits - 1);
+        out += nb_digits - 1;
+    }
+    int scientific = point - 1;
+    *out++ = 'e';
+    *out++ = (scientific < 0) ? '-' : '+';
+    char exponent_digits[8];
+    char* exponent_end = exponent_digits + sizeof(exponent_digits);
+    char* exponent_start = _nstr_write_u64((uint64_t)((scientific < 0) ? -scientific : scientific), exponent_end);
+    if (exponent_end - exponent_start < 2)
+        *out++ = '0';
+    memcpy(out, exponent_start, (size_t)(exponent_end - exponent_start));
+    out += exponent_end - exponent_start;
+    return (size_t)(out - buffer);
+} /* n_double_to_chars(...) */
+
+/**
+ *@brief append the shortest decimal text of a double that reads back as the same value
+ *@param dest N_STR to append to, created if NULL
+ *@param value number to append
+ *@return the updated N_STR, or NULL
+ */
+N_STR* n_nstr_cat_double(N_STR** dest, double value) {
+    __n_assert(dest, return NULL);
+    char buffer[NSTR_DOUBLE_MAX_LEN];
+    size_t len = n_double_to_chars(value, buffer);
+    return _nstr_cat_number(dest, buffer, len);
+} /* n_nstr_cat_double(...) */
+
+/**
+ *@brief Expand double-brace tokens in a template using a hash table. Tokens not found in vars are left unchanged. To expand the same template many times, compile it once with n_str_template_compile and use n_str_template_render
+ *@param tmpl Template string with {{key}} tokens
+ *@param vars Hash table mapping key to value, may be NULL
+ *@return Newly allocated N_STR with expanded result, or NULL on failure
+ */
 N_STR* n_str_template_expand(const char* tmpl, HASH_TABLE* vars) {
     if (!tmpl) return NULL;
-    N_STR* result = new_nstr(strlen(tmpl) + 256);
-    if (!result) return NULL;
-    const char* p = tmpl;
+    N_STR_TEMPLATE* compiled = n_str_template_compile(tmpl);
+    if (!compiled) return NULL;
+    N_STR* result = NULL;
+    n_str_template_render(compiled, vars, &result);
+    n_str_template_delete(&compiled);
+    return result;
+}
+
+/**
+ *@brief add a segment to a template being compiled, merging literal text with the previous literal segment
+ *@param compiled template being compiled, with room for the segment
+ *@param offset position of the segment in the template text
+ *@param length number of bytes of the segment
+ *@param key placeholder key in compiled->keys, NULL for literal text
+ *@param key_length length of key
+ */
+static void _n_str_template_add(N_STR_TEMPLATE* compiled, size_t offset, size_t length, char* key, size_t key_length) {
+    if (!key) {
+        compiled->literal_length += length;
+        if (compiled->nb_segments > 0 && !compiled->segments[compiled->nb_segments - 1].key) {
+            compiled->segments[compiled->nb_segments - 1].length += length;
+            return;
+        }
+    } else {
+        compiled->nb_keys++;
+    }
+    N_STR_TEMPLATE_SEGMENT* segment = &compiled->segments[compiled->nb_segments++];
+    segment->offset = offset;
+    segment->length = length;
+    segment->key = key;
+    segment->key_length = key_length;
+    segment->value = compiled->text + offset;
+    segment->value_length = length;
+} /* _n_str_template_add(...) */
+
+/**
+ *@brief parse a template once into literal text and {{key}} placeholders, with the same rules as n_str_template_expand
+ *@param tmpl Template string with {{key}} tokens
+ *@return a new N_STR_TEMPLATE to release with n_str_template_delete, or NULL
+ */
+N_STR_TEMPLATE* n_str_template_compile(const char* tmpl) {
+    __n_assert(tmpl, return NULL);
+
+    size_t len = strlen(tmpl);
+    N_STR_TEMPLATE* compiled = NULL;
+    Malloc(compiled, N_STR_TEMPLATE, 1);
+    __n_assert(compiled, return NULL);
+    /* at most one segment per byte, keys are shorter than the template */
+    Malloc(compiled->text, char, len + 1);
+    Malloc(compiled->keys, char, len + 1);
+    Malloc(compiled->segments, N_STR_TEMPLATE_SEGMENT, len + 1);
+    __n_assert(compiled->text && compiled->keys && compiled->segments, n_str_template_delete(&compiled); return NULL);
+    memcpy(compiled->text, tmpl, len + 1);
+
+    char* keys = compiled->keys;
+    const char* p = compiled->text;
+    const char* literal = p;
     while (*p) {
         if (p[0] == '{' && p[1] == '{') {
             const char* end = strstr(p + 2, "}}");
             if (end) {
                 size_t klen = (size_t)(end - (p + 2));
-                char key[256];
-                if (klen < sizeof(key)) {
-                    memcpy(key, p + 2, klen);
-                    key[klen] = '\0';
-                    char* val = NULL;
-                    if (vars && ht_get_string(vars, key, &val) == TRUE && val) {
-                        nstrprintf_cat(result, "%s", val);
-                    } else {
-                        nstrprintf_cat(result, "{{%s}}", key);
-                    }
+                if (klen < N_STR_TEMPLATE_MAX_KEY) {
+                    if (p > literal)
+                        _n_str_template_add(compiled, (size_t)(literal - compiled->text), (size_t)(p - literal), NULL, 0);
+                    memcpy(keys, p + 2, klen);
+                    keys[klen] = '\0';
+                    _n_str_template_add(compiled, (size_t)(p - compiled->text), klen + 4, keys, klen);
+                    keys += klen + 1;
                     p = end + 2;
+                    literal = p;
                     continue;
                 }
             }
         }
-        char ch[2] = {*p, '\0'};
-        nstrprintf_cat(result, "%s", ch);
         p++;
     }
-    return result;
-}
+    if (p > literal)
+        _n_str_template_add(compiled, (size_t)(literal - compiled->text), (size_t)(p - literal), NULL, 0);
+    return compiled;
+} /* n_str_template_compile(...) */
+
+/**
+ *@brief leave the read sections entered by n_str_template_render for the first nb segments, HASH_CONCURRENT tables only
+ *@param compiled rendered template
+ *@param vars table of the render
+ *@param nb number of segments looked up
+ */
+static void _nstr_template_unlock(N_STR_TEMPLATE* compiled, HASH_TABLE* vars, size_t nb) {
+    if (!vars || vars->mode != HASH_CONCURRENT)
+        return;
+    for (size_t it = 0; it < nb; it++) {
+        const N_STR_TEMPLATE_SEGMENT* segment = &compiled->segments[it];
+        if (segment->key && segment->key_length > 0)
+            ht_concurrent_read_unlock_hashed(vars, segment->hash, segment->read_parity);
+    }
+} /* _nstr_template_unlock(...) */
+
+/**
+ *@brief append a compiled template to an N_STR, each {{key}} replaced by its string value in vars or left unchanged. The keys are hashed once for all the tables of the same seed, and the values are looked up before writing so that out grows at most once. With a HASH_CONCURRENT table the read sections of the keys are held from the lookups to the copies, so that concurrent writers can't free the values in between. A compiled template keeps the hashes and values of its last render, it must not be rendered by several threads at once
+ *@param compiled template compiled by n_str_template_compile
+ *@param vars Hash table mapping key to value, may be NULL
+ *@param out N_STR to append to, created if NULL. Set (*out)->written to 0 to reuse it from one render to the next
+ *@return TRUE or FALSE
+ */
+int n_str_template_render(N_STR_TEMPLATE* compiled, HASH_TABLE* vars, N_STR** out) {
+    __n_assert(compiled, return FALSE);
+    __n_assert(out, return FALSE);
+
+    if (vars && compiled->nb_keys > 0 && (!compiled->hashed || compiled->hash_seed != vars->seed)) {
+        for (size_t it = 0; it < compiled->nb_segments; it++) {
+            N_STR_TEMPLATE_SEGMENT* segment = &compiled->segments[it];
+            if (segment->key)
+                segment->hash = ht_hash_key(vars, segment->key, segment->key_length);
+        }
+        compiled->hash_seed = vars->seed;
+        compiled->hashed = TRUE;
+    }
+
+    size_t total = compiled->literal_length;
+    for (size_t it = 0; it < compiled->nb_segments; it++) {
+        N_STR_TEMPLATE_SEGMENT* segment = &compiled->segments[it];
+        if (!segment->key)
+            continue;
+        char* val = NULL;
+        if (vars && vars->mode == HASH_CONCURRENT && segment->key_length > 0)
+            segment->read_parity = ht_concurrent_read_lock_hashed(vars, segment->hash);
+        if (vars && segment->key_length > 0 && ht_get_string_hashed(vars, segment->key, segment->hash, &val) == TRUE && val) {
+            segment->value = val;
+            segment->value_length = strlen(val);
+        } else {
+            segment->value = compiled->text + segment->offset;
+            segment->value_length = segment->length;
+        }
+        if (segment->value_length > SIZE_MAX - 2 - total) {
+            n_log(LOG_ERR, "integer overflow computing the size of template %p", compiled);
+            _nstr_template_unlock(compiled, vars, it + 1);
+            return FALSE;
+        }
+        total += segment->value_length;
+    }
+
+    size_t written = (*out) ? (*out)->written : 0;
+    if (total > SIZE_MAX - 2 - written) {
+        n_log(LOG_ERR, "integer overflow appending template %p to %p", compiled, (*out));
+        _nstr_template_unlock(compiled, vars, compiled->nb_segments);
+        return FALSE;
+    }
+    if (!(*out)) {
+        (*out) = new_nstr(total + 1);
+        __n_assert((*out), _nstr_template_unlock(compiled, vars, compiled->nb_segments); return FALSE);
+    } else if (written + total + 1 > (*out)->length) {
+        if (resize_nstr((*out), written + total + 1) == FALSE) {
+            n_log(LOG_ERR, "could not resize N_STR %p to size %zu", (*out), written + total + 1);
+            _nstr_template_unlock(compiled, vars, compiled->nb_segments);
+            return FALSE;
+        }
+    }
+
+    char* dest = (*out)->data + written;
+    for (size_t it = 0; it < compiled->nb_segments; it++) {
+        const N_STR_TEMPLATE_SEGMENT* segment = &compiled->segments[it];
+        if (segment->key) {
+            memcpy(dest, segment->value, segment->value_length);
+            dest += segment->value_length;
+        } else {
+            memcpy(dest, compiled->text + segment->offset, segment->length);
+            dest += segment->length;
+        }
+    }
+    (*dest) = '\0';
+    (*out)->written = written + total;
+    _nstr_template_unlock(compiled, vars, compiled->nb_segments);
+    return TRUE;
+} /* n_str_template_render(...) */
+
+/**
+ *@brief destroy a compiled template and set it to NULL
+ *@param compiled N_STR_TEMPLATE to destroy
+ *@return TRUE or FALSE
+ */
+int n_str_template_delete(N_STR_TEMPLATE** compiled) {
+    __n_assert(compiled && (*compiled), return FALSE);
+    FreeNoLog((*compiled)->text);
+    FreeNoLog((*compiled)->keys);
+    FreeNoLog((*compiled)->segments);
+    Free((*compiled));
+    return TRUE;
+} /* n_str_template_delete(...) */
 
 /**
  *@brief Percent-encode a C string per RFC 3986 (unreserved set kept as-is).
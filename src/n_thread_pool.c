@@ -565,3 +565,102 @@ int refresh_thread_pool(THREAD_POOL* thread_pool) {
 
     return TRUE;
 }  // refresh_thread_pool()
+
+/*! structure of a list_sort_parallel task param */
+typedef struct LIST_SORT_PARAM {
+    /*! list to sort, or to merge other into */
+    LIST* list;
+    /*! sorted list to merge into list, NULL to sort list */
+    LIST* other;
+    /*! items comparator */
+    int (*comparator)(const void* a, const void* b);
+} LIST_SORT_PARAM;
+
+/**
+ * @brief list_sort_parallel task: sort a sublist, or merge two sorted sublists
+ * @param param a LIST_SORT_PARAM
+ * @return NULL
+ */
+static void* _list_sort_proc(void* param) {
+    LIST_SORT_PARAM* sort_param = (LIST_SORT_PARAM*)param;
+    if (sort_param->other) {
+        list_merge_sorted(sort_param->list, sort_param->other, sort_param->comparator);
+    } else {
+        list_sort(sort_param->list, sort_param->comparator);
+    }
+    return NULL;
+} /* _list_sort_proc(...) */
+
+/**
+ * @brief run a list_sort_parallel task on the pool, or in the calling thread if it can't be queued
+ * @param thread_pool targeted thread pool
+ * @param sort_param task param
+ */
+static void _list_sort_submit(THREAD_POOL* thread_pool, LIST_SORT_PARAM* sort_param) {
+    if (add_threaded_process(thread_pool, &_list_sort_proc, sort_param, NORMAL_PROC) == FALSE) {
+        _list_sort_proc(sort_param);
+    }
+} /* _list_sort_submit(...) */
+
+/**
+ * @brief Sort a list with a stable merge sort spread on a thread pool: the list is cut in one sublist per pool thread, the sublists are sorted on the pool then merged two by two on the pool. Lists shorter than LIST_SORT_PARALLEL_MIN_ITEMS are sorted with list_sort in the calling thread. The pool is waited until idle between steps, so other work queued on it delays the sort.
+ * @param list the list to sort
+ * @param comparator A pointer to a function which take two void * pointers and return an int, called from the pool threads
+ * @param thread_pool a started thread pool, or NULL to sort in the calling thread
+ * @return TRUE or FALSE
+ */
+int list_sort_parallel(LIST* list, int (*comparator)(const void* a, const void* b), THREAD_POOL* thread_pool) {
+    __n_assert(list, return FALSE);
+    __n_assert(comparator, return FALSE);
+
+    if (!thread_pool || thread_pool->max_threads < 2 || list->nb_items < LIST_SORT_PARALLEL_MIN_ITEMS)
+        return list_sort(list, comparator);
+
+    size_t nb_chunks = thread_pool->max_threads;
+    LIST* chunks = NULL;
+    LIST_SORT_PARAM* params = NULL;
+    Malloc(chunks, LIST, nb_chunks);
+    __n_assert(chunks, return FALSE);
+    Malloc(params, LIST_SORT_PARAM, nb_chunks);
+    __n_assert(params, Free(chunks); return FALSE);
+
+    /* cut the list in contiguous sublists, keeping their order for a stable merge */
+    size_t nb_items = list->nb_items;
+    LIST_NODE* node = list->start;
+    for (size_t it = 0; it < nb_chunks; it++) {
+        size_t chunk_size = nb_items / nb_chunks + ((it < nb_items % nb_chunks) ? 1 : 0);
+        chunks[it].start = node;
+        for (size_t count = 1; count < chunk_size; count++) {
+            node = node->next;
+        }
+        chunks[it].end = node;
+        chunks[it].nb_items = chunk_size;
+        node = node->next;
+        chunks[it].start->prev = NULL;
+        chunks[it].end->next = NULL;
+    }
+    list->start = list->end = NULL;
+    list->nb_items = 0;
+
+    for (size_t it = 0; it < nb_chunks; it++) {
+        params[it].list = &chunks[it];
+        params[it].other = NULL;
+        params[it].comparator = comparator;
+        _list_sort_submit(thread_pool, &params[it]);
+    }
+    wait_for_threaded_pool(thread_pool);
+
+    for (size_t step = 1; step < nb_chunks; step *= 2) {
+        for (size_t it = 0; it + step < nb_chunks; it += 2 * step) {
+            params[it].list = &chunks[it];
+            params[it].other = &chunks[it + step];
+            _list_sort_submit(thread_pool, &params[it]);
+        }
+        wait_for_threaded_pool(thread_pool);
+    }
+
+    int ret = list_merge_sorted(list, &chunks[0], comparator);
+    Free(params);
+    Free(chunks);
+    return ret;
+} /* list_sort_parallel(...) */
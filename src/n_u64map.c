@@ -0,0 +1,428 @@
+/*
+ * Nilorea Library
+ * Copyright (C) 2005-2026 Castagnier Mickael
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ *@file n_u64map.c
+ *@brief Integer keyed map functions
+ *@author Castagnier Mickael
+ *@version 1.0
+ *@date 16/10/2026
+ */
+
+#include "nilorea/n_u64map.h"
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ *@brief mix the bits of a key, murmur3 finalizer
+ *@param key key to hash
+ *@return the hash of key
+ */
+FORCE_INLINE uint64_t _u64map_hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+/**
+ *@brief get the slots of a group whose control byte is ctrl
+ *@param group first control byte of the group
+ *@param ctrl control byte to look for
+ *@return a bit mask of the matching slots
+ */
+FORCE_INLINE uint32_t _u64map_group_match(const uint8_t* group, uint8_t ctrl) {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)ctrl)));
+#else
+    uint32_t mask = 0;
+    for (uint32_t it = 0; it < U64MAP_GROUP_SIZE; it++) {
+        if (group[it] == ctrl)
+            mask |= 1U << it;
+    }
+    return mask;
+#endif
+}
+
+/**
+ *@brief get the slots of a group that are empty or deleted
+ *@param group first control byte of the group
+ *@return a bit mask of the free slots
+ */
+FORCE_INLINE uint32_t _u64map_group_free(const uint8_t* group) {
+#ifdef __SSE2__
+    /* free slots are the ones with the high bit set */
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    uint32_t mask = 0;
+    for (uint32_t it = 0; it < U64MAP_GROUP_SIZE; it++) {
+        if (!U64MAP_SLOT_IS_FULL(group[it]))
+            mask |= 1U << it;
+    }
+    return mask;
+#endif
+}
+
+/**
+ *@brief get the number of slots needed to hold nb_items keys
+ *@param nb_items number of keys
+ *@return a power of two multiple of U64MAP_GROUP_SIZE
+ */
+size_t _u64map_size_for(size_t nb_items) {
+    size_t size = U64MAP_GROUP_SIZE;
+    while (size * U64MAP_MAX_LOAD_PERCENT < nb_items * 100) {
+        size *= 2;
+    }
+    return size;
+} /* _u64map_size_for(...) */
+
+/**
+ *@brief find the slot of a key
+ *@param map targeted map
+ *@param key key to find
+ *@param hash hash of key
+ *@return the slot index or SIZE_MAX if key is not in map
+ */
+size_t _u64map_find(const U64MAP* map, uint64_t key, uint64_t hash) {
+    size_t group_mask = map->size / U64MAP_GROUP_SIZE - 1;
+    size_t group = (size_t)(hash >> 7) & group_mask;
+    uint8_t ctrl = (uint8_t)(hash & 0x7F);
+    for (size_t probe = 0; probe <= group_mask; probe++) {
+        const uint8_t* group_ctrl = map->ctrl + group * U64MAP_GROUP_SIZE;
+        uint32_t match = _u64map_group_match(group_ctrl, ctrl);
+        while (match) {
+            size_t index = group * U64MAP_GROUP_SIZE + (size_t)__builtin_ctz(match);
+            if (map->keys[index] == key)
+                return index;
+            match &= match - 1;
+        }
+        /* a key is never placed past a group that still has an empty slot */
+        if (_u64map_group_match(group_ctrl, U64MAP_EMPTY))
+            return SIZE_MAX;
+        group = (group + probe + 1) & group_mask;
+    }
+    return SIZE_MAX;
+} /* _u64map_find(...) */
+
+/**
+ *@brief put a key that is not in the map in the first free slot of its probe sequence
+ *@param map targeted map, with at least one free slot
+ *@param key key to put
+ *@param hash hash of key
+ *@param value value of key
+ */
+void _u64map_insert(U64MAP* map, uint64_t key, uint64_t hash, void* value) {
+    size_t group_mask = map->size / U64MAP_GROUP_SIZE - 1;
+    size_t group = (size_t)(hash >> 7) & group_mask;
+    for (size_t probe = 0; probe <= group_mask; probe++) {
+        uint32_t free_slots = _u64map_group_free(map->ctrl + group * U64MAP_GROUP_SIZE);
+        if (free_slots) {
+            size_t index = group * U64MAP_GROUP_SIZE + (size_t)__builtin_ctz(free_slots);
+            if (map->ctrl[index] == U64MAP_DELETED)
+                map->nb_deleted--;
+            map->ctrl[index] = (uint8_t)(hash & 0x7F);
+            map->keys[index] = key;
+            map->values[index] = value;
+            map->nb_items++;
+            return;
+        }
+        group = (group + probe + 1) & group_mask;
+    }
+} /* _u64map_insert(...) */
+
+/**
+ *@brief move all the keys into new arrays of new_size slots, dropping the deleted slots
+ *@param map targeted map
+ *@param new_size new number of slots, a power of two multiple of U64MAP_GROUP_SIZE
+ *@return TRUE or FALSE
+ */
+int _u64map_rehash(U64MAP* map, size_t new_size) {
+    uint8_t* new_ctrl = NULL;
+    uint64_t* new_keys = NULL;
+    void** new_values = NULL;
+    Malloc(new_ctrl, uint8_t, new_size);
+    __n_assert(new_ctrl, return FALSE);
+    Malloc(new_keys, uint64_t, new_size);
+    __n_assert(new_keys, Free(new_ctrl); return FALSE);
+    Malloc(new_values, void*, new_size);
+    __n_assert(new_values, Free(new_ctrl); Free(new_keys); return FALSE);
+    memset(new_ctrl, U64MAP_EMPTY, new_size);
+
+    uint8_t* old_ctrl = map->ctrl;
+    uint64_t* old_keys = map->keys;
+    void** old_values = map->values;
+    size_t old_size = map->size;
+
+    map->ctrl = new_ctrl;
+    map->keys = new_keys;
+    map->values = new_values;
+    map->size = new_size;
+    map->nb_items = 0;
+    map->nb_deleted = 0;
+    for (size_t it = 0; it < old_size; it++) {
+        if (U64MAP_SLOT_IS_FULL(old_ctrl[it]))
+            _u64map_insert(map, old_keys[it], _u64map_hash(old_keys[it]), old_values[it]);
+    }
+    FreeNoLog(old_ctrl);
+    FreeNoLog(old_keys);
+    FreeNoLog(old_values);
+    return TRUE;
+} /* _u64map_rehash(...) */
+
+/**
+ *@brief create a new integer keyed map. Keys are stored inline, values are pointers.
+ *@param size number of keys the map can hold before growing
+ *@param destructor function called on the values replaced, removed or left in the map when it is emptied or destroyed, or NULL
+ *@return NULL or the new allocated map
+ */
+U64MAP* new_u64map(size_t size, void (*destructor)(void* ptr)) {
+    U64MAP* map = NULL;
+    Malloc(map, U64MAP, 1);
+    __n_assert(map, n_log(LOG_ERR, "Error allocating U64MAP *map"); return NULL);
+
+    map->destroy_func = destructor;
+    if (_u64map_rehash(map, _u64map_size_for(size)) == FALSE) {
+        n_log(LOG_ERR, "Could not allocate a U64MAP for %zu keys", size);
+        Free(map);
+        return NULL;
+    }
+    return map;
+} /* new_u64map(...) */
+
+/**
+ *@brief grow the map so that it holds nb_items keys without growing again
+ *@param map targeted map
+ *@param nb_items number of keys to make room for
+ *@return TRUE or FALSE
+ */
+int u64map_reserve(U64MAP* map, size_t nb_items) {
+    __n_assert(map, return FALSE);
+
+    if ((nb_items + map->nb_deleted) * 100 <= map->size * U64MAP_MAX_LOAD_PERCENT)
+        return TRUE;
+    size_t new_size = _u64map_size_for(nb_items > map->nb_items ? nb_items : map->nb_items);
+    return _u64map_rehash(map, new_size > map->size ? new_size : map->size);
+} /* u64map_reserve(...) */
+
+/**
+ *@brief put a value at a precomputed hash, replacing the previous value of key
+ *@param map targeted map
+ *@param key key of the value
+ *@param hash hash of key
+ *@param value value to put
+ *@return TRUE or FALSE
+ */
+int _u64map_put_hashed(U64MAP* map, uint64_t key, uint64_t hash, void* value) {
+    size_t index = _u64map_find(map, key, hash);
+    if (index != SIZE_MAX) {
+        if (map->destroy_func && map->values[index] && map->values[index] != value)
+            map->destroy_func(map->values[index]);
+        map->values[index] = value;
+        return TRUE;
+    }
+    if ((map->nb_items + map->nb_deleted + 1) * 100 > map->size * U64MAP_MAX_LOAD_PERCENT) {
+        /* drop the deleted slots if that is enough, else double */
+        size_t new_size = map->size;
+        if ((map->nb_items + 1) * 200 > map->size * U64MAP_MAX_LOAD_PERCENT)
+            new_size *= 2;
+        if (_u64map_rehash(map, new_size) == FALSE) {
+            n_log(LOG_ERR, "Could not grow map %p from %zu slots", map, map->size);
+            return FALSE;
+        }
+    }
+    _u64map_insert(map, key, hash, value);
+    return TRUE;
+} /* _u64map_put_hashed(...) */
+
+/**
+ *@brief put a value at key, replacing and destroying the previous one
+ *@param map targeted map
+ *@param key key of the value
+ *@param value value to put
+ *@return TRUE or FALSE
+ */
+int u64map_put(U64MAP* map, uint64_t key, void* value) {
+    __n_assert(map, return FALSE);
+    return _u64map_put_hashed(map, key, _u64map_hash(key), value);
+} /* u64map_put(...) */
+
+/**
+ *@brief get the value at key. Leave value untouched if key is not found.
+ *@param map targeted map
+ *@param key key of the value
+ *@param value a pointer to the destination pointer
+ *@return TRUE or FALSE
+ */
+int u64map_get(const U64MAP* map, uint64_t key, void** value) {
+    __n_assert(map, return FALSE);
+    __n_assert(value, return FALSE);
+
+    size_t index = _u64map_find(map, key, _u64map_hash(key));
+    if (index == SIZE_MAX)
+        return FALSE;
+    (*value) = map->values[index];
+    return TRUE;
+} /* u64map_get(...) */
+
+/**
+ *@brief remove key from the map and destroy its value
+ *@param map targeted map
+ *@param key key to remove
+ *@return TRUE or FALSE
+ */
+int u64map_remove(U64MAP* map, uint64_t key) {
+    __n_assert(map, return FALSE);
+
+    size_t index = _u64map_find(map, key, _u64map_hash(key));
+    if (index == SIZE_MAX)
+        return FALSE;
+    if (map->destroy_func && map->values[index])
+        map->destroy_func(map->values[index]);
+    map->values[index] = NULL;
+    /* probes stop on a group with an empty slot, so the slot can only be emptied if its group already stops them */
+    if (_u64map_group_match(map->ctrl + (index & ~(size_t)(U64MAP_GROUP_SIZE - 1)), U64MAP_EMPTY)) {
+        map->ctrl[index] = U64MAP_EMPTY;
+    } else {
+        map->ctrl[index] = U64MAP_DELETED;
+        map->nb_deleted++;
+    }
+    map->nb_items--;
+    return TRUE;
+} /* u64map_remove(...) */
+
+/**
+ *@brief hash a batch of keys and prefetch the first group of each
+ *@param map targeted map
+ *@param keys keys of the batch
+ *@param nb number of keys in the batch, at most U64MAP_BATCH_SIZE
+ *@param hashes destination of the hashes
+ */
+void _u64map_prefetch(const U64MAP* map, const uint64_t* keys, size_t nb, uint64_t* hashes) {
+    size_t group_mask = map->size / U64MAP_GROUP_SIZE - 1;
+    for (size_t it = 0; it < nb; it++) {
+        hashes[it] = _u64map_hash(keys[it]);
+        size_t slot = ((size_t)(hashes[it] >> 7) & group_mask) * U64MAP_GROUP_SIZE;
+        __builtin_prefetch(map->ctrl + slot, 0, 1);
+        __builtin_prefetch(map->keys + slot, 0, 1);
+    }
+} /* _u64map_prefetch(...) */
+
+/**
+ *@brief put nb values at their keys. Keys are hashed and their groups prefetched U64MAP_BATCH_SIZE at a time before being resolved, so the cache misses of a batch overlap.
+ *@param map targeted map
+ *@param keys array of nb keys
+ *@param values array of nb values
+ *@param nb number of keys
+ *@return the number of keys put
+ */
+size_t u64map_put_many(U64MAP* map, const uint64_t* keys, void* const* values, size_t nb) {
+    __n_assert(map, return 0);
+    __n_assert(keys, return 0);
+    __n_assert(values, return 0);
+
+    /* grow once up front, so the prefetched groups stay valid */
+    if (u64map_reserve(map, map->nb_items + nb) == FALSE)
+        return 0;
+
+    size_t nb_put = 0;
+    uint64_t hashes[U64MAP_BATCH_SIZE];
+    for (size_t base = 0; base < nb; base += U64MAP_BATCH_SIZE) {
+        size_t batch = (nb - base < U64MAP_BATCH_SIZE) ? nb - base : U64MAP_BATCH_SIZE;
+        _u64map_prefetch(map, keys + base, batch, hashes);
+        for (size_t it = 0; it < batch; it++) {
+            if (_u64map_put_hashed(map, keys[base + it], hashes[it], values[base + it]) == TRUE)
+                nb_put++;
+        }
+    }
+    return nb_put;
+} /* u64map_put_many(...) */
+
+/**
+ *@brief get the values of nb keys. Keys are hashed and their groups prefetched U64MAP_BATCH_SIZE at a time before being resolved, so the cache misses of a batch overlap.
+ *@param map targeted map
+ *@param keys array of nb keys
+ *@param nb number of keys
+ *@param values destination array of nb values, NULL for the keys not found
+ *@return the number of keys found
+ */
+size_t u64map_get_many(const U64MAP* map, const uint64_t* keys, size_t nb, void** values) {
+    __n_assert(map, return 0);
+    __n_assert(keys, return 0);
+    __n_assert(values, return 0);
+
+    size_t nb_found = 0;
+    uint64_t hashes[U64MAP_BATCH_SIZE];
+    for (size_t base = 0; base < nb; base += U64MAP_BATCH_SIZE) {
+        size_t batch = (nb - base < U64MAP_BATCH_SIZE) ? nb - base : U64MAP_BATCH_SIZE;
+        _u64map_prefetch(map, keys + base, batch, hashes);
+        for (size_t it = 0; it < batch; it++) {
+            size_t index = _u64map_find(map, keys[base + it], hashes[it]);
+            if (index == SIZE_MAX) {
+                values[base + it] = NULL;
+            } else {
+                values[base + it] = map->values[index];
+                nb_found++;
+            }
+        }
+    }
+    return nb_found;
+} /* u64map_get_many(...) */
+
+/**
+ *@brief remove all the keys from the map, destroying their values. The slots are kept.
+ *@param map targeted map
+ *@return TRUE or FALSE
+ */
+int u64map_empty(U64MAP* map) {
+    __n_assert(map, return FALSE);
+
+    if (map->destroy_func) {
+        u64map_foreach(it, map) {
+            if (map->values[it])
+                map->destroy_func(map->values[it]);
+        }
+    }
+    memset(map->ctrl, U64MAP_EMPTY, map->size);
+    memset(map->values, 0, map->size * sizeof(void*));
+    map->nb_items = 0;
+    map->nb_deleted = 0;
+    return TRUE;
+} /* u64map_empty(...) */
+
+/**
+ *@brief destroy a map, destroying the values left in it, and set it to NULL
+ *@param map pointer to the map to destroy
+ *@return TRUE or FALSE
+ */
+int destroy_u64map(U64MAP** map) {
+    __n_assert(map && (*map), n_log(LOG_ERR, "Can't destroy map: already NULL"); return FALSE);
+
+    u64map_empty((*map));
+    Free((*map)->ctrl);
+    Free((*map)->keys);
+    Free((*map)->values);
+    Free((*map));
+    return TRUE;
+} /* destroy_u64map(...) */